@@ -953,6 +953,24 @@ bool CApplicationPlayer::RenderCaptureGetPixels(unsigned int captureId, unsigned
     return false;
 }
 
+bool CApplicationPlayer::GetFramePacing(FramePacingStats& stats,
+                                        std::vector<FramePacingEvent>& events,
+                                        unsigned int maxEvents)
+{
+  std::shared_ptr<IPlayer> player = GetInternal();
+  if (player)
+    return player->GetFramePacing(stats, events, maxEvents);
+  else
+    return false;
+}
+
+void CApplicationPlayer::ResetFramePacing()
+{
+  std::shared_ptr<IPlayer> player = GetInternal();
+  if (player)
+    player->ResetFramePacing();
+}
+
 bool CApplicationPlayer::IsExternalPlaying()
 {
   std::shared_ptr<IPlayer> player = GetInternal();
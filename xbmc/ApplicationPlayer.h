@@ -65,6 +65,8 @@ public:
   void RenderCapture(unsigned int captureId, unsigned int width, unsigned int height, int flags = 0);
   void RenderCaptureRelease(unsigned int captureId);
   bool RenderCaptureGetPixels(unsigned int captureId, unsigned int millis, uint8_t *buffer, unsigned int size);
+  bool GetFramePacing(FramePacingStats& stats, std::vector<FramePacingEvent>& events, unsigned int maxEvents);
+  void ResetFramePacing();
   bool IsExternalPlaying();
   bool IsRemotePlaying();
 
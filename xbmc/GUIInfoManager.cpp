@@ -1004,6 +1004,14 @@ const infomap player_times[] =   {{ "seektime",         PLAYER_SEEKTIME },
 ///     @skinning_v17 **[New Infolabel]** \link Player_Process_audiobitspersample `Player.Process(audiobitspersample)`\endlink
 ///     <p>
 ///   }
+///   \table_row3{   <b>`Player.Process(audiolatency)`</b>,
+///                  \anchor Player_Process_audiolatency
+///                  _string_,
+///     @return The measured audio output latency of the currently playing item in milliseconds.
+///     <p><hr>
+///     @skinning_v20 **[New Infolabel]** \link Player_Process_audiolatency `Player.Process(audiolatency)`\endlink
+///     <p>
+///   }
 /// \table_end
 ///
 /// -----------------------------------------------------------------------------
@@ -1021,7 +1029,8 @@ const infomap player_process[] =
   { "audiodecoder", PLAYER_PROCESS_AUDIODECODER },
   { "audiochannels", PLAYER_PROCESS_AUDIOCHANNELS },
   { "audiosamplerate", PLAYER_PROCESS_AUDIOSAMPLERATE },
-  { "audiobitspersample", PLAYER_PROCESS_AUDIOBITSPERSAMPLE }
+  { "audiobitspersample", PLAYER_PROCESS_AUDIOBITSPERSAMPLE },
+  { "audiolatency", PLAYER_PROCESS_AUDIOLATENCY }
 };
 
 /// \page modules__infolabels_boolean_conditions
@@ -3817,6 +3826,31 @@ const infomap videoplayer[] =    {{ "title",            VIDEOPLAYER_TITLE },
 ///     @skinning_v18 **[New Infolabel]** \link RetroPlayer_VideoRotation `RetroPlayer.VideoRotation`\endlink
 ///     <p>
 ///   }
+///   \table_row3{   <b>`RetroPlayer.RunAheadFrames`</b>,
+///                  \anchor RetroPlayer_RunAheadFrames
+///                  _integer_,
+///     @return The number of frames the currently-playing game is emulated
+///     ahead of the input\, or 0 if run-ahead is disabled.
+///     <p><hr>
+///     @skinning_v20 **[New Infolabel]** \link RetroPlayer_RunAheadFrames `RetroPlayer.RunAheadFrames`\endlink
+///     <p>
+///   }
+///   \table_row3{   <b>`RetroPlayer.RunAheadCpuTime`</b>,
+///                  \anchor RetroPlayer_RunAheadCpuTime
+///                  _string_,
+///     @return The CPU time in milliseconds that run-ahead adds to every frame.
+///     <p><hr>
+///     @skinning_v20 **[New Infolabel]** \link RetroPlayer_RunAheadCpuTime `RetroPlayer.RunAheadCpuTime`\endlink
+///     <p>
+///   }
+///   \table_row3{   <b>`RetroPlayer.RunAheadLatency`</b>,
+///                  \anchor RetroPlayer_RunAheadLatency
+///                  _string_,
+///     @return The input latency in milliseconds that run-ahead removes.
+///     <p><hr>
+///     @skinning_v20 **[New Infolabel]** \link RetroPlayer_RunAheadLatency `RetroPlayer.RunAheadLatency`\endlink
+///     <p>
+///   }
 /// \table_end
 ///
 /// -----------------------------------------------------------------------------
@@ -3825,6 +3859,9 @@ const infomap retroplayer[] =
   { "videofilter",            RETROPLAYER_VIDEO_FILTER},
   { "stretchmode",            RETROPLAYER_STRETCH_MODE},
   { "videorotation",          RETROPLAYER_VIDEO_ROTATION},
+  { "runaheadframes",         RETROPLAYER_RUNAHEAD_FRAMES},
+  { "runaheadcputime",        RETROPLAYER_RUNAHEAD_CPUTIME},
+  { "runaheadlatency",        RETROPLAYER_RUNAHEAD_LATENCY},
 };
 
 /// \page modules__infolabels_boolean_conditions
@@ -6890,6 +6927,42 @@ const infomap listitem_labels[]= {{ "thumb",            LISTITEM_THUMB },
 ///     @return the name of the visualisation.
 ///     <p>
 ///   }
+///   \table_row3{   <b>`Visualisation.LevelLeft`</b>,
+///                  \anchor Visualisation_LevelLeft
+///                  _integer_,
+///     @return The RMS level of the left channel of the audio being played\, from 0
+///     (-60 dB or silence) to 100 (full scale). Works without a visualisation.
+///     <p><hr>
+///     @skinning_v20 **[New Infolabel]** \link Visualisation_LevelLeft `Visualisation.LevelLeft`\endlink
+///     <p>
+///   }
+///   \table_row3{   <b>`Visualisation.LevelRight`</b>,
+///                  \anchor Visualisation_LevelRight
+///                  _integer_,
+///     @return The RMS level of the right channel of the audio being played\, from 0
+///     (-60 dB or silence) to 100 (full scale). Works without a visualisation.
+///     <p><hr>
+///     @skinning_v20 **[New Infolabel]** \link Visualisation_LevelRight `Visualisation.LevelRight`\endlink
+///     <p>
+///   }
+///   \table_row3{   <b>`Visualisation.PeakLeft`</b>,
+///                  \anchor Visualisation_PeakLeft
+///                  _integer_,
+///     @return The peak level of the left channel of the audio being played\, from 0
+///     (-60 dB or silence) to 100 (full scale). Works without a visualisation.
+///     <p><hr>
+///     @skinning_v20 **[New Infolabel]** \link Visualisation_PeakLeft `Visualisation.PeakLeft`\endlink
+///     <p>
+///   }
+///   \table_row3{   <b>`Visualisation.PeakRight`</b>,
+///                  \anchor Visualisation_PeakRight
+///                  _integer_,
+///     @return The peak level of the right channel of the audio being played\, from 0
+///     (-60 dB or silence) to 100 (full scale). Works without a visualisation.
+///     <p><hr>
+///     @skinning_v20 **[New Infolabel]** \link Visualisation_PeakRight `Visualisation.PeakRight`\endlink
+///     <p>
+///   }
 /// \table_end
 ///
 /// -----------------------------------------------------------------------------
@@ -6897,7 +6970,11 @@ const infomap visualisation[] =  {{ "locked",           VISUALISATION_LOCKED },
                                   { "preset",           VISUALISATION_PRESET },
                                   { "haspresets",       VISUALISATION_HAS_PRESETS },
                                   { "name",             VISUALISATION_NAME },
-                                  { "enabled",          VISUALISATION_ENABLED }};
+                                  { "enabled",          VISUALISATION_ENABLED },
+                                  { "levelleft",        VISUALISATION_LEVEL_LEFT },
+                                  { "levelright",       VISUALISATION_LEVEL_RIGHT },
+                                  { "peakleft",         VISUALISATION_PEAK_LEFT },
+                                  { "peakright",        VISUALISATION_PEAK_RIGHT }};
 
 /// \page modules__infolabels_boolean_conditions
 /// \subsection modules__infolabels_boolean_conditions_Fanart Fanart
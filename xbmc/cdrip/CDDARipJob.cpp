@@ -12,7 +12,9 @@
 #include "FileItem.h"
 #include "ServiceBroker.h"
 #include "utils/log.h"
+#include "utils/CPUInfo.h"
 #include "utils/SystemInfo.h"
+#include "utils/URIUtils.h"
 #include "Util.h"
 #include "dialogs/GUIDialogExtendedProgressBar.h"
 #include "filesystem/File.h"
@@ -28,6 +30,9 @@
 #include "addons/AddonManager.h"
 #include "addons/AudioEncoder.h"
 
+#include <algorithm>
+#include <utility>
+
 #if defined(TARGET_WINDOWS)
 #include "platform/win32/CharsetConverter.h"
 #endif
@@ -43,36 +48,43 @@ CCDDARipJob::CCDDARipJob(const std::string& input,
                          bool eject,
                          unsigned int rate,
                          unsigned int channels, unsigned int bps) :
-  m_rate(rate), m_channels(channels), m_bps(bps), m_tag(tag),
-  m_input(input), m_output(CUtil::MakeLegalPath(output)), m_eject(eject),
-  m_encoder(encoder)
+  CCDDARipJob(std::vector<CDDARipTrack>{{input, output, tag}}, encoder, eject, rate, channels,
+              bps)
+{
+}
+
+CCDDARipJob::CCDDARipJob(std::vector<CDDARipTrack> tracks,
+                         int encoder,
+                         bool eject,
+                         unsigned int rate,
+                         unsigned int channels, unsigned int bps) :
+  m_rate(rate), m_channels(channels), m_bps(bps), m_tracks(std::move(tracks)),
+  m_eject(eject), m_encoder(encoder)
 {
+  for (CDDARipTrack& track : m_tracks)
+    track.output = CUtil::MakeLegalPath(track.output);
 }
 
 CCDDARipJob::~CCDDARipJob() = default;
 
 bool CCDDARipJob::DoWork()
 {
-  CLog::Log(LOGINFO, "Start ripping track {} to {}", m_input, m_output);
+  CLog::Log(LOGINFO, "Start ripping {} track(s) from {}", m_tracks.size(),
+            URIUtils::GetDirectory(m_tracks.front().input));
 
   // if we are ripping to a samba share, rip it to hd first and then copy it it the share
-  CFileItem file(m_output, false);
-  if (file.IsRemote())
-    m_output = SetupTempFile();
-
-  if (m_output.empty())
+  std::vector<CDDARipTrack> tracks = m_tracks;
+  for (CDDARipTrack& track : tracks)
   {
-    CLog::Log(LOGERROR, "CCDDARipper: Error opening file");
-    return false;
-  }
+    CFileItem file(track.output, false);
+    if (file.IsRemote())
+      track.output = SetupTempFile();
 
-  // init ripper
-  CFile reader;
-  CEncoder* encoder = nullptr;
-  if (!reader.Open(m_input,READ_CACHED) || !(encoder=SetupEncoder(reader)))
-  {
-    CLog::Log(LOGERROR, "Error: CCDDARipper::Init failed");
-    return false;
+    if (track.output.empty())
+    {
+      CLog::Log(LOGERROR, "CCDDARipper: Error opening file");
+      return false;
+    }
   }
 
   // setup the progress dialog
@@ -80,56 +92,74 @@ bool CCDDARipJob::DoWork()
       CServiceBroker::GetGUI()->GetWindowManager().GetWindow<CGUIDialogExtendedProgressBar>(WINDOW_DIALOG_EXT_PROGRESS);
   CGUIDialogProgressBarHandle* handle = pDlgProgress->GetHandle(g_localizeStrings.Get(605));
 
-  int iTrack = atoi(m_input.substr(13, m_input.size() - 13 - 5).c_str());
-  std::string strLine0 =
-      StringUtils::Format("{:02}. {} - {}", iTrack, m_tag.GetArtistString(), m_tag.GetTitle());
-  handle->SetText(strLine0);
+  // the drive reads one track at a time, the tracks that were read are encoded in parallel
+  const std::shared_ptr<CCPUInfo> cpuInfo = CServiceBroker::GetCPUInfo();
+  const unsigned int encoders = cpuInfo ? std::max(cpuInfo->GetCPUCount(), 1) : 1;
 
-  // start ripping
-  int percent=0;
-  int oldpercent=0;
+  CCDDARipPipeline pipeline(
+      [this](const CDDARipTrack& track, int64_t length) { return SetupEncoder(track, length); },
+      encoders);
+
+  size_t shownTrack = tracks.size();
+  int oldpercent = -1;
   bool cancelled(false);
-  int result;
-  while (!cancelled && (result=RipChunk(reader, encoder, percent)) == 0)
-  {
-    cancelled = ShouldCancel(percent,100);
+  const bool success = pipeline.Rip(tracks, [&](size_t track, int percent) {
+    if (track != shownTrack)
+    {
+      shownTrack = track;
+      const CMusicInfoTag& tag = tracks[track].tag;
+      handle->SetText(StringUtils::Format("{:02}. {} - {}", GetTrackNumber(tracks[track].input),
+                                          tag.GetArtistString(), tag.GetTitle()));
+    }
     if (percent > oldpercent)
     {
       oldpercent = percent;
       handle->SetPercentage(static_cast<float>(percent));
     }
-  }
-
-  // close encoder ripper
-  encoder->CloseEncode();
-  delete encoder;
-  reader.Close();
+    cancelled = ShouldCancel(percent, 100);
+    return !cancelled;
+  });
 
-  if (file.IsRemote() && !cancelled && result == 2)
+  bool copied = true;
+  for (size_t i = 0; i < tracks.size(); ++i)
   {
-    // copy the ripped track to the share
-    if (!CFile::Copy(m_output, file.GetPath()))
+    const std::string& input = tracks[i].input;
+    switch (pipeline.GetResult(i))
     {
-      CLog::Log(LOGERROR, "CDDARipper: Error copying file from {} to {}", m_output, file.GetPath());
-      CFile::Delete(m_output);
-      return false;
+      case CCDDARipPipeline::TrackResult::OK:
+        CLog::Log(LOGINFO, "Finished ripping {}", input);
+        if (tracks[i].output != m_tracks[i].output)
+        {
+          // copy the ripped track to the share
+          if (!CFile::Copy(tracks[i].output, m_tracks[i].output))
+          {
+            CLog::Log(LOGERROR, "CDDARipper: Error copying file from {} to {}", tracks[i].output,
+                      m_tracks[i].output);
+            CFile::Delete(tracks[i].output);
+            copied = false;
+            break;
+          }
+          // delete cached file
+          CFile::Delete(tracks[i].output);
+        }
+        break;
+      case CCDDARipPipeline::TrackResult::READ_FAILED:
+        CLog::Log(LOGERROR, "CDDARipper: Error ripping {}", input);
+        break;
+      case CCDDARipPipeline::TrackResult::ENCODE_FAILED:
+        CLog::Log(LOGERROR, "CDDARipper: Error encoding {}", input);
+        break;
+      default:
+        break;
     }
-    // delete cached file
-    CFile::Delete(m_output);
   }
 
   if (cancelled)
-  {
     CLog::Log(LOGWARNING, "User Cancelled CDDA Rip");
-    CFile::Delete(m_output);
-  }
-  else if (result == 1)
-    CLog::Log(LOGERROR, "CDDARipper: Error ripping {}", m_input);
-  else if (result < 0)
-    CLog::Log(LOGERROR, "CDDARipper: Error encoding {}", m_input);
-  else
+  else if (success && copied)
   {
-    CLog::Log(LOGINFO, "Finished ripping {}", m_input);
+    CLog::Log(LOGINFO, "Ripped {} track(s) at {:.1f} tracks per minute", tracks.size(),
+              pipeline.GetTracksPerMinute());
     if (m_eject)
     {
       CLog::Log(LOGINFO, "Ejecting CD");
@@ -139,42 +169,23 @@ bool CCDDARipJob::DoWork()
 
   handle->MarkFinished();
 
-  return !cancelled && result == 2;
+  return !cancelled && success && copied;
 }
 
-int CCDDARipJob::RipChunk(CFile& reader, CEncoder* encoder, int& percent)
+int CCDDARipJob::GetTrackNumber(const std::string& input)
 {
-  percent = 0;
-
-  uint8_t stream[1024];
-
-  // get data
-  int result = reader.Read(stream, 1024);
-
-  // return if rip is done or on some kind of error
-  if (result <= 0)
-    return 1;
-
-  // encode data
-  int encres=encoder->Encode(result, stream);
-
-  // Get progress indication
-  percent = static_cast<int>(reader.GetPosition()*100/reader.GetLength());
-
-  if (reader.GetPosition() == reader.GetLength())
-    return 2;
-
-  return -(1-encres);
+  return atoi(URIUtils::GetFileName(input).c_str());
 }
 
-CEncoder* CCDDARipJob::SetupEncoder(CFile& reader)
+std::unique_ptr<CEncoder> CCDDARipJob::SetupEncoder(const CDDARipTrack& track,
+                                                    int64_t length) const
 {
-  CEncoder* encoder = nullptr;
+  std::unique_ptr<CEncoder> encoder;
   const std::string audioEncoder = CServiceBroker::GetSettingsComponent()->GetSettings()->GetString(CSettings::SETTING_AUDIOCDS_ENCODER);
   if (audioEncoder == "audioencoder.kodi.builtin.aac" || audioEncoder == "audioencoder.kodi.builtin.wma")
   {
     std::shared_ptr<IEncoder> enc(new CEncoderFFmpeg());
-    encoder = new CEncoder(enc);
+    encoder.reset(new CEncoder(enc));
   }
   else
   {
@@ -183,31 +194,31 @@ CEncoder* CCDDARipJob::SetupEncoder(CFile& reader)
     if (addonInfo)
     {
       std::shared_ptr<IEncoder> enc = std::make_shared<CAudioEncoder>(addonInfo);
-      encoder = new CEncoder(enc);
+      encoder.reset(new CEncoder(enc));
     }
   }
   if (!encoder)
-    return NULL;
+    return nullptr;
 
   // we have to set the tags before we init the Encoder
-  const std::string strTrack = StringUtils::Format(
-      "{}", std::stol(m_input.substr(13, m_input.size() - 13 - 5), nullptr, 10));
+  const std::string strTrack = StringUtils::Format("{}", GetTrackNumber(track.input));
 
   const std::string itemSeparator = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_musicItemSeparator;
 
+  const CMusicInfoTag& tag = track.tag;
   encoder->SetComment(std::string("Ripped with ") + CSysInfo::GetAppName());
-  encoder->SetArtist(StringUtils::Join(m_tag.GetArtist(), itemSeparator));
-  encoder->SetTitle(m_tag.GetTitle());
-  encoder->SetAlbum(m_tag.GetAlbum());
-  encoder->SetAlbumArtist(StringUtils::Join(m_tag.GetAlbumArtist(), itemSeparator));
-  encoder->SetGenre(StringUtils::Join(m_tag.GetGenre(), itemSeparator));
+  encoder->SetArtist(StringUtils::Join(tag.GetArtist(), itemSeparator));
+  encoder->SetTitle(tag.GetTitle());
+  encoder->SetAlbum(tag.GetAlbum());
+  encoder->SetAlbumArtist(StringUtils::Join(tag.GetAlbumArtist(), itemSeparator));
+  encoder->SetGenre(StringUtils::Join(tag.GetGenre(), itemSeparator));
   encoder->SetTrack(strTrack);
-  encoder->SetTrackLength(static_cast<int>(reader.GetLength()));
-  encoder->SetYear(m_tag.GetYearString());
+  encoder->SetTrackLength(static_cast<int>(length));
+  encoder->SetYear(tag.GetYearString());
 
   // init encoder
-  if (!encoder->Init(m_output.c_str(), m_channels, m_rate, m_bps))
-    delete encoder, encoder = nullptr;
+  if (!encoder->Init(track.output.c_str(), m_channels, m_rate, m_bps))
+    encoder.reset();
 
   return encoder;
 }
@@ -239,8 +250,11 @@ bool CCDDARipJob::operator==(const CJob* job) const
     const CCDDARipJob* rjob = dynamic_cast<const CCDDARipJob*>(job);
     if (rjob)
     {
-      return m_input  == rjob->m_input &&
-             m_output == rjob->m_output;
+      return std::equal(m_tracks.begin(), m_tracks.end(), rjob->m_tracks.begin(),
+                        rjob->m_tracks.end(),
+                        [](const CDDARipTrack& track, const CDDARipTrack& other) {
+                          return track.input == other.input && track.output == other.output;
+                        });
     }
   }
   return false;
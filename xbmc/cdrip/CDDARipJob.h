@@ -8,15 +8,15 @@
 
 #pragma once
 
-#include "music/tags/MusicInfoTag.h"
+#include "CDDARipPipeline.h"
 #include "utils/Job.h"
 
-class CEncoder;
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
 
-namespace XFILE
-{
-class CFile;
-}
+class CEncoder;
 
 class CCDDARipJob : public CJob
 {
@@ -35,36 +35,41 @@ public:
               bool eject=false, unsigned int rate=44100,
               unsigned int channels=2, unsigned int bps=16);
 
+  //! \brief Construct a ripper job for several tracks of a disc
+  //!
+  //! The tracks are read one after another and encoded in parallel.
+  //! \param tracks The tracks to rip, in disc order
+  //! \param encoder The encoder to use. See Encoder.h
+  //! \param eject Should we eject tray on finish?
+  //! \param rate The sample rate of the input
+  //! \param channels Number of audio channels in input
+  //! \param bps The bits per sample for input
+  CCDDARipJob(std::vector<CDDARipTrack> tracks, int encoder,
+              bool eject=false, unsigned int rate=44100,
+              unsigned int channels=2, unsigned int bps=16);
+
   ~CCDDARipJob() override;
 
   const char* GetType() const override { return "cdrip"; };
   bool operator==(const CJob *job) const override;
   bool DoWork() override;
-  std::string GetOutput() const { return m_output; }
+  std::string GetOutput() const { return m_tracks.front().output; }
 protected:
-  //! \brief Setup the audio encoder
-  CEncoder* SetupEncoder(XFILE::CFile& reader);
+  //! \brief Setup the audio encoder of a track
+  //! \param track The track to encode
+  //! \param length The length of the track's input in bytes
+  std::unique_ptr<CEncoder> SetupEncoder(const CDDARipTrack& track, int64_t length) const;
 
   //! \brief Helper used if output is a remote url
   std::string SetupTempFile();
 
-  //! \brief Rip a chunk of audio
-  //! \param reader The input reader
-  //! \param encoder The audio encoder
-  //! \param percent The percentage completed on return
-  //! \return 0 (CDDARIP_OK) if everything went okay, or
-  //!         a positive error code from the reader, or
-  //!         -1 if the encoder failed
-  //! \sa CCDDARipper::GetData, CEncoder::Encode
-  int RipChunk(XFILE::CFile& reader, CEncoder* encoder, int& percent);
+  //! \brief Get the track number from a cdda:// url
+  static int GetTrackNumber(const std::string& input);
 
   unsigned int m_rate; //< The sample rate of the input file
   unsigned int m_channels; //< The number of channels in input file
   unsigned int m_bps; //< The bits per sample of input
-  MUSIC_INFO::CMusicInfoTag m_tag; //< Music tag to attach to output file
-  std::string m_input; //< The input url
-  std::string m_output; //< The output url
+  std::vector<CDDARipTrack> m_tracks; //< The tracks to rip
   bool m_eject; //< Should we eject tray when we are finished?
   int m_encoder; //< The audio encoder
 };
-
@@ -0,0 +1,395 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "CDDARipPipeline.h"
+
+#include "Encoder.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+using namespace XFILE;
+using namespace std::chrono_literals;
+
+CCDDARipPipeline::CCDDARipPipeline(EncoderFactory encoderFactory,
+                                   unsigned int encoders,
+                                   size_t bufferSize)
+  : m_encoderFactory(std::move(encoderFactory)),
+    m_encoders(std::max(encoders, 1u)),
+    m_bufferSize(std::max(bufferSize, CHUNK_SIZE))
+{
+}
+
+CCDDARipPipeline::~CCDDARipPipeline() = default;
+
+bool CCDDARipPipeline::Rip(const std::vector<CDDARipTrack>& tracks,
+                           const ProgressCallback& progress)
+{
+  {
+    CSingleLock lock(m_critSection);
+    m_tracks.clear();
+    m_tracks.resize(tracks.size());
+    for (size_t i = 0; i < tracks.size(); ++i)
+      m_tracks[i].track = &tracks[i];
+    m_queue.clear();
+    m_activeTracks = 0;
+    m_buffered = 0;
+    m_maxBuffered = 0;
+    m_cancelled = false;
+    m_failed = false;
+    m_stop = false;
+  }
+  m_tracksPerMinute = 0.0;
+
+  if (tracks.empty())
+    return true;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  const size_t encoders = std::min(static_cast<size_t>(m_encoders), tracks.size());
+  for (size_t i = 0; i < encoders; ++i)
+  {
+    m_threads.emplace_back(new CThread(this, "CDDAEncoder"));
+    m_threads.back()->Create();
+  }
+
+  // Read the tracks one after another, stop at the first failure
+  bool success = true;
+  for (size_t i = 0; i < tracks.size() && success; ++i)
+    success = ReadTrack(i, progress);
+
+  // Wait for the encoders to finish the tracks that were read
+  while (true)
+  {
+    if (!ReportProgress(tracks.size() - 1, progress))
+      CancelTracks();
+
+    CSingleLock lock(m_critSection);
+    if (m_activeTracks == 0)
+    {
+      m_stop = true;
+      break;
+    }
+    m_readerCondition.wait(lock, 100ms);
+  }
+
+  m_encoderCondition.notifyAll();
+  for (auto& thread : m_threads)
+    thread->StopThread(true);
+  m_threads.clear();
+
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  size_t ripped = 0;
+  for (const TrackState& state : m_tracks)
+  {
+    if (state.result == TrackResult::OK)
+      ++ripped;
+  }
+
+  if (seconds > 0.0)
+    m_tracksPerMinute = ripped * 60.0 / seconds;
+
+  CLog::Log(LOGINFO,
+            "CDDARipPipeline: Ripped {} of {} tracks in {:.1f} s with {} encoders, {:.1f} tracks "
+            "per minute",
+            ripped, tracks.size(), seconds, encoders, m_tracksPerMinute);
+
+  return ripped == tracks.size();
+}
+
+CCDDARipPipeline::TrackResult CCDDARipPipeline::GetResult(size_t track) const
+{
+  CSingleLock lock(m_critSection);
+  if (track >= m_tracks.size())
+    return TrackResult::NONE;
+
+  return m_tracks[track].result;
+}
+
+bool CCDDARipPipeline::ReadTrack(size_t index, const ProgressCallback& progress)
+{
+  TrackState& state = m_tracks[index];
+
+  // Wait for a free encoder, so the buffer only holds tracks that are being encoded
+  while (true)
+  {
+    if (!ReportProgress(index, progress))
+    {
+      CancelTracks();
+      return false;
+    }
+
+    CSingleLock lock(m_critSection);
+    if (m_cancelled || m_failed)
+      return false;
+
+    if (m_activeTracks < m_threads.size())
+    {
+      ++m_activeTracks;
+      break;
+    }
+    m_readerCondition.wait(lock, 100ms);
+  }
+
+  CFile reader;
+  if (!reader.Open(state.track->input, READ_CACHED))
+  {
+    CLog::Log(LOGERROR, "CDDARipPipeline: Error opening {}", state.track->input);
+
+    CSingleLock lock(m_critSection);
+    state.result = TrackResult::READ_FAILED;
+    m_failed = true;
+    --m_activeTracks;
+    return false;
+  }
+
+  {
+    CSingleLock lock(m_critSection);
+    state.length = reader.GetLength();
+    m_queue.push_back(index);
+  }
+  m_encoderCondition.notifyAll();
+
+  bool success = true;
+  while (true)
+  {
+    std::vector<uint8_t> chunk;
+    if (!GetChunk(state, index, progress, chunk))
+    {
+      success = false;
+      break;
+    }
+
+    chunk.resize(CHUNK_SIZE);
+    const ssize_t read = reader.Read(chunk.data(), chunk.size());
+    if (read == 0 && reader.GetPosition() >= state.length)
+      break;
+
+    if (read <= 0)
+    {
+      CLog::Log(LOGERROR, "CDDARipPipeline: Error reading {}", state.track->input);
+
+      CSingleLock lock(m_critSection);
+      state.readFailed = true;
+      success = false;
+      break;
+    }
+
+    chunk.resize(read);
+    {
+      CSingleLock lock(m_critSection);
+      m_buffered += chunk.size();
+      m_maxBuffered = std::max(m_maxBuffered, m_buffered);
+      state.chunks.emplace_back(std::move(chunk));
+    }
+    m_encoderCondition.notifyAll();
+  }
+
+  reader.Close();
+
+  {
+    CSingleLock lock(m_critSection);
+    state.inputDone = true;
+  }
+  m_encoderCondition.notifyAll();
+
+  return success;
+}
+
+bool CCDDARipPipeline::GetChunk(TrackState& state,
+                                size_t index,
+                                const ProgressCallback& progress,
+                                std::vector<uint8_t>& chunk)
+{
+  while (true)
+  {
+    if (!ReportProgress(index, progress))
+    {
+      CancelTracks();
+      return false;
+    }
+
+    CSingleLock lock(m_critSection);
+    if (m_cancelled || state.encodeFailed)
+      return false;
+
+    if (m_buffered + CHUNK_SIZE <= m_bufferSize)
+    {
+      if (!m_freeChunks.empty())
+      {
+        chunk = std::move(m_freeChunks.back());
+        m_freeChunks.pop_back();
+      }
+      return true;
+    }
+    m_readerCondition.wait(lock, 100ms);
+  }
+}
+
+void CCDDARipPipeline::Run()
+{
+  while (true)
+  {
+    size_t index;
+    {
+      CSingleLock lock(m_critSection);
+      while (m_queue.empty() && !m_stop)
+        m_encoderCondition.wait(lock);
+
+      if (m_queue.empty())
+        return;
+
+      index = m_queue.front();
+      m_queue.pop_front();
+    }
+
+    EncodeTrack(m_tracks[index]);
+  }
+}
+
+void CCDDARipPipeline::EncodeTrack(TrackState& state)
+{
+  // Tracks cancelled before they were started have no output file
+  bool skipped;
+  {
+    CSingleLock lock(m_critSection);
+    skipped = state.cancelled;
+  }
+
+  std::unique_ptr<CEncoder> encoder;
+  if (!skipped)
+  {
+    encoder = m_encoderFactory(*state.track, state.length);
+    if (!encoder)
+      CLog::Log(LOGERROR, "CDDARipPipeline: Error creating encoder for {}", state.track->output);
+  }
+
+  bool failed = !skipped && !encoder;
+
+  while (true)
+  {
+    std::vector<uint8_t> chunk;
+    {
+      CSingleLock lock(m_critSection);
+      if (failed)
+        state.encodeFailed = true;
+
+      while (state.chunks.empty() && !state.inputDone && !m_cancelled)
+        m_encoderCondition.wait(lock);
+
+      if (state.chunks.empty())
+        break;
+
+      chunk = std::move(state.chunks.front());
+      state.chunks.pop_front();
+    }
+
+    // Chunks of a failed track are only drained to release their buffer
+    if (!failed && !encoder->Encode(static_cast<int>(chunk.size()), chunk.data()))
+    {
+      CLog::Log(LOGERROR, "CDDARipPipeline: Error encoding {}", state.track->output);
+      failed = true;
+    }
+
+    {
+      CSingleLock lock(m_critSection);
+      m_buffered -= chunk.size();
+      state.encoded += chunk.size();
+      chunk.clear();
+      m_freeChunks.emplace_back(std::move(chunk));
+    }
+    m_readerCondition.notifyAll();
+  }
+
+  if (encoder && !encoder->CloseEncode())
+    failed = true;
+  encoder.reset();
+
+  TrackResult result = TrackResult::OK;
+  {
+    CSingleLock lock(m_critSection);
+    if (state.readFailed)
+      result = TrackResult::READ_FAILED;
+    else if (failed)
+      result = TrackResult::ENCODE_FAILED;
+    else if (state.cancelled)
+      result = TrackResult::CANCELLED;
+  }
+
+  if (result != TrackResult::OK && !skipped)
+    CFile::Delete(state.track->output);
+
+  {
+    CSingleLock lock(m_critSection);
+    state.result = result;
+    if (result == TrackResult::READ_FAILED || result == TrackResult::ENCODE_FAILED)
+      m_failed = true;
+    --m_activeTracks;
+  }
+  m_readerCondition.notifyAll();
+}
+
+bool CCDDARipPipeline::ReportProgress(size_t track, const ProgressCallback& progress)
+{
+  int percent;
+  {
+    CSingleLock lock(m_critSection);
+    if (m_cancelled)
+      return false;
+
+    double done = 0.0;
+    for (const TrackState& state : m_tracks)
+    {
+      if (state.result != TrackResult::NONE)
+        done += 1.0;
+      else if (state.length > 0)
+        done += static_cast<double>(state.encoded) / state.length;
+    }
+    percent = static_cast<int>(done * 100.0 / m_tracks.size());
+  }
+
+  if (!progress)
+    return true;
+
+  return progress(track, percent);
+}
+
+void CCDDARipPipeline::CancelTracks()
+{
+  {
+    CSingleLock lock(m_critSection);
+    if (m_cancelled)
+      return;
+
+    m_cancelled = true;
+    for (TrackState& state : m_tracks)
+    {
+      if (state.result != TrackResult::NONE)
+        continue;
+
+      // Tracks that were completely read are still encoded to the end
+      if (state.inputDone)
+        continue;
+
+      state.cancelled = true;
+      for (const auto& chunk : state.chunks)
+        m_buffered -= chunk.size();
+      state.chunks.clear();
+    }
+  }
+
+  m_encoderCondition.notifyAll();
+  m_readerCondition.notifyAll();
+}
@@ -0,0 +1,152 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "music/tags/MusicInfoTag.h"
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+#include "threads/IRunnable.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class CEncoder;
+class CThread;
+
+//! \brief A track to rip
+struct CDDARipTrack
+{
+  std::string input; //!< The input url, a cdda:// track or a file holding the same PCM data
+  std::string output; //!< The local output file
+  MUSIC_INFO::CMusicInfoTag tag; //!< Music tag to attach to the output file
+};
+
+//! \brief Rips tracks with reading and encoding running in parallel.
+//!
+//! The tracks are read one after another on the calling thread, as the drive
+//! can only read one position at a time. Read chunks are handed to a pool of
+//! encoder threads through a buffer of bounded size, each encoder working on
+//! a different track. While the drive reads the next track, the previous
+//! tracks are still being encoded on other cores.
+class CCDDARipPipeline : private IRunnable
+{
+public:
+  //! \brief Size of the chunks read from the input, 32 CD sectors.
+  static constexpr size_t CHUNK_SIZE = 2352 * 32;
+
+  //! \brief Default limit of audio data waiting for an encoder, about three minutes of CD audio.
+  static constexpr size_t DEFAULT_BUFFER_SIZE = 32 * 1024 * 1024;
+
+  enum class TrackResult
+  {
+    NONE,
+    OK,
+    READ_FAILED,
+    ENCODE_FAILED,
+    CANCELLED,
+  };
+
+  //! \brief Create an encoder writing the output file of a track.
+  //! \param track The track to encode
+  //! \param length The length of the track's input in bytes
+  //! \return The initialized encoder or nullptr on failure
+  //! \note Called from the encoder threads.
+  using EncoderFactory =
+      std::function<std::unique_ptr<CEncoder>(const CDDARipTrack& track, int64_t length)>;
+
+  //! \brief Report progress on the calling thread.
+  //! \param track Index of the track that is read
+  //! \param percent Percentage of all tracks that is encoded
+  //! \return false to cancel ripping
+  using ProgressCallback = std::function<bool(size_t track, int percent)>;
+
+  //! \brief Construct a ripping pipeline
+  //! \param encoderFactory The function creating the encoder of each track
+  //! \param encoders Maximum number of tracks encoded in parallel
+  //! \param bufferSize Maximum number of bytes read but not yet encoded
+  CCDDARipPipeline(EncoderFactory encoderFactory,
+                   unsigned int encoders,
+                   size_t bufferSize = DEFAULT_BUFFER_SIZE);
+  ~CCDDARipPipeline() override;
+
+  //! \brief Rip tracks, returns when all of them are encoded.
+  //!
+  //! Ripping stops at the first track that fails, tracks being encoded at that
+  //! time are finished. The output files of failed and cancelled tracks are
+  //! deleted.
+  //!
+  //! \param tracks The tracks to rip
+  //! \param progress Progress callback, may be empty
+  //! \return true if all tracks were ripped
+  bool Rip(const std::vector<CDDARipTrack>& tracks, const ProgressCallback& progress);
+
+  //! \brief Get the result of a track of the last call to Rip()
+  TrackResult GetResult(size_t track) const;
+
+  //! \brief Get the number of tracks per minute of the last call to Rip()
+  double GetTracksPerMinute() const { return m_tracksPerMinute; }
+
+  //! \brief Get the largest number of bytes waiting for an encoder during the last call to Rip()
+  size_t GetMaxBuffered() const { return m_maxBuffered; }
+
+private:
+  struct TrackState
+  {
+    const CDDARipTrack* track = nullptr;
+    int64_t length = 0;
+    int64_t encoded = 0;
+    std::deque<std::vector<uint8_t>> chunks;
+    bool inputDone = false;
+    bool readFailed = false;
+    bool encodeFailed = false;
+    bool cancelled = false;
+    TrackResult result = TrackResult::NONE;
+  };
+
+  // Implementation of IRunnable, the loop of an encoder thread
+  void Run() override;
+
+  void EncodeTrack(TrackState& state);
+  bool ReadTrack(size_t index, const ProgressCallback& progress);
+  bool GetChunk(TrackState& state,
+                size_t index,
+                const ProgressCallback& progress,
+                std::vector<uint8_t>& chunk);
+  bool ReportProgress(size_t track, const ProgressCallback& progress);
+  void CancelTracks();
+
+  // Construction parameters
+  const EncoderFactory m_encoderFactory;
+  const unsigned int m_encoders;
+  const size_t m_bufferSize;
+
+  // State of the current call to Rip()
+  std::vector<TrackState> m_tracks;
+  std::deque<size_t> m_queue; //!< Tracks waiting for an encoder thread
+  unsigned int m_activeTracks = 0; //!< Tracks being read or encoded
+  std::vector<std::vector<uint8_t>> m_freeChunks;
+  size_t m_buffered = 0;
+  size_t m_maxBuffered = 0;
+  bool m_cancelled = false;
+  bool m_failed = false; //!< A track failed, no further tracks are started
+  bool m_stop = false;
+  std::vector<std::unique_ptr<CThread>> m_threads;
+
+  // Statistics
+  double m_tracksPerMinute = 0.0;
+
+  // Synchronization
+  mutable CCriticalSection m_critSection;
+  XbmcThreads::ConditionVariable m_readerCondition;
+  XbmcThreads::ConditionVariable m_encoderCondition;
+};
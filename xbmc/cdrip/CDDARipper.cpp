@@ -36,6 +36,9 @@
 #include "utils/Variant.h"
 #include "utils/log.h"
 
+#include <utility>
+#include <vector>
+
 using namespace ADDON;
 using namespace XFILE;
 using namespace MUSIC_INFO;
@@ -115,8 +118,8 @@ bool CCDDARipper::RipCD()
   if (!CreateAlbumDir(*vecItems[0]->GetMusicInfoTag(), strDirectory, legalType))
     return false;
 
-  // rip all tracks one by one
-  const std::shared_ptr<CSettings> settings = CServiceBroker::GetSettingsComponent()->GetSettings();
+  // rip all tracks in one job, so reading the disc and encoding the tracks can overlap
+  std::vector<CDDARipTrack> tracks;
   for (int i = 0; i < vecItems.Size(); i++)
   {
     CFileItemPtr item = vecItems[i];
@@ -128,12 +131,16 @@ bool CCDDARipper::RipCD()
     if (item->GetPath().find(".cdda") == std::string::npos)
       continue;
 
-    bool eject = settings->GetBool(CSettings::SETTING_AUDIOCDS_EJECTONRIP) && i == vecItems.Size()-1;
-    AddJob(new CCDDARipJob(item->GetPath(),strFile,
-                           *item->GetMusicInfoTag(),
-                           settings->GetInt(CSettings::SETTING_AUDIOCDS_ENCODER), eject));
+    tracks.push_back({item->GetPath(), strFile, *item->GetMusicInfoTag()});
   }
 
+  if (tracks.empty())
+    return false;
+
+  const std::shared_ptr<CSettings> settings = CServiceBroker::GetSettingsComponent()->GetSettings();
+  AddJob(new CCDDARipJob(std::move(tracks), settings->GetInt(CSettings::SETTING_AUDIOCDS_ENCODER),
+                         settings->GetBool(CSettings::SETTING_AUDIOCDS_EJECTONRIP)));
+
   return true;
 }
 
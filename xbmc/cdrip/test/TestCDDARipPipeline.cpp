@@ -0,0 +1,248 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cdrip/CDDARipPipeline.h"
+#include "cdrip/Encoder.h"
+#include "cdrip/IEncoder.h"
+#include "filesystem/File.h"
+#include "test/TestUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace XFILE;
+
+namespace
+{
+// One second of CD audio
+constexpr size_t SECOND = 44100 * 2 * 2;
+
+//! Stand-in for an encoder add-on, writes its input unchanged and can be
+//! made slower or fail after a number of bytes
+class CPassthroughEncoder : public IEncoder
+{
+public:
+  CPassthroughEncoder(std::chrono::microseconds delayPerChunk, int64_t failAfter)
+    : m_delayPerChunk(delayPerChunk), m_failAfter(failAfter)
+  {
+  }
+
+  bool Init(AddonToKodiFuncTable_AudioEncoder& callbacks) override
+  {
+    m_callbacks = callbacks;
+    return true;
+  }
+
+  int Encode(int nNumBytesRead, uint8_t* pbtStream) override
+  {
+    m_encoded += nNumBytesRead;
+    if (m_failAfter >= 0 && m_encoded > m_failAfter)
+      return -1;
+
+    if (m_delayPerChunk.count() > 0)
+      std::this_thread::sleep_for(m_delayPerChunk);
+
+    return m_callbacks.write(m_callbacks.kodiInstance, pbtStream, nNumBytesRead);
+  }
+
+  bool Close() override { return true; }
+
+private:
+  const std::chrono::microseconds m_delayPerChunk;
+  const int64_t m_failAfter;
+  AddonToKodiFuncTable_AudioEncoder m_callbacks{};
+  int64_t m_encoded = 0;
+};
+
+class TestCDDARipPipeline : public ::testing::Test
+{
+protected:
+  ~TestCDDARipPipeline() override
+  {
+    for (const CDDARipTrack& track : m_tracks)
+      CFile::Delete(track.output);
+    for (CFile* file : m_images)
+      XBMC_DELETETEMPFILE(file);
+  }
+
+  // Create images of the tracks of a disc, filled with a different pattern each
+  void CreateDisc(const std::vector<size_t>& sizes)
+  {
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+      CFile* file = XBMC_CREATETEMPFILE(".cdda");
+      ASSERT_NE(file, nullptr);
+      std::vector<uint8_t> data(sizes[i]);
+      for (size_t n = 0; n < data.size(); ++n)
+        data[n] = static_cast<uint8_t>(n * (i + 1));
+      ASSERT_EQ(file->Write(data.data(), data.size()), static_cast<ssize_t>(data.size()));
+      file->Flush();
+      m_images.push_back(file);
+
+      const std::string path = XBMC_TEMPFILEPATH(file);
+      m_tracks.push_back({path, path + ".out", {}});
+    }
+  }
+
+  CCDDARipPipeline::EncoderFactory MakeFactory(std::chrono::microseconds delayPerChunk =
+                                                   std::chrono::microseconds(0),
+                                               size_t failingTrack = std::string::npos,
+                                               int64_t failAfter = -1)
+  {
+    return [this, delayPerChunk, failingTrack, failAfter](const CDDARipTrack& track,
+                                                          int64_t length) {
+      m_lengths += length;
+      const bool failing = failingTrack < m_tracks.size() &&
+                           track.input == m_tracks[failingTrack].input;
+      std::unique_ptr<CEncoder> encoder(new CEncoder(
+          std::make_shared<CPassthroughEncoder>(delayPerChunk, failing ? failAfter : -1)));
+      if (!encoder->Init(track.output.c_str(), 2, 44100, 16))
+        encoder.reset();
+      return encoder;
+    };
+  }
+
+  bool OutputMatchesInput(size_t track)
+  {
+    CFile input;
+    CFile output;
+    if (!input.Open(m_tracks[track].input) || !output.Open(m_tracks[track].output))
+      return false;
+
+    if (input.GetLength() != output.GetLength())
+      return false;
+
+    std::vector<uint8_t> in(CCDDARipPipeline::CHUNK_SIZE);
+    std::vector<uint8_t> out(CCDDARipPipeline::CHUNK_SIZE);
+    while (true)
+    {
+      const ssize_t read = input.Read(in.data(), in.size());
+      if (read <= 0)
+        return read == 0;
+      if (output.Read(out.data(), read) != read ||
+          !std::equal(in.begin(), in.begin() + read, out.begin()))
+        return false;
+    }
+  }
+
+  std::vector<CFile*> m_images;
+  std::vector<CDDARipTrack> m_tracks;
+  std::atomic<int64_t> m_lengths{0};
+};
+} // namespace
+
+TEST_F(TestCDDARipPipeline, RipsAllTracks)
+{
+  CreateDisc({3 * SECOND, SECOND / 3, 2 * SECOND + 17, CCDDARipPipeline::CHUNK_SIZE, 0, SECOND});
+
+  CCDDARipPipeline pipeline(MakeFactory(), 3);
+  int lastPercent = 0;
+  ASSERT_TRUE(pipeline.Rip(m_tracks, [&lastPercent](size_t track, int percent) {
+    EXPECT_GE(percent, lastPercent);
+    lastPercent = percent;
+    return true;
+  }));
+
+  int64_t total = 0;
+  for (size_t i = 0; i < m_tracks.size(); ++i)
+  {
+    EXPECT_EQ(pipeline.GetResult(i), CCDDARipPipeline::TrackResult::OK);
+    EXPECT_TRUE(OutputMatchesInput(i)) << "track " << i;
+    total += m_images[i]->GetLength();
+  }
+  EXPECT_EQ(m_lengths, total);
+  EXPECT_GT(pipeline.GetTracksPerMinute(), 0.0);
+}
+
+TEST_F(TestCDDARipPipeline, BoundedBuffer)
+{
+  CreateDisc({4 * SECOND, 4 * SECOND, 4 * SECOND});
+
+  const size_t bufferSize = 4 * CCDDARipPipeline::CHUNK_SIZE;
+  CCDDARipPipeline pipeline(MakeFactory(std::chrono::microseconds(500)), 2, bufferSize);
+  ASSERT_TRUE(pipeline.Rip(m_tracks, nullptr));
+
+  EXPECT_GT(pipeline.GetMaxBuffered(), 0u);
+  EXPECT_LE(pipeline.GetMaxBuffered(), bufferSize);
+  for (size_t i = 0; i < m_tracks.size(); ++i)
+    EXPECT_TRUE(OutputMatchesInput(i)) << "track " << i;
+}
+
+TEST_F(TestCDDARipPipeline, EncodeFailureStopsRip)
+{
+  CreateDisc({2 * SECOND, 2 * SECOND, 2 * SECOND, 2 * SECOND});
+
+  // Encoding is slow enough for the drive to stop before the last track
+  CCDDARipPipeline pipeline(MakeFactory(std::chrono::microseconds(2000), 1, SECOND), 1);
+  EXPECT_FALSE(pipeline.Rip(m_tracks, nullptr));
+
+  EXPECT_EQ(pipeline.GetResult(0), CCDDARipPipeline::TrackResult::OK);
+  EXPECT_EQ(pipeline.GetResult(1), CCDDARipPipeline::TrackResult::ENCODE_FAILED);
+  EXPECT_EQ(pipeline.GetResult(3), CCDDARipPipeline::TrackResult::NONE);
+  EXPECT_TRUE(OutputMatchesInput(0));
+  EXPECT_FALSE(CFile::Exists(m_tracks[1].output));
+  EXPECT_FALSE(CFile::Exists(m_tracks[3].output));
+}
+
+TEST_F(TestCDDARipPipeline, MissingInput)
+{
+  CreateDisc({SECOND, SECOND});
+  m_tracks[1].input += ".missing";
+
+  CCDDARipPipeline pipeline(MakeFactory(), 2);
+  EXPECT_FALSE(pipeline.Rip(m_tracks, nullptr));
+
+  EXPECT_EQ(pipeline.GetResult(0), CCDDARipPipeline::TrackResult::OK);
+  EXPECT_EQ(pipeline.GetResult(1), CCDDARipPipeline::TrackResult::READ_FAILED);
+}
+
+TEST_F(TestCDDARipPipeline, Cancel)
+{
+  CreateDisc({4 * SECOND, 4 * SECOND, 4 * SECOND});
+
+  // The small buffer keeps the drive from reading ahead of the encoders, tracks
+  // that were read completely before cancelling would still be finished
+  CCDDARipPipeline pipeline(MakeFactory(std::chrono::microseconds(1000)), 2,
+                            2 * CCDDARipPipeline::CHUNK_SIZE);
+  EXPECT_FALSE(pipeline.Rip(m_tracks, [](size_t track, int percent) { return percent == 0; }));
+
+  for (size_t i = 0; i < m_tracks.size(); ++i)
+  {
+    EXPECT_NE(pipeline.GetResult(i), CCDDARipPipeline::TrackResult::OK);
+    EXPECT_FALSE(CFile::Exists(m_tracks[i].output)) << "track " << i;
+  }
+}
+
+TEST_F(TestCDDARipPipeline, DISABLED_Benchmark)
+{
+  // Eight tracks with an encoder that is much slower than reading the image
+  CreateDisc(std::vector<size_t>(8, 2 * SECOND));
+  const auto delay = std::chrono::microseconds(5000);
+
+  CCDDARipPipeline serial(MakeFactory(delay), 1);
+  ASSERT_TRUE(serial.Rip(m_tracks, nullptr));
+
+  CCDDARipPipeline parallel(MakeFactory(delay), 4);
+  ASSERT_TRUE(parallel.Rip(m_tracks, nullptr));
+
+  std::cout << "1 encoder: " << serial.GetTracksPerMinute() << " tracks per minute" << std::endl;
+  std::cout << "4 encoders: " << parallel.GetTracksPerMinute() << " tracks per minute"
+            << std::endl;
+  RecordProperty("serial_tracks_per_minute", static_cast<int>(serial.GetTracksPerMinute()));
+  RecordProperty("parallel_tracks_per_minute", static_cast<int>(parallel.GetTracksPerMinute()));
+
+  EXPECT_GT(parallel.GetTracksPerMinute(), serial.GetTracksPerMinute() * 1.5);
+}
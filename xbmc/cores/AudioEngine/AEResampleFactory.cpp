@@ -8,13 +8,39 @@
 
 #include "AEResampleFactory.h"
 #include "cores/AudioEngine/Engines/ActiveAE/ActiveAEResampleFFMPEG.h"
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAEResamplePolyphase.h"
+
+#include <atomic>
 
 namespace ActiveAE
 {
 
+namespace
+{
+std::atomic<AEResampleEngine> resampleEngine{AEResampleEngine::FFMPEG};
+}
+
 IAEResample *CAEResampleFactory::Create(uint32_t flags /* = 0 */)
 {
+  if (flags & AERESAMPLEFACTORY_POLYPHASE)
+    return new CActiveAEResamplePolyphase();
+
+  // quick jobs are not worth building a filter bank for
+  if ((flags & (AERESAMPLEFACTORY_FFMPEG | AERESAMPLEFACTORY_QUICK_RESAMPLE)) == 0 &&
+      GetEngine() == AEResampleEngine::POLYPHASE)
+    return new CActiveAEResamplePolyphase();
+
   return new CActiveAEResampleFFMPEG();
 }
 
+void CAEResampleFactory::SetEngine(AEResampleEngine engine)
+{
+  resampleEngine = engine;
+}
+
+AEResampleEngine CAEResampleFactory::GetEngine()
+{
+  return resampleEngine;
+}
+
 }
@@ -21,13 +21,29 @@ namespace ActiveAE
 enum AEResampleFactoryOptions
 {
   /* This is a quick resample job (e.g. resample a single noise packet) and may not be worth using GPU acceleration */
-  AERESAMPLEFACTORY_QUICK_RESAMPLE = 0x01
+  AERESAMPLEFACTORY_QUICK_RESAMPLE = 0x01,
+  /* Use swresample regardless of the configured engine */
+  AERESAMPLEFACTORY_FFMPEG = 0x02,
+  /* Use the native polyphase resampler regardless of the configured engine */
+  AERESAMPLEFACTORY_POLYPHASE = 0x04
+};
+
+/**
+ * Resampler implementation created by default
+ */
+enum class AEResampleEngine
+{
+  FFMPEG,
+  POLYPHASE
 };
 
 class CAEResampleFactory
 {
 public:
   static IAEResample *Create(uint32_t flags = 0U);
+
+  static void SetEngine(AEResampleEngine engine);
+  static AEResampleEngine GetEngine();
 };
 
 }
@@ -21,14 +21,27 @@ using namespace ActiveAE;
 #include "cores/AudioEngine/AEResampleFactory.h"
 #include "cores/AudioEngine/Encoders/AEEncoderFFmpeg.h"
 
+#include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "settings/SettingsComponent.h"
 #include "windowing/WinSystem.h"
 #include "utils/log.h"
 
+#include <algorithm>
+
 #define MAX_CACHE_LEVEL 0.4   // total cache time of stream in seconds
 #define MAX_WATER_LEVEL 0.2   // buffered time after stream stages in seconds
 #define MAX_BUFFER_TIME 0.1   // max time of a buffer in seconds
+#define LOW_LATENCY_TARGET 0.04 // output latency of low latency mode in seconds
+
+namespace
+{
+const AELatencyLevels DEFAULT_LEVELS = {MAX_CACHE_LEVEL, MAX_WATER_LEVEL, MAX_BUFFER_TIME};
+
+// a quarter of the target for each engine stage, the sink keeps about four periods
+const AELatencyLevels LOW_LATENCY_LEVELS = {LOW_LATENCY_TARGET / 4, LOW_LATENCY_TARGET / 4,
+                                            LOW_LATENCY_TARGET / 8};
+} // namespace
 
 void CEngineStats::Reset(unsigned int sampleRate, bool pcm)
 {
@@ -205,13 +218,26 @@ float CEngineStats::GetCacheTime(CActiveAEStream *stream)
 
 float CEngineStats::GetCacheTotal()
 {
-  return MAX_CACHE_LEVEL;
+  CSingleLock lock(m_lock);
+  return m_levels.cacheLevel;
+}
+
+float CEngineStats::GetMaxDelay()
+{
+  CSingleLock lock(m_lock);
+  return m_levels.cacheLevel + m_levels.waterLevel + m_sinkCacheTotal;
+}
+
+void CEngineStats::SetSinkCacheTotal(float time)
+{
+  CSingleLock lock(m_lock);
+  m_sinkCacheTotal = time;
 }
 
-float CEngineStats::GetMaxDelay() const
+void CEngineStats::SetLatencyLevels(const AELatencyLevels& levels)
 {
-  return static_cast<float>(MAX_CACHE_LEVEL) + static_cast<float>(MAX_WATER_LEVEL) +
-         m_sinkCacheTotal;
+  CSingleLock lock(m_lock);
+  m_levels = levels;
 }
 
 float CEngineStats::GetWaterLevel()
@@ -266,9 +292,12 @@ CActiveAE::CActiveAE() :
   m_mode = MODE_PCM;
   m_encoder = NULL;
   m_vizInitialized = false;
+  m_vizAnalyze = false;
   m_sinkHasVolume = false;
   m_aeGUISoundForce = false;
   m_stats.Reset(44100, true);
+  m_levels = DEFAULT_LEVELS;
+  m_stats.SetLatencyLevels(m_levels);
   m_streamIdGen = 0;
 
   m_settingsHandler.reset(new CActiveAESettings(*this));
@@ -814,6 +843,11 @@ void CActiveAE::StateMachine(int signal, Protocol *port, Message *msg)
             }
             m_extDrain = true;
           }
+          // leave low latency mode when the last interactive stream is gone
+          else if (m_lowLatency && !HasLowLatencyStream())
+          {
+            Configure();
+          }
           m_extTimeout = 0;
           m_state = AE_TOP_CONFIGURED_PLAY;
           return;
@@ -1155,6 +1189,12 @@ AEAudioFormat CActiveAE::GetInputFormat(AEAudioFormat *desiredFmt)
   return inputFormat;
 }
 
+bool CActiveAE::HasLowLatencyStream() const
+{
+  return std::any_of(m_streams.begin(), m_streams.end(),
+                     [](const CActiveAEStream* stream) { return stream->m_lowLatency; });
+}
+
 void CActiveAE::Configure(AEAudioFormat *desiredFmt)
 {
   bool initSink = false;
@@ -1165,16 +1205,37 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
 
   inputFormat = GetInputFormat(desiredFmt);
 
+  // streams of interactive players like games ask for low latency, this shrinks all buffers
+  const bool lowLatency = HasLowLatencyStream();
+  const bool latencyChanged = lowLatency != m_lowLatency;
+  if (latencyChanged)
+  {
+    CLog::Log(LOGINFO, "ActiveAE::{} - low latency mode {}", __FUNCTION__,
+              lowLatency ? "enabled" : "disabled");
+    m_lowLatency = lowLatency;
+    m_levels = m_lowLatency ? LOW_LATENCY_LEVELS : DEFAULT_LEVELS;
+    m_stats.SetLatencyLevels(m_levels);
+  }
+
   m_sinkRequestFormat = inputFormat;
   ApplySettingsToFormat(m_sinkRequestFormat, m_settings, (int*)&m_mode);
   m_extKeepConfig = 0;
 
+  // ask the sink for a period that fits the latency target
+  if (m_sinkRequestFormat.m_dataFormat != AE_FMT_RAW)
+  {
+    m_sinkRequestFormat.m_frames =
+        m_lowLatency ? static_cast<unsigned int>(m_levels.bufferTime * m_sinkRequestFormat.m_sampleRate)
+                     : 0;
+  }
+
   std::string device = (m_sinkRequestFormat.m_dataFormat == AE_FMT_RAW) ? m_settings.passthroughdevice : m_settings.device;
   std::string driver;
   CAESinkFactory::ParseDevice(device, driver);
   if ((!CompareFormat(m_sinkRequestFormat, m_sinkFormat) && !CompareFormat(m_sinkRequestFormat, oldSinkRequestFormat)) ||
       m_currDevice.compare(device) != 0 ||
-      m_settings.driver.compare(driver) != 0)
+      m_settings.driver.compare(driver) != 0 ||
+      latencyChanged)
   {
     FlushEngine();
     if (!InitSink())
@@ -1189,12 +1250,12 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
     {
       // limit buffer size in case of sink returns large buffer
       double buffertime = (double)m_sinkFormat.m_frames / m_sinkFormat.m_sampleRate;
-      if (buffertime > MAX_BUFFER_TIME)
+      if (buffertime > m_levels.bufferTime)
       {
         CLog::Log(LOGWARNING,
                   "ActiveAE::{} - sink returned large buffer of {} ms, reducing to {} ms",
-                  __FUNCTION__, (int)(buffertime * 1000), (int)(MAX_BUFFER_TIME * 1000));
-        m_sinkFormat.m_frames = MAX_BUFFER_TIME * m_sinkFormat.m_sampleRate;
+                  __FUNCTION__, (int)(buffertime * 1000), (int)(m_levels.bufferTime * 1000));
+        m_sinkFormat.m_frames = m_levels.bufferTime * m_sinkFormat.m_sampleRate;
       }
     }
   }
@@ -1218,7 +1279,7 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
     inputFormat.m_frameSize = inputFormat.m_channelLayout.Count() *
                               (CAEUtil::DataFormatToBits(inputFormat.m_dataFormat) >> 3);
     m_silenceBuffers = new CActiveAEBufferPool(inputFormat);
-    m_silenceBuffers->Create(MAX_WATER_LEVEL*1000);
+    m_silenceBuffers->Create(m_levels.waterLevel*1000);
     sinkInputFormat = inputFormat;
     m_internalFormat = inputFormat;
 
@@ -1298,7 +1359,7 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
         if (!m_encoderBuffers)
         {
           m_encoderBuffers = new CActiveAEBufferPool(format);
-          m_encoderBuffers->Create(MAX_WATER_LEVEL*1000);
+          m_encoderBuffers->Create(m_levels.waterLevel*1000);
         }
       }
 
@@ -1340,7 +1401,7 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
 
         // create buffer pool
         (*it)->m_inputBuffers = new CActiveAEBufferPool((*it)->m_format);
-        (*it)->m_inputBuffers->Create(MAX_CACHE_LEVEL*1000);
+        (*it)->m_inputBuffers->Create(m_levels.cacheLevel*1000);
         (*it)->m_streamSpace = (*it)->m_format.m_frameSize * (*it)->m_format.m_frames;
 
         // if input format does not follow ffmpeg channel mask, we may need to remap channels
@@ -1359,7 +1420,7 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
         (*it)->m_processingBuffers = new CActiveAEStreamBuffers((*it)->m_inputBuffers->m_format, outputFormat, m_settings.resampleQuality);
         (*it)->m_processingBuffers->ForceResampler((*it)->m_forceResampler);
 
-        (*it)->m_processingBuffers->Create(MAX_CACHE_LEVEL*1000, false, m_settings.stereoupmix, m_settings.normalizelevels);
+        (*it)->m_processingBuffers->Create(m_levels.cacheLevel*1000, false, m_settings.stereoupmix, m_settings.normalizelevels);
       }
       if (m_mode == MODE_TRANSCODE || m_streams.size() > 1)
         (*it)->m_processingBuffers->FillBuffer();
@@ -1381,7 +1442,7 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
         m_discardBufferPools.push_back(m_vizBuffersInput);
         m_vizBuffersInput = NULL;
       }
-      if (!m_vizBuffers && !m_audioCallback.empty())
+      if (!m_vizBuffers && (!m_audioCallback.empty() || m_vizAnalyze))
       {
         AEAudioFormat vizFormat = m_internalFormat;
         vizFormat.m_channelLayout = AE_CH_LAYOUT_2_0;
@@ -1420,7 +1481,7 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
   if (!m_sinkBuffers)
   {
     m_sinkBuffers = new CActiveAEBufferPoolResample(sinkInputFormat, m_sinkFormat, m_settings.resampleQuality);
-    m_sinkBuffers->Create(MAX_WATER_LEVEL*1000, true, false);
+    m_sinkBuffers->Create(m_levels.waterLevel*1000, true, false);
   }
 
   // reset gui sounds
@@ -1485,6 +1546,9 @@ CActiveAEStream* CActiveAE::CreateStream(MsgStreamNew *streamMsg)
   if (streamMsg->options & AESTREAM_FORCE_RESAMPLE)
     stream->m_forceResampler = true;
 
+  if (streamMsg->options & AESTREAM_LOW_LATENCY)
+    stream->m_lowLatency = true;
+
   stream->m_pClock = streamMsg->clock;
 
   m_streams.push_back(stream);
@@ -1911,7 +1975,7 @@ bool CActiveAE::RunStages()
       float buftime = (float)(*it)->m_inputBuffers->m_format.m_frames / (*it)->m_inputBuffers->m_format.m_sampleRate;
       if ((*it)->m_inputBuffers->m_format.m_dataFormat == AE_FMT_RAW)
         buftime = (*it)->m_inputBuffers->m_format.m_streamInfo.GetDuration() / 1000;
-      while ((time < static_cast<float>(MAX_CACHE_LEVEL) || (*it)->m_streamIsBuffering) &&
+      while ((time < m_levels.cacheLevel || (*it)->m_streamIsBuffering) &&
              !(*it)->m_inputBuffers->m_freeSamples.empty())
       {
         buffer = (*it)->m_inputBuffers->GetFreeBuffer();
@@ -1951,7 +2015,7 @@ bool CActiveAE::RunStages()
     }
   }
 
-  if (m_stats.GetWaterLevel() < static_cast<float>(MAX_WATER_LEVEL) &&
+  if (m_stats.GetWaterLevel() < m_levels.waterLevel &&
       (m_mode != MODE_TRANSCODE || (m_encoderBuffers && !m_encoderBuffers->m_freeSamples.empty())))
   {
     // calculate sync error
@@ -2213,13 +2277,21 @@ bool CActiveAE::RunStages()
         // viz
         {
           CSingleLock lock(m_vizLock);
-          if (!m_audioCallback.empty() && !m_streams.empty())
+          const bool analyze = m_spectrumAnalyzer.IsActive();
+          if (analyze != m_vizAnalyze)
+          {
+            m_vizAnalyze = analyze;
+            m_vizInitialized = false;
+          }
+          if ((!m_audioCallback.empty() || m_vizAnalyze) && !m_streams.empty())
           {
             if (!m_vizInitialized || !m_vizBuffers)
             {
               Configure();
               for (auto& it : m_audioCallback)
                 it->OnInitialize(2, m_vizBuffers->m_format.m_sampleRate, 32);
+              if (m_vizAnalyze)
+                m_spectrumAnalyzer.OnInitialize(2, m_vizBuffers->m_format.m_sampleRate, 32);
               m_vizInitialized = true;
             }
 
@@ -2254,6 +2326,8 @@ bool CActiveAE::RunStages()
                                        buf->pkt->config.channels / buf->pkt->planes;
                 for (auto& it : m_audioCallback)
                   it->OnAudioData((float*)(buf->pkt->data[0]), samples);
+                if (m_vizAnalyze)
+                  m_spectrumAnalyzer.OnAudioData((float*)(buf->pkt->data[0]), samples);
                 buf->Return();
                 m_vizBuffers->m_outputSamples.pop_front();
               }
@@ -2651,6 +2725,11 @@ void CActiveAE::LoadSettings()
   m_settings.atempoThreshold = settings->GetInt(CSettings::SETTING_AUDIOOUTPUT_ATEMPOTHRESHOLD) / 100.0;
   m_settings.streamNoise = settings->GetBool(CSettings::SETTING_AUDIOOUTPUT_STREAMNOISE);
   m_settings.silenceTimeout = settings->GetInt(CSettings::SETTING_AUDIOOUTPUT_STREAMSILENCE) * 60000;
+
+  const std::string resampler =
+      CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_audioResampler;
+  CAEResampleFactory::SetEngine(resampler == "polyphase" ? AEResampleEngine::POLYPHASE
+                                                         : AEResampleEngine::FFMPEG);
 }
 
 void CActiveAE::Start()
@@ -3457,3 +3536,18 @@ void CActiveAE::UnregisterAudioCallback(IAudioCallback* pCallback)
   if (it != m_audioCallback.end())
     m_audioCallback.erase(it);
 }
+
+void CActiveAE::RegisterSpectrumCallback(IAudioSpectrumCallback* pCallback)
+{
+  m_spectrumAnalyzer.RegisterCallback(pCallback);
+}
+
+void CActiveAE::UnregisterSpectrumCallback(IAudioSpectrumCallback* pCallback)
+{
+  m_spectrumAnalyzer.UnregisterCallback(pCallback);
+}
+
+bool CActiveAE::GetAudioLevels(AEAudioLevels& levels)
+{
+  return m_spectrumAnalyzer.GetLevels(levels);
+}
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "ActiveAESink.h"
+#include "ActiveAESpectrum.h"
 #include "cores/AudioEngine/Engines/ActiveAE/ActiveAEBuffer.h"
 #include "cores/AudioEngine/Interfaces/AESound.h"
 #include "cores/AudioEngine/Interfaces/AEStream.h"
@@ -39,6 +40,16 @@ class CActiveAESound;
 class CActiveAEStream;
 class CActiveAESettings;
 
+/*!
+ * \brief Buffer levels of the engine in seconds.
+ */
+struct AELatencyLevels
+{
+  float cacheLevel; //!< total cache time of a stream
+  float waterLevel; //!< buffered time after stream stages
+  float bufferTime; //!< max time of a buffer, i.e. the period of the sink
+};
+
 struct AudioSettings
 {
   std::string device;
@@ -188,17 +199,19 @@ public:
   void GetSyncInfo(CAESyncInfo& info, CActiveAEStream *stream);
   float GetCacheTime(CActiveAEStream *stream);
   float GetCacheTotal();
-  float GetMaxDelay() const;
+  float GetMaxDelay();
   float GetWaterLevel();
   void SetSuspended(bool state);
   void SetCurrentSinkFormat(const AEAudioFormat& SinkFormat);
-  void SetSinkCacheTotal(float time) { m_sinkCacheTotal = time; }
+  void SetSinkCacheTotal(float time);
   void SetSinkLatency(float time) { m_sinkLatency = time; }
+  void SetLatencyLevels(const AELatencyLevels& levels);
   bool IsSuspended();
   AEAudioFormat GetCurrentSinkFormat();
 protected:
   float m_sinkCacheTotal;
   float m_sinkLatency;
+  AELatencyLevels m_levels;
   int m_bufferedSamples;
   unsigned int m_sinkSampleRate;
   AEDelayStatus m_sinkDelay;
@@ -264,6 +277,9 @@ public:
 
   void RegisterAudioCallback(IAudioCallback* pCallback) override;
   void UnregisterAudioCallback(IAudioCallback* pCallback) override;
+  void RegisterSpectrumCallback(IAudioSpectrumCallback* pCallback) override;
+  void UnregisterSpectrumCallback(IAudioSpectrumCallback* pCallback) override;
+  bool GetAudioLevels(AEAudioLevels& levels) override;
 
   void OnLostDisplay() override;
   void OnResetDisplay() override;
@@ -301,6 +317,7 @@ protected:
   bool NeedReconfigureSink();
   void ApplySettingsToFormat(AEAudioFormat &format, AudioSettings &settings, int *mode = NULL);
   void Configure(AEAudioFormat *desiredFmt = NULL);
+  bool HasLowLatencyStream() const;
   AEAudioFormat GetInputFormat(AEAudioFormat *desiredFmt = NULL);
   CActiveAEStream* CreateStream(MsgStreamNew *streamMsg);
   void DiscardStream(CActiveAEStream *stream);
@@ -353,6 +370,8 @@ protected:
   AEAudioFormat m_inputFormat;
   AudioSettings m_settings;
   CEngineStats m_stats;
+  AELatencyLevels m_levels;
+  bool m_lowLatency = false;
   IAEEncoder *m_encoder;
   std::string m_currDevice;
   std::unique_ptr<CActiveAESettings> m_settingsHandler;
@@ -386,7 +405,9 @@ protected:
   // viz
   std::vector<IAudioCallback*> m_audioCallback;
   bool m_vizInitialized;
+  bool m_vizAnalyze; // feed the spectrum analyzer
   CCriticalSection m_vizLock;
+  CActiveAESpectrumAnalyzer m_spectrumAnalyzer;
 
   // polled via the interface
   float m_aeVolume;
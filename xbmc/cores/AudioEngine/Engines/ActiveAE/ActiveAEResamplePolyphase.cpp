@@ -0,0 +1,721 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "ActiveAEResamplePolyphase.h"
+
+#include "ServiceBroker.h"
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAEResampleFFMPEG.h"
+#include "utils/CPUInfo.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define POLYPHASE_X86
+#include <immintrin.h>
+#if defined(__GNUC__)
+#define POLYPHASE_TARGET_SSE2 __attribute__((target("sse2")))
+#define POLYPHASE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define POLYPHASE_TARGET_SSE2
+#define POLYPHASE_TARGET_AVX2
+#endif
+#elif defined(__aarch64__) || (defined(__arm__) && defined(HAS_NEON))
+#define POLYPHASE_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace ActiveAE;
+
+namespace
+{
+// sub-sample positions of the filter bank, positions in between are interpolated linearly
+constexpr int PHASES = 256;
+
+// all kernels work on blocks of 8 taps
+constexpr int TAP_ALIGN = 8;
+constexpr int MAX_TAPS = 1024;
+
+struct FilterQuality
+{
+  int taps; //!< filter length when upsampling, grows with the downsampling factor
+  double beta; //!< kaiser window shape, trades stopband attenuation for transition width
+  double cutoff; //!< relative to the lower nyquist frequency of source and destination
+};
+
+FilterQuality GetFilterQuality(AEQuality quality)
+{
+  switch (quality)
+  {
+    case AE_QUALITY_LOW:
+      return {16, 5.0, 0.80};
+    case AE_QUALITY_HIGH:
+      return {64, 9.0, 0.93};
+    case AE_QUALITY_REALLYHIGH:
+      return {128, 10.0, 0.96};
+    case AE_QUALITY_MID:
+    default:
+      return {32, 7.0, 0.88};
+  }
+}
+
+double BesselI0(double x)
+{
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; k < 50; k++)
+  {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if (term < sum * 1e-12)
+      break;
+  }
+  return sum;
+}
+
+struct KernelSet
+{
+  CActiveAEResamplePolyphase::Kernel kernel;
+  void (*interpolate)(float* dst, const float* h0, const float* h1, float a, int taps);
+  float (*dot)(const float* h, const float* x, int taps);
+};
+
+//------------------------------------------------------------------------------
+// C
+//------------------------------------------------------------------------------
+
+void InterpolateC(float* dst, const float* h0, const float* h1, float a, int taps)
+{
+  for (int k = 0; k < taps; k++)
+    dst[k] = h0[k] + a * (h1[k] - h0[k]);
+}
+
+float DotC(const float* h, const float* x, int taps)
+{
+  float sum[4] = {};
+  for (int k = 0; k < taps; k += 4)
+  {
+    sum[0] += h[k] * x[k];
+    sum[1] += h[k + 1] * x[k + 1];
+    sum[2] += h[k + 2] * x[k + 2];
+    sum[3] += h[k + 3] * x[k + 3];
+  }
+  return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+constexpr KernelSet KERNELS_C = {CActiveAEResamplePolyphase::Kernel::C, InterpolateC, DotC};
+
+#if defined(POLYPHASE_X86)
+//------------------------------------------------------------------------------
+// SSE2
+//------------------------------------------------------------------------------
+
+POLYPHASE_TARGET_SSE2 void InterpolateSSE2(
+    float* dst, const float* h0, const float* h1, float a, int taps)
+{
+  const __m128 va = _mm_set1_ps(a);
+  for (int k = 0; k < taps; k += 4)
+  {
+    const __m128 x0 = _mm_loadu_ps(h0 + k);
+    const __m128 x1 = _mm_loadu_ps(h1 + k);
+    _mm_storeu_ps(dst + k, _mm_add_ps(x0, _mm_mul_ps(va, _mm_sub_ps(x1, x0))));
+  }
+}
+
+POLYPHASE_TARGET_SSE2 float DotSSE2(const float* h, const float* x, int taps)
+{
+  __m128 acc0 = _mm_setzero_ps();
+  __m128 acc1 = _mm_setzero_ps();
+  for (int k = 0; k < taps; k += 8)
+  {
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(h + k), _mm_loadu_ps(x + k)));
+    acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(h + k + 4), _mm_loadu_ps(x + k + 4)));
+  }
+  __m128 sum = _mm_add_ps(acc0, acc1);
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum);
+}
+
+constexpr KernelSet KERNELS_SSE2 = {CActiveAEResamplePolyphase::Kernel::SSE2, InterpolateSSE2,
+                                    DotSSE2};
+
+//------------------------------------------------------------------------------
+// AVX2
+//------------------------------------------------------------------------------
+
+POLYPHASE_TARGET_AVX2 void InterpolateAVX2(
+    float* dst, const float* h0, const float* h1, float a, int taps)
+{
+  const __m256 va = _mm256_set1_ps(a);
+  for (int k = 0; k < taps; k += 8)
+  {
+    const __m256 y0 = _mm256_loadu_ps(h0 + k);
+    const __m256 y1 = _mm256_loadu_ps(h1 + k);
+    _mm256_storeu_ps(dst + k, _mm256_add_ps(y0, _mm256_mul_ps(va, _mm256_sub_ps(y1, y0))));
+  }
+}
+
+POLYPHASE_TARGET_AVX2 float DotAVX2(const float* h, const float* x, int taps)
+{
+  __m256 acc = _mm256_setzero_ps();
+  for (int k = 0; k < taps; k += 8)
+    acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(h + k), _mm256_loadu_ps(x + k)));
+
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum);
+}
+
+constexpr KernelSet KERNELS_AVX2 = {CActiveAEResamplePolyphase::Kernel::AVX2, InterpolateAVX2,
+                                    DotAVX2};
+#endif
+
+#if defined(POLYPHASE_NEON)
+//------------------------------------------------------------------------------
+// NEON
+//------------------------------------------------------------------------------
+
+void InterpolateNEON(float* dst, const float* h0, const float* h1, float a, int taps)
+{
+  const float32x4_t va = vdupq_n_f32(a);
+  for (int k = 0; k < taps; k += 4)
+  {
+    const float32x4_t x0 = vld1q_f32(h0 + k);
+    const float32x4_t x1 = vld1q_f32(h1 + k);
+    vst1q_f32(dst + k, vmlaq_f32(x0, va, vsubq_f32(x1, x0)));
+  }
+}
+
+float DotNEON(const float* h, const float* x, int taps)
+{
+  float32x4_t acc0 = vdupq_n_f32(0.0f);
+  float32x4_t acc1 = vdupq_n_f32(0.0f);
+  for (int k = 0; k < taps; k += 8)
+  {
+    acc0 = vmlaq_f32(acc0, vld1q_f32(h + k), vld1q_f32(x + k));
+    acc1 = vmlaq_f32(acc1, vld1q_f32(h + k + 4), vld1q_f32(x + k + 4));
+  }
+  const float32x4_t sum = vaddq_f32(acc0, acc1);
+  const float32x2_t pair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+  return vget_lane_f32(vpadd_f32(pair, pair), 0);
+}
+
+constexpr KernelSet KERNELS_NEON = {CActiveAEResamplePolyphase::Kernel::NEON, InterpolateNEON,
+                                    DotNEON};
+#endif
+
+//------------------------------------------------------------------------------
+// Dispatch
+//------------------------------------------------------------------------------
+
+const KernelSet* GetKernelSet(CActiveAEResamplePolyphase::Kernel kernel)
+{
+  switch (kernel)
+  {
+#if defined(POLYPHASE_X86)
+    case CActiveAEResamplePolyphase::Kernel::SSE2:
+      return &KERNELS_SSE2;
+    case CActiveAEResamplePolyphase::Kernel::AVX2:
+      return &KERNELS_AVX2;
+#endif
+#if defined(POLYPHASE_NEON)
+    case CActiveAEResamplePolyphase::Kernel::NEON:
+      return &KERNELS_NEON;
+#endif
+    case CActiveAEResamplePolyphase::Kernel::C:
+      return &KERNELS_C;
+    default:
+      return nullptr;
+  }
+}
+
+unsigned int GetCPUFeatures()
+{
+  std::shared_ptr<CCPUInfo> cpuInfo = CServiceBroker::GetCPUInfo();
+  if (!cpuInfo)
+    cpuInfo = CCPUInfo::GetCPUInfo();
+
+  return cpuInfo ? cpuInfo->GetCPUFeatures() : 0;
+}
+
+const KernelSet* SelectBest()
+{
+  using Kernel = CActiveAEResamplePolyphase::Kernel;
+  for (Kernel kernel : {Kernel::AVX2, Kernel::SSE2, Kernel::NEON})
+  {
+    if (CActiveAEResamplePolyphase::IsSupported(kernel))
+      return GetKernelSet(kernel);
+  }
+  return &KERNELS_C;
+}
+
+std::atomic<const KernelSet*> activeKernels{nullptr};
+
+const KernelSet& Kernels()
+{
+  const KernelSet* kernels = activeKernels.load(std::memory_order_acquire);
+  if (!kernels)
+  {
+    // selecting twice from concurrent first calls is harmless
+    kernels = SelectBest();
+    activeKernels.store(kernels, std::memory_order_release);
+  }
+  return *kernels;
+}
+
+bool IsNativeSrcFormat(AVSampleFormat fmt)
+{
+  switch (fmt)
+  {
+    case AV_SAMPLE_FMT_S16:
+    case AV_SAMPLE_FMT_S16P:
+    case AV_SAMPLE_FMT_S32:
+    case AV_SAMPLE_FMT_S32P:
+    case AV_SAMPLE_FMT_FLT:
+    case AV_SAMPLE_FMT_FLTP:
+    case AV_SAMPLE_FMT_DBL:
+    case AV_SAMPLE_FMT_DBLP:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsPlanar(AVSampleFormat fmt)
+{
+  return fmt == AV_SAMPLE_FMT_S16P || fmt == AV_SAMPLE_FMT_S32P || fmt == AV_SAMPLE_FMT_FLTP ||
+         fmt == AV_SAMPLE_FMT_DBLP;
+}
+
+int BytesPerSample(AVSampleFormat fmt)
+{
+  switch (fmt)
+  {
+    case AV_SAMPLE_FMT_S16:
+    case AV_SAMPLE_FMT_S16P:
+      return 2;
+    case AV_SAMPLE_FMT_DBL:
+    case AV_SAMPLE_FMT_DBLP:
+      return 8;
+    default:
+      return 4;
+  }
+}
+
+template<typename T>
+void ToFloat(std::vector<std::vector<float>>& planes,
+             uint8_t** src,
+             int samples,
+             bool planar,
+             float scale)
+{
+  const int channels = static_cast<int>(planes.size());
+  for (int ch = 0; ch < channels; ch++)
+  {
+    float* dst = planes[ch].data();
+    if (planar)
+    {
+      const T* in = reinterpret_cast<const T*>(src[ch]);
+      for (int i = 0; i < samples; i++)
+        dst[i] = static_cast<float>(in[i]) * scale;
+    }
+    else
+    {
+      const T* in = reinterpret_cast<const T*>(src[0]) + ch;
+      for (int i = 0; i < samples; i++)
+        dst[i] = static_cast<float>(in[i * channels]) * scale;
+    }
+  }
+}
+} // namespace
+
+//------------------------------------------------------------------------------
+// CPolyphaseFilter
+//------------------------------------------------------------------------------
+
+bool CPolyphaseFilter::Init(int channels, int srcRate, int dstRate, AEQuality quality)
+{
+  if (channels <= 0 || srcRate <= 0 || dstRate <= 0)
+    return false;
+
+  const FilterQuality filter = GetFilterQuality(quality);
+
+  // when downsampling the filter has to cut below the destination nyquist frequency, which takes
+  // proportionally more taps for the same transition band
+  const double scale = std::min(1.0, static_cast<double>(dstRate) / srcRate);
+  int taps = static_cast<int>(std::ceil(filter.taps / scale));
+  taps = std::min((taps + TAP_ALIGN - 1) / TAP_ALIGN * TAP_ALIGN, MAX_TAPS);
+  const double cutoff = filter.cutoff * scale;
+  const int half = taps / 2;
+
+  m_channels = channels;
+  m_taps = taps;
+  m_step = static_cast<double>(srcRate) / dstRate;
+  m_coeffs.resize(static_cast<size_t>(PHASES + 1) * taps);
+  m_kernel.resize(taps);
+
+  const double i0Beta = BesselI0(filter.beta);
+  std::vector<double> coeffs(taps);
+  for (int phase = 0; phase <= PHASES; phase++)
+  {
+    float* h = &m_coeffs[static_cast<size_t>(phase) * taps];
+    const double frac = static_cast<double>(phase) / PHASES;
+    double sum = 0.0;
+    for (int k = 0; k < taps; k++)
+    {
+      // distance of the tap from the output position in input samples
+      const double t = k - (half - 1) - frac;
+      const double x = M_PI * cutoff * t;
+      const double sinc = std::fabs(x) < 1e-9 ? 1.0 : std::sin(x) / x;
+      const double w = std::max(0.0, 1.0 - (t / half) * (t / half));
+      coeffs[k] = cutoff * sinc * BesselI0(filter.beta * std::sqrt(w)) / i0Beta;
+      sum += coeffs[k];
+    }
+    // unity gain at DC for every phase, otherwise the gain is modulated by the sub-sample position
+    for (int k = 0; k < taps; k++)
+      h[k] = static_cast<float>(coeffs[k] / sum);
+  }
+
+  m_history.assign(channels, std::vector<float>());
+  Reset();
+  return true;
+}
+
+void CPolyphaseFilter::Reset()
+{
+  // the first output frame is centered on the first input frame
+  const int half = m_taps / 2;
+  for (auto& history : m_history)
+    history.assign(half - 1, 0.0f);
+  m_index = half - 1;
+  m_frac = 0.0;
+  m_padding = 0;
+}
+
+int CPolyphaseFilter::Process(
+    float* const* dst, int dstFrames, const float* const* src, int srcFrames, double ratio)
+{
+  if (m_history.empty() || ratio <= 0.0)
+    return -1;
+
+  const int half = m_taps / 2;
+
+  if (src)
+  {
+    for (int ch = 0; ch < m_channels; ch++)
+    {
+      std::vector<float>& history = m_history[ch];
+      history.resize(history.size() - m_padding);
+      history.insert(history.end(), src[ch], src[ch] + srcFrames);
+    }
+    m_padding = 0;
+  }
+
+  const int available = static_cast<int>(m_history[0].size());
+  const int end = available - m_padding;
+
+  if (!src && end + half > available)
+  {
+    // flush: append silence so the filter can reach the last input frame
+    for (auto& history : m_history)
+      history.resize(end + half, 0.0f);
+    m_padding = half;
+  }
+
+  const int size = static_cast<int>(m_history[0].size());
+  const KernelSet& kernels = Kernels();
+  const double step = m_step / ratio;
+
+  int frames = 0;
+  while (frames < dstFrames && m_index + half < size)
+  {
+    if (m_padding > 0 && m_index + m_frac >= end)
+      break;
+
+    const double position = m_frac * PHASES;
+    const int phase = static_cast<int>(position);
+    const float* h0 = &m_coeffs[static_cast<size_t>(phase) * m_taps];
+    kernels.interpolate(m_kernel.data(), h0, h0 + m_taps, static_cast<float>(position - phase),
+                        m_taps);
+
+    const int start = m_index - half + 1;
+    for (int ch = 0; ch < m_channels; ch++)
+      dst[ch][frames] = kernels.dot(m_kernel.data(), &m_history[ch][start], m_taps);
+
+    frames++;
+    m_frac += step;
+    const int advance = static_cast<int>(m_frac);
+    m_index += advance;
+    m_frac -= advance;
+  }
+
+  // drop input that is behind the filter window
+  const int drop = std::min(m_index - half + 1, end);
+  if (drop > 0)
+  {
+    for (auto& history : m_history)
+      history.erase(history.begin(), history.begin() + drop);
+    m_index -= drop;
+  }
+
+  return frames;
+}
+
+double CPolyphaseFilter::GetBufferedFrames() const
+{
+  if (m_history.empty())
+    return 0.0;
+
+  const int end = static_cast<int>(m_history[0].size()) - m_padding;
+  return std::max(0.0, end - (m_index + m_frac));
+}
+
+//------------------------------------------------------------------------------
+// CActiveAEResamplePolyphase
+//------------------------------------------------------------------------------
+
+CActiveAEResamplePolyphase::CActiveAEResamplePolyphase() = default;
+
+CActiveAEResamplePolyphase::~CActiveAEResamplePolyphase() = default;
+
+bool CActiveAEResamplePolyphase::Init(SampleConfig dstConfig,
+                                      SampleConfig srcConfig,
+                                      bool upmix,
+                                      bool normalize,
+                                      double centerMix,
+                                      CAEChannelInfo* remapLayout,
+                                      AEQuality quality,
+                                      bool force_resample)
+{
+  m_fallback.reset();
+  m_channels = srcConfig.channels;
+  m_src_rate = srcConfig.sample_rate;
+  m_dst_rate = dstConfig.sample_rate;
+  m_src_fmt = srcConfig.fmt;
+  m_dst_fmt = dstConfig.fmt;
+
+  const bool sameLayout = srcConfig.channels == dstConfig.channels &&
+                          (srcConfig.channel_layout == dstConfig.channel_layout ||
+                           srcConfig.channel_layout == 0 || dstConfig.channel_layout == 0);
+  const bool floatOutput = m_dst_fmt == AV_SAMPLE_FMT_FLT || m_dst_fmt == AV_SAMPLE_FMT_FLTP;
+  const bool resample = m_src_rate != m_dst_rate || force_resample;
+
+  if (!remapLayout && sameLayout && floatOutput && resample && IsNativeSrcFormat(m_src_fmt))
+  {
+    if (!m_filter.Init(m_channels, m_src_rate, m_dst_rate, quality))
+    {
+      CLog::Log(LOGERROR, "CActiveAEResamplePolyphase::{} - invalid configuration", __FUNCTION__);
+      return false;
+    }
+
+    m_srcPlanes.assign(m_channels, std::vector<float>());
+    m_dstPlanes.assign(m_channels, std::vector<float>());
+
+    CLog::Log(LOGDEBUG, "CActiveAEResamplePolyphase::{} - {} Hz -> {} Hz, {} channels, {} taps, {}",
+              __FUNCTION__, m_src_rate, m_dst_rate, m_channels, m_filter.GetTaps(),
+              GetKernelName(GetKernel()));
+    return true;
+  }
+
+  // channel matrices and integer output are left to swresample
+  m_fallback = std::make_unique<CActiveAEResampleFFMPEG>();
+  return m_fallback->Init(dstConfig, srcConfig, upmix, normalize, centerMix, remapLayout, quality,
+                          force_resample);
+}
+
+bool CActiveAEResamplePolyphase::ConvertInput(uint8_t** src_buffer, int src_samples)
+{
+  for (auto& plane : m_srcPlanes)
+  {
+    if (plane.size() < static_cast<size_t>(src_samples))
+      plane.resize(src_samples);
+  }
+
+  const bool planar = IsPlanar(m_src_fmt);
+  switch (m_src_fmt)
+  {
+    case AV_SAMPLE_FMT_S16:
+    case AV_SAMPLE_FMT_S16P:
+      ToFloat<int16_t>(m_srcPlanes, src_buffer, src_samples, planar, 1.0f / 32768.0f);
+      return true;
+    case AV_SAMPLE_FMT_S32:
+    case AV_SAMPLE_FMT_S32P:
+      ToFloat<int32_t>(m_srcPlanes, src_buffer, src_samples, planar, 1.0f / 2147483648.0f);
+      return true;
+    case AV_SAMPLE_FMT_FLT:
+    case AV_SAMPLE_FMT_FLTP:
+      ToFloat<float>(m_srcPlanes, src_buffer, src_samples, planar, 1.0f);
+      return true;
+    case AV_SAMPLE_FMT_DBL:
+    case AV_SAMPLE_FMT_DBLP:
+      ToFloat<double>(m_srcPlanes, src_buffer, src_samples, planar, 1.0f);
+      return true;
+    default:
+      return false;
+  }
+}
+
+int CActiveAEResamplePolyphase::Resample(
+    uint8_t** dst_buffer, int dst_samples, uint8_t** src_buffer, int src_samples, double ratio)
+{
+  if (m_fallback)
+    return m_fallback->Resample(dst_buffer, dst_samples, src_buffer, src_samples, ratio);
+
+  const float* src[AE_CH_MAX];
+  if (src_buffer)
+  {
+    if (m_src_fmt == AV_SAMPLE_FMT_FLTP)
+    {
+      for (int ch = 0; ch < m_channels; ch++)
+        src[ch] = reinterpret_cast<const float*>(src_buffer[ch]);
+    }
+    else
+    {
+      if (!ConvertInput(src_buffer, src_samples))
+        return -1;
+      for (int ch = 0; ch < m_channels; ch++)
+        src[ch] = m_srcPlanes[ch].data();
+    }
+  }
+
+  float* dst[AE_CH_MAX];
+  const bool interleave = m_dst_fmt == AV_SAMPLE_FMT_FLT;
+  for (int ch = 0; ch < m_channels; ch++)
+  {
+    if (interleave)
+    {
+      if (m_dstPlanes[ch].size() < static_cast<size_t>(dst_samples))
+        m_dstPlanes[ch].resize(dst_samples);
+      dst[ch] = m_dstPlanes[ch].data();
+    }
+    else
+      dst[ch] = reinterpret_cast<float*>(dst_buffer[ch]);
+  }
+
+  const int frames =
+      m_filter.Process(dst, dst_samples, src_buffer ? src : nullptr, src_samples, ratio);
+  if (frames < 0)
+  {
+    CLog::Log(LOGERROR, "CActiveAEResamplePolyphase::{} - resample failed", __FUNCTION__);
+    return -1;
+  }
+
+  if (interleave)
+  {
+    float* out = reinterpret_cast<float*>(dst_buffer[0]);
+    for (int ch = 0; ch < m_channels; ch++)
+    {
+      const float* in = m_dstPlanes[ch].data();
+      for (int i = 0; i < frames; i++)
+        out[i * m_channels + ch] = in[i];
+    }
+  }
+
+  return frames;
+}
+
+int64_t CActiveAEResamplePolyphase::GetDelay(int64_t base)
+{
+  if (m_fallback)
+    return m_fallback->GetDelay(base);
+
+  return static_cast<int64_t>(std::ceil(m_filter.GetBufferedFrames() * base / m_src_rate));
+}
+
+int CActiveAEResamplePolyphase::GetBufferedSamples()
+{
+  if (m_fallback)
+    return m_fallback->GetBufferedSamples();
+
+  return static_cast<int>(std::ceil(m_filter.GetBufferedFrames() * m_dst_rate / m_src_rate));
+}
+
+int CActiveAEResamplePolyphase::CalcDstSampleCount(int src_samples, int dst_rate, int src_rate)
+{
+  return static_cast<int>((static_cast<int64_t>(src_samples) * dst_rate + src_rate - 1) /
+                          src_rate);
+}
+
+int CActiveAEResamplePolyphase::GetSrcBufferSize(int samples)
+{
+  if (m_fallback)
+    return m_fallback->GetSrcBufferSize(samples);
+
+  return samples * m_channels * BytesPerSample(m_src_fmt);
+}
+
+int CActiveAEResamplePolyphase::GetDstBufferSize(int samples)
+{
+  if (m_fallback)
+    return m_fallback->GetDstBufferSize(samples);
+
+  return samples * m_channels * BytesPerSample(m_dst_fmt);
+}
+
+CActiveAEResamplePolyphase::Kernel CActiveAEResamplePolyphase::GetKernel()
+{
+  return Kernels().kernel;
+}
+
+const char* CActiveAEResamplePolyphase::GetKernelName(Kernel kernel)
+{
+  switch (kernel)
+  {
+    case Kernel::C:
+      return "C";
+    case Kernel::SSE2:
+      return "SSE2";
+    case Kernel::AVX2:
+      return "AVX2";
+    case Kernel::NEON:
+      return "NEON";
+    default:
+      return "unknown";
+  }
+}
+
+bool CActiveAEResamplePolyphase::IsSupported(Kernel kernel)
+{
+  if (!GetKernelSet(kernel))
+    return false;
+
+  switch (kernel)
+  {
+    case Kernel::SSE2:
+      return (GetCPUFeatures() & CPU_FEATURE_SSE2) != 0;
+    case Kernel::AVX2:
+      return (GetCPUFeatures() & CPU_FEATURE_AVX2) != 0;
+    case Kernel::NEON:
+#if defined(__aarch64__)
+      // NEON is mandatory on AArch64
+      return true;
+#else
+      return (GetCPUFeatures() & CPU_FEATURE_NEON) != 0;
+#endif
+    default:
+      return true;
+  }
+}
+
+bool CActiveAEResamplePolyphase::ForceKernel(Kernel kernel)
+{
+  if (!IsSupported(kernel))
+    return false;
+
+  activeKernels.store(GetKernelSet(kernel), std::memory_order_release);
+  return true;
+}
+
+void CActiveAEResamplePolyphase::ResetKernel()
+{
+  activeKernels.store(SelectBest(), std::memory_order_release);
+}
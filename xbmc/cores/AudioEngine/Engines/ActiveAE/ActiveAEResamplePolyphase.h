@@ -0,0 +1,137 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "cores/AudioEngine/Interfaces/AE.h"
+#include "cores/AudioEngine/Interfaces/AEResample.h"
+
+#include <memory>
+#include <vector>
+
+namespace ActiveAE
+{
+
+class CActiveAEResampleFFMPEG;
+
+/*!
+ * \brief Windowed sinc polyphase filter bank working on planar float samples.
+ *
+ * The filter bank is built once for the nominal rates. Speeding up or slowing down the output, as
+ * done to sync playback to the display, only changes the step through the input and is free.
+ */
+class CPolyphaseFilter
+{
+public:
+  bool Init(int channels, int srcRate, int dstRate, AEQuality quality);
+  void Reset();
+
+  /*!
+   * \brief Resample planar float samples, input that does not fit into dst is kept for the next
+   * call.
+   * \param src input planes or nullptr to flush the buffered input
+   * \param ratio output speed factor, same meaning as for IAEResample::Resample
+   * \return number of frames written to dst
+   */
+  int Process(
+      float* const* dst, int dstFrames, const float* const* src, int srcFrames, double ratio);
+
+  /*!
+   * \brief Input frames that have not been turned into output yet.
+   */
+  double GetBufferedFrames() const;
+
+  int GetTaps() const { return m_taps; }
+
+private:
+  int m_channels = 0;
+  int m_taps = 0;
+  double m_step = 1.0;
+  std::vector<float> m_coeffs; //!< (PHASES + 1) x m_taps, one extra phase to interpolate into
+  std::vector<float> m_kernel; //!< coefficients for the current output sample
+  std::vector<std::vector<float>> m_history;
+  int m_index = 0; //!< input frame the next output frame is computed at
+  double m_frac = 0.0; //!< fractional part of the input position
+  int m_padding = 0; //!< frames of silence appended to the history to flush
+};
+
+/*!
+ * \brief Polyphase resampler with SIMD kernels.
+ *
+ * Converts between sample rates without a channel matrix, output is float. Configurations it
+ * cannot handle natively (remapping, up or downmix, integer output) are handed to swresample.
+ */
+class CActiveAEResamplePolyphase : public IAEResample
+{
+public:
+  enum class Kernel
+  {
+    C,
+    SSE2,
+    AVX2,
+    NEON,
+  };
+
+  CActiveAEResamplePolyphase();
+  ~CActiveAEResamplePolyphase() override;
+
+  const char* GetName() override { return "ActiveAEResamplePolyphase"; }
+  bool Init(SampleConfig dstConfig,
+            SampleConfig srcConfig,
+            bool upmix,
+            bool normalize,
+            double centerMix,
+            CAEChannelInfo* remapLayout,
+            AEQuality quality,
+            bool force_resample) override;
+  int Resample(uint8_t** dst_buffer,
+               int dst_samples,
+               uint8_t** src_buffer,
+               int src_samples,
+               double ratio) override;
+  int64_t GetDelay(int64_t base) override;
+  int GetBufferedSamples() override;
+  bool WantsNewSamples(int samples) override { return GetBufferedSamples() <= samples * 2; }
+  int CalcDstSampleCount(int src_samples, int dst_rate, int src_rate) override;
+  int GetSrcBufferSize(int samples) override;
+  int GetDstBufferSize(int samples) override;
+
+  /*!
+   * \brief Whether Init() chose the native path, false if swresample does the conversion.
+   */
+  bool IsNative() const { return !m_fallback; }
+
+  /*!
+   * \brief The kernel set used by all instances.
+   */
+  static Kernel GetKernel();
+  static const char* GetKernelName(Kernel kernel);
+  static bool IsSupported(Kernel kernel);
+
+  /*!
+   * \brief Use the given kernel set instead of the best one, used by tests and benchmarks.
+   * \return false if the kernel set is not supported, the current one is kept.
+   */
+  static bool ForceKernel(Kernel kernel);
+  static void ResetKernel();
+
+private:
+  bool ConvertInput(uint8_t** src_buffer, int src_samples);
+
+  std::unique_ptr<CActiveAEResampleFFMPEG> m_fallback;
+  CPolyphaseFilter m_filter;
+  int m_channels = 0;
+  int m_src_rate = 0;
+  int m_dst_rate = 0;
+  AVSampleFormat m_src_fmt = AV_SAMPLE_FMT_NONE;
+  AVSampleFormat m_dst_fmt = AV_SAMPLE_FMT_NONE;
+  std::vector<std::vector<float>> m_srcPlanes;
+  std::vector<std::vector<float>> m_dstPlanes;
+};
+
+}
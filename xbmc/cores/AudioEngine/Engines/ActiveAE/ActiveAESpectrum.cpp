@@ -0,0 +1,247 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "ActiveAESpectrum.h"
+
+#include "threads/SingleLock.h"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+
+using namespace ActiveAE;
+using namespace std::chrono_literals;
+
+CActiveAESpectrumAnalyzer::CActiveAESpectrumAnalyzer()
+  : CThread("AESpectrum"),
+    m_dataEvent(false, false),
+    m_idleEvent(false, true),
+    m_transform(FFT_SIZE, true),
+    m_input(2 * FFT_SIZE),
+    m_freq(FFT_SIZE),
+    m_levelsRequested(-LEVELS_TIMEOUT_MS),
+    m_levelsTime(0)
+{
+  for (unsigned int i = 0; i < 2; i++)
+  {
+    m_peak[i] = 0.0f;
+    m_rms[i] = 0.0f;
+  }
+}
+
+CActiveAESpectrumAnalyzer::~CActiveAESpectrumAnalyzer()
+{
+  StopThread(true);
+}
+
+void CActiveAESpectrumAnalyzer::Start()
+{
+  CSingleLock lock(m_startLock);
+  if (!IsRunning())
+    Create();
+}
+
+void CActiveAESpectrumAnalyzer::RegisterCallback(IAudioSpectrumCallback* callback)
+{
+  {
+    CSingleLock lock(m_callbackLock);
+    auto it = std::find_if(m_callbacks.begin(), m_callbacks.end(),
+                           [callback](const Consumer& consumer)
+                           { return consumer.callback == callback; });
+    if (it == m_callbacks.end())
+      m_callbacks.push_back({callback, false});
+    m_hasCallbacks = true;
+  }
+
+  Start();
+}
+
+void CActiveAESpectrumAnalyzer::UnregisterCallback(IAudioSpectrumCallback* callback)
+{
+  // The lock is held while callbacks are made, so the consumer may be destroyed on return
+  CSingleLock lock(m_callbackLock);
+  m_callbacks.erase(std::remove_if(m_callbacks.begin(), m_callbacks.end(),
+                                   [callback](const Consumer& consumer)
+                                   { return consumer.callback == callback; }),
+                    m_callbacks.end());
+  m_hasCallbacks = !m_callbacks.empty();
+}
+
+bool CActiveAESpectrumAnalyzer::GetLevels(AEAudioLevels& levels)
+{
+  m_levelsRequested = Now();
+  Start();
+
+  // Audio stopped if no block was analyzed for a while
+  if (!m_hasLevels || m_levelsRequested - m_levelsTime > LEVELS_STALE_MS)
+  {
+    levels = AEAudioLevels();
+    return false;
+  }
+
+  for (unsigned int i = 0; i < 2; i++)
+  {
+    levels.peak[i] = m_peak[i];
+    levels.rms[i] = m_rms[i];
+  }
+
+  return true;
+}
+
+bool CActiveAESpectrumAnalyzer::IsActive() const
+{
+  if (m_hasCallbacks)
+    return true;
+
+  return Now() - m_levelsRequested < LEVELS_TIMEOUT_MS;
+}
+
+void CActiveAESpectrumAnalyzer::Flush()
+{
+  while (m_readPos != m_writePos && IsRunning())
+    m_idleEvent.Wait(10ms);
+}
+
+CActiveAESpectrumAnalyzer::Block* CActiveAESpectrumAnalyzer::BeginWrite()
+{
+  const unsigned int writePos = m_writePos.load(std::memory_order_relaxed);
+  if (writePos - m_readPos.load(std::memory_order_acquire) >= RING_SIZE)
+  {
+    m_droppedBlocks++;
+    return nullptr;
+  }
+
+  return &m_ring[writePos % RING_SIZE];
+}
+
+void CActiveAESpectrumAnalyzer::EndWrite()
+{
+  m_writePos.fetch_add(1, std::memory_order_release);
+  m_dataEvent.Set();
+}
+
+void CActiveAESpectrumAnalyzer::OnInitialize(int channels, int samplesPerSec, int bitsPerSample)
+{
+  Block* block = BeginWrite();
+  if (block == nullptr)
+    return;
+
+  block->initialize = true;
+  block->channels = channels;
+  block->samplesPerSec = samplesPerSec;
+  block->bitsPerSample = bitsPerSample;
+  block->length = 0;
+
+  EndWrite();
+}
+
+void CActiveAESpectrumAnalyzer::OnAudioData(const float* audioData, unsigned int audioDataLength)
+{
+  if (audioData == nullptr || audioDataLength == 0)
+    return;
+
+  Block* block = BeginWrite();
+  if (block == nullptr)
+    return;
+
+  // Slots keep their allocation, so this only allocates for the first blocks
+  if (block->samples.size() < audioDataLength)
+    block->samples.resize(audioDataLength);
+
+  std::copy(audioData, audioData + audioDataLength, block->samples.begin());
+  block->initialize = false;
+  block->length = audioDataLength;
+
+  EndWrite();
+}
+
+void CActiveAESpectrumAnalyzer::Process()
+{
+  while (!m_bStop)
+  {
+    const unsigned int readPos = m_readPos.load(std::memory_order_relaxed);
+    if (readPos == m_writePos.load(std::memory_order_acquire))
+    {
+      m_idleEvent.Set();
+      AbortableWait(m_dataEvent);
+      continue;
+    }
+
+    const Block& block = m_ring[readPos % RING_SIZE];
+    if (block.initialize)
+    {
+      m_channels = block.channels;
+      m_samplesPerSec = block.samplesPerSec;
+      m_bitsPerSample = block.bitsPerSample;
+      m_initialized = true;
+
+      CSingleLock lock(m_callbackLock);
+      for (Consumer& consumer : m_callbacks)
+        consumer.initialized = false;
+    }
+    else
+      Analyze(block);
+
+    m_readPos.store(readPos + 1, std::memory_order_release);
+  }
+}
+
+void CActiveAESpectrumAnalyzer::Analyze(const Block& block)
+{
+  const float* samples = block.samples.data();
+  const unsigned int frames = block.length / 2;
+
+  // Levels of the whole block
+  float peak[2] = {0.0f, 0.0f};
+  float sum[2] = {0.0f, 0.0f};
+  for (unsigned int i = 0; i < frames; i++)
+  {
+    for (unsigned int ch = 0; ch < 2; ch++)
+    {
+      const float sample = samples[2 * i + ch];
+      peak[ch] = std::max(peak[ch], fabsf(sample));
+      sum[ch] += sample * sample;
+    }
+  }
+
+  for (unsigned int ch = 0; ch < 2; ch++)
+  {
+    m_peak[ch] = peak[ch];
+    m_rms[ch] = frames > 0 ? sqrtf(sum[ch] / frames) : 0.0f;
+  }
+  m_levelsTime = Now();
+  m_hasLevels = true;
+
+  if (!m_hasCallbacks || !m_initialized)
+    return;
+
+  // Spectrum of the start of the block, zero padded if the block is short
+  const unsigned int length = std::min(block.length, 2 * FFT_SIZE);
+  std::copy(samples, samples + length, m_input.begin());
+  std::fill(m_input.begin() + length, m_input.end(), 0.0f);
+  m_transform.calc(m_input.data(), m_freq.data());
+
+  CSingleLock lock(m_callbackLock);
+  for (Consumer& consumer : m_callbacks)
+  {
+    if (!consumer.initialized)
+    {
+      consumer.callback->OnInitialize(m_channels, m_samplesPerSec, m_bitsPerSample);
+      consumer.initialized = true;
+    }
+
+    consumer.callback->OnSpectrumData(samples, block.length, m_freq.data(), FFT_SIZE);
+  }
+}
+
+int64_t CActiveAESpectrumAnalyzer::Now()
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
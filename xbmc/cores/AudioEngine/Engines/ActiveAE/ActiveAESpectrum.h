@@ -0,0 +1,151 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "cores/AudioEngine/Interfaces/IAudioCallback.h"
+#include "cores/AudioEngine/Interfaces/IAudioSpectrumCallback.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+#include "utils/rfft.h"
+
+#include <array>
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+namespace ActiveAE
+{
+
+/*!
+ * \brief Spectrum and level analysis of the visualization audio.
+ *
+ * The audio thread hands blocks of interleaved stereo samples to the analyzer
+ * through a single producer single consumer ring, which never blocks and
+ * drops blocks if the analysis thread falls behind. The analysis thread
+ * computes a windowed FFT and the peak and RMS levels of each block once and
+ * shares them with all consumers.
+ */
+class CActiveAESpectrumAnalyzer : public IAudioCallback, private CThread
+{
+public:
+  //! Number of stereo frames transformed per block
+  static constexpr unsigned int FFT_SIZE = 256;
+
+  //! Number of blocks the ring holds
+  static constexpr unsigned int RING_SIZE = 16;
+
+  //! Time the analyzer stays active after levels were last requested
+  static constexpr int64_t LEVELS_TIMEOUT_MS = 2000;
+
+  //! Age after which levels of the last block are reported as silence
+  static constexpr int64_t LEVELS_STALE_MS = 500;
+
+  CActiveAESpectrumAnalyzer();
+  ~CActiveAESpectrumAnalyzer() override;
+
+  /*!
+   * \brief Register a consumer of the spectrum, starts the analysis thread
+   */
+  void RegisterCallback(IAudioSpectrumCallback* callback);
+
+  /*!
+   * \brief Unregister a consumer, waits for a callback in progress
+   */
+  void UnregisterCallback(IAudioSpectrumCallback* callback);
+
+  /*!
+   * \brief Get the levels of the last analyzed block
+   *
+   * Requesting levels keeps the analyzer active for LEVELS_TIMEOUT_MS, so
+   * level meters work without a visualization.
+   *
+   * \return False if no audio was analyzed recently
+   */
+  bool GetLevels(AEAudioLevels& levels);
+
+  /*!
+   * \brief Whether the audio engine has to feed the analyzer
+   */
+  bool IsActive() const;
+
+  /*!
+   * \brief Number of blocks dropped because the ring was full
+   */
+  unsigned int DroppedBlocks() const { return m_droppedBlocks; }
+
+  /*!
+   * \brief Wait until all queued blocks are analyzed, used by tests
+   */
+  void Flush();
+
+  // Implementation of IAudioCallback, called from the audio thread
+  void OnInitialize(int channels, int samplesPerSec, int bitsPerSample) override;
+  void OnAudioData(const float* audioData, unsigned int audioDataLength) override;
+
+protected:
+  // Implementation of CThread
+  void Process() override;
+
+private:
+  struct Consumer
+  {
+    IAudioSpectrumCallback* callback;
+    bool initialized;
+  };
+
+  struct Block
+  {
+    bool initialize = false;
+    int channels = 0;
+    int samplesPerSec = 0;
+    int bitsPerSample = 0;
+    std::vector<float> samples;
+    unsigned int length = 0;
+  };
+
+  Block* BeginWrite();
+  void EndWrite();
+  void Start();
+  void Analyze(const Block& block);
+  static int64_t Now();
+
+  // Ring, written by the audio thread and read by the analysis thread
+  std::array<Block, RING_SIZE> m_ring;
+  std::atomic<unsigned int> m_writePos{0};
+  std::atomic<unsigned int> m_readPos{0};
+  std::atomic<unsigned int> m_droppedBlocks{0};
+  CEvent m_dataEvent;
+  CEvent m_idleEvent;
+
+  // Analysis thread state
+  RFFT m_transform;
+  std::vector<float> m_input;
+  std::vector<float> m_freq;
+
+  int m_channels = 0;
+  int m_samplesPerSec = 0;
+  int m_bitsPerSample = 0;
+  bool m_initialized = false;
+
+  // Results
+  std::atomic<float> m_peak[2];
+  std::atomic<float> m_rms[2];
+  std::atomic<bool> m_hasLevels{false};
+  std::atomic<int64_t> m_levelsRequested;
+  std::atomic<int64_t> m_levelsTime;
+
+  // Consumers
+  std::vector<Consumer> m_callbacks;
+  std::atomic<bool> m_hasCallbacks{false};
+  CCriticalSection m_callbackLock;
+  CCriticalSection m_startLock;
+};
+
+} // namespace ActiveAE
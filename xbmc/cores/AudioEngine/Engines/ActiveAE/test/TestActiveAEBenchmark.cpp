@@ -0,0 +1,278 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAEBuffer.h"
+#include "cores/AudioEngine/Sinks/AESinkVirtual.h"
+
+#include <cmath>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace ActiveAE;
+using namespace AE;
+using namespace AE::SINK;
+
+namespace
+{
+constexpr unsigned int SINK_RATE = 48000;
+constexpr unsigned int PERIOD = 1024;
+constexpr unsigned int SECONDS = 10;
+
+struct BenchmarkStream
+{
+  unsigned int sampleRate;
+  AEStdChLayout layout;
+  float tempo;
+};
+
+struct BenchmarkCase
+{
+  const char* name;
+  std::vector<BenchmarkStream> streams;
+  AEStdChLayout sinkLayout;
+};
+
+/*!
+ * \brief One decoder stream as the engine processes it: input in the decoder format, resample and
+ * remap to the internal format and optionally change the tempo.
+ */
+class CStreamPipeline
+{
+public:
+  CStreamPipeline(const BenchmarkStream& stream, const AEAudioFormat& internalFormat)
+  {
+    m_inputFormat.m_dataFormat = AE_FMT_FLOAT;
+    m_inputFormat.m_sampleRate = stream.sampleRate;
+    m_inputFormat.m_channelLayout = stream.layout;
+    m_inputFormat.m_frames = PERIOD;
+    m_inputFormat.m_frameSize = m_inputFormat.m_channelLayout.Count() * sizeof(float);
+
+    m_input = std::make_unique<CActiveAEBufferPool>(m_inputFormat);
+    m_input->Create(200);
+
+    m_resample =
+        std::make_unique<CActiveAEBufferPoolResample>(m_inputFormat, internalFormat, AE_QUALITY_MID);
+    m_resample->Create(200, true, true);
+    m_resample->FillBuffer();
+
+    if (stream.tempo != 1.0f)
+    {
+      m_atempo = std::make_unique<CActiveAEBufferPoolAtempo>(internalFormat);
+      m_atempo->Create(200);
+      m_atempo->FillBuffer();
+      m_atempo->SetTempo(stream.tempo);
+    }
+  }
+
+  ~CStreamPipeline()
+  {
+    Flush(m_resample->m_outputSamples);
+    m_resample->Flush();
+    if (m_atempo)
+    {
+      Flush(m_atempo->m_outputSamples);
+      m_atempo->Flush();
+    }
+  }
+
+  /*!
+   * \brief Get the next period in the internal format, the caller returns it to its pool.
+   */
+  CSampleBuffer* Next()
+  {
+    std::deque<CSampleBuffer*>& output =
+        m_atempo ? m_atempo->m_outputSamples : m_resample->m_outputSamples;
+
+    while (output.empty())
+    {
+      if (m_resample->m_inputSamples.empty() && !m_input->m_freeSamples.empty())
+        m_resample->m_inputSamples.push_back(Decode());
+
+      while (m_resample->ResampleBuffers())
+      {
+      }
+
+      if (m_atempo)
+      {
+        while (!m_resample->m_outputSamples.empty())
+        {
+          m_atempo->m_inputSamples.push_back(m_resample->m_outputSamples.front());
+          m_resample->m_outputSamples.pop_front();
+        }
+        while (m_atempo->ProcessBuffers())
+        {
+        }
+      }
+    }
+
+    CSampleBuffer* buffer = output.front();
+    output.pop_front();
+    return buffer;
+  }
+
+private:
+  CSampleBuffer* Decode()
+  {
+    CSampleBuffer* buffer = m_input->GetFreeBuffer();
+    float* samples = reinterpret_cast<float*>(buffer->pkt->data[0]);
+    const unsigned int channels = m_inputFormat.m_channelLayout.Count();
+    for (unsigned int frame = 0; frame < PERIOD; frame++, m_phase++)
+    {
+      const float value = 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 440.0f * m_phase /
+                                           m_inputFormat.m_sampleRate);
+      for (unsigned int ch = 0; ch < channels; ch++)
+        *samples++ = value;
+    }
+    buffer->pkt->nb_samples = PERIOD;
+    buffer->timestamp = 0;
+    buffer->pkt_start_offset = 0;
+    buffer->centerMixLevel = M_SQRT1_2;
+    return buffer;
+  }
+
+  static void Flush(std::deque<CSampleBuffer*>& samples)
+  {
+    while (!samples.empty())
+    {
+      samples.front()->Return();
+      samples.pop_front();
+    }
+  }
+
+  AEAudioFormat m_inputFormat;
+  std::unique_ptr<CActiveAEBufferPool> m_input;
+  std::unique_ptr<CActiveAEBufferPoolResample> m_resample;
+  std::unique_ptr<CActiveAEBufferPoolAtempo> m_atempo;
+  unsigned int m_phase = 0;
+};
+
+/*!
+ * \brief Run SECONDS of audio through the streams, the mixer and the sink conversion into a free
+ * running virtual sink.
+ * \return CPU milliseconds spent per second of audio.
+ */
+double RunCase(const BenchmarkCase& benchmark)
+{
+  AEAudioFormat internalFormat;
+  internalFormat.m_dataFormat = AE_FMT_FLOATP;
+  internalFormat.m_sampleRate = SINK_RATE;
+  internalFormat.m_channelLayout = benchmark.sinkLayout;
+  internalFormat.m_frames = PERIOD;
+  internalFormat.m_frameSize = internalFormat.m_channelLayout.Count() * sizeof(float);
+
+  VirtualSinkConfig config;
+  config.clock = VirtualSinkConfig::Clock::FREE_RUNNING;
+  config.periodFrames = PERIOD;
+  config.dataFormat = AE_FMT_S32NE;
+  CAESinkVirtual::SetConfig(config);
+
+  std::string device = "fast";
+  AEAudioFormat sinkFormat = internalFormat;
+  std::unique_ptr<IAESink> sink(CAESinkVirtual::Create(device, sinkFormat));
+  if (!sink)
+    return -1.0;
+
+  CActiveAEBufferPoolResample sinkBuffers(internalFormat, sinkFormat, AE_QUALITY_MID);
+  sinkBuffers.Create(200, false, false);
+
+  std::vector<std::unique_ptr<CStreamPipeline>> streams;
+  for (const auto& stream : benchmark.streams)
+    streams.emplace_back(std::make_unique<CStreamPipeline>(stream, internalFormat));
+
+  const std::clock_t start = std::clock();
+
+  uint64_t written = 0;
+  while (written < SECONDS * SINK_RATE)
+  {
+    // mix all streams into the buffer of the first one
+    CSampleBuffer* mix = streams.front()->Next();
+    for (size_t i = 1; i < streams.size(); i++)
+    {
+      CSampleBuffer* buffer = streams[i]->Next();
+      for (int plane = 0; plane < mix->pkt->planes; plane++)
+      {
+        float* dst = reinterpret_cast<float*>(mix->pkt->data[plane]);
+        const float* src = reinterpret_cast<const float*>(buffer->pkt->data[plane]);
+        for (int frame = 0; frame < mix->pkt->nb_samples; frame++)
+          dst[frame] += src[frame];
+      }
+      buffer->Return();
+    }
+
+    sinkBuffers.m_inputSamples.push_back(mix);
+    while (sinkBuffers.ResampleBuffers())
+    {
+    }
+
+    while (!sinkBuffers.m_outputSamples.empty())
+    {
+      CSampleBuffer* out = sinkBuffers.m_outputSamples.front();
+      sinkBuffers.m_outputSamples.pop_front();
+
+      unsigned int offset = 0;
+      while (offset < static_cast<unsigned int>(out->pkt->nb_samples))
+        offset += sink->AddPackets(out->pkt->data, out->pkt->nb_samples - offset, offset);
+      written += offset;
+      out->Return();
+    }
+  }
+
+  const double cpuSeconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+
+  // mixed buffers belong to the stream pools
+  sinkBuffers.Flush();
+  streams.clear();
+  sink->Deinitialize();
+  CAESinkVirtual::SetConfig(VirtualSinkConfig());
+
+  return cpuSeconds * 1000.0 * SINK_RATE / written;
+}
+} // namespace
+
+class TestActiveAEBenchmark : public ::testing::TestWithParam<BenchmarkCase>
+{
+};
+
+/* Disabled as it only measures, run it with --gtest_also_run_disabled_tests. */
+TEST_P(TestActiveAEBenchmark, DISABLED_CpuPerSecond)
+{
+  const double cpuMs = RunCase(GetParam());
+  ASSERT_GE(cpuMs, 0.0);
+
+  RecordProperty("cpu_us_per_second", static_cast<int>(cpuMs * 1000.0));
+}
+
+namespace
+{
+const BenchmarkCase BENCHMARK_CASES[] = {
+    {"passthrough_48k_stereo", {{48000, AE_CH_LAYOUT_2_0, 1.0f}}, AE_CH_LAYOUT_2_0},
+    {"resample_44k1_48k", {{44100, AE_CH_LAYOUT_2_0, 1.0f}}, AE_CH_LAYOUT_2_0},
+    {"upmix_2_0_to_5_1", {{48000, AE_CH_LAYOUT_2_0, 1.0f}}, AE_CH_LAYOUT_5_1},
+    {"downmix_7_1_to_2_0", {{48000, AE_CH_LAYOUT_7_1, 1.0f}}, AE_CH_LAYOUT_2_0},
+    {"atempo_1_5", {{48000, AE_CH_LAYOUT_2_0, 1.5f}}, AE_CH_LAYOUT_2_0},
+    {"resample_upmix_atempo", {{44100, AE_CH_LAYOUT_2_0, 1.1f}}, AE_CH_LAYOUT_5_1},
+    {"four_streams_mixed",
+     {{44100, AE_CH_LAYOUT_2_0, 1.0f},
+      {48000, AE_CH_LAYOUT_5_1, 1.0f},
+      {22050, AE_CH_LAYOUT_1_0, 1.0f},
+      {96000, AE_CH_LAYOUT_2_0, 1.0f}},
+     AE_CH_LAYOUT_5_1},
+};
+} // namespace
+
+INSTANTIATE_TEST_SUITE_P(ActiveAE,
+                         TestActiveAEBenchmark,
+                         ::testing::ValuesIn(BENCHMARK_CASES),
+                         [](const ::testing::TestParamInfo<BenchmarkCase>& info) {
+                           return std::string(info.param.name);
+                         });
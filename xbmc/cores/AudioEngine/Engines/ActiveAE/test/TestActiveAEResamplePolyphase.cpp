@@ -0,0 +1,352 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/AudioEngine/AEResampleFactory.h"
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAEResampleFFMPEG.h"
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAEResamplePolyphase.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace ActiveAE;
+
+namespace
+{
+constexpr int PACKET = 1024;
+constexpr double TONE = 1000.0;
+
+SampleConfig MakeConfig(AVSampleFormat fmt, int channels, int sampleRate)
+{
+  SampleConfig config = {};
+  config.fmt = fmt;
+  config.channels = channels;
+  config.channel_layout = 0;
+  config.sample_rate = sampleRate;
+  config.bits_per_sample = 32;
+  config.dither_bits = 0;
+  return config;
+}
+
+/*!
+ * \brief Feed a sine through a stereo float planar resampler, the ratio of every packet is
+ * provided by the caller.
+ */
+template<typename RatioFunc>
+std::vector<float> ResampleTone(ActiveAE::IAEResample& resampler,
+                                int srcRate,
+                                int dstRate,
+                                int packets,
+                                RatioFunc ratio,
+                                bool flush = false)
+{
+  std::vector<float> left(PACKET), right(PACKET);
+  const int dstMax = resampler.CalcDstSampleCount(PACKET, dstRate, srcRate) * 2 + 64;
+  std::vector<float> outLeft(dstMax), outRight(dstMax);
+  std::vector<float> output;
+
+  int64_t phase = 0;
+  for (int packet = 0; packet < packets + (flush ? 1 : 0); packet++)
+  {
+    uint8_t* src[] = {reinterpret_cast<uint8_t*>(left.data()),
+                      reinterpret_cast<uint8_t*>(right.data())};
+    uint8_t* dst[] = {reinterpret_cast<uint8_t*>(outLeft.data()),
+                      reinterpret_cast<uint8_t*>(outRight.data())};
+
+    int frames;
+    if (packet < packets)
+    {
+      for (int i = 0; i < PACKET; i++, phase++)
+      {
+        left[i] = 0.5f * static_cast<float>(std::sin(2.0 * M_PI * TONE * phase / srcRate));
+        right[i] = -left[i];
+      }
+      frames = resampler.Resample(dst, dstMax, src, PACKET, ratio(packet));
+    }
+    else
+      frames = resampler.Resample(dst, dstMax, nullptr, 0, 1.0);
+
+    EXPECT_GE(frames, 0);
+    output.insert(output.end(), outLeft.begin(), outLeft.begin() + std::max(frames, 0));
+  }
+  return output;
+}
+
+/*!
+ * \brief Signal to noise and distortion of a tone, after a least squares fit of the tone.
+ */
+double MeasureSinad(const std::vector<float>& signal, double frequency, int rate)
+{
+  // skip the filter start up
+  const size_t start = 256;
+  double ss = 0, sc = 0, cc = 0, xs = 0, xc = 0;
+  for (size_t i = start; i < signal.size(); i++)
+  {
+    const double s = std::sin(2.0 * M_PI * frequency * i / rate);
+    const double c = std::cos(2.0 * M_PI * frequency * i / rate);
+    ss += s * s;
+    sc += s * c;
+    cc += c * c;
+    xs += signal[i] * s;
+    xc += signal[i] * c;
+  }
+  const double det = ss * cc - sc * sc;
+  const double a = (xs * cc - xc * sc) / det;
+  const double b = (xc * ss - xs * sc) / det;
+
+  double power = 0, noise = 0;
+  for (size_t i = start; i < signal.size(); i++)
+  {
+    const double fit = a * std::sin(2.0 * M_PI * frequency * i / rate) +
+                       b * std::cos(2.0 * M_PI * frequency * i / rate);
+    power += fit * fit;
+    noise += (signal[i] - fit) * (signal[i] - fit);
+  }
+  return 10.0 * std::log10(power / std::max(noise, 1e-30));
+}
+
+std::unique_ptr<CActiveAEResamplePolyphase> CreatePolyphase(int srcRate,
+                                                            int dstRate,
+                                                            AEQuality quality,
+                                                            bool force = false)
+{
+  auto resampler = std::make_unique<CActiveAEResamplePolyphase>();
+  EXPECT_TRUE(resampler->Init(MakeConfig(AV_SAMPLE_FMT_FLTP, 2, dstRate),
+                              MakeConfig(AV_SAMPLE_FMT_FLTP, 2, srcRate), false, true, M_SQRT1_2,
+                              nullptr, quality, force));
+  EXPECT_TRUE(resampler->IsNative());
+  return resampler;
+}
+} // namespace
+
+TEST(TestActiveAEResamplePolyphase, Quality)
+{
+  const struct
+  {
+    AEQuality quality;
+    double minSinad;
+  } levels[] = {{AE_QUALITY_LOW, 55.0}, {AE_QUALITY_MID, 70.0}, {AE_QUALITY_HIGH, 85.0}};
+
+  for (const auto& level : levels)
+  {
+    auto resampler = CreatePolyphase(44100, 48000, level.quality);
+    const std::vector<float> output =
+        ResampleTone(*resampler, 44100, 48000, 40, [](int) { return 1.0; });
+    EXPECT_GT(MeasureSinad(output, TONE, 48000), level.minSinad) << "quality " << level.quality;
+  }
+}
+
+TEST(TestActiveAEResamplePolyphase, Downsample)
+{
+  auto resampler = CreatePolyphase(96000, 44100, AE_QUALITY_MID);
+  const std::vector<float> output =
+      ResampleTone(*resampler, 96000, 44100, 40, [](int) { return 1.0; });
+  EXPECT_GT(MeasureSinad(output, TONE, 44100), 70.0);
+}
+
+TEST(TestActiveAEResamplePolyphase, SampleCount)
+{
+  auto resampler = CreatePolyphase(44100, 48000, AE_QUALITY_MID);
+  const int packets = 100;
+  const std::vector<float> output =
+      ResampleTone(*resampler, 44100, 48000, packets, [](int) { return 1.0; });
+
+  // everything but the input the filter is waiting for comes out
+  const double expected = packets * PACKET * 48000.0 / 44100.0;
+  EXPECT_NEAR(expected, output.size() + resampler->GetBufferedSamples(), 1.0);
+  EXPECT_LE(resampler->GetBufferedSamples(), 64);
+
+  // flushing returns the rest
+  auto flushed = CreatePolyphase(44100, 48000, AE_QUALITY_MID);
+  const std::vector<float> all =
+      ResampleTone(*flushed, 44100, 48000, packets, [](int) { return 1.0; }, true);
+  EXPECT_NEAR(expected, all.size(), 1.0);
+  EXPECT_EQ(0, flushed->GetBufferedSamples());
+}
+
+TEST(TestActiveAEResamplePolyphase, RatioSampleCount)
+{
+  // sync playback to display: same rates, output is stretched by the ratio
+  auto resampler = CreatePolyphase(48000, 48000, AE_QUALITY_MID, true);
+  const int packets = 100;
+  const std::vector<float> output =
+      ResampleTone(*resampler, 48000, 48000, packets, [](int) { return 1.01; }, true);
+  EXPECT_NEAR(packets * PACKET * 1.01, output.size(), 2.0);
+}
+
+TEST(TestActiveAEResamplePolyphase, RatioChangeArtifacts)
+{
+  auto resampler = CreatePolyphase(48000, 48000, AE_QUALITY_MID, true);
+
+  // the ratio jumps on every packet like the video clock correction does
+  const std::vector<float> output = ResampleTone(*resampler, 48000, 48000, 100, [](int packet) {
+    return packet % 2 ? 1.005 : 0.995;
+  });
+
+  // a discontinuity shows up as a step larger than the steepest slope of the tone
+  const double maxStep = 0.5 * 2.0 * M_PI * TONE / (48000 * 0.995);
+  double worst = 0.0;
+  for (size_t i = 256; i < output.size(); i++)
+    worst = std::max(worst, static_cast<double>(std::fabs(output[i] - output[i - 1])));
+  EXPECT_LT(worst, maxStep * 1.01);
+
+  // the curvature of a clean tone is bounded as well, clicks are not
+  const double maxCurve = maxStep * 2.0 * M_PI * TONE / (48000 * 0.995);
+  worst = 0.0;
+  for (size_t i = 256; i < output.size(); i++)
+  {
+    worst = std::max(worst,
+                     static_cast<double>(std::fabs(output[i] - 2 * output[i - 1] + output[i - 2])));
+  }
+  EXPECT_LT(worst, maxCurve * 1.05);
+}
+
+TEST(TestActiveAEResamplePolyphase, Interleaved)
+{
+  CActiveAEResamplePolyphase resampler;
+  ASSERT_TRUE(resampler.Init(MakeConfig(AV_SAMPLE_FMT_FLT, 2, 48000),
+                             MakeConfig(AV_SAMPLE_FMT_S16, 2, 44100), false, true, M_SQRT1_2,
+                             nullptr, AE_QUALITY_MID, false));
+  ASSERT_TRUE(resampler.IsNative());
+  EXPECT_EQ(PACKET * 4, resampler.GetSrcBufferSize(PACKET));
+  EXPECT_EQ(PACKET * 8, resampler.GetDstBufferSize(PACKET));
+
+  std::vector<int16_t> src(PACKET * 2);
+  for (int i = 0; i < PACKET; i++)
+  {
+    src[2 * i] = 16384;
+    src[2 * i + 1] = -16384;
+  }
+  std::vector<float> dst(PACKET * 4);
+  uint8_t* in[] = {reinterpret_cast<uint8_t*>(src.data())};
+  uint8_t* out[] = {reinterpret_cast<uint8_t*>(dst.data())};
+
+  int frames = 0;
+  for (int i = 0; i < 4; i++)
+    frames = resampler.Resample(out, PACKET * 2, in, PACKET, 1.0);
+  ASSERT_GT(frames, 0);
+
+  // DC passes with unity gain and the channels stay in place
+  EXPECT_NEAR(0.5f, dst[2 * (frames - 1)], 1e-4);
+  EXPECT_NEAR(-0.5f, dst[2 * (frames - 1) + 1], 1e-4);
+}
+
+TEST(TestActiveAEResamplePolyphase, Fallback)
+{
+  CActiveAEResamplePolyphase resampler;
+
+  // a channel matrix is done by swresample
+  EXPECT_TRUE(resampler.Init(MakeConfig(AV_SAMPLE_FMT_FLTP, 6, 48000),
+                             MakeConfig(AV_SAMPLE_FMT_FLTP, 2, 44100), true, true, M_SQRT1_2,
+                             nullptr, AE_QUALITY_MID, false));
+  EXPECT_FALSE(resampler.IsNative());
+
+  // so is integer output
+  EXPECT_TRUE(resampler.Init(MakeConfig(AV_SAMPLE_FMT_S32, 2, 48000),
+                             MakeConfig(AV_SAMPLE_FMT_FLTP, 2, 44100), false, true, M_SQRT1_2,
+                             nullptr, AE_QUALITY_MID, false));
+  EXPECT_FALSE(resampler.IsNative());
+
+  // and a plain format conversion
+  EXPECT_TRUE(resampler.Init(MakeConfig(AV_SAMPLE_FMT_FLTP, 2, 48000),
+                             MakeConfig(AV_SAMPLE_FMT_S16, 2, 48000), false, true, M_SQRT1_2,
+                             nullptr, AE_QUALITY_MID, false));
+  EXPECT_FALSE(resampler.IsNative());
+}
+
+TEST(TestActiveAEResamplePolyphase, Kernels)
+{
+  ASSERT_TRUE(CActiveAEResamplePolyphase::ForceKernel(CActiveAEResamplePolyphase::Kernel::C));
+  auto reference = CreatePolyphase(44100, 48000, AE_QUALITY_HIGH);
+  const auto ratio = [](int packet) { return 1.0 + 0.001 * (packet % 3); };
+  const std::vector<float> expected = ResampleTone(*reference, 44100, 48000, 10, ratio);
+
+  for (auto kernel : {CActiveAEResamplePolyphase::Kernel::SSE2,
+                      CActiveAEResamplePolyphase::Kernel::AVX2,
+                      CActiveAEResamplePolyphase::Kernel::NEON})
+  {
+    if (!CActiveAEResamplePolyphase::ForceKernel(kernel))
+      continue;
+
+    auto resampler = CreatePolyphase(44100, 48000, AE_QUALITY_HIGH);
+    const std::vector<float> output = ResampleTone(*resampler, 44100, 48000, 10, ratio);
+    ASSERT_EQ(expected.size(), output.size());
+    for (size_t i = 0; i < output.size(); i++)
+    {
+      ASSERT_NEAR(expected[i], output[i], 1e-5)
+          << CActiveAEResamplePolyphase::GetKernelName(kernel) << " frame " << i;
+    }
+  }
+  CActiveAEResamplePolyphase::ResetKernel();
+}
+
+TEST(TestActiveAEResamplePolyphase, Factory)
+{
+  std::unique_ptr<ActiveAE::IAEResample> resampler(
+      CAEResampleFactory::Create(AERESAMPLEFACTORY_POLYPHASE));
+  EXPECT_STREQ("ActiveAEResamplePolyphase", resampler->GetName());
+
+  resampler.reset(CAEResampleFactory::Create(AERESAMPLEFACTORY_FFMPEG));
+  EXPECT_STREQ("ActiveAEResampleFFMPEG", resampler->GetName());
+
+  CAEResampleFactory::SetEngine(AEResampleEngine::POLYPHASE);
+  resampler.reset(CAEResampleFactory::Create());
+  EXPECT_STREQ("ActiveAEResamplePolyphase", resampler->GetName());
+
+  // one-off conversions stay with swresample
+  resampler.reset(CAEResampleFactory::Create(AERESAMPLEFACTORY_QUICK_RESAMPLE));
+  EXPECT_STREQ("ActiveAEResampleFFMPEG", resampler->GetName());
+
+  CAEResampleFactory::SetEngine(AEResampleEngine::FFMPEG);
+  resampler.reset(CAEResampleFactory::Create());
+  EXPECT_STREQ("ActiveAEResampleFFMPEG", resampler->GetName());
+}
+
+TEST(TestActiveAEResamplePolyphase, DISABLED_Benchmark)
+{
+  const struct
+  {
+    const char* name;
+    int srcRate;
+    int dstRate;
+    double ratio;
+  } cases[] = {{"resample_44k1_48k", 44100, 48000, 1.0}, {"sync_48k_1.001", 48000, 48000, 1.001}};
+  const int packets = 470; // ten seconds
+
+  for (const auto& test : cases)
+  {
+    for (AEQuality quality : {AE_QUALITY_MID, AE_QUALITY_HIGH})
+    {
+      std::unique_ptr<ActiveAE::IAEResample> engines[] = {
+          std::make_unique<CActiveAEResampleFFMPEG>(),
+          std::make_unique<CActiveAEResamplePolyphase>()};
+      for (auto& resampler : engines)
+      {
+        ASSERT_TRUE(resampler->Init(MakeConfig(AV_SAMPLE_FMT_FLTP, 2, test.dstRate),
+                                    MakeConfig(AV_SAMPLE_FMT_FLTP, 2, test.srcRate), false, true,
+                                    M_SQRT1_2, nullptr, quality, true));
+
+        const std::clock_t start = std::clock();
+        const std::vector<float> output = ResampleTone(*resampler, test.srcRate, test.dstRate,
+                                                       packets, [&](int) { return test.ratio; });
+        const double cpuMs = static_cast<double>(std::clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+        ASSERT_FALSE(output.empty());
+        const double seconds = static_cast<double>(output.size()) / test.dstRate;
+
+        std::cout << test.name << " quality " << quality << " " << resampler->GetName() << ": "
+                  << cpuMs / seconds << " ms CPU per second of audio, SINAD "
+                  << MeasureSinad(output, TONE / test.ratio, test.dstRate) << " dB" << std::endl;
+      }
+    }
+  }
+}
@@ -0,0 +1,204 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAESpectrum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace ActiveAE;
+
+namespace
+{
+constexpr int SAMPLE_RATE = 44100;
+constexpr unsigned int BLOCK_FRAMES = 512;
+
+class CSpectrumConsumer : public IAudioSpectrumCallback
+{
+public:
+  void OnInitialize(int iChannels, int iSamplesPerSec, int iBitsPerSample) override
+  {
+    m_channels = iChannels;
+    m_samplesPerSec = iSamplesPerSec;
+    m_initializedBeforeData = m_blocks == 0;
+  }
+
+  void OnSpectrumData(const float* pAudioData,
+                      unsigned int iAudioDataLength,
+                      const float* pFreqData,
+                      unsigned int iFreqDataLength) override
+  {
+    m_blocks++;
+    m_audioLength = iAudioDataLength;
+    m_freq.assign(pFreqData, pFreqData + iFreqDataLength);
+  }
+
+  int m_channels = 0;
+  int m_samplesPerSec = 0;
+  bool m_initializedBeforeData = false;
+  unsigned int m_blocks = 0;
+  unsigned int m_audioLength = 0;
+  std::vector<float> m_freq;
+};
+
+// Interleaved stereo block, a sine on each channel
+std::vector<float> MakeBlock(float leftAmplitude, float rightAmplitude, unsigned int bin)
+{
+  std::vector<float> block(2 * BLOCK_FRAMES);
+  const double step = 2.0 * M_PI * bin / CActiveAESpectrumAnalyzer::FFT_SIZE;
+  for (unsigned int i = 0; i < BLOCK_FRAMES; i++)
+  {
+    block[2 * i] = static_cast<float>(static_cast<double>(leftAmplitude) * sin(step * i));
+    block[2 * i + 1] = static_cast<float>(static_cast<double>(rightAmplitude) * sin(step * i));
+  }
+  return block;
+}
+
+// Bin with the largest magnitude of one channel of the interleaved spectrum
+unsigned int PeakBin(const std::vector<float>& freq, unsigned int channel)
+{
+  unsigned int peak = 0;
+  for (unsigned int i = 0; i < freq.size() / 2; i++)
+  {
+    if (freq[2 * i + channel] > freq[2 * peak + channel])
+      peak = i;
+  }
+  return peak;
+}
+} // namespace
+
+TEST(TestActiveAESpectrum, Levels)
+{
+  CActiveAESpectrumAnalyzer analyzer;
+  AEAudioLevels levels;
+
+  EXPECT_FALSE(analyzer.GetLevels(levels));
+
+  const std::vector<float> block = MakeBlock(1.0f, 0.25f, 16);
+  analyzer.OnInitialize(2, SAMPLE_RATE, 32);
+  analyzer.OnAudioData(block.data(), block.size());
+  analyzer.Flush();
+
+  ASSERT_TRUE(analyzer.GetLevels(levels));
+  EXPECT_NEAR(levels.peak[0], 1.0f, 1e-3f);
+  EXPECT_NEAR(levels.peak[1], 0.25f, 1e-3f);
+  EXPECT_NEAR(levels.rms[0], 1.0f / std::sqrt(2.0f), 1e-3f);
+  EXPECT_NEAR(levels.rms[1], 0.25f / std::sqrt(2.0f), 1e-3f);
+}
+
+TEST(TestActiveAESpectrum, SharedSpectrum)
+{
+  CActiveAESpectrumAnalyzer analyzer;
+  CSpectrumConsumer first;
+  CSpectrumConsumer second;
+  analyzer.RegisterCallback(&first);
+  analyzer.RegisterCallback(&second);
+
+  const std::vector<float> block = MakeBlock(1.0f, 0.5f, 16);
+  analyzer.OnInitialize(2, SAMPLE_RATE, 32);
+  for (unsigned int i = 0; i < 4; i++)
+    analyzer.OnAudioData(block.data(), block.size());
+  analyzer.Flush();
+  analyzer.UnregisterCallback(&first);
+  analyzer.UnregisterCallback(&second);
+
+  for (const CSpectrumConsumer* consumer : {&first, &second})
+  {
+    EXPECT_EQ(consumer->m_channels, 2);
+    EXPECT_EQ(consumer->m_samplesPerSec, SAMPLE_RATE);
+    EXPECT_TRUE(consumer->m_initializedBeforeData);
+    EXPECT_EQ(consumer->m_blocks, 4u);
+    EXPECT_EQ(consumer->m_audioLength, block.size());
+    ASSERT_EQ(consumer->m_freq.size(), CActiveAESpectrumAnalyzer::FFT_SIZE);
+    EXPECT_EQ(PeakBin(consumer->m_freq, 0), 16u);
+    EXPECT_EQ(PeakBin(consumer->m_freq, 1), 16u);
+  }
+
+  EXPECT_EQ(first.m_freq, second.m_freq);
+  EXPECT_GT(first.m_freq[32], first.m_freq[33]);
+}
+
+TEST(TestActiveAESpectrum, LateConsumerIsInitialized)
+{
+  CActiveAESpectrumAnalyzer analyzer;
+  CSpectrumConsumer first;
+  analyzer.RegisterCallback(&first);
+
+  const std::vector<float> block = MakeBlock(1.0f, 1.0f, 8);
+  analyzer.OnInitialize(2, SAMPLE_RATE, 32);
+  analyzer.OnAudioData(block.data(), block.size());
+  analyzer.Flush();
+
+  CSpectrumConsumer late;
+  analyzer.RegisterCallback(&late);
+  analyzer.OnAudioData(block.data(), block.size());
+  analyzer.Flush();
+  analyzer.UnregisterCallback(&first);
+  analyzer.UnregisterCallback(&late);
+
+  EXPECT_EQ(first.m_blocks, 2u);
+  EXPECT_EQ(late.m_blocks, 1u);
+  EXPECT_EQ(late.m_samplesPerSec, SAMPLE_RATE);
+  EXPECT_TRUE(late.m_initializedBeforeData);
+}
+
+TEST(TestActiveAESpectrum, ShortBlock)
+{
+  CActiveAESpectrumAnalyzer analyzer;
+  CSpectrumConsumer consumer;
+  analyzer.RegisterCallback(&consumer);
+
+  const std::vector<float> block(64, 0.5f);
+  analyzer.OnInitialize(2, SAMPLE_RATE, 32);
+  analyzer.OnAudioData(block.data(), block.size());
+  analyzer.Flush();
+  analyzer.UnregisterCallback(&consumer);
+
+  EXPECT_EQ(consumer.m_blocks, 1u);
+  EXPECT_EQ(consumer.m_audioLength, block.size());
+  EXPECT_EQ(consumer.m_freq.size(), CActiveAESpectrumAnalyzer::FFT_SIZE);
+}
+
+TEST(TestActiveAESpectrum, FullRingDropsBlocks)
+{
+  // Nothing is analyzed before the thread is started by a consumer
+  CActiveAESpectrumAnalyzer analyzer;
+  const std::vector<float> block = MakeBlock(1.0f, 1.0f, 8);
+  for (unsigned int i = 0; i < CActiveAESpectrumAnalyzer::RING_SIZE + 4; i++)
+    analyzer.OnAudioData(block.data(), block.size());
+
+  EXPECT_EQ(analyzer.DroppedBlocks(), 4u);
+
+  AEAudioLevels levels;
+  analyzer.GetLevels(levels);
+  analyzer.Flush();
+  EXPECT_TRUE(analyzer.GetLevels(levels));
+
+  analyzer.OnAudioData(block.data(), block.size());
+  EXPECT_EQ(analyzer.DroppedBlocks(), 4u);
+}
+
+TEST(TestActiveAESpectrum, Active)
+{
+  CActiveAESpectrumAnalyzer analyzer;
+  EXPECT_FALSE(analyzer.IsActive());
+
+  CSpectrumConsumer consumer;
+  analyzer.RegisterCallback(&consumer);
+  EXPECT_TRUE(analyzer.IsActive());
+  analyzer.UnregisterCallback(&consumer);
+  EXPECT_FALSE(analyzer.IsActive());
+
+  // Level meters keep the analyzer active for a while
+  AEAudioLevels levels;
+  analyzer.GetLevels(levels);
+  EXPECT_TRUE(analyzer.IsActive());
+}
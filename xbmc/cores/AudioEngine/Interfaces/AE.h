@@ -27,8 +27,10 @@ class IAEStream;
 class IAESound;
 class IAEPacketizer;
 class IAudioCallback;
+class IAudioSpectrumCallback;
 class IAEClockCallback;
 class CAEStreamInfo;
+struct AEAudioLevels;
 
 /* sound options */
 #define AE_SOUND_OFF    0 /* disable sounds */
@@ -205,6 +207,21 @@ public:
 
   virtual void UnregisterAudioCallback(IAudioCallback* pCallback) {}
 
+  /**
+   * Register a consumer of the spectrum the AudioEngine computes for visualizations
+   * @param pCallback the consumer, called from the analysis thread
+   */
+  virtual void RegisterSpectrumCallback(IAudioSpectrumCallback* pCallback) {}
+
+  virtual void UnregisterSpectrumCallback(IAudioSpectrumCallback* pCallback) {}
+
+  /**
+   * Get the peak and RMS levels of the audio being played
+   * @param levels the levels, silence if nothing is played
+   * @returns false if levels are not available
+   */
+  virtual bool GetAudioLevels(AEAudioLevels& levels) { return false; }
+
   /**
    * Returns true if AudioEngine supports specified quality level
    * @return true if specified quality level is supported, otherwise false
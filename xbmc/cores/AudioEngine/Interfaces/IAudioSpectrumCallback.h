@@ -0,0 +1,48 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+/*!
+ * \brief Peak and RMS levels of the stereo downmix of the audio being played.
+ *
+ * Levels are linear, 1.0 is full scale.
+ */
+struct AEAudioLevels
+{
+  float peak[2] = {0.0f, 0.0f};
+  float rms[2] = {0.0f, 0.0f};
+};
+
+/*!
+ * \brief Consumer of the spectrum computed by the audio engine.
+ *
+ * The engine computes one spectrum per block of audio and hands it to all
+ * registered consumers, so visualizations don't need to transform the audio
+ * themselves. Callbacks are made from the analysis thread, never from the
+ * audio thread.
+ */
+class IAudioSpectrumCallback
+{
+public:
+  IAudioSpectrumCallback() = default;
+  virtual ~IAudioSpectrumCallback() = default;
+
+  virtual void OnInitialize(int iChannels, int iSamplesPerSec, int iBitsPerSample) = 0;
+
+  /*!
+   * \param pAudioData Interleaved stereo samples of the block
+   * \param iAudioDataLength Number of floats in pAudioData
+   * \param pFreqData Interleaved stereo magnitudes of the block's spectrum
+   * \param iFreqDataLength Number of floats in pFreqData
+   */
+  virtual void OnSpectrumData(const float* pAudioData,
+                              unsigned int iAudioDataLength,
+                              const float* pFreqData,
+                              unsigned int iFreqDataLength) = 0;
+};
@@ -905,6 +905,13 @@ bool CAESinkPULSE::Initialize(AEAudioFormat &format, std::string &device)
     process_time = latency / 4;
   }
 
+  // low latency mode of the engine requests a packet size
+  if (format.m_frames > 0 && !m_passthrough)
+  {
+    process_time = std::min(process_time, format.m_frames * frameSize);
+    latency = process_time * 4;
+  }
+
   pa_buffer_attr buffer_attr;
   buffer_attr.fragsize = latency;
   buffer_attr.maxlength = (uint32_t) -1;
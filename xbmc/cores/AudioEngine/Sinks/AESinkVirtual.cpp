@@ -0,0 +1,268 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "AESinkVirtual.h"
+
+#include "cores/AudioEngine/AESinkFactory.h"
+#include "cores/AudioEngine/Utils/AEUtil.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <string.h>
+#include <thread>
+
+using namespace AE;
+using namespace AE::SINK;
+
+namespace
+{
+CCriticalSection virtualSinkSection;
+VirtualSinkConfig virtualSinkConfig;
+VirtualSinkStats virtualSinkStats;
+
+constexpr const char* DEVICE_FAST = "fast";
+} // namespace
+
+CAESinkVirtual::~CAESinkVirtual()
+{
+  Deinitialize();
+}
+
+void CAESinkVirtual::Register()
+{
+  AE::AESinkRegEntry entry;
+  entry.sinkName = "VIRTUAL";
+  entry.createFunc = CAESinkVirtual::Create;
+  entry.enumerateFunc = CAESinkVirtual::EnumerateDevicesEx;
+  AE::CAESinkFactory::RegisterSink(entry);
+}
+
+IAESink* CAESinkVirtual::Create(std::string& device, AEAudioFormat& desiredFormat)
+{
+  IAESink* sink = new CAESinkVirtual();
+  if (sink->Initialize(desiredFormat, device))
+    return sink;
+
+  delete sink;
+  return nullptr;
+}
+
+void CAESinkVirtual::EnumerateDevicesEx(AEDeviceInfoList& list, bool force)
+{
+  const VirtualSinkConfig config = GetConfig();
+
+  CAEDeviceInfo info;
+  info.m_deviceType = AE_DEVTYPE_PCM;
+  info.m_wantsIECPassthrough = false;
+  info.m_channels = AE_CH_LAYOUT_7_1;
+  if (config.channelLayout.Count() > 0)
+    info.m_channels = config.channelLayout;
+
+  if (config.sampleRate > 0)
+    info.m_sampleRates.push_back(config.sampleRate);
+  else
+    info.m_sampleRates = {44100, 48000, 88200, 96000, 176400, 192000};
+
+  if (config.dataFormat != AE_FMT_INVALID)
+    info.m_dataFormats.push_back(config.dataFormat);
+  else
+    info.m_dataFormats = {AE_FMT_FLOAT, AE_FMT_S32NE, AE_FMT_S16NE, AE_FMT_FLOATP};
+
+  info.m_deviceName = "default";
+  info.m_displayName = "Virtual output";
+  info.m_displayNameExtra = "simulated device clock";
+  list.push_back(info);
+
+  info.m_deviceName = DEVICE_FAST;
+  info.m_displayName = "Virtual output (fast)";
+  info.m_displayNameExtra = "free running";
+  list.push_back(info);
+}
+
+void CAESinkVirtual::SetConfig(const VirtualSinkConfig& config)
+{
+  CSingleLock lock(virtualSinkSection);
+  virtualSinkConfig = config;
+}
+
+VirtualSinkConfig CAESinkVirtual::GetConfig()
+{
+  CSingleLock lock(virtualSinkSection);
+  return virtualSinkConfig;
+}
+
+VirtualSinkStats CAESinkVirtual::GetStats()
+{
+  CSingleLock lock(virtualSinkSection);
+  return virtualSinkStats;
+}
+
+bool CAESinkVirtual::Initialize(AEAudioFormat& format, std::string& device)
+{
+  m_config = GetConfig();
+  if (device == DEVICE_FAST)
+    m_config.clock = VirtualSinkConfig::Clock::FREE_RUNNING;
+
+  // honour the period the engine prefers in low latency mode
+  if (format.m_frames > 0)
+    m_config.periodFrames = std::min(m_config.periodFrames, format.m_frames);
+
+  if (m_config.periodFrames == 0 || m_config.periods == 0)
+  {
+    CLog::Log(LOGERROR, "CAESinkVirtual::{} - invalid buffer configuration", __FUNCTION__);
+    return false;
+  }
+
+  if (format.m_dataFormat == AE_FMT_RAW)
+  {
+    CLog::Log(LOGERROR, "CAESinkVirtual::{} - passthrough is not supported", __FUNCTION__);
+    return false;
+  }
+
+  if (m_config.dataFormat != AE_FMT_INVALID)
+    format.m_dataFormat = m_config.dataFormat;
+  if (m_config.sampleRate > 0)
+    format.m_sampleRate = m_config.sampleRate;
+  if (m_config.channelLayout.Count() > 0)
+    format.m_channelLayout = m_config.channelLayout;
+
+  format.m_frames = m_config.periodFrames;
+  format.m_frameSize =
+      format.m_channelLayout.Count() * (CAEUtil::DataFormatToBits(format.m_dataFormat) >> 3);
+
+  m_format = format;
+  m_bufferFrames = m_config.periodFrames * m_config.periods;
+  m_written = 0;
+  m_clockStart = std::chrono::steady_clock::now();
+
+  {
+    CSingleLock lock(virtualSinkSection);
+    virtualSinkStats = VirtualSinkStats();
+    virtualSinkStats.format = format;
+  }
+
+  CLog::Log(LOGDEBUG, "CAESinkVirtual::{} - {} Hz, {} channels, {}, {} x {} frames, {}",
+            __FUNCTION__, format.m_sampleRate, format.m_channelLayout.Count(),
+            CAEUtil::DataFormatToStr(format.m_dataFormat), m_config.periods,
+            m_config.periodFrames,
+            m_config.clock == VirtualSinkConfig::Clock::REALTIME ? "realtime" : "free running");
+
+  return true;
+}
+
+void CAESinkVirtual::Deinitialize()
+{
+  m_written = 0;
+}
+
+double CAESinkVirtual::GetCacheTotal()
+{
+  return static_cast<double>(m_bufferFrames) / m_format.m_sampleRate;
+}
+
+int64_t CAESinkVirtual::GetBufferedFrames(std::chrono::steady_clock::time_point now)
+{
+  if (m_config.clock == VirtualSinkConfig::Clock::FREE_RUNNING)
+    return 0;
+
+  const std::chrono::duration<double> elapsed = now - m_clockStart;
+  const int64_t played = static_cast<int64_t>(elapsed.count() * m_format.m_sampleRate);
+  int64_t buffered = m_written - played;
+  if (buffered < 0)
+  {
+    // the device ran dry, restart its clock at the current position
+    if (m_written > 0)
+    {
+      CSingleLock lock(virtualSinkSection);
+      virtualSinkStats.underruns++;
+    }
+    m_clockStart = now;
+    m_written = 0;
+    buffered = 0;
+  }
+  return buffered;
+}
+
+void CAESinkVirtual::GetDelay(AEDelayStatus& status)
+{
+  const int64_t buffered = GetBufferedFrames(std::chrono::steady_clock::now());
+  status.SetDelay(static_cast<double>(buffered) / m_format.m_sampleRate);
+}
+
+unsigned int CAESinkVirtual::AddPackets(uint8_t** data, unsigned int frames, unsigned int offset)
+{
+  int64_t space = m_bufferFrames;
+  if (m_config.clock == VirtualSinkConfig::Clock::REALTIME)
+  {
+    // block until the device has played at least one period
+    space = m_bufferFrames - GetBufferedFrames(std::chrono::steady_clock::now());
+    if (space < m_config.periodFrames)
+    {
+      const double wait = static_cast<double>(m_config.periodFrames - space) / m_format.m_sampleRate;
+      std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+      space = m_bufferFrames - GetBufferedFrames(std::chrono::steady_clock::now());
+    }
+  }
+
+  const unsigned int written =
+      static_cast<unsigned int>(std::min<int64_t>(frames, std::max<int64_t>(space, 0)));
+  m_written += written;
+
+  Capture(data, written, offset);
+
+  return written;
+}
+
+void CAESinkVirtual::Capture(uint8_t** data, unsigned int frames, unsigned int offset)
+{
+  CSingleLock lock(virtualSinkSection);
+  virtualSinkStats.framesWritten += frames;
+  virtualSinkStats.addPacketsCalls++;
+
+  const size_t frameSize = m_format.m_frameSize;
+  const size_t captured = virtualSinkStats.capture.size() / frameSize;
+  if (captured >= m_config.captureFrames)
+    return;
+
+  const size_t count = std::min<size_t>(frames, m_config.captureFrames - captured);
+  if (!AE_IS_PLANAR(m_format.m_dataFormat))
+  {
+    const uint8_t* src = data[0] + offset * frameSize;
+    virtualSinkStats.capture.insert(virtualSinkStats.capture.end(), src, src + count * frameSize);
+    return;
+  }
+
+  // interleave the planes so the capture has the same layout for all formats
+  const unsigned int channels = m_format.m_channelLayout.Count();
+  const size_t sampleSize = frameSize / channels;
+  const size_t start = virtualSinkStats.capture.size();
+  virtualSinkStats.capture.resize(start + count * frameSize);
+  for (size_t frame = 0; frame < count; frame++)
+  {
+    for (unsigned int ch = 0; ch < channels; ch++)
+    {
+      memcpy(&virtualSinkStats.capture[start + frame * frameSize + ch * sampleSize],
+             data[ch] + (offset + frame) * sampleSize, sampleSize);
+    }
+  }
+}
+
+void CAESinkVirtual::Drain()
+{
+  if (m_config.clock == VirtualSinkConfig::Clock::REALTIME)
+  {
+    const int64_t buffered = GetBufferedFrames(std::chrono::steady_clock::now());
+    std::this_thread::sleep_for(
+        std::chrono::duration<double>(static_cast<double>(buffered) / m_format.m_sampleRate));
+  }
+
+  m_written = 0;
+  m_clockStart = std::chrono::steady_clock::now();
+}
@@ -0,0 +1,106 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "cores/AudioEngine/Interfaces/AESink.h"
+#include "cores/AudioEngine/Utils/AEDeviceInfo.h"
+
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace AE
+{
+namespace SINK
+{
+
+/*!
+ * \brief Output device simulation of CAESinkVirtual.
+ */
+struct VirtualSinkConfig
+{
+  enum class Clock
+  {
+    REALTIME, //!< the device consumes one period every period duration of wall time
+    FREE_RUNNING, //!< the device consumes data as fast as it is written
+  };
+
+  Clock clock = Clock::REALTIME;
+  unsigned int periodFrames = 1024;
+  unsigned int periods = 4; //!< device buffer size in periods
+  AEDataFormat dataFormat = AE_FMT_FLOAT; //!< AE_FMT_INVALID accepts the requested format
+  unsigned int sampleRate = 0; //!< 0 accepts the requested rate
+  CAEChannelInfo channelLayout; //!< empty accepts the requested layout
+  unsigned int captureFrames = 0; //!< frames of output to keep for verification, 0 disables
+};
+
+/*!
+ * \brief Counters of the sink that is currently open, reset on every Initialize().
+ */
+struct VirtualSinkStats
+{
+  AEAudioFormat format;
+  uint64_t framesWritten = 0;
+  uint64_t addPacketsCalls = 0;
+  uint64_t underruns = 0; //!< times the simulated device ran out of data
+  std::vector<uint8_t> capture; //!< interleaved copy of the first captureFrames frames
+};
+
+/*!
+ * \brief Sink without audio hardware that simulates a device clock.
+ *
+ * Used to drive the audio engine headlessly, e.g. in tests and benchmarks. Select it with
+ * KODI_AE_SINK=VIRTUAL or register it explicitly. Device "default" uses the configured clock,
+ * device "fast" always runs free.
+ */
+class CAESinkVirtual : public IAESink
+{
+public:
+  CAESinkVirtual() = default;
+  ~CAESinkVirtual() override;
+
+  static void Register();
+  static IAESink* Create(std::string& device, AEAudioFormat& desiredFormat);
+  static void EnumerateDevicesEx(AEDeviceInfoList& list, bool force = false);
+
+  /*!
+   * \brief Configure the devices opened from now on.
+   */
+  static void SetConfig(const VirtualSinkConfig& config);
+  static VirtualSinkConfig GetConfig();
+  static VirtualSinkStats GetStats();
+
+  // overrides via IAESink
+  const char* GetName() override { return "VIRTUAL"; }
+
+  bool Initialize(AEAudioFormat& format, std::string& device) override;
+  void Deinitialize() override;
+
+  double GetCacheTotal() override;
+  void GetDelay(AEDelayStatus& status) override;
+
+  unsigned int AddPackets(uint8_t** data, unsigned int frames, unsigned int offset) override;
+  void Drain() override;
+
+private:
+  int64_t GetBufferedFrames(std::chrono::steady_clock::time_point now);
+  void Capture(uint8_t** data, unsigned int frames, unsigned int offset);
+
+  VirtualSinkConfig m_config;
+  AEAudioFormat m_format;
+  unsigned int m_bufferFrames = 0;
+
+  //! frames written to the device, the device clock started at m_clockStart
+  int64_t m_written = 0;
+  std::chrono::steady_clock::time_point m_clockStart;
+};
+
+} // namespace SINK
+} // namespace AE
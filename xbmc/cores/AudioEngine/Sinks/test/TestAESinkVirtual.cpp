@@ -0,0 +1,264 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/AudioEngine/Sinks/AESinkVirtual.h"
+
+#include <chrono>
+#include <memory>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace AE;
+using namespace AE::SINK;
+
+namespace
+{
+AEAudioFormat MakeFormat(AEDataFormat dataFormat, unsigned int sampleRate, AEStdChLayout layout)
+{
+  AEAudioFormat format;
+  format.m_dataFormat = dataFormat;
+  format.m_sampleRate = sampleRate;
+  format.m_channelLayout = layout;
+  return format;
+}
+
+std::unique_ptr<IAESink> OpenSink(const VirtualSinkConfig& config,
+                                  std::string device,
+                                  AEAudioFormat& format)
+{
+  CAESinkVirtual::SetConfig(config);
+  return std::unique_ptr<IAESink>(CAESinkVirtual::Create(device, format));
+}
+} // namespace
+
+class TestAESinkVirtual : public ::testing::Test
+{
+protected:
+  ~TestAESinkVirtual() override { CAESinkVirtual::SetConfig(VirtualSinkConfig()); }
+};
+
+TEST_F(TestAESinkVirtual, FormatNegotiation)
+{
+  VirtualSinkConfig config;
+  config.periodFrames = 256;
+  config.dataFormat = AE_FMT_S16NE;
+  config.sampleRate = 48000;
+
+  AEAudioFormat format = MakeFormat(AE_FMT_FLOAT, 44100, AE_CH_LAYOUT_5_1);
+  auto sink = OpenSink(config, "default", format);
+  ASSERT_TRUE(sink);
+
+  EXPECT_EQ(AE_FMT_S16NE, format.m_dataFormat);
+  EXPECT_EQ(48000u, format.m_sampleRate);
+  EXPECT_EQ(6u, format.m_channelLayout.Count());
+  EXPECT_EQ(256u, format.m_frames);
+  EXPECT_EQ(12u, format.m_frameSize);
+  EXPECT_DOUBLE_EQ(4 * 256 / 48000.0, sink->GetCacheTotal());
+
+  // an invalid format accepts what the engine asks for
+  config.dataFormat = AE_FMT_INVALID;
+  config.sampleRate = 0;
+  format = MakeFormat(AE_FMT_S32NE, 96000, AE_CH_LAYOUT_2_0);
+  sink = OpenSink(config, "default", format);
+  ASSERT_TRUE(sink);
+  EXPECT_EQ(AE_FMT_S32NE, format.m_dataFormat);
+  EXPECT_EQ(96000u, format.m_sampleRate);
+  EXPECT_EQ(8u, format.m_frameSize);
+
+  format = MakeFormat(AE_FMT_RAW, 48000, AE_CH_LAYOUT_2_0);
+  EXPECT_FALSE(OpenSink(config, "default", format));
+}
+
+TEST_F(TestAESinkVirtual, PeriodRequest)
+{
+  VirtualSinkConfig config;
+  config.periodFrames = 1024;
+
+  // low latency mode of the engine asks for a smaller period
+  AEAudioFormat format = MakeFormat(AE_FMT_FLOAT, 48000, AE_CH_LAYOUT_2_0);
+  format.m_frames = 240;
+  auto sink = OpenSink(config, "default", format);
+  ASSERT_TRUE(sink);
+  EXPECT_EQ(240u, format.m_frames);
+  EXPECT_DOUBLE_EQ(4 * 240 / 48000.0, sink->GetCacheTotal());
+
+  // the configured period is an upper limit
+  format.m_frames = 4096;
+  sink = OpenSink(config, "default", format);
+  ASSERT_TRUE(sink);
+  EXPECT_EQ(1024u, format.m_frames);
+}
+
+TEST_F(TestAESinkVirtual, Enumerate)
+{
+  AEDeviceInfoList list;
+  CAESinkVirtual::EnumerateDevicesEx(list);
+  ASSERT_EQ(2u, list.size());
+  EXPECT_EQ("default", list[0].m_deviceName);
+  EXPECT_EQ("fast", list[1].m_deviceName);
+  EXPECT_EQ(AE_DEVTYPE_PCM, list[0].m_deviceType);
+}
+
+TEST_F(TestAESinkVirtual, FreeRunning)
+{
+  VirtualSinkConfig config;
+  config.clock = VirtualSinkConfig::Clock::FREE_RUNNING;
+
+  AEAudioFormat format = MakeFormat(AE_FMT_FLOAT, 48000, AE_CH_LAYOUT_2_0);
+  auto sink = OpenSink(config, "default", format);
+  ASSERT_TRUE(sink);
+
+  // ten seconds of audio must not take anywhere near ten seconds
+  std::vector<float> buffer(format.m_frames * 2);
+  uint8_t* data[] = {reinterpret_cast<uint8_t*>(buffer.data())};
+  const auto start = std::chrono::steady_clock::now();
+  unsigned int total = 0;
+  while (total < 480000)
+    total += sink->AddPackets(data, format.m_frames, 0);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+
+  AEDelayStatus status;
+  sink->GetDelay(status);
+  EXPECT_DOUBLE_EQ(0.0, status.delay);
+
+  const VirtualSinkStats stats = CAESinkVirtual::GetStats();
+  EXPECT_EQ(total, stats.framesWritten);
+  EXPECT_EQ(0u, stats.underruns);
+}
+
+TEST_F(TestAESinkVirtual, FastDevice)
+{
+  VirtualSinkConfig config;
+  config.clock = VirtualSinkConfig::Clock::REALTIME;
+
+  AEAudioFormat format = MakeFormat(AE_FMT_FLOAT, 48000, AE_CH_LAYOUT_2_0);
+  auto sink = OpenSink(config, "fast", format);
+  ASSERT_TRUE(sink);
+
+  std::vector<float> buffer(format.m_frames * 2);
+  uint8_t* data[] = {reinterpret_cast<uint8_t*>(buffer.data())};
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 100; i++)
+    EXPECT_EQ(format.m_frames, sink->AddPackets(data, format.m_frames, 0));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+}
+
+TEST_F(TestAESinkVirtual, Realtime)
+{
+  VirtualSinkConfig config;
+  config.periodFrames = 480;
+  config.periods = 2;
+
+  AEAudioFormat format = MakeFormat(AE_FMT_FLOAT, 48000, AE_CH_LAYOUT_2_0);
+  auto sink = OpenSink(config, "default", format);
+  ASSERT_TRUE(sink);
+
+  std::vector<float> buffer(format.m_frames * 2);
+  uint8_t* data[] = {reinterpret_cast<uint8_t*>(buffer.data())};
+
+  // the first two periods fill the device buffer without blocking
+  EXPECT_EQ(480u, sink->AddPackets(data, 480, 0));
+  EXPECT_EQ(480u, sink->AddPackets(data, 480, 0));
+
+  AEDelayStatus status;
+  sink->GetDelay(status);
+  EXPECT_NEAR(0.02, status.delay, 0.005);
+
+  // 20 more periods of 10 ms must be paced by the simulated clock
+  const auto start = std::chrono::steady_clock::now();
+  unsigned int total = 0;
+  while (total < 20 * 480)
+    total += sink->AddPackets(data, 480, 0);
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_GE(elapsed.count(), 0.18);
+  EXPECT_LT(elapsed.count(), 1.0);
+
+  sink->Drain();
+  sink->GetDelay(status);
+  EXPECT_DOUBLE_EQ(0.0, status.delay);
+}
+
+TEST_F(TestAESinkVirtual, Underrun)
+{
+  VirtualSinkConfig config;
+  config.periodFrames = 48;
+  config.periods = 2;
+
+  AEAudioFormat format = MakeFormat(AE_FMT_FLOAT, 48000, AE_CH_LAYOUT_2_0);
+  auto sink = OpenSink(config, "default", format);
+  ASSERT_TRUE(sink);
+
+  std::vector<float> buffer(format.m_frames * 2);
+  uint8_t* data[] = {reinterpret_cast<uint8_t*>(buffer.data())};
+  sink->AddPackets(data, 48, 0);
+
+  // two periods are 2 ms, the device must have run dry after 20 ms
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  AEDelayStatus status;
+  sink->GetDelay(status);
+  EXPECT_DOUBLE_EQ(0.0, status.delay);
+  EXPECT_EQ(1u, CAESinkVirtual::GetStats().underruns);
+}
+
+TEST_F(TestAESinkVirtual, CaptureInterleaved)
+{
+  VirtualSinkConfig config;
+  config.clock = VirtualSinkConfig::Clock::FREE_RUNNING;
+  config.dataFormat = AE_FMT_S16NE;
+  config.captureFrames = 6;
+
+  AEAudioFormat format = MakeFormat(AE_FMT_S16NE, 48000, AE_CH_LAYOUT_2_0);
+  auto sink = OpenSink(config, "default", format);
+  ASSERT_TRUE(sink);
+
+  std::vector<int16_t> samples;
+  for (int16_t i = 0; i < 16; i++)
+    samples.push_back(i);
+  uint8_t* data[] = {reinterpret_cast<uint8_t*>(samples.data())};
+
+  // skip the first frame, capture stops after six frames
+  EXPECT_EQ(4u, sink->AddPackets(data, 4, 1));
+  EXPECT_EQ(3u, sink->AddPackets(data, 3, 4));
+
+  const VirtualSinkStats stats = CAESinkVirtual::GetStats();
+  ASSERT_EQ(6u * 4, stats.capture.size());
+  std::vector<int16_t> captured(12);
+  memcpy(captured.data(), stats.capture.data(), stats.capture.size());
+  EXPECT_EQ((std::vector<int16_t>{2, 3, 4, 5, 6, 7, 8, 9, 8, 9, 10, 11}), captured);
+  EXPECT_EQ(7u, stats.framesWritten);
+  EXPECT_EQ(2u, stats.addPacketsCalls);
+}
+
+TEST_F(TestAESinkVirtual, CapturePlanar)
+{
+  VirtualSinkConfig config;
+  config.clock = VirtualSinkConfig::Clock::FREE_RUNNING;
+  config.dataFormat = AE_FMT_FLOATP;
+  config.captureFrames = 3;
+
+  AEAudioFormat format = MakeFormat(AE_FMT_FLOATP, 48000, AE_CH_LAYOUT_2_0);
+  auto sink = OpenSink(config, "default", format);
+  ASSERT_TRUE(sink);
+
+  float left[] = {1.0f, 2.0f, 3.0f};
+  float right[] = {-1.0f, -2.0f, -3.0f};
+  uint8_t* data[] = {reinterpret_cast<uint8_t*>(left), reinterpret_cast<uint8_t*>(right)};
+  sink->AddPackets(data, 3, 0);
+
+  const VirtualSinkStats stats = CAESinkVirtual::GetStats();
+  ASSERT_EQ(6 * sizeof(float), stats.capture.size());
+  float captured[6];
+  memcpy(captured, stats.capture.data(), sizeof(captured));
+  EXPECT_FLOAT_EQ(1.0f, captured[0]);
+  EXPECT_FLOAT_EQ(-1.0f, captured[1]);
+  EXPECT_FLOAT_EQ(3.0f, captured[4]);
+  EXPECT_FLOAT_EQ(-3.0f, captured[5]);
+}
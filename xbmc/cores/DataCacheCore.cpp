@@ -17,6 +17,7 @@
 CDataCacheCore::CDataCacheCore() :
   m_playerVideoInfo {},
   m_playerAudioInfo {},
+  m_gameInfo {},
   m_contentInfo {},
   m_renderInfo {},
   m_stateInfo {}
@@ -246,6 +247,42 @@ int CDataCacheCore::GetAudioBitsPerSample()
   return m_playerAudioInfo.bitsPerSample;
 }
 
+void CDataCacheCore::SetAudioLatency(double latency)
+{
+  CSingleLock lock(m_audioPlayerSection);
+
+  m_playerAudioInfo.latency = latency;
+}
+
+double CDataCacheCore::GetAudioLatency()
+{
+  CSingleLock lock(m_audioPlayerSection);
+
+  return m_playerAudioInfo.latency;
+}
+
+void CDataCacheCore::SetGameRunAhead(double cpuTime, double latencySaved)
+{
+  CSingleLock lock(m_gameSection);
+
+  m_gameInfo.runAheadCpuTime = cpuTime;
+  m_gameInfo.runAheadLatencySaved = latencySaved;
+}
+
+double CDataCacheCore::GetGameRunAheadCpuTime()
+{
+  CSingleLock lock(m_gameSection);
+
+  return m_gameInfo.runAheadCpuTime;
+}
+
+double CDataCacheCore::GetGameRunAheadLatencySaved()
+{
+  CSingleLock lock(m_gameSection);
+
+  return m_gameInfo.runAheadLatencySaved;
+}
+
 void CDataCacheCore::SetCutList(const std::vector<EDL::Cut>& cutList)
 {
   CSingleLock lock(m_contentSection);
@@ -58,6 +58,13 @@ public:
   int GetAudioSampleRate();
   void SetAudioBitsPerSample(int bitsPerSample);
   int GetAudioBitsPerSample();
+  void SetAudioLatency(double latency);
+  double GetAudioLatency();
+
+  // game info
+  void SetGameRunAhead(double cpuTime, double latencySaved);
+  double GetGameRunAheadCpuTime();
+  double GetGameRunAheadLatencySaved();
 
   // content info
   void SetCutList(const std::vector<EDL::Cut>& cutList);
@@ -150,8 +157,16 @@ protected:
     std::string channels;
     int sampleRate;
     int bitsPerSample;
+    double latency; // seconds until added audio is heard
   } m_playerAudioInfo;
 
+  CCriticalSection m_gameSection;
+  struct SGameInfo
+  {
+    double runAheadCpuTime; // seconds spent emulating ahead per frame
+    double runAheadLatencySaved; // seconds of input latency removed by run-ahead
+  } m_gameInfo;
+
   mutable CCriticalSection m_contentSection;
   struct SContentInfo
   {
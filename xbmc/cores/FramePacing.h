@@ -0,0 +1,60 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+enum class FrameDropReason
+{
+  NONE = 0, //!< the frame was presented
+  LATE, //!< skipped by the render manager because a later frame was already due
+  DISCARDED, //!< dropped from the render queue on flush or while the GUI was not rendering
+};
+
+/*!
+ * \brief Timing of a single video frame on its way through the render queue.
+ *
+ * Times are in microseconds of a monotonic clock, pts is in DVD clock units.
+ */
+struct FramePacingEvent
+{
+  double pts = 0.0;
+  int64_t queueTime = 0; //!< when the frame was added to the render queue
+  int64_t presentTime = 0; //!< when the frame was rendered, 0 if it was dropped
+  double refreshDelta = 0.0; //!< refresh periods since the previous presented frame
+  FrameDropReason dropReason = FrameDropReason::NONE;
+};
+
+/*!
+ * \brief Frame pacing counters accumulated since playback start or the last reset.
+ */
+struct FramePacingStats
+{
+  //! refresh periods a frame stayed on screen: 0, 1, ... REFRESH_BUCKETS - 1 or more
+  static constexpr int REFRESH_BUCKETS = 8;
+  //! deviation of the present interval from the frame duration: < 1, 2, 4, ... ms, the last
+  //! bucket holds everything above
+  static constexpr int JUDDER_BUCKETS = 8;
+
+  float refreshRate = 0.0f;
+  float frameRate = 0.0f;
+
+  uint64_t presented = 0;
+  uint64_t late = 0;
+  uint64_t discarded = 0;
+
+  uint64_t refreshHistogram[REFRESH_BUCKETS] = {};
+  uint64_t judderHistogram[JUDDER_BUCKETS] = {};
+
+  //! upper bound of a judder bucket in milliseconds, 0 for the open-ended last bucket
+  static int JudderBucketLimit(int bucket)
+  {
+    return bucket < JUDDER_BUCKETS - 1 ? 1 << bucket : 0;
+  }
+};
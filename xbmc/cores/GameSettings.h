@@ -55,6 +55,11 @@ constexpr const char* STRETCHMODE_STRETCH_4_3_ID = "4:3";
 constexpr const char* STRETCHMODE_FULLSCREEN_ID = "fullscreen";
 constexpr const char* STRETCHMODE_ORIGINAL_ID = "original";
 
+/*!
+ * \brief Maximum number of frames the game can be emulated ahead of the input
+ */
+constexpr unsigned int MAX_RUNAHEAD_FRAMES = 4;
+
 enum class RENDERFEATURE
 {
   ROTATION,
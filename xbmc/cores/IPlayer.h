@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "FramePacing.h"
 #include "IPlayerCallback.h"
 #include "Interface/StreamInfo.h"
 #include "VideoSettings.h"
@@ -223,6 +224,13 @@ public:
   virtual void RenderCapture(unsigned int captureId, unsigned int width, unsigned int height, int flags) {};
   virtual bool RenderCaptureGetPixels(unsigned int captureId, unsigned int millis, uint8_t *buffer, unsigned int size) { return false; };
 
+  /*!
+   \brief frame pacing telemetry of the video renderer
+   \param maxEvents limit of the most recent per-frame events to return, 0 for all
+   */
+  virtual bool GetFramePacing(FramePacingStats& stats, std::vector<FramePacingEvent>& events, unsigned int maxEvents) { return false; };
+  virtual void ResetFramePacing() {};
+
   // video and audio settings
   virtual CVideoSettings GetVideoSettings() { return CVideoSettings(); };
   virtual void SetVideoSettings(CVideoSettings& settings) {};
@@ -213,7 +213,7 @@ bool CRetroPlayer::CloseFile(bool reopen /* = false */)
 
   if (m_gameClient && m_gameServices.GameSettings().AutosaveEnabled())
   {
-    std::string savePath = m_playback->CreateSavestate();
+    std::string savePath = m_playback->CreateSavestate(false);
     if (!savePath.empty())
       CLog::Log(LOGDEBUG, "RetroPlayer[SAVE]: Saved state to {}", CURL::GetRedacted(savePath));
     else
@@ -435,7 +435,7 @@ std::string CRetroPlayer::GetPlayerState()
 
   if (m_autoSave)
   {
-    savestatePath = m_playback->CreateSavestate();
+    savestatePath = m_playback->CreateSavestate(false);
     if (savestatePath.empty())
     {
       CLog::Log(LOGDEBUG, "RetroPlayer[SAVE]: Continuing without saving");
@@ -525,7 +525,7 @@ bool CRetroPlayer::IsAutoSaveEnabled() const
 
 std::string CRetroPlayer::CreateSavestate()
 {
-  return m_playback->CreateSavestate();
+  return m_playback->CreateSavestate(true);
 }
 
 void CRetroPlayer::SetSpeedInternal(double speed)
@@ -542,7 +542,6 @@ void CRetroPlayer::OnSpeedChange(double newSpeed)
 {
   m_streamManager->EnableAudio(newSpeed == 1.0);
   m_input->SetSpeed(newSpeed);
-  m_renderManager->SetSpeed(newSpeed);
   m_processInfo->SetSpeed(static_cast<float>(newSpeed));
 }
 
@@ -551,7 +550,8 @@ void CRetroPlayer::CreatePlayback(bool bRestoreState)
   if (m_gameClient->RequiresGameLoop())
   {
     m_playback->Deinitialize();
-    m_playback.reset(new CReversiblePlayback(m_gameClient.get(), m_gameClient->GetFrameRate(),
+    m_playback.reset(new CReversiblePlayback(m_gameClient.get(), *m_streamManager, *m_processInfo,
+                                             m_gameClient->GetFrameRate(),
                                              m_gameClient->GetSerializeSize()));
   }
   else
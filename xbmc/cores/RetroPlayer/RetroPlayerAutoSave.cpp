@@ -55,7 +55,7 @@ void CRetroPlayerAutoSave::Process()
     {
       std::string savePath = m_callback.CreateSavestate();
       if (!savePath.empty())
-        CLog::Log(LOGDEBUG, "RetroPlayer[SAVE]: Saved state to {}", CURL::GetRedacted(savePath));
+        CLog::Log(LOGDEBUG, "RetroPlayer[SAVE]: Saving state to {}", CURL::GetRedacted(savePath));
     }
   }
 
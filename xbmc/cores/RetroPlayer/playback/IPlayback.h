@@ -37,7 +37,9 @@ public:
   virtual void PauseAsync() = 0; // Pauses after the following frame
 
   // Savestates
-  virtual std::string CreateSavestate() = 0; // Returns the path of savestate on success
+  // Returns the path of savestate on success. Autosaves are written in the
+  // background, so their path is returned before the savestate exists.
+  virtual std::string CreateSavestate(bool autosave) = 0;
   virtual bool LoadSavestate(const std::string& path) = 0;
 };
 } // namespace RETRO
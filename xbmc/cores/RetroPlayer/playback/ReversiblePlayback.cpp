@@ -9,29 +9,46 @@
 #include "ReversiblePlayback.h"
 
 #include "ServiceBroker.h"
+#include "cores/GameSettings.h"
+#include "cores/RetroPlayer/process/RPProcessInfo.h"
 #include "cores/RetroPlayer/savestates/ISavestate.h"
 #include "cores/RetroPlayer/savestates/SavestateDatabase.h"
-#include "cores/RetroPlayer/streams/memory/DeltaPairMemoryStream.h"
+#include "cores/RetroPlayer/savestates/SavestateWriter.h"
+#include "cores/RetroPlayer/streams/RPStreamManager.h"
+#include "cores/RetroPlayer/streams/memory/BlockDeltaMemoryStream.h"
 #include "games/GameServices.h"
 #include "games/GameSettings.h"
 #include "games/addons/GameClient.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/GameSettings.h"
+#include "settings/MediaSettings.h"
+#include "settings/SettingsComponent.h"
 #include "threads/SingleLock.h"
 #include "utils/MathUtils.h"
 #include "utils/URIUtils.h"
+#include "utils/log.h"
 
 #include <algorithm>
+#include <chrono>
 
 using namespace KODI;
 using namespace RETRO;
 
 #define REWIND_FACTOR 0.25 // Rewind at 25% of gameplay speed
+#define STATS_INTERVAL_SEC 60 // Log rewind buffer stats once a minute
+#define RUNAHEAD_SMOOTHING 0.05 // Weight of the last frame in the run-ahead CPU time
 
 CReversiblePlayback::CReversiblePlayback(GAME::CGameClient* gameClient,
+                                         CRPStreamManager& streamManager,
+                                         CRPProcessInfo& processInfo,
                                          double fps,
                                          size_t serializeSize)
   : m_gameClient(gameClient),
+    m_streamManager(streamManager),
+    m_processInfo(processInfo),
     m_gameLoop(this, fps),
     m_savestateDatabase(new CSavestateDatabase),
+    m_savestateWriter(new CSavestateWriter),
     m_totalFrameCount(0),
     m_pastFrameCount(0),
     m_futureFrameCount(0),
@@ -41,12 +58,22 @@ CReversiblePlayback::CReversiblePlayback(GAME::CGameClient* gameClient,
 {
   UpdateMemoryStream();
 
+  // Restore the run-ahead chosen for this game
+  CGameSettings& currentSettings = CMediaSettings::GetInstance().GetCurrentGameSettings();
+  if (!m_gameClient->GetGamePath().empty())
+    currentSettings.SetRunAheadFrames(
+        CMediaSettings::GetInstance().GetGameRunAheadFrames(m_gameClient->GetGamePath()));
+  UpdateRunAhead();
+
   GAME::CGameSettings& gameSettings = CServiceBroker::GetGameServices().GameSettings();
   gameSettings.RegisterObserver(this);
+  currentSettings.RegisterObserver(this);
 }
 
 CReversiblePlayback::~CReversiblePlayback()
 {
+  CGameSettings& currentSettings = CMediaSettings::GetInstance().GetCurrentGameSettings();
+  currentSettings.UnregisterObserver(this);
   GAME::CGameSettings& gameSettings = CServiceBroker::GetGameServices().GameSettings();
   gameSettings.UnregisterObserver(this);
 
@@ -108,7 +135,7 @@ void CReversiblePlayback::PauseAsync()
   m_gameLoop.PauseAsync();
 }
 
-std::string CReversiblePlayback::CreateSavestate()
+std::string CReversiblePlayback::CreateSavestate(bool autosave)
 {
   const size_t memorySize = m_gameClient->SerializeSize();
 
@@ -122,47 +149,53 @@ std::string CReversiblePlayback::CreateSavestate()
     return "";
   }
 
-  const CDateTime now = CDateTime::GetCurrentDateTime();
-  const std::string label = now.GetAsLocalizedDateTime();
-  const std::string gameFileName = URIUtils::GetFileName(m_gameClient->GetGamePath());
-  const uint64_t timestampFrames = m_totalFrameCount;
-  const double timestampWallClock =
+  const auto start = std::chrono::steady_clock::now();
+
+  SavestateProperties properties;
+  properties.type = SAVE_TYPE::AUTO;
+  properties.created = CDateTime::GetCurrentDateTime();
+  properties.label = properties.created.GetAsLocalizedDateTime();
+  properties.gameFileName = URIUtils::GetFileName(m_gameClient->GetGamePath());
+  properties.timestampFrames = m_totalFrameCount;
+  properties.timestampWallClock =
       (m_totalFrameCount /
        m_gameClient->GetFrameRate()); //! @todo Accumulate playtime instead of deriving it
-  const std::string gameClientId = m_gameClient->ID();
-  const std::string gameClientVersion = m_gameClient->Version().asString();
-
-  std::unique_ptr<ISavestate> savestate = m_savestateDatabase->CreateSavestate();
-
-  savestate->SetType(SAVE_TYPE::AUTO);
-  savestate->SetLabel(label);
-  savestate->SetCreated(now);
-  savestate->SetGameFileName(gameFileName);
-  savestate->SetTimestampFrames(timestampFrames);
-  savestate->SetTimestampWallClock(timestampWallClock);
-  savestate->SetGameClientID(gameClientId);
-  savestate->SetGameClientVersion(gameClientVersion);
+  properties.gameClientId = m_gameClient->ID();
+  properties.gameClientVersion = m_gameClient->Version().asString();
 
-  uint8_t* memoryData = savestate->GetMemoryBuffer(memorySize);
+  // Only the snapshot of the memory stalls the game, compressing and writing
+  // an autosave is left to the writer's thread
+  std::vector<uint8_t> memoryData = m_savestateWriter->GetBuffer(memorySize);
 
   {
     CSingleLock lock(m_mutex);
     if (m_memoryStream && m_memoryStream->CurrentFrame() != nullptr)
     {
-      std::memcpy(memoryData, m_memoryStream->CurrentFrame(), memorySize);
+      std::memcpy(memoryData.data(), m_memoryStream->CurrentFrame(), memorySize);
     }
     else
     {
       lock.Leave();
-      if (!m_gameClient->Serialize(memoryData, memorySize))
+      if (!m_gameClient->Serialize(memoryData.data(), memorySize))
         return "";
     }
   }
 
-  savestate->Finalize();
+  const auto snapshotTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  CLog::Log(LOGDEBUG, "RetroPlayer[SAVE]: Took snapshot of {} bytes in {} us", memorySize,
+            snapshotTime.count());
 
-  if (!m_savestateDatabase->AddSavestate(m_gameClient->GetGamePath(), *savestate))
+  if (autosave)
+  {
+    m_savestateWriter->Write(m_gameClient->GetGamePath(), std::move(properties),
+                             std::move(memoryData));
+  }
+  else if (!m_savestateWriter->WriteNow(m_gameClient->GetGamePath(), properties,
+                                        std::move(memoryData)))
+  {
     return "";
+  }
 
   return m_gameClient->GetGamePath();
 }
@@ -177,18 +210,20 @@ bool CReversiblePlayback::LoadSavestate(const std::string& path)
 
   bool bSuccess = false;
 
+  // A savestate of this game may still be queued
+  m_savestateWriter->Flush();
+
   std::unique_ptr<ISavestate> savestate = m_savestateDatabase->CreateSavestate();
   if (m_savestateDatabase->GetSavestate(path, *savestate) &&
       savestate->GetMemorySize() == memorySize)
   {
+    CSingleLock lock(m_mutex);
+
+    if (m_memoryStream)
     {
-      CSingleLock lock(m_mutex);
-      if (m_memoryStream)
-      {
-        m_memoryStream->SetFrameCounter(savestate->TimestampFrames());
-        std::memcpy(m_memoryStream->BeginFrame(), savestate->GetMemoryData(), memorySize);
-        m_memoryStream->SubmitFrame();
-      }
+      m_memoryStream->SetFrameCounter(savestate->TimestampFrames());
+      std::memcpy(m_memoryStream->BeginFrame(), savestate->GetMemoryData(), memorySize);
+      m_memoryStream->SubmitFrame();
     }
 
     if (m_gameClient->Deserialize(savestate->GetMemoryData(), memorySize))
@@ -203,9 +238,19 @@ bool CReversiblePlayback::LoadSavestate(const std::string& path)
 
 void CReversiblePlayback::FrameEvent()
 {
-  m_gameClient->RunFrame();
+  const unsigned int runAheadFrames = m_runAheadFrames;
 
-  AddFrame();
+  if (runAheadFrames > 0)
+  {
+    // The run-ahead state must not be replaced before it is added
+    CSingleLock lock(m_mutex);
+    AddFrame(RunAhead(runAheadFrames));
+  }
+  else
+  {
+    m_gameClient->RunFrame();
+    AddFrame(nullptr);
+  }
 }
 
 void CReversiblePlayback::RewindEvent()
@@ -215,22 +260,115 @@ void CReversiblePlayback::RewindEvent()
   m_gameClient->RunFrame();
 }
 
-void CReversiblePlayback::AddFrame()
+void CReversiblePlayback::AddFrame(const uint8_t* state)
 {
   CSingleLock lock(m_mutex);
 
   if (m_memoryStream)
   {
-    if (m_gameClient->Serialize(m_memoryStream->BeginFrame(), m_memoryStream->FrameSize()))
+    bool bSuccess;
+    if (state != nullptr)
+    {
+      // Already serialized by run-ahead
+      std::memcpy(m_memoryStream->BeginFrame(), state, m_memoryStream->FrameSize());
+      bSuccess = true;
+    }
+    else
+      bSuccess = m_gameClient->Serialize(m_memoryStream->BeginFrame(), m_memoryStream->FrameSize());
+
+    if (bSuccess)
     {
       m_memoryStream->SubmitFrame();
       UpdatePlaybackStats();
+
+      // Only submitted frames advance the frame count, so the stats aren't
+      // logged again for every frame that fails to serialize
+      const MemoryStreamStats stats = m_memoryStream->GetStats();
+      const uint64_t statsInterval =
+          std::max(MathUtils::round_int(STATS_INTERVAL_SEC * m_gameLoop.FPS()), 1);
+      if (stats.frameCount > 0 && stats.frameCount % statsInterval == 0)
+      {
+        CLog::Log(LOGDEBUG,
+                  "ReversiblePlayback: Rewind buffer holds {} frames in {} KiB, {:.0f} bytes "
+                  "and {:.0f} us per frame",
+                  m_memoryStream->PastFramesAvailable(), stats.memoryUsage / 1024,
+                  stats.bytesPerFrame, stats.encodeTimeUs);
+      }
     }
   }
 
   m_totalFrameCount++;
 }
 
+const uint8_t* CReversiblePlayback::RunAhead(unsigned int frames)
+{
+  using namespace std::chrono;
+
+  // Loading a savestate, rewinding or advancing in between would be undone
+  // by the roll back
+  CSingleLock lock(m_mutex);
+
+  const size_t stateSize = m_gameClient->SerializeSize();
+  m_runAheadState.resize(stateSize);
+
+  // Run the frame that is kept. Its audio is played, but its video is
+  // replaced by the last frame run ahead.
+  m_streamManager.SuppressVideo(true);
+  m_gameClient->RunFrame();
+
+  const auto start = steady_clock::now();
+
+  if (!m_gameClient->Serialize(m_runAheadState.data(), stateSize))
+  {
+    m_streamManager.SuppressVideo(false);
+    CLog::Log(LOGERROR, "ReversiblePlayback: Failed to serialize game, disabling run-ahead");
+    m_runAheadFrames = 0;
+    m_processInfo.SetRunAhead(0.0, 0.0);
+    return nullptr;
+  }
+
+  // Emulate the next frames with the current input. Only the video of the
+  // last one is presented, no audio is heard.
+  m_streamManager.SuppressAudio(true);
+  for (unsigned int i = 0; i < frames; i++)
+  {
+    if (i + 1 == frames)
+      m_streamManager.SuppressVideo(false);
+    m_gameClient->RunFrame();
+  }
+  m_streamManager.SuppressAudio(false);
+
+  // Roll back to the frame that is kept
+  m_gameClient->Deserialize(m_runAheadState.data(), stateSize);
+
+  const double cpuTime = duration<double>(steady_clock::now() - start).count();
+  if (frames != m_runAheadStatsFrames)
+  {
+    // Restart the statistics when the number of frames changes
+    m_runAheadStatsFrames = frames;
+    m_runAheadFrameCount = 0;
+  }
+  if (m_runAheadFrameCount++ == 0)
+    m_runAheadCpuTime = cpuTime;
+  else
+    m_runAheadCpuTime += (cpuTime - m_runAheadCpuTime) * RUNAHEAD_SMOOTHING;
+
+  const double latencySaved = frames / m_gameLoop.FPS();
+  m_processInfo.SetRunAhead(m_runAheadCpuTime, latencySaved);
+
+  const uint64_t statsInterval =
+      std::max(MathUtils::round_int(STATS_INTERVAL_SEC * m_gameLoop.FPS()), 1);
+  if (m_runAheadFrameCount % statsInterval == 0)
+  {
+    CLog::Log(LOGDEBUG,
+              "ReversiblePlayback: Run-ahead of {} frames saves {:.1f} ms of latency for {:.2f} "
+              "ms of CPU time per frame",
+              frames, latencySaved * 1000.0, m_runAheadCpuTime * 1000.0);
+  }
+
+  return m_runAheadState.data();
+}
+
 void CReversiblePlayback::RewindFrames(uint64_t frames)
 {
   CSingleLock lock(m_mutex);
@@ -279,6 +417,7 @@ void CReversiblePlayback::Notify(const Observable& obs, const ObservableMessage
   {
     case ObservableMessageSettingsChanged:
       UpdateMemoryStream();
+      UpdateRunAhead();
       break;
     default:
       break;
@@ -304,9 +443,14 @@ void CReversiblePlayback::UpdateMemoryStream()
 
     unsigned int frameCount = MathUtils::round_int(rewindBufferSec * m_gameLoop.FPS());
 
+    const size_t memoryBudget = static_cast<size_t>(CServiceBroker::GetSettingsComponent()
+                                                        ->GetAdvancedSettings()
+                                                        ->m_gamesRewindMemorySize) *
+                                1024 * 1024;
+
     if (!m_memoryStream)
     {
-      m_memoryStream.reset(new CDeltaPairMemoryStream);
+      m_memoryStream.reset(new CBlockDeltaMemoryStream(memoryBudget));
       m_memoryStream->Init(m_gameClient->SerializeSize(), frameCount);
     }
 
@@ -314,6 +458,9 @@ void CReversiblePlayback::UpdateMemoryStream()
     {
       m_memoryStream->SetMaxFrameCount(frameCount);
     }
+
+    if (m_memoryStream->MemoryBudget() != memoryBudget)
+      m_memoryStream->SetMemoryBudget(memoryBudget);
   }
   else
   {
@@ -327,3 +474,27 @@ void CReversiblePlayback::UpdateMemoryStream()
     m_cacheTimeMs = 0;
   }
 }
+
+void CReversiblePlayback::UpdateRunAhead()
+{
+  const CGameSettings& gameSettings = CMediaSettings::GetInstance().GetCurrentGameSettings();
+  const unsigned int runAheadFrames = std::min(gameSettings.RunAheadFrames(), MAX_RUNAHEAD_FRAMES);
+
+  // Remember the choice for the next time this game is played
+  const std::string& gamePath = m_gameClient->GetGamePath();
+  if (!gamePath.empty() &&
+      CMediaSettings::GetInstance().GetGameRunAheadFrames(gamePath) != runAheadFrames)
+    CMediaSettings::GetInstance().SetGameRunAheadFrames(gamePath, runAheadFrames);
+
+  // Game client must support serialization
+  if (m_gameClient->SerializeSize() == 0)
+    return;
+
+  if (m_runAheadFrames.exchange(runAheadFrames) != runAheadFrames)
+  {
+    CLog::Log(LOGDEBUG, "ReversiblePlayback: Running {} frames ahead", runAheadFrames);
+
+    if (runAheadFrames == 0)
+      m_processInfo.SetRunAhead(0.0, 0.0);
+  }
+}
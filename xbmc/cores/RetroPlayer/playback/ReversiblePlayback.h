@@ -13,9 +13,11 @@
 #include "threads/CriticalSection.h"
 #include "utils/Observer.h"
 
+#include <atomic>
 #include <memory>
 #include <stddef.h>
 #include <stdint.h>
+#include <vector>
 
 namespace KODI
 {
@@ -26,13 +28,20 @@ class CGameClient;
 
 namespace RETRO
 {
+class CBlockDeltaMemoryStream;
+class CRPProcessInfo;
+class CRPStreamManager;
 class CSavestateDatabase;
-class IMemoryStream;
+class CSavestateWriter;
 
 class CReversiblePlayback : public IPlayback, public IGameLoopCallback, public Observer
 {
 public:
-  CReversiblePlayback(GAME::CGameClient* gameClient, double fps, size_t serializeSize);
+  CReversiblePlayback(GAME::CGameClient* gameClient,
+                      CRPStreamManager& streamManager,
+                      CRPProcessInfo& processInfo,
+                      double fps,
+                      size_t serializeSize);
 
   ~CReversiblePlayback() override;
 
@@ -48,7 +57,7 @@ public:
   double GetSpeed() const override;
   void SetSpeed(double speedFactor) override;
   void PauseAsync() override;
-  std::string CreateSavestate() override;
+  std::string CreateSavestate(bool autosave) override;
   bool LoadSavestate(const std::string& path) override;
 
   // implementation of IGameLoopCallback
@@ -59,22 +68,39 @@ public:
   void Notify(const Observable& obs, const ObservableMessage msg) override;
 
 private:
-  void AddFrame();
+  void AddFrame(const uint8_t* state);
+  /*!
+   * \brief Run the next frame, but present the video of a frame further ahead
+   *
+   * \return The serialized state after the next frame, or nullptr on failure
+   */
+  const uint8_t* RunAhead(unsigned int frames);
   void RewindFrames(uint64_t frames);
   void AdvanceFrames(uint64_t frames);
   void UpdatePlaybackStats();
   void UpdateMemoryStream();
+  void UpdateRunAhead();
 
   // Construction parameter
   GAME::CGameClient* const m_gameClient;
+  CRPStreamManager& m_streamManager;
+  CRPProcessInfo& m_processInfo;
 
   // Gameplay functionality
   CGameLoop m_gameLoop;
-  std::unique_ptr<IMemoryStream> m_memoryStream;
+  std::unique_ptr<CBlockDeltaMemoryStream> m_memoryStream;
   CCriticalSection m_mutex;
 
   // Savestate functionality
   std::unique_ptr<CSavestateDatabase> m_savestateDatabase;
+  std::unique_ptr<CSavestateWriter> m_savestateWriter;
+
+  // Run-ahead functionality
+  std::atomic<unsigned int> m_runAheadFrames{0};
+  std::vector<uint8_t> m_runAheadState;
+  double m_runAheadCpuTime = 0.0; // Smoothed seconds spent per frame emulating ahead
+  unsigned int m_runAheadStatsFrames = 0;
+  uint64_t m_runAheadFrameCount = 0;
 
   // Playback stats
   uint64_t m_totalFrameCount;
@@ -161,6 +161,8 @@ void CRPProcessInfo::ResetInfo()
     m_dataCache->SetAudioChannels("");
     m_dataCache->SetAudioSampleRate(0);
     m_dataCache->SetAudioBitsPerSample(0);
+    m_dataCache->SetAudioLatency(0.0);
+    m_dataCache->SetGameRunAhead(0.0, 0.0);
     m_dataCache->SetRenderClockSync(false);
     m_dataCache->SetStateSeeking(false);
     m_dataCache->SetSpeed(1.0f, 1.0f);
@@ -227,6 +229,21 @@ void CRPProcessInfo::SetAudioBitsPerSample(int bitsPerSample)
     m_dataCache->SetAudioBitsPerSample(bitsPerSample);
 }
 
+void CRPProcessInfo::SetAudioLatency(double latency)
+{
+  if (m_dataCache != nullptr)
+    m_dataCache->SetAudioLatency(latency);
+}
+
+//******************************************************************************
+// game info
+//******************************************************************************
+void CRPProcessInfo::SetRunAhead(double cpuTime, double latencySaved)
+{
+  if (m_dataCache != nullptr)
+    m_dataCache->SetGameRunAhead(cpuTime, latencySaved);
+}
+
 //******************************************************************************
 // player states
 //******************************************************************************
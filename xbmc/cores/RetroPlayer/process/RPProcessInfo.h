@@ -156,6 +156,12 @@ public:
   void SetAudioChannels(const std::string& channels);
   void SetAudioSampleRate(int sampleRate);
   void SetAudioBitsPerSample(int bitsPerSample);
+  void SetAudioLatency(double latency);
+  ///}
+
+  /// @name Game info
+  ///{
+  void SetRunAhead(double cpuTime, double latencySaved);
   ///}
 
   /// @name Player states
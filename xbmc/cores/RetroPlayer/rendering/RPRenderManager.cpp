@@ -21,6 +21,7 @@
 #include "cores/RetroPlayer/rendering/VideoRenderers/RPBaseRenderer.h"
 #include "threads/SingleLock.h"
 #include "utils/Color.h"
+#include "utils/FrameCopy.h"
 #include "utils/TransformMatrix.h"
 #include "utils/log.h"
 
@@ -30,7 +31,6 @@ extern "C"
 }
 
 #include <algorithm>
-#include <cstring>
 
 using namespace KODI;
 using namespace RETRO;
@@ -63,9 +63,13 @@ void CRPRenderManager::Deinitialize()
     renderBuffer->Release();
   m_renderBuffers.clear();
 
-  for (auto buffer : m_pendingBuffers)
-    buffer->Release();
-  m_pendingBuffers.clear();
+  if (m_pendingBuffer != nullptr)
+  {
+    m_pendingBuffer->ReleaseMemory();
+    m_pendingBuffer->Release();
+    m_pendingBuffer = nullptr;
+    m_pendingMemory = nullptr;
+  }
 
   m_renderers.clear();
 
@@ -97,35 +101,50 @@ bool CRPRenderManager::Configure(AVPixelFormat format,
 bool CRPRenderManager::GetVideoBuffer(
     unsigned int width, unsigned int height, AVPixelFormat& format, uint8_t*& data, size_t& size)
 {
-  for (IRenderBuffer* buffer : m_pendingBuffers)
-    buffer->Release();
-  m_pendingBuffers.clear();
+  // The game client didn't submit the previous buffer
+  if (m_pendingBuffer != nullptr)
+  {
+    m_pendingBuffer->ReleaseMemory();
+    m_pendingBuffer->Release();
+    m_pendingBuffer = nullptr;
+    m_pendingMemory = nullptr;
+  }
 
   if (m_bFlush || m_state != RENDER_STATE::CONFIGURED)
     return false;
 
-  // Get buffers from visible renderers
+  // Get a buffer from the first buffer pool with a visible renderer. Pools of
+  // other visible renderers receive a copy in AddFrame().
   for (IRenderBufferPool* bufferPool : m_processInfo.GetBufferManager().GetBufferPools())
   {
     if (!bufferPool->HasVisibleRenderer())
       continue;
 
     IRenderBuffer* renderBuffer = bufferPool->GetBuffer(width, height);
-    if (renderBuffer != nullptr)
-      m_pendingBuffers.emplace_back(renderBuffer);
-    else
+    if (renderBuffer == nullptr)
+    {
       CLog::Log(LOGDEBUG, "RetroPlayer[RENDER]: Unable to get video buffer for frame");
+      continue;
+    }
+
+    uint8_t* memory = renderBuffer->GetMemory();
+    if (memory == nullptr)
+    {
+      renderBuffer->Release();
+      continue;
+    }
+
+    m_pendingBuffer = renderBuffer;
+    m_pendingMemory = memory;
+    break;
   }
 
-  if (m_pendingBuffers.empty())
+  if (m_pendingBuffer == nullptr)
     return false;
 
-  //! @todo Handle multiple buffers
-  IRenderBuffer* renderBuffer = m_pendingBuffers.at(0);
-
-  format = renderBuffer->GetFormat();
-  data = renderBuffer->GetMemory();
-  size = renderBuffer->GetFrameSize();
+  format = m_pendingBuffer->GetFormat();
+  data = m_pendingMemory;
+  size = m_pendingBuffer->GetFrameSize();
 
   return true;
 }
@@ -136,44 +155,64 @@ void CRPRenderManager::AddFrame(const uint8_t* data,
                                 unsigned int height,
                                 unsigned int orientationDegCCW)
 {
-  if (m_bFlush || m_state != RENDER_STATE::CONFIGURED)
-    return;
+  // Take back the buffer if the game client rendered into it
+  IRenderBuffer* zeroCopyBuffer = nullptr;
+  if (m_pendingBuffer != nullptr)
+  {
+    if (data == m_pendingMemory)
+    {
+      zeroCopyBuffer = m_pendingBuffer;
+    }
+    else
+    {
+      m_pendingBuffer->ReleaseMemory();
+      m_pendingBuffer->Release();
+    }
+    m_pendingBuffer = nullptr;
+    m_pendingMemory = nullptr;
+  }
 
-  // Validate parameters
-  if (data == nullptr || size == 0 || width == 0 || height == 0)
+  if (m_bFlush || m_state != RENDER_STATE::CONFIGURED || data == nullptr || size == 0 ||
+      width == 0 || height == 0)
+  {
+    if (zeroCopyBuffer != nullptr)
+    {
+      zeroCopyBuffer->ReleaseMemory();
+      zeroCopyBuffer->Release();
+    }
     return;
+  }
+
+  // A zero-copy frame is in the format of its buffer
+  const AVPixelFormat format = (zeroCopyBuffer != nullptr ? zeroCopyBuffer->GetFormat() : m_format);
 
   // Get render buffers to copy the frame into
   std::vector<IRenderBuffer*> renderBuffers;
 
-  // Check pending buffers
-  for (IRenderBuffer* buffer : m_pendingBuffers)
+  // Copy frame to buffers with visible renderers, skipping the pool of the
+  // buffer the frame was rendered into
+  for (IRenderBufferPool* bufferPool : m_processInfo.GetBufferManager().GetBufferPools())
   {
-    if (buffer->GetMemory() == data)
+    if (!bufferPool->HasVisibleRenderer())
+      continue;
+
+    if (zeroCopyBuffer != nullptr && zeroCopyBuffer->GetPool() == bufferPool)
+      continue;
+
+    IRenderBuffer* renderBuffer = bufferPool->GetBuffer(width, height);
+    if (renderBuffer != nullptr)
     {
-      buffer->Acquire();
-      renderBuffers.emplace_back(buffer);
+      CopyFrame(renderBuffer, format, data, size, width, height);
+      renderBuffers.emplace_back(renderBuffer);
     }
+    else
+      CLog::Log(LOGDEBUG, "RetroPlayer[RENDER]: Unable to get render buffer for frame");
   }
 
-  // If we aren't submitting a zero-copy frame, copy into render buffer now
-  if (renderBuffers.empty())
+  if (zeroCopyBuffer != nullptr)
   {
-    // Copy frame to buffers with visible renderers
-    for (IRenderBufferPool* bufferPool : m_processInfo.GetBufferManager().GetBufferPools())
-    {
-      if (!bufferPool->HasVisibleRenderer())
-        continue;
-
-      IRenderBuffer* renderBuffer = bufferPool->GetBuffer(width, height);
-      if (renderBuffer != nullptr)
-      {
-        CopyFrame(renderBuffer, m_format, data, size, width, height);
-        renderBuffers.emplace_back(renderBuffer);
-      }
-      else
-        CLog::Log(LOGDEBUG, "RetroPlayer[RENDER]: Unable to get render buffer for frame");
-    }
+    zeroCopyBuffer->ReleaseMemory();
+    renderBuffers.insert(renderBuffers.begin(), zeroCopyBuffer);
   }
 
   {
@@ -187,42 +226,9 @@ void CRPRenderManager::AddFrame(const uint8_t* data,
     // Apply rotation to render buffers
     for (auto renderBuffer : m_renderBuffers)
       renderBuffer->SetRotation(orientationDegCCW);
-
-    // Cache frame if it arrived after being paused
-    if (m_speed == 0.0)
-    {
-      std::vector<uint8_t> cachedFrame = std::move(m_cachedFrame);
-
-      if (!m_bHasCachedFrame)
-      {
-        // In this case, cachedFrame is definitely empty (see invariant for
-        // m_bHasCachedFrame). Otherwise, cachedFrame may be empty if the frame
-        // is being copied in the rendering thread. In that case, we would want
-        // to leave cached frame empty to avoid caching another frame.
-
-        cachedFrame.resize(size);
-        m_bHasCachedFrame = true;
-      }
-
-      if (!cachedFrame.empty())
-      {
-        {
-          CSingleExit exit(m_bufferMutex);
-          std::memcpy(cachedFrame.data(), data, size);
-        }
-        m_cachedFrame = std::move(cachedFrame);
-        m_cachedWidth = width;
-        m_cachedHeight = height;
-      }
-    }
   }
 }
 
-void CRPRenderManager::SetSpeed(double speed)
-{
-  m_speed = speed;
-}
-
 void CRPRenderManager::FrameMove()
 {
   CheckFlush();
@@ -259,12 +265,6 @@ void CRPRenderManager::CheckFlush()
       for (auto renderBuffer : m_renderBuffers)
         renderBuffer->Release();
       m_renderBuffers.clear();
-
-      m_cachedFrame.clear();
-      m_cachedWidth = 0;
-      m_cachedHeight = 0;
-
-      m_bHasCachedFrame = false;
     }
 
     for (const auto& renderer : m_renderers)
@@ -571,46 +571,55 @@ void CRPRenderManager::CreateRenderBuffer(IRenderBufferPool* bufferPool)
 
   CSingleLock lock(m_bufferMutex);
 
-  if (!HasRenderBuffer(bufferPool) && m_bHasCachedFrame)
+  if (!HasRenderBuffer(bufferPool) && !m_renderBuffers.empty())
   {
     IRenderBuffer* renderBuffer =
-        CreateFromCache(m_cachedFrame, m_cachedWidth, m_cachedHeight, bufferPool, m_bufferMutex);
+        CreateFromBuffer(m_renderBuffers.front(), bufferPool, m_bufferMutex);
     if (renderBuffer != nullptr)
-      m_renderBuffers.emplace_back(renderBuffer);
+    {
+      // A new frame may have arrived while the mutex was exited
+      if (HasRenderBuffer(bufferPool))
+        renderBuffer->Release();
+      else
+        m_renderBuffers.emplace_back(renderBuffer);
+    }
   }
 }
 
-IRenderBuffer* CRPRenderManager::CreateFromCache(std::vector<uint8_t>& cachedFrame,
-                                                 unsigned int width,
-                                                 unsigned int height,
-                                                 IRenderBufferPool* bufferPool,
-                                                 CCriticalSection& mutex)
+IRenderBuffer* CRPRenderManager::CreateFromBuffer(IRenderBuffer* sourceBuffer,
+                                                  IRenderBufferPool* bufferPool,
+                                                  CCriticalSection& mutex)
 {
-  // Take ownership of cached frame
-  std::vector<uint8_t> ownedFrame = std::move(cachedFrame);
+  const unsigned int width = sourceBuffer->GetWidth();
+  const unsigned int height = sourceBuffer->GetHeight();
 
-  if (!ownedFrame.empty())
+  CLog::Log(LOGDEBUG, "RetroPlayer[RENDER]: Creating render buffer for renderer");
+
+  IRenderBuffer* renderBuffer = bufferPool->GetBuffer(width, height);
+  if (renderBuffer == nullptr)
   {
-    CLog::Log(LOGERROR, "RetroPlayer[RENDER]: Creating render buffer for renderer");
+    CLog::Log(LOGERROR, "RetroPlayer[RENDER]: Failed to create render buffer");
+    return nullptr;
+  }
 
-    IRenderBuffer* renderBuffer = bufferPool->GetBuffer(width, height);
-    if (renderBuffer != nullptr)
-    {
-      CSingleExit exit(mutex);
-      CopyFrame(renderBuffer, m_format, ownedFrame.data(), ownedFrame.size(), width, height);
-    }
+  renderBuffer->SetRotation(sourceBuffer->GetRotation());
 
-    // Return ownership of cached frame
-    cachedFrame = std::move(ownedFrame);
+  // Keep the source buffer alive while the mutex is exited
+  sourceBuffer->Acquire();
 
-    return renderBuffer;
-  }
-  else
   {
-    CLog::Log(LOGERROR, "RetroPlayer[RENDER]: Failed to create render buffer, no cached frame");
+    CSingleExit exit(mutex);
+
+    const uint8_t* data = sourceBuffer->GetMemory();
+    if (data != nullptr)
+      CopyFrame(renderBuffer, sourceBuffer->GetFormat(), data, sourceBuffer->GetFrameSize(), width,
+                height);
+    sourceBuffer->ReleaseMemory();
+
+    sourceBuffer->Release();
   }
 
-  return nullptr;
+  return renderBuffer;
 }
 
 void CRPRenderManager::CopyFrame(IRenderBuffer* renderBuffer,
@@ -629,18 +638,15 @@ void CRPRenderManager::CopyFrame(IRenderBuffer* renderBuffer,
     const unsigned int targetStride =
         static_cast<unsigned int>(renderBuffer->GetFrameSize() / renderBuffer->GetHeight());
 
-    if (m_format == renderBuffer->GetFormat())
+    if (format == renderBuffer->GetFormat())
     {
       if (sourceStride == targetStride)
-        std::memcpy(target, source, size);
+        CFrameCopy::CopyPlane(target, targetStride, source, sourceStride, sourceStride, height);
       else
       {
-        const unsigned int widthBytes = CRenderTranslator::TranslateWidthToBytes(width, m_format);
+        const unsigned int widthBytes = CRenderTranslator::TranslateWidthToBytes(width, format);
         if (widthBytes > 0)
-        {
-          for (unsigned int i = 0; i < height; i++)
-            std::memcpy(target + targetStride * i, source + sourceStride * i, widthBytes);
-        }
+          CFrameCopy::CopyPlane(target, targetStride, source, sourceStride, widthBytes, height);
       }
     }
     else
@@ -50,6 +50,9 @@ class IRenderBufferPool;
  * a visible renderer. For example, if a GLES and MMAL renderer are both
  * visible in the GUI, then the frame will be copied into two buffers.
  *
+ * Game clients that render into a buffer provided by GetVideoBuffer() skip
+ * this copy for the first of these buffer pools.
+ *
  * When it is time to render the frame, the GUI control or window calls into
  * this class through the IRenderManager interface. RenderManager selects an
  * appropriate renderer to use to render the frame. The renderer is then
@@ -57,8 +60,8 @@ class IRenderBufferPool;
  *
  * Special behavior is needed when the game is paused. As no new frames are
  * delivered, a newly created renderer will stay black. For this scenario,
- * when we detect a pause event, the frame is preemptively cached so that a
- * newly created renderer will have something to display.
+ * the render buffer of the last frame is copied into a buffer of the new
+ * renderer's buffer pool.
  */
 class CRPRenderManager : public IRenderManager, public IRenderCallback
 {
@@ -89,9 +92,6 @@ public:
                 unsigned int orientationDegCW);
   void Flush();
 
-  // Functions called from the player
-  void SetSpeed(double speed);
-
   // Functions called from render thread
   void FrameMove();
 
@@ -138,38 +138,30 @@ private:
   IRenderBuffer* GetRenderBuffer(IRenderBufferPool* bufferPool);
 
   /*!
-   * \brief Create a render buffer for the specified pool from a cached frame
+   * \brief Create a render buffer for the specified pool from the last frame
    */
   void CreateRenderBuffer(IRenderBufferPool* bufferPool);
 
   /*!
-   * \brief Create a render buffer and copy the cached data into it
+   * \brief Create a render buffer and copy the frame of another render
+   *        buffer into it
    *
-   * The cached frame is accessed by both the game and rendering threads,
-   * and therefore requires synchronization.
+   * The render buffers are accessed by both the game and rendering threads,
+   * and therefore require synchronization.
    *
    * However, assuming the memory copy is expensive, we must avoid holding
-   * the mutex during the copy.
+   * the mutex during the copy. The source buffer is acquired so that it
+   * stays valid while the mutex is exited.
    *
-   * To allow for this, the function is permitted to invalidate its
-   * cachedFrame parameter, as long as it is restored upon exit. While the
-   * mutex is exited inside this function, cachedFrame is guaranteed to be
-   * empty.
-   *
-   * \param cachedFrame The cached frame
-   * \param width The width of the cached frame
-   * \param height The height of the cached frame
+   * \param sourceBuffer The render buffer holding the frame
    * \param bufferPool The buffer pool used to create the render buffer
    * \param mutex The locked mutex, to be unlocked during memory copy
    *
-   * \return The render buffer if one was created from the cached frame,
-   *         otherwise nullptr
+   * \return The render buffer if one was created, otherwise nullptr
    */
-  IRenderBuffer* CreateFromCache(std::vector<uint8_t>& cachedFrame,
-                                 unsigned int width,
-                                 unsigned int height,
-                                 IRenderBufferPool* bufferPool,
-                                 CCriticalSection& mutex);
+  IRenderBuffer* CreateFromBuffer(IRenderBuffer* sourceBuffer,
+                                  IRenderBufferPool* bufferPool,
+                                  CCriticalSection& mutex);
 
   /*!
    * \brief Utility function to copy a frame and rescale pixels if necessary
@@ -200,12 +192,10 @@ private:
 
   // Render resources
   std::set<std::shared_ptr<CRPBaseRenderer>> m_renderers;
-  std::vector<IRenderBuffer*> m_pendingBuffers; // Only access from game thread
+  IRenderBuffer* m_pendingBuffer = nullptr; // Only access from game thread
+  uint8_t* m_pendingMemory = nullptr; // Only access from game thread
   std::vector<IRenderBuffer*> m_renderBuffers;
   std::map<AVPixelFormat, SwsContext*> m_scalers;
-  std::vector<uint8_t> m_cachedFrame;
-  unsigned int m_cachedWidth = 0;
-  unsigned int m_cachedHeight = 0;
 
   // State parameters
   enum class RENDER_STATE
@@ -215,16 +205,12 @@ private:
     CONFIGURED,
   };
   RENDER_STATE m_state = RENDER_STATE::UNCONFIGURED;
-  bool m_bHasCachedFrame = false; // Invariant: m_cachedFrame is empty if false
   std::set<std::string> m_failedShaderPresets;
   std::atomic<bool> m_bFlush = {false};
 
   // Windowing state
   bool m_bDisplayScaleSet = false;
 
-  // Playback parameters
-  std::atomic<double> m_speed = {1.0};
-
   // Synchronization parameters
   CCriticalSection m_stateMutex;
   CCriticalSection m_bufferMutex;
@@ -118,6 +118,14 @@ public:
   virtual void SetGameClientID(const std::string& gameClient) = 0;
   virtual void SetGameClientVersion(const std::string& gameClient) = 0;
   virtual uint8_t* GetMemoryBuffer(size_t size) = 0;
+
+  /*!
+   * \brief Copy the memory into the savestate, compressed if that makes the
+   *        savestate smaller
+   *
+   * Used instead of GetMemoryBuffer().
+   */
+  virtual void SetMemoryData(const uint8_t* data, size_t size) = 0;
   virtual void Finalize() = 0;
 
   /*!
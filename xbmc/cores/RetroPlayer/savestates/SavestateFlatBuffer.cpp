@@ -11,12 +11,22 @@
 #include "savestate_generated.h"
 #include "utils/log.h"
 
+#include <lzo/lzo1x.h>
+
 using namespace KODI;
 using namespace RETRO;
 
 namespace
 {
-const uint8_t SCHEMA_VERSION = 1;
+const uint8_t SCHEMA_VERSION = 2;
+
+/*!
+ * \brief The oldest schema version that can still be read
+ *
+ * Version 2 only added the compression of the memory, version 1 savestates
+ * are read as uncompressed savestates.
+ */
+const uint8_t MIN_SCHEMA_VERSION = 1;
 
 /*!
  * \brief The initial size of the FlatBuffer's memory buffer
@@ -26,6 +36,21 @@ const uint8_t SCHEMA_VERSION = 1;
  */
 const size_t INITIAL_FLATBUFFER_SIZE = 1024;
 
+/*!
+ * \brief The largest memory size accepted from a savestate
+ *
+ * The memory of the largest libretro cores is well below this, anything
+ * above it comes from a corrupted savestate.
+ */
+const uint64_t MAX_MEMORY_SIZE = 512 * 1024 * 1024;
+
+/*!
+ * \brief Upper bound on the LZO1X compression ratio
+ *
+ * A byte of LZO1X data expands to at most 255 bytes of memory.
+ */
+const uint64_t MAX_COMPRESSION_RATIO = 256;
+
 /*!
  * \brief Translate the save type (RetroPlayer to FlatBuffers)
  */
@@ -74,7 +99,10 @@ void CSavestateFlatBuffer::Reset()
 {
   m_builder.reset(new flatbuffers::FlatBufferBuilder(INITIAL_FLATBUFFER_SIZE));
   m_data.clear();
+  m_memory.clear();
   m_savestate = nullptr;
+  m_memoryCompressed = false;
+  m_memorySize = 0;
 }
 
 bool CSavestateFlatBuffer::Serialize(const uint8_t*& data, size_t& size) const
@@ -221,7 +249,15 @@ void CSavestateFlatBuffer::SetGameClientVersion(const std::string& gameClientVer
 const uint8_t* CSavestateFlatBuffer::GetMemoryData() const
 {
   if (m_savestate != nullptr && m_savestate->memory_data())
-    return m_savestate->memory_data()->data();
+  {
+    if (m_savestate->memory_compression() == MemoryCompression_None)
+      return m_savestate->memory_data()->data();
+
+    if (m_memory.empty() && !DecompressMemory())
+      return nullptr;
+
+    return m_memory.data();
+  }
 
   return nullptr;
 }
@@ -229,7 +265,12 @@ const uint8_t* CSavestateFlatBuffer::GetMemoryData() const
 size_t CSavestateFlatBuffer::GetMemorySize() const
 {
   if (m_savestate != nullptr && m_savestate->memory_data())
-    return m_savestate->memory_data()->size();
+  {
+    if (m_savestate->memory_compression() == MemoryCompression_None)
+      return m_savestate->memory_data()->size();
+
+    return static_cast<size_t>(m_savestate->memory_size());
+  }
 
   return 0;
 }
@@ -240,10 +281,38 @@ uint8_t* CSavestateFlatBuffer::GetMemoryBuffer(size_t size)
 
   m_memoryDataOffset.reset(
       new VectorOffset{m_builder->CreateUninitializedVector(size, &memoryBuffer)});
+  m_memoryCompressed = false;
+  m_memorySize = size;
 
   return memoryBuffer;
 }
 
+void CSavestateFlatBuffer::SetMemoryData(const uint8_t* data, size_t size)
+{
+  m_memoryCompressed = false;
+  m_memorySize = size;
+
+  if (size > 0 && lzo_init() == LZO_E_OK)
+  {
+    // Worst case expansion of LZO1X, see the LZO FAQ
+    std::vector<uint8_t> compressed(size + size / 16 + 64 + 3);
+    std::unique_ptr<uint8_t[]> workMemory(new uint8_t[LZO1X_1_MEM_COMPRESS]);
+
+    lzo_uint compressedSize = 0;
+    if (lzo1x_1_compress(data, size, compressed.data(), &compressedSize, workMemory.get()) ==
+            LZO_E_OK &&
+        compressedSize < size)
+    {
+      m_memoryDataOffset.reset(
+          new VectorOffset{m_builder->CreateVector(compressed.data(), compressedSize)});
+      m_memoryCompressed = true;
+      return;
+    }
+  }
+
+  m_memoryDataOffset.reset(new VectorOffset{m_builder->CreateVector(data, size)});
+}
+
 void CSavestateFlatBuffer::Finalize()
 {
   // Helper class to build the nested Savestate table
@@ -297,6 +366,10 @@ void CSavestateFlatBuffer::Finalize()
     m_memoryDataOffset.reset();
   }
 
+  savestateBuilder.add_memory_compression(m_memoryCompressed ? MemoryCompression_Lzo1x
+                                                             : MemoryCompression_None);
+  savestateBuilder.add_memory_size(m_memorySize);
+
   auto savestate = savestateBuilder.Finish();
   FinishSavestateBuffer(*m_builder, savestate);
 
@@ -310,18 +383,66 @@ bool CSavestateFlatBuffer::Deserialize(std::vector<uint8_t> data)
   {
     const Savestate* savestate = GetSavestate(data.data());
 
-    if (savestate->version() != SCHEMA_VERSION)
+    if (savestate->version() < MIN_SCHEMA_VERSION || savestate->version() > SCHEMA_VERSION)
     {
-      CLog::Log(LOGERROR, "RetroPlayer[SAVE): Schema version {} not supported, must be version {}",
-                savestate->version(), SCHEMA_VERSION);
+      CLog::Log(LOGERROR,
+                "RetroPlayer[SAVE): Schema version {} not supported, must be version {} to {}",
+                savestate->version(), MIN_SCHEMA_VERSION, SCHEMA_VERSION);
     }
     else
     {
       m_data = std::move(data);
+      m_memory.clear();
       m_savestate = GetSavestate(m_data.data());
-      return true;
+
+      // Catch corrupted memory while the savestate is loaded
+      if (m_savestate->memory_compression() == MemoryCompression_None || DecompressMemory())
+        return true;
+
+      m_data.clear();
+      m_savestate = nullptr;
     }
   }
 
   return false;
 }
+
+bool CSavestateFlatBuffer::DecompressMemory() const
+{
+  if (m_savestate->memory_compression() != MemoryCompression_Lzo1x)
+  {
+    CLog::Log(LOGERROR, "RetroPlayer[SAVE]: Unknown memory compression {}",
+              static_cast<int>(m_savestate->memory_compression()));
+    return false;
+  }
+
+  const flatbuffers::Vector<uint8_t>* memoryData = m_savestate->memory_data();
+  const uint64_t memorySizeExpected = m_savestate->memory_size();
+
+  // Don't trust the size of a corrupted savestate for the allocation
+  const uint64_t compressedSize = memoryData != nullptr ? memoryData->size() : 0;
+  if (memorySizeExpected > MAX_MEMORY_SIZE ||
+      memorySizeExpected > compressedSize * MAX_COMPRESSION_RATIO)
+  {
+    CLog::Log(LOGERROR,
+              "RetroPlayer[SAVE]: Invalid memory size {} for {} bytes of compressed memory",
+              memorySizeExpected, compressedSize);
+    return false;
+  }
+
+  m_memory.resize(static_cast<size_t>(memorySizeExpected));
+
+  lzo_uint memorySize = m_memory.size();
+  if (lzo_init() != LZO_E_OK ||
+      lzo1x_decompress_safe(memoryData->data(), memoryData->size(), m_memory.data(), &memorySize,
+                            nullptr) != LZO_E_OK ||
+      memorySize != m_memory.size())
+  {
+    CLog::Log(LOGERROR, "RetroPlayer[SAVE]: Failed to decompress memory of {} bytes",
+              m_memory.size());
+    m_memory.clear();
+    return false;
+  }
+
+  return true;
+}
@@ -56,10 +56,16 @@ public:
   void SetGameClientID(const std::string& gameClient) override;
   void SetGameClientVersion(const std::string& gameClient) override;
   uint8_t* GetMemoryBuffer(size_t size) override;
+  void SetMemoryData(const uint8_t* data, size_t size) override;
   void Finalize() override;
   bool Deserialize(std::vector<uint8_t> data) override;
 
 private:
+  /*!
+   * \brief Decompress the memory of the savestate into m_memory
+   */
+  bool DecompressMemory() const;
+
   /*!
    * \brief Helper class to hold data needed in creation of a FlatBuffer
    *
@@ -74,6 +80,11 @@ private:
    */
   std::vector<uint8_t> m_data;
 
+  /*!
+   * \brief Decompressed memory of a savestate with compressed memory
+   */
+  mutable std::vector<uint8_t> m_memory;
+
   /*!
    * \brief FlatBuffer struct used for accessing data
    */
@@ -93,6 +104,8 @@ private:
   std::unique_ptr<StringOffset> m_emulatorAddonIdOffset;
   std::unique_ptr<StringOffset> m_emulatorVersionOffset;
   std::unique_ptr<VectorOffset> m_memoryDataOffset;
+  bool m_memoryCompressed = false;
+  uint64_t m_memorySize = 0;
 };
 } // namespace RETRO
 } // namespace KODI
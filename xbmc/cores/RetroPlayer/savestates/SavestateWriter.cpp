@@ -0,0 +1,227 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "SavestateWriter.h"
+
+#include "ISavestate.h"
+#include "SavestateDatabase.h"
+#include "URL.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+using namespace KODI;
+using namespace RETRO;
+
+namespace
+{
+// Buffers kept for the next savestates. Autosaves reuse one buffer, a second
+// one covers a manual save while the autosave is still being written.
+constexpr size_t MAX_POOLED_BUFFERS = 2;
+} // namespace
+
+CSavestateWriter::CSavestateWriter(SavestateWriteFunc writeFunc)
+  : CThread("SavestateWriter"),
+    m_writeFunc(std::move(writeFunc)),
+    m_idleEvent(true, true)
+{
+  if (!m_writeFunc)
+    m_writeFunc = WriteToDatabase;
+}
+
+CSavestateWriter::~CSavestateWriter()
+{
+  Flush();
+  StopThread(true);
+}
+
+std::vector<uint8_t> CSavestateWriter::GetBuffer(size_t size)
+{
+  std::vector<uint8_t> buffer;
+
+  {
+    CSingleLock lock(m_critSection);
+    if (!m_buffers.empty())
+    {
+      buffer = std::move(m_buffers.back());
+      m_buffers.pop_back();
+    }
+  }
+
+  buffer.resize(size);
+
+  return buffer;
+}
+
+void CSavestateWriter::Write(const std::string& gamePath,
+                             SavestateProperties properties,
+                             std::vector<uint8_t> memory)
+{
+  {
+    CSingleLock lock(m_critSection);
+
+    auto it = std::find_if(m_jobs.begin(), m_jobs.end(),
+                           [&gamePath](const Job& job) { return job.gamePath == gamePath; });
+    if (it != m_jobs.end())
+    {
+      // The older savestate was not written yet, replace it
+      CLog::Log(LOGDEBUG, "RetroPlayer[SAVE]: Replacing pending savestate of frame {}",
+                it->properties.timestampFrames);
+      std::swap(it->memory, memory);
+      it->properties = std::move(properties);
+      if (m_buffers.size() < MAX_POOLED_BUFFERS)
+        m_buffers.emplace_back(std::move(memory));
+    }
+    else
+    {
+      m_jobs.push_back(Job{gamePath, std::move(properties), std::move(memory)});
+    }
+
+    m_idleEvent.Reset();
+  }
+
+  if (!IsRunning())
+    Create();
+  m_jobEvent.Set();
+}
+
+bool CSavestateWriter::WriteNow(const std::string& gamePath,
+                                const SavestateProperties& properties,
+                                std::vector<uint8_t> memory)
+{
+  // An older savestate of the game must not overwrite this one
+  Flush();
+
+  bool bSuccess;
+  {
+    CSingleLock lock(m_writeMutex);
+    bSuccess = WriteSavestate(gamePath, properties, memory);
+  }
+
+  ReturnBuffer(std::move(memory));
+
+  return bSuccess;
+}
+
+void CSavestateWriter::Flush()
+{
+  while (true)
+  {
+    {
+      CSingleLock lock(m_critSection);
+      if (m_jobs.empty() && !m_bWriting)
+        break;
+    }
+
+    m_idleEvent.Wait();
+  }
+}
+
+unsigned int CSavestateWriter::WrittenCount() const
+{
+  CSingleLock lock(m_critSection);
+  return m_writtenCount;
+}
+
+void CSavestateWriter::Process()
+{
+  while (!m_bStop)
+  {
+    Job job;
+
+    {
+      CSingleLock lock(m_critSection);
+      if (m_jobs.empty())
+      {
+        m_bWriting = false;
+        m_idleEvent.Set();
+      }
+      else
+      {
+        job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        m_bWriting = true;
+      }
+    }
+
+    if (!m_bWriting)
+    {
+      AbortableWait(m_jobEvent);
+      continue;
+    }
+
+    {
+      CSingleLock lock(m_writeMutex);
+      WriteSavestate(job.gamePath, job.properties, job.memory);
+    }
+
+    ReturnBuffer(std::move(job.memory));
+  }
+
+  CSingleLock lock(m_critSection);
+  m_bWriting = false;
+  m_idleEvent.Set();
+}
+
+bool CSavestateWriter::WriteSavestate(const std::string& gamePath,
+                                      const SavestateProperties& properties,
+                                      const std::vector<uint8_t>& memory)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  const bool bSuccess = m_writeFunc(gamePath, properties, memory);
+
+  const auto writeTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start);
+
+  if (bSuccess)
+    CLog::Log(LOGDEBUG, "RetroPlayer[SAVE]: Wrote savestate of {} bytes in {} ms", memory.size(),
+              writeTime.count());
+  else
+    CLog::Log(LOGERROR, "RetroPlayer[SAVE]: Failed to write savestate for {}",
+              CURL::GetRedacted(gamePath));
+
+  CSingleLock lock(m_critSection);
+  if (bSuccess)
+    m_writtenCount++;
+
+  return bSuccess;
+}
+
+void CSavestateWriter::ReturnBuffer(std::vector<uint8_t> buffer)
+{
+  CSingleLock lock(m_critSection);
+  if (m_buffers.size() < MAX_POOLED_BUFFERS)
+    m_buffers.emplace_back(std::move(buffer));
+}
+
+bool CSavestateWriter::WriteToDatabase(const std::string& gamePath,
+                                       const SavestateProperties& properties,
+                                       const std::vector<uint8_t>& memory)
+{
+  CSavestateDatabase savestateDatabase;
+
+  std::unique_ptr<ISavestate> savestate = savestateDatabase.CreateSavestate();
+
+  savestate->SetType(properties.type);
+  savestate->SetSlot(properties.slot);
+  savestate->SetLabel(properties.label);
+  savestate->SetCreated(properties.created);
+  savestate->SetGameFileName(properties.gameFileName);
+  savestate->SetTimestampFrames(properties.timestampFrames);
+  savestate->SetTimestampWallClock(properties.timestampWallClock);
+  savestate->SetGameClientID(properties.gameClientId);
+  savestate->SetGameClientVersion(properties.gameClientVersion);
+  savestate->SetMemoryData(memory.data(), memory.size());
+  savestate->Finalize();
+
+  return savestateDatabase.AddSavestate(gamePath, *savestate);
+}
@@ -0,0 +1,162 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "SavestateTypes.h"
+#include "XBDateTime.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+#include <deque>
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace KODI
+{
+namespace RETRO
+{
+/*!
+ * \brief Properties of a savestate that is written in the background
+ */
+struct SavestateProperties
+{
+  SAVE_TYPE type = SAVE_TYPE::UNKNOWN;
+  uint8_t slot = 0;
+  std::string label;
+  CDateTime created;
+  std::string gameFileName;
+  uint64_t timestampFrames = 0;
+  double timestampWallClock = 0.0;
+  std::string gameClientId;
+  std::string gameClientVersion;
+};
+
+/*!
+ * \brief Function that builds and stores a savestate
+ *
+ * \param gamePath The game the savestate belongs to
+ * \param properties The savestate's properties
+ * \param memory The serialized memory of the game client
+ *
+ * \return True if the savestate was written
+ */
+using SavestateWriteFunc = std::function<bool(const std::string& gamePath,
+                                              const SavestateProperties& properties,
+                                              const std::vector<uint8_t>& memory)>;
+
+/*!
+ * \brief Writes savestates on a worker thread
+ *
+ * The caller only copies the memory of the game client into a pooled buffer.
+ * Compressing the memory, building the FlatBuffer and the file I/O happen in
+ * the background, so autosaves of large states don't stall the game loop.
+ *
+ * If a game is saved again before its previous savestate was written, only
+ * the newer savestate is written. Failed writes are logged.
+ */
+class CSavestateWriter : protected CThread
+{
+public:
+  /*!
+   * \param writeFunc Function that stores a savestate, or empty to write it
+   *                  to the savestate database
+   */
+  explicit CSavestateWriter(SavestateWriteFunc writeFunc = nullptr);
+
+  /*!
+   * \brief Writes all pending savestates before returning
+   */
+  ~CSavestateWriter() override;
+
+  /*!
+   * \brief Get a buffer for the memory of the next savestate
+   *
+   * Buffers of written savestates are reused, so the returned buffer may
+   * already have the requested size.
+   */
+  std::vector<uint8_t> GetBuffer(size_t size);
+
+  /*!
+   * \brief Queue a savestate to be written
+   *
+   * \param gamePath The game the savestate belongs to
+   * \param properties The savestate's properties
+   * \param memory A buffer from GetBuffer() holding the memory of the game client
+   */
+  void Write(const std::string& gamePath,
+             SavestateProperties properties,
+             std::vector<uint8_t> memory);
+
+  /*!
+   * \brief Write a savestate before returning
+   *
+   * Savestates queued before are written first. Used when the caller needs
+   * the savestate to exist, e.g. to resume the game from it.
+   *
+   * \param gamePath The game the savestate belongs to
+   * \param properties The savestate's properties
+   * \param memory A buffer from GetBuffer() holding the memory of the game client
+   *
+   * \return True if the savestate was written
+   */
+  bool WriteNow(const std::string& gamePath,
+                const SavestateProperties& properties,
+                std::vector<uint8_t> memory);
+
+  /*!
+   * \brief Wait until all queued savestates are written
+   */
+  void Flush();
+
+  /*!
+   * \brief Number of savestates that were written successfully
+   */
+  unsigned int WrittenCount() const;
+
+protected:
+  // implementation of CThread
+  void Process() override;
+
+private:
+  struct Job
+  {
+    std::string gamePath;
+    SavestateProperties properties;
+    std::vector<uint8_t> memory;
+  };
+
+  bool WriteSavestate(const std::string& gamePath,
+                      const SavestateProperties& properties,
+                      const std::vector<uint8_t>& memory);
+  void ReturnBuffer(std::vector<uint8_t> buffer);
+
+  static bool WriteToDatabase(const std::string& gamePath,
+                              const SavestateProperties& properties,
+                              const std::vector<uint8_t>& memory);
+
+  // Construction parameters
+  SavestateWriteFunc m_writeFunc;
+
+  // Worker state
+  std::deque<Job> m_jobs;
+  bool m_bWriting = false;
+  std::vector<std::vector<uint8_t>> m_buffers;
+  unsigned int m_writtenCount = 0;
+
+  // Synchronization
+  mutable CCriticalSection m_critSection;
+  CCriticalSection m_writeMutex;
+  CEvent m_jobEvent;
+  CEvent m_idleEvent;
+};
+} // namespace RETRO
+} // namespace KODI
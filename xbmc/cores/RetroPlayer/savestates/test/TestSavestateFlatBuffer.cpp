@@ -0,0 +1,119 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/RetroPlayer/savestates/SavestateFlatBuffer.h"
+#include "savestate_generated.h"
+
+#include <random>
+#include <string.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace KODI;
+using namespace RETRO;
+
+namespace
+{
+constexpr size_t STATE_SIZE = 128 * 1024;
+
+std::vector<uint8_t> Serialize(const std::vector<uint8_t>& memory)
+{
+  CSavestateFlatBuffer savestate;
+  savestate.SetType(SAVE_TYPE::MANUAL);
+  savestate.SetSlot(3);
+  savestate.SetLabel("Boss");
+  savestate.SetTimestampFrames(1234);
+  savestate.SetGameClientID("game.libretro.test");
+  savestate.SetMemoryData(memory.data(), memory.size());
+  savestate.Finalize();
+
+  EXPECT_EQ(memory.size(), savestate.GetMemorySize());
+  EXPECT_EQ(0, memcmp(memory.data(), savestate.GetMemoryData(), memory.size()));
+
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+  EXPECT_TRUE(savestate.Serialize(data, size));
+  return std::vector<uint8_t>(data, data + size);
+}
+} // namespace
+
+TEST(TestSavestateFlatBuffer, CompressedMemory)
+{
+  // mostly empty RAM, like most console states
+  std::vector<uint8_t> memory(STATE_SIZE);
+  for (size_t i = 0; i < memory.size(); i += 97)
+    memory[i] = static_cast<uint8_t>(i);
+
+  std::vector<uint8_t> data = Serialize(memory);
+  EXPECT_LT(data.size(), STATE_SIZE / 4);
+
+  CSavestateFlatBuffer savestate;
+  ASSERT_TRUE(savestate.Deserialize(std::move(data)));
+  EXPECT_EQ(SAVE_TYPE::MANUAL, savestate.Type());
+  EXPECT_EQ(3, savestate.Slot());
+  EXPECT_EQ("Boss", savestate.Label());
+  EXPECT_EQ(1234u, savestate.TimestampFrames());
+  EXPECT_EQ("game.libretro.test", savestate.GameClientID());
+  ASSERT_EQ(STATE_SIZE, savestate.GetMemorySize());
+  EXPECT_EQ(0, memcmp(memory.data(), savestate.GetMemoryData(), STATE_SIZE));
+}
+
+TEST(TestSavestateFlatBuffer, IncompressibleMemory)
+{
+  std::mt19937 random(1234);
+  std::vector<uint8_t> memory(STATE_SIZE);
+  for (auto& byte : memory)
+    byte = static_cast<uint8_t>(random());
+
+  // stored as is, without paying for the compression overhead
+  std::vector<uint8_t> data = Serialize(memory);
+  EXPECT_LT(data.size(), STATE_SIZE + 1024);
+
+  CSavestateFlatBuffer savestate;
+  ASSERT_TRUE(savestate.Deserialize(std::move(data)));
+  ASSERT_EQ(STATE_SIZE, savestate.GetMemorySize());
+  EXPECT_EQ(0, memcmp(memory.data(), savestate.GetMemoryData(), STATE_SIZE));
+}
+
+TEST(TestSavestateFlatBuffer, UncompressedMemoryBuffer)
+{
+  CSavestateFlatBuffer savestate;
+  uint8_t* buffer = savestate.GetMemoryBuffer(16);
+  ASSERT_NE(nullptr, buffer);
+  for (unsigned int i = 0; i < 16; i++)
+    buffer[i] = static_cast<uint8_t>(i);
+  savestate.Finalize();
+
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(savestate.Serialize(data, size));
+
+  CSavestateFlatBuffer loaded;
+  ASSERT_TRUE(loaded.Deserialize(std::vector<uint8_t>(data, data + size)));
+  ASSERT_EQ(16u, loaded.GetMemorySize());
+  EXPECT_EQ(15, loaded.GetMemoryData()[15]);
+}
+
+TEST(TestSavestateFlatBuffer, CorruptMemorySize)
+{
+  // a few bytes of compressed memory claiming to expand to a terabyte
+  flatbuffers::FlatBufferBuilder builder;
+  const std::vector<uint8_t> compressed(16);
+  auto memoryData = builder.CreateVector(compressed);
+  SavestateBuilder savestateBuilder(builder);
+  savestateBuilder.add_version(2);
+  savestateBuilder.add_memory_data(memoryData);
+  savestateBuilder.add_memory_compression(MemoryCompression_Lzo1x);
+  savestateBuilder.add_memory_size(1ull << 40);
+  FinishSavestateBuffer(builder, savestateBuilder.Finish());
+
+  CSavestateFlatBuffer savestate;
+  EXPECT_FALSE(savestate.Deserialize(std::vector<uint8_t>(
+      builder.GetBufferPointer(), builder.GetBufferPointer() + builder.GetSize())));
+}
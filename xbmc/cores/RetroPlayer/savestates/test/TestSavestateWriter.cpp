@@ -0,0 +1,247 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/RetroPlayer/savestates/SavestateFlatBuffer.h"
+#include "cores/RetroPlayer/savestates/SavestateWriter.h"
+#include "filesystem/File.h"
+#include "test/SlowStorage.h"
+#include "test/TestUtils.h"
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace KODI;
+using namespace RETRO;
+using namespace std::chrono_literals;
+
+namespace
+{
+constexpr size_t STATE_SIZE = 256 * 1024;
+
+/*!
+ * \brief Savestate database that needs a while to write every savestate
+ */
+struct SlowDatabase : public CSlowStorage
+{
+  std::mutex mutex;
+  std::map<std::string, std::vector<uint8_t>> savestates;
+  std::map<std::string, uint64_t> frames;
+
+  bool Write(const std::string& gamePath,
+             const SavestateProperties& properties,
+             const std::vector<uint8_t>& memory)
+  {
+    if (!Access())
+      return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    savestates[gamePath] = memory;
+    frames[gamePath] = properties.timestampFrames;
+    return true;
+  }
+};
+
+SavestateProperties MakeProperties(uint64_t frame)
+{
+  SavestateProperties properties;
+  properties.type = SAVE_TYPE::AUTO;
+  properties.timestampFrames = frame;
+  properties.gameClientId = "game.libretro.test";
+  return properties;
+}
+} // namespace
+
+class TestSavestateWriter : public ::testing::Test
+{
+protected:
+  TestSavestateWriter()
+    : writer([this](const std::string& gamePath, const SavestateProperties& properties,
+                    const std::vector<uint8_t>& memory) {
+        return storage.Write(gamePath, properties, memory);
+      })
+  {
+  }
+
+  void Save(const std::string& gamePath, uint64_t frame)
+  {
+    std::vector<uint8_t> memory = writer.GetBuffer(STATE_SIZE);
+    for (size_t i = 0; i < memory.size(); i++)
+      memory[i] = static_cast<uint8_t>(i + frame);
+    writer.Write(gamePath, MakeProperties(frame), std::move(memory));
+  }
+
+  SlowDatabase storage;
+  CSavestateWriter writer;
+};
+
+TEST_F(TestSavestateWriter, WriteInBackground)
+{
+  storage.delayMs = 200;
+
+  const auto start = std::chrono::steady_clock::now();
+  Save("/games/a.sfc", 60);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 100ms);
+
+  writer.Flush();
+  EXPECT_EQ(1, storage.accesses);
+  EXPECT_EQ(1u, writer.WrittenCount());
+  ASSERT_EQ(1u, storage.savestates.count("/games/a.sfc"));
+
+  const std::vector<uint8_t>& memory = storage.savestates["/games/a.sfc"];
+  ASSERT_EQ(STATE_SIZE, memory.size());
+  for (size_t i = 0; i < memory.size(); i += 1021)
+    ASSERT_EQ(static_cast<uint8_t>(i + 60), memory[i]);
+  EXPECT_EQ(60u, storage.frames["/games/a.sfc"]);
+}
+
+TEST_F(TestSavestateWriter, NewerSavestateReplacesPending)
+{
+  storage.delayMs = 100;
+
+  // the first savestate is being written, the next ones wait in the queue
+  Save("/games/a.sfc", 1);
+  std::this_thread::sleep_for(20ms);
+  Save("/games/a.sfc", 2);
+  Save("/games/b.sfc", 3);
+  Save("/games/a.sfc", 4);
+
+  writer.Flush();
+  EXPECT_EQ(3, storage.accesses);
+  EXPECT_EQ(4u, storage.frames["/games/a.sfc"]);
+  EXPECT_EQ(3u, storage.frames["/games/b.sfc"]);
+  EXPECT_EQ(static_cast<uint8_t>(4), storage.savestates["/games/a.sfc"][0]);
+}
+
+TEST_F(TestSavestateWriter, ReuseBuffers)
+{
+  Save("/games/a.sfc", 1);
+  writer.Flush();
+
+  // the buffer of the written savestate is handed out again
+  std::vector<uint8_t> buffer = writer.GetBuffer(STATE_SIZE);
+  ASSERT_EQ(STATE_SIZE, buffer.size());
+  EXPECT_EQ(static_cast<uint8_t>(1), buffer[0]);
+
+  // a new buffer is allocated when the pool is empty
+  std::vector<uint8_t> other = writer.GetBuffer(STATE_SIZE);
+  EXPECT_EQ(STATE_SIZE, other.size());
+  EXPECT_NE(buffer.data(), other.data());
+}
+
+TEST_F(TestSavestateWriter, FailedWrite)
+{
+  storage.fail = true;
+  Save("/games/a.sfc", 1);
+  writer.Flush();
+  EXPECT_EQ(1, storage.accesses);
+  EXPECT_EQ(0u, writer.WrittenCount());
+
+  storage.fail = false;
+  Save("/games/a.sfc", 2);
+  writer.Flush();
+  EXPECT_EQ(1u, writer.WrittenCount());
+  EXPECT_EQ(2u, storage.frames["/games/a.sfc"]);
+}
+
+TEST_F(TestSavestateWriter, WriteNow)
+{
+  storage.delayMs = 50;
+
+  // the queued savestate is written first, so it can't overwrite the newer one
+  Save("/games/a.sfc", 1);
+  EXPECT_TRUE(writer.WriteNow("/games/a.sfc", MakeProperties(2), writer.GetBuffer(STATE_SIZE)));
+  EXPECT_EQ(2, storage.accesses);
+  EXPECT_EQ(2u, storage.frames["/games/a.sfc"]);
+
+  storage.fail = true;
+  EXPECT_FALSE(writer.WriteNow("/games/a.sfc", MakeProperties(3), writer.GetBuffer(STATE_SIZE)));
+  EXPECT_EQ(2u, writer.WrittenCount());
+}
+
+TEST(TestSavestateWriterShutdown, WritesPendingSavestates)
+{
+  SlowDatabase storage;
+  storage.delayMs = 20;
+
+  {
+    CSavestateWriter writer([&storage](const std::string& gamePath,
+                                       const SavestateProperties& properties,
+                                       const std::vector<uint8_t>& memory) {
+      return storage.Write(gamePath, properties, memory);
+    });
+    writer.Write("/games/a.sfc", MakeProperties(1), writer.GetBuffer(16));
+    writer.Write("/games/b.sfc", MakeProperties(2), writer.GetBuffer(16));
+  }
+
+  // the player stops right after saving, nothing is lost
+  EXPECT_EQ(2, storage.accesses);
+  EXPECT_EQ(2u, storage.savestates.size());
+}
+
+/* Compares how long the game loop stalls for a savestate that is compressed
+ * and written synchronously and one that is left to the writer's thread.
+ * Disabled as it only measures, run it with --gtest_also_run_disabled_tests.
+ */
+TEST(TestSavestateWriterBenchmark, DISABLED_SyncVsAsync)
+{
+  constexpr size_t BENCHMARK_STATE_SIZE = 16 * 1024 * 1024;
+  constexpr int SAVES = 10;
+
+  XFILE::CFile* file = CXBMCTestUtils::Instance().CreateTempFile(".sav");
+  ASSERT_NE(nullptr, file);
+
+  CSavestateWriter writer([file](const std::string&, const SavestateProperties& properties,
+                                 const std::vector<uint8_t>& memory) {
+    CSavestateFlatBuffer savestate;
+    savestate.SetTimestampFrames(properties.timestampFrames);
+    savestate.SetMemoryData(memory.data(), memory.size());
+    savestate.Finalize();
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    return savestate.Serialize(data, size) && file->Seek(0, SEEK_SET) == 0 &&
+           file->Write(data, size) == static_cast<ssize_t>(size);
+  });
+
+  auto fill = [](std::vector<uint8_t>& memory, uint64_t frame) {
+    for (size_t i = 0; i < memory.size(); i += 61)
+      memory[i] = static_cast<uint8_t>(i + frame);
+  };
+
+  std::chrono::microseconds syncStall{0};
+  std::chrono::microseconds asyncStall{0};
+  for (int i = 0; i < SAVES; i++)
+  {
+    std::vector<uint8_t> memory = writer.GetBuffer(BENCHMARK_STATE_SIZE);
+    fill(memory, i);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(writer.WriteNow("/games/a.sfc", MakeProperties(i), std::move(memory)));
+    syncStall += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    memory = writer.GetBuffer(BENCHMARK_STATE_SIZE);
+    fill(memory, i);
+    start = std::chrono::steady_clock::now();
+    writer.Write("/games/a.sfc", MakeProperties(i), std::move(memory));
+    asyncStall += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    // autosaves are far apart, the previous one is always written
+    writer.Flush();
+  }
+
+  EXPECT_EQ(static_cast<unsigned int>(2 * SAVES), writer.WrittenCount());
+  RecordProperty("sync_stall_us", static_cast<int>(syncStall.count() / SAVES));
+  RecordProperty("async_stall_us", static_cast<int>(asyncStall.count() / SAVES));
+
+  EXPECT_TRUE(CXBMCTestUtils::Instance().DeleteTempFile(file));
+}
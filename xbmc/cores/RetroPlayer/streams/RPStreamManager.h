@@ -15,6 +15,7 @@ namespace KODI
 namespace RETRO
 {
 class CRetroPlayerAudio;
+class CRetroPlayerVideo;
 class CRPProcessInfo;
 class CRPRenderManager;
 
@@ -26,6 +27,15 @@ public:
 
   void EnableAudio(bool bEnable);
 
+  /*!
+   * \brief Discard the output of frames that are emulated but not presented
+   *
+   * Used by run-ahead, which only shows the video of the last frame it runs
+   * and only plays the audio of the frame it rolls back to.
+   */
+  void SuppressVideo(bool bSuppress);
+  void SuppressAudio(bool bSuppress);
+
   // Implementation of IStreamManager
   StreamPtr CreateStream(StreamType streamType) override;
   void CloseStream(StreamPtr stream) override;
@@ -37,6 +47,7 @@ private:
 
   // Stream parameters
   CRetroPlayerAudio* m_audioStream = nullptr;
+  CRetroPlayerVideo* m_videoStream = nullptr;
 };
 } // namespace RETRO
 } // namespace KODI
@@ -47,6 +47,7 @@ public:
   ~CRetroPlayerAudio() override;
 
   void Enable(bool bEnabled) { m_bAudioEnabled = bEnabled; }
+  void Suppress(bool bSuppressed) { m_bSuppressed = bSuppressed; }
 
   // implementation of IRetroPlayerStream
   bool OpenStream(const StreamProperties& properties) override;
@@ -61,6 +62,7 @@ private:
   CRPProcessInfo& m_processInfo;
   IAEStream* m_pAudioStream;
   bool m_bAudioEnabled;
+  bool m_bSuppressed = false;
 };
 } // namespace RETRO
 } // namespace KODI
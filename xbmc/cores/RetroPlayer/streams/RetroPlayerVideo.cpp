@@ -70,7 +70,9 @@ bool CRetroPlayerVideo::GetStreamBuffer(unsigned int width,
 {
   VideoStreamBuffer& videoBuffer = static_cast<VideoStreamBuffer&>(buffer);
 
-  if (m_bOpen)
+  // Frames that are emulated ahead are not shown, let the game client render
+  // them into its own memory
+  if (m_bOpen && !m_bSuppressed)
   {
     return m_renderManager.GetVideoBuffer(width, height, videoBuffer.pixfmt, videoBuffer.data,
                                           videoBuffer.size);
@@ -83,7 +85,7 @@ void CRetroPlayerVideo::AddStreamData(const StreamPacket& packet)
 {
   const VideoStreamPacket& videoPacket = static_cast<const VideoStreamPacket&>(packet);
 
-  if (m_bOpen)
+  if (m_bOpen && !m_bSuppressed)
   {
     unsigned int orientationDegCCW = 0;
     switch (videoPacket.rotation)
@@ -83,6 +83,8 @@ public:
   CRetroPlayerVideo(CRPRenderManager& m_renderManager, CRPProcessInfo& m_processInfo);
   ~CRetroPlayerVideo() override;
 
+  void Suppress(bool bSuppressed) { m_bSuppressed = bSuppressed; }
+
   // implementation of IRetroPlayerStream
   bool OpenStream(const StreamProperties& properties) override;
   bool GetStreamBuffer(unsigned int width, unsigned int height, StreamBuffer& buffer) override;
@@ -96,6 +98,7 @@ private:
 
   // Stream properties
   bool m_bOpen = false;
+  bool m_bSuppressed = false;
 };
 } // namespace RETRO
 } // namespace KODI
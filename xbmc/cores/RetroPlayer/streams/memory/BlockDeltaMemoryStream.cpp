@@ -0,0 +1,335 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "BlockDeltaMemoryStream.h"
+
+#include "utils/log.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <lzo/lzo1x.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+using namespace KODI;
+using namespace RETRO;
+
+namespace
+{
+// Granularity of the change detection. Smaller blocks store less unchanged
+// data, larger blocks need fewer run lengths.
+constexpr size_t BLOCK_SIZE = 128;
+
+/*!
+ * \brief XOR two buffers into a third one
+ *
+ * \return True if the buffers differ
+ */
+bool XorBuffers(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t size)
+{
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 16 <= size; i += 16)
+  {
+    const __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), x);
+    acc = _mm_or_si128(acc, x);
+  }
+  bool changed = _mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) != 0xFFFF;
+#elif defined(__ARM_NEON)
+  uint8x16_t acc = vdupq_n_u8(0);
+  for (; i + 16 <= size; i += 16)
+  {
+    const uint8x16_t x = veorq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+    vst1q_u8(out + i, x);
+    acc = vorrq_u8(acc, x);
+  }
+  const uint64x2_t acc64 = vreinterpretq_u64_u8(acc);
+  bool changed = (vgetq_lane_u64(acc64, 0) | vgetq_lane_u64(acc64, 1)) != 0;
+#else
+  bool changed = false;
+#endif
+
+  uint8_t tail = 0;
+  for (; i < size; i++)
+  {
+    out[i] = a[i] ^ b[i];
+    tail |= out[i];
+  }
+
+  return changed || tail != 0;
+}
+
+void PutVarint(std::vector<uint8_t>& buffer, size_t value)
+{
+  while (value >= 0x80)
+  {
+    buffer.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<uint8_t>(value));
+}
+
+size_t GetVarint(const uint8_t*& data)
+{
+  size_t value = 0;
+  unsigned int shift = 0;
+  while (*data & 0x80)
+  {
+    value |= static_cast<size_t>(*data++ & 0x7F) << shift;
+    shift += 7;
+  }
+  value |= static_cast<size_t>(*data++) << shift;
+  return value;
+}
+} // namespace
+
+CBlockDeltaMemoryStream::CBlockDeltaMemoryStream(size_t memoryBudget)
+  : m_memoryBudget(memoryBudget), m_workMemory(new uint8_t[LZO1X_1_MEM_COMPRESS])
+{
+  lzo_init();
+}
+
+void CBlockDeltaMemoryStream::Reset()
+{
+  CLinearMemoryStream::Reset();
+
+  m_rewindBuffer.clear();
+  m_memoryUsage = 0;
+
+  m_delta.clear();
+  m_compressed.clear();
+  m_runs.clear();
+
+  m_encodedFrames = 0;
+  m_encodedBytes = 0;
+  m_encodeTimeUs = 0;
+  m_lastFrameBytes = 0;
+  m_lastEncodeTimeUs = 0;
+}
+
+void CBlockDeltaMemoryStream::SetMemoryBudget(size_t memoryBudget)
+{
+  m_memoryBudget = memoryBudget;
+  CullToBudget();
+}
+
+MemoryStreamStats CBlockDeltaMemoryStream::GetStats() const
+{
+  MemoryStreamStats stats;
+
+  stats.frameCount = m_encodedFrames;
+  if (m_encodedFrames > 0)
+  {
+    stats.bytesPerFrame = static_cast<double>(m_encodedBytes) / m_encodedFrames;
+    stats.encodeTimeUs = static_cast<double>(m_encodeTimeUs) / m_encodedFrames;
+  }
+  stats.lastFrameBytes = m_lastFrameBytes;
+  stats.lastEncodeTimeUs = m_lastEncodeTimeUs;
+  stats.memoryUsage = m_memoryUsage;
+
+  return stats;
+}
+
+void CBlockDeltaMemoryStream::SubmitFrameInternal()
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  const uint8_t* currentFrame = reinterpret_cast<const uint8_t*>(m_currentFrame.get());
+  const uint8_t* nextFrame = reinterpret_cast<const uint8_t*>(m_nextFrame.get());
+
+  // Collect the delta of changed blocks and the lengths of the runs of
+  // unchanged and changed blocks in between
+  m_delta.resize(m_paddedFrameSize);
+  m_runs.clear();
+
+  size_t deltaSize = 0;
+  size_t unchangedBlocks = 0;
+  size_t changedBlocks = 0;
+  for (size_t pos = 0; pos < m_paddedFrameSize; pos += BLOCK_SIZE)
+  {
+    const size_t size = std::min(BLOCK_SIZE, m_paddedFrameSize - pos);
+    if (XorBuffers(currentFrame + pos, nextFrame + pos, m_delta.data() + deltaSize, size))
+    {
+      if (changedBlocks == 0)
+        PutVarint(m_runs, unchangedBlocks);
+      unchangedBlocks = 0;
+      changedBlocks++;
+      deltaSize += size;
+    }
+    else
+    {
+      if (changedBlocks != 0)
+        PutVarint(m_runs, changedBlocks);
+      changedBlocks = 0;
+      unchangedBlocks++;
+    }
+  }
+  if (changedBlocks != 0)
+    PutVarint(m_runs, changedBlocks);
+
+  m_rewindBuffer.emplace_back();
+  MemoryFrame& frame = m_rewindBuffer.back();
+
+  // Record frame history
+  frame.frameHistoryCount = m_currentFrameHistory++;
+  frame.runBytes = static_cast<uint32_t>(m_runs.size());
+  frame.deltaSize = static_cast<uint32_t>(deltaSize);
+  frame.compressed = false;
+
+  const uint8_t* payload = m_delta.data();
+  size_t payloadSize = deltaSize;
+  if (deltaSize > 0)
+  {
+    m_compressed.resize(deltaSize + deltaSize / 16 + 64 + 3);
+    lzo_uint compressedSize = 0;
+    if (lzo1x_1_compress(m_delta.data(), deltaSize, m_compressed.data(), &compressedSize,
+                         m_workMemory.get()) == LZO_E_OK &&
+        compressedSize < deltaSize)
+    {
+      frame.compressed = true;
+      payload = m_compressed.data();
+      payloadSize = compressedSize;
+    }
+  }
+
+  frame.buffer.reserve(m_runs.size() + payloadSize);
+  frame.buffer.insert(frame.buffer.end(), m_runs.begin(), m_runs.end());
+  frame.buffer.insert(frame.buffer.end(), payload, payload + payloadSize);
+
+  // Delta is generated, bring the new frame forward (m_nextFrame is now disposable)
+  std::swap(m_currentFrame, m_nextFrame);
+
+  m_bHasNextFrame = false;
+
+  m_memoryUsage += FrameCost(frame);
+  m_lastFrameBytes = frame.buffer.size();
+
+  if (PastFramesAvailable() + 1 > MaxFrameCount())
+    CullPastFrames(1);
+  CullToBudget();
+
+  const auto encodeTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+
+  m_lastEncodeTimeUs = static_cast<unsigned int>(encodeTime.count());
+  m_encodedFrames++;
+  m_encodedBytes += m_lastFrameBytes;
+  m_encodeTimeUs += m_lastEncodeTimeUs;
+}
+
+uint64_t CBlockDeltaMemoryStream::PastFramesAvailable() const
+{
+  return static_cast<uint64_t>(m_rewindBuffer.size());
+}
+
+uint64_t CBlockDeltaMemoryStream::RewindFrames(uint64_t frameCount)
+{
+  uint64_t rewound;
+
+  for (rewound = 0; rewound < frameCount; rewound++)
+  {
+    if (m_rewindBuffer.empty())
+      break;
+
+    const MemoryFrame& frame = m_rewindBuffer.back();
+    ApplyFrame(frame);
+
+    // Restore frame history
+    m_currentFrameHistory = frame.frameHistoryCount;
+
+    m_memoryUsage -= FrameCost(frame);
+    m_rewindBuffer.pop_back();
+  }
+
+  return rewound;
+}
+
+void CBlockDeltaMemoryStream::CullPastFrames(uint64_t frameCount)
+{
+  for (uint64_t removedCount = 0; removedCount < frameCount; removedCount++)
+  {
+    if (m_rewindBuffer.empty())
+    {
+      CLog::Log(LOGDEBUG,
+                "CBlockDeltaMemoryStream: Tried to cull {} frames too many. Check your math!",
+                frameCount - removedCount);
+      break;
+    }
+    m_memoryUsage -= FrameCost(m_rewindBuffer.front());
+    m_rewindBuffer.pop_front();
+  }
+}
+
+void CBlockDeltaMemoryStream::ApplyFrame(const MemoryFrame& frame)
+{
+  if (frame.deltaSize == 0)
+    return;
+
+  const uint8_t* delta = frame.buffer.data() + frame.runBytes;
+  if (frame.compressed)
+  {
+    m_delta.resize(frame.deltaSize);
+    lzo_uint deltaSize = frame.deltaSize;
+    if (lzo1x_decompress_safe(delta, frame.buffer.size() - frame.runBytes, m_delta.data(),
+                              &deltaSize, nullptr) != LZO_E_OK ||
+        deltaSize != frame.deltaSize)
+    {
+      CLog::Log(LOGERROR, "CBlockDeltaMemoryStream: Failed to decompress frame {}",
+                frame.frameHistoryCount);
+      return;
+    }
+    delta = m_delta.data();
+  }
+
+  uint8_t* currentFrame = reinterpret_cast<uint8_t*>(m_currentFrame.get());
+
+  const uint8_t* runs = frame.buffer.data();
+  const uint8_t* runsEnd = runs + frame.runBytes;
+  size_t pos = 0;
+  while (runs < runsEnd)
+  {
+    pos += GetVarint(runs) * BLOCK_SIZE;
+    const size_t size = std::min(GetVarint(runs) * BLOCK_SIZE, m_paddedFrameSize - pos);
+    XorBuffers(currentFrame + pos, delta, currentFrame + pos, size);
+    delta += size;
+    pos += size;
+  }
+}
+
+void CBlockDeltaMemoryStream::CullToBudget()
+{
+  if (m_memoryBudget == 0)
+    return;
+
+  uint64_t cullCount = 0;
+  size_t memoryUsage = m_memoryUsage;
+  for (const MemoryFrame& frame : m_rewindBuffer)
+  {
+    if (memoryUsage <= m_memoryBudget)
+      break;
+    memoryUsage -= FrameCost(frame);
+    cullCount++;
+  }
+
+  if (cullCount > 0)
+    CullPastFrames(cullCount);
+}
+
+size_t CBlockDeltaMemoryStream::FrameCost(const MemoryFrame& frame)
+{
+  return sizeof(MemoryFrame) + frame.buffer.capacity();
+}
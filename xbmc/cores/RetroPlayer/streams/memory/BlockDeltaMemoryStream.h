@@ -0,0 +1,107 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "LinearMemoryStream.h"
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace KODI
+{
+namespace RETRO
+{
+/*!
+ * \brief Encoder statistics of a memory stream
+ */
+struct MemoryStreamStats
+{
+  uint64_t frameCount = 0; //!< Frames encoded since the stream was initialized
+  double bytesPerFrame = 0.0; //!< Average size of a stored frame
+  double encodeTimeUs = 0.0; //!< Average time to encode a frame
+  size_t lastFrameBytes = 0; //!< Size of the last stored frame
+  unsigned int lastEncodeTimeUs = 0; //!< Time to encode the last frame
+  size_t memoryUsage = 0; //!< Bytes held by the rewind buffer
+};
+
+/*!
+ * \brief Implementation of a linear memory stream using compressed block deltas
+ *
+ * The frame is split into blocks that are compared with SIMD. Only blocks that
+ * changed are kept: runs of changed blocks are stored as a list of lengths,
+ * their XOR delta is compressed with LZO1X-1. Unlike CDeltaPairMemoryStream,
+ * which spends 12-16 bytes per changed word, a frame usually costs a few
+ * hundred bytes, which allows much longer rewind windows for systems with
+ * large save states.
+ *
+ * In addition to the frame count, the window can be limited by a memory
+ * budget, the oldest frames are dropped when it is exceeded.
+ */
+class CBlockDeltaMemoryStream : public CLinearMemoryStream
+{
+public:
+  /*!
+   * \param memoryBudget Maximum bytes used by the rewind buffer, or 0 for no limit
+   */
+  explicit CBlockDeltaMemoryStream(size_t memoryBudget = 0);
+
+  ~CBlockDeltaMemoryStream() override = default;
+
+  // implementation of IMemoryStream via CLinearMemoryStream
+  void Reset() override;
+  uint64_t PastFramesAvailable() const override;
+  uint64_t RewindFrames(uint64_t frameCount) override;
+
+  void SetMemoryBudget(size_t memoryBudget);
+  size_t MemoryBudget() const { return m_memoryBudget; }
+
+  /*!
+   * \brief Get the frame sizes and encode times since Init()
+   */
+  MemoryStreamStats GetStats() const;
+
+protected:
+  // implementation of CLinearMemoryStream
+  void SubmitFrameInternal() override;
+  void CullPastFrames(uint64_t frameCount) override;
+
+private:
+  struct MemoryFrame
+  {
+    std::vector<uint8_t> buffer; //!< Run lengths followed by the (compressed) delta
+    uint32_t runBytes;
+    uint32_t deltaSize; //!< Uncompressed size of the delta
+    bool compressed;
+    uint64_t frameHistoryCount;
+  };
+
+  void ApplyFrame(const MemoryFrame& frame);
+  void CullToBudget();
+  static size_t FrameCost(const MemoryFrame& frame);
+
+  size_t m_memoryBudget;
+  size_t m_memoryUsage = 0;
+  std::deque<MemoryFrame> m_rewindBuffer;
+
+  // Scratch buffers reused for every frame
+  std::vector<uint8_t> m_delta;
+  std::vector<uint8_t> m_compressed;
+  std::vector<uint8_t> m_runs;
+  std::unique_ptr<uint8_t[]> m_workMemory;
+
+  // Statistics
+  uint64_t m_encodedFrames = 0;
+  uint64_t m_encodedBytes = 0;
+  uint64_t m_encodeTimeUs = 0;
+  size_t m_lastFrameBytes = 0;
+  unsigned int m_lastEncodeTimeUs = 0;
+};
+} // namespace RETRO
+} // namespace KODI
@@ -0,0 +1,230 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/RetroPlayer/streams/memory/BlockDeltaMemoryStream.h"
+
+#include <random>
+#include <string.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace KODI;
+using namespace RETRO;
+
+namespace
+{
+// Not a multiple of the block or word size
+constexpr size_t FRAME_SIZE = 100003;
+
+/*!
+ * \brief Emulated console state, a few variables change every frame
+ */
+class CFakeState
+{
+public:
+  explicit CFakeState(size_t size) : m_state(size)
+  {
+    for (auto& byte : m_state)
+      byte = static_cast<uint8_t>(m_random());
+  }
+
+  void RunFrame(unsigned int changes)
+  {
+    std::uniform_int_distribution<size_t> pos(0, m_state.size() - 1);
+    for (unsigned int i = 0; i < changes; i++)
+      m_state[pos(m_random)] += 1 + (m_random() % 255);
+
+    // a frame counter at the very end of the state
+    m_state.back()++;
+  }
+
+  void Serialize(IMemoryStream& stream) const
+  {
+    memcpy(stream.BeginFrame(), m_state.data(), m_state.size());
+    stream.SubmitFrame();
+  }
+
+  const std::vector<uint8_t>& Data() const { return m_state; }
+
+private:
+  std::vector<uint8_t> m_state;
+  std::mt19937 m_random{1234};
+};
+
+bool FrameEquals(const IMemoryStream& stream, const std::vector<uint8_t>& expected)
+{
+  return stream.CurrentFrame() != nullptr &&
+         memcmp(stream.CurrentFrame(), expected.data(), expected.size()) == 0;
+}
+} // namespace
+
+TEST(TestBlockDeltaMemoryStream, Rewind)
+{
+  CBlockDeltaMemoryStream stream;
+  stream.Init(FRAME_SIZE, 100);
+
+  CFakeState state(FRAME_SIZE);
+  std::vector<std::vector<uint8_t>> history;
+  for (unsigned int frame = 0; frame < 50; frame++)
+  {
+    state.RunFrame(frame * 10);
+    state.Serialize(stream);
+    history.push_back(state.Data());
+  }
+
+  ASSERT_EQ(49u, stream.PastFramesAvailable());
+  EXPECT_EQ(49u, stream.GetFrameCounter());
+  ASSERT_TRUE(FrameEquals(stream, history.back()));
+
+  // rewind one frame at a time
+  for (unsigned int frame = 49; frame > 40; frame--)
+  {
+    ASSERT_EQ(1u, stream.RewindFrames(1));
+    ASSERT_TRUE(FrameEquals(stream, history[frame - 1])) << "frame " << frame - 1;
+    EXPECT_EQ(frame - 1, stream.GetFrameCounter());
+  }
+
+  // and several at once, the stream stops at the oldest frame
+  ASSERT_EQ(10u, stream.RewindFrames(10));
+  ASSERT_TRUE(FrameEquals(stream, history[30]));
+  EXPECT_EQ(30u, stream.RewindFrames(100));
+  ASSERT_TRUE(FrameEquals(stream, history[0]));
+  EXPECT_EQ(0u, stream.PastFramesAvailable());
+
+  // playing on after a rewind
+  state.RunFrame(100);
+  state.Serialize(stream);
+  EXPECT_EQ(1u, stream.PastFramesAvailable());
+  ASSERT_EQ(1u, stream.RewindFrames(1));
+  ASSERT_TRUE(FrameEquals(stream, history[0]));
+}
+
+TEST(TestBlockDeltaMemoryStream, SmallFrames)
+{
+  for (size_t frameSize : {1, 3, 17, 129, 255})
+  {
+    CBlockDeltaMemoryStream stream;
+    stream.Init(frameSize, 10);
+
+    CFakeState state(frameSize);
+    std::vector<std::vector<uint8_t>> history;
+    for (unsigned int frame = 0; frame < 5; frame++)
+    {
+      state.RunFrame(2);
+      state.Serialize(stream);
+      history.push_back(state.Data());
+    }
+
+    for (unsigned int frame = 4; frame > 0; frame--)
+    {
+      ASSERT_EQ(1u, stream.RewindFrames(1));
+      ASSERT_TRUE(FrameEquals(stream, history[frame - 1])) << "frame size " << frameSize;
+    }
+  }
+}
+
+TEST(TestBlockDeltaMemoryStream, UnchangedFrames)
+{
+  CBlockDeltaMemoryStream stream;
+  stream.Init(FRAME_SIZE, 100);
+
+  CFakeState state(FRAME_SIZE);
+  for (unsigned int frame = 0; frame < 10; frame++)
+    state.Serialize(stream);
+
+  // a paused game costs nothing but the bookkeeping
+  const MemoryStreamStats stats = stream.GetStats();
+  EXPECT_EQ(9u, stats.frameCount);
+  EXPECT_EQ(0u, stats.lastFrameBytes);
+  EXPECT_DOUBLE_EQ(0.0, stats.bytesPerFrame);
+  EXPECT_EQ(9u, stream.PastFramesAvailable());
+}
+
+TEST(TestBlockDeltaMemoryStream, MaxFrameCount)
+{
+  CBlockDeltaMemoryStream stream;
+  stream.Init(FRAME_SIZE, 10);
+
+  CFakeState state(FRAME_SIZE);
+  for (unsigned int frame = 0; frame < 20; frame++)
+  {
+    state.RunFrame(10);
+    state.Serialize(stream);
+  }
+  EXPECT_EQ(9u, stream.PastFramesAvailable());
+
+  stream.SetMaxFrameCount(5);
+  EXPECT_EQ(4u, stream.PastFramesAvailable());
+  EXPECT_EQ(4u, stream.RewindFrames(10));
+  EXPECT_EQ(15u, stream.GetFrameCounter());
+}
+
+TEST(TestBlockDeltaMemoryStream, MemoryBudget)
+{
+  CBlockDeltaMemoryStream unlimited;
+  unlimited.Init(FRAME_SIZE, 1000);
+  CFakeState state(FRAME_SIZE);
+  for (unsigned int frame = 0; frame < 100; frame++)
+  {
+    state.RunFrame(50);
+    state.Serialize(unlimited);
+  }
+  EXPECT_EQ(99u, unlimited.PastFramesAvailable());
+  const size_t fullUsage = unlimited.GetStats().memoryUsage;
+  ASSERT_GT(fullUsage, 0u);
+
+  // half the memory holds about half the frames
+  CBlockDeltaMemoryStream stream(fullUsage / 2);
+  stream.Init(FRAME_SIZE, 1000);
+  CFakeState state2(FRAME_SIZE);
+  std::vector<uint8_t> last;
+  for (unsigned int frame = 0; frame < 100; frame++)
+  {
+    state2.RunFrame(50);
+    state2.Serialize(stream);
+    EXPECT_LE(stream.GetStats().memoryUsage, fullUsage / 2);
+  }
+  EXPECT_GT(stream.PastFramesAvailable(), 40u);
+  EXPECT_LT(stream.PastFramesAvailable(), 60u);
+
+  stream.SetMemoryBudget(fullUsage / 10);
+  EXPECT_LE(stream.GetStats().memoryUsage, fullUsage / 10);
+  EXPECT_LT(stream.PastFramesAvailable(), 15u);
+
+  // the remaining frames can still be rewound
+  const uint64_t past = stream.PastFramesAvailable();
+  EXPECT_EQ(past, stream.RewindFrames(past));
+  EXPECT_EQ(0u, stream.GetStats().memoryUsage);
+}
+
+TEST(TestBlockDeltaMemoryStream, Stats)
+{
+  CBlockDeltaMemoryStream stream;
+  stream.Init(FRAME_SIZE, 100);
+
+  CFakeState state(FRAME_SIZE);
+  for (unsigned int frame = 0; frame < 50; frame++)
+  {
+    state.RunFrame(100);
+    state.Serialize(stream);
+  }
+
+  const MemoryStreamStats stats = stream.GetStats();
+  EXPECT_EQ(49u, stats.frameCount);
+  EXPECT_GT(stats.bytesPerFrame, 0.0);
+  EXPECT_GT(stats.lastFrameBytes, 0u);
+  EXPECT_GE(stats.memoryUsage, static_cast<size_t>(stats.bytesPerFrame * 49));
+
+  // 100 changed bytes cost 1600 bytes as delta pairs
+  EXPECT_LT(stats.bytesPerFrame, 1600.0);
+
+  stream.Reset();
+  EXPECT_EQ(0u, stream.GetStats().frameCount);
+  EXPECT_EQ(0u, stream.GetStats().memoryUsage);
+}
@@ -9,6 +9,7 @@
 #include "VideoBuffer.h"
 
 #include "threads/SingleLock.h"
+#include "utils/FrameCopy.h"
 
 #include <string.h>
 #include <utility>
@@ -51,124 +52,34 @@ AVPixelFormat CVideoBuffer::GetFormat()
 
 bool CVideoBuffer::CopyPicture(YuvImage* pDst, YuvImage *pSrc)
 {
-  uint8_t *s = pSrc->plane[0];
-  uint8_t *d = pDst->plane[0];
-  int w = pDst->width * pDst->bpp;
-  int h = pDst->height;
-  if ((w == pSrc->stride[0]) && (pSrc->stride[0] == pDst->stride[0]))
-  {
-    memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      memcpy(d, s, w);
-      s += pSrc->stride[0];
-      d += pDst->stride[0];
-    }
-  }
-  s = pSrc->plane[1];
-  d = pDst->plane[1];
-  w =(pDst->width  >> pDst->cshift_x) * pDst->bpp;
-  h =(pDst->height >> pDst->cshift_y);
-  if ((w == pSrc->stride[1]) && (pSrc->stride[1] == pDst->stride[1]))
-  {
-    memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      memcpy(d, s, w);
-      s += pSrc->stride[1];
-      d += pDst->stride[1];
-    }
-  }
-  s = pSrc->plane[2];
-  d = pDst->plane[2];
-  if ((w == pSrc->stride[2]) && (pSrc->stride[2] == pDst->stride[2]))
-  {
-    memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      memcpy(d, s, w);
-      s += pSrc->stride[2];
-      d += pDst->stride[2];
-    }
-  }
+  const int w = pDst->width * pDst->bpp;
+  const int h = pDst->height;
+  CFrameCopy::CopyPlane(pDst->plane[0], pDst->stride[0], pSrc->plane[0], pSrc->stride[0], w, h);
+
+  const int cw = (pDst->width >> pDst->cshift_x) * pDst->bpp;
+  const int ch = pDst->height >> pDst->cshift_y;
+  CFrameCopy::CopyPlane(pDst->plane[1], pDst->stride[1], pSrc->plane[1], pSrc->stride[1], cw, ch);
+  CFrameCopy::CopyPlane(pDst->plane[2], pDst->stride[2], pSrc->plane[2], pSrc->stride[2], cw, ch);
   return true;
 }
 
-
 bool CVideoBuffer::CopyNV12Picture(YuvImage* pDst, YuvImage *pSrc)
 {
-  uint8_t *s = pSrc->plane[0];
-  uint8_t *d = pDst->plane[0];
-  int w = pDst->width;
-  int h = pDst->height;
+  const int w = pDst->width;
+  const int h = pDst->height;
   // Copy Y
-  if ((w == pSrc->stride[0]) && (pSrc->stride[0] == pDst->stride[0]))
-  {
-    memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      memcpy(d, s, w);
-      s += pSrc->stride[0];
-      d += pDst->stride[0];
-    }
-  }
-
-  s = pSrc->plane[1];
-  d = pDst->plane[1];
-  w = pDst->width;
-  h = pDst->height >> 1;
+  CFrameCopy::CopyPlane(pDst->plane[0], pDst->stride[0], pSrc->plane[0], pSrc->stride[0], w, h);
   // Copy packed UV (width is same as for Y as it's both U and V components)
-  if ((w == pSrc->stride[1]) && (pSrc->stride[1] == pDst->stride[1]))
-  {
-    memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      memcpy(d, s, w);
-      s += pSrc->stride[1];
-      d += pDst->stride[1];
-    }
-  }
-
+  CFrameCopy::CopyPlane(pDst->plane[1], pDst->stride[1], pSrc->plane[1], pSrc->stride[1], w,
+                        h >> 1);
   return true;
 }
 
 bool CVideoBuffer::CopyYUV422PackedPicture(YuvImage* pDst, YuvImage *pSrc)
 {
-  uint8_t *s = pSrc->plane[0];
-  uint8_t *d = pDst->plane[0];
-  int w = pDst->width;
-  int h = pDst->height;
-
   // Copy YUYV
-  if ((w * 2 == pSrc->stride[0]) && (pSrc->stride[0] == pDst->stride[0]))
-  {
-    memcpy(d, s, w*h*2);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      memcpy(d, s, w*2);
-      s += pSrc->stride[0];
-      d += pDst->stride[0];
-    }
-  }
-
+  CFrameCopy::CopyPlane(pDst->plane[0], pDst->stride[0], pSrc->plane[0], pSrc->stride[0],
+                        pDst->width * 2, pDst->height);
   return true;
 }
 
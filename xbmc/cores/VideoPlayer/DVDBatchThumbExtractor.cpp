@@ -0,0 +1,196 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "DVDBatchThumbExtractor.h"
+
+#include "DVDCodecs/DVDFactoryCodec.h"
+#include "DVDCodecs/Video/DVDVideoCodec.h"
+#include "DVDDemuxers/DVDDemux.h"
+#include "DVDDemuxers/DVDDemuxUtils.h"
+#include "DVDDemuxers/DVDFactoryDemuxer.h"
+#include "DVDFileInfo.h"
+#include "DVDInputStreams/DVDFactoryInputStream.h"
+#include "DVDInputStreams/DVDInputStream.h"
+#include "DVDStreamInfo.h"
+#include "Process/ProcessInfo.h"
+#include "TextureCache.h"
+#include "URL.h"
+#include "cores/VideoPlayer/Interface/DemuxPacket.h"
+#include "filesystem/File.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+namespace
+{
+// packets to read after a seek without getting a key frame before giving up on a request
+constexpr int MAX_PACKETS_PER_REQUEST = 300;
+
+// an empty cache file marks a request as failed so it is not retried forever
+void MarkFailed(const ThumbExtractRequest& request)
+{
+  XFILE::CFile cacheFile;
+  if (cacheFile.OpenForWrite(CTextureCache::GetCachedPath(request.details.file)))
+    cacheFile.Close();
+}
+
+unsigned int MarkAllFailed(const ThumbExtractFile& file)
+{
+  for (const auto& request : file.requests)
+    MarkFailed(request);
+  return 0;
+}
+} // namespace
+
+unsigned int CDVDBatchThumbExtractor::Extract(ThumbExtractFile& file)
+{
+  const std::string redactPath = CURL::GetRedacted(file.item.GetPath());
+
+  CFileItem item(file.item);
+  item.SetMimeTypeForInternetFile();
+  auto inputStream = CDVDFactoryInputStream::CreateInputStream(nullptr, item);
+  if (!inputStream || !inputStream->Open())
+  {
+    CLog::Log(LOGERROR, "CDVDBatchThumbExtractor::{} - error opening {}", __FUNCTION__,
+              redactPath);
+    return MarkAllFailed(file);
+  }
+
+  std::unique_ptr<CDVDDemux> demuxer;
+  try
+  {
+    demuxer.reset(CDVDFactoryDemuxer::CreateDemuxer(inputStream, true));
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "CDVDBatchThumbExtractor::{} - exception thrown when opening demuxer",
+              __FUNCTION__);
+    return MarkAllFailed(file);
+  }
+
+  if (!demuxer)
+  {
+    CLog::Log(LOGERROR, "CDVDBatchThumbExtractor::{} - error creating demuxer for {}",
+              __FUNCTION__, redactPath);
+    return MarkAllFailed(file);
+  }
+
+  if (file.streamDetails)
+    CDVDFileInfo::ProbeStreamDetails(inputStream, demuxer.get(), item.GetPath(),
+                                     *file.streamDetails);
+
+  CDemuxStream* videoStream = nullptr;
+  for (CDemuxStream* stream : demuxer->GetStreams())
+  {
+    if (!stream)
+      continue;
+
+    // ignore if it's a picture attachment (e.g. jpeg artwork)
+    if (!videoStream && stream->type == STREAM_VIDEO &&
+        !(stream->flags & AV_DISPOSITION_ATTACHED_PIC))
+      videoStream = stream;
+    else
+      demuxer->EnableStream(stream->demuxerId, stream->uniqueId, false);
+  }
+
+  if (!videoStream)
+    return MarkAllFailed(file);
+
+  CDVDStreamInfo hint(*videoStream, true);
+  hint.codecOptions = CODEC_FORCE_SOFTWARE;
+
+  // the process info has to outlive the codec
+  std::unique_ptr<CProcessInfo> processInfo(CProcessInfo::CreateInstance());
+  std::vector<AVPixelFormat> pixFmts;
+  pixFmts.push_back(AV_PIX_FMT_YUV420P);
+  processInfo->SetPixFormats(pixFmts);
+
+  std::unique_ptr<CDVDVideoCodec> codec = CDVDFactoryCodec::CreateVideoCodec(hint, *processInfo);
+  if (!codec)
+  {
+    CLog::Log(LOGERROR, "CDVDBatchThumbExtractor::{} - unable to open video codec for {}",
+              __FUNCTION__, redactPath);
+    return MarkAllFailed(file);
+  }
+  codec->SetCodecControl(DVD_CODEC_CTRL_KEYFRAMES);
+
+  const int videoStreamId = videoStream->uniqueId;
+
+  // a single forward pass over the file in position order
+  std::vector<ThumbExtractRequest*> requests;
+  for (auto& request : file.requests)
+  {
+    if (request.pos < 0)
+      request.pos = demuxer->GetStreamLength() / 3;
+    requests.push_back(&request);
+  }
+  std::sort(requests.begin(), requests.end(),
+            [](const ThumbExtractRequest* a, const ThumbExtractRequest* b) {
+              return a->pos < b->pos;
+            });
+
+  unsigned int extracted = 0;
+  VideoPicture picture;
+  for (ThumbExtractRequest* request : requests)
+  {
+    // backwards seek lands on the key frame at or before the requested position
+    if (!demuxer->SeekTime(static_cast<double>(request->pos), true))
+      continue;
+    codec->Reset();
+
+    bool gotPicture = false;
+    for (int packets = 0; packets < MAX_PACKETS_PER_REQUEST && !gotPicture; ++packets)
+    {
+      DemuxPacket* packet = demuxer->Read();
+      if (!packet)
+        break;
+
+      if (packet->iStreamId == videoStreamId)
+      {
+        codec->AddData(*packet);
+
+        CDVDVideoCodec::VCReturn ret;
+        while ((ret = codec->GetPicture(&picture)) == CDVDVideoCodec::VC_NONE ||
+               ret == CDVDVideoCodec::VC_PICTURE)
+        {
+          if (ret == CDVDVideoCodec::VC_PICTURE && !(picture.iFlags & DVP_FLAG_DROPPED))
+          {
+            gotPicture = true;
+            break;
+          }
+        }
+      }
+
+      CDVDDemuxUtils::FreeDemuxPacket(packet);
+    }
+
+    if (gotPicture && CDVDFileInfo::CachePicture(picture, hint, request->details))
+    {
+      request->extracted = true;
+      extracted++;
+    }
+  }
+
+  for (const auto& request : file.requests)
+  {
+    if (!request.extracted)
+      MarkFailed(request);
+  }
+
+  CLog::Log(LOGDEBUG,
+            "CDVDBatchThumbExtractor::{} - extracted {}/{} images from {}", __FUNCTION__,
+            extracted, file.requests.size(), redactPath);
+
+  return extracted;
+}
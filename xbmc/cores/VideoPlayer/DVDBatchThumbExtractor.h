@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "FileItem.h"
+#include "TextureCacheJob.h"
+
+#include <stdint.h>
+#include <vector>
+
+class CStreamDetails;
+
+/*!
+ * \brief A single image to extract from a file.
+ */
+struct ThumbExtractRequest
+{
+  int64_t pos = 0; //!< position in ms, -1 for a third of the stream length
+  CTextureDetails details; //!< details.file must be set to the cache file to create
+  bool extracted = false;
+};
+
+/*!
+ * \brief All images to extract from one file.
+ */
+struct ThumbExtractFile
+{
+  CFileItem item;
+  std::vector<ThumbExtractRequest> requests;
+  CStreamDetails* streamDetails = nullptr; //!< if set, filled in from the opened file
+};
+
+/*!
+ * \brief Batch, keyframe-only thumbnail extractor.
+ *
+ * Opens the file once and extracts all requested images in a single forward pass: each
+ * request is satisfied by the first key frame at or before its position, non-key frames are
+ * discarded by the decoder.
+ */
+class CDVDBatchThumbExtractor
+{
+public:
+  /*!
+   * \brief Extract all requested images of a file. Requests that fail get an empty cache file
+   * so they are not retried.
+   * \return The number of images extracted.
+   */
+  static unsigned int Extract(ThumbExtractFile& file);
+};
@@ -1338,6 +1338,12 @@ void CDVDVideoCodecFFmpeg::SetCodecControl(int flags)
       m_pCodecContext->skip_idct = AVDISCARD_NONREF;
       m_pCodecContext->skip_loop_filter = AVDISCARD_NONREF;
     }
+    else if (flags & DVD_CODEC_CTRL_KEYFRAMES)
+    {
+      m_pCodecContext->skip_frame = AVDISCARD_NONKEY;
+      m_pCodecContext->skip_idct = AVDISCARD_DEFAULT;
+      m_pCodecContext->skip_loop_filter = AVDISCARD_DEFAULT;
+    }
     else
     {
       m_pCodecContext->skip_frame = AVDISCARD_DEFAULT;
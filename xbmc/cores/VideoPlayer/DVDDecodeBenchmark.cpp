@@ -0,0 +1,263 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "DVDDecodeBenchmark.h"
+
+#include "DVDCodecs/Audio/DVDAudioCodec.h"
+#include "DVDCodecs/DVDFactoryCodec.h"
+#include "DVDCodecs/Video/DVDVideoCodec.h"
+#include "DVDDemuxers/DVDDemux.h"
+#include "DVDDemuxers/DVDDemuxUtils.h"
+#include "DVDDemuxers/DVDFactoryDemuxer.h"
+#include "DVDInputStreams/DVDFactoryInputStream.h"
+#include "DVDInputStreams/DVDInputStream.h"
+#include "DVDStreamInfo.h"
+#include "FileItem.h"
+#include "Process/ProcessInfo.h"
+#include "URL.h"
+#include "cores/VideoPlayer/Interface/DemuxPacket.h"
+#include "utils/StringUtils.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <set>
+#include <vector>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+namespace
+{
+// give up on a packet the decoder keeps refusing after this many drain attempts
+constexpr int MAX_ADDDATA_RETRIES = 160;
+
+double Percentile(const std::vector<double>& sorted, double p)
+{
+  if (sorted.empty())
+    return 0.0;
+
+  const size_t idx = std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()));
+  return sorted[idx];
+}
+
+struct VideoDecodeState
+{
+  VideoPicture picture;
+  std::set<int> bufferIds;
+};
+
+void DrainVideo(CDVDVideoCodec& codec, VideoDecodeState& state, DecodeBenchmarkResult& result)
+{
+  while (true)
+  {
+    const CDVDVideoCodec::VCReturn ret = codec.GetPicture(&state.picture);
+    if (ret == CDVDVideoCodec::VC_NONE)
+      continue;
+
+    if (ret == CDVDVideoCodec::VC_PICTURE)
+    {
+      if (state.picture.iFlags & DVP_FLAG_DROPPED)
+      {
+        result.droppedFrames++;
+      }
+      else
+      {
+        result.videoFrames++;
+        if (state.picture.videoBuffer)
+          state.bufferIds.insert(state.picture.videoBuffer->GetId());
+      }
+      continue;
+    }
+
+    if (ret == CDVDVideoCodec::VC_ERROR || ret == CDVDVideoCodec::VC_FATAL)
+      result.decoderErrors++;
+
+    break;
+  }
+}
+
+void DrainAudio(CDVDAudioCodec& codec, DecodeBenchmarkResult& result)
+{
+  DVDAudioFrame frame = {};
+  while (true)
+  {
+    codec.GetData(frame);
+    if (frame.nb_frames == 0)
+      break;
+
+    // null sink: the samples are only counted
+    result.audioFrames += frame.nb_frames;
+  }
+}
+} // namespace
+
+std::string DecodeBenchmarkResult::ToString() const
+{
+  return StringUtils::Format(
+      "video: {} audio: {} elapsed: {:.3f}s fps: {:.2f} latency(ms) p50: {:.3f} p90: {:.3f} "
+      "p99: {:.3f} max: {:.3f} packets: {} frames: {} buffers: {} dropped: {} errors: {} "
+      "audio frames: {}",
+      videoCodec, audioCodec.empty() ? "none" : audioCodec, elapsedSeconds, decodeFps, latencyP50,
+      latencyP90, latencyP99, latencyMax, packets, videoFrames, videoBuffers, droppedFrames,
+      decoderErrors, audioFrames);
+}
+
+bool CDVDDecodeBenchmark::Run(const std::string& path, DecodeBenchmarkResult& result)
+{
+  result = DecodeBenchmarkResult();
+  const std::string redactPath = CURL::GetRedacted(path);
+
+  CFileItem item(path, false);
+  item.SetMimeTypeForInternetFile();
+  auto inputStream = CDVDFactoryInputStream::CreateInputStream(nullptr, item);
+  if (!inputStream || !inputStream->Open())
+  {
+    CLog::Log(LOGERROR, "CDVDDecodeBenchmark::{} - error opening {}", __FUNCTION__, redactPath);
+    return false;
+  }
+
+  std::unique_ptr<CDVDDemux> demuxer;
+  try
+  {
+    demuxer.reset(CDVDFactoryDemuxer::CreateDemuxer(inputStream, true));
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "CDVDDecodeBenchmark::{} - exception thrown when opening demuxer",
+              __FUNCTION__);
+    return false;
+  }
+
+  if (!demuxer)
+  {
+    CLog::Log(LOGERROR, "CDVDDecodeBenchmark::{} - error creating demuxer for {}", __FUNCTION__,
+              redactPath);
+    return false;
+  }
+
+  CDemuxStream* videoStream = nullptr;
+  CDemuxStream* audioStream = nullptr;
+  for (CDemuxStream* stream : demuxer->GetStreams())
+  {
+    if (!stream)
+      continue;
+
+    if (!videoStream && stream->type == STREAM_VIDEO &&
+        !(stream->flags & AV_DISPOSITION_ATTACHED_PIC))
+      videoStream = stream;
+    else if (!audioStream && m_decodeAudio && stream->type == STREAM_AUDIO)
+      audioStream = stream;
+    else
+      demuxer->EnableStream(stream->demuxerId, stream->uniqueId, false);
+  }
+
+  if (!videoStream)
+  {
+    CLog::Log(LOGERROR, "CDVDDecodeBenchmark::{} - no video stream in {}", __FUNCTION__,
+              redactPath);
+    return false;
+  }
+
+  std::unique_ptr<CProcessInfo> processInfo(CProcessInfo::CreateInstance());
+  std::vector<AVPixelFormat> pixFmts;
+  pixFmts.push_back(AV_PIX_FMT_YUV420P);
+  processInfo->SetPixFormats(pixFmts);
+
+  CDVDStreamInfo videoHint(*videoStream, true);
+  videoHint.codecOptions = CODEC_FORCE_SOFTWARE;
+  std::unique_ptr<CDVDVideoCodec> videoCodec =
+      CDVDFactoryCodec::CreateVideoCodec(videoHint, *processInfo);
+  if (!videoCodec)
+  {
+    CLog::Log(LOGERROR, "CDVDDecodeBenchmark::{} - unable to open video codec for {}",
+              __FUNCTION__, redactPath);
+    return false;
+  }
+  result.videoCodec = videoCodec->GetName();
+
+  std::unique_ptr<CDVDAudioCodec> audioCodec;
+  if (audioStream)
+  {
+    CDVDStreamInfo audioHint(*audioStream, true);
+    audioCodec = CDVDFactoryCodec::CreateAudioCodec(audioHint, *processInfo, false, false,
+                                                    CAEStreamInfo::STREAM_TYPE_NULL);
+    if (audioCodec)
+      result.audioCodec = audioCodec->GetName();
+  }
+
+  const int videoStreamId = videoStream->uniqueId;
+  const int audioStreamId = audioStream ? audioStream->uniqueId : -1;
+
+  VideoDecodeState state;
+  std::vector<double> latencies;
+  const auto start = std::chrono::steady_clock::now();
+
+  while (m_maxFrames == 0 || result.videoFrames < m_maxFrames)
+  {
+    DemuxPacket* packet = demuxer->Read();
+    if (!packet)
+      break;
+
+    result.packets++;
+
+    if (packet->iStreamId == videoStreamId)
+    {
+      const auto packetStart = std::chrono::steady_clock::now();
+
+      bool added = videoCodec->AddData(*packet);
+      for (int retries = MAX_ADDDATA_RETRIES; !added && retries > 0; --retries)
+      {
+        DrainVideo(*videoCodec, state, result);
+        added = videoCodec->AddData(*packet);
+      }
+      // the picture of a packet the decoder never accepted is lost
+      if (!added)
+        result.droppedFrames++;
+      DrainVideo(*videoCodec, state, result);
+
+      const std::chrono::duration<double, std::milli> latency =
+          std::chrono::steady_clock::now() - packetStart;
+      latencies.push_back(latency.count());
+    }
+    else if (audioCodec && packet->iStreamId == audioStreamId)
+    {
+      if (!audioCodec->AddData(*packet))
+      {
+        DrainAudio(*audioCodec, result);
+        audioCodec->AddData(*packet);
+      }
+      DrainAudio(*audioCodec, result);
+    }
+
+    CDVDDemuxUtils::FreeDemuxPacket(packet);
+  }
+
+  // deliver the pictures still held back by the decoder
+  videoCodec->SetCodecControl(DVD_CODEC_CTRL_DRAIN);
+  DrainVideo(*videoCodec, state, result);
+
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  result.elapsedSeconds = elapsed.count();
+  if (result.elapsedSeconds > 0.0)
+    result.decodeFps = result.videoFrames / result.elapsedSeconds;
+
+  std::sort(latencies.begin(), latencies.end());
+  result.latencyP50 = Percentile(latencies, 0.50);
+  result.latencyP90 = Percentile(latencies, 0.90);
+  result.latencyP99 = Percentile(latencies, 0.99);
+  result.latencyMax = latencies.empty() ? 0.0 : latencies.back();
+  result.videoBuffers = state.bufferIds.size();
+
+  CLog::Log(LOGINFO, "CDVDDecodeBenchmark::{} - {}: {}", __FUNCTION__, redactPath,
+            result.ToString());
+
+  return result.videoFrames > 0;
+}
@@ -0,0 +1,76 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+/*!
+ * \brief Result of a single decode benchmark run.
+ *
+ * All latencies are in milliseconds and measure the wall time from handing a packet to the
+ * decoder until the decoder has returned all output produced by that packet.
+ */
+struct DecodeBenchmarkResult
+{
+  std::string videoCodec;
+  std::string audioCodec;
+
+  double elapsedSeconds = 0.0;
+  double decodeFps = 0.0;
+
+  double latencyP50 = 0.0;
+  double latencyP90 = 0.0;
+  double latencyP99 = 0.0;
+  double latencyMax = 0.0;
+
+  uint64_t packets = 0; //!< demux packets allocated by the demuxer
+  uint64_t videoFrames = 0; //!< pictures returned by the video decoder
+  uint64_t videoBuffers = 0; //!< distinct video buffers handed out by the decoder's pool
+  uint64_t droppedFrames = 0; //!< pictures dropped by the decoder or packets it refused
+  uint64_t decoderErrors = 0; //!< VC_ERROR returns from the video decoder
+  uint64_t audioFrames = 0; //!< audio sample frames delivered to the null sink
+
+  std::string ToString() const;
+};
+
+/*!
+ * \brief Headless decode pipeline benchmark.
+ *
+ * Drives CDVDDemuxFFmpeg -> CDVDVideoCodecFFmpeg (software decode) and, optionally, the audio
+ * codec into a null sink that only counts samples. No windowing system, renderer or audio engine
+ * is required, so this can be run from the test suite against fixture clips.
+ */
+class CDVDDecodeBenchmark
+{
+public:
+  CDVDDecodeBenchmark() = default;
+
+  /*!
+   * \brief Stop after this many video frames (0 = decode the whole file).
+   */
+  void SetMaxFrames(unsigned int maxFrames) { m_maxFrames = maxFrames; }
+
+  /*!
+   * \brief Also decode the first audio stream of the file.
+   */
+  void SetDecodeAudio(bool decodeAudio) { m_decodeAudio = decodeAudio; }
+
+  /*!
+   * \brief Run the benchmark on the given file.
+   * \param path The file to decode.
+   * \param result The collected statistics.
+   * \return true if the file could be opened and at least one video frame was decoded.
+   */
+  bool Run(const std::string& path, DecodeBenchmarkResult& result);
+
+private:
+  unsigned int m_maxFrames = 0;
+  bool m_decodeAudio = true;
+};
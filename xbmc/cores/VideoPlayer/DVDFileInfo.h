@@ -18,15 +18,16 @@ class CStreamDetails;
 class CStreamDetailSubtitle;
 class CDVDInputStream;
 class CTextureDetails;
+class CDVDStreamInfo;
+struct VideoPicture;
 
 class CDVDFileInfo
 {
 public:
-  // Extract a thumbnail image from the media referenced by fileItem, optionally populating a streamdetails class with the data
-  static bool ExtractThumb(const CFileItem& fileItem,
-                           CTextureDetails &details,
-                           CStreamDetails *pStreamDetails,
-                           int64_t pos);
+  // Scale a decoded picture to the configured image resolution and store it in the texture cache
+  static bool CachePicture(const VideoPicture& picture,
+                           const CDVDStreamInfo& hint,
+                           CTextureDetails& details);
 
   // Probe the files streams and store the info in the VideoInfoTag
   static bool GetFileStreamDetails(CFileItem *pItem);
@@ -43,6 +44,14 @@ public:
                                      const std::vector<CStreamDetailSubtitle>& subs,
                                      CStreamDetails& details);
 
+  /** \brief Probe the file's internal streams and the external subtitle files next to it.
+  *   \param[out] details The file's StreamDetails.
+  */
+  static bool ProbeStreamDetails(const std::shared_ptr<CDVDInputStream>& pInputStream,
+                                 CDVDDemux* pDemuxer,
+                                 const std::string& strPath,
+                                 CStreamDetails& details);
+
   static bool GetFileDuration(const std::string &path, int &duration);
 
   /** \brief Probe the streams of an external subtitle file and store the info in the StreamDetails parameter.
@@ -20,6 +20,7 @@
 #include "InputStreamAddon.h"
 #include "InputStreamMultiSource.h"
 #include "InputStreamPVRChannel.h"
+#include "InputStreamPVRPrebuffered.h"
 #include "InputStreamPVRRecording.h"
 #include "ServiceBroker.h"
 #include "URL.h"
@@ -28,6 +29,8 @@
 #include "filesystem/CurlFile.h"
 #include "filesystem/File.h"
 #include "filesystem/IFileTypes.h"
+#include "pvr/PVRManager.h"
+#include "pvr/channels/PVRChannelPrebuffers.h"
 #include "storage/MediaManager.h"
 #include "utils/URIUtils.h"
 
@@ -68,6 +71,15 @@ std::shared_ptr<CDVDInputStream> CDVDFactoryInputStream::CreateInputStream(IVide
       STREAM_PROPERTY_VALUE_INPUTSTREAMFFMPEG)
     return std::shared_ptr<CDVDInputStreamFFmpeg>(new CDVDInputStreamFFmpeg(fileitem));
 
+  if (fileitem.IsPVRChannel())
+  {
+    // the stream may have been opened ahead of time
+    std::shared_ptr<PVR::CPVRStreamPrebuffer> stream =
+        CServiceBroker::GetPVRManager().ChannelPrebuffers()->Take(fileitem.GetPath(), file);
+    if (stream)
+      return std::make_shared<CInputStreamPVRPrebuffered>(fileitem, std::move(stream));
+  }
+
   if (fileitem.IsDiscImage())
   {
 #ifdef HAVE_LIBBLURAY
@@ -8,10 +8,10 @@
 
 #include "DVDInputStreamMemory.h"
 
+#include <string.h>
+
 CDVDInputStreamMemory::CDVDInputStreamMemory(CFileItem& fileitem) : CDVDInputStream(DVDSTREAM_TYPE_MEMORY, fileitem)
 {
-  m_pData = NULL;
-  m_iDataSize = 0;
   m_iDataPos = 0;
 }
 
@@ -20,9 +20,15 @@ CDVDInputStreamMemory::~CDVDInputStreamMemory()
   Close();
 }
 
+void CDVDInputStreamMemory::SetData(std::shared_ptr<const std::vector<uint8_t>> data)
+{
+  m_data = std::move(data);
+  m_iDataPos = 0;
+}
+
 bool CDVDInputStreamMemory::IsEOF()
 {
-  if(m_iDataPos >= m_iDataSize)
+  if(m_iDataPos >= GetLength())
     return true;
 
   return false;
@@ -33,15 +39,13 @@ bool CDVDInputStreamMemory::Open()
   if (!CDVDInputStream::Open())
     return false;
 
-  return true;
+  return m_data != nullptr;
 }
 
 // close file and reset everything
 void CDVDInputStreamMemory::Close()
 {
-  if (m_pData) delete[] m_pData;
-  m_pData = NULL;
-  m_iDataSize = 0;
+  m_data.reset();
   m_iDataPos = 0;
 
   CDVDInputStream::Close();
@@ -49,38 +53,42 @@ void CDVDInputStreamMemory::Close()
 
 int CDVDInputStreamMemory::Read(uint8_t* buf, int buf_size)
 {
-  int iBytesToCopy = buf_size;
-  int iBytesLeft = m_iDataSize - m_iDataPos;
+  int64_t iBytesToCopy = buf_size;
+  int64_t iBytesLeft = GetLength() - m_iDataPos;
   if (iBytesToCopy > iBytesLeft) iBytesToCopy = iBytesLeft;
 
   if (iBytesToCopy > 0)
   {
-    memcpy(buf, m_pData + m_iDataPos, iBytesToCopy);
+    memcpy(buf, m_data->data() + m_iDataPos, static_cast<size_t>(iBytesToCopy));
     m_iDataPos += iBytesToCopy;
   }
 
-  return iBytesToCopy;
+  return static_cast<int>(iBytesToCopy);
 }
 
 int64_t CDVDInputStreamMemory::Seek(int64_t offset, int whence)
 {
+  const int64_t size = GetLength();
   switch (whence)
   {
+    case SEEK_POSSIBLE:
+      return 1;
     case SEEK_CUR:
     {
-      if ((m_iDataPos + offset) > m_iDataSize) return -1;
-      else m_iDataPos += (int)offset;
+      if ((m_iDataPos + offset) > size || (m_iDataPos + offset) < 0) return -1;
+      else m_iDataPos += offset;
       break;
     }
     case SEEK_END:
     {
-      m_iDataPos = m_iDataSize;
+      if (offset > 0 || size + offset < 0) return -1;
+      else m_iDataPos = size + offset;
       break;
     }
     case SEEK_SET:
     {
-      if (offset > m_iDataSize || offset < 0) return -1;
-      else m_iDataPos = (int)offset;
+      if (offset > size || offset < 0) return -1;
+      else m_iDataPos = offset;
       break;
     }
     default:
@@ -91,6 +99,5 @@ int64_t CDVDInputStreamMemory::Seek(int64_t offset, int whence)
 
 int64_t CDVDInputStreamMemory::GetLength()
 {
-  return m_iDataSize;
+  return m_data ? static_cast<int64_t>(m_data->size()) : 0;
 }
-
@@ -10,6 +10,9 @@
 
 #include "DVDInputStream.h"
 
+#include <memory>
+#include <vector>
+
 class CDVDInputStreamMemory : public CDVDInputStream
 {
 public:
@@ -22,8 +25,13 @@ public:
   bool IsEOF() override;
   int64_t GetLength() override;
 
+  /*!
+   * \brief Serve the stream from a file that is already in memory, the stream keeps a reference
+   * to the data until it is closed.
+   */
+  void SetData(std::shared_ptr<const std::vector<uint8_t>> data);
+
 protected:
-  uint8_t* m_pData;
-  int   m_iDataSize;
-  int   m_iDataPos;
+  std::shared_ptr<const std::vector<uint8_t>> m_data;
+  int64_t m_iDataPos;
 };
@@ -8,14 +8,54 @@
 
 #include "InputStreamPVRChannel.h"
 
+#include "FileItem.h"
 #include "ServiceBroker.h"
+#include "TimeshiftBuffer.h"
+#include "cores/VideoPlayer/Interface/TimingConstants.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
 #include "pvr/PVRManager.h"
 #include "pvr/addons/PVRClient.h"
 #include "pvr/channels/PVRChannelGroupsContainer.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/SettingsComponent.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
 #include "utils/log.h"
 
+#include <mutex>
+
 using namespace PVR;
 
+namespace
+{
+const std::string TIMESHIFT_FILE_PREFIX = "pvrtimeshift-";
+
+std::once_flag staleTimeshiftFilesDeleted;
+
+// Buffers delete their file when they are closed, only a crash leaves files behind. Called before
+// the first buffer of the session creates its file, so no file of a running buffer is deleted.
+void DeleteStaleTimeshiftFiles(const std::string& path)
+{
+  CFileItemList items;
+  if (!XFILE::CDirectory::GetDirectory(path, items, ".ts",
+                                       XFILE::DIR_FLAG_NO_FILE_DIRS | XFILE::DIR_FLAG_BYPASS_CACHE))
+    return;
+
+  for (const auto& item : items)
+  {
+    if (!item->m_bIsFolder &&
+        StringUtils::StartsWith(URIUtils::GetFileName(item->GetPath()), TIMESHIFT_FILE_PREFIX))
+    {
+      CLog::Log(LOGDEBUG, "CInputStreamPVRChannel - {} - deleting stale timeshift file {}",
+                __FUNCTION__, item->GetPath());
+      XFILE::CFile::Delete(item->GetPath());
+    }
+  }
+}
+} // namespace
+
 CInputStreamPVRChannel::CInputStreamPVRChannel(IVideoPlayer* pPlayer, const CFileItem& fileitem)
   : CInputStreamPVRBase(pPlayer, fileitem),
     m_bDemuxActive(false)
@@ -35,6 +75,48 @@ CDVDInputStream::IDemux* CInputStreamPVRChannel::GetIDemux()
   return CInputStreamPVRBase::GetIDemux();
 }
 
+CDVDInputStream::IPosTime* CInputStreamPVRChannel::GetIPosTime()
+{
+  if (m_timeshift)
+    return this;
+
+  return CInputStreamPVRBase::GetIPosTime();
+}
+
+bool CInputStreamPVRChannel::PosTime(int ms)
+{
+  if (!m_timeshift)
+    return false;
+
+  m_timeshift->SeekTime(ms);
+  m_eof = false;
+  return true;
+}
+
+bool CInputStreamPVRChannel::GetTimes(Times& times)
+{
+  if (!m_timeshift)
+    return CInputStreamPVRBase::GetTimes(times);
+
+  // The demuxer starts the stream's pts at zero, the buffer its times at the first data received.
+  // Both advance in real time for live streams.
+  const CTimeshiftBuffer::Times bufferTimes = m_timeshift->GetTimes();
+  times.startTime = bufferTimes.startTime;
+  times.ptsStart = 0;
+  times.ptsBegin = DVD_MSEC_TO_TIME(bufferTimes.iBeginMs);
+  times.ptsEnd = DVD_MSEC_TO_TIME(bufferTimes.iEndMs);
+  return true;
+}
+
+bool CInputStreamPVRChannel::IsRealtime()
+{
+  // a paused stream is recorded on
+  if (m_timeshift)
+    return false;
+
+  return CInputStreamPVRBase::IsRealtime();
+}
+
 bool CInputStreamPVRChannel::OpenPVRStream()
 {
   std::shared_ptr<CPVRChannel> channel = m_item.GetPVRChannelInfoTag();
@@ -51,13 +133,48 @@ bool CInputStreamPVRChannel::OpenPVRStream()
     m_bDemuxActive = m_client->GetClientCapabilities().HandlesDemuxing();
     CLog::Log(LOGDEBUG, "CInputStreamPVRChannel - {} - opened channel stream {}", __FUNCTION__,
               m_item.GetPath());
+
+    if (!m_bDemuxActive)
+      StartTimeshift();
+
     return true;
   }
   return false;
 }
 
+void CInputStreamPVRChannel::StartTimeshift()
+{
+  const std::shared_ptr<CAdvancedSettings> settings =
+      CServiceBroker::GetSettingsComponent()->GetAdvancedSettings();
+  if (!settings->m_bPVRLocalTimeshift || CanPausePVRStream() || CanSeekPVRStream())
+    return;
+
+  // each buffer gets its own file, buffers of streams open at once must not share one
+  const std::string path = CSpecialProtocol::TranslatePath(settings->m_strPVRLocalTimeshiftPath);
+  XFILE::CDirectory::Create(path);
+  std::call_once(staleTimeshiftFilesDeleted, DeleteStaleTimeshiftFiles, path);
+  auto timeshift = std::make_unique<CTimeshiftBuffer>(
+      URIUtils::AddFileToFolder(path, TIMESHIFT_FILE_PREFIX + StringUtils::CreateUUID() + ".ts"),
+      static_cast<int64_t>(settings->m_iPVRLocalTimeshiftSizeMB) * 1024 * 1024,
+      [client = m_client](uint8_t* buf, int size) {
+        int ret = -1;
+        client->ReadLiveStream(buf, size, ret);
+        return ret;
+      });
+
+  if (timeshift->Start())
+  {
+    m_timeshift = std::move(timeshift);
+    CLog::Log(LOGDEBUG, "CInputStreamPVRChannel - {} - timeshifting channel stream {} locally",
+              __FUNCTION__, m_item.GetPath());
+  }
+}
+
 void CInputStreamPVRChannel::ClosePVRStream()
 {
+  // stop reading from the client before closing the stream
+  m_timeshift.reset();
+
   if (m_client && (m_client->CloseLiveStream() == PVR_ERROR_NO_ERROR))
   {
     m_bDemuxActive = false;
@@ -68,6 +185,9 @@ void CInputStreamPVRChannel::ClosePVRStream()
 
 int CInputStreamPVRChannel::ReadPVRStream(uint8_t* buf, int buf_size)
 {
+  if (m_timeshift)
+    return m_timeshift->Read(buf, buf_size);
+
   int ret = -1;
 
   if (m_client)
@@ -78,6 +198,9 @@ int CInputStreamPVRChannel::ReadPVRStream(uint8_t* buf, int buf_size)
 
 int64_t CInputStreamPVRChannel::SeekPVRStream(int64_t offset, int whence)
 {
+  if (m_timeshift)
+    return m_timeshift->Seek(offset, whence);
+
   int64_t ret = -1;
 
   if (m_client)
@@ -88,6 +211,10 @@ int64_t CInputStreamPVRChannel::SeekPVRStream(int64_t offset, int whence)
 
 int64_t CInputStreamPVRChannel::GetPVRStreamLength()
 {
+  // the recorded stream keeps growing
+  if (m_timeshift)
+    return -1;
+
   int64_t ret = -1;
 
   if (m_client)
@@ -106,6 +233,9 @@ CDVDInputStream::ENextStream CInputStreamPVRChannel::NextPVRStream()
 
 bool CInputStreamPVRChannel::CanPausePVRStream()
 {
+  if (m_timeshift)
+    return true;
+
   bool ret = false;
 
   if (m_client)
@@ -116,6 +246,9 @@ bool CInputStreamPVRChannel::CanPausePVRStream()
 
 bool CInputStreamPVRChannel::CanSeekPVRStream()
 {
+  if (m_timeshift)
+    return true;
+
   bool ret = false;
 
   if (m_client)
@@ -10,13 +10,21 @@
 
 #include "InputStreamPVRBase.h"
 
-class CInputStreamPVRChannel : public CInputStreamPVRBase
+#include <memory>
+
+class CTimeshiftBuffer;
+
+class CInputStreamPVRChannel : public CInputStreamPVRBase, public CDVDInputStream::IPosTime
 {
 public:
   CInputStreamPVRChannel(IVideoPlayer* pPlayer, const CFileItem& fileitem);
   ~CInputStreamPVRChannel() override;
 
   CDVDInputStream::IDemux* GetIDemux() override;
+  CDVDInputStream::IPosTime* GetIPosTime() override;
+  bool PosTime(int ms) override;
+  bool GetTimes(Times& times) override;
+  bool IsRealtime() override;
 
 protected:
   bool OpenPVRStream() override;
@@ -29,5 +37,8 @@ protected:
   bool CanSeekPVRStream() override;
 
 private:
+  void StartTimeshift();
+
   bool m_bDemuxActive;
+  std::unique_ptr<CTimeshiftBuffer> m_timeshift; //!< Records the stream if the client can't
 };
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "InputStreamPVRPrebuffered.h"
+
+#include "pvr/channels/PVRChannelPrebuffers.h"
+
+#include <utility>
+
+CInputStreamPVRPrebuffered::CInputStreamPVRPrebuffered(
+    const CFileItem& fileitem, std::shared_ptr<PVR::CPVRStreamPrebuffer> stream)
+  : CDVDInputStream(DVDSTREAM_TYPE_FILE, fileitem), m_stream(std::move(stream))
+{
+}
+
+CInputStreamPVRPrebuffered::~CInputStreamPVRPrebuffered()
+{
+  Close();
+}
+
+bool CInputStreamPVRPrebuffered::Open()
+{
+  if (!m_stream || !CDVDInputStream::Open())
+    return false;
+
+  m_eof = false;
+  return true;
+}
+
+void CInputStreamPVRPrebuffered::Close()
+{
+  // the stream is closed by its own thread, waited for when the last reference is gone
+  if (m_stream)
+    m_stream->Stop();
+
+  m_stream.reset();
+  CDVDInputStream::Close();
+  m_eof = true;
+}
+
+int CInputStreamPVRPrebuffered::Read(uint8_t* buf, int buf_size)
+{
+  if (!m_stream)
+    return -1;
+
+  const int ret = m_stream->Read(buf, buf_size);
+  if (ret == 0)
+    m_eof = true;
+
+  return ret;
+}
+
+int64_t CInputStreamPVRPrebuffered::Seek(int64_t offset, int whence)
+{
+  // live streams can not be seeked
+  if (whence == SEEK_POSSIBLE)
+    return 0;
+
+  return -1;
+}
+
+bool CInputStreamPVRPrebuffered::IsEOF()
+{
+  return !m_stream || m_eof;
+}
+
+int64_t CInputStreamPVRPrebuffered::GetLength()
+{
+  return -1;
+}
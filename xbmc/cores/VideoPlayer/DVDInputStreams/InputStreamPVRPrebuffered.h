@@ -0,0 +1,38 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "DVDInputStream.h"
+
+#include <memory>
+
+namespace PVR
+{
+class CPVRStreamPrebuffer;
+}
+
+//! Plays a channel stream the PVR manager opened ahead of time
+class CInputStreamPVRPrebuffered : public CDVDInputStream
+{
+public:
+  CInputStreamPVRPrebuffered(const CFileItem& fileitem,
+                             std::shared_ptr<PVR::CPVRStreamPrebuffer> stream);
+  ~CInputStreamPVRPrebuffered() override;
+  bool Open() override;
+  void Close() override;
+  int Read(uint8_t* buf, int buf_size) override;
+  int64_t Seek(int64_t offset, int whence) override;
+  bool IsEOF() override;
+  int64_t GetLength() override;
+  bool CanSeek() override { return false; }
+
+private:
+  std::shared_ptr<PVR::CPVRStreamPrebuffer> m_stream;
+  bool m_eof = true;
+};
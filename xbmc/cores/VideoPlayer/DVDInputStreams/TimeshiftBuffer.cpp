@@ -0,0 +1,254 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "TimeshiftBuffer.h"
+
+#include "URL.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+constexpr int64_t CHUNK_SIZE = 64 * 1024;
+} // unnamed namespace
+
+CTimeshiftBuffer::CTimeshiftBuffer(const std::string& path, int64_t iSize, LiveReader reader)
+  : CThread("TimeshiftBuffer"),
+    m_path(path),
+    m_iSize(std::max(iSize, 4 * CHUNK_SIZE)),
+    m_reader(std::move(reader))
+{
+}
+
+CTimeshiftBuffer::~CTimeshiftBuffer()
+{
+  Stop();
+}
+
+bool CTimeshiftBuffer::Start()
+{
+  if (!m_writeFile.OpenForWrite(m_path, true) ||
+      !m_readFile.Open(m_path, XFILE::READ_NO_CACHE))
+  {
+    CLog::LogF(LOGERROR, "Unable to create timeshift buffer {}", CURL::GetRedacted(m_path));
+    m_writeFile.Close();
+    XFILE::CFile::Delete(m_path);
+    return false;
+  }
+
+  m_start = std::chrono::steady_clock::now();
+  m_startTime = std::time(nullptr);
+  Create();
+  return true;
+}
+
+void CTimeshiftBuffer::Stop()
+{
+  if (!m_writeFile.GetImplementation())
+    return;
+
+  // wake up a reader waiting for data, then wait for the live stream read to return
+  StopThread(false);
+  m_condition.notifyAll();
+  StopThread(true);
+
+  CSingleLock lock(m_critSection);
+  m_readFile.Close();
+  m_writeFile.Close();
+  XFILE::CFile::Delete(m_path);
+}
+
+int CTimeshiftBuffer::Read(uint8_t* buf, int size)
+{
+  CSingleLock lock(m_critSection);
+  while (m_iReadPos >= m_iEnd)
+  {
+    if (m_bFailed)
+      return -1;
+
+    if (m_bEof || m_bStop)
+      return 0;
+
+    m_condition.wait(lock, 100ms);
+  }
+
+  // the writer only writes outside of the buffered range, read up to the end of the file at most
+  const int64_t iFilePos = m_iReadPos % m_iSize;
+  const int64_t iSize = std::min(
+      {static_cast<int64_t>(std::max(size, 0)), m_iEnd - m_iReadPos, m_iSize - iFilePos});
+  if (m_readFile.Seek(iFilePos, SEEK_SET) != iFilePos)
+    return -1;
+
+  const ssize_t iRead = m_readFile.Read(buf, static_cast<size_t>(iSize));
+  if (iRead <= 0)
+    return -1;
+
+  m_iReadPos += iRead;
+  return static_cast<int>(iRead);
+}
+
+int64_t CTimeshiftBuffer::Seek(int64_t offset, int whence)
+{
+  CSingleLock lock(m_critSection);
+
+  int64_t iPosition;
+  switch (whence)
+  {
+    case SEEK_SET:
+      iPosition = offset;
+      break;
+    case SEEK_CUR:
+      iPosition = m_iReadPos + offset;
+      break;
+    case SEEK_END:
+      iPosition = m_iEnd + offset;
+      break;
+    default:
+      return -1;
+  }
+
+  if (iPosition < m_iBegin || iPosition > m_iEnd)
+    return -1;
+
+  m_iReadPos = iPosition;
+  return m_iReadPos;
+}
+
+int64_t CTimeshiftBuffer::SeekTime(int64_t iTimeMs)
+{
+  CSingleLock lock(m_critSection);
+
+  const auto it = std::find_if(m_index.begin(), m_index.end(),
+                               [iTimeMs](const std::pair<int64_t, int64_t>& entry) {
+                                 return entry.second >= iTimeMs;
+                               });
+
+  // beyond the newest data is the live position
+  m_iReadPos = it == m_index.end() ? m_iEnd : std::max(it->first, m_iBegin);
+  return m_iReadPos;
+}
+
+CTimeshiftBuffer::Times CTimeshiftBuffer::GetTimes() const
+{
+  Times times;
+
+  CSingleLock lock(m_critSection);
+  times.startTime = m_startTime;
+  if (!m_index.empty())
+  {
+    times.iBeginMs = GetTimeAt(m_iBegin);
+    times.iEndMs = m_index.back().second;
+    times.iReadMs = GetTimeAt(m_iReadPos);
+  }
+  return times;
+}
+
+std::pair<int64_t, int64_t> CTimeshiftBuffer::GetRange() const
+{
+  CSingleLock lock(m_critSection);
+  return {m_iBegin, m_iEnd};
+}
+
+void CTimeshiftBuffer::Process()
+{
+  std::vector<uint8_t> chunk(CHUNK_SIZE);
+
+  while (!m_bStop)
+  {
+    const int iRead = m_reader(chunk.data(), static_cast<int>(chunk.size()));
+    if (iRead <= 0)
+    {
+      CSingleLock lock(m_critSection);
+      m_bEof = iRead == 0;
+      m_bFailed = iRead < 0;
+      break;
+    }
+
+    int64_t iPosition;
+    {
+      CSingleLock lock(m_critSection);
+      iPosition = m_iEnd;
+
+      // make room by dropping the oldest data before it gets overwritten
+      const int64_t iBegin = m_iEnd + iRead - m_iSize;
+      if (iBegin > m_iBegin)
+      {
+        m_iBegin = iBegin;
+        while (m_index.size() > 1 && m_index[1].first <= m_iBegin)
+          m_index.pop_front();
+
+        if (m_iReadPos < m_iBegin)
+        {
+          CLog::LogF(LOGDEBUG, "Paused longer than the buffer lasts, skipping {} bytes",
+                     m_iBegin - m_iReadPos);
+          m_iReadPos = m_iBegin;
+        }
+      }
+    }
+
+    if (!WriteToFile(iPosition, chunk.data(), iRead))
+    {
+      CLog::LogF(LOGERROR, "Unable to write to timeshift buffer {}", CURL::GetRedacted(m_path));
+      CSingleLock lock(m_critSection);
+      m_bFailed = true;
+      break;
+    }
+
+    {
+      CSingleLock lock(m_critSection);
+      m_index.emplace_back(iPosition, GetTimeMs());
+      m_iEnd += iRead;
+    }
+    m_condition.notifyAll();
+  }
+
+  m_condition.notifyAll();
+}
+
+int64_t CTimeshiftBuffer::GetTimeMs() const
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                               m_start)
+      .count();
+}
+
+int64_t CTimeshiftBuffer::GetTimeAt(int64_t iPosition) const
+{
+  // the time of the chunk containing the position
+  const auto it = std::upper_bound(m_index.begin(), m_index.end(), iPosition,
+                                   [](int64_t iPos, const std::pair<int64_t, int64_t>& entry) {
+                                     return iPos < entry.first;
+                                   });
+  if (it == m_index.begin())
+    return m_index.empty() ? 0 : m_index.front().second;
+
+  return std::prev(it)->second;
+}
+
+bool CTimeshiftBuffer::WriteToFile(int64_t iPosition, const uint8_t* data, size_t size)
+{
+  while (size > 0)
+  {
+    // wrap around at the end of the file
+    const int64_t iFilePos = iPosition % m_iSize;
+    const size_t iSize = std::min(size, static_cast<size_t>(m_iSize - iFilePos));
+    if (m_writeFile.Seek(iFilePos, SEEK_SET) != iFilePos ||
+        m_writeFile.Write(data, iSize) != static_cast<ssize_t>(iSize))
+      return false;
+
+    iPosition += iSize;
+    data += iSize;
+    size -= iSize;
+  }
+  return true;
+}
@@ -0,0 +1,129 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "filesystem/File.h"
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include <utility>
+
+/*!
+ * @brief Records a live stream into a ring file of fixed size on disk, so that it can be paused,
+ * rewound and seeked independently of its source.
+ *
+ * A thread keeps reading the live stream, whether the stream is played or not, and overwrites the
+ * oldest data once the file is full. Positions are byte offsets since the start of the live
+ * stream. The time each chunk arrived is indexed, times are milliseconds since the start of the
+ * live stream.
+ */
+class CTimeshiftBuffer : private CThread
+{
+public:
+  /*!
+   * @brief Reads the live stream, blocking until data is available. Returns the number of bytes
+   * read, 0 at the end of the stream, a negative number on error.
+   */
+  using LiveReader = std::function<int(uint8_t* buf, int size)>;
+
+  struct Times
+  {
+    time_t startTime = 0; //!< The wall clock time the live stream started
+    int64_t iBeginMs = 0; //!< The time of the oldest data still buffered
+    int64_t iEndMs = 0; //!< The time of the newest data
+    int64_t iReadMs = 0; //!< The time of the data at the read position
+  };
+
+  /*!
+   * @brief Create a buffer.
+   * @param path The path of the ring file.
+   * @param iSize The size of the ring file in bytes.
+   * @param reader The reader of the live stream.
+   */
+  CTimeshiftBuffer(const std::string& path, int64_t iSize, LiveReader reader);
+  ~CTimeshiftBuffer() override;
+
+  /*!
+   * @brief Create the ring file and start recording the live stream.
+   * @return True on success, false if the ring file could not be created.
+   */
+  bool Start();
+
+  /*!
+   * @brief Stop recording and delete the ring file.
+   */
+  void Stop();
+
+  /*!
+   * @brief Read from the read position, blocking until the live stream delivered data.
+   * @param buf The buffer to fill.
+   * @param size The size of the buffer.
+   * @return The number of bytes read, 0 at the end of the live stream, -1 on error.
+   */
+  int Read(uint8_t* buf, int size);
+
+  /*!
+   * @brief Move the read position.
+   * @param offset The offset.
+   * @param whence SEEK_SET, SEEK_CUR or SEEK_END.
+   * @return The new read position, or -1 if the position is not buffered.
+   */
+  int64_t Seek(int64_t offset, int whence);
+
+  /*!
+   * @brief Move the read position to the data that arrived at the given time, or as close as the
+   * buffered data allows.
+   * @param iTimeMs The time.
+   * @return The new read position.
+   */
+  int64_t SeekTime(int64_t iTimeMs);
+
+  /*!
+   * @brief Get the range of buffered times and the time at the read position.
+   * @return The times.
+   */
+  Times GetTimes() const;
+
+  /*!
+   * @brief Get the range of buffered positions.
+   * @return The first and the end position.
+   */
+  std::pair<int64_t, int64_t> GetRange() const;
+
+private:
+  void Process() override;
+  int64_t GetTimeMs() const;
+  int64_t GetTimeAt(int64_t iPosition) const;
+  bool WriteToFile(int64_t iPosition, const uint8_t* data, size_t size);
+
+  const std::string m_path;
+  const int64_t m_iSize;
+  const LiveReader m_reader;
+
+  XFILE::CFile m_writeFile;
+  XFILE::CFile m_readFile; //!< Guarded by m_critSection
+  std::chrono::steady_clock::time_point m_start;
+
+  mutable CCriticalSection m_critSection;
+  XbmcThreads::ConditionVariable m_condition;
+  time_t m_startTime = 0;
+  int64_t m_iBegin = 0; //!< The oldest buffered position
+  int64_t m_iEnd = 0; //!< The position the next data of the live stream is written to
+  int64_t m_iReadPos = 0;
+  std::deque<std::pair<int64_t, int64_t>> m_index; //!< Position and arrival time of each chunk
+  bool m_bEof = false;
+  bool m_bFailed = false;
+};
@@ -8,17 +8,10 @@
 
 #include "DVDSubtitleLineCollection.h"
 
-#include <stddef.h>
+#include <algorithm>
+#include <limits>
 
-
-CDVDSubtitleLineCollection::CDVDSubtitleLineCollection()
-{
-  m_pHead = NULL;
-  m_pCurrent = NULL;
-  m_pTail = NULL;
-
-  m_iSize = 0;
-}
+CDVDSubtitleLineCollection::CDVDSubtitleLineCollection() = default;
 
 CDVDSubtitleLineCollection::~CDVDSubtitleLineCollection()
 {
@@ -27,85 +20,86 @@ CDVDSubtitleLineCollection::~CDVDSubtitleLineCollection()
 
 void CDVDSubtitleLineCollection::Add(CDVDOverlay* pOverlay)
 {
-  ListElement* pElement = new ListElement;
-  pElement->pOverlay = pOverlay;
-  pElement->pNext = NULL;
-
-  if (!m_pHead)
-  {
-    m_pHead = m_pTail = pElement;
-    m_pCurrent = m_pHead;
-  }
-  else
-  {
-    m_pTail->pNext = pElement;
-    m_pTail = pElement;
-  }
-
-  m_iSize++;
+  m_overlays.push_back(pOverlay);
+  m_indexValid = false;
 }
 
 void CDVDSubtitleLineCollection::Sort()
 {
-  if (!m_pHead || !m_pHead->pNext)
-    return;
-
-  for (ListElement* p1 = m_pHead; p1->pNext != NULL; p1 = p1->pNext)
-  {
-    for (ListElement* p2 = p1->pNext; p2 != NULL; p2 = p2->pNext)
-    {
-      if (p1->pOverlay->iPTSStartTime > p2->pOverlay->iPTSStartTime)
-      {
-        CDVDOverlay* temp = p1->pOverlay;
-        p1->pOverlay = p2->pOverlay;
-        p2->pOverlay = temp;
-      }
-    }
-  }
+  std::stable_sort(m_overlays.begin(), m_overlays.end(),
+                   [](const CDVDOverlay* a, const CDVDOverlay* b) {
+                     return a->iPTSStartTime < b->iPTSStartTime;
+                   });
+  m_indexValid = false;
 }
 
-CDVDOverlay* CDVDSubtitleLineCollection::Get(double iPts)
+void CDVDSubtitleLineCollection::BuildIndex()
 {
-  CDVDOverlay* pOverlay = NULL;
-
-  if (m_pCurrent)
-  {
-    while (m_pCurrent && m_pCurrent->pOverlay->iPTSStopTime < iPts)
-    {
-      m_pCurrent = m_pCurrent->pNext;
-    }
-
-    if (m_pCurrent)
-    {
-      pOverlay = m_pCurrent->pOverlay;
-
-      // advance to the next overlay
-      m_pCurrent = m_pCurrent->pNext;
-    }
-  }
-  return pOverlay;
+  m_leaves = 1;
+  while (m_leaves < m_overlays.size())
+    m_leaves <<= 1;
+
+  m_maxStop.assign(2 * m_leaves, std::numeric_limits<double>::lowest());
+  for (size_t i = 0; i < m_overlays.size(); ++i)
+    m_maxStop[m_leaves + i] = m_overlays[i]->iPTSStopTime;
+  for (size_t i = m_leaves - 1; i > 0; --i)
+    m_maxStop[i] = std::max(m_maxStop[2 * i], m_maxStop[2 * i + 1]);
+
+  m_indexValid = true;
 }
 
-void CDVDSubtitleLineCollection::Reset()
+size_t CDVDSubtitleLineCollection::FindFirstNotEnded(size_t from, double iPts) const
 {
-  m_pCurrent = m_pHead;
+  if (from >= m_overlays.size())
+    return m_overlays.size();
+
+  return FindFirstNotEnded(1, 0, m_leaves, from, iPts);
 }
 
-void CDVDSubtitleLineCollection::Clear()
+size_t CDVDSubtitleLineCollection::FindFirstNotEnded(
+    size_t node, size_t nodeBegin, size_t nodeEnd, size_t from, double iPts) const
+{
+  // nothing in this subtree is at or after 'from' or has a stop time >= iPts
+  if (nodeEnd <= from || m_maxStop[node] < iPts)
+    return m_overlays.size();
+
+  if (nodeEnd - nodeBegin == 1)
+    return std::min(nodeBegin, m_overlays.size());
+
+  const size_t nodeMid = nodeBegin + (nodeEnd - nodeBegin) / 2;
+  const size_t left = FindFirstNotEnded(2 * node, nodeBegin, nodeMid, from, iPts);
+  if (left < m_overlays.size())
+    return left;
+
+  return FindFirstNotEnded(2 * node + 1, nodeMid, nodeEnd, from, iPts);
+}
+
+CDVDOverlay* CDVDSubtitleLineCollection::Get(double iPts)
 {
-  ListElement* pElement = NULL;
+  if (!m_indexValid)
+    BuildIndex();
+
+  m_current = FindFirstNotEnded(m_current, iPts);
+  if (m_current >= m_overlays.size())
+    return nullptr;
 
-  while (m_pHead)
-  {
-    pElement = m_pHead;
-    m_pHead = pElement->pNext;
+  // advance to the next overlay
+  return m_overlays[m_current++];
+}
 
-    pElement->pOverlay->Release();
-    delete pElement;
-  }
+void CDVDSubtitleLineCollection::Reset()
+{
+  m_current = 0;
+}
 
-  m_pTail    = NULL;
-  m_pHead    = NULL;
-  m_pCurrent = NULL;
-  m_iSize    = 0;
+void CDVDSubtitleLineCollection::Clear()
+{
+  for (CDVDOverlay* pOverlay : m_overlays)
+    pOverlay->Release();
+
+  m_overlays.clear();
+  m_maxStop.clear();
+  m_leaves = 0;
+  m_current = 0;
+  m_indexValid = false;
 }
@@ -10,39 +10,45 @@
 
 #include "../DVDCodecs/Overlay/DVDOverlay.h"
 
-typedef struct stListElement
-{
-  CDVDOverlay* pOverlay;
-  struct stListElement* pNext;
-
-} ListElement;
+#include <stddef.h>
+#include <vector>
 
+/*!
+ * \brief Time indexed store of the overlays of a text subtitle file.
+ *
+ * Overlays are kept in an array sorted by start time. A max-tree over the stop times is built
+ * lazily on the first lookup after a modification, so finding the next overlay that is still
+ * active at a given pts costs O(log n) instead of a linear walk, also after seeking.
+ */
 class CDVDSubtitleLineCollection
 {
 public:
   CDVDSubtitleLineCollection();
   virtual ~CDVDSubtitleLineCollection();
 
-  //void Lock()   { EnterCriticalSection(&m_critSection); }
-  //void Unlock() { LeaveCriticalSection(&m_critSection); }
-
   void Add(CDVDOverlay* pSubtitle);
   void Sort();
 
-  CDVDOverlay* Get(double iPts = 0LL); // get the first overlay in this fifo
+  /*!
+   * \brief Get the next overlay, starting at the current position, that has not ended before
+   * iPts and advance the current position past it.
+   */
+  CDVDOverlay* Get(double iPts = 0LL);
 
   void Reset();
 
-  void Remove();
   void Clear();
-  int GetSize() { return m_iSize; }
+  int GetSize() { return static_cast<int>(m_overlays.size()); }
 
 private:
-  ListElement* m_pHead;
-  ListElement* m_pCurrent;
-  ListElement* m_pTail;
-
-  int m_iSize;
-  //CRITICAL_SECTION m_critSection;
+  void BuildIndex();
+  size_t FindFirstNotEnded(size_t from, double iPts) const;
+  size_t FindFirstNotEnded(
+      size_t node, size_t nodeBegin, size_t nodeEnd, size_t from, double iPts) const;
+
+  std::vector<CDVDOverlay*> m_overlays; // sorted by start time after Sort()
+  std::vector<double> m_maxStop; // max-tree of stop times, root at index 1
+  size_t m_leaves = 0;
+  size_t m_current = 0;
+  bool m_indexValid = false;
 };
-
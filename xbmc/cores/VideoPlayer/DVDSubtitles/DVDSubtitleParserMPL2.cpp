@@ -62,6 +62,8 @@ bool CDVDSubtitleParserMPL2::Open(CDVDStreamInfo &hints)
     }
   }
 
+  m_collection.Sort();
+
   return true;
 }
 
@@ -69,6 +69,8 @@ bool CDVDSubtitleParserMicroDVD::Open(CDVDStreamInfo &hints)
     }
   }
 
+  m_collection.Sort();
+
   return true;
 }
 
@@ -80,6 +80,8 @@ bool CDVDSubtitleParserVplayer::Open(CDVDStreamInfo &hints)
       pPrevOverlay->iPTSStopTime = pPrevOverlay->iPTSStartTime + iDefaultDuration;
   }
 
+  m_collection.Sort();
+
   return true;
 }
 
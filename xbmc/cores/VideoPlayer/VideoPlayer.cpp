@@ -4875,6 +4875,19 @@ bool CVideoPlayer::RenderCaptureGetPixels(unsigned int captureId, unsigned int m
   return m_renderManager.RenderCaptureGetPixels(captureId, millis, buffer, size);
 }
 
+bool CVideoPlayer::GetFramePacing(FramePacingStats& stats,
+                                  std::vector<FramePacingEvent>& events,
+                                  unsigned int maxEvents)
+{
+  m_renderManager.GetFramePacing(stats, events, maxEvents);
+  return true;
+}
+
+void CVideoPlayer::ResetFramePacing()
+{
+  m_renderManager.ResetFramePacing();
+}
+
 void CVideoPlayer::VideoParamsChange()
 {
   m_messenger.Put(std::make_shared<CDVDMsg>(CDVDMsg::PLAYER_AVCHANGE));
@@ -326,6 +326,8 @@ public:
   void RenderCapture(unsigned int captureId, unsigned int width, unsigned int height, int flags) override;
   void RenderCaptureRelease(unsigned int captureId) override;
   bool RenderCaptureGetPixels(unsigned int captureId, unsigned int millis, uint8_t *buffer, unsigned int size) override;
+  bool GetFramePacing(FramePacingStats& stats, std::vector<FramePacingEvent>& events, unsigned int maxEvents) override;
+  void ResetFramePacing() override;
 
   // IDispResource interface
   void OnLostDisplay() override;
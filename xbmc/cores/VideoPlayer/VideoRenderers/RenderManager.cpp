@@ -227,6 +227,7 @@ bool CRenderManager::Configure()
     m_renderedOverlay = false;
     m_renderDebug = false;
     m_clockSync.Reset();
+    m_telemetry.Reset();
     m_dvdClock.SetVsyncAdjust(0);
     m_overlays.SetStereoMode(m_stereomode);
 
@@ -432,6 +433,9 @@ bool CRenderManager::Flush(bool wait, bool saveBuffers)
 
       if (!m_pRenderer->Flush(saveBuffers))
       {
+        for (int idx : m_queued)
+          m_telemetry.FrameDropped(m_Queue[idx].pts, m_Queue[idx].queueTime,
+                                   FrameDropReason::DISCARDED);
         m_queued.clear();
         m_discard.clear();
         m_free.clear();
@@ -766,6 +770,9 @@ void CRenderManager::Render(bool clear, DWORD flags, DWORD alpha, bool gui)
 
     if (m_presentstep == PRESENT_FRAME)
     {
+      m_telemetry.FramePresented(m.pts, m.queueTime, CRenderTelemetry::Now(),
+                                 CServiceBroker::GetWinSystem()->GetGfxContext().GetFPS(), m_fps);
+
       if (m.presentmethod == PRESENT_METHOD_BOB)
         m_presentstep = PRESENT_FRAME2;
       else
@@ -983,6 +990,7 @@ bool CRenderManager::AddVideoPicture(const VideoPicture& picture, volatile std::
   m.presentfield = displayField;
   m.presentmethod = presentmethod;
   m.pts = picture.pts;
+  m.queueTime = CRenderTelemetry::Now();
   m_queued.push_back(m_free.front());
   m_free.pop_front();
   m_playerPort->UpdateRenderBuffers(m_queued.size(), m_discard.size(), m_free.size());
@@ -1184,6 +1192,8 @@ void CRenderManager::PrepareNextRender()
         m_QueueSkip++;
       }
       m_presentsourcePast = m_queued.front();
+      m_telemetry.FrameDropped(m_Queue[m_presentsourcePast].pts,
+                               m_Queue[m_presentsourcePast].queueTime, FrameDropReason::LATE);
       m_queued.pop_front();
     }
 
@@ -1221,6 +1231,9 @@ void CRenderManager::DiscardBuffer()
 
   while(!m_queued.empty())
   {
+    const int idx = m_queued.front();
+    m_telemetry.FrameDropped(m_Queue[idx].pts, m_Queue[idx].queueTime,
+                             FrameDropReason::DISCARDED);
     m_discard.push_back(m_queued.front());
     m_queued.pop_front();
   }
@@ -1230,6 +1243,19 @@ void CRenderManager::DiscardBuffer()
   m_presentevent.notifyAll();
 }
 
+void CRenderManager::GetFramePacing(FramePacingStats& stats,
+                                    std::vector<FramePacingEvent>& events,
+                                    unsigned int maxEvents)
+{
+  m_telemetry.GetStats(stats);
+  m_telemetry.GetEvents(events, maxEvents);
+}
+
+void CRenderManager::ResetFramePacing()
+{
+  m_telemetry.Reset();
+}
+
 bool CRenderManager::GetStats(int &lateframes, double &pts, int &queued, int &discard)
 {
   CSingleLock lock(m_presentlock);
@@ -10,6 +10,7 @@
 
 #include "DVDClock.h"
 #include "DebugRenderer.h"
+#include "RenderTelemetry.h"
 #include "cores/VideoPlayer/VideoRenderers/BaseRenderer.h"
 #include "cores/VideoPlayer/VideoRenderers/OverlayRenderer.h"
 #include "cores/VideoSettings.h"
@@ -115,6 +116,14 @@ public:
 
   void SetVideoSettings(CVideoSettings settings);
 
+  /**
+   * Frame pacing telemetry, can be called from any thread
+   */
+  void GetFramePacing(FramePacingStats& stats,
+                      std::vector<FramePacingEvent>& events,
+                      unsigned int maxEvents);
+  void ResetFramePacing();
+
 protected:
 
   void PresentSingle(bool clear, DWORD flags, DWORD alpha);
@@ -181,12 +190,14 @@ protected:
 
   int m_QueueSize = 2;
   int m_QueueSkip = 0;
+  CRenderTelemetry m_telemetry;
 
   struct SPresent
   {
     double         pts;
     EFIELDSYNC     presentfield;
     EPRESENTMETHOD presentmethod;
+    int64_t        queueTime;
   } m_Queue[NUM_BUFFERS];
 
   std::deque<int> m_free;
@@ -0,0 +1,186 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "RenderTelemetry.h"
+
+#include "utils/StringUtils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+CRenderTelemetry::CRenderTelemetry()
+{
+  for (auto& bucket : m_refreshHistogram)
+    bucket = 0;
+  for (auto& bucket : m_judderHistogram)
+    bucket = 0;
+}
+
+int64_t CRenderTelemetry::Now()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void CRenderTelemetry::FramePresented(
+    double pts, int64_t queueTime, int64_t presentTime, float refreshRate, float frameRate)
+{
+  const uint64_t resetRequest = m_resetRequest.load(std::memory_order_acquire);
+  if (resetRequest != m_resetGeneration)
+  {
+    m_resetGeneration = resetRequest;
+    m_lastPresentTime = 0;
+  }
+
+  m_refreshRate.store(refreshRate, std::memory_order_relaxed);
+  m_frameRate.store(frameRate, std::memory_order_relaxed);
+
+  FramePacingEvent event;
+  event.pts = pts;
+  event.queueTime = queueTime;
+  event.presentTime = presentTime;
+
+  if (m_lastPresentTime > 0 && refreshRate > 0.0f)
+  {
+    const double interval = static_cast<double>(presentTime - m_lastPresentTime);
+    const double refreshPeriod = 1000000.0 / static_cast<double>(refreshRate);
+    event.refreshDelta = interval / refreshPeriod;
+
+    const int periods = std::min(static_cast<int>(std::lround(event.refreshDelta)),
+                                 FramePacingStats::REFRESH_BUCKETS - 1);
+    m_refreshHistogram[periods].fetch_add(1, std::memory_order_relaxed);
+
+    if (frameRate > 0.0f)
+    {
+      const double framePeriod = 1000000.0 / static_cast<double>(frameRate);
+      const double judderMs = std::abs(interval - framePeriod) / 1000.0;
+      int bucket = 0;
+      while (bucket < FramePacingStats::JUDDER_BUCKETS - 1 &&
+             judderMs >= FramePacingStats::JudderBucketLimit(bucket))
+        bucket++;
+      m_judderHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  m_lastPresentTime = presentTime;
+
+  m_presented.fetch_add(1, std::memory_order_relaxed);
+  Push(event);
+}
+
+void CRenderTelemetry::FrameDropped(double pts, int64_t queueTime, FrameDropReason reason)
+{
+  FramePacingEvent event;
+  event.pts = pts;
+  event.queueTime = queueTime;
+  event.dropReason = reason;
+
+  if (reason == FrameDropReason::LATE)
+    m_late.fetch_add(1, std::memory_order_relaxed);
+  else
+    m_discarded.fetch_add(1, std::memory_order_relaxed);
+
+  Push(event);
+}
+
+void CRenderTelemetry::Push(const FramePacingEvent& event)
+{
+  const uint64_t pos = m_writePos.load(std::memory_order_relaxed);
+  Slot& slot = m_ring[pos % CAPACITY];
+
+  slot.sequence.store(2 * pos + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.event = event;
+  slot.sequence.store(2 * pos + 2, std::memory_order_release);
+
+  m_writePos.store(pos + 1, std::memory_order_release);
+}
+
+void CRenderTelemetry::Reset()
+{
+  m_readStart.store(m_writePos.load(std::memory_order_acquire), std::memory_order_release);
+
+  m_presented = 0;
+  m_late = 0;
+  m_discarded = 0;
+  for (auto& bucket : m_refreshHistogram)
+    bucket = 0;
+  for (auto& bucket : m_judderHistogram)
+    bucket = 0;
+
+  // the writer drops its interval reference on the next present
+  m_resetRequest.fetch_add(1, std::memory_order_release);
+}
+
+void CRenderTelemetry::GetStats(FramePacingStats& stats) const
+{
+  stats.refreshRate = m_refreshRate.load(std::memory_order_relaxed);
+  stats.frameRate = m_frameRate.load(std::memory_order_relaxed);
+  stats.presented = m_presented.load(std::memory_order_relaxed);
+  stats.late = m_late.load(std::memory_order_relaxed);
+  stats.discarded = m_discarded.load(std::memory_order_relaxed);
+  for (int i = 0; i < FramePacingStats::REFRESH_BUCKETS; i++)
+    stats.refreshHistogram[i] = m_refreshHistogram[i].load(std::memory_order_relaxed);
+  for (int i = 0; i < FramePacingStats::JUDDER_BUCKETS; i++)
+    stats.judderHistogram[i] = m_judderHistogram[i].load(std::memory_order_relaxed);
+}
+
+void CRenderTelemetry::GetEvents(std::vector<FramePacingEvent>& events, size_t maxEvents) const
+{
+  events.clear();
+
+  const uint64_t end = m_writePos.load(std::memory_order_acquire);
+  uint64_t start = std::max(m_readStart.load(std::memory_order_acquire),
+                            end > CAPACITY ? end - CAPACITY : 0);
+  if (maxEvents > 0 && end - start > maxEvents)
+    start = end - maxEvents;
+
+  events.reserve(end - start);
+  for (uint64_t pos = start; pos < end; pos++)
+  {
+    const Slot& slot = m_ring[pos % CAPACITY];
+
+    // skip slots the writer has overwritten or is overwriting while we copy
+    if (slot.sequence.load(std::memory_order_acquire) != 2 * pos + 2)
+      continue;
+    const FramePacingEvent event = slot.event;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != 2 * pos + 2)
+      continue;
+
+    events.push_back(event);
+  }
+}
+
+std::string CRenderTelemetry::ToCSV(const std::vector<FramePacingEvent>& events)
+{
+  std::string csv = "pts,queuetime,presenttime,refreshdelta,dropreason\n";
+  for (const auto& event : events)
+  {
+    csv += StringUtils::Format("{:.0f},{},{},{:.3f},{}\n", event.pts, event.queueTime,
+                               event.presentTime, event.refreshDelta,
+                               DropReasonToString(event.dropReason));
+  }
+  return csv;
+}
+
+const char* CRenderTelemetry::DropReasonToString(FrameDropReason reason)
+{
+  switch (reason)
+  {
+    case FrameDropReason::NONE:
+      return "none";
+    case FrameDropReason::LATE:
+      return "late";
+    case FrameDropReason::DISCARDED:
+      return "discarded";
+    default:
+      return "unknown";
+  }
+}
@@ -0,0 +1,91 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "cores/FramePacing.h"
+
+#include <array>
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Per-frame pacing telemetry of CRenderManager.
+ *
+ * Events are kept in a fixed size ring that readers copy without taking a lock, so the JSON-RPC
+ * thread never blocks the render thread. Writers must be serialized by the caller, the render
+ * manager records all events while holding its present lock.
+ */
+class CRenderTelemetry
+{
+public:
+  static constexpr size_t CAPACITY = 4096;
+
+  CRenderTelemetry();
+
+  /*!
+   * \brief Microseconds of the clock used for all event times.
+   */
+  static int64_t Now();
+
+  /*!
+   * \brief Record a frame that has been rendered.
+   * \param refreshRate The display refresh rate at the time of the present.
+   * \param frameRate The frame rate of the video.
+   */
+  void FramePresented(
+      double pts, int64_t queueTime, int64_t presentTime, float refreshRate, float frameRate);
+
+  void FrameDropped(double pts, int64_t queueTime, FrameDropReason reason);
+
+  /*!
+   * \brief Forget all events and counters, e.g. after a refresh rate switch.
+   */
+  void Reset();
+
+  void GetStats(FramePacingStats& stats) const;
+
+  /*!
+   * \brief Copy the most recent events, oldest first.
+   * \param maxEvents Limit of events to return, 0 for all events in the ring.
+   */
+  void GetEvents(std::vector<FramePacingEvent>& events, size_t maxEvents = 0) const;
+
+  static std::string ToCSV(const std::vector<FramePacingEvent>& events);
+  static const char* DropReasonToString(FrameDropReason reason);
+
+private:
+  struct Slot
+  {
+    //! 2 * position + 1 while being written, 2 * position + 2 once complete
+    std::atomic<uint64_t> sequence{0};
+    FramePacingEvent event;
+  };
+
+  void Push(const FramePacingEvent& event);
+
+  std::array<Slot, CAPACITY> m_ring;
+  std::atomic<uint64_t> m_writePos{0};
+  std::atomic<uint64_t> m_readStart{0};
+
+  // only touched by the writer
+  int64_t m_lastPresentTime = 0;
+  uint64_t m_resetGeneration = 0;
+  std::atomic<uint64_t> m_resetRequest{0};
+
+  std::atomic<float> m_refreshRate{0.0f};
+  std::atomic<float> m_frameRate{0.0f};
+  std::atomic<uint64_t> m_presented{0};
+  std::atomic<uint64_t> m_late{0};
+  std::atomic<uint64_t> m_discarded{0};
+  std::array<std::atomic<uint64_t>, FramePacingStats::REFRESH_BUCKETS> m_refreshHistogram;
+  std::array<std::atomic<uint64_t>, FramePacingStats::JUDDER_BUCKETS> m_judderHistogram;
+};
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/VideoPlayer/DVDBatchThumbExtractor.h"
+#include "test/TestUtils.h"
+#include "utils/StringUtils.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(TestDVDBatchThumbExtractor, NoRequests)
+{
+  ThumbExtractFile file;
+  file.item = CFileItem(XBMC_REF_FILE_PATH("xbmc/cores/VideoPlayer/test/doesnotexist.mkv"), false);
+
+  EXPECT_EQ(0u, CDVDBatchThumbExtractor::Extract(file));
+}
+
+TEST(TestDVDBatchThumbExtractor, MissingFile)
+{
+  ThumbExtractFile file;
+  file.item = CFileItem(XBMC_REF_FILE_PATH("xbmc/cores/VideoPlayer/test/doesnotexist.mkv"), false);
+  file.requests.resize(2);
+
+  EXPECT_EQ(0u, CDVDBatchThumbExtractor::Extract(file));
+  EXPECT_FALSE(file.requests[0].extracted);
+  EXPECT_FALSE(file.requests[1].extracted);
+}
+
+/* Extracts ten images from every file given with --add-benchmark-file(s). Disabled as it
+ * needs real media, run it with --gtest_also_run_disabled_tests.
+ */
+TEST(TestDVDBatchThumbExtractor, DISABLED_Benchmark)
+{
+  const std::vector<std::string>& paths = CXBMCTestUtils::Instance().getBenchmarkFiles();
+  ASSERT_FALSE(paths.empty()) << "no file given with --add-benchmark-file(s)";
+
+  unsigned int extracted = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t f = 0; f < paths.size(); ++f)
+  {
+    ThumbExtractFile file;
+    file.item = CFileItem(paths[f], false);
+    for (int i = 0; i < 10; ++i)
+    {
+      ThumbExtractRequest request;
+      request.pos = i * 10000;
+      request.details.file = StringUtils::Format("benchmark/{}-{}.jpg", f, i);
+      file.requests.push_back(request);
+    }
+    extracted += CDVDBatchThumbExtractor::Extract(file);
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  RecordProperty("images", static_cast<int>(extracted));
+  RecordProperty("images_per_second",
+                 static_cast<int>(elapsed.count() > 0.0 ? extracted / elapsed.count() : 0.0));
+}
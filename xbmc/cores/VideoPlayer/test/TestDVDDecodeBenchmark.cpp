@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/VideoPlayer/DVDDecodeBenchmark.h"
+#include "test/TestUtils.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(TestDVDDecodeBenchmark, MissingFile)
+{
+  CDVDDecodeBenchmark benchmark;
+  DecodeBenchmarkResult result;
+
+  EXPECT_FALSE(benchmark.Run(XBMC_REF_FILE_PATH("xbmc/cores/VideoPlayer/test/doesnotexist.mkv"),
+                             result));
+  EXPECT_EQ(0u, result.videoFrames);
+}
+
+/* The fixture clips are not shipped with the source tree, they must be given to the test suite
+ * with --add-benchmark-file(s). Run with --gtest_also_run_disabled_tests, the results are
+ * reported as test properties.
+ */
+TEST(TestDVDDecodeBenchmark, DISABLED_Decode)
+{
+  const std::vector<std::string>& files = CXBMCTestUtils::Instance().getBenchmarkFiles();
+  ASSERT_FALSE(files.empty()) << "no file given with --add-benchmark-file(s)";
+
+  for (size_t i = 0; i < files.size(); ++i)
+  {
+    CDVDDecodeBenchmark benchmark;
+    DecodeBenchmarkResult result;
+
+    ASSERT_TRUE(benchmark.Run(files[i], result)) << files[i];
+
+    const std::string suffix = "_" + std::to_string(i);
+    RecordProperty("file" + suffix, files[i]);
+    RecordProperty("decode_fps" + suffix, static_cast<int>(result.decodeFps));
+    RecordProperty("latency_p50_us" + suffix, static_cast<int>(result.latencyP50 * 1000));
+    RecordProperty("latency_p99_us" + suffix, static_cast<int>(result.latencyP99 * 1000));
+    RecordProperty("dropped_frames" + suffix, static_cast<int>(result.droppedFrames));
+
+    EXPECT_GT(result.packets, 0u);
+    EXPECT_GT(result.decodeFps, 0.0);
+    EXPECT_LE(result.latencyP50, result.latencyP99);
+    EXPECT_EQ(0u, result.decoderErrors);
+  }
+}
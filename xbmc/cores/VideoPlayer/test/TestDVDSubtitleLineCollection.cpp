@@ -0,0 +1,126 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/VideoPlayer/DVDSubtitles/DVDSubtitleLineCollection.h"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+CDVDOverlay* CreateOverlay(double start, double stop)
+{
+  CDVDOverlay* overlay = new CDVDOverlay(DVDOVERLAY_TYPE_TEXT);
+  overlay->iPTSStartTime = start;
+  overlay->iPTSStopTime = stop;
+  return overlay;
+}
+
+// karaoke-like track: short lines every 100ms plus a long commentary line every 10s
+void FillLargeTrack(CDVDSubtitleLineCollection& collection, int events)
+{
+  for (int i = 0; i < events; ++i)
+  {
+    if (i % 100 == 0)
+      collection.Add(CreateOverlay(i * 100.0, i * 100.0 + 30000.0));
+    else
+      collection.Add(CreateOverlay(i * 100.0, i * 100.0 + 150.0));
+  }
+  collection.Sort();
+}
+} // namespace
+
+TEST(TestDVDSubtitleLineCollection, Sort)
+{
+  CDVDSubtitleLineCollection collection;
+  collection.Add(CreateOverlay(300, 400));
+  collection.Add(CreateOverlay(100, 200));
+  collection.Add(CreateOverlay(200, 300));
+  collection.Sort();
+
+  EXPECT_EQ(3, collection.GetSize());
+  EXPECT_EQ(100, collection.Get(0)->iPTSStartTime);
+  EXPECT_EQ(200, collection.Get(0)->iPTSStartTime);
+  EXPECT_EQ(300, collection.Get(0)->iPTSStartTime);
+  EXPECT_EQ(nullptr, collection.Get(0));
+}
+
+TEST(TestDVDSubtitleLineCollection, GetSkipsEnded)
+{
+  CDVDSubtitleLineCollection collection;
+  collection.Add(CreateOverlay(0, 100));
+  collection.Add(CreateOverlay(50, 1000));
+  collection.Add(CreateOverlay(200, 300));
+  collection.Add(CreateOverlay(400, 500));
+  collection.Sort();
+
+  // the long overlay is still active, so it is returned first
+  CDVDOverlay* overlay = collection.Get(250);
+  ASSERT_NE(nullptr, overlay);
+  EXPECT_EQ(50, overlay->iPTSStartTime);
+
+  overlay = collection.Get(250);
+  ASSERT_NE(nullptr, overlay);
+  EXPECT_EQ(200, overlay->iPTSStartTime);
+
+  overlay = collection.Get(450);
+  ASSERT_NE(nullptr, overlay);
+  EXPECT_EQ(400, overlay->iPTSStartTime);
+  EXPECT_EQ(nullptr, collection.Get(450));
+
+  // seeking back
+  collection.Reset();
+  overlay = collection.Get(0);
+  ASSERT_NE(nullptr, overlay);
+  EXPECT_EQ(0, overlay->iPTSStartTime);
+}
+
+TEST(TestDVDSubtitleLineCollection, AddAfterGet)
+{
+  CDVDSubtitleLineCollection collection;
+  collection.Add(CreateOverlay(0, 100));
+  EXPECT_NE(nullptr, collection.Get(0));
+  EXPECT_EQ(nullptr, collection.Get(0));
+
+  collection.Add(CreateOverlay(200, 300));
+  CDVDOverlay* overlay = collection.Get(0);
+  ASSERT_NE(nullptr, overlay);
+  EXPECT_EQ(200, overlay->iPTSStartTime);
+}
+
+/* Disabled as it only measures, run it with --gtest_also_run_disabled_tests. */
+TEST(TestDVDSubtitleLineCollection, DISABLED_SeekBenchmark)
+{
+  const int events = 100000;
+  const int seeks = 10000;
+
+  CDVDSubtitleLineCollection collection;
+  auto start = std::chrono::steady_clock::now();
+  FillLargeTrack(collection, events);
+  const std::chrono::duration<double, std::milli> fillTime =
+      std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  unsigned int found = 0;
+  for (int i = 0; i < seeks; ++i)
+  {
+    // pseudo random seek positions over the whole track, like a user skipping around
+    const double pts = static_cast<double>((i * 7919) % events) * 100.0 + 50.0;
+    collection.Reset();
+    if (collection.Get(pts))
+      found++;
+  }
+  const std::chrono::duration<double, std::milli> seekTime =
+      std::chrono::steady_clock::now() - start;
+
+  RecordProperty("fill_us", static_cast<int>(fillTime.count() * 1000.0));
+  RecordProperty("seek_us", static_cast<int>(seekTime.count() * 1000.0));
+
+  EXPECT_EQ(static_cast<unsigned int>(seeks), found);
+}
@@ -0,0 +1,147 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/VideoPlayer/VideoRenderers/RenderTelemetry.h"
+
+#include <atomic>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+// 24 fps content on a 60 Hz display in microseconds
+constexpr int64_t REFRESH_PERIOD = 16667;
+} // namespace
+
+TEST(TestRenderTelemetry, Pulldown)
+{
+  CRenderTelemetry telemetry;
+
+  // 3:2 pulldown, frames alternate between three and two refresh periods
+  int64_t time = 1000000;
+  for (int i = 0; i < 10; i++)
+  {
+    telemetry.FramePresented(i * 41708.0, time - 20000, time, 60.0f, 24.0f);
+    time += (i % 2 == 0 ? 3 : 2) * REFRESH_PERIOD;
+  }
+
+  FramePacingStats stats;
+  telemetry.GetStats(stats);
+  EXPECT_EQ(10u, stats.presented);
+  EXPECT_FLOAT_EQ(60.0f, stats.refreshRate);
+  EXPECT_FLOAT_EQ(24.0f, stats.frameRate);
+
+  // the first present has no interval
+  EXPECT_EQ(5u, stats.refreshHistogram[3]);
+  EXPECT_EQ(4u, stats.refreshHistogram[2]);
+
+  // 50 ms and 33.3 ms against 41.7 ms are both off by 8.3 ms
+  EXPECT_EQ(9u, stats.judderHistogram[4]);
+
+  std::vector<FramePacingEvent> events;
+  telemetry.GetEvents(events);
+  ASSERT_EQ(10u, events.size());
+  EXPECT_DOUBLE_EQ(0.0, events[0].refreshDelta);
+  EXPECT_NEAR(3.0, events[1].refreshDelta, 0.01);
+  EXPECT_NEAR(2.0, events[2].refreshDelta, 0.01);
+  EXPECT_EQ(FrameDropReason::NONE, events[9].dropReason);
+}
+
+TEST(TestRenderTelemetry, Drops)
+{
+  CRenderTelemetry telemetry;
+  telemetry.FramePresented(0.0, 1, 2, 50.0f, 50.0f);
+  telemetry.FrameDropped(20000.0, 3, FrameDropReason::LATE);
+  telemetry.FrameDropped(40000.0, 4, FrameDropReason::DISCARDED);
+
+  FramePacingStats stats;
+  telemetry.GetStats(stats);
+  EXPECT_EQ(1u, stats.presented);
+  EXPECT_EQ(1u, stats.late);
+  EXPECT_EQ(1u, stats.discarded);
+
+  std::vector<FramePacingEvent> events;
+  telemetry.GetEvents(events);
+  ASSERT_EQ(3u, events.size());
+  EXPECT_EQ(FrameDropReason::LATE, events[1].dropReason);
+  EXPECT_EQ(0, events[1].presentTime);
+
+  EXPECT_EQ("pts,queuetime,presenttime,refreshdelta,dropreason\n"
+            "0,1,2,0.000,none\n"
+            "20000,3,0,0.000,late\n"
+            "40000,4,0,0.000,discarded\n",
+            CRenderTelemetry::ToCSV(events));
+}
+
+TEST(TestRenderTelemetry, RingWrap)
+{
+  CRenderTelemetry telemetry;
+  const size_t total = CRenderTelemetry::CAPACITY + 100;
+  for (size_t i = 0; i < total; i++)
+    telemetry.FrameDropped(static_cast<double>(i), 0, FrameDropReason::LATE);
+
+  std::vector<FramePacingEvent> events;
+  telemetry.GetEvents(events);
+  ASSERT_EQ(CRenderTelemetry::CAPACITY, events.size());
+  EXPECT_DOUBLE_EQ(100.0, events.front().pts);
+  EXPECT_DOUBLE_EQ(static_cast<double>(total - 1), events.back().pts);
+
+  telemetry.GetEvents(events, 10);
+  ASSERT_EQ(10u, events.size());
+  EXPECT_DOUBLE_EQ(static_cast<double>(total - 10), events.front().pts);
+}
+
+TEST(TestRenderTelemetry, Reset)
+{
+  CRenderTelemetry telemetry;
+  telemetry.FramePresented(0.0, 0, 1000000, 60.0f, 60.0f);
+  telemetry.Reset();
+
+  // the interval to the present before the reset must not be counted
+  telemetry.FramePresented(16667.0, 0, 5000000, 60.0f, 60.0f);
+
+  FramePacingStats stats;
+  telemetry.GetStats(stats);
+  EXPECT_EQ(1u, stats.presented);
+  for (uint64_t count : stats.refreshHistogram)
+    EXPECT_EQ(0u, count);
+
+  std::vector<FramePacingEvent> events;
+  telemetry.GetEvents(events);
+  ASSERT_EQ(1u, events.size());
+  EXPECT_DOUBLE_EQ(16667.0, events[0].pts);
+}
+
+TEST(TestRenderTelemetry, ConcurrentReader)
+{
+  CRenderTelemetry telemetry;
+  std::atomic<bool> done{false};
+
+  std::thread writer([&]() {
+    for (int i = 0; i < 200000; i++)
+      telemetry.FramePresented(static_cast<double>(i), i, i, 60.0f, 60.0f);
+    done = true;
+  });
+
+  // every event a reader gets must be consistent and in order
+  std::vector<FramePacingEvent> events;
+  while (!done)
+  {
+    telemetry.GetEvents(events);
+    for (size_t i = 0; i < events.size(); i++)
+    {
+      ASSERT_EQ(static_cast<int64_t>(events[i].pts), events[i].queueTime);
+      if (i > 0)
+      {
+        ASSERT_LT(events[i - 1].pts, events[i].pts);
+      }
+    }
+  }
+  writer.join();
+}
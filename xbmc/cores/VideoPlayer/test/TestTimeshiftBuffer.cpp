@@ -0,0 +1,190 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/VideoPlayer/DVDInputStreams/TimeshiftBuffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+constexpr int CHUNK_SIZE = 64 * 1024;
+
+//! Stand-in for the live stream of a client that can't timeshift. Delivers chunks at a fixed
+//! rate, each 8 bytes of the stream hold their own offset.
+class CStandInLiveStream
+{
+public:
+  CStandInLiveStream(unsigned int iBytesPerSecond, uint64_t iLength = UINT64_MAX)
+    : m_iBytesPerSecond(iBytesPerSecond), m_iLength(iLength)
+  {
+  }
+
+  int Read(uint8_t* buf, int size)
+  {
+    if (m_iDelivered >= m_iLength)
+      return 0;
+
+    const auto due = m_start + std::chrono::milliseconds((m_iDelivered + CHUNK_SIZE) * 1000 /
+                                                         m_iBytesPerSecond);
+    std::this_thread::sleep_until(due);
+
+    const int iSize =
+        static_cast<int>(std::min<uint64_t>({static_cast<uint64_t>(size),
+                                             static_cast<uint64_t>(CHUNK_SIZE),
+                                             m_iLength - m_iDelivered}));
+    for (int i = 0; i < iSize; i += 8)
+    {
+      const uint64_t iOffset = m_iDelivered + i;
+      std::memcpy(buf + i, &iOffset, std::min(8, iSize - i));
+    }
+    m_iDelivered += iSize;
+    ++m_iReads;
+    return iSize;
+  }
+
+  CTimeshiftBuffer::LiveReader Reader()
+  {
+    return [this](uint8_t* buf, int size) { return Read(buf, size); };
+  }
+
+  std::atomic<int> m_iReads{0};
+
+private:
+  const unsigned int m_iBytesPerSecond;
+  const uint64_t m_iLength;
+  const std::chrono::steady_clock::time_point m_start = std::chrono::steady_clock::now();
+  uint64_t m_iDelivered = 0;
+};
+
+//! Read a chunk and check that it is the stream's data at the expected offset
+void ReadAt(CTimeshiftBuffer& buffer, uint64_t iOffset, int iSize = CHUNK_SIZE)
+{
+  std::vector<uint8_t> buf(iSize);
+  int iRead = 0;
+  while (iRead < iSize)
+  {
+    const int iResult = buffer.Read(buf.data() + iRead, iSize - iRead);
+    ASSERT_GT(iResult, 0);
+    iRead += iResult;
+  }
+
+  for (int i = 0; i < iSize; i += 8)
+  {
+    uint64_t iData;
+    std::memcpy(&iData, buf.data() + i, 8);
+    ASSERT_EQ(iData, iOffset + i);
+  }
+}
+
+std::string GetBufferPath()
+{
+  return testing::TempDir() + "timeshift.ts";
+}
+} // namespace
+
+TEST(TestTimeshiftBuffer, PauseKeepsRecording)
+{
+  CStandInLiveStream live(2 * 1024 * 1024);
+  CTimeshiftBuffer buffer(GetBufferPath(), 16 * 1024 * 1024, live.Reader());
+  ASSERT_TRUE(buffer.Start());
+
+  ReadAt(buffer, 0);
+
+  // while paused, the live stream is read on
+  for (int i = 0; i < 500 && buffer.GetRange().second < 8 * CHUNK_SIZE; ++i)
+    std::this_thread::sleep_for(10ms);
+  EXPECT_GE(buffer.GetRange().second, 8 * CHUNK_SIZE);
+
+  // and playback resumes where it was paused
+  ReadAt(buffer, CHUNK_SIZE);
+  ReadAt(buffer, 2 * CHUNK_SIZE, 1000);
+  EXPECT_EQ(buffer.GetRange().first, 0);
+}
+
+TEST(TestTimeshiftBuffer, OverwritesOldest)
+{
+  constexpr int64_t iSize = 4 * CHUNK_SIZE;
+  constexpr int64_t iLength = 3 * iSize + 2 * CHUNK_SIZE;
+  CStandInLiveStream live(4 * 1024 * 1024, iLength);
+  CTimeshiftBuffer buffer(GetBufferPath(), iSize, live.Reader());
+  ASSERT_TRUE(buffer.Start());
+
+  while (buffer.GetRange().second < iLength)
+    std::this_thread::sleep_for(10ms);
+
+  const std::pair<int64_t, int64_t> range = buffer.GetRange();
+  EXPECT_EQ(range.first, iLength - iSize);
+
+  // a position overwritten is not buffered anymore
+  EXPECT_EQ(buffer.Seek(0, SEEK_SET), -1);
+  EXPECT_EQ(buffer.Seek(range.first - 1, SEEK_SET), -1);
+
+  // the read position moved along with the oldest data, the data is intact across the wrap
+  ReadAt(buffer, range.first, iSize);
+
+  uint8_t buf[16];
+  EXPECT_EQ(buffer.Read(buf, sizeof(buf)), 0);
+}
+
+TEST(TestTimeshiftBuffer, SeekTime)
+{
+  constexpr int64_t iLength = 16 * CHUNK_SIZE;
+  CStandInLiveStream live(4 * 1024 * 1024, iLength);
+  CTimeshiftBuffer buffer(GetBufferPath(), 16 * 1024 * 1024, live.Reader());
+  ASSERT_TRUE(buffer.Start());
+
+  for (int i = 0; i < 500 && buffer.GetRange().second < iLength; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(buffer.GetRange().second, iLength);
+
+  const CTimeshiftBuffer::Times times = buffer.GetTimes();
+  EXPECT_NE(times.startTime, 0);
+  EXPECT_LE(times.iBeginMs, times.iEndMs);
+
+  // the position follows the arrival time of the data
+  const int64_t iTargetMs = (times.iBeginMs + times.iEndMs) / 2;
+  const int64_t iPosition = buffer.SeekTime(iTargetMs);
+  EXPECT_GE(buffer.GetTimes().iReadMs, iTargetMs);
+  EXPECT_LE(buffer.GetTimes().iReadMs, times.iEndMs);
+  ReadAt(buffer, iPosition);
+
+  // seeking before the buffer starts at the oldest data, after it at the live position
+  EXPECT_EQ(buffer.SeekTime(-1000), 0);
+  EXPECT_EQ(buffer.SeekTime(times.iEndMs + 10000), iLength);
+}
+
+TEST(TestTimeshiftBuffer, EndOfStream)
+{
+  CStandInLiveStream live(8 * 1024 * 1024, 3 * CHUNK_SIZE + 800);
+  CTimeshiftBuffer buffer(GetBufferPath(), 16 * 1024 * 1024, live.Reader());
+  ASSERT_TRUE(buffer.Start());
+
+  ReadAt(buffer, 0, 3 * CHUNK_SIZE + 800);
+
+  uint8_t buf[16];
+  EXPECT_EQ(buffer.Read(buf, sizeof(buf)), 0);
+  EXPECT_EQ(buffer.Seek(0, SEEK_END), 3 * CHUNK_SIZE + 800);
+}
+
+TEST(TestTimeshiftBuffer, InvalidPath)
+{
+  CStandInLiveStream live(1024 * 1024);
+  CTimeshiftBuffer buffer(testing::TempDir() + "missing/folder/timeshift.ts", 1024 * 1024,
+                          live.Reader());
+  EXPECT_FALSE(buffer.Start());
+  EXPECT_EQ(live.m_iReads, 0);
+}
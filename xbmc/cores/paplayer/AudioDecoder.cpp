@@ -57,7 +57,9 @@ void CAudioDecoder::Destroy()
   m_canPlay = false;
 }
 
-bool CAudioDecoder::Create(const CFileItem &file, int64_t seekOffset)
+bool CAudioDecoder::Create(const CFileItem &file,
+                           int64_t seekOffset,
+                           std::shared_ptr<const std::vector<uint8_t>> prefetchedData)
 {
   Destroy();
 
@@ -78,6 +80,8 @@ bool CAudioDecoder::Create(const CFileItem &file, int64_t seekOffset)
 
   // create our codec
   m_codec=CodecFactory::CreateCodecDemux(file, filecache * 1024);
+  if (m_codec && prefetchedData)
+    m_codec->SetPrefetchedData(std::move(prefetchedData));
 
   if (!m_codec || !m_codec->Init(file, filecache * 1024))
   {
@@ -43,7 +43,9 @@ public:
   CAudioDecoder();
   ~CAudioDecoder();
 
-  bool Create(const CFileItem &file, int64_t seekOffset);
+  bool Create(const CFileItem &file,
+              int64_t seekOffset,
+              std::shared_ptr<const std::vector<uint8_t>> prefetchedData = nullptr);
   void Destroy();
 
   int ReadSamples(int numsamples);
@@ -0,0 +1,274 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "AudioPrefetchCache.h"
+
+#include "URL.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+#include <algorithm>
+
+namespace
+{
+constexpr size_t READ_CHUNK_SIZE = 256 * 1024;
+
+class CFilePrefetchSource : public IAudioPrefetchSource
+{
+public:
+  bool Open(const std::string& path) override
+  {
+    return m_file.Open(path, XFILE::READ_NO_CACHE | XFILE::READ_AUDIO_VIDEO);
+  }
+  int64_t GetLength() override { return m_file.GetLength(); }
+  ssize_t Read(void* buffer, size_t size) override { return m_file.Read(buffer, size); }
+
+private:
+  XFILE::CFile m_file;
+};
+} // namespace
+
+CAudioPrefetchCache::CAudioPrefetchCache(AudioPrefetchSourceFactory factory)
+  : CThread("AudioPrefetch"), m_factory(std::move(factory))
+{
+  if (!m_factory)
+    m_factory = []() { return std::make_unique<CFilePrefetchSource>(); };
+}
+
+CAudioPrefetchCache::~CAudioPrefetchCache()
+{
+  StopThread(true);
+}
+
+void CAudioPrefetchCache::Configure(size_t memoryBudget, unsigned int lookahead)
+{
+  CSingleLock lock(m_critSection);
+  m_memoryBudget = memoryBudget;
+  m_lookahead = lookahead;
+  for (auto& entry : m_entries)
+    entry->failed = false;
+  Evict();
+  m_wakeEvent.Set();
+}
+
+void CAudioPrefetchCache::SetUpcoming(const std::vector<std::string>& paths)
+{
+  {
+    CSingleLock lock(m_critSection);
+    m_upcoming = paths;
+    for (auto& entry : m_entries)
+      entry->failed = false;
+    Evict();
+  }
+
+  if (!IsRunning())
+    Create();
+  m_wakeEvent.Set();
+}
+
+std::shared_ptr<const std::vector<uint8_t>> CAudioPrefetchCache::Get(const std::string& path) const
+{
+  CSingleLock lock(m_critSection);
+  for (const auto& entry : m_entries)
+  {
+    if (entry->path == path && entry->complete)
+      return entry->data;
+  }
+  return nullptr;
+}
+
+bool CAudioPrefetchCache::IsComplete(const std::string& path) const
+{
+  return Get(path) != nullptr;
+}
+
+std::shared_ptr<const std::vector<uint8_t>> CAudioPrefetchCache::Advance(
+    const std::string& path, const std::vector<std::string>& upcoming)
+{
+  std::shared_ptr<const std::vector<uint8_t>> data = Get(path);
+  SetUpcoming(upcoming);
+  return data;
+}
+
+size_t CAudioPrefetchCache::GetMemoryUsage() const
+{
+  CSingleLock lock(m_critSection);
+  return UsedBytes();
+}
+
+void CAudioPrefetchCache::Clear()
+{
+  StopThread(true);
+
+  CSingleLock lock(m_critSection);
+  m_upcoming.clear();
+  m_entries.clear();
+}
+
+void CAudioPrefetchCache::Process()
+{
+  while (!m_bStop)
+  {
+    std::shared_ptr<Entry> entry;
+    {
+      CSingleLock lock(m_critSection);
+      entry = NextEntry();
+    }
+
+    if (entry)
+      Fetch(entry);
+    else
+      AbortableWait(m_wakeEvent);
+  }
+}
+
+void CAudioPrefetchCache::Fetch(const std::shared_ptr<Entry>& entry)
+{
+  std::unique_ptr<IAudioPrefetchSource> source = m_factory();
+  const int64_t length = source && source->Open(entry->path) ? source->GetLength() : -1;
+
+  {
+    CSingleLock lock(m_critSection);
+    if (length <= 0)
+    {
+      // streams of unknown length are left to the regular file cache
+      CLog::Log(LOGDEBUG, "CAudioPrefetchCache::{} - unable to prefetch {}", __FUNCTION__,
+                CURL::GetRedacted(entry->path));
+      entry->failed = true;
+      return;
+    }
+    if (!Reserve(*entry, static_cast<size_t>(length)))
+    {
+      entry->failed = true;
+      return;
+    }
+  }
+
+  auto data = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(length));
+  size_t pos = 0;
+  while (pos < data->size())
+  {
+    {
+      CSingleLock lock(m_critSection);
+      // dropped from the playlist or evicted in favour of an earlier item
+      if (m_bStop || std::find(m_entries.begin(), m_entries.end(), entry) == m_entries.end())
+      {
+        entry->size = 0;
+        return;
+      }
+    }
+
+    const size_t size = std::min(READ_CHUNK_SIZE, data->size() - pos);
+    const ssize_t read = source->Read(data->data() + pos, size);
+    if (read <= 0)
+    {
+      CLog::Log(LOGWARNING, "CAudioPrefetchCache::{} - read error at {} of {} in {}",
+                __FUNCTION__, pos, data->size(), CURL::GetRedacted(entry->path));
+      CSingleLock lock(m_critSection);
+      entry->size = 0;
+      entry->failed = true;
+      return;
+    }
+    pos += static_cast<size_t>(read);
+  }
+
+  CSingleLock lock(m_critSection);
+  entry->data = std::move(data);
+  entry->complete = true;
+  CLog::Log(LOGDEBUG, "CAudioPrefetchCache::{} - prefetched {} ({} bytes)", __FUNCTION__,
+            CURL::GetRedacted(entry->path), entry->size);
+}
+
+bool CAudioPrefetchCache::Reserve(Entry& entry, size_t size)
+{
+  // items further down the playlist give way to this one
+  const int rank = GetRank(entry.path);
+  size_t higher = 0;
+  for (const auto& other : m_entries)
+  {
+    const int otherRank = GetRank(other->path);
+    if (other.get() != &entry && otherRank >= 0 && otherRank < rank)
+      higher += other->size;
+  }
+  if (rank < 0 || higher + size > m_memoryBudget)
+  {
+    CLog::Log(LOGDEBUG, "CAudioPrefetchCache::{} - {} bytes of {} exceed the budget",
+              __FUNCTION__, size, CURL::GetRedacted(entry.path));
+    return false;
+  }
+
+  entry.size = size;
+  while (UsedBytes() > m_memoryBudget)
+  {
+    auto lowest = std::max_element(m_entries.begin(), m_entries.end(),
+                                   [this](const auto& a, const auto& b) {
+                                     return GetRank(a->path) < GetRank(b->path);
+                                   });
+    if (lowest->get() == &entry)
+      break;
+    m_entries.erase(lowest);
+  }
+  return true;
+}
+
+int CAudioPrefetchCache::GetRank(const std::string& path) const
+{
+  const size_t count = std::min(m_upcoming.size(), static_cast<size_t>(m_lookahead));
+  for (size_t i = 0; i < count; i++)
+  {
+    if (m_upcoming[i] == path)
+      return static_cast<int>(i);
+  }
+  return -1;
+}
+
+std::shared_ptr<CAudioPrefetchCache::Entry> CAudioPrefetchCache::NextEntry()
+{
+  const size_t count = std::min(m_upcoming.size(), static_cast<size_t>(m_lookahead));
+  for (size_t i = 0; i < count; i++)
+  {
+    auto it = std::find_if(m_entries.begin(), m_entries.end(),
+                           [this, i](const auto& entry) { return entry->path == m_upcoming[i]; });
+    if (it == m_entries.end())
+    {
+      auto entry = std::make_shared<Entry>();
+      entry->path = m_upcoming[i];
+      m_entries.push_back(entry);
+      return entry;
+    }
+    if (!(*it)->complete && !(*it)->failed)
+      return *it;
+  }
+  return nullptr;
+}
+
+void CAudioPrefetchCache::Evict()
+{
+  m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(),
+                                 [this](const auto& entry) { return GetRank(entry->path) < 0; }),
+                  m_entries.end());
+
+  // a smaller budget drops the items played last
+  while (UsedBytes() > m_memoryBudget)
+  {
+    auto lowest = std::max_element(m_entries.begin(), m_entries.end(),
+                                   [this](const auto& a, const auto& b) {
+                                     return GetRank(a->path) < GetRank(b->path);
+                                   });
+    m_entries.erase(lowest);
+  }
+}
+
+size_t CAudioPrefetchCache::UsedBytes() const
+{
+  size_t used = 0;
+  for (const auto& entry : m_entries)
+    used += entry->size;
+  return used;
+}
@@ -0,0 +1,116 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Source the prefetch cache reads files from, wraps XFILE::CFile unless a test provides
+ * its own.
+ */
+class IAudioPrefetchSource
+{
+public:
+  virtual ~IAudioPrefetchSource() = default;
+  virtual bool Open(const std::string& path) = 0;
+  virtual int64_t GetLength() = 0;
+  virtual ssize_t Read(void* buffer, size_t size) = 0;
+};
+
+using AudioPrefetchSourceFactory = std::function<std::unique_ptr<IAudioPrefetchSource>()>;
+
+/*!
+ * \brief Reads upcoming playlist items completely into memory in the background.
+ *
+ * Network shares may need seconds to answer after a disk spin-up, which is too late once the
+ * next track of a gapless album is being opened. The cache fetches the next items in playlist
+ * order as long as they fit into the memory budget, a decoder then reads the file from memory.
+ */
+class CAudioPrefetchCache : private CThread
+{
+public:
+  explicit CAudioPrefetchCache(AudioPrefetchSourceFactory factory = nullptr);
+  ~CAudioPrefetchCache() override;
+
+  /*!
+   * \brief Set the limits, items that do not fit any more are dropped.
+   * \param memoryBudget maximum number of bytes held by the cache
+   * \param lookahead maximum number of upcoming items that are fetched
+   */
+  void Configure(size_t memoryBudget, unsigned int lookahead);
+
+  /*!
+   * \brief Set the items that will be played next, in playlist order. Items that are not in the
+   * list any more are dropped, a fetch in progress for such an item is aborted.
+   */
+  void SetUpcoming(const std::vector<std::string>& paths);
+
+  /*!
+   * \brief Get the content of a completely fetched file.
+   * \return the file content or nullptr if the file is not (yet) in the cache
+   */
+  std::shared_ptr<const std::vector<uint8_t>> Get(const std::string& path) const;
+
+  bool IsComplete(const std::string& path) const;
+
+  /*!
+   * \brief Take the content of the item that is opened now and set the items that will be played
+   * after it. The opened item is not upcoming any more, so the cache drops it.
+   * \return the content of the opened item or nullptr if it was not completely fetched
+   */
+  std::shared_ptr<const std::vector<uint8_t>> Advance(const std::string& path,
+                                                      const std::vector<std::string>& upcoming);
+
+  /*!
+   * \brief Bytes held by the cache including fetches in progress.
+   */
+  size_t GetMemoryUsage() const;
+
+  /*!
+   * \brief Stop fetching and drop everything.
+   */
+  void Clear();
+
+protected:
+  // implementation of CThread
+  void Process() override;
+
+private:
+  struct Entry
+  {
+    std::string path;
+    std::shared_ptr<std::vector<uint8_t>> data;
+    size_t size = 0; //!< bytes accounted against the budget
+    bool complete = false;
+    bool failed = false; //!< not tried again until the upcoming items change
+  };
+
+  void Fetch(const std::shared_ptr<Entry>& entry);
+  bool Reserve(Entry& entry, size_t size);
+  int GetRank(const std::string& path) const;
+  std::shared_ptr<Entry> NextEntry();
+  void Evict();
+  size_t UsedBytes() const;
+
+  AudioPrefetchSourceFactory m_factory;
+  CEvent m_wakeEvent;
+
+  mutable CCriticalSection m_critSection;
+  std::vector<std::string> m_upcoming;
+  std::vector<std::shared_ptr<Entry>> m_entries;
+  size_t m_memoryBudget = 64 * 1024 * 1024;
+  unsigned int m_lookahead = 2;
+};
@@ -12,7 +12,9 @@
 #include "filesystem/File.h"
 #include "music/tags/MusicInfoTag.h"
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #define READ_EOF      -1
 #define READ_SUCCESS   0
@@ -67,6 +69,11 @@ public:
   // set the total time - useful when info comes from a preset tag
   virtual void SetTotalTime(int64_t totaltime) {}
 
+  // SetPrefetchedData()
+  // Hands over the complete file, already read into memory, before Init() is called.
+  // Codecs that support it read from memory instead of opening the file.
+  virtual void SetPrefetchedData(std::shared_ptr<const std::vector<uint8_t>> data) {}
+
   virtual bool IsCaching()    const    {return false;}
   virtual int GetCacheLevel() const    {return -1;}
 
@@ -9,6 +9,7 @@
 #include "PAPlayer.h"
 
 #include "CodecFactory.h"
+#include "PlayListPlayer.h"
 #include "ServiceBroker.h"
 #include "Util.h"
 #include "cores/AudioEngine/Interfaces/AE.h"
@@ -19,6 +20,7 @@
 #include "cores/VideoPlayer/Process/ProcessInfo.h"
 #include "messaging/ApplicationMessenger.h"
 #include "music/tags/MusicInfoTag.h"
+#include "playlists/PlayList.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "settings/SettingsComponent.h"
@@ -236,8 +238,9 @@ bool PAPlayer::OpenFile(const CFileItem& file, const CPlayerOptions &options)
     CSingleLock lock(m_streamsLock);
     m_jobCounter++;
   }
+  const auto prefetched = UpdatePrefetch(file);
   CJobManager::GetInstance().Submit(
-    [=]() { QueueNextFileEx(file, false); },
+    [=]() { QueueNextFileEx(file, false, prefetched); },
     this,
     CJob::PRIORITY_NORMAL
   );
@@ -300,14 +303,17 @@ bool PAPlayer::QueueNextFile(const CFileItem &file)
     CSingleLock lock(m_streamsLock);
     m_jobCounter++;
   }
-  CJobManager::GetInstance().Submit([this, file]() {
-    QueueNextFileEx(file, true);
+  const auto prefetched = UpdatePrefetch(file);
+  CJobManager::GetInstance().Submit([this, file, prefetched]() {
+    QueueNextFileEx(file, true, prefetched);
   }, this, CJob::PRIORITY_NORMAL);
 
   return true;
 }
 
-bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn)
+bool PAPlayer::QueueNextFileEx(const CFileItem& file,
+                               bool fadeIn,
+                               const std::shared_ptr<const std::vector<uint8_t>>& prefetched)
 {
   if (m_currentStream)
   {
@@ -329,7 +335,7 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn)
 
   StreamInfo *si = new StreamInfo();
   si->m_fileItem = file;
-  if (!si->m_decoder.Create(file, si->m_fileItem.m_lStartOffset))
+  if (!si->m_decoder.Create(file, si->m_fileItem.m_lStartOffset, prefetched))
   {
     CLog::Log(LOGWARNING, "PAPlayer::QueueNextFileEx - Failed to create the decoder");
 
@@ -526,6 +532,9 @@ bool PAPlayer::CloseFile(bool reopen)
   /* wait for the thread to terminate */
   StopThread(true);//true - wait for end of thread
 
+  if (!reopen)
+    m_prefetchCache.Clear();
+
   // wait for any pending jobs to complete
   {
     CSingleLock lock(m_streamsLock);
@@ -1164,3 +1173,40 @@ void PAPlayer::AdvancePlaylistOnError(CFileItem &fileItem)
   m_signalStarted = true;
   m_callback.OnAVStarted(fileItem);
 }
+
+std::shared_ptr<const std::vector<uint8_t>> PAPlayer::UpdatePrefetch(const CFileItem& file)
+{
+  const std::shared_ptr<CAdvancedSettings> advancedSettings = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings();
+  if (!advancedSettings->m_audioPrefetch)
+    return nullptr;
+
+  const unsigned int lookahead = advancedSettings->m_audioPrefetchLookahead;
+  m_prefetchCache.Configure(
+      static_cast<size_t>(advancedSettings->m_audioPrefetchMemorySize) * 1024 * 1024, lookahead);
+
+  // the playlist still points to the playing item when the next one is queued, skip the item
+  // that is being opened right now
+  std::vector<std::string> upcoming;
+  const PLAYLIST::CPlayListPlayer& playlistPlayer = CServiceBroker::GetPlaylistPlayer();
+  const int playlist = playlistPlayer.GetCurrentPlaylist();
+  if (playlist != PLAYLIST_NONE)
+  {
+    const PLAYLIST::CPlayList& items = playlistPlayer.GetPlaylist(playlist);
+    for (unsigned int offset = 1; offset <= lookahead + 1 && upcoming.size() < lookahead; offset++)
+    {
+      const int index = playlistPlayer.GetNextSong(offset);
+      if (index < 0 || index >= items.size())
+        break;
+
+      // local files don't stall, streams and cds are not read ahead
+      const CFileItemPtr item = items[index];
+      if (item->GetDynPath() == file.GetDynPath() || !item->IsRemote() ||
+          item->IsInternetStream() || item->IsCDDA())
+        continue;
+
+      upcoming.push_back(item->GetDynPath());
+    }
+  }
+  // the item being opened is no longer upcoming, take its content before it is dropped
+  return m_prefetchCache.Advance(file.GetDynPath(), upcoming);
+}
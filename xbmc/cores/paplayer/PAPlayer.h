@@ -9,6 +9,7 @@
 #pragma once
 
 #include "AudioDecoder.h"
+#include "AudioPrefetchCache.h"
 #include "FileItem.h"
 #include "cores/AudioEngine/Interfaces/IAudioCallback.h"
 #include "cores/IPlayer.h"
@@ -134,8 +135,11 @@ private:
   int64_t             m_newForcedPlayerTime;
   int64_t             m_newForcedTotalTime;
   std::unique_ptr<CProcessInfo> m_processInfo;
+  CAudioPrefetchCache m_prefetchCache;       /* upcoming playlist items read ahead from network shares */
 
-  bool QueueNextFileEx(const CFileItem &file, bool fadeIn);
+  bool QueueNextFileEx(const CFileItem& file,
+                       bool fadeIn,
+                       const std::shared_ptr<const std::vector<uint8_t>>& prefetched);
   void SoftStart(bool wait = false);
   void SoftStop(bool wait = false, bool close = true);
   void CloseAllStreams(bool fade = true);
@@ -152,5 +156,6 @@ private:
   bool SetTotalTimeInternal(int64_t time);
   void CloseFileCB(StreamInfo &si);
   void AdvancePlaylistOnError(CFileItem &fileItem);
+  std::shared_ptr<const std::vector<uint8_t>> UpdatePrefetch(const CFileItem& file);
 };
 
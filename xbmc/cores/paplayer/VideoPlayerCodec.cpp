@@ -17,6 +17,7 @@
 #include "cores/VideoPlayer/DVDDemuxers/DVDDemuxUtils.h"
 #include "cores/VideoPlayer/DVDDemuxers/DVDFactoryDemuxer.h"
 #include "cores/VideoPlayer/DVDInputStreams/DVDFactoryInputStream.h"
+#include "cores/VideoPlayer/DVDInputStreams/DVDInputStreamMemory.h"
 #include "cores/VideoPlayer/DVDStreamInfo.h"
 #include "music/tags/TagLoaderTagLib.h"
 #include "utils/StringUtils.h"
@@ -82,7 +83,14 @@ bool VideoPlayerCodec::Init(const CFileItem &file, unsigned int filecache)
   CFileItem fileitem(file);
   fileitem.SetMimeType(m_strContentType);
   fileitem.SetMimeTypeForInternetFile();
-  m_pInputStream = CDVDFactoryInputStream::CreateInputStream(NULL, fileitem);
+  if (m_prefetchedData)
+  {
+    auto memoryStream = std::make_shared<CDVDInputStreamMemory>(fileitem);
+    memoryStream->SetData(std::move(m_prefetchedData));
+    m_pInputStream = memoryStream;
+  }
+  else
+    m_pInputStream = CDVDFactoryInputStream::CreateInputStream(NULL, fileitem);
   if (!m_pInputStream)
   {
     CLog::Log(LOGERROR, "{}: Error creating input stream for {}", __FUNCTION__, file.GetDynPath());
@@ -278,6 +286,11 @@ bool VideoPlayerCodec::Init(const CFileItem &file, unsigned int filecache)
   return true;
 }
 
+void VideoPlayerCodec::SetPrefetchedData(std::shared_ptr<const std::vector<uint8_t>> data)
+{
+  m_prefetchedData = std::move(data);
+}
+
 void VideoPlayerCodec::DeInit()
 {
   if (m_pDemuxer != NULL)
@@ -30,6 +30,7 @@ public:
   int ReadRaw(uint8_t **pBuffer, int *bufferSize) override;
   bool CanInit() override;
   bool CanSeek() override;
+  void SetPrefetchedData(std::shared_ptr<const std::vector<uint8_t>> data) override;
 
   void DeInit();
   AEAudioFormat GetFormat();
@@ -44,6 +45,7 @@ private:
   CDVDDemux* m_pDemuxer;
   std::shared_ptr<CDVDInputStream> m_pInputStream;
   std::unique_ptr<CDVDAudioCodec> m_pAudioCodec;
+  std::shared_ptr<const std::vector<uint8_t>> m_prefetchedData;
 
   std::string m_strContentType;
   std::string m_strFileName;
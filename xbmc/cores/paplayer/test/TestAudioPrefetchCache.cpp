@@ -0,0 +1,257 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/paplayer/AudioPrefetchCache.h"
+#include "test/SlowStorage.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string.h>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+/*!
+ * \brief Network share that needs a while to answer every read.
+ */
+struct SlowShare : public CSlowStorage
+{
+  SlowShare() { delayMs = 5; }
+
+  std::map<std::string, int64_t> files;
+  std::atomic<int> opens{0};
+
+  static uint8_t ByteAt(const std::string& path, size_t pos)
+  {
+    return static_cast<uint8_t>(pos * 7 + path.size());
+  }
+};
+
+class CSlowSource : public IAudioPrefetchSource
+{
+public:
+  explicit CSlowSource(SlowShare& storage) : m_storage(storage) {}
+
+  bool Open(const std::string& path) override
+  {
+    m_storage.opens++;
+    auto it = m_storage.files.find(path);
+    if (it == m_storage.files.end())
+      return false;
+    m_path = path;
+    m_length = it->second;
+    return true;
+  }
+
+  int64_t GetLength() override { return m_length; }
+
+  ssize_t Read(void* buffer, size_t size) override
+  {
+    m_storage.Access();
+
+    // the share hands out at most 64 kB per request
+    size = std::min<size_t>(size, 64 * 1024);
+    size = std::min<size_t>(size, static_cast<size_t>(m_length - m_pos));
+    uint8_t* data = static_cast<uint8_t*>(buffer);
+    for (size_t i = 0; i < size; i++)
+      data[i] = SlowShare::ByteAt(m_path, static_cast<size_t>(m_pos) + i);
+    m_pos += size;
+    return static_cast<ssize_t>(size);
+  }
+
+private:
+  SlowShare& m_storage;
+  std::string m_path;
+  int64_t m_length = -1;
+  int64_t m_pos = 0;
+};
+
+template<typename Predicate>
+bool WaitFor(Predicate predicate, std::chrono::milliseconds timeout = 5000ms)
+{
+  const auto end = std::chrono::steady_clock::now() + timeout;
+  while (!predicate())
+  {
+    if (std::chrono::steady_clock::now() > end)
+      return false;
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+} // namespace
+
+class TestAudioPrefetchCache : public ::testing::Test
+{
+protected:
+  TestAudioPrefetchCache()
+    : cache([this]() { return std::make_unique<CSlowSource>(storage); })
+  {
+    storage.files["smb://nas/album/01.flac"] = 512 * 1024;
+    storage.files["smb://nas/album/02.flac"] = 384 * 1024;
+    storage.files["smb://nas/album/03.flac"] = 256 * 1024;
+  }
+
+  SlowShare storage;
+  CAudioPrefetchCache cache;
+};
+
+TEST_F(TestAudioPrefetchCache, PrefetchInBackground)
+{
+  cache.Configure(16 * 1024 * 1024, 2);
+  cache.SetUpcoming({"smb://nas/album/01.flac", "smb://nas/album/02.flac"});
+
+  ASSERT_TRUE(WaitFor([this]() { return cache.IsComplete("smb://nas/album/02.flac"); }));
+  EXPECT_TRUE(cache.IsComplete("smb://nas/album/01.flac"));
+  EXPECT_EQ(static_cast<size_t>(896 * 1024), cache.GetMemoryUsage());
+
+  auto data = cache.Get("smb://nas/album/01.flac");
+  ASSERT_TRUE(data);
+  ASSERT_EQ(static_cast<size_t>(512 * 1024), data->size());
+  for (size_t i = 0; i < data->size(); i += 4099)
+    ASSERT_EQ(SlowShare::ByteAt("smb://nas/album/01.flac", i), (*data)[i]);
+
+  EXPECT_FALSE(cache.Get("smb://nas/album/03.flac"));
+  EXPECT_EQ(2, storage.opens);
+}
+
+TEST_F(TestAudioPrefetchCache, NextTrackFromMemory)
+{
+  cache.Configure(16 * 1024 * 1024, 1);
+  cache.SetUpcoming({"smb://nas/album/02.flac"});
+  ASSERT_TRUE(WaitFor([this]() { return cache.IsComplete("smb://nas/album/02.flac"); }));
+
+  // the share spins down, opening the next track must not touch it anymore
+  storage.delayMs = 500;
+  const int reads = storage.accesses;
+  const auto start = std::chrono::steady_clock::now();
+  auto data = cache.Get("smb://nas/album/02.flac");
+  ASSERT_TRUE(data);
+  uint8_t buffer[4096];
+  for (size_t pos = 0; pos < data->size(); pos += sizeof(buffer))
+    memcpy(buffer, data->data() + pos, std::min(sizeof(buffer), data->size() - pos));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 100ms);
+  EXPECT_EQ(reads, storage.accesses);
+
+  // an item that is still being fetched is not waited for
+  cache.SetUpcoming({"smb://nas/album/02.flac", "smb://nas/album/03.flac"});
+  cache.Configure(16 * 1024 * 1024, 2);
+  ASSERT_TRUE(WaitFor([this, reads]() { return storage.accesses > reads; }));
+  const auto before = std::chrono::steady_clock::now();
+  EXPECT_FALSE(cache.Get("smb://nas/album/03.flac"));
+  EXPECT_LT(std::chrono::steady_clock::now() - before, 100ms);
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.GetMemoryUsage());
+}
+
+TEST_F(TestAudioPrefetchCache, QueueNextFile)
+{
+  // PAPlayer queues the next track while the playlist still points to the playing one
+  cache.Configure(16 * 1024 * 1024, 2);
+  cache.SetUpcoming({"smb://nas/album/02.flac", "smb://nas/album/03.flac"});
+  ASSERT_TRUE(WaitFor([this]() { return cache.IsComplete("smb://nas/album/03.flac"); }));
+  const int opens = storage.opens;
+
+  // opening the next track moves the upcoming items on, which drops the opened one
+  auto data = cache.Advance("smb://nas/album/02.flac", {"smb://nas/album/03.flac"});
+  ASSERT_TRUE(data);
+  ASSERT_EQ(static_cast<size_t>(384 * 1024), data->size());
+  for (size_t i = 0; i < data->size(); i += 4099)
+    ASSERT_EQ(SlowShare::ByteAt("smb://nas/album/02.flac", i), (*data)[i]);
+  EXPECT_FALSE(cache.Get("smb://nas/album/02.flac"));
+  EXPECT_EQ(static_cast<size_t>(256 * 1024), cache.GetMemoryUsage());
+
+  // an item that was not fetched completely is read from the share by the decoder
+  EXPECT_FALSE(cache.Advance("smb://nas/album/01.flac", {}));
+  EXPECT_EQ(opens, storage.opens);
+}
+
+TEST_F(TestAudioPrefetchCache, MemoryBudget)
+{
+  // the second item does not fit next to the first one
+  cache.Configure(800 * 1024, 3);
+  cache.SetUpcoming({"smb://nas/album/01.flac", "smb://nas/album/02.flac", "smb://nas/album/03.flac"});
+
+  ASSERT_TRUE(WaitFor([this]() { return cache.IsComplete("smb://nas/album/03.flac"); }));
+  EXPECT_TRUE(cache.IsComplete("smb://nas/album/01.flac"));
+  EXPECT_FALSE(cache.IsComplete("smb://nas/album/02.flac"));
+  EXPECT_EQ(static_cast<size_t>(768 * 1024), cache.GetMemoryUsage());
+
+  // once the first item is played the second one moves up and takes the place of the third
+  cache.SetUpcoming({"smb://nas/album/02.flac", "smb://nas/album/03.flac"});
+  ASSERT_TRUE(WaitFor([this]() { return cache.IsComplete("smb://nas/album/02.flac"); }));
+  EXPECT_TRUE(cache.IsComplete("smb://nas/album/03.flac"));
+  EXPECT_LE(cache.GetMemoryUsage(), static_cast<size_t>(800 * 1024));
+
+  // a smaller budget drops the items played last
+  cache.Configure(400 * 1024, 3);
+  EXPECT_TRUE(cache.IsComplete("smb://nas/album/02.flac"));
+  EXPECT_FALSE(cache.IsComplete("smb://nas/album/03.flac"));
+  EXPECT_EQ(static_cast<size_t>(384 * 1024), cache.GetMemoryUsage());
+}
+
+TEST_F(TestAudioPrefetchCache, Lookahead)
+{
+  cache.Configure(16 * 1024 * 1024, 1);
+  cache.SetUpcoming({"smb://nas/album/01.flac", "smb://nas/album/02.flac", "smb://nas/album/03.flac"});
+
+  ASSERT_TRUE(WaitFor([this]() { return cache.IsComplete("smb://nas/album/01.flac"); }));
+  std::this_thread::sleep_for(50ms);
+  EXPECT_FALSE(cache.IsComplete("smb://nas/album/02.flac"));
+  EXPECT_EQ(1, storage.opens);
+}
+
+TEST_F(TestAudioPrefetchCache, PlaylistChange)
+{
+  storage.delayMs = 50;
+  cache.Configure(16 * 1024 * 1024, 1);
+  cache.SetUpcoming({"smb://nas/album/01.flac"});
+  ASSERT_TRUE(WaitFor([this]() { return storage.accesses > 0; }));
+
+  // the user picks another track, the fetch in progress is abandoned
+  storage.delayMs = 1;
+  cache.SetUpcoming({"smb://nas/album/03.flac"});
+  ASSERT_TRUE(WaitFor([this]() { return cache.IsComplete("smb://nas/album/03.flac"); }));
+  EXPECT_FALSE(cache.IsComplete("smb://nas/album/01.flac"));
+  EXPECT_EQ(static_cast<size_t>(256 * 1024), cache.GetMemoryUsage());
+  EXPECT_LT(storage.accesses, 8 + 4);
+}
+
+TEST_F(TestAudioPrefetchCache, StopWhileReading)
+{
+  storage.delayMs = 20;
+  cache.Configure(16 * 1024 * 1024, 2);
+  cache.SetUpcoming({"smb://nas/album/01.flac", "smb://nas/album/02.flac"});
+  ASSERT_TRUE(WaitFor([this]() { return storage.accesses > 0; }));
+
+  const auto start = std::chrono::steady_clock::now();
+  cache.Clear();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 500ms);
+  EXPECT_EQ(0u, cache.GetMemoryUsage());
+  EXPECT_FALSE(cache.IsComplete("smb://nas/album/01.flac"));
+}
+
+TEST_F(TestAudioPrefetchCache, Unavailable)
+{
+  storage.files["smb://nas/album/live.mp3"] = -1;
+  cache.Configure(16 * 1024 * 1024, 3);
+  cache.SetUpcoming({"smb://nas/album/missing.flac", "smb://nas/album/live.mp3",
+                     "smb://nas/album/03.flac"});
+
+  // items that cannot be read are skipped
+  ASSERT_TRUE(WaitFor([this]() { return cache.IsComplete("smb://nas/album/03.flac"); }));
+  EXPECT_FALSE(cache.Get("smb://nas/album/missing.flac"));
+  EXPECT_FALSE(cache.Get("smb://nas/album/live.mp3"));
+  EXPECT_EQ(3, storage.opens);
+}
@@ -31,15 +31,18 @@ using namespace ADDON;
 #define LABEL_ROW2 11
 #define LABEL_ROW3 12
 
-CAudioBuffer::CAudioBuffer(int iSize)
+CAudioBuffer::CAudioBuffer(int iSize, int iFreqSize)
 {
   m_iLen = iSize;
   m_pBuffer = new float[iSize];
+  m_iFreqLen = iFreqSize;
+  m_pFreq = iFreqSize > 0 ? new float[iFreqSize] : nullptr;
 }
 
 CAudioBuffer::~CAudioBuffer()
 {
   delete [] m_pBuffer;
+  delete [] m_pFreq;
 }
 
 const float* CAudioBuffer::Get() const
@@ -52,6 +55,16 @@ int CAudioBuffer::Size() const
   return m_iLen;
 }
 
+const float* CAudioBuffer::GetFreq() const
+{
+  return m_pFreq;
+}
+
+int CAudioBuffer::FreqSize() const
+{
+  return m_iFreqLen;
+}
+
 void CAudioBuffer::Set(const float* psBuffer, int iSize)
 {
   if (iSize < 0)
@@ -62,6 +75,14 @@ void CAudioBuffer::Set(const float* psBuffer, int iSize)
     m_pBuffer[i] = 0;
 }
 
+void CAudioBuffer::SetFreq(const float* psFreq, int iFreqSize)
+{
+  if (iFreqSize < 0 || iFreqSize > m_iFreqLen)
+    return;
+
+  memcpy(m_pFreq, psFreq, iFreqSize * sizeof(float));
+}
+
 CGUIVisualisationControl::CGUIVisualisationControl(int parentID, int controlID, float posX, float posY, float width, float height)
   : CGUIControl(parentID, controlID, posX, posY, width, height),
     m_callStart(false),
@@ -240,15 +261,20 @@ void CGUIVisualisationControl::OnInitialize(int channels, int samplesPerSec, int
   m_callStart = true;
 }
 
-void CGUIVisualisationControl::OnAudioData(const float* audioData, unsigned int audioDataLength)
+void CGUIVisualisationControl::OnSpectrumData(const float* audioData,
+                                              unsigned int audioDataLength,
+                                              const float* freqData,
+                                              unsigned int freqDataLength)
 {
   if (!m_instance || !m_alreadyStarted || !audioData || audioDataLength == 0)
     return;
 
-  // Save our audio data in the buffers
-  std::unique_ptr<CAudioBuffer> pBuffer(new CAudioBuffer(audioDataLength));
+  // Save our audio data in the buffers, the spectrum is computed once by the
+  // audio engine and kept with its block for the visualisation's sync delay
+  const unsigned int freqLength = m_wantsFreq && freqData ? freqDataLength : 0;
+  std::unique_ptr<CAudioBuffer> pBuffer(new CAudioBuffer(audioDataLength, freqLength));
   pBuffer->Set(audioData, audioDataLength);
-  //m_vecBuffers.push_back(pBuffer.release());
+  pBuffer->SetFreq(freqData, freqLength);
   m_vecBuffers.emplace_back(std::move(pBuffer));
 
   if (m_vecBuffers.size() < m_numBuffers)
@@ -257,23 +283,9 @@ void CGUIVisualisationControl::OnAudioData(const float* audioData, unsigned int
   std::unique_ptr<CAudioBuffer> ptrAudioBuffer = std::move(m_vecBuffers.front());
   m_vecBuffers.pop_front();
 
-  // Fourier transform the data if the vis wants it...
-  if (m_wantsFreq)
-  {
-    const float *psAudioData = ptrAudioBuffer->Get();
-
-    if (!m_transform)
-      m_transform.reset(new RFFT(AUDIO_BUFFER_SIZE/2, false)); // half due to stereo
-
-    m_transform->calc(psAudioData, m_freq);
-
-    // Transfer data to our visualisation
-    m_instance->AudioData(psAudioData, ptrAudioBuffer->Size(), m_freq, AUDIO_BUFFER_SIZE/2); // half due to complex-conjugate
-  }
-  else
-  { // Transfer data to our visualisation
-    m_instance->AudioData(ptrAudioBuffer->Get(), ptrAudioBuffer->Size(), nullptr, 0);
-  }
+  // Transfer data to our visualisation
+  m_instance->AudioData(ptrAudioBuffer->Get(), ptrAudioBuffer->Size(), ptrAudioBuffer->GetFreq(),
+                        ptrAudioBuffer->FreqSize());
 }
 
 void CGUIVisualisationControl::UpdateTrack()
@@ -370,8 +382,6 @@ bool CGUIVisualisationControl::InitVisualization()
   if (!addonBase)
     return false;
 
-  CServiceBroker::GetActiveAE()->RegisterAudioCallback(this);
-
   CServiceBroker::GetWinSystem()->GetGfxContext().CaptureStateBlock();
 
   float x = CServiceBroker::GetWinSystem()->GetGfxContext().ScaleFinalXCoord(GetXPosition(), GetYPosition());
@@ -392,6 +402,8 @@ bool CGUIVisualisationControl::InitVisualization()
 
   m_alreadyStarted = false;
   CServiceBroker::GetWinSystem()->GetGfxContext().ApplyStateBlock();
+
+  CServiceBroker::GetActiveAE()->RegisterSpectrumCallback(this);
   return true;
 }
 
@@ -402,7 +414,7 @@ void CGUIVisualisationControl::DeInitVisualization()
 
   IAE * ae = CServiceBroker::GetActiveAE();
   if (ae)
-    ae->UnregisterAudioCallback(this);
+    ae->UnregisterSpectrumCallback(this);
 
   m_attemptedLoad = false;
 
@@ -451,12 +463,4 @@ void CGUIVisualisationControl::ClearBuffers()
   m_wantsFreq = false;
   m_numBuffers = 0;
   m_vecBuffers.clear();
-
-  for (float& freq : m_freq)
-  {
-    freq = 0.0f;
-  }
-
-  if (m_transform)
-    m_transform.reset();
 }
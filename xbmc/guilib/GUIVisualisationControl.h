@@ -10,42 +10,48 @@
 
 #include "GUIControl.h"
 #include "addons/Visualization.h"
-#include "cores/AudioEngine/Interfaces/IAudioCallback.h"
-#include "utils/rfft.h"
+#include "cores/AudioEngine/Interfaces/IAudioSpectrumCallback.h"
 
 #include <list>
 #include <string>
 #include <vector>
 
-#define AUDIO_BUFFER_SIZE 512 // MUST BE A POWER OF 2!!!
 #define MAX_AUDIO_BUFFERS 16
 
 class CAudioBuffer
 {
 public:
-  explicit CAudioBuffer(int iSize);
+  CAudioBuffer(int iSize, int iFreqSize);
   virtual ~CAudioBuffer();
   const float* Get() const;
   int Size() const;
+  const float* GetFreq() const;
+  int FreqSize() const;
   void Set(const float* psBuffer, int iSize);
+  void SetFreq(const float* psFreq, int iFreqSize);
 private:
   CAudioBuffer(const CAudioBuffer&) = delete;
   CAudioBuffer& operator=(const CAudioBuffer&) = delete;
   CAudioBuffer();
   float* m_pBuffer;
   int m_iLen;
+  float* m_pFreq;
+  int m_iFreqLen;
 };
 
-class CGUIVisualisationControl : public CGUIControl, public IAudioCallback
+class CGUIVisualisationControl : public CGUIControl, public IAudioSpectrumCallback
 {
 public:
   CGUIVisualisationControl(int parentID, int controlID, float posX, float posY, float width, float height);
   CGUIVisualisationControl(const CGUIVisualisationControl &from);
   CGUIVisualisationControl *Clone() const override { return new CGUIVisualisationControl(*this); }; //! @todo check for naughties
 
-  // Child functions related to IAudioCallback
+  // Child functions related to IAudioSpectrumCallback
   void OnInitialize(int channels, int samplesPerSec, int bitsPerSample) override;
-  void OnAudioData(const float* audioData, unsigned int audioDataLength) override;
+  void OnSpectrumData(const float* audioData,
+                      unsigned int audioDataLength,
+                      const float* freqData,
+                      unsigned int freqDataLength) override;
 
   // Child functions related to CGUIControl
   void FreeResources(bool immediately = false) override;
@@ -80,11 +86,9 @@ private:
   std::list<std::unique_ptr<CAudioBuffer>> m_vecBuffers;
   unsigned int m_numBuffers; /*!< Number of Audio buffers */
   bool m_wantsFreq;
-  float m_freq[AUDIO_BUFFER_SIZE]; /*!< Frequency data */
   std::vector<std::string> m_presets; /*!< cached preset list */
-  std::unique_ptr<RFFT> m_transform;
 
-  /* values set from "OnInitialize" IAudioCallback  */
+  /* values set from "OnInitialize" IAudioSpectrumCallback  */
   int m_channels;
   int m_samplesPerSec;
   int m_bitsPerSample;
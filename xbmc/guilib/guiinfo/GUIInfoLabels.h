@@ -306,6 +306,9 @@
 #define RETROPLAYER_VIDEO_FILTER      330
 #define RETROPLAYER_STRETCH_MODE      331
 #define RETROPLAYER_VIDEO_ROTATION    332
+#define RETROPLAYER_RUNAHEAD_FRAMES   333
+#define RETROPLAYER_RUNAHEAD_CPUTIME  334
+#define RETROPLAYER_RUNAHEAD_LATENCY  335
 
 #define CONTAINER_HAS_PARENT_ITEM    341
 #define CONTAINER_CAN_FILTER         342
@@ -375,6 +378,10 @@
 #define VISUALISATION_NAME          412
 #define VISUALISATION_ENABLED       413
 #define VISUALISATION_HAS_PRESETS   414
+#define VISUALISATION_LEVEL_LEFT    415
+#define VISUALISATION_LEVEL_RIGHT   416
+#define VISUALISATION_PEAK_LEFT     417
+#define VISUALISATION_PEAK_RIGHT    418
 
 #define STRING_IS_EMPTY             420
 #define STRING_IS_EQUAL             421
@@ -709,6 +716,7 @@
 #define PLAYER_PROCESS_AUDIOCHANNELS (PLAYER_PROCESS + 9)
 #define PLAYER_PROCESS_AUDIOSAMPLERATE (PLAYER_PROCESS + 10)
 #define PLAYER_PROCESS_AUDIOBITSPERSAMPLE (PLAYER_PROCESS + 11)
+#define PLAYER_PROCESS_AUDIOLATENCY (PLAYER_PROCESS + 12)
 
 #define WINDOW_PROPERTY             9993
 #define WINDOW_IS_VISIBLE           9995
@@ -9,7 +9,9 @@
 #include "guilib/guiinfo/GamesGUIInfo.h"
 
 #include "FileItem.h"
+#include "ServiceBroker.h"
 #include "Util.h"
+#include "cores/DataCacheCore.h"
 #include "cores/RetroPlayer/RetroPlayerUtils.h"
 #include "games/tags/GameInfoTag.h"
 #include "guilib/guiinfo/GUIInfo.h"
@@ -69,6 +71,23 @@ bool CGamesGUIInfo::GetLabel(std::string& value, const CFileItem *item, int cont
       value = std::to_string(rotationDegCCW);
       return true;
     }
+    case RETROPLAYER_RUNAHEAD_FRAMES:
+    {
+      value = std::to_string(CMediaSettings::GetInstance().GetCurrentGameSettings().RunAheadFrames());
+      return true;
+    }
+    case RETROPLAYER_RUNAHEAD_CPUTIME:
+    {
+      value = StringUtils::Format(
+          "{:.1f}", CServiceBroker::GetDataCacheCore().GetGameRunAheadCpuTime() * 1000.0);
+      return true;
+    }
+    case RETROPLAYER_RUNAHEAD_LATENCY:
+    {
+      value = StringUtils::Format(
+          "{:.0f}", CServiceBroker::GetDataCacheCore().GetGameRunAheadLatencySaved() * 1000.0);
+      return true;
+    }
     default:
       break;
   }
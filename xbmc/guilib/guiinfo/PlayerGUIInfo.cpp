@@ -343,6 +343,10 @@ bool CPlayerGUIInfo::GetLabel(std::string& value, const CFileItem *item, int con
     case PLAYER_PROCESS_AUDIOBITSPERSAMPLE:
       value = StringUtils::FormatNumber(CServiceBroker::GetDataCacheCore().GetAudioBitsPerSample());
       return true;
+    case PLAYER_PROCESS_AUDIOLATENCY:
+      value = StringUtils::Format(
+          "{:.0f}", CServiceBroker::GetDataCacheCore().GetAudioLatency() * 1000.0);
+      return true;
 
     ///////////////////////////////////////////////////////////////////////////////////////////////
     // PLAYLIST_*
@@ -11,6 +11,8 @@
 #include "GUIUserMessages.h"
 #include "ServiceBroker.h"
 #include "addons/AddonManager.h"
+#include "cores/AudioEngine/Interfaces/AE.h"
+#include "cores/AudioEngine/Interfaces/IAudioSpectrumCallback.h"
 #include "guilib/GUIComponent.h"
 #include "guilib/GUIVisualisationControl.h"
 #include "guilib/GUIWindowManager.h"
@@ -20,8 +22,51 @@
 #include "settings/SettingsComponent.h"
 #include "utils/URIUtils.h"
 
+#include <algorithm>
+#include <math.h>
+
 using namespace KODI::GUILIB::GUIINFO;
 
+namespace
+{
+constexpr float LEVEL_RANGE_DB = 60.0f;
+
+// Level of the audio being played on a 0..100 scale covering LEVEL_RANGE_DB
+int GetAudioLevel(int info)
+{
+  IAE* ae = CServiceBroker::GetActiveAE();
+  if (!ae)
+    return 0;
+
+  AEAudioLevels levels;
+  if (!ae->GetAudioLevels(levels))
+    return 0;
+
+  float level = 0.0f;
+  switch (info)
+  {
+    case VISUALISATION_LEVEL_LEFT:
+      level = levels.rms[0];
+      break;
+    case VISUALISATION_LEVEL_RIGHT:
+      level = levels.rms[1];
+      break;
+    case VISUALISATION_PEAK_LEFT:
+      level = levels.peak[0];
+      break;
+    case VISUALISATION_PEAK_RIGHT:
+      level = levels.peak[1];
+      break;
+  }
+
+  if (level <= 0.0f)
+    return 0;
+
+  const float scaled = (20.0f * log10f(level) + LEVEL_RANGE_DB) / LEVEL_RANGE_DB;
+  return static_cast<int>(lroundf(std::min(std::max(scaled, 0.0f), 1.0f) * 100.0f));
+}
+} // namespace
+
 bool CVisualisationGUIInfo::InitCurrentItem(CFileItem *item)
 {
   return false;
@@ -63,6 +108,14 @@ bool CVisualisationGUIInfo::GetLabel(std::string& value, const CFileItem *item,
       }
       break;
     }
+    case VISUALISATION_LEVEL_LEFT:
+    case VISUALISATION_LEVEL_RIGHT:
+    case VISUALISATION_PEAK_LEFT:
+    case VISUALISATION_PEAK_RIGHT:
+    {
+      value = std::to_string(GetAudioLevel(info.m_info));
+      return true;
+    }
   }
 
   return false;
@@ -70,6 +123,21 @@ bool CVisualisationGUIInfo::GetLabel(std::string& value, const CFileItem *item,
 
 bool CVisualisationGUIInfo::GetInt(int& value, const CGUIListItem *gitem, int contextWindow, const CGUIInfo &info) const
 {
+  switch (info.m_info)
+  {
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // VISUALISATION_*
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    case VISUALISATION_LEVEL_LEFT:
+    case VISUALISATION_LEVEL_RIGHT:
+    case VISUALISATION_PEAK_LEFT:
+    case VISUALISATION_PEAK_RIGHT:
+    {
+      value = GetAudioLevel(info.m_info);
+      return true;
+    }
+  }
+
   return false;
 }
 
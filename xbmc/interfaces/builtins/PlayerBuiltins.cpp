@@ -22,6 +22,7 @@
 #include "pvr/channels/PVRChannel.h"
 #include "pvr/guilib/PVRGUIActions.h"
 #include "pvr/recordings/PVRRecording.h"
+#include "settings/GameSettings.h"
 #include "settings/MediaSettings.h"
 #include "settings/Settings.h"
 #include "settings/SettingsComponent.h"
@@ -33,6 +34,7 @@
 #include "video/windows/GUIWindowVideoBase.h"
 #include "view/GUIViewState.h"
 
+#include <algorithm>
 #include <math.h>
 
 #ifdef HAS_DVD_DRIVE
@@ -383,6 +385,42 @@ static int PlayerControl(const std::vector<std::string>& params)
   {
     g_application.OnAction(CAction(ACTION_PLAYER_RESET));
   }
+  else if (StringUtils::StartsWithNoCase(params[0], "runahead"))
+  {
+    if (!g_application.GetAppPlayer().IsPlayingGame())
+      return 0;
+
+    CGameSettings& gameSettings = CMediaSettings::GetInstance().GetCurrentGameSettings();
+
+    unsigned int runAheadFrames;
+    if (params[0].size() == 8)
+    {
+      // cycle through the frame counts
+      runAheadFrames = (gameSettings.RunAheadFrames() + 1) % (KODI::RETRO::MAX_RUNAHEAD_FRAMES + 1);
+    }
+    else if (params[0].size() < 11) // arg must be at least "(N)"
+    {
+      CLog::Log(LOGERROR, "PlayerControl(runahead(n)) called with invalid argument: \"{}\"",
+                params[0].substr(9));
+      return 0;
+    }
+    else
+    {
+      std::string strFrames = params[0].substr(9);
+      StringUtils::TrimRight(strFrames, ")");
+      runAheadFrames = std::min(static_cast<unsigned int>(std::max(atoi(strFrames.c_str()), 0)),
+                                KODI::RETRO::MAX_RUNAHEAD_FRAMES);
+    }
+
+    if (gameSettings.RunAheadFrames() != runAheadFrames)
+    {
+      gameSettings.SetRunAheadFrames(runAheadFrames);
+      gameSettings.NotifyObservers(ObservableMessageSettingsChanged);
+
+      // the choice is remembered for the game that is playing
+      CServiceBroker::GetSettingsComponent()->GetSettings()->Save();
+    }
+  }
 
   return 0;
 }
@@ -596,6 +634,8 @@ static int Seek(const std::vector<std::string>& params)
 ///     | Partymode(path to .xsp) | Partymode for *.xsp-file               | Partymode for *.xsp-file    |             |
 ///     | ShowVideoMenu           | Shows the DVD/BR menu if available     | none                        |             |
 ///     | FrameAdvance(n) ***     | Advance video by _n_ frames            | none                        | Kodi v18    |
+///     | RunAhead                | Cycles the run-ahead frames of games   | none                        | Kodi v20    |
+///     | RunAhead(n)             | Runs games _n_ frames ahead of input   | none                        | Kodi v20    |
 ///     <br>
 ///     '*' = For these controls\, the PlayerControl built-in function can make use of the 'notify'-parameter. For example: PlayerControl(random\, notify)
 ///     <br>
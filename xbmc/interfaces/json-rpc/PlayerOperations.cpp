@@ -19,6 +19,7 @@
 #include "Util.h"
 #include "VideoLibrary.h"
 #include "cores/IPlayer.h"
+#include "cores/VideoPlayer/VideoRenderers/RenderTelemetry.h"
 #include "cores/playercorefactory/PlayerCoreFactory.h"
 #include "guilib/GUIWindowManager.h"
 #include "input/Key.h"
@@ -631,6 +632,62 @@ JSONRPC_STATUS CPlayerOperations::GetViewMode(const std::string &method, ITransp
   return OK;
 }
 
+JSONRPC_STATUS CPlayerOperations::GetFramePacing(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  if (GetPlayer(parameterObject["playerid"]) != Video)
+    return FailedToExecute;
+
+  FramePacingStats stats;
+  std::vector<FramePacingEvent> events;
+  CApplicationPlayer& player = g_application.GetAppPlayer();
+  if (!player.GetFramePacing(stats, events,
+                             static_cast<unsigned int>(parameterObject["limit"].asUnsignedInteger())))
+    return FailedToExecute;
+
+  if (parameterObject["reset"].asBoolean())
+    player.ResetFramePacing();
+
+  result["refreshrate"] = stats.refreshRate;
+  result["framerate"] = stats.frameRate;
+  result["presented"] = stats.presented;
+  result["late"] = stats.late;
+  result["discarded"] = stats.discarded;
+
+  result["refreshhistogram"] = CVariant(CVariant::VariantTypeArray);
+  for (uint64_t count : stats.refreshHistogram)
+    result["refreshhistogram"].push_back(count);
+
+  result["judderhistogram"] = CVariant(CVariant::VariantTypeArray);
+  for (int i = 0; i < FramePacingStats::JUDDER_BUCKETS; i++)
+  {
+    CVariant bucket(CVariant::VariantTypeObject);
+    bucket["limit"] = FramePacingStats::JudderBucketLimit(i);
+    bucket["count"] = stats.judderHistogram[i];
+    result["judderhistogram"].push_back(bucket);
+  }
+
+  if (parameterObject["format"].asString() == "csv")
+  {
+    result["csv"] = CRenderTelemetry::ToCSV(events);
+  }
+  else
+  {
+    result["events"] = CVariant(CVariant::VariantTypeArray);
+    for (const auto& event : events)
+    {
+      CVariant item(CVariant::VariantTypeObject);
+      item["pts"] = event.pts;
+      item["queuetime"] = event.queueTime;
+      item["presenttime"] = event.presentTime;
+      item["refreshdelta"] = event.refreshDelta;
+      item["dropreason"] = CRenderTelemetry::DropReasonToString(event.dropReason);
+      result["events"].push_back(item);
+    }
+  }
+
+  return OK;
+}
+
 JSONRPC_STATUS CPlayerOperations::Rotate(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
 {
   switch (GetPlayer(parameterObject["playerid"]))
@@ -85,10 +85,25 @@ CCPUInfoOsx::CCPUInfoOsx() : m_resourceCounter(new CPosixResourceCounter())
 
     if (features.find("3DNOWEXT") != std::string::npos)
       m_cpuFeatures |= CPU_FEATURE_3DNOWEXT;
+
+    // the kernel only reports AVX1.0 if it saves the AVX register state
+    if (features.find("AVX1.0") != std::string::npos)
+      m_cpuFeatures |= CPU_FEATURE_AVX;
   }
   else
     m_cpuFeatures |= CPU_FEATURE_MMX;
 
+  buffer = {};
+  bufferLength = buffer.size();
+  if ((m_cpuFeatures & CPU_FEATURE_AVX) &&
+      sysctlbyname("machdep.cpu.leaf7_features", buffer.data(), &bufferLength, nullptr, 0) == 0)
+  {
+    std::string features = buffer.data();
+
+    if (features.find("AVX2") != std::string::npos)
+      m_cpuFeatures |= CPU_FEATURE_AVX2;
+  }
+
   // Set MMX2 when SSE is present as SSE is a superset of MMX2 and Intel doesn't set the MMX2 cap
   if (m_cpuFeatures & CPU_FEATURE_SSE)
     m_cpuFeatures |= CPU_FEATURE_MMX2;
@@ -8,6 +8,7 @@
 
 #include "PlatformFreebsd.h"
 
+#include "cores/AudioEngine/Sinks/AESinkVirtual.h"
 #include "utils/StringUtils.h"
 
 #include "platform/freebsd/OptionalsReg.h"
@@ -99,6 +100,10 @@ bool CPlatformFreebsd::InitStageOne()
   {
     OPTIONALS::SndioRegister();
   }
+  else if (StringUtils::EqualsNoCase(envSink, "VIRTUAL"))
+  {
+    AE::SINK::CAESinkVirtual::Register();
+  }
   else if (StringUtils::EqualsNoCase(envSink, "ALSA+PULSE"))
   {
     OPTIONALS::ALSARegister();
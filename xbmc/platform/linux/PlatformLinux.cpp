@@ -8,6 +8,7 @@
 
 #include "PlatformLinux.h"
 
+#include "cores/AudioEngine/Sinks/AESinkVirtual.h"
 #include "utils/StringUtils.h"
 
 #include "platform/linux/powermanagement/LinuxPowerSyscall.h"
@@ -98,6 +99,10 @@ bool CPlatformLinux::InitStageOne()
   {
     OPTIONALS::SndioRegister();
   }
+  else if (StringUtils::EqualsNoCase(envSink, "VIRTUAL"))
+  {
+    AE::SINK::CAESinkVirtual::Register();
+  }
   else if (StringUtils::EqualsNoCase(envSink, "ALSA+PULSE"))
   {
     OPTIONALS::ALSARegister();
@@ -13,14 +13,17 @@
 #include "interfaces/AnnouncementManager.h"
 #include "messaging/ApplicationMessenger.h"
 #include "pvr/PVRDatabase.h"
+#include "pvr/PVRManagerJobQueue.h"
 #include "pvr/PVRPlaybackState.h"
 #include "pvr/addons/PVRClient.h"
 #include "pvr/addons/PVRClients.h"
 #include "pvr/channels/PVRChannel.h"
 #include "pvr/channels/PVRChannelGroup.h"
 #include "pvr/channels/PVRChannelGroupInternal.h"
+#include "pvr/channels/PVRChannelGroupMember.h"
 #include "pvr/channels/PVRChannelGroups.h"
 #include "pvr/channels/PVRChannelGroupsContainer.h"
+#include "pvr/channels/PVRChannelPrebuffers.h"
 #include "pvr/epg/EpgInfoTag.h"
 #include "pvr/guilib/PVRGUIActions.h"
 #include "pvr/guilib/PVRGUIChannelIconUpdater.h"
@@ -30,13 +33,16 @@
 #include "pvr/recordings/PVRRecordings.h"
 #include "pvr/timers/PVRTimerInfoTag.h"
 #include "pvr/timers/PVRTimers.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
+#include "settings/SettingsComponent.h"
 #include "utils/JobManager.h"
 #include "utils/Stopwatch.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
 #include "utils/log.h"
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <utility>
@@ -46,131 +52,6 @@ using namespace PVR;
 using namespace KODI::MESSAGING;
 using namespace std::chrono_literals;
 
-namespace PVR
-{
-template<typename F>
-class CPVRLambdaJob : public CJob
-{
-public:
-  CPVRLambdaJob() = delete;
-  CPVRLambdaJob(const std::string& type, F&& f) : m_type(type), m_f(std::forward<F>(f)) {}
-
-  bool DoWork() override
-  {
-    m_f();
-    return true;
-  }
-
-  const char* GetType() const override
-  {
-    return m_type.c_str();
-  }
-
-private:
-  std::string m_type;
-  F m_f;
-};
-
-class CPVRManagerJobQueue
-{
-public:
-  CPVRManagerJobQueue() : m_triggerEvent(false) {}
-
-  void Start();
-  void Stop();
-  void Clear();
-
-  template<typename F>
-  void Append(const std::string& type, F&& f)
-  {
-    AppendJob(new CPVRLambdaJob<F>(type, std::forward<F>(f)));
-  }
-
-  void ExecutePendingJobs();
-
-  bool WaitForJobs(unsigned int milliSeconds)
-  {
-    return m_triggerEvent.Wait(std::chrono::milliseconds(milliSeconds));
-  }
-
-
-private:
-  void AppendJob(CJob* job);
-
-  CCriticalSection m_critSection;
-  CEvent m_triggerEvent;
-  std::vector<CJob*> m_pendingUpdates;
-  bool m_bStopped = true;
-};
-} // namespace PVR
-
-void CPVRManagerJobQueue::Start()
-{
-  CSingleLock lock(m_critSection);
-  m_bStopped = false;
-  m_triggerEvent.Set();
-}
-
-void CPVRManagerJobQueue::Stop()
-{
-  CSingleLock lock(m_critSection);
-  m_bStopped = true;
-  m_triggerEvent.Reset();
-}
-
-void CPVRManagerJobQueue::Clear()
-{
-  CSingleLock lock(m_critSection);
-  for (CJob* updateJob : m_pendingUpdates)
-    delete updateJob;
-
-  m_pendingUpdates.clear();
-  m_triggerEvent.Set();
-}
-
-void CPVRManagerJobQueue::AppendJob(CJob* job)
-{
-  CSingleLock lock(m_critSection);
-
-  // check for another pending job of given type...
-  for (CJob* updateJob : m_pendingUpdates)
-  {
-    if (!strcmp(updateJob->GetType(), job->GetType()))
-    {
-      delete job;
-      return;
-    }
-  }
-
-  m_pendingUpdates.push_back(job);
-  m_triggerEvent.Set();
-}
-
-void CPVRManagerJobQueue::ExecutePendingJobs()
-{
-  std::vector<CJob*> pendingUpdates;
-
-  {
-    CSingleLock lock(m_critSection);
-
-    if (m_bStopped)
-      return;
-
-    pendingUpdates = std::move(m_pendingUpdates);
-    m_triggerEvent.Reset();
-  }
-
-  CJob* job = nullptr;
-  while (!pendingUpdates.empty())
-  {
-    job = pendingUpdates.front();
-    pendingUpdates.erase(pendingUpdates.begin());
-
-    job->DoWork();
-    delete job;
-  }
-}
-
 CPVRManager::CPVRManager() :
     CThread("PVRManager"),
     m_channelGroups(new CPVRChannelGroupsContainer),
@@ -179,6 +60,7 @@ CPVRManager::CPVRManager() :
     m_addons(new CPVRClients),
     m_guiInfo(new CPVRGUIInfo),
     m_guiActions(new CPVRGUIActions),
+    m_channelPrebuffers(new CPVRChannelPrebuffers),
     m_pendingUpdates(new CPVRManagerJobQueue),
     m_database(new CPVRDatabase),
     m_parentalTimer(new CStopWatch),
@@ -236,6 +118,12 @@ std::shared_ptr<CPVRChannelGroupsContainer> CPVRManager::ChannelGroups() const
   return m_channelGroups;
 }
 
+std::shared_ptr<CPVRChannelPrebuffers> CPVRManager::ChannelPrebuffers() const
+{
+  CSingleLock lock(m_critSection);
+  return m_channelPrebuffers;
+}
+
 std::shared_ptr<CPVRRecordings> CPVRManager::Recordings() const
 {
   CSingleLock lock(m_critSection);
@@ -315,6 +203,7 @@ void CPVRManager::Clear()
 
   CSingleLock lock(m_critSection);
 
+  m_channelPrebuffers->Stop();
   m_guiInfo.reset();
   m_timers.reset();
   m_recordings.reset();
@@ -334,6 +223,7 @@ void CPVRManager::ResetProperties()
   m_channelGroups.reset(new CPVRChannelGroupsContainer);
   m_recordings.reset(new CPVRRecordings);
   m_timers.reset(new CPVRTimers);
+  m_channelPrebuffers.reset(new CPVRChannelPrebuffers);
   m_guiInfo.reset(new CPVRGUIInfo);
   m_parentalTimer.reset(new CStopWatch);
 }
@@ -480,10 +370,19 @@ void CPVRManager::Process()
   m_addons->Continue();
   m_database->Open();
 
+  m_startupStart = std::chrono::steady_clock::now();
+  m_startupStageStart = m_startupStart;
+
+  /* make the data of the last session available while the clients are starting */
+  m_bWarmStarted = WarmStart();
+
   /* load the pvr data from the db and clients if it's not already loaded */
   XbmcThreads::EndTime progressTimeout(30000); // 30 secs
-  CPVRGUIProgressHandler* progressHandler = new CPVRGUIProgressHandler(g_localizeStrings.Get(19235)); // PVR manager is starting up
-  while (!LoadComponents(progressHandler) && IsInitialising())
+  CPVRGUIProgressHandler* progressHandler =
+      m_bWarmStarted ? nullptr
+                     : new CPVRGUIProgressHandler(
+                           g_localizeStrings.Get(19235)); // PVR manager is starting up
+  while (!LoadComponents(progressHandler) && IsLoading())
   {
     CLog::Log(LOGWARNING, "PVR Manager failed to load data, retrying");
     CThread::Sleep(1000ms);
@@ -501,7 +400,7 @@ void CPVRManager::Process()
     progressHandler = nullptr; // no delete, instance is deleting itself
   }
 
-  if (!IsInitialising())
+  if (!IsLoading())
   {
     CLog::Log(LOGINFO, "PVR Manager: Start aborted");
     return;
@@ -510,16 +409,23 @@ void CPVRManager::Process()
   // Load EPGs from database.
   m_epgContainer.Load();
 
-  // Reinit playbackstate
-  m_playbackState->ReInit();
+  if (!m_bWarmStarted)
+  {
+    // Reinit playbackstate
+    m_playbackState->ReInit();
 
-  m_guiInfo->Start();
-  m_epgContainer.Start();
+    m_guiInfo->Start();
+    m_epgContainer.Start();
+  }
   m_timers->Start();
   m_pendingUpdates->Start();
 
   SetState(ManagerStateStarted);
-  CLog::Log(LOGINFO, "PVR Manager: Started");
+  LogStartupStage("starting background threads");
+  CLog::Log(LOGINFO, "PVR Manager: Started in {} ms",
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                                  m_startupStart)
+                .count());
 
   /* main loop */
   CLog::LogFC(LOGDEBUG, LOGPVR, "PVR Manager entering main loop");
@@ -622,39 +528,97 @@ void CPVRManager::OnWake()
   TriggerTimersUpdate();
 }
 
+bool CPVRManager::WarmStart()
+{
+  if (!CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_bPVRWarmStart)
+    return false;
+
+  if (!m_channelGroups->LoadFromDatabase())
+  {
+    CLog::LogFC(LOGDEBUG, LOGPVR, "No persisted channels found, waiting for the clients");
+    return false;
+  }
+
+  if (!IsInitialising())
+    return false;
+
+  PublishEvent(PVREvent::ChannelGroupsLoaded);
+
+  // Reinit playbackstate
+  m_playbackState->ReInit();
+
+  // Associate the persisted channels with their persisted EPGs, providing now and next right away.
+  // The EPGs are not updated from the clients before the channels were synced (m_bEpgsCreated).
+  m_guiInfo->Start();
+  m_epgContainer.Start();
+  m_channelGroups->CreateChannelEpgs();
+
+  SetState(ManagerStateStarted);
+  LogStartupStage("loading persisted channels, groups and EPG");
+  CLog::Log(LOGINFO, "PVR Manager: Started with persisted data, syncing with clients");
+  return true;
+}
+
+bool CPVRManager::IsLoading() const
+{
+  return m_bWarmStarted ? IsStarted() : IsInitialising();
+}
+
+void CPVRManager::LogStartupStage(const char* stage)
+{
+  const auto now = std::chrono::steady_clock::now();
+  CLog::LogFC(
+      LOGDEBUG, LOGPVR, "Startup stage '{}' took {} ms ({} ms since start)", stage,
+      std::chrono::duration_cast<std::chrono::milliseconds>(now - m_startupStageStart).count(),
+      std::chrono::duration_cast<std::chrono::milliseconds>(now - m_startupStart).count());
+  m_startupStageStart = now;
+}
+
 bool CPVRManager::LoadComponents(CPVRGUIProgressHandler* progressHandler)
 {
   /* load at least one client */
-  while (IsInitialising() && m_addons && !m_addons->HasCreatedClients())
+  while (IsLoading() && m_addons && !m_addons->HasCreatedClients())
     CThread::Sleep(50ms);
 
-  if (!IsInitialising() || !m_addons->HasCreatedClients())
+  if (!IsLoading() || !m_addons->HasCreatedClients())
     return false;
 
   CLog::LogFC(LOGDEBUG, LOGPVR, "PVR Manager found active clients. Continuing startup");
+  LogStartupStage("waiting for clients");
 
   /* load all channels and groups */
   if (progressHandler)
     progressHandler->UpdateProgress(g_localizeStrings.Get(19236), 0); // Loading channels from clients
 
-  if (!m_channelGroups->Load() || !IsInitialising())
+  if (m_bWarmStarted)
+  {
+    // sync the persisted channels and groups with the clients, keeping the instances in use
+    if (!m_channelGroups->Update() || !IsLoading())
+      return false;
+  }
+  else if (!m_channelGroups->Load() || !IsLoading())
+  {
     return false;
+  }
 
   PublishEvent(PVREvent::ChannelGroupsLoaded);
+  LogStartupStage("loading channels and groups");
 
   /* get timers from the backends */
   if (progressHandler)
     progressHandler->UpdateProgress(g_localizeStrings.Get(19237), 50); // Loading timers from clients
 
   m_timers->Load();
+  LogStartupStage("loading timers");
 
   /* get recordings from the backend */
   if (progressHandler)
     progressHandler->UpdateProgress(g_localizeStrings.Get(19238), 75); // Loading recordings from clients
 
   m_recordings->Load();
+  LogStartupStage("loading recordings");
 
-  if (!IsInitialising())
+  if (!IsLoading())
     return false;
 
   /* start the other pvr related update threads */
@@ -730,6 +694,9 @@ void CPVRManager::OnPlaybackStarted(const CFileItemPtr& item)
   m_playbackState->OnPlaybackStarted(item);
   m_guiActions->OnPlaybackStarted(item);
   m_epgContainer.OnPlaybackStarted();
+
+  if (item->IsPVRChannel() && ChannelPrebuffers()->IsEnabled())
+    TriggerChannelsPrebuffer();
 }
 
 void CPVRManager::OnPlaybackStopped(const CFileItemPtr& item)
@@ -740,6 +707,7 @@ void CPVRManager::OnPlaybackStopped(const CFileItemPtr& item)
 
   m_guiActions->OnPlaybackStopped(item);
   m_epgContainer.OnPlaybackStopped();
+  ChannelPrebuffers()->Stop();
 }
 
 void CPVRManager::OnPlaybackEnded(const CFileItemPtr& item)
@@ -778,6 +746,13 @@ void CPVRManager::TriggerRecordingsUpdate()
   });
 }
 
+void CPVRManager::TriggerRecordingsUpdateCoalesced()
+{
+  m_pendingUpdates->AppendCoalesced("pvr-update-recordings", 500ms, 3000ms, [this]() {
+    return Recordings()->Update();
+  });
+}
+
 void CPVRManager::TriggerRecordingsSizeInProgressUpdate()
 {
   m_pendingUpdates->Append("pvr-update-recordings-size", [this]() {
@@ -785,6 +760,51 @@ void CPVRManager::TriggerRecordingsSizeInProgressUpdate()
   });
 }
 
+void CPVRManager::TriggerChannelsPrebuffer()
+{
+  m_pendingUpdates->Append("pvr-prebuffer-channels", [this]() {
+    PrebufferAdjacentChannels();
+  });
+}
+
+void CPVRManager::PrebufferAdjacentChannels()
+{
+  const std::shared_ptr<CPVRChannelPrebuffers> prebuffers = ChannelPrebuffers();
+
+  std::vector<CPVRChannelPrebuffers::Channel> channels;
+  const std::shared_ptr<CPVRChannel> channel = m_playbackState->GetPlayingChannel();
+  const std::shared_ptr<CPVRChannelGroup> group =
+      channel ? m_playbackState->GetActiveChannelGroup(channel->IsRadio()) : nullptr;
+  const std::shared_ptr<CPVRChannelGroupMember> member =
+      group ? group->GetByUniqueID(channel->StorageId()) : nullptr;
+  if (member)
+  {
+    // switching up is more common than switching down
+    for (const auto& adjacent :
+         {group->GetNextChannelGroupMember(member), group->GetPreviousChannelGroupMember(member)})
+    {
+      if (!adjacent || adjacent == member ||
+          std::any_of(channels.begin(), channels.end(),
+                      [&adjacent](const CPVRChannelPrebuffers::Channel& prebuffered) {
+                        return prebuffered.strPath == adjacent->Path();
+                      }))
+        continue;
+
+      const std::shared_ptr<CPVRChannel> adjacentChannel = adjacent->Channel();
+      const std::shared_ptr<CPVRClient> client = GetClient(adjacentChannel->ClientID());
+      if (!client || IsParentalLocked(adjacentChannel))
+        continue;
+
+      CPVRChannelPrebuffers::Channel prebuffered{adjacent->Path(), adjacentChannel->ClientID(), {}};
+      if (client->GetChannelStreamProperties(adjacentChannel, prebuffered.props) ==
+          PVR_ERROR_NO_ERROR)
+        channels.emplace_back(prebuffered);
+    }
+  }
+
+  prebuffers->Prebuffer(channels);
+}
+
 void CPVRManager::TriggerTimersUpdate()
 {
   m_pendingUpdates->Append("pvr-update-timers", [this]() {
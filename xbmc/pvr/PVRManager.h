@@ -18,6 +18,7 @@
 #include "threads/Thread.h"
 #include "utils/EventStream.h"
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -29,6 +30,7 @@ namespace PVR
 {
   class CPVRChannel;
   class CPVRChannelGroup;
+  class CPVRChannelPrebuffers;
   class CPVRChannelGroupsContainer;
   class CPVRClient;
   class CPVRClients;
@@ -127,6 +129,12 @@ namespace PVR
      */
     std::shared_ptr<CPVRClients> Clients() const;
 
+    /*!
+     * @brief Get the streams of the channels opened ahead of time.
+     * @return The prebuffered streams.
+     */
+    std::shared_ptr<CPVRChannelPrebuffers> ChannelPrebuffers() const;
+
     /*!
      * @brief Get the instance of a client that matches the given item.
      * @param item The item containing a PVR recording, a PVR channel, a PVR timer or a PVR EPG event.
@@ -269,11 +277,23 @@ namespace PVR
      */
     void TriggerRecordingsUpdate();
 
+    /*!
+     * @brief Let the background thread update the recordings list once a burst of such requests is
+     * over, so that backends notifying each single change do not cause an update for each of them.
+     */
+    void TriggerRecordingsUpdateCoalesced();
+
     /*!
      * @brief Let the background thread update the size for any in progress recordings.
      */
     void TriggerRecordingsSizeInProgressUpdate();
 
+    /*!
+     * @brief Let the background thread open the streams of the channels next to the playing channel
+     * in the active group, so that switching to them is fast.
+     */
+    void TriggerChannelsPrebuffer();
+
     /*!
      * @brief Let the background thread update the timer list.
      */
@@ -368,6 +388,33 @@ namespace PVR
      */
     bool LoadComponents(CPVRGUIProgressHandler* progressHandler);
 
+    /*!
+     * @brief Make the channels, groups and EPG data persisted by the last session available and
+     * start the PVR manager, before any client is ready. LoadComponents() then syncs the data
+     * with the clients in the background. Until a client is ready, its channels can be browsed
+     * but not played, opening their live streams fails.
+     * @return True if persisted data was found and the PVR manager was started, false otherwise.
+     */
+    bool WarmStart();
+
+    /*!
+     * @brief Check whether the PVR manager is still loading its data. After a warm start, it is
+     * loading while started.
+     * @return True while loading, false otherwise.
+     */
+    bool IsLoading() const;
+
+    /*!
+     * @brief Log the duration of a startup stage.
+     * @param stage The name of the stage.
+     */
+    void LogStartupStage(const char* stage);
+
+    /*!
+     * @brief Open the streams of the channels next to the playing channel in the active group.
+     */
+    void PrebufferAdjacentChannels();
+
     /*!
      * @brief Unload all PVR data (recordings, timers, channelgroups).
      */
@@ -420,6 +467,7 @@ namespace PVR
     std::shared_ptr<CPVRClients> m_addons; /*!< pointer to the pvr addon container */
     std::unique_ptr<CPVRGUIInfo> m_guiInfo; /*!< pointer to the guiinfo data */
     std::shared_ptr<CPVRGUIActions> m_guiActions; /*!< pointer to the pvr gui actions */
+    std::shared_ptr<CPVRChannelPrebuffers> m_channelPrebuffers; /*!< streams of channels opened ahead of time */
     CPVREpgContainer m_epgContainer; /*!< the epg container */
     //@}
 
@@ -428,6 +476,9 @@ namespace PVR
     mutable CCriticalSection m_critSection; /*!< critical section for all changes to this class, except for changes to triggers */
     bool m_bFirstStart = true; /*!< true when the PVR manager was started first, false otherwise */
     bool m_bEpgsCreated = false; /*!< true if epg data for channels has been created */
+    bool m_bWarmStarted = false; /*!< true if started from persisted data, before the clients were ready */
+    std::chrono::steady_clock::time_point m_startupStart; /*!< start of the current startup */
+    std::chrono::steady_clock::time_point m_startupStageStart; /*!< start of the current startup stage */
 
     mutable CCriticalSection m_managerStateMutex;
     ManagerState m_managerState = ManagerStateStopped;
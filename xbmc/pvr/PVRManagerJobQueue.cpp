@@ -0,0 +1,125 @@
+/*
+ *  Copyright (C) 2012-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "PVRManagerJobQueue.h"
+
+#include "threads/SingleLock.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace PVR;
+using namespace std::chrono_literals;
+
+void CPVRManagerJobQueue::Start()
+{
+  CSingleLock lock(m_critSection);
+  m_bStopped = false;
+  m_triggerEvent.Set();
+}
+
+void CPVRManagerJobQueue::Stop()
+{
+  CSingleLock lock(m_critSection);
+  m_bStopped = true;
+  m_triggerEvent.Reset();
+}
+
+void CPVRManagerJobQueue::Clear()
+{
+  CSingleLock lock(m_critSection);
+  for (const auto& updateJob : m_pendingUpdates)
+    delete updateJob.job;
+
+  m_pendingUpdates.clear();
+  m_triggerEvent.Set();
+}
+
+void CPVRManagerJobQueue::AppendJob(CJob* job,
+                                   std::chrono::milliseconds quietPeriod,
+                                   std::chrono::milliseconds maxDelay)
+{
+  CSingleLock lock(m_critSection);
+
+  const auto now = std::chrono::steady_clock::now();
+
+  // check for another pending job of given type...
+  for (auto& updateJob : m_pendingUpdates)
+  {
+    if (!strcmp(updateJob.job->GetType(), job->GetType()))
+    {
+      // ...and postpone it, unless it waited long enough already
+      updateJob.due = std::min(now + quietPeriod, updateJob.latest);
+      delete job;
+      m_triggerEvent.Set();
+      return;
+    }
+  }
+
+  m_pendingUpdates.push_back({job, now + quietPeriod, now + std::max(quietPeriod, maxDelay)});
+  m_triggerEvent.Set();
+}
+
+void CPVRManagerJobQueue::ExecutePendingJobs()
+{
+  std::vector<CJob*> pendingUpdates;
+
+  {
+    CSingleLock lock(m_critSection);
+
+    if (m_bStopped)
+      return;
+
+    const auto now = std::chrono::steady_clock::now();
+    for (auto it = m_pendingUpdates.begin(); it != m_pendingUpdates.end();)
+    {
+      if ((*it).due <= now)
+      {
+        pendingUpdates.emplace_back((*it).job);
+        it = m_pendingUpdates.erase(it);
+      }
+      else
+        ++it;
+    }
+    m_triggerEvent.Reset();
+  }
+
+  CJob* job = nullptr;
+  while (!pendingUpdates.empty())
+  {
+    job = pendingUpdates.front();
+    pendingUpdates.erase(pendingUpdates.begin());
+
+    job->DoWork();
+    delete job;
+  }
+}
+
+bool CPVRManagerJobQueue::WaitForJobs(unsigned int milliSeconds)
+{
+  auto timeout = std::chrono::milliseconds(milliSeconds);
+
+  {
+    // wake up in time for postponed jobs
+    CSingleLock lock(m_critSection);
+    const auto now = std::chrono::steady_clock::now();
+    for (const auto& updateJob : m_pendingUpdates)
+    {
+      if (m_bStopped)
+        break;
+
+      if (updateJob.due <= now)
+        return true;
+
+      const auto dueIn = std::chrono::duration_cast<std::chrono::milliseconds>(updateJob.due - now);
+      timeout = std::min(timeout, dueIn + 1ms);
+    }
+  }
+
+  return m_triggerEvent.Wait(timeout);
+}
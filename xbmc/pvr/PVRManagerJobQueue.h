@@ -0,0 +1,99 @@
+/*
+ *  Copyright (C) 2012-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/Job.h"
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace PVR
+{
+template<typename F>
+class CPVRLambdaJob : public CJob
+{
+public:
+  CPVRLambdaJob() = delete;
+  CPVRLambdaJob(const std::string& type, F&& f) : m_type(type), m_f(std::forward<F>(f)) {}
+
+  bool DoWork() override
+  {
+    m_f();
+    return true;
+  }
+
+  const char* GetType() const override
+  {
+    return m_type.c_str();
+  }
+
+private:
+  std::string m_type;
+  F m_f;
+};
+
+/*!
+ * @brief The jobs the PVR manager's main loop executes. Only one job of each type is pending, jobs
+ * appended while one of the same type is pending are dropped.
+ */
+class CPVRManagerJobQueue
+{
+public:
+  CPVRManagerJobQueue() : m_triggerEvent(false) {}
+
+  void Start();
+  void Stop();
+  void Clear();
+
+  template<typename F>
+  void Append(const std::string& type, F&& f)
+  {
+    AppendJob(new CPVRLambdaJob<F>(type, std::forward<F>(f)), std::chrono::milliseconds(0),
+              std::chrono::milliseconds(0));
+  }
+
+  /*!
+   * @brief Append a job that runs once no job of the same type was appended for the given quiet
+   * period, but no later than the given maximum delay after the first of them.
+   */
+  template<typename F>
+  void AppendCoalesced(const std::string& type,
+                       std::chrono::milliseconds quietPeriod,
+                       std::chrono::milliseconds maxDelay,
+                       F&& f)
+  {
+    AppendJob(new CPVRLambdaJob<F>(type, std::forward<F>(f)), quietPeriod, maxDelay);
+  }
+
+  void ExecutePendingJobs();
+
+  bool WaitForJobs(unsigned int milliSeconds);
+
+private:
+  struct PendingJob
+  {
+    CJob* job;
+    std::chrono::steady_clock::time_point due;
+    std::chrono::steady_clock::time_point latest;
+  };
+
+  void AppendJob(CJob* job,
+                 std::chrono::milliseconds quietPeriod,
+                 std::chrono::milliseconds maxDelay);
+
+  CCriticalSection m_critSection;
+  CEvent m_triggerEvent;
+  std::vector<PendingJob> m_pendingUpdates;
+  bool m_bStopped = true;
+};
+} // namespace PVR
@@ -1789,10 +1789,8 @@ void CPVRClient::cb_transfer_recording_entry(void* kodiInstance,
     }
 
     // transfer this entry to the recordings container
-    const std::shared_ptr<CPVRRecording> transferRecording =
-        std::make_shared<CPVRRecording>(*recording, client->GetID());
     CPVRRecordings* recordings = static_cast<CPVRRecordings*>(handle->dataAddress);
-    recordings->UpdateFromClient(transferRecording, *client);
+    recordings->UpdateFromClient(*recording, *client);
   });
 }
 
@@ -1884,8 +1882,8 @@ void CPVRClient::cb_trigger_timer_update(void* kodiInstance)
 void CPVRClient::cb_trigger_recording_update(void* kodiInstance)
 {
   HandleAddonCallback(__func__, kodiInstance, [&](CPVRClient* client) {
-    // update recordings in the next iteration of the pvrmanager's main loop
-    CServiceBroker::GetPVRManager().TriggerRecordingsUpdate();
+    // update recordings in the pvrmanager's main loop once the backend's changes settled
+    CServiceBroker::GetPVRManager().TriggerRecordingsUpdateCoalesced();
   });
 }
 
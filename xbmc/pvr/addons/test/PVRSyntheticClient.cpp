@@ -0,0 +1,455 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "PVRSyntheticClient.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace PVR;
+
+namespace
+{
+constexpr time_t SLOT_DURATION = 60 * 60; // each slot is split into two events
+
+constexpr unsigned int TIMER_TYPE_ONCE_EPG = 1;
+constexpr unsigned int TIMER_TYPE_EPG_RULE = 2;
+
+enum RandomKind
+{
+  KIND_EVENT,
+  KIND_RECORDING,
+  KIND_TIMER,
+};
+
+const std::vector<std::string> WORDS = {
+    "News",    "Weather", "Star",   "Trek",    "Doctor",  "Who",     "Football", "Tennis",
+    "Cooking", "Garden",  "Crime",  "Scene",   "Family",  "Quiz",    "Night",    "Morning",
+    "Show",    "Live",    "World",  "Nature",  "Ocean",   "Planet",  "History",  "Science",
+    "Music",   "Concert", "Comedy", "Drama",   "Movie",   "Classic", "Kids",     "Cartoon",
+    "Sports",  "Racing",  "Travel", "Journey", "Talk",    "Report",  "Special",  "Finale"};
+
+const int GENRES[] = {EPG_EVENT_CONTENTMASK_MOVIEDRAMA, EPG_EVENT_CONTENTMASK_NEWSCURRENTAFFAIRS,
+                      EPG_EVENT_CONTENTMASK_SHOW, EPG_EVENT_CONTENTMASK_SPORTS,
+                      EPG_EVENT_CONTENTMASK_CHILDRENYOUTH};
+
+void Copy(char* dest, size_t size, const std::string& src)
+{
+  strncpy(dest, src.c_str(), size - 1);
+  dest[size - 1] = '\0';
+}
+
+std::string GetGroupName(unsigned int iGroup)
+{
+  return "Group " + std::to_string(iGroup + 1);
+}
+} // unnamed namespace
+
+void CPVRSyntheticClient::Attach(AddonInstance_PVR& instance)
+{
+  KodiToAddonFuncTable_PVR& toAddon = *instance.toAddon;
+  toAddon.addonInstance = this;
+  toAddon.GetCapabilities = GetCapabilities;
+  toAddon.GetBackendName = GetBackendName;
+  toAddon.GetBackendVersion = GetBackendVersion;
+  toAddon.GetBackendHostname = GetBackendHostname;
+  toAddon.GetConnectionString = GetConnectionString;
+  toAddon.GetChannelsAmount = GetChannelsAmount;
+  toAddon.GetChannels = GetChannels;
+  toAddon.GetChannelGroupsAmount = GetChannelGroupsAmount;
+  toAddon.GetChannelGroups = GetChannelGroups;
+  toAddon.GetChannelGroupMembers = GetChannelGroupMembers;
+  toAddon.GetEPGForChannel = GetEPGForChannel;
+  toAddon.GetRecordingsAmount = GetRecordingsAmount;
+  toAddon.GetRecordings = GetRecordings;
+  toAddon.GetTimerTypes = GetTimerTypes;
+  toAddon.GetTimersAmount = GetTimersAmount;
+  toAddon.GetTimers = GetTimers;
+}
+
+void CPVRSyntheticClient::GetEpgEvent(unsigned int iChannelUid,
+                                      unsigned int iEvent,
+                                      EpgEvent& event) const
+{
+  const uint64_t random = GetRandom(KIND_EVENT, iChannelUid, iEvent);
+
+  // the first event of a slot lasts 15, 30 or 45 minutes, the second one the rest of the slot
+  const time_t slotStart = m_settings.epgStart + (iEvent / 2) * SLOT_DURATION;
+  const uint64_t slotRandom = GetRandom(KIND_EVENT, iChannelUid, iEvent & ~1u);
+  const time_t split = slotStart + 15 * 60 * (1 + slotRandom % 3);
+
+  event.strTitle = GetWord(random) + " " + GetWord(random >> 8);
+  event.strPlot = "The " + GetWord(random >> 16) + " of " + GetWord(random >> 24) + " and " +
+                  GetWord(random >> 32) + ".";
+  event.strSeriesLink.clear();
+  if ((random >> 40) % 4 == 0)
+    event.strSeriesLink = "series-" + std::to_string((random >> 42) % 100);
+
+  EPG_TAG& tag = event.tag;
+  tag = {};
+  tag.iUniqueBroadcastId = iEvent + 1;
+  tag.iUniqueChannelId = iChannelUid;
+  tag.strTitle = event.strTitle.c_str();
+  tag.startTime = (iEvent % 2 == 0) ? slotStart : split;
+  tag.endTime = (iEvent % 2 == 0) ? split : slotStart + SLOT_DURATION;
+  tag.strPlot = event.strPlot.c_str();
+  tag.iGenreType = GENRES[(random >> 48) % (sizeof(GENRES) / sizeof(GENRES[0]))];
+  tag.iSeriesNumber = EPG_TAG_INVALID_SERIES_EPISODE;
+  tag.iEpisodeNumber = EPG_TAG_INVALID_SERIES_EPISODE;
+  tag.iEpisodePartNumber = EPG_TAG_INVALID_SERIES_EPISODE;
+  tag.strSeriesLink = event.strSeriesLink.c_str();
+}
+
+const std::string& CPVRSyntheticClient::GetWord(uint64_t iIndex)
+{
+  return WORDS[iIndex % WORDS.size()];
+}
+
+CPVRSyntheticClient& CPVRSyntheticClient::Get(const AddonInstance_PVR* instance)
+{
+  return *static_cast<CPVRSyntheticClient*>(instance->toAddon->addonInstance);
+}
+
+PVR_ERROR CPVRSyntheticClient::GetCapabilities(const AddonInstance_PVR* instance,
+                                               PVR_ADDON_CAPABILITIES* capabilities)
+{
+  Get(instance).OnCall();
+
+  *capabilities = {};
+  capabilities->bSupportsEPG = true;
+  capabilities->bSupportsTV = true;
+  capabilities->bSupportsRecordings = true;
+  capabilities->bSupportsTimers = true;
+  capabilities->bSupportsChannelGroups = true;
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR CPVRSyntheticClient::GetBackendName(const AddonInstance_PVR* instance,
+                                              char* str,
+                                              int size)
+{
+  Get(instance).OnCall();
+  Copy(str, size, "Synthetic backend");
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR CPVRSyntheticClient::GetBackendVersion(const AddonInstance_PVR* instance,
+                                                 char* str,
+                                                 int size)
+{
+  Get(instance).OnCall();
+  Copy(str, size, "1.0.0");
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR CPVRSyntheticClient::GetBackendHostname(const AddonInstance_PVR* instance,
+                                                  char* str,
+                                                  int size)
+{
+  Get(instance).OnCall();
+  Copy(str, size, "");
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR CPVRSyntheticClient::GetConnectionString(const AddonInstance_PVR* instance,
+                                                   char* str,
+                                                   int size)
+{
+  Get(instance).OnCall();
+  Copy(str, size, "synthetic");
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR CPVRSyntheticClient::GetChannelsAmount(const AddonInstance_PVR* instance, int* amount)
+{
+  CPVRSyntheticClient& client = Get(instance);
+  client.OnCall();
+  *amount = static_cast<int>(client.m_settings.iChannels);
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR CPVRSyntheticClient::GetChannels(const AddonInstance_PVR* instance,
+                                           ADDON_HANDLE handle,
+                                           bool radio)
+{
+  CPVRSyntheticClient& client = Get(instance);
+  client.OnCall();
+  if (radio)
+    return PVR_ERROR_NO_ERROR;
+
+  PVR_CHANNEL channel;
+  for (unsigned int i = 1; i <= client.m_settings.iChannels; ++i)
+  {
+    channel = {};
+    channel.iUniqueId = i;
+    channel.iChannelNumber = i;
+    Copy(channel.strChannelName, sizeof(channel.strChannelName), "Channel " + std::to_string(i));
+    channel.iOrder = static_cast<int>(i);
+
+    client.OnEntry();
+    instance->toKodi->TransferChannelEntry(instance->toKodi->kodiInstance, handle, &channel);
+  }
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR CPVRSyntheticClient::GetChannelGroupsAmount(const AddonInstance_PVR* instance,
+                                                      int* amount)
+{
+  CPVRSyntheticClient& client = Get(instance);
+  client.OnCall();
+  *amount = static_cast<int>(client.m_settings.iGroups);
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR CPVRSyntheticClient::GetChannelGroups(const AddonInstance_PVR* instance,
+                                                ADDON_HANDLE handle,
+                                                bool radio)
+{
+  CPVRSyntheticClient& client = Get(instance);
+  client.OnCall();
+  if (radio)
+    return PVR_ERROR_NO_ERROR;
+
+  PVR_CHANNEL_GROUP group;
+  for (unsigned int i = 0; i < client.m_settings.iGroups; ++i)
+  {
+    group = {};
+    Copy(group.strGroupName, sizeof(group.strGroupName), GetGroupName(i));
+    group.iPosition = i + 1;
+
+    client.OnEntry();
+    instance->toKodi->TransferChannelGroup(instance->toKodi->kodiInstance, handle, &group);
+  }
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR CPVRSyntheticClient::GetChannelGroupMembers(const AddonInstance_PVR* instance,
+                                                      ADDON_HANDLE handle,
+                                                      const PVR_CHANNEL_GROUP* group)
+{
+  CPVRSyntheticClient& client = Get(instance);
+  client.OnCall();
+  if (group->bIsRadio || client.m_settings.iGroups == 0)
+    return PVR_ERROR_NO_ERROR;
+
+  unsigned int iGroup = 0;
+  while (iGroup < client.m_settings.iGroups && GetGroupName(iGroup) != group->strGroupName)
+    ++iGroup;
+
+  PVR_CHANNEL_GROUP_MEMBER member;
+  for (unsigned int i = iGroup; i < client.m_settings.iChannels; i += client.m_settings.iGroups)
+  {
+    member = {};
+    Copy(member.strGroupName, sizeof(member.strGroupName), group->strGroupName);
+    member.iChannelUniqueId = i + 1;
+    member.iChannelNumber = i / client.m_settings.iGroups + 1;
+    member.iOrder = static_cast<int>(member.iChannelNumber);
+
+    client.OnEntry();
+    instance->toKodi->TransferChannelGroupMember(instance->toKodi->kodiInstance, handle, &member);
+  }
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR CPVRSyntheticClient::GetEPGForChannel(const AddonInstance_PVR* instance,
+                                                ADDON_HANDLE handle,
+                                                int iChannelUid,
+                                                time_t start,
+                                                time_t end)
+{
+  CPVRSyntheticClient& client = Get(instance);
+  client.OnCall();
+  if (iChannelUid < 1 || static_cast<unsigned int>(iChannelUid) > client.m_settings.iChannels)
+    return PVR_ERROR_INVALID_PARAMETERS;
+
+  // the events of the slots overlapping the requested time frame
+  const time_t firstSlot = std::max<time_t>(0, start - client.m_settings.epgStart) / SLOT_DURATION;
+  const unsigned int iFirst = static_cast<unsigned int>(
+      std::min<time_t>(firstSlot * 2, client.m_settings.iEpgEventsPerChannel));
+
+  EpgEvent event;
+  for (unsigned int i = iFirst; i < client.m_settings.iEpgEventsPerChannel; ++i)
+  {
+    client.GetEpgEvent(iChannelUid, i, event);
+    if (event.tag.startTime >= end)
+      break;
+
+    if (event.tag.endTime > start)
+    {
+      client.OnEntry();
+      instance->toKodi->TransferEpgEntry(instance->toKodi->kodiInstance, handle, &event.tag);
+    }
+  }
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR CPVRSyntheticClient::GetRecordingsAmount(const AddonInstance_PVR* instance,
+                                                   bool deleted,
+                                                   int* amount)
+{
+  CPVRSyntheticClient& client = Get(instance);
+  client.OnCall();
+  *amount = deleted ? 0 : static_cast<int>(client.m_settings.iRecordings);
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR CPVRSyntheticClient::GetRecordings(const AddonInstance_PVR* instance,
+                                             ADDON_HANDLE handle,
+                                             bool deleted)
+{
+  CPVRSyntheticClient& client = Get(instance);
+  client.OnCall();
+  if (deleted)
+    return PVR_ERROR_NO_ERROR;
+
+  // one reused for all recordings, like the add-ons do
+  PVR_RECORDING recording;
+  for (unsigned int i = 0; i < client.m_settings.iRecordings; ++i)
+  {
+    const uint64_t random = client.GetRandom(KIND_RECORDING, 0, i);
+
+    recording = {};
+    Copy(recording.strRecordingId, sizeof(recording.strRecordingId),
+         "rec" + std::to_string(i + 1));
+    Copy(recording.strTitle, sizeof(recording.strTitle),
+         GetWord(random) + " " + GetWord(random >> 8));
+    Copy(recording.strPlot, sizeof(recording.strPlot),
+         "The " + GetWord(random >> 16) + " of " + GetWord(random >> 24) + ".");
+    Copy(recording.strDirectory, sizeof(recording.strDirectory), GetWord(random));
+    recording.iSeriesNumber = PVR_RECORDING_INVALID_SERIES_EPISODE;
+    recording.iEpisodeNumber = PVR_RECORDING_INVALID_SERIES_EPISODE;
+    recording.recordingTime = client.m_settings.epgStart - (i + 1) * SLOT_DURATION;
+    recording.iDuration = static_cast<int>(SLOT_DURATION);
+    recording.iLifetime = 99;
+    recording.iGenreType = GENRES[(random >> 32) % (sizeof(GENRES) / sizeof(GENRES[0]))];
+    if (client.m_settings.iChannels > 0)
+      recording.iChannelUid = static_cast<int>((random >> 40) % client.m_settings.iChannels) + 1;
+    recording.channelType = PVR_RECORDING_CHANNEL_TYPE_TV;
+    recording.sizeInBytes = 1024 * 1024 * 1024;
+
+    client.OnEntry();
+    instance->toKodi->TransferRecordingEntry(instance->toKodi->kodiInstance, handle, &recording);
+  }
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR CPVRSyntheticClient::GetTimerTypes(const AddonInstance_PVR* instance,
+                                             PVR_TIMER_TYPE types[],
+                                             int* size)
+{
+  Get(instance).OnCall();
+  if (*size < 2)
+    return PVR_ERROR_INVALID_PARAMETERS;
+
+  types[0] = {};
+  types[0].iId = TIMER_TYPE_ONCE_EPG;
+  types[0].iAttributes = PVR_TIMER_TYPE_REQUIRES_EPG_TAG_ON_CREATE |
+                         PVR_TIMER_TYPE_SUPPORTS_CHANNELS | PVR_TIMER_TYPE_SUPPORTS_START_TIME |
+                         PVR_TIMER_TYPE_SUPPORTS_END_TIME;
+
+  types[1] = {};
+  types[1].iId = TIMER_TYPE_EPG_RULE;
+  types[1].iAttributes = PVR_TIMER_TYPE_IS_REPEATING | PVR_TIMER_TYPE_SUPPORTS_TITLE_EPG_MATCH |
+                         PVR_TIMER_TYPE_SUPPORTS_CHANNELS | PVR_TIMER_TYPE_SUPPORTS_ANY_CHANNEL |
+                         PVR_TIMER_TYPE_SUPPORTS_WEEKDAYS;
+
+  *size = 2;
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR CPVRSyntheticClient::GetTimersAmount(const AddonInstance_PVR* instance, int* amount)
+{
+  CPVRSyntheticClient& client = Get(instance);
+  client.OnCall();
+  *amount = static_cast<int>(client.m_settings.iTimers);
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR CPVRSyntheticClient::GetTimers(const AddonInstance_PVR* instance, ADDON_HANDLE handle)
+{
+  CPVRSyntheticClient& client = Get(instance);
+  client.OnCall();
+
+  PVR_TIMER timer;
+  EpgEvent event;
+  for (unsigned int i = 0; i < client.m_settings.iTimers; ++i)
+  {
+    const uint64_t random = client.GetRandom(KIND_TIMER, 0, i);
+
+    timer = {};
+    timer.iClientIndex = i + 1;
+    timer.state = PVR_TIMER_STATE_SCHEDULED;
+    timer.iWeekdays = PVR_WEEKDAY_NONE;
+    timer.iLifetime = 99;
+
+    if (i % 2 == 1)
+    {
+      // an epg search rule for a word of the titles, on any channel
+      timer.iTimerType = TIMER_TYPE_EPG_RULE;
+      timer.iClientChannelUid = PVR_TIMER_ANY_CHANNEL;
+      timer.bStartAnyTime = true;
+      timer.bEndAnyTime = true;
+      timer.iWeekdays = PVR_WEEKDAY_ALLDAYS;
+      Copy(timer.strTitle, sizeof(timer.strTitle), GetWord(random));
+      Copy(timer.strEpgSearchString, sizeof(timer.strEpgSearchString), GetWord(random));
+    }
+    else if (client.m_settings.iChannels > 0 && client.m_settings.iEpgEventsPerChannel > 0)
+    {
+      // a recording of an epg event
+      const unsigned int iChannelUid =
+          static_cast<unsigned int>(random % client.m_settings.iChannels) + 1;
+      client.GetEpgEvent(iChannelUid,
+                         static_cast<unsigned int>((random >> 32) %
+                                                   client.m_settings.iEpgEventsPerChannel),
+                         event);
+
+      timer.iTimerType = TIMER_TYPE_ONCE_EPG;
+      timer.iClientChannelUid = static_cast<int>(iChannelUid);
+      timer.startTime = event.tag.startTime;
+      timer.endTime = event.tag.endTime;
+      timer.iEpgUid = event.tag.iUniqueBroadcastId;
+      Copy(timer.strTitle, sizeof(timer.strTitle), event.strTitle);
+    }
+    else
+      continue;
+
+    client.OnEntry();
+    instance->toKodi->TransferTimerEntry(instance->toKodi->kodiInstance, handle, &timer);
+  }
+  return PVR_ERROR_NO_ERROR;
+}
+
+void CPVRSyntheticClient::OnCall()
+{
+  ++m_iCalls;
+  if (m_settings.callLatency.count() > 0)
+    std::this_thread::sleep_for(m_settings.callLatency);
+}
+
+void CPVRSyntheticClient::OnEntry()
+{
+  ++m_iEntries;
+  if (m_settings.entryLatency.count() > 0)
+    std::this_thread::sleep_for(m_settings.entryLatency);
+}
+
+uint64_t CPVRSyntheticClient::GetRandom(unsigned int iKind,
+                                        unsigned int iId,
+                                        unsigned int iIndex) const
+{
+  // splitmix64 of the seed and the entry
+  uint64_t x = (static_cast<uint64_t>(m_settings.iSeed) << 32) ^
+               (static_cast<uint64_t>(iKind) << 60) ^ (static_cast<uint64_t>(iId) << 24) ^ iIndex;
+  x += 0x9E3779B97F4A7C15ull;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+  return x ^ (x >> 31);
+}
@@ -0,0 +1,145 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "addons/kodi-dev-kit/include/kodi/c-api/addon-instance/pvr.h"
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <stdint.h>
+#include <string>
+
+namespace PVR
+{
+/*!
+ * @brief A synthetic PVR backend, implementing the add-on side of the PVR add-on API.
+ *
+ * Channels, channel groups, epg events, recordings and timers are generated from their index and
+ * a seed, so any number of them is delivered without being stored and the same settings always
+ * deliver the same data. Every call and every transferred entry can be delayed to mimic the
+ * latency of a real backend. Data is transferred through the toKodi functions of the instance the
+ * client is attached to, i.e. the instance of a CPVRClient or one filled in by a test.
+ *
+ * Implemented are the capabilities, backend information, channels, channel groups, epg,
+ * recordings, timer types and timers. The other add-on functions are left unset.
+ */
+class CPVRSyntheticClient
+{
+public:
+  struct Settings
+  {
+    unsigned int iChannels = 100;
+    unsigned int iGroups = 10; //!< Channel n is a member of group n % iGroups
+    unsigned int iEpgEventsPerChannel = 48 * 7; //!< Two events per hour
+    time_t epgStart = 1609459200; //!< The start of the first event of each channel
+    unsigned int iRecordings = 1000;
+    unsigned int iTimers = 50; //!< Every second timer is an epg search rule
+    std::chrono::microseconds callLatency{0}; //!< Delay of each call
+    std::chrono::microseconds entryLatency{0}; //!< Delay of each transferred entry
+    unsigned int iSeed = 1;
+  };
+
+  explicit CPVRSyntheticClient(const Settings& settings) : m_settings(settings) {}
+
+  /*!
+   * @brief Set the add-on functions of an instance to the ones of this client.
+   * @param instance The instance, its toKodi functions receive the transferred data.
+   */
+  void Attach(AddonInstance_PVR& instance);
+
+  /*!
+   * @brief Get the settings of this client.
+   * @return The settings.
+   */
+  const Settings& GetSettings() const { return m_settings; }
+
+  /*!
+   * @brief Get the number of add-on functions called.
+   * @return The number of calls.
+   */
+  unsigned int GetCalls() const { return m_iCalls; }
+
+  /*!
+   * @brief Get the number of entries transferred.
+   * @return The number of entries.
+   */
+  unsigned int GetEntries() const { return m_iEntries; }
+
+  //! An epg event, its tag points to its strings
+  struct EpgEvent
+  {
+    EPG_TAG tag = {};
+    std::string strTitle;
+    std::string strPlot;
+    std::string strSeriesLink;
+  };
+
+  /*!
+   * @brief Get the epg event of a channel delivered for the given index, without transferring it.
+   * @param iChannelUid The unique id of the channel.
+   * @param iEvent The index of the event.
+   * @param event The event.
+   */
+  void GetEpgEvent(unsigned int iChannelUid, unsigned int iEvent, EpgEvent& event) const;
+
+  /*!
+   * @brief Get a word of the titles the client generates.
+   * @param iIndex The index of the word, any number.
+   * @return The word.
+   */
+  static const std::string& GetWord(uint64_t iIndex);
+
+private:
+  CPVRSyntheticClient(const CPVRSyntheticClient&) = delete;
+  CPVRSyntheticClient& operator=(const CPVRSyntheticClient&) = delete;
+
+  static CPVRSyntheticClient& Get(const AddonInstance_PVR* instance);
+
+  static PVR_ERROR GetCapabilities(const AddonInstance_PVR* instance,
+                                   PVR_ADDON_CAPABILITIES* capabilities);
+  static PVR_ERROR GetBackendName(const AddonInstance_PVR* instance, char* str, int size);
+  static PVR_ERROR GetBackendVersion(const AddonInstance_PVR* instance, char* str, int size);
+  static PVR_ERROR GetBackendHostname(const AddonInstance_PVR* instance, char* str, int size);
+  static PVR_ERROR GetConnectionString(const AddonInstance_PVR* instance, char* str, int size);
+  static PVR_ERROR GetChannelsAmount(const AddonInstance_PVR* instance, int* amount);
+  static PVR_ERROR GetChannels(const AddonInstance_PVR* instance, ADDON_HANDLE handle, bool radio);
+  static PVR_ERROR GetChannelGroupsAmount(const AddonInstance_PVR* instance, int* amount);
+  static PVR_ERROR GetChannelGroups(const AddonInstance_PVR* instance,
+                                    ADDON_HANDLE handle,
+                                    bool radio);
+  static PVR_ERROR GetChannelGroupMembers(const AddonInstance_PVR* instance,
+                                          ADDON_HANDLE handle,
+                                          const PVR_CHANNEL_GROUP* group);
+  static PVR_ERROR GetEPGForChannel(const AddonInstance_PVR* instance,
+                                    ADDON_HANDLE handle,
+                                    int iChannelUid,
+                                    time_t start,
+                                    time_t end);
+  static PVR_ERROR GetRecordingsAmount(const AddonInstance_PVR* instance,
+                                       bool deleted,
+                                       int* amount);
+  static PVR_ERROR GetRecordings(const AddonInstance_PVR* instance,
+                                 ADDON_HANDLE handle,
+                                 bool deleted);
+  static PVR_ERROR GetTimerTypes(const AddonInstance_PVR* instance,
+                                 PVR_TIMER_TYPE types[],
+                                 int* size);
+  static PVR_ERROR GetTimersAmount(const AddonInstance_PVR* instance, int* amount);
+  static PVR_ERROR GetTimers(const AddonInstance_PVR* instance, ADDON_HANDLE handle);
+
+  void OnCall();
+  void OnEntry();
+  uint64_t GetRandom(unsigned int iKind, unsigned int iId, unsigned int iIndex) const;
+
+  const Settings m_settings;
+  std::atomic<unsigned int> m_iCalls{0};
+  std::atomic<unsigned int> m_iEntries{0};
+};
+} // namespace PVR
@@ -0,0 +1,550 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "XBDateTime.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "pvr/addons/PVRClient.h"
+#include "pvr/addons/test/PVRSyntheticClient.h"
+#include "pvr/channels/PVRChannel.h"
+#include "pvr/epg/Epg.h"
+#include "pvr/epg/EpgChannelData.h"
+#include "pvr/epg/EpgDatabase.h"
+#include "pvr/epg/EpgInfoTag.h"
+#include "pvr/epg/EpgSearchData.h"
+#include "pvr/recordings/PVRRecordings.h"
+#include "pvr/timers/PVRTimerRuleIndex.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/StringUtils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PVR;
+
+namespace
+{
+const std::string DB_NAME = "TestPVRSyntheticClient";
+constexpr int CLIENT_ID = 1;
+constexpr time_t HOUR = 60 * 60;
+const CDateTimeSpan ONE_SECOND(0, 0, 0, 1);
+
+double GetMilliseconds(const std::chrono::steady_clock::time_point& start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+//! The recordings of the synthetic client, fetched through the add-on API like CPVRClient does
+class CTestRecordings : public CPVRRecordings
+{
+public:
+  explicit CTestRecordings(AddonInstance_PVR& instance) : m_instance(instance) {}
+
+protected:
+  void GetRecordingsFromClients(std::vector<int>& failedClients) override
+  {
+    ADDON_HANDLE_STRUCT handle = {};
+    handle.dataAddress = this;
+    if (m_instance.toAddon->GetRecordings(&m_instance, &handle, false) != PVR_ERROR_NO_ERROR)
+      failedClients.emplace_back(CLIENT_ID);
+  }
+
+  void PublishEvent(PVREvent /* event */) override {}
+
+private:
+  AddonInstance_PVR& m_instance;
+};
+
+//! The Kodi side of the add-on API. Feeds what a client transfers into the epgs, epg database,
+//! recordings and timer rule index the PVR manager builds on startup and on epg updates.
+class TestPVRSyntheticClient : public ::testing::Test
+{
+protected:
+  TestPVRSyntheticClient() : m_recordings(m_instance)
+  {
+    m_instance.props = &m_props;
+    m_instance.toKodi = &m_toKodi;
+    m_instance.toAddon = &m_toAddon;
+
+    m_toKodi.kodiInstance = this;
+    m_toKodi.TransferChannelEntry = TransferChannelEntry;
+    m_toKodi.TransferChannelGroup = TransferChannelGroup;
+    m_toKodi.TransferChannelGroupMember = TransferChannelGroupMember;
+    m_toKodi.TransferEpgEntry = TransferEpgEntry;
+    m_toKodi.TransferRecordingEntry = TransferRecordingEntry;
+    m_toKodi.TransferTimerEntry = TransferTimerEntry;
+
+    // Events ended longer ago than the past days to display are dropped by the epg
+    time_t now = 0;
+    CDateTime::GetUTCDateTime().GetAsTime(now);
+    m_epgStart = now - now % HOUR;
+  }
+
+  void SetUp() override
+  {
+    m_settings.type = "sqlite3";
+    m_settings.host = CSpecialProtocol::TranslatePath("special://temp/");
+    XFILE::CFile::Delete(m_settings.host + DB_NAME + ".db");
+
+    m_database = std::make_shared<CPVREpgDatabase>();
+    ASSERT_TRUE(m_database->Connect(DB_NAME, m_settings, true));
+  }
+
+  void TearDown() override
+  {
+    m_epgs.clear();
+    m_database->Close();
+    XFILE::CFile::Delete(m_settings.host + DB_NAME + ".db");
+  }
+
+  CPVRSyntheticClient::Settings CreateSettings() const
+  {
+    CPVRSyntheticClient::Settings settings;
+    settings.epgStart = m_epgStart;
+    return settings;
+  }
+
+  // The calls of the PVR manager's startup: capabilities, channels, groups, recordings, timers
+  void Startup(CPVRSyntheticClient& client)
+  {
+    client.Attach(m_instance);
+
+    PVR_ADDON_CAPABILITIES capabilities = {};
+    ASSERT_EQ(m_toAddon.GetCapabilities(&m_instance, &capabilities), PVR_ERROR_NO_ERROR);
+    m_capabilities = capabilities;
+    char strName[PVR_ADDON_NAME_STRING_LENGTH];
+    ASSERT_EQ(m_toAddon.GetBackendName(&m_instance, strName, sizeof(strName)), PVR_ERROR_NO_ERROR);
+
+    ADDON_HANDLE_STRUCT handle = {};
+    ASSERT_EQ(m_toAddon.GetChannels(&m_instance, &handle, false), PVR_ERROR_NO_ERROR);
+
+    if (capabilities.bSupportsChannelGroups)
+    {
+      ASSERT_EQ(m_toAddon.GetChannelGroups(&m_instance, &handle, false), PVR_ERROR_NO_ERROR);
+      for (const std::string& strGroup : m_groups)
+      {
+        PVR_CHANNEL_GROUP group = {};
+        strncpy(group.strGroupName, strGroup.c_str(), sizeof(group.strGroupName) - 1);
+        ASSERT_EQ(m_toAddon.GetChannelGroupMembers(&m_instance, &handle, &group),
+                  PVR_ERROR_NO_ERROR);
+      }
+    }
+
+    m_recordings.Update();
+
+    std::unique_ptr<PVR_TIMER_TYPE[]> types(new PVR_TIMER_TYPE[PVR_ADDON_TIMERTYPE_ARRAY_SIZE]);
+    int iTypes = PVR_ADDON_TIMERTYPE_ARRAY_SIZE;
+    ASSERT_EQ(m_toAddon.GetTimerTypes(&m_instance, types.get(), &iTypes), PVR_ERROR_NO_ERROR);
+    for (int i = 0; i < iTypes; ++i)
+      m_timerTypes[types[i].iId] = types[i].iAttributes;
+
+    ASSERT_EQ(m_toAddon.GetTimers(&m_instance, &handle), PVR_ERROR_NO_ERROR);
+    IndexTimerRules();
+  }
+
+  // Get the epg of all channels for the given time frame and persist it, like an epg update
+  void UpdateEpg(time_t start, time_t end)
+  {
+    TransferEpg(start, end);
+    PersistEpgs();
+  }
+
+  void TransferEpg(time_t start, time_t end)
+  {
+    for (const auto& channel : m_channels)
+    {
+      std::shared_ptr<CPVREpg>& epg = m_epgs[channel->UniqueID()];
+      if (!epg)
+        epg = std::make_shared<CPVREpg>(channel->UniqueID(), channel->ChannelName(), "client",
+                                        std::make_shared<CPVREpgChannelData>(*channel),
+                                        m_database);
+
+      ADDON_HANDLE_STRUCT handle = {};
+      handle.dataAddress = epg.get();
+      ASSERT_EQ(m_toAddon.GetEPGForChannel(&m_instance, &handle, channel->UniqueID(), start, end),
+                PVR_ERROR_NO_ERROR);
+    }
+  }
+
+  // Write the changed epgs to the database, the way the epg container does
+  void PersistEpgs()
+  {
+    for (const auto& epg : m_epgs)
+    {
+      epg.second->Lock();
+      if (epg.second->NeedsSave())
+      {
+        m_database->Lock();
+        epg.second->QueuePersistQuery(m_database);
+        m_database->CommitDeleteQueries();
+        m_database->CommitInsertQueries();
+        m_database->Unlock();
+      }
+      epg.second->Unlock();
+    }
+  }
+
+  // The tags of all channels for a page of the guide, the way the guide's grid model fetches them
+  size_t BuildGrid(time_t gridStart, time_t gridEnd, time_t pageStart, time_t pageEnd) const
+  {
+    size_t iTags = 0;
+    for (const auto& epg : m_epgs)
+      iTags += epg.second
+                   ->GetTimeline(CDateTime(gridStart), CDateTime(gridEnd),
+                                 CDateTime(pageStart) + ONE_SECOND, CDateTime(pageEnd))
+                   .size();
+    return iTags;
+  }
+
+  // The tags of all channels matching a search term in their title or description
+  size_t Search(const std::string& strTerm) const
+  {
+    PVREpgSearchData searchData;
+    searchData.m_strSearchTerm = strTerm;
+    searchData.m_bSearchInDescription = true;
+    searchData.m_startDateTime = CDateTime(m_epgStart - 24 * HOUR);
+    searchData.m_endDateTime = CDateTime(m_epgStart + 365 * 24 * HOUR);
+    return m_database->GetEpgTags(searchData).size();
+  }
+
+  // Index the epg-based timer rules, as CPVRTimerRuleIndex::GetRule() does for a timer rule. The
+  // rules of the synthetic client start and end at any time.
+  void IndexTimerRules()
+  {
+    m_timerRules.Clear();
+    for (size_t i = 0; i < m_timers.size(); ++i)
+    {
+      const PVR_TIMER& timer = m_timers[i];
+      const uint64_t iAttributes = m_timerTypes[timer.iTimerType];
+      if (!(iAttributes & PVR_TIMER_TYPE_IS_REPEATING) ||
+          !(iAttributes & PVR_TIMER_TYPE_SUPPORTS_TITLE_EPG_MATCH))
+        continue;
+
+      CPVRTimerRuleIndex::Rule rule;
+      rule.iClientId = CLIENT_ID;
+      if (timer.iClientChannelUid != PVR_TIMER_ANY_CHANNEL)
+        rule.iClientChannelUid = timer.iClientChannelUid;
+      rule.strTitleSearch = timer.strEpgSearchString;
+      if (iAttributes & PVR_TIMER_TYPE_SUPPORTS_WEEKDAYS)
+        rule.iWeekdays = timer.iWeekdays;
+
+      m_timerRules.Add(rule, i);
+    }
+  }
+
+  // The timer rules that may match the tags of all channels, looked up after an epg update
+  size_t MatchTimerRules() const
+  {
+    size_t iCandidates = 0;
+    std::vector<size_t> ruleIds;
+    for (const auto& epg : m_epgs)
+    {
+      for (const auto& tag : epg.second->GetTags())
+      {
+        m_timerRules.GetCandidates(*tag, ruleIds);
+        iCandidates += ruleIds.size();
+      }
+    }
+    return iCandidates;
+  }
+
+  size_t GetEpgMemoryUsage() const
+  {
+    size_t iBytes = 0;
+    for (const auto& epg : m_epgs)
+      iBytes += epg.second->GetMemoryUsage();
+    return iBytes;
+  }
+
+  int64_t GetDatabaseSize() const
+  {
+    struct __stat64 buffer = {};
+    if (XFILE::CFile::Stat(m_settings.host + DB_NAME + ".db", &buffer) != 0)
+      return 0;
+    return buffer.st_size;
+  }
+
+  static TestPVRSyntheticClient& Get(void* kodiInstance)
+  {
+    return *static_cast<TestPVRSyntheticClient*>(kodiInstance);
+  }
+
+  static void TransferChannelEntry(void* kodiInstance,
+                                   const ADDON_HANDLE handle,
+                                   const PVR_CHANNEL* channel)
+  {
+    Get(kodiInstance).m_channels.emplace_back(std::make_shared<CPVRChannel>(*channel, CLIENT_ID));
+  }
+
+  static void TransferChannelGroup(void* kodiInstance,
+                                   const ADDON_HANDLE handle,
+                                   const PVR_CHANNEL_GROUP* group)
+  {
+    Get(kodiInstance).m_groups.emplace_back(group->strGroupName);
+  }
+
+  static void TransferChannelGroupMember(void* kodiInstance,
+                                         const ADDON_HANDLE handle,
+                                         const PVR_CHANNEL_GROUP_MEMBER* member)
+  {
+    Get(kodiInstance).m_groupMembers[member->strGroupName].emplace_back(member->iChannelUniqueId);
+  }
+
+  static void TransferEpgEntry(void* kodiInstance, const ADDON_HANDLE handle, const EPG_TAG* tag)
+  {
+    static_cast<CPVREpg*>(handle->dataAddress)->UpdateEntry(tag, CLIENT_ID);
+  }
+
+  static void TransferRecordingEntry(void* kodiInstance,
+                                     const ADDON_HANDLE handle,
+                                     const PVR_RECORDING* recording)
+  {
+    static_cast<CPVRRecordings*>(handle->dataAddress)
+        ->UpdateFromClient(*recording, CLIENT_ID, Get(kodiInstance).m_capabilities);
+  }
+
+  static void TransferTimerEntry(void* kodiInstance,
+                                 const ADDON_HANDLE handle,
+                                 const PVR_TIMER* timer)
+  {
+    Get(kodiInstance).m_timers.emplace_back(*timer);
+  }
+
+  AddonInstance_PVR m_instance = {};
+  AddonProperties_PVR m_props = {};
+  AddonToKodiFuncTable_PVR m_toKodi = {};
+  KodiToAddonFuncTable_PVR m_toAddon = {};
+  CPVRClientCapabilities m_capabilities;
+  time_t m_epgStart = 0;
+
+  DatabaseSettings m_settings;
+  std::shared_ptr<CPVREpgDatabase> m_database;
+
+  std::vector<std::shared_ptr<CPVRChannel>> m_channels;
+  std::vector<std::string> m_groups;
+  std::map<std::string, std::vector<unsigned int>> m_groupMembers;
+  std::map<unsigned int, std::shared_ptr<CPVREpg>> m_epgs;
+  CTestRecordings m_recordings;
+  std::map<unsigned int, uint64_t> m_timerTypes;
+  std::vector<PVR_TIMER> m_timers;
+  CPVRTimerRuleIndex m_timerRules;
+};
+} // namespace
+
+TEST_F(TestPVRSyntheticClient, DeliversConfiguredData)
+{
+  CPVRSyntheticClient::Settings settings = CreateSettings();
+  settings.iChannels = 20;
+  settings.iGroups = 4;
+  settings.iEpgEventsPerChannel = 48;
+  settings.iRecordings = 30;
+  settings.iTimers = 10;
+  CPVRSyntheticClient client(settings);
+  Startup(client);
+
+  ASSERT_EQ(m_channels.size(), 20u);
+  EXPECT_EQ(m_channels.front()->ChannelName(), "Channel 1");
+  ASSERT_EQ(m_groups.size(), 4u);
+  for (const std::string& strGroup : m_groups)
+  {
+    ASSERT_EQ(m_groupMembers[strGroup].size(), 5u);
+    for (unsigned int iUid : m_groupMembers[strGroup])
+    {
+      EXPECT_GE(iUid, 1u);
+      EXPECT_LE(iUid, 20u);
+    }
+  }
+  EXPECT_EQ(m_recordings.GetNumTVRecordings(), 30);
+  ASSERT_EQ(m_timers.size(), 10u);
+  EXPECT_EQ(m_timerRules.Size(), 5u);
+
+  // the whole epg, events follow each other without gaps
+  UpdateEpg(0, settings.epgStart + 365 * 24 * HOUR);
+  ASSERT_EQ(m_epgs.size(), 20u);
+  for (const auto& epg : m_epgs)
+  {
+    const std::vector<std::shared_ptr<CPVREpgInfoTag>> tags = epg.second->GetTags();
+    ASSERT_EQ(tags.size(), 48u);
+    EXPECT_EQ(tags.front()->StartAsUTC(), CDateTime(settings.epgStart));
+    EXPECT_EQ(tags.back()->EndAsUTC(), CDateTime(settings.epgStart + 24 * HOUR));
+    for (size_t i = 1; i < tags.size(); ++i)
+      EXPECT_EQ(tags[i - 1]->EndAsUTC(), tags[i]->StartAsUTC());
+  }
+
+  for (size_t i = 0; i < m_timers.size(); ++i)
+  {
+    const PVR_TIMER& timer = m_timers[i];
+    if (timer.iClientChannelUid == PVR_TIMER_ANY_CHANNEL)
+    {
+      // an epg search rule is a candidate for each event whose title contains its search string
+      const std::string strSearch = StringUtils::ToLower(timer.strEpgSearchString);
+      ASSERT_NE(strSearch, "");
+      size_t iMatches = 0;
+      std::vector<size_t> ruleIds;
+      for (const auto& epg : m_epgs)
+      {
+        for (const auto& tag : epg.second->GetTags())
+        {
+          if (StringUtils::ToLower(tag->Title()).find(strSearch) == std::string::npos)
+            continue;
+
+          m_timerRules.GetCandidates(*tag, ruleIds);
+          EXPECT_NE(std::find(ruleIds.begin(), ruleIds.end(), i), ruleIds.end());
+          ++iMatches;
+        }
+      }
+      EXPECT_GT(iMatches, 0u);
+      continue;
+    }
+
+    // the timers recording a single event refer to events of the epg
+    const std::shared_ptr<CPVREpgInfoTag> tag =
+        m_epgs[timer.iClientChannelUid]->GetTagByBroadcastId(timer.iEpgUid);
+    ASSERT_NE(tag, nullptr);
+    EXPECT_EQ(tag->StartAsUTC(), CDateTime(timer.startTime));
+    EXPECT_EQ(tag->Title(), timer.strTitle);
+  }
+}
+
+TEST_F(TestPVRSyntheticClient, EpgTimeFrame)
+{
+  CPVRSyntheticClient::Settings settings = CreateSettings();
+  settings.iChannels = 3;
+  CPVRSyntheticClient client(settings);
+  Startup(client);
+
+  // two slots of two events each, the event ending at the start is not delivered
+  UpdateEpg(settings.epgStart + 3 * HOUR, settings.epgStart + 5 * HOUR);
+  for (const auto& epg : m_epgs)
+  {
+    ASSERT_EQ(epg.second->GetTags().size(), 4u);
+    EXPECT_EQ(epg.second->GetFirstDate(), CDateTime(settings.epgStart + 3 * HOUR));
+    EXPECT_EQ(epg.second->GetLastDate(), CDateTime(settings.epgStart + 5 * HOUR));
+  }
+
+  // the same data is delivered for the same settings, other data for another seed
+  CPVRSyntheticClient same(settings);
+  settings.iSeed = 2;
+  CPVRSyntheticClient other(settings);
+
+  CPVRSyntheticClient::EpgEvent event;
+  CPVRSyntheticClient::EpgEvent sameEvent;
+  CPVRSyntheticClient::EpgEvent otherEvent;
+  size_t iDifferent = 0;
+  for (unsigned int i = 0; i < 100; ++i)
+  {
+    client.GetEpgEvent(1, i, event);
+    same.GetEpgEvent(1, i, sameEvent);
+    other.GetEpgEvent(1, i, otherEvent);
+    EXPECT_EQ(event.strTitle, sameEvent.strTitle);
+    EXPECT_EQ(event.tag.startTime, sameEvent.tag.startTime);
+    if (event.strTitle != otherEvent.strTitle)
+      ++iDifferent;
+  }
+  EXPECT_GT(iDifferent, 50u);
+}
+
+TEST_F(TestPVRSyntheticClient, InjectedLatency)
+{
+  CPVRSyntheticClient::Settings settings = CreateSettings();
+  settings.iChannels = 10;
+  settings.callLatency = std::chrono::milliseconds(20);
+  settings.entryLatency = std::chrono::milliseconds(2);
+  CPVRSyntheticClient client(settings);
+  client.Attach(m_instance);
+
+  const auto start = std::chrono::steady_clock::now();
+  ADDON_HANDLE_STRUCT handle = {};
+  ASSERT_EQ(m_toAddon.GetChannels(&m_instance, &handle, false), PVR_ERROR_NO_ERROR);
+  EXPECT_GE(GetMilliseconds(start), 20.0 + 10 * 2.0);
+
+  EXPECT_EQ(m_channels.size(), 10u);
+  EXPECT_EQ(client.GetCalls(), 1u);
+  EXPECT_EQ(client.GetEntries(), 10u);
+}
+
+// 500 channels with a week of epg, 5000 recordings and 200 timers. Takes a few minutes, run with
+// --gtest_also_run_disabled_tests. The timings and sizes are reported as test properties.
+TEST_F(TestPVRSyntheticClient, DISABLED_Benchmark)
+{
+  CPVRSyntheticClient::Settings settings = CreateSettings();
+  settings.iChannels = 500;
+  settings.iGroups = 20;
+  settings.iEpgEventsPerChannel = 48 * 7;
+  settings.iRecordings = 5000;
+  settings.iTimers = 200;
+  CPVRSyntheticClient client(settings);
+
+  auto start = std::chrono::steady_clock::now();
+  Startup(client);
+  const double startupMs = GetMilliseconds(start);
+
+  // the epg keeps the transferred events in memory until they are persisted
+  const time_t epgEnd = settings.epgStart + 7 * 24 * HOUR;
+  const size_t iEpgMemoryBefore = GetEpgMemoryUsage();
+  const int64_t iDatabaseSizeBefore = GetDatabaseSize();
+  start = std::chrono::steady_clock::now();
+  TransferEpg(settings.epgStart, epgEnd);
+  const size_t iEpgMemory = GetEpgMemoryUsage() - iEpgMemoryBefore;
+  PersistEpgs();
+  const double epgMs = GetMilliseconds(start);
+  const int64_t iDatabaseSize = GetDatabaseSize() - iDatabaseSizeBefore;
+
+  // a refresh delivers all events again, unchanged
+  start = std::chrono::steady_clock::now();
+  UpdateEpg(settings.epgStart, epgEnd);
+  const double epgRefreshMs = GetMilliseconds(start);
+
+  start = std::chrono::steady_clock::now();
+  m_recordings.Update();
+  const double recordingsRefreshMs = GetMilliseconds(start);
+
+  // scrolling the guide through the week, three hours visible at a time
+  start = std::chrono::steady_clock::now();
+  size_t iGridTags = 0;
+  size_t iGrids = 0;
+  for (time_t page = settings.epgStart; page < epgEnd; page += 3 * HOUR, ++iGrids)
+    iGridTags += BuildGrid(settings.epgStart, epgEnd, page, page + 3 * HOUR);
+  const double gridMs = GetMilliseconds(start) / iGrids;
+
+  start = std::chrono::steady_clock::now();
+  const size_t iMatches = Search(CPVRSyntheticClient::GetWord(3));
+  const double searchMs = GetMilliseconds(start);
+
+  start = std::chrono::steady_clock::now();
+  const size_t iCandidates = MatchTimerRules();
+  const double timerRulesMs = GetMilliseconds(start);
+
+  RecordProperty("startup_ms", static_cast<int>(startupMs));
+  RecordProperty("epg_update_ms", static_cast<int>(epgMs));
+  RecordProperty("epg_refresh_ms", static_cast<int>(epgRefreshMs));
+  RecordProperty("recordings_refresh_ms", static_cast<int>(recordingsRefreshMs));
+  RecordProperty("grid_us", static_cast<int>(gridMs * 1000));
+  RecordProperty("search_ms", static_cast<int>(searchMs));
+  RecordProperty("timer_rules_ms", static_cast<int>(timerRulesMs));
+  RecordProperty("epg_memory_kb", static_cast<int>(iEpgMemory / 1024));
+  RecordProperty("epg_database_kb", static_cast<int>(iDatabaseSize / 1024));
+
+  EXPECT_EQ(m_channels.size(), settings.iChannels);
+  EXPECT_EQ(m_recordings.GetNumTVRecordings(), static_cast<int>(settings.iRecordings));
+  EXPECT_EQ(m_timers.size(), settings.iTimers);
+  EXPECT_GT(iDatabaseSize, 0);
+
+  // each page shows at least the two events of each of its three slots, for all channels
+  EXPECT_GE(iGridTags, iGrids * m_channels.size() * 6);
+  EXPECT_GT(iMatches, 0u);
+  EXPECT_GT(iCandidates, 0u);
+}
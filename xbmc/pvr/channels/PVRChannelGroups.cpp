@@ -329,23 +329,26 @@ bool CPVRChannelGroups::LoadFromDb()
   return true;
 }
 
-bool CPVRChannelGroups::Load()
+bool CPVRChannelGroups::LoadFromDatabase()
 {
-  {
-    CSingleLock lock(m_critSection);
+  CSingleLock lock(m_critSection);
+
+  // Remove previous contents
+  Clear();
 
-    // Remove previous contents
-    Clear();
+  // Ensure we have an internal group. It is important that the internal group is created before
+  // loading contents from database and that it gets inserted in front of m_groups. Look at
+  // GetGroupAll() implementation to see why.
+  const auto internalGroup = std::make_shared<CPVRChannelGroupInternal>(m_bRadio);
+  m_groups.emplace_back(internalGroup);
 
-    // Ensure we have an internal group. It is important that the internal group is created before
-    // loading contents from database and that it gets inserted in front of m_groups. Look at
-    // GetGroupAll() implementation to see why.
-    const auto internalGroup = std::make_shared<CPVRChannelGroupInternal>(m_bRadio);
-    m_groups.emplace_back(internalGroup);
+  // Load groups, group members and channels from database
+  return LoadFromDb();
+}
 
-    // Load groups, group members and channels from database
-    LoadFromDb();
-  }
+bool CPVRChannelGroups::Load()
+{
+  LoadFromDatabase();
 
   // Load data from clients and sync with local data
   Update();
@@ -43,6 +43,13 @@ namespace PVR
      */
     bool Load();
 
+    /*!
+     * @brief Load this container's contents persisted in the database, without asking the PVR
+     * clients. Call Update() to sync them with the clients.
+     * @return True if it was loaded successfully, false if not.
+     */
+    bool LoadFromDatabase();
+
     /*!
      * @brief Create a channel group matching the given type.
      * @param iType The type for the group.
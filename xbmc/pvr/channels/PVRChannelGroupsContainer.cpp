@@ -56,6 +56,17 @@ bool CPVRChannelGroupsContainer::Load()
   return m_bLoaded;
 }
 
+bool CPVRChannelGroupsContainer::LoadFromDatabase()
+{
+  Unload();
+
+  if (!m_groupsTV->LoadFromDatabase() || !m_groupsRadio->LoadFromDatabase())
+    return false;
+
+  m_bLoaded = m_groupsTV->GetGroupAll()->Size() > 0 || m_groupsRadio->GetGroupAll()->Size() > 0;
+  return m_bLoaded;
+}
+
 bool CPVRChannelGroupsContainer::Loaded() const
 {
   return m_bLoaded;
@@ -39,6 +39,13 @@ namespace PVR
      */
     bool Load();
 
+    /*!
+     * @brief Load the channel groups and channels persisted by the last session, without asking
+     * the PVR clients. Use Update() to sync them with the clients.
+     * @return True if any persisted channel was loaded, false otherwise.
+     */
+    bool LoadFromDatabase();
+
     /*!
      * @brief Checks whether groups were already loaded.
      * @return True if groups were successfully loaded, false otherwise.
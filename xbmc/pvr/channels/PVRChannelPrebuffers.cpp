@@ -0,0 +1,478 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "PVRChannelPrebuffers.h"
+
+#include "ServiceBroker.h"
+#include "URL.h"
+#include "addons/kodi-dev-kit/include/kodi/c-api/addon-instance/inputstream/stream_constants.h"
+#include "filesystem/File.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/SettingsComponent.h"
+#include "utils/JobManager.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <map>
+#include <utility>
+
+using namespace PVR;
+using namespace std::chrono_literals;
+
+namespace
+{
+constexpr int READ_CHUNK_SIZE = 64 * 1024;
+
+class CPVRFileStreamSource : public IPVRStreamSource
+{
+public:
+  bool Open(const std::string& url) override
+  {
+    // Buffering is done by the prebuffer, the file cache would read ahead at full speed
+    return m_file.Open(url, XFILE::READ_TRUNCATED | XFILE::READ_CHUNKED | XFILE::READ_NO_CACHE);
+  }
+
+  int Read(uint8_t* buf, int size) override
+  {
+    const ssize_t iRead = m_file.Read(buf, size);
+    return iRead < 0 ? -1 : static_cast<int>(iRead);
+  }
+
+  void Close() override { m_file.Close(); }
+
+private:
+  XFILE::CFile m_file;
+};
+} // unnamed namespace
+
+CPVRStreamPrebuffer::CPVRStreamPrebuffer(std::unique_ptr<IPVRStreamSource> source,
+                                         const std::string& url,
+                                         size_t iBufferSize,
+                                         unsigned int iMaxBytesPerSecond)
+  : CThread("PVRPrebuffer"),
+    m_source(std::move(source)),
+    m_url(url),
+    m_iMaxBytesPerSecond(iMaxBytesPerSecond),
+    m_buffer(std::max(iBufferSize, static_cast<size_t>(READ_CHUNK_SIZE)))
+{
+}
+
+CPVRStreamPrebuffer::~CPVRStreamPrebuffer()
+{
+  Stop();
+  StopThread(true);
+}
+
+void CPVRStreamPrebuffer::Start()
+{
+  Create();
+}
+
+void CPVRStreamPrebuffer::Stop()
+{
+  StopThread(false);
+  m_condition.notifyAll();
+}
+
+bool CPVRStreamPrebuffer::IsPrimed() const
+{
+  CSingleLock lock(m_critSection);
+  return m_bOpened && !m_bFailed && m_iBufferedSize > 0;
+}
+
+bool CPVRStreamPrebuffer::HasFailed() const
+{
+  CSingleLock lock(m_critSection);
+  return m_bFailed;
+}
+
+void CPVRStreamPrebuffer::HandOver()
+{
+  CSingleLock lock(m_critSection);
+  m_bHandedOver = true;
+}
+
+int CPVRStreamPrebuffer::Read(uint8_t* buf, int size)
+{
+  CSingleLock lock(m_critSection);
+  while (m_iBufferedSize == 0)
+  {
+    if (m_bFailed)
+      return -1;
+
+    if (m_bEof || m_bStop)
+      return 0;
+
+    m_condition.wait(lock, 100ms);
+  }
+
+  const size_t iSize = std::min(static_cast<size_t>(std::max(size, 0)), m_iBufferedSize);
+  for (size_t iCopied = 0; iCopied < iSize;)
+  {
+    const size_t iChunk = std::min(iSize - iCopied, m_buffer.size() - m_iReadPos);
+    std::copy_n(m_buffer.begin() + m_iReadPos, iChunk, buf + iCopied);
+    m_iReadPos = (m_iReadPos + iChunk) % m_buffer.size();
+    iCopied += iChunk;
+  }
+  m_iBufferedSize -= iSize;
+
+  // the buffer may have been too full to read more
+  m_condition.notifyAll();
+  return static_cast<int>(iSize);
+}
+
+void CPVRStreamPrebuffer::SetMaxBytesPerSecond(unsigned int iMaxBytesPerSecond)
+{
+  CSingleLock lock(m_critSection);
+  m_iMaxBytesPerSecond = iMaxBytesPerSecond;
+}
+
+unsigned int CPVRStreamPrebuffer::GetMaxBytesPerSecond() const
+{
+  CSingleLock lock(m_critSection);
+  return m_iMaxBytesPerSecond;
+}
+
+size_t CPVRStreamPrebuffer::GetBufferedSize() const
+{
+  CSingleLock lock(m_critSection);
+  return m_iBufferedSize;
+}
+
+uint64_t CPVRStreamPrebuffer::GetDroppedSize() const
+{
+  CSingleLock lock(m_critSection);
+  return m_iDroppedSize;
+}
+
+void CPVRStreamPrebuffer::Process()
+{
+  const bool bOpened = m_source->Open(m_url);
+  {
+    CSingleLock lock(m_critSection);
+    m_bOpened = bOpened;
+    m_bFailed = !bOpened;
+  }
+  m_condition.notifyAll();
+
+  if (!bOpened)
+  {
+    CLog::LogF(LOGDEBUG, "Unable to open stream {}", CURL::GetRedacted(m_url));
+    return;
+  }
+
+  std::vector<uint8_t> chunk(READ_CHUNK_SIZE);
+  auto start = std::chrono::steady_clock::now();
+  uint64_t iThrottledSize = 0;
+  unsigned int iMaxBytesPerSecond = 0;
+
+  while (!m_bStop)
+  {
+    bool bHandedOver;
+    {
+      CSingleLock lock(m_critSection);
+      // once handed over, wait for the reader to make room instead of dropping data
+      while (m_bHandedOver && m_buffer.size() - m_iBufferedSize < chunk.size() && !m_bStop)
+        m_condition.wait(lock, 100ms);
+
+      bHandedOver = m_bHandedOver;
+
+      // the rate changes with the number of streams sharing the bandwidth
+      if (iMaxBytesPerSecond != m_iMaxBytesPerSecond)
+      {
+        iMaxBytesPerSecond = m_iMaxBytesPerSecond;
+        start = std::chrono::steady_clock::now();
+        iThrottledSize = 0;
+      }
+    }
+
+    if (m_bStop)
+      break;
+
+    if (!bHandedOver && iMaxBytesPerSecond > 0)
+    {
+      const auto due =
+          start + std::chrono::milliseconds(iThrottledSize * 1000 / iMaxBytesPerSecond);
+      const auto now = std::chrono::steady_clock::now();
+      if (due > now)
+      {
+        Sleep(std::min(std::chrono::duration_cast<std::chrono::milliseconds>(due - now), 100ms));
+        continue;
+      }
+    }
+
+    const int iRead = m_source->Read(chunk.data(), static_cast<int>(chunk.size()));
+    {
+      CSingleLock lock(m_critSection);
+      if (iRead <= 0)
+      {
+        m_bEof = iRead == 0;
+        m_bFailed = iRead < 0;
+      }
+      else
+      {
+        Append(chunk.data(), iRead);
+        if (!m_bHandedOver)
+          iThrottledSize += iRead;
+      }
+    }
+    m_condition.notifyAll();
+
+    if (iRead <= 0)
+      break;
+  }
+
+  m_source->Close();
+}
+
+void CPVRStreamPrebuffer::Append(const uint8_t* data, size_t size)
+{
+  // keep the most recent data
+  if (size > m_buffer.size())
+  {
+    m_iDroppedSize += size - m_buffer.size();
+    data += size - m_buffer.size();
+    size = m_buffer.size();
+  }
+
+  const size_t iFree = m_buffer.size() - m_iBufferedSize;
+  if (size > iFree)
+  {
+    const size_t iDrop = size - iFree;
+    m_iReadPos = (m_iReadPos + iDrop) % m_buffer.size();
+    m_iBufferedSize -= iDrop;
+    m_iDroppedSize += iDrop;
+  }
+
+  size_t iWritePos = (m_iReadPos + m_iBufferedSize) % m_buffer.size();
+  for (size_t iCopied = 0; iCopied < size;)
+  {
+    const size_t iChunk = std::min(size - iCopied, m_buffer.size() - iWritePos);
+    std::copy_n(data + iCopied, iChunk, m_buffer.begin() + iWritePos);
+    iWritePos = (iWritePos + iChunk) % m_buffer.size();
+    iCopied += iChunk;
+  }
+  m_iBufferedSize += size;
+}
+
+namespace
+{
+CPVRChannelPrebuffers::Budget GetBudgetFromSettings()
+{
+  const std::shared_ptr<CAdvancedSettings> settings =
+      CServiceBroker::GetSettingsComponent()->GetAdvancedSettings();
+
+  CPVRChannelPrebuffers::Budget budget;
+  if (settings->m_bPVRPrebufferChannels)
+  {
+    budget.iMaxStreamsPerClient = settings->m_iPVRPrebufferMaxStreams;
+    budget.iMaxBytesPerSecond = settings->m_iPVRPrebufferMaxKBps * 1024;
+    budget.iBufferSize = settings->m_iPVRPrebufferSizeKB * 1024;
+  }
+  return budget;
+}
+} // unnamed namespace
+
+CPVRChannelPrebuffers::CPVRChannelPrebuffers()
+  : CPVRChannelPrebuffers(GetBudgetFromSettings(),
+                          []() { return std::make_unique<CPVRFileStreamSource>(); })
+{
+}
+
+CPVRChannelPrebuffers::CPVRChannelPrebuffers(const Budget& budget, SourceFactory sourceFactory)
+  : m_budget(budget), m_sourceFactory(std::move(sourceFactory))
+{
+}
+
+CPVRChannelPrebuffers::~CPVRChannelPrebuffers()
+{
+  for (auto& entry : m_entries)
+    entry.stream->Stop();
+
+  if (m_reserved)
+    m_reserved->stream->Stop();
+}
+
+bool CPVRChannelPrebuffers::IsEnabled() const
+{
+  return m_budget.iMaxStreamsPerClient > 0 && m_budget.iBufferSize > 0;
+}
+
+bool CPVRChannelPrebuffers::CanPrebuffer(const CPVRStreamProperties& props)
+{
+  // Streams played by input stream add-ons or by ffmpeg are not read through the file layer
+  for (const auto& prop : props)
+  {
+    if (prop.first == STREAM_PROPERTY_INPUTSTREAM)
+      return false;
+  }
+
+  const std::string url = props.GetStreamURL();
+  const std::string mime = props.GetStreamMimeType();
+  if (StringUtils::EqualsNoCase(mime, "application/vnd.apple.mpegurl") ||
+      StringUtils::EqualsNoCase(mime, "application/x-mpegURL") ||
+      URIUtils::HasExtension(url, ".m3u8"))
+    return false;
+
+  return URIUtils::IsProtocol(url, "http") || URIUtils::IsProtocol(url, "https");
+}
+
+void CPVRChannelPrebuffers::Prebuffer(const std::vector<Channel>& channels)
+{
+  if (!IsEnabled())
+    return;
+
+  std::vector<Entry> stopped;
+  {
+    CSingleLock lock(m_critSection);
+
+    // the player did not take the reserved stream
+    if (m_reserved)
+    {
+      stopped.emplace_back(std::move(*m_reserved));
+      m_reserved.reset();
+    }
+
+    std::vector<Entry> entries;
+    std::map<int, unsigned int> streamsPerClient;
+    for (const auto& channel : channels)
+    {
+      if (streamsPerClient[channel.iClientId] >= m_budget.iMaxStreamsPerClient ||
+          !CanPrebuffer(channel.props))
+        continue;
+
+      ++streamsPerClient[channel.iClientId];
+
+      // keep streams already prebuffering
+      const std::string url = channel.props.GetStreamURL();
+      const auto it = std::find_if(m_entries.begin(), m_entries.end(), [&](const Entry& entry) {
+        return entry.channel.strPath == channel.strPath && entry.stream->GetURL() == url &&
+               !entry.stream->HasFailed();
+      });
+
+      if (it != m_entries.end())
+      {
+        entries.emplace_back(std::move(*it));
+        m_entries.erase(it);
+      }
+      else
+        entries.push_back({channel, nullptr});
+    }
+
+    // the bandwidth is shared by all streams, the ones kept included
+    const unsigned int iMaxBytesPerSecond =
+        entries.empty() ? 0 : m_budget.iMaxBytesPerSecond / entries.size();
+    for (auto& entry : entries)
+    {
+      if (entry.stream)
+      {
+        entry.stream->SetMaxBytesPerSecond(iMaxBytesPerSecond);
+        continue;
+      }
+
+      entry.stream = std::make_shared<CPVRStreamPrebuffer>(
+          m_sourceFactory(), entry.channel.props.GetStreamURL(), m_budget.iBufferSize,
+          iMaxBytesPerSecond);
+      entry.stream->Start();
+      CLog::LogFC(LOGDEBUG, LOGPVR, "Prebuffering channel {}", entry.channel.strPath);
+    }
+
+    std::move(m_entries.begin(), m_entries.end(), std::back_inserter(stopped));
+    m_entries = std::move(entries);
+  }
+
+  StopEntries(stopped);
+}
+
+void CPVRChannelPrebuffers::Stop()
+{
+  std::vector<Entry> stopped;
+  {
+    CSingleLock lock(m_critSection);
+    stopped = std::move(m_entries);
+    m_entries.clear();
+  }
+
+  StopEntries(stopped);
+}
+
+bool CPVRChannelPrebuffers::Reserve(const std::string& strPath, CPVRStreamProperties& props)
+{
+  std::vector<Entry> stopped;
+  bool bReserved = false;
+  {
+    CSingleLock lock(m_critSection);
+
+    const auto it = std::find_if(m_entries.begin(), m_entries.end(),
+                                 [&strPath](const Entry& entry) {
+                                   return entry.channel.strPath == strPath;
+                                 });
+    if (it == m_entries.end() || !it->stream->IsPrimed())
+      return false;
+
+    // a reserved stream that was not taken is of no use anymore
+    if (m_reserved)
+      stopped.emplace_back(std::move(*m_reserved));
+
+    props = it->channel.props;
+    m_reserved = std::make_unique<Entry>(std::move(*it));
+    m_entries.erase(it);
+    bReserved = true;
+  }
+
+  StopEntries(stopped);
+  return bReserved;
+}
+
+std::shared_ptr<CPVRStreamPrebuffer> CPVRChannelPrebuffers::Take(const std::string& strPath,
+                                                                 const std::string& url)
+{
+  CSingleLock lock(m_critSection);
+  if (!m_reserved || m_reserved->channel.strPath != strPath ||
+      m_reserved->stream->GetURL() != url || m_reserved->stream->HasFailed())
+    return {};
+
+  const std::shared_ptr<CPVRStreamPrebuffer> stream = m_reserved->stream;
+  m_reserved.reset();
+
+  stream->HandOver();
+  CLog::LogFC(LOGDEBUG, LOGPVR, "Playing prebuffered stream of channel {}", strPath);
+  return stream;
+}
+
+std::vector<std::string> CPVRChannelPrebuffers::GetPrebufferedChannels() const
+{
+  std::vector<std::string> paths;
+
+  CSingleLock lock(m_critSection);
+  for (const auto& entry : m_entries)
+    paths.emplace_back(entry.channel.strPath);
+
+  return paths;
+}
+
+void CPVRChannelPrebuffers::StopEntries(std::vector<Entry>& entries)
+{
+  if (entries.empty())
+    return;
+
+  // closing a stream may block on the network, let a job wait for it
+  std::vector<std::shared_ptr<CPVRStreamPrebuffer>> streams;
+  for (auto& entry : entries)
+  {
+    entry.stream->Stop();
+    streams.emplace_back(std::move(entry.stream));
+  }
+  entries.clear();
+
+  CJobManager::GetInstance().Submit([streams = std::move(streams)]() mutable { streams.clear(); });
+}
@@ -0,0 +1,265 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "pvr/PVRStreamProperties.h"
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+
+#include <functional>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace PVR
+{
+/*!
+ * @brief A source of stream data.
+ */
+class IPVRStreamSource
+{
+public:
+  virtual ~IPVRStreamSource() = default;
+
+  /*!
+   * @brief Open the stream.
+   * @param url The URL of the stream.
+   * @return True on success, false otherwise.
+   */
+  virtual bool Open(const std::string& url) = 0;
+
+  /*!
+   * @brief Read from the stream, blocking until data is available.
+   * @param buf The buffer to fill.
+   * @param size The size of the buffer.
+   * @return The number of bytes read, 0 at the end of the stream, -1 on error.
+   */
+  virtual int Read(uint8_t* buf, int size) = 0;
+
+  /*!
+   * @brief Close the stream.
+   */
+  virtual void Close() = 0;
+};
+
+/*!
+ * @brief A stream opened speculatively, ready to be handed over to the player.
+ *
+ * A thread opens the stream and keeps the most recent data in a buffer of fixed size, dropping
+ * older data, and reading no faster than a given number of bytes per second. Once handed over,
+ * no data is dropped anymore and the buffer is drained by Read().
+ */
+class CPVRStreamPrebuffer : private CThread
+{
+public:
+  /*!
+   * @brief Create a prebuffer.
+   * @param source The source of the stream.
+   * @param url The URL of the stream.
+   * @param iBufferSize The size of the buffer in bytes.
+   * @param iMaxBytesPerSecond The maximum rate to read the stream with until it is handed over, or
+   * 0 for no limit.
+   */
+  CPVRStreamPrebuffer(std::unique_ptr<IPVRStreamSource> source,
+                      const std::string& url,
+                      size_t iBufferSize,
+                      unsigned int iMaxBytesPerSecond);
+  ~CPVRStreamPrebuffer() override;
+
+  /*!
+   * @brief Open the stream and start buffering.
+   */
+  void Start();
+
+  /*!
+   * @brief Stop buffering and close the stream. Does not wait for the stream to be closed.
+   */
+  void Stop();
+
+  /*!
+   * @brief Get the URL of the stream.
+   * @return The URL.
+   */
+  const std::string& GetURL() const { return m_url; }
+
+  /*!
+   * @brief Check whether the stream was opened and data is buffered.
+   * @return True if data is buffered, false otherwise.
+   */
+  bool IsPrimed() const;
+
+  /*!
+   * @brief Check whether opening or reading the stream failed.
+   * @return True on failure, false otherwise.
+   */
+  bool HasFailed() const;
+
+  /*!
+   * @brief Hand the stream over to a reader. No buffered data is dropped from now on.
+   */
+  void HandOver();
+
+  /*!
+   * @brief Read from the stream, blocking until data is available. Only valid after HandOver().
+   * @param buf The buffer to fill.
+   * @param size The size of the buffer.
+   * @return The number of bytes read, 0 at the end of the stream, -1 on error.
+   */
+  int Read(uint8_t* buf, int size);
+
+  /*!
+   * @brief Set the maximum rate to read the stream with until it is handed over.
+   * @param iMaxBytesPerSecond The rate, or 0 for no limit.
+   */
+  void SetMaxBytesPerSecond(unsigned int iMaxBytesPerSecond);
+
+  /*!
+   * @brief Get the maximum rate to read the stream with until it is handed over.
+   * @return The rate, or 0 for no limit.
+   */
+  unsigned int GetMaxBytesPerSecond() const;
+
+  /*!
+   * @brief Get the number of bytes buffered.
+   * @return The number of bytes.
+   */
+  size_t GetBufferedSize() const;
+
+  /*!
+   * @brief Get the number of bytes dropped to make room for newer data.
+   * @return The number of bytes.
+   */
+  uint64_t GetDroppedSize() const;
+
+private:
+  void Process() override;
+  void Append(const uint8_t* data, size_t size);
+
+  const std::unique_ptr<IPVRStreamSource> m_source;
+  const std::string m_url;
+
+  mutable CCriticalSection m_critSection;
+  XbmcThreads::ConditionVariable m_condition;
+  unsigned int m_iMaxBytesPerSecond;
+  std::vector<uint8_t> m_buffer; //!< Ring buffer
+  size_t m_iReadPos = 0;
+  size_t m_iBufferedSize = 0;
+  uint64_t m_iDroppedSize = 0;
+  bool m_bOpened = false;
+  bool m_bEof = false;
+  bool m_bFailed = false;
+  bool m_bHandedOver = false;
+};
+
+/*!
+ * @brief Speculatively opens the streams of the channels the user is likely to switch to next,
+ * within a budget of streams per client and of bandwidth.
+ *
+ * Only streams the clients deliver through a URL read by Kodi's file layer are prebuffered, the
+ * live streams of the clients themselves can only be opened one at a time.
+ */
+class CPVRChannelPrebuffers
+{
+public:
+  struct Budget
+  {
+    unsigned int iMaxStreamsPerClient = 0; //!< The number of tuners a client may spend
+    unsigned int iMaxBytesPerSecond = 0; //!< The bandwidth all prebuffered streams may use
+    size_t iBufferSize = 0; //!< The size of the buffer of each stream, in bytes
+  };
+
+  //! A channel to prebuffer
+  struct Channel
+  {
+    std::string strPath; //!< The path of the channel
+    int iClientId;
+    CPVRStreamProperties props; //!< The properties of the channel's stream
+  };
+
+  using SourceFactory = std::function<std::unique_ptr<IPVRStreamSource>()>;
+
+  /*!
+   * @brief Create an instance with the budget of the advanced settings, reading from the file
+   * layer. Prebuffering is disabled if the advanced settings do not enable it.
+   */
+  CPVRChannelPrebuffers();
+
+  /*!
+   * @brief Create an instance with the given budget and source of streams.
+   */
+  CPVRChannelPrebuffers(const Budget& budget, SourceFactory sourceFactory);
+  virtual ~CPVRChannelPrebuffers();
+
+  /*!
+   * @brief Check whether prebuffering is enabled.
+   * @return True if enabled, false otherwise.
+   */
+  bool IsEnabled() const;
+
+  /*!
+   * @brief Check whether the stream with the given properties can be prebuffered.
+   * @param props The properties of the stream.
+   * @return True if the stream can be prebuffered, false otherwise.
+   */
+  static bool CanPrebuffer(const CPVRStreamProperties& props);
+
+  /*!
+   * @brief Prebuffer the given channels, in order of preference, as far as the budget allows.
+   * Prebuffering of all other channels is stopped, as is a reserved stream that was not taken.
+   * The bandwidth is shared equally by the streams prebuffered, including the ones kept.
+   * @param channels The channels.
+   */
+  void Prebuffer(const std::vector<Channel>& channels);
+
+  /*!
+   * @brief Stop prebuffering all channels, except for the reserved one.
+   */
+  void Stop();
+
+  /*!
+   * @brief Reserve the prebuffered stream of a channel for the player.
+   * @param strPath The path of the channel.
+   * @param props Set to the properties of the channel's stream, if prebuffered.
+   * @return True if the channel's stream is prebuffered and was reserved, false otherwise.
+   */
+  bool Reserve(const std::string& strPath, CPVRStreamProperties& props);
+
+  /*!
+   * @brief Take the reserved stream of a channel and hand it over to the caller.
+   * @param strPath The path of the channel.
+   * @param url The URL of the stream to play.
+   * @return The stream, or nullptr if no stream with the given URL was reserved for the channel.
+   */
+  std::shared_ptr<CPVRStreamPrebuffer> Take(const std::string& strPath, const std::string& url);
+
+  /*!
+   * @brief Get the paths of the channels being prebuffered.
+   * @return The paths.
+   */
+  std::vector<std::string> GetPrebufferedChannels() const;
+
+private:
+  struct Entry
+  {
+    Channel channel;
+    std::shared_ptr<CPVRStreamPrebuffer> stream;
+  };
+
+  void StopEntries(std::vector<Entry>& entries);
+
+  const Budget m_budget;
+  const SourceFactory m_sourceFactory;
+
+  mutable CCriticalSection m_critSection;
+  std::vector<Entry> m_entries;
+  std::unique_ptr<Entry> m_reserved;
+};
+} // namespace PVR
@@ -0,0 +1,317 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "addons/kodi-dev-kit/include/kodi/c-api/addon-instance/pvr/pvr_general.h"
+#include "pvr/PVRStreamProperties.h"
+#include "pvr/channels/PVRChannelPrebuffers.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PVR;
+using namespace std::chrono_literals;
+
+namespace
+{
+constexpr const char* STANDIN_URL = "http://standin/";
+
+//! Stand-in for a live stream of a PVR backend, plays a local file. Opening the stream takes the
+//! time a backend needs to tune, data arrives at the bitrate of the stream.
+class CStandInStreamSource : public IPVRStreamSource
+{
+public:
+  CStandInStreamSource(const std::string& directory,
+                       std::chrono::milliseconds tuneTime,
+                       unsigned int iBytesPerSecond,
+                       std::atomic<unsigned int>& iTunings)
+    : m_directory(directory),
+      m_tuneTime(tuneTime),
+      m_iBytesPerSecond(iBytesPerSecond),
+      m_iTunings(iTunings)
+  {
+  }
+
+  bool Open(const std::string& url) override
+  {
+    std::this_thread::sleep_for(m_tuneTime);
+    ++m_iTunings;
+    m_file.open(m_directory + url.substr(std::string(STANDIN_URL).size()), std::ios::binary);
+    m_start = std::chrono::steady_clock::now();
+    return m_file.is_open();
+  }
+
+  int Read(uint8_t* buf, int size) override
+  {
+    // deliver the data as it is broadcast, no sooner
+    uint64_t iBroadcast;
+    while ((iBroadcast = GetBroadcastSize()) <= m_iDelivered)
+      std::this_thread::sleep_for(10ms);
+
+    const int iSize = static_cast<int>(std::min<uint64_t>(size, iBroadcast - m_iDelivered));
+    m_file.read(reinterpret_cast<char*>(buf), iSize);
+    m_iDelivered += m_file.gcount();
+    return static_cast<int>(m_file.gcount());
+  }
+
+  void Close() override { m_file.close(); }
+
+private:
+  uint64_t GetBroadcastSize() const
+  {
+    const auto elapsed = std::chrono::steady_clock::now() - m_start;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() *
+           m_iBytesPerSecond / 1000;
+  }
+
+  const std::string m_directory;
+  const std::chrono::milliseconds m_tuneTime;
+  const unsigned int m_iBytesPerSecond;
+  std::atomic<unsigned int>& m_iTunings;
+  std::ifstream m_file;
+  std::chrono::steady_clock::time_point m_start;
+  uint64_t m_iDelivered = 0;
+};
+
+class TestPVRChannelPrebuffers : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_directory = testing::TempDir();
+    CreateStream("channel1.ts", 1024 * 1024);
+    CreateStream("channel2.ts", 1024 * 1024);
+    CreateStream("channel3.ts", 1024 * 1024);
+  }
+
+  void TearDown() override
+  {
+    for (const auto& name : m_files)
+      std::remove((m_directory + name).c_str());
+  }
+
+  void CreateStream(const std::string& name, size_t iSize)
+  {
+    std::ofstream file(m_directory + name, std::ios::binary);
+    for (size_t i = 0; i < iSize; ++i)
+      file.put(static_cast<char>(ByteAt(i)));
+    m_files.emplace_back(name);
+  }
+
+  static uint8_t ByteAt(uint64_t iOffset)
+  {
+    return static_cast<uint8_t>(iOffset * 7 + iOffset / 251);
+  }
+
+  std::unique_ptr<IPVRStreamSource> CreateSource(std::chrono::milliseconds tuneTime,
+                                                 unsigned int iBytesPerSecond)
+  {
+    return std::make_unique<CStandInStreamSource>(m_directory, tuneTime, iBytesPerSecond,
+                                                  m_iTunings);
+  }
+
+  static CPVRChannelPrebuffers::Channel CreateChannel(const std::string& name, int iClientId)
+  {
+    CPVRChannelPrebuffers::Channel channel{"pvr://channels/tv/All channels/" + name, iClientId, {}};
+    channel.props.emplace_back(PVR_STREAM_PROPERTY_STREAMURL, STANDIN_URL + name);
+    return channel;
+  }
+
+  static bool WaitForPrimed(const CPVRStreamPrebuffer& stream)
+  {
+    for (int i = 0; i < 200 && !stream.IsPrimed(); ++i)
+      std::this_thread::sleep_for(10ms);
+    return stream.IsPrimed();
+  }
+
+  std::string m_directory;
+  std::vector<std::string> m_files;
+  std::atomic<unsigned int> m_iTunings{0}; //!< The number of streams the backends tuned to
+};
+} // namespace
+
+TEST_F(TestPVRChannelPrebuffers, KeepsMostRecentData)
+{
+  CPVRStreamPrebuffer stream(CreateSource(0ms, 2 * 1024 * 1024),
+                             STANDIN_URL + std::string("channel1.ts"), 64 * 1024, 0);
+  stream.Start();
+  ASSERT_TRUE(WaitForPrimed(stream));
+
+  while (stream.GetDroppedSize() < 256 * 1024)
+    std::this_thread::sleep_for(10ms);
+
+  EXPECT_LE(stream.GetBufferedSize(), 64u * 1024);
+
+  // once handed over, the stream continues seamlessly from the oldest buffered byte
+  stream.HandOver();
+  const uint64_t iFirstOffset = stream.GetDroppedSize();
+
+  std::vector<uint8_t> data;
+  uint8_t buf[10000];
+  int iRead;
+  while ((iRead = stream.Read(buf, sizeof(buf))) > 0)
+    data.insert(data.end(), buf, buf + iRead);
+
+  EXPECT_EQ(iRead, 0);
+  EXPECT_EQ(stream.GetDroppedSize(), iFirstOffset);
+  ASSERT_EQ(iFirstOffset + data.size(), 1024u * 1024);
+  for (size_t i = 0; i < data.size(); ++i)
+    ASSERT_EQ(data[i], ByteAt(iFirstOffset + i)) << "at " << iFirstOffset + i;
+}
+
+TEST_F(TestPVRChannelPrebuffers, ZapTime)
+{
+  CPVRChannelPrebuffers prebuffers({1, 0, 1024 * 1024}, [this]() {
+    return CreateSource(100ms, 512 * 1024);
+  });
+  const CPVRChannelPrebuffers::Channel channel = CreateChannel("channel2.ts", 1);
+  prebuffers.Prebuffer({channel});
+
+  CPVRStreamProperties props;
+  for (int i = 0; i < 200 && !prebuffers.Reserve(channel.strPath, props); ++i)
+    std::this_thread::sleep_for(10ms);
+
+  // the backend tuned before the player asked for the stream...
+  ASSERT_EQ(props.GetStreamURL(), STANDIN_URL + std::string("channel2.ts"));
+  EXPECT_EQ(m_iTunings.load(), 1u);
+  const std::shared_ptr<CPVRStreamPrebuffer> stream =
+      prebuffers.Take(channel.strPath, props.GetStreamURL());
+  ASSERT_TRUE(stream);
+
+  // ...so the player's first read is served from the buffer, without waiting for a tuner
+  ASSERT_GT(stream->GetBufferedSize(), 0u);
+  uint8_t buf[4096];
+  EXPECT_GT(stream->Read(buf, sizeof(buf)), 0);
+  EXPECT_EQ(m_iTunings.load(), 1u);
+  stream->Stop();
+}
+
+TEST_F(TestPVRChannelPrebuffers, Budget)
+{
+  CPVRChannelPrebuffers prebuffers({1, 0, 64 * 1024}, [this]() {
+    return CreateSource(0ms, 1024 * 1024);
+  });
+  ASSERT_TRUE(prebuffers.IsEnabled());
+
+  const CPVRChannelPrebuffers::Channel channel1 = CreateChannel("channel1.ts", 1);
+  const CPVRChannelPrebuffers::Channel channel2 = CreateChannel("channel2.ts", 1);
+  const CPVRChannelPrebuffers::Channel channel3 = CreateChannel("channel3.ts", 2);
+
+  // one stream per client, in order of preference
+  prebuffers.Prebuffer({channel1, channel2, channel3});
+  EXPECT_EQ(prebuffers.GetPrebufferedChannels(),
+            (std::vector<std::string>{channel1.strPath, channel3.strPath}));
+
+  prebuffers.Prebuffer({channel2, channel1});
+  EXPECT_EQ(prebuffers.GetPrebufferedChannels(), std::vector<std::string>{channel2.strPath});
+
+  // streams not read through the file layer can not be prebuffered
+  CPVRChannelPrebuffers::Channel addon = CreateChannel("channel3.ts", 2);
+  addon.props.emplace_back(PVR_STREAM_PROPERTY_INPUTSTREAM, "inputstream.adaptive");
+  CPVRChannelPrebuffers::Channel hls = CreateChannel("channel3.m3u8", 2);
+  EXPECT_FALSE(CPVRChannelPrebuffers::CanPrebuffer(addon.props));
+  EXPECT_FALSE(CPVRChannelPrebuffers::CanPrebuffer(hls.props));
+  EXPECT_TRUE(CPVRChannelPrebuffers::CanPrebuffer(channel3.props));
+
+  prebuffers.Stop();
+  EXPECT_TRUE(prebuffers.GetPrebufferedChannels().empty());
+
+  CPVRChannelPrebuffers disabled({0, 0, 0}, [this]() { return CreateSource(0ms, 1024); });
+  disabled.Prebuffer({channel1});
+  EXPECT_FALSE(disabled.IsEnabled());
+  EXPECT_TRUE(disabled.GetPrebufferedChannels().empty());
+}
+
+TEST_F(TestPVRChannelPrebuffers, Bandwidth)
+{
+  // both streams are broadcast far faster than the limited one may read
+  CPVRStreamPrebuffer unlimited(CreateSource(0ms, 1024 * 1024 * 1024),
+                                STANDIN_URL + std::string("channel1.ts"), 1024 * 1024, 0);
+  CPVRStreamPrebuffer limited(CreateSource(0ms, 1024 * 1024 * 1024),
+                              STANDIN_URL + std::string("channel2.ts"), 1024 * 1024, 64 * 1024);
+  unlimited.Start();
+  limited.Start();
+  ASSERT_TRUE(WaitForPrimed(limited));
+
+  for (int i = 0; i < 200 && unlimited.GetBufferedSize() < 1024 * 1024; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(unlimited.GetBufferedSize(), 1024u * 1024);
+
+  // reading all of the stream takes the limited one 16 s
+  EXPECT_LT(limited.GetBufferedSize() + limited.GetDroppedSize(), 1024u * 1024);
+}
+
+TEST_F(TestPVRChannelPrebuffers, SharedBandwidth)
+{
+  constexpr unsigned int iMaxBytesPerSecond = 256 * 1024;
+  CPVRChannelPrebuffers prebuffers({2, iMaxBytesPerSecond, 64 * 1024}, [this]() {
+    return CreateSource(0ms, 1024 * 1024);
+  });
+  const CPVRChannelPrebuffers::Channel channel1 = CreateChannel("channel1.ts", 1);
+  const CPVRChannelPrebuffers::Channel channel2 = CreateChannel("channel2.ts", 1);
+
+  // the stream kept gets the bandwidth of the stream stopped
+  prebuffers.Prebuffer({channel1, channel2});
+  prebuffers.Prebuffer({channel1});
+
+  CPVRStreamProperties props;
+  for (int i = 0; i < 200 && !prebuffers.Reserve(channel1.strPath, props); ++i)
+    std::this_thread::sleep_for(10ms);
+  const std::shared_ptr<CPVRStreamPrebuffer> stream =
+      prebuffers.Take(channel1.strPath, props.GetStreamURL());
+  ASSERT_TRUE(stream);
+  EXPECT_EQ(stream->GetMaxBytesPerSecond(), iMaxBytesPerSecond);
+  stream->Stop();
+}
+
+TEST_F(TestPVRChannelPrebuffers, ReserveAndTake)
+{
+  CPVRChannelPrebuffers prebuffers({2, 0, 64 * 1024}, [this]() {
+    return CreateSource(100ms, 1024 * 1024);
+  });
+  const CPVRChannelPrebuffers::Channel channel1 = CreateChannel("channel1.ts", 1);
+  const CPVRChannelPrebuffers::Channel channel2 = CreateChannel("channel2.ts", 1);
+  prebuffers.Prebuffer({channel1, channel2});
+
+  // a stream still tuning is of no use for the player
+  CPVRStreamProperties props;
+  EXPECT_FALSE(prebuffers.Reserve(channel1.strPath, props));
+  EXPECT_FALSE(prebuffers.Reserve("pvr://channels/tv/All channels/other.ts", props));
+
+  for (int i = 0; i < 200 && !prebuffers.Reserve(channel1.strPath, props); ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(props.GetStreamURL(), channel1.props.GetStreamURL());
+  EXPECT_EQ(prebuffers.GetPrebufferedChannels(), std::vector<std::string>{channel2.strPath});
+
+  // stopping the previous playback keeps the reserved stream
+  prebuffers.Stop();
+  EXPECT_FALSE(prebuffers.Take(channel1.strPath, "http://standin/other.ts"));
+  const std::shared_ptr<CPVRStreamPrebuffer> stream =
+      prebuffers.Take(channel1.strPath, props.GetStreamURL());
+  ASSERT_TRUE(stream);
+  EXPECT_FALSE(prebuffers.Take(channel1.strPath, props.GetStreamURL()));
+
+  uint8_t buf[1024];
+  EXPECT_GT(stream->Read(buf, sizeof(buf)), 0);
+  stream->Stop();
+
+  // a reserved stream the player did not take is released with the next prebuffering
+  prebuffers.Prebuffer({channel2});
+  for (int i = 0; i < 200 && !prebuffers.Reserve(channel2.strPath, props); ++i)
+    std::this_thread::sleep_for(10ms);
+  prebuffers.Prebuffer({channel1});
+  EXPECT_FALSE(prebuffers.Take(channel2.strPath, props.GetStreamURL()));
+}
@@ -170,6 +170,7 @@ bool CPVREpg::UpdateEntries(const CPVREpg& epg)
 
   /* copy over tags */
   m_tags.UpdateEntries(epg.m_tags);
+  ++m_iTagsChangeCount;
 
   /* update the last scan time of this table */
   m_lastScanTime = CDateTime::GetUTCDateTime();
@@ -214,6 +215,8 @@ bool CPVREpg::UpdateEntry(const std::shared_ptr<CPVREpgInfoTag>& tag, EPG_EVENT_
   {
     CSingleLock lock(m_critSection);
     bRet = !IsTagExpired(tag) && m_tags.UpdateEntry(tag);
+    if (bRet)
+      ++m_iTagsChangeCount;
   }
   else if (newState == EPG_EVENT_DELETED)
   {
@@ -380,6 +383,12 @@ bool CPVREpg::QueueDeleteQueries(const std::shared_ptr<CPVREpgDatabase>& databas
   return true;
 }
 
+unsigned int CPVREpg::GetTagsChangeCount() const
+{
+  CSingleLock lock(m_critSection);
+  return m_iTagsChangeCount;
+}
+
 CDateTime CPVREpg::GetFirstDate() const
 {
   CSingleLock lock(m_critSection);
@@ -539,6 +548,12 @@ bool CPVREpg::NeedsSave() const
   return m_bChanged || m_bUpdateLastScanTime || m_tags.NeedsSave();
 }
 
+size_t CPVREpg::GetMemoryUsage() const
+{
+  CSingleLock lock(m_critSection);
+  return m_tags.GetMemoryUsage();
+}
+
 bool CPVREpg::IsValid() const
 {
   CSingleLock lock(m_critSection);
@@ -224,6 +224,12 @@ namespace PVR
      */
     bool QueueDeleteQueries(const std::shared_ptr<CPVREpgDatabase>& database);
 
+    /*!
+     * @brief Get the number of times tags were added to or updated in this table.
+     * @return The number of changes.
+     */
+    unsigned int GetTagsChangeCount() const;
+
     /*!
      * @brief Get the start time of the first entry in this table.
      * @return The first date in UTC.
@@ -256,6 +262,12 @@ namespace PVR
      */
     bool NeedsSave() const;
 
+    /*!
+     * @brief Get the approximate number of bytes allocated by the unsaved data of this EPG.
+     * @return The number of bytes.
+     */
+    size_t GetMemoryUsage() const;
+
     /*!
      * @brief Check whether this EPG is valid.
      * @return True if this EPG is valid and can be updated, false otherwise.
@@ -320,6 +332,7 @@ namespace PVR
     bool m_bUpdateLastScanTime = false;
     std::shared_ptr<CPVREpgChannelData> m_channelData;
     CPVREpgTagsContainer m_tags;
+    unsigned int m_iTagsChangeCount = 0; /*!< the number of times tags were added or updated */
 
     CEventSource<PVREvent> m_events;
   };
@@ -12,11 +12,15 @@
 #include "addons/kodi-dev-kit/include/kodi/c-api/addon-instance/pvr/pvr_channels.h" // PVR_CHANNEL_INVALID_UID
 #include "guilib/LocalizeStrings.h"
 #include "pvr/PVRManager.h"
+#include "pvr/PVRPlaybackState.h"
+#include "pvr/channels/PVRChannel.h"
+#include "pvr/channels/PVRChannelGroup.h"
 #include "pvr/epg/Epg.h"
 #include "pvr/epg/EpgChannelData.h"
 #include "pvr/epg/EpgContainer.h"
 #include "pvr/epg/EpgDatabase.h"
 #include "pvr/epg/EpgInfoTag.h"
+#include "pvr/epg/EpgUpdateScheduler.h"
 #include "pvr/guilib/PVRGUIProgressHandler.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
@@ -25,6 +29,7 @@
 #include "threads/SystemClock.h"
 #include "utils/log.h"
 
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -255,6 +260,20 @@ void CPVREpgContainer::LoadFromDB()
 }
 
 bool CPVREpgContainer::PersistAll(unsigned int iMaxTimeslice) const
+{
+  std::vector<std::shared_ptr<CPVREpg>> epgs;
+  {
+    CSingleLock lock(m_critSection);
+    epgs.reserve(m_epgIdToEpgMap.size());
+    for (const auto& epg : m_epgIdToEpgMap)
+      epgs.emplace_back(epg.second);
+  }
+
+  return PersistEpgs(epgs, iMaxTimeslice);
+}
+
+bool CPVREpgContainer::PersistEpgs(const std::vector<std::shared_ptr<CPVREpg>>& epgs,
+                                   unsigned int iMaxTimeslice) const
 {
   const std::shared_ptr<CPVREpgDatabase> database = GetEpgDatabase();
   if (!database)
@@ -264,17 +283,14 @@ bool CPVREpgContainer::PersistAll(unsigned int iMaxTimeslice) const
   }
 
   std::vector<std::shared_ptr<CPVREpg>> changedEpgs;
+  for (const auto& epg : epgs)
   {
-    CSingleLock lock(m_critSection);
-    for (const auto& epg : m_epgIdToEpgMap)
+    if (epg && epg->NeedsSave())
     {
-      if (epg.second && epg.second->NeedsSave())
-      {
-        // Note: We need to obtain a lock for every epg instance before we can lock
-        //       the epg db. This order is important. Otherwise deadlocks may occur.
-        epg.second->Lock();
-        changedEpgs.emplace_back(epg.second);
-      }
+      // Note: We need to obtain a lock for every epg instance before we can lock
+      //       the epg db. This order is important. Otherwise deadlocks may occur.
+      epg->Lock();
+      changedEpgs.emplace_back(epg);
     }
   }
 
@@ -704,6 +720,32 @@ void CPVREpgContainer::WaitForUpdateFinish()
   m_updateEvent.Wait();
 }
 
+namespace
+{
+// Number of updated EPG tables persisted together during an update
+constexpr size_t EPG_UPDATE_PERSIST_BATCH_SIZE = 50;
+
+// Fetch the EPG the user is most likely to look at first: the playing channel, then the members
+// of the active channel group, then all other channels. Hidden channels have nothing to fetch.
+int GetUpdatePriority(const CPVREpgChannelData& channelData,
+                      const std::shared_ptr<CPVRChannel>& playingChannel,
+                      const std::shared_ptr<CPVRChannelGroup>& activeGroup)
+{
+  if (channelData.IsHidden() || !channelData.IsEPGEnabled())
+    return 3;
+
+  if (playingChannel && playingChannel->ClientID() == channelData.ClientId() &&
+      playingChannel->UniqueID() == channelData.UniqueClientChannelId())
+    return 0;
+
+  if (activeGroup && activeGroup->GetByUniqueID(
+                         std::make_pair(channelData.ClientId(), channelData.UniqueClientChannelId())))
+    return 1;
+
+  return 2;
+}
+} // unnamed namespace
+
 bool CPVREpgContainer::UpdateEPG(bool bOnlyPending /* = false */)
 {
   bool bInterrupted = false;
@@ -737,46 +779,89 @@ bool CPVREpgContainer::UpdateEPG(bool bOnlyPending /* = false */)
     progressHandler = new CPVRGUIProgressHandler(g_localizeStrings.Get(19004)); // Importing guide from clients
 
   /* load or update all EPG tables */
-  unsigned int iCounter = 0;
   const std::shared_ptr<CPVREpgDatabase> database = GetEpgDatabase();
 
   m_critSection.lock();
   const auto epgsToUpdate = m_epgIdToEpgMap;
   m_critSection.unlock();
 
+  const std::shared_ptr<CPVRPlaybackState> playbackState =
+      CServiceBroker::GetPVRManager().PlaybackState();
+  const std::shared_ptr<CPVRChannel> playingChannel = playbackState->GetPlayingChannel();
+  const std::shared_ptr<CPVRChannelGroup> activeTVGroup =
+      playbackState->GetActiveChannelGroup(false);
+  const std::shared_ptr<CPVRChannelGroup> activeRadioGroup =
+      playbackState->GetActiveChannelGroup(true);
+
+  std::vector<std::shared_ptr<CPVREpg>> epgs;
+  std::vector<CPVREpgUpdateScheduler::Job> jobs;
   for (const auto& epgEntry : epgsToUpdate)
   {
-    if (InterruptUpdate())
-    {
-      bInterrupted = true;
-      break;
-    }
-
     const std::shared_ptr<CPVREpg> epg = epgEntry.second;
     if (!epg)
       continue;
 
-    if (bShowProgress && !bOnlyPending)
-      progressHandler->UpdateProgress(epg->GetChannelData()->ChannelName(), ++iCounter,
-                                      epgsToUpdate.size());
-
-    if ((!bOnlyPending || epg->UpdatePending()) &&
-        epg->Update(start,
-                    end,
-                    m_settings.GetIntValue(CSettings::SETTING_EPG_EPGUPDATE) * 60,
-                    m_settings.GetIntValue(CSettings::SETTING_EPG_PAST_DAYSTODISPLAY),
-                    database,
-                    bOnlyPending))
+    if (bOnlyPending && !epg->UpdatePending())
+    {
+      if (!epg->IsValid())
+        invalidTables.push_back(epg);
+      continue;
+    }
+
+    const std::shared_ptr<CPVREpgChannelData> channelData = epg->GetChannelData();
+    epgs.emplace_back(epg);
+    jobs.push_back({channelData->ClientId(),
+                    GetUpdatePriority(*channelData, playingChannel,
+                                      channelData->IsRadio() ? activeRadioGroup : activeTVGroup)});
+  }
+
+  const int iUpdateTime = m_settings.GetIntValue(CSettings::SETTING_EPG_EPGUPDATE) * 60;
+  const int iPastDays = m_settings.GetIntValue(CSettings::SETTING_EPG_PAST_DAYSTODISPLAY);
+
+  CPVREpgUpdateScheduler scheduler(
+      [&](size_t job) {
+        return epgs[job]->Update(start, end, iUpdateTime, iPastDays, database, bOnlyPending);
+      },
+      advancedSettings->m_iEpgMaxConcurrentUpdates,
+      advancedSettings->m_iEpgMaxConcurrentUpdatesPerClient);
+
+  // Tables updated but not persisted yet
+  std::vector<std::shared_ptr<CPVREpg>> updatedTables;
+
+  bInterrupted = !scheduler.Execute(jobs, [&](size_t job, size_t iFinished) {
+    if (job == CPVREpgUpdateScheduler::NO_JOB)
+      return !InterruptUpdate();
+
+    const std::shared_ptr<CPVREpg>& epg = epgs[job];
+    if (progressHandler)
+      progressHandler->UpdateProgress(epg->GetChannelData()->ChannelName(), iFinished,
+                                      jobs.size());
+
+    if (scheduler.GetResult(job) == CPVREpgUpdateScheduler::JobResult::SUCCEEDED)
     {
       iUpdatedTables++;
+      updatedTables.emplace_back(epg);
     }
     else if (!epg->IsValid())
     {
       invalidTables.push_back(epg);
     }
-  }
 
-  if (bShowProgress && !bOnlyPending)
+    // Store the new data in large transactions while the remaining tables are fetched, and let
+    // the GUI show it right away
+    if (updatedTables.size() >= EPG_UPDATE_PERSIST_BATCH_SIZE)
+    {
+      PersistEpgs(updatedTables, std::numeric_limits<unsigned int>::max());
+      updatedTables.clear();
+      m_events.Publish(PVREvent::EpgContainer);
+    }
+
+    return !InterruptUpdate();
+  });
+
+  PersistEpgs(updatedTables, std::numeric_limits<unsigned int>::max());
+
+  if (progressHandler)
     progressHandler->DestroyProgress();
 
   QueueDeleteEpgs(invalidTables);
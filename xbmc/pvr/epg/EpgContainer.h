@@ -245,6 +245,16 @@ namespace PVR
      */
     bool PersistAll(unsigned int iMaxTimeslice) const;
 
+    /*!
+     * @brief Call Persist() on the given tables, committing all their changes together
+     * @param epgs The tables to persist.
+     * @param iMaxTimeslice time in milliseconds for max processing. Return after this time
+     *        even if not all data was persisted
+     * @return True when they all were persisted, false otherwise.
+     */
+    bool PersistEpgs(const std::vector<std::shared_ptr<CPVREpg>>& epgs,
+                     unsigned int iMaxTimeslice) const;
+
     /*!
      * @brief Remove old EPG entries.
      * @return True if the old entries were removed successfully, false otherwise.
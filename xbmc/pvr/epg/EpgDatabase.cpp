@@ -16,8 +16,10 @@
 #include "settings/AdvancedSettings.h"
 #include "settings/SettingsComponent.h"
 #include "threads/SingleLock.h"
+#include "utils/StringUtils.h"
 #include "utils/log.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 #include <string>
@@ -36,6 +38,7 @@ void CPVREpgDatabase::Close()
 {
   CSingleLock lock(m_critSection);
   CDatabase::Close();
+  m_searchIndexState = SearchIndexState::UNKNOWN;
 }
 
 void CPVREpgDatabase::Lock()
@@ -103,6 +106,8 @@ void CPVREpgDatabase::CreateTables()
         "sLastScan varchar(20)"
       ")"
   );
+
+  CreateSearchIndex();
 }
 
 void CPVREpgDatabase::CreateAnalytics()
@@ -112,6 +117,10 @@ void CPVREpgDatabase::CreateAnalytics()
   CSingleLock lock(m_critSection);
   m_pDS->exec("CREATE UNIQUE INDEX idx_epg_idEpg_iStartTime on epgtags(idEpg, iStartTime desc);");
   m_pDS->exec("CREATE INDEX idx_epg_iEndTime on epgtags(iEndTime);");
+
+  // The tags might have been changed while updating the tables, fill the search index from scratch
+  if (IsSearchIndexUsable(m_pDS))
+    RebuildSearchIndex(m_pDS);
 }
 
 void CPVREpgDatabase::UpdateTables(int iVersion)
@@ -258,6 +267,128 @@ void CPVREpgDatabase::UpdateTables(int iVersion)
     m_pDS->exec("DROP TABLE epgtags");
     m_pDS->exec("ALTER TABLE epgtags_new RENAME TO epgtags");
   }
+
+  if (iVersion < 14)
+    CreateSearchIndex();
+}
+
+bool CPVREpgDatabase::CreateSearchIndex()
+{
+  // The trigram tokenizer of SQLite's FTS5 (SQLite 3.34 and later) can look up any substring
+  // of at least three characters, like the LIKE '%term%' expressions used for searching do.
+  if (!m_sqlite)
+    return false;
+
+  try
+  {
+    CLog::LogFC(LOGDEBUG, LOGEPG, "Creating table 'epgtags_fts'");
+    m_pDS->exec("CREATE VIRTUAL TABLE epgtags_fts USING fts5("
+                "sTitle, "
+                "sPlotOutline, "
+                "sPlot, "
+                "tokenize = 'trigram'"
+                ")");
+  }
+  catch (...)
+  {
+    CLog::Log(LOGINFO, "Full-text search is not supported by the EPG database, searching without "
+                       "search index");
+    return false;
+  }
+
+  return true;
+}
+
+bool CPVREpgDatabase::IsSearchIndexUsable(const std::unique_ptr<dbiplus::Dataset>& pDS)
+{
+  if (!m_sqlite)
+    return false;
+
+  try
+  {
+    if (!pDS->query("SELECT name FROM sqlite_master WHERE type = 'table' AND name = 'epgtags_fts'"))
+      return false;
+
+    const bool bExists = pDS->num_rows() > 0;
+    pDS->close();
+    if (!bExists)
+      return false;
+
+    // the table might have been created by an SQLite version with other modules
+    pDS->query("SELECT rowid FROM epgtags_fts LIMIT 1");
+    pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "EPG search index can not be used, searching without search index");
+  }
+
+  // keep the tags writable without the index, it is rebuilt once it can be used again
+  try
+  {
+    pDS->exec("DROP TRIGGER IF EXISTS epgtags_fts_delete");
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "Failed to drop the EPG search index trigger");
+  }
+
+  return false;
+}
+
+bool CPVREpgDatabase::RebuildSearchIndex(const std::unique_ptr<dbiplus::Dataset>& pDS)
+{
+  CLog::LogFC(LOGDEBUG, LOGEPG, "Rebuilding EPG search index");
+
+  try
+  {
+    pDS->exec("DROP TRIGGER IF EXISTS epgtags_fts_delete");
+    pDS->exec("DELETE FROM epgtags_fts");
+    pDS->exec("INSERT INTO epgtags_fts (rowid, sTitle, sPlotOutline, sPlot) "
+              "SELECT idBroadcast, sTitle, sPlotOutline, sPlot FROM epgtags");
+
+    // Tags are added to the index by QueuePersistQuery() instead of an insert trigger, which
+    // makes FTS5 flush its pending changes for every single tag. REPLACE INTO does not fire the
+    // delete trigger for the tags it replaces, QueuePersistQuery() removes their entries itself.
+    pDS->exec("CREATE TRIGGER epgtags_fts_delete AFTER DELETE ON epgtags FOR EACH ROW BEGIN "
+              "DELETE FROM epgtags_fts WHERE rowid = old.idBroadcast; "
+              "END");
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "Failed to rebuild the EPG search index");
+    return false;
+  }
+
+  return true;
+}
+
+bool CPVREpgDatabase::HasSearchIndex()
+{
+  CSingleLock lock(m_critSection);
+
+  if (m_searchIndexState == SearchIndexState::UNKNOWN && m_pDB)
+  {
+    // use a dataset of its own, m_pDS might hold queued delete queries
+    std::unique_ptr<dbiplus::Dataset> pDS(m_pDB->CreateDataset());
+
+    bool bAvailable = IsSearchIndexUsable(pDS);
+    if (bAvailable &&
+        GetSingleValue("SELECT name FROM sqlite_master WHERE type = 'trigger' AND name = "
+                       "'epgtags_fts_delete'",
+                       pDS)
+            .empty())
+    {
+      // the index was not maintained while it could not be used
+      bAvailable = RebuildSearchIndex(pDS);
+    }
+
+    m_searchIndexState =
+        bAvailable ? SearchIndexState::AVAILABLE : SearchIndexState::UNAVAILABLE;
+  }
+
+  return m_searchIndexState == SearchIndexState::AVAILABLE;
 }
 
 bool CPVREpgDatabase::DeleteEpg()
@@ -267,6 +398,17 @@ bool CPVREpgDatabase::DeleteEpg()
 
   CSingleLock lock(m_critSection);
 
+  if (HasSearchIndex())
+  {
+    // Much faster than deleting the entries of the index one by one
+    ExecuteQuery("DROP TABLE epgtags_fts");
+    if (!CreateSearchIndex())
+    {
+      ExecuteQuery("DROP TRIGGER IF EXISTS epgtags_fts_delete");
+      m_searchIndexState = SearchIndexState::UNAVAILABLE;
+    }
+  }
+
   bReturn = DeleteValues("epg") || bReturn;
   bReturn = DeleteValues("epgtags") || bReturn;
   bReturn = DeleteValues("lastepgscan") || bReturn;
@@ -519,7 +661,129 @@ public:
     return result;
   }
 
+  /*!
+   * @brief Get a full-text query for the given columns, matching at least all tags matched by
+   * ToSQL() for any of the columns. Used to narrow down the search with the search index, the
+   * tags found still need to be checked against ToSQL().
+   * @param strColumns The space-separated names of the columns.
+   * @return The query or an empty string, if the search term can't be looked up in the index.
+   */
+  std::string ToFTS(const std::string& strColumns) const
+  {
+    size_t pos = 0;
+    std::string strQuery;
+    if (!ParseFTSOr(pos, strQuery) || pos != m_tokens.size() || strQuery.empty())
+      return {};
+
+    return "{" + strColumns + "} : (" + strQuery + ")";
+  }
+
 private:
+  enum class TokenType
+  {
+    TERM,
+    AND,
+    OR,
+    NOT,
+  };
+
+  struct Token
+  {
+    TokenType type;
+    std::string term;
+  };
+
+  // The ParseFTS functions follow the precedence of NOT, AND and OR in the SQL expression built
+  // from the same tokens. An empty query matches all tags.
+  bool ParseFTSOr(size_t& pos, std::string& strQuery) const
+  {
+    std::vector<std::string> alternatives;
+    bool bMatchesAll = false;
+
+    while (true)
+    {
+      std::string strAlternative;
+      if (!ParseFTSAnd(pos, strAlternative))
+        return false;
+
+      if (strAlternative.empty())
+        bMatchesAll = true;
+      else
+        alternatives.emplace_back("(" + strAlternative + ")");
+
+      if (pos == m_tokens.size() || m_tokens[pos].type != TokenType::OR)
+        break;
+
+      ++pos;
+    }
+
+    strQuery = bMatchesAll ? "" : StringUtils::Join(alternatives, " OR ");
+    return true;
+  }
+
+  bool ParseFTSAnd(size_t& pos, std::string& strQuery) const
+  {
+    std::vector<std::string> conditions;
+
+    while (true)
+    {
+      std::string strCondition;
+      if (!ParseFTSNot(pos, strCondition))
+        return false;
+
+      if (!strCondition.empty())
+        conditions.emplace_back(strCondition);
+
+      if (pos == m_tokens.size() || m_tokens[pos].type != TokenType::AND)
+        break;
+
+      ++pos;
+    }
+
+    strQuery = StringUtils::Join(conditions, " AND ");
+    return true;
+  }
+
+  bool ParseFTSNot(size_t& pos, std::string& strQuery) const
+  {
+    if (pos == m_tokens.size())
+      return false;
+
+    const Token& token = m_tokens[pos++];
+    if (token.type == TokenType::NOT)
+    {
+      // negated terms can't narrow down the search
+      std::string strNegated;
+      if (!ParseFTSNot(pos, strNegated))
+        return false;
+
+      strQuery.clear();
+      return true;
+    }
+
+    if (token.type != TokenType::TERM)
+      return false;
+
+    strQuery = ToFTSPhrase(token.term);
+    return true;
+  }
+
+  static std::string ToFTSPhrase(const std::string& strTerm)
+  {
+    // LIKE wildcards and terms shorter than a trigram can't be looked up in the index
+    if (strTerm.find_first_of("%_") != std::string::npos)
+      return {};
+
+    const size_t length = std::count_if(strTerm.begin(), strTerm.end(),
+                                        [](char c) { return (c & 0xC0) != 0x80; });
+    if (length < 3)
+      return {};
+
+    std::string strPhrase(strTerm);
+    StringUtils::Replace(strPhrase, "\"", "\"\"");
+    return "\"" + strPhrase + "\"";
+  }
+
   void Parse(const std::string& strSearchTerm)
   {
     std::string strParsedSearchTerm(strSearchTerm);
@@ -538,6 +802,7 @@ private:
         std::string strDummy;
         GetAndCutNextTerm(strParsedSearchTerm, strDummy);
         strFragment += " NOT ";
+        m_tokens.push_back({TokenType::NOT, {}});
         bNextOR = false;
       }
       else if (StringUtils::StartsWith(strParsedSearchTerm, "+") ||
@@ -546,6 +811,7 @@ private:
         std::string strDummy;
         GetAndCutNextTerm(strParsedSearchTerm, strDummy);
         strFragment += " AND ";
+        m_tokens.push_back({TokenType::AND, {}});
         bNextOR = false;
       }
       else if (StringUtils::StartsWith(strParsedSearchTerm, "|") ||
@@ -554,6 +820,7 @@ private:
         std::string strDummy;
         GetAndCutNextTerm(strParsedSearchTerm, strDummy);
         strFragment += " OR ";
+        m_tokens.push_back({TokenType::OR, {}});
         bNextOR = false;
       }
       else
@@ -563,7 +830,12 @@ private:
         if (!strTerm.empty())
         {
           if (bNextOR && !m_fragments.empty())
+          {
             strFragment += " OR "; // default operator
+            m_tokens.push_back({TokenType::OR, {}});
+          }
+
+          m_tokens.push_back({TokenType::TERM, strTerm});
 
           strFragment += "(UPPER(";
 
@@ -614,6 +886,7 @@ private:
   }
 
   std::vector<std::string> m_fragments;
+  std::vector<Token> m_tokens;
 };
 
 } // unnamed namespace
@@ -688,6 +961,17 @@ std::vector<std::shared_ptr<CPVREpgInfoTag>> CPVREpgDatabase::GetEpgTags(
     }
 
     filter.AppendWhere(strWhere);
+
+    // narrow the search down to the tags found in the search index
+    if (HasSearchIndex())
+    {
+      const std::string strMatch = conv.ToFTS(
+          searchData.m_bSearchInDescription ? "sTitle sPlotOutline sPlot" : "sTitle sPlotOutline");
+      if (!strMatch.empty())
+        filter.AppendWhere(PrepareSQL(
+            "idBroadcast IN (SELECT rowid FROM epgtags_fts WHERE epgtags_fts MATCH '%s')",
+            strMatch.c_str()));
+    }
   }
 
   if (BuildSQL(strQuery, filter, strQuery))
@@ -1127,6 +1411,16 @@ bool CPVREpgDatabase::QueuePersistQuery(const CPVREpgInfoTag& tag)
 
   CSingleLock lock(m_critSection);
 
+  const bool bHasSearchIndex = HasSearchIndex();
+  if (bHasSearchIndex)
+  {
+    // the tag replaced by REPLACE INTO below is deleted without firing the delete trigger
+    strQuery = PrepareSQL("DELETE FROM epgtags_fts WHERE rowid IN (SELECT idBroadcast FROM epgtags "
+                          "WHERE (idEpg = %u AND iStartTime = %u) OR idBroadcast = %i);",
+                          tag.EpgID(), static_cast<unsigned int>(iStartTime), iBroadcastId);
+    QueueInsertQuery(strQuery);
+  }
+
   if (iBroadcastId < 0)
   {
     strQuery = PrepareSQL("REPLACE INTO epgtags (idEpg, iStartTime, "
@@ -1161,6 +1455,16 @@ bool CPVREpgDatabase::QueuePersistQuery(const CPVREpgInfoTag& tag)
   }
 
   QueueInsertQuery(strQuery);
+
+  if (bHasSearchIndex)
+  {
+    // queued right after the tag, so the last inserted row is the tag
+    strQuery = PrepareSQL("INSERT OR REPLACE INTO epgtags_fts (rowid, sTitle, sPlotOutline, sPlot) "
+                          "VALUES (last_insert_rowid(), '%s', '%s', '%s');",
+                          tag.Title().c_str(), tag.PlotOutline().c_str(), tag.Plot().c_str());
+    QueueInsertQuery(strQuery);
+  }
+
   return true;
 }
 
@@ -65,7 +65,7 @@ namespace PVR
      * @brief Get the minimal database version that is required to operate correctly.
      * @return The minimal database version.
      */
-    int GetSchemaVersion() const override { return 13; }
+    int GetSchemaVersion() const override { return 14; }
 
     /*!
      * @brief Get the default sqlite database filename.
@@ -308,6 +308,40 @@ namespace PVR
 
     std::shared_ptr<CPVREpgInfoTag> CreateEpgTag(const std::unique_ptr<dbiplus::Dataset>& pDS);
 
+    /*!
+     * @brief Create the full-text search index of the EPG tags, if supported by the database.
+     * @return True if the index was created, false otherwise.
+     */
+    bool CreateSearchIndex();
+
+    /*!
+     * @brief Check whether the full-text search index exists and can be used.
+     * @param pDS The dataset to run the check on.
+     * @return True if the index can be used, false otherwise.
+     */
+    bool IsSearchIndexUsable(const std::unique_ptr<dbiplus::Dataset>& pDS);
+
+    /*!
+     * @brief Fill the full-text search index from the EPG tags and start maintaining it.
+     * @param pDS The dataset to run the queries on.
+     * @return True on success, false otherwise.
+     */
+    bool RebuildSearchIndex(const std::unique_ptr<dbiplus::Dataset>& pDS);
+
+    /*!
+     * @brief Check whether searches and persisted tags use the full-text search index.
+     * @return True if the index is used, false otherwise.
+     */
+    bool HasSearchIndex();
+
+    enum class SearchIndexState
+    {
+      UNKNOWN,
+      AVAILABLE,
+      UNAVAILABLE,
+    };
+
     CCriticalSection m_critSection;
+    SearchIndexState m_searchIndexState = SearchIndexState::UNKNOWN;
   };
 }
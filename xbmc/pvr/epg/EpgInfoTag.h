@@ -28,6 +28,7 @@ namespace PVR
                                public std::enable_shared_from_this<CPVREpgInfoTag>
   {
     friend class CPVREpgDatabase;
+    friend class CPVREpgTagsTimeline;
 
   public:
     /*!
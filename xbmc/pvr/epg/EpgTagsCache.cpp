@@ -14,6 +14,7 @@
 #include "pvr/epg/EpgChannelData.h"
 #include "pvr/epg/EpgDatabase.h"
 #include "pvr/epg/EpgInfoTag.h"
+#include "pvr/epg/EpgTagsTimeline.h"
 #include "utils/log.h"
 
 using namespace PVR;
@@ -80,15 +81,11 @@ void CPVREpgTagsCache::Refresh(bool bUpdateIfNeeded)
     m_nowActiveTag.reset();
     m_nextStartingTag.reset();
 
-    for (const auto& tag : m_changedTags)
+    m_nowActiveTag = m_changedTags.GetActiveTag(activeTime);
+    if (m_nowActiveTag)
     {
-      if (tag.second->StartAsUTC() <= activeTime && tag.second->EndAsUTC() > activeTime)
-      {
-        m_nowActiveTag = tag.second;
-        m_nowActiveStart = m_nowActiveTag->StartAsUTC();
-        m_nowActiveEnd = m_nowActiveTag->EndAsUTC();
-        break;
-      }
+      m_nowActiveStart = m_nowActiveTag->StartAsUTC();
+      m_nowActiveEnd = m_nowActiveTag->EndAsUTC();
     }
 
     if (!m_nowActiveTag && m_database)
@@ -135,17 +132,9 @@ void CPVREpgTagsCache::RefreshLastEndedTag(const CDateTime& activeTime)
       m_lastEndedTag->SetChannelData(m_channelData);
   }
 
-  for (auto it = m_changedTags.rbegin(); it != m_changedTags.rend(); ++it)
-  {
-    if (it->second->WasActive())
-    {
-      if (!m_lastEndedTag || m_lastEndedTag->EndAsUTC() < it->second->EndAsUTC())
-      {
-        m_lastEndedTag = it->second;
-        break;
-      }
-    }
-  }
+  const std::shared_ptr<CPVREpgInfoTag> changedTag = m_changedTags.GetLastEndedTag(activeTime);
+  if (changedTag && (!m_lastEndedTag || m_lastEndedTag->EndAsUTC() < changedTag->EndAsUTC()))
+    m_lastEndedTag = changedTag;
 }
 
 void CPVREpgTagsCache::RefreshNextStartingTag(const CDateTime& activeTime)
@@ -157,15 +146,8 @@ void CPVREpgTagsCache::RefreshNextStartingTag(const CDateTime& activeTime)
       m_nextStartingTag->SetChannelData(m_channelData);
   }
 
-  for (const auto& tag : m_changedTags)
-  {
-    if (tag.second->IsUpcoming())
-    {
-      if (!m_nextStartingTag || m_nextStartingTag->StartAsUTC() > tag.second->StartAsUTC())
-      {
-        m_nextStartingTag = tag.second;
-        break;
-      }
-    }
-  }
+  const std::shared_ptr<CPVREpgInfoTag> changedTag = m_changedTags.GetNextStartingTag(activeTime);
+  if (changedTag &&
+      (!m_nextStartingTag || m_nextStartingTag->StartAsUTC() > changedTag->StartAsUTC()))
+    m_nextStartingTag = changedTag;
 }
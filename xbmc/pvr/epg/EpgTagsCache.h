@@ -10,7 +10,6 @@
 
 #include "XBDateTime.h"
 
-#include <map>
 #include <memory>
 
 namespace PVR
@@ -18,6 +17,7 @@ namespace PVR
 class CPVREpgChannelData;
 class CPVREpgDatabase;
 class CPVREpgInfoTag;
+class CPVREpgTagsTimeline;
 
 class CPVREpgTagsCache
 {
@@ -26,7 +26,7 @@ public:
   CPVREpgTagsCache(int iEpgID,
                    const std::shared_ptr<CPVREpgChannelData>& channelData,
                    const std::shared_ptr<CPVREpgDatabase>& database,
-                   const std::map<CDateTime, std::shared_ptr<CPVREpgInfoTag>>& changedTags)
+                   const CPVREpgTagsTimeline& changedTags)
     : m_iEpgID(iEpgID), m_channelData(channelData), m_database(database), m_changedTags(changedTags)
   {
   }
@@ -47,7 +47,7 @@ private:
   int m_iEpgID;
   std::shared_ptr<CPVREpgChannelData> m_channelData;
   std::shared_ptr<CPVREpgDatabase> m_database;
-  const std::map<CDateTime, std::shared_ptr<CPVREpgInfoTag>>& m_changedTags;
+  const CPVREpgTagsTimeline& m_changedTags;
 
   std::shared_ptr<CPVREpgInfoTag> m_lastEndedTag;
   std::shared_ptr<CPVREpgInfoTag> m_nowActiveTag;
@@ -27,6 +27,8 @@ CPVREpgTagsContainer::CPVREpgTagsContainer(int iEpgID,
   : m_iEpgID(iEpgID),
     m_channelData(channelData),
     m_database(database),
+    m_changedTags(iEpgID, channelData),
+    m_deletedTags(iEpgID, channelData),
     m_tagsCache(new CPVREpgTagsCache(iEpgID, channelData, database, m_changedTags))
 {
 }
@@ -36,16 +38,16 @@ CPVREpgTagsContainer::~CPVREpgTagsContainer() = default;
 void CPVREpgTagsContainer::SetEpgID(int iEpgID)
 {
   m_iEpgID = iEpgID;
-  for (const auto& tag : m_changedTags)
-    tag.second->SetEpgID(iEpgID);
+  m_changedTags.SetEpgID(iEpgID);
+  m_deletedTags.SetEpgID(iEpgID);
 }
 
 void CPVREpgTagsContainer::SetChannelData(const std::shared_ptr<CPVREpgChannelData>& data)
 {
   m_channelData = data;
   m_tagsCache->SetChannelData(data);
-  for (const auto& tag : m_changedTags)
-    tag.second->SetChannelData(data);
+  m_changedTags.SetChannelData(data);
+  m_deletedTags.SetChannelData(data);
 }
 
 namespace
@@ -130,36 +132,25 @@ bool FixOverlap(const std::shared_ptr<CPVREpgInfoTag>& previousTag,
 
 bool CPVREpgTagsContainer::UpdateEntries(const CPVREpgTagsContainer& tags)
 {
-  if (tags.m_changedTags.empty())
+  if (tags.m_changedTags.IsEmpty())
     return false;
 
   if (m_database)
   {
-    const CDateTime minEventEnd = (*tags.m_changedTags.cbegin()).second->StartAsUTC() + ONE_SECOND;
-    const CDateTime maxEventStart = (*tags.m_changedTags.crbegin()).second->EndAsUTC();
+    const CDateTime minEventEnd = tags.m_changedTags.GetFirstStartTime() + ONE_SECOND;
+    const CDateTime maxEventStart = tags.m_changedTags.GetLastEndTime();
 
     std::vector<std::shared_ptr<CPVREpgInfoTag>> existingTags =
         m_database->GetEpgTagsByMinEndMaxStartTime(m_iEpgID, minEventEnd, maxEventStart);
 
-    if (!m_changedTags.empty())
-    {
-      // Fix data inconsistencies
-      for (const auto& changedTagsEntry : m_changedTags)
-      {
-        const auto& changedTag = changedTagsEntry.second;
-
-        if (changedTag->EndAsUTC() > minEventEnd && changedTag->StartAsUTC() < maxEventStart)
-        {
-          // tag is in queried range, thus it could cause inconsistencies...
-          ResolveConflictingTags(changedTag, existingTags);
-        }
-      }
-    }
+    // Fix data inconsistencies. Tags in queried range could cause inconsistencies...
+    for (const auto& changedTag : m_changedTags.GetTags(minEventEnd, maxEventStart))
+      ResolveConflictingTags(changedTag, existingTags);
 
     bool bResetCache = false;
-    for (const auto& tagsEntry : tags.m_changedTags)
+    for (size_t i = 0; i < tags.m_changedTags.Size(); ++i)
     {
-      const auto& tag = tagsEntry.second;
+      const std::shared_ptr<CPVREpgInfoTag> tag = tags.m_changedTags.GetTagAt(i);
 
       tag->SetChannelData(m_channelData);
       tag->SetEpgID(m_iEpgID);
@@ -182,14 +173,14 @@ bool CPVREpgTagsContainer::UpdateEntries(const CPVREpgTagsContainer& tags)
         if (existingTag->Update(*tag, false))
         {
           // tag differs from existing tag and must be persisted
-          m_changedTags.insert({existingTag->StartAsUTC(), existingTag});
+          m_changedTags.Insert(*existingTag);
           bResetCache = true;
         }
       }
       else
       {
         // new tags must always be persisted
-        m_changedTags.insert({tag->StartAsUTC(), tag});
+        m_changedTags.Insert(*tag);
         bResetCache = true;
       }
     }
@@ -199,8 +190,8 @@ bool CPVREpgTagsContainer::UpdateEntries(const CPVREpgTagsContainer& tags)
   }
   else
   {
-    for (const auto& tag : tags.m_changedTags)
-      UpdateEntry(tag.second);
+    for (size_t i = 0; i < tags.m_changedTags.Size(); ++i)
+      UpdateEntry(tags.m_changedTags.GetTagAt(i));
   }
 
   return true;
@@ -226,26 +217,6 @@ void CPVREpgTagsContainer::FixOverlappingEvents(
   }
 }
 
-void CPVREpgTagsContainer::FixOverlappingEvents(
-    std::map<CDateTime, std::shared_ptr<CPVREpgInfoTag>>& tags) const
-{
-  std::shared_ptr<CPVREpgInfoTag> previousTag;
-  for (auto it = tags.begin(); it != tags.end();)
-  {
-    const std::shared_ptr<CPVREpgInfoTag> currentTag = (*it).second;
-    if (FixOverlap(previousTag, currentTag))
-    {
-      previousTag = currentTag;
-      ++it;
-    }
-    else
-    {
-      it = tags.erase(it);
-      m_tagsCache->Reset();
-    }
-  }
-}
-
 std::shared_ptr<CPVREpgInfoTag> CPVREpgTagsContainer::CreateEntry(
     const std::shared_ptr<CPVREpgInfoTag>& tag) const
 {
@@ -277,14 +248,14 @@ bool CPVREpgTagsContainer::UpdateEntry(const std::shared_ptr<CPVREpgInfoTag>& ta
     if (existingTag->Update(*tag, false))
     {
       // tag differs from existing tag and must be persisted
-      m_changedTags.insert({existingTag->StartAsUTC(), existingTag});
+      m_changedTags.Insert(*existingTag);
       m_tagsCache->Reset();
     }
   }
   else
   {
     // new tags must always be persisted
-    m_changedTags.insert({tag->StartAsUTC(), tag});
+    m_changedTags.Insert(*tag);
     m_tagsCache->Reset();
   }
 
@@ -293,31 +264,19 @@ bool CPVREpgTagsContainer::UpdateEntry(const std::shared_ptr<CPVREpgInfoTag>& ta
 
 bool CPVREpgTagsContainer::DeleteEntry(const std::shared_ptr<CPVREpgInfoTag>& tag)
 {
-  m_changedTags.erase(tag->StartAsUTC());
-  m_deletedTags.insert({tag->StartAsUTC(), tag});
+  m_changedTags.Erase(tag->StartAsUTC());
+  m_deletedTags.Insert(*tag);
   m_tagsCache->Reset();
   return true;
 }
 
 void CPVREpgTagsContainer::Cleanup(const CDateTime& time)
 {
-  for (auto it = m_changedTags.begin(); it != m_changedTags.end();)
-  {
-    if (it->second->EndAsUTC() < time)
-    {
-      m_tagsCache->Reset();
-
-      const auto it1 = m_deletedTags.find(it->first);
-      if (it1 != m_deletedTags.end())
-        m_deletedTags.erase(it1);
+  if (m_changedTags.EraseEndedBefore(time))
+    m_tagsCache->Reset();
 
-      it = m_changedTags.erase(it);
-    }
-    else
-    {
-      ++it;
-    }
-  }
+  // the database deletes these tags below
+  m_deletedTags.EraseEndedBefore(time);
 
   if (m_database)
     m_database->DeleteEpgTags(m_iEpgID, time);
@@ -325,12 +284,12 @@ void CPVREpgTagsContainer::Cleanup(const CDateTime& time)
 
 void CPVREpgTagsContainer::Clear()
 {
-  m_changedTags.clear();
+  m_changedTags.Clear();
 }
 
 bool CPVREpgTagsContainer::IsEmpty() const
 {
-  if (!m_changedTags.empty())
+  if (!m_changedTags.IsEmpty())
     return false;
 
   if (m_database)
@@ -341,9 +300,9 @@ bool CPVREpgTagsContainer::IsEmpty() const
 
 std::shared_ptr<CPVREpgInfoTag> CPVREpgTagsContainer::GetTag(const CDateTime& startTime) const
 {
-  const auto it = m_changedTags.find(startTime);
-  if (it != m_changedTags.cend())
-    return (*it).second;
+  const std::shared_ptr<CPVREpgInfoTag> tag = m_changedTags.GetTag(startTime);
+  if (tag)
+    return tag;
 
   if (m_database)
     return CreateEntry(m_database->GetEpgTagByStartTime(m_iEpgID, startTime));
@@ -356,11 +315,9 @@ std::shared_ptr<CPVREpgInfoTag> CPVREpgTagsContainer::GetTag(unsigned int iUniqu
   if (iUniqueBroadcastID == EPG_TAG_INVALID_UID)
     return {};
 
-  for (const auto& tag : m_changedTags)
-  {
-    if (tag.second->UniqueBroadcastID() == iUniqueBroadcastID)
-      return tag.second;
-  }
+  const std::shared_ptr<CPVREpgInfoTag> tag = m_changedTags.GetTag(iUniqueBroadcastID);
+  if (tag)
+    return tag;
 
   if (m_database)
     return CreateEntry(m_database->GetEpgTagByUniqueBroadcastID(m_iEpgID, iUniqueBroadcastID));
@@ -373,11 +330,9 @@ std::shared_ptr<CPVREpgInfoTag> CPVREpgTagsContainer::GetTagByDatabaseID(int iDa
   if (iDatabaseID <= 0)
     return {};
 
-  for (const auto& tag : m_changedTags)
-  {
-    if (tag.second->DatabaseID() == iDatabaseID)
-      return tag.second;
-  }
+  const std::shared_ptr<CPVREpgInfoTag> tag = m_changedTags.GetTagByDatabaseID(iDatabaseID);
+  if (tag)
+    return tag;
 
   if (m_database)
     return CreateEntry(m_database->GetEpgTagByDatabaseID(m_iEpgID, iDatabaseID));
@@ -388,16 +343,9 @@ std::shared_ptr<CPVREpgInfoTag> CPVREpgTagsContainer::GetTagByDatabaseID(int iDa
 std::shared_ptr<CPVREpgInfoTag> CPVREpgTagsContainer::GetTagBetween(const CDateTime& start,
                                                                     const CDateTime& end) const
 {
-  for (const auto& tag : m_changedTags)
-  {
-    if (tag.second->StartAsUTC() >= start)
-    {
-      if (tag.second->EndAsUTC() <= end)
-        return tag.second;
-      else
-        break;
-    }
-  }
+  const std::shared_ptr<CPVREpgInfoTag> tag = m_changedTags.GetTagBetween(start, end);
+  if (tag)
+    return tag;
 
   if (m_database)
   {
@@ -446,14 +394,10 @@ std::vector<std::shared_ptr<CPVREpgInfoTag>> CPVREpgTagsContainer::GetTimeline(
   {
     std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
 
-    if (!m_changedTags.empty() && !m_database->GetFirstStartTime(m_iEpgID).IsValid())
+    if (!m_changedTags.IsEmpty() && !m_database->GetFirstStartTime(m_iEpgID).IsValid())
     {
       // nothing in the db yet. take what we have in memory.
-      for (const auto& tag : m_changedTags)
-      {
-        if (tag.second->EndAsUTC() > minEventEnd && tag.second->StartAsUTC() < maxEventStart)
-          tags.emplace_back(tag.second);
-      }
+      tags = m_changedTags.GetTags(minEventEnd, maxEventStart);
 
       if (!tags.empty())
         FixOverlappingEvents(tags);
@@ -462,20 +406,9 @@ std::vector<std::shared_ptr<CPVREpgInfoTag>> CPVREpgTagsContainer::GetTimeline(
     {
       tags = m_database->GetEpgTagsByMinEndMaxStartTime(m_iEpgID, minEventEnd, maxEventStart);
 
-      if (!m_changedTags.empty())
-      {
-        // Fix data inconsistencies
-        for (const auto& changedTagsEntry : m_changedTags)
-        {
-          const auto& changedTag = changedTagsEntry.second;
-
-          if (changedTag->EndAsUTC() > minEventEnd && changedTag->StartAsUTC() < maxEventStart)
-          {
-            // tag is in queried range, thus it could cause inconsistencies...
-            ResolveConflictingTags(changedTag, tags);
-          }
-        }
-      }
+      // Fix data inconsistencies. Tags in queried range could cause inconsistencies...
+      for (const auto& changedTag : m_changedTags.GetTags(minEventEnd, maxEventStart))
+        ResolveConflictingTags(changedTag, tags);
     }
 
     tags = CreateEntries(tags);
@@ -545,11 +478,10 @@ std::vector<std::shared_ptr<CPVREpgInfoTag>> CPVREpgTagsContainer::GetAllTags()
   if (m_database)
   {
     std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
-    if (!m_changedTags.empty() && !m_database->GetFirstStartTime(m_iEpgID).IsValid())
+    if (!m_changedTags.IsEmpty() && !m_database->GetFirstStartTime(m_iEpgID).IsValid())
     {
       // nothing in the db yet. take what we have in memory.
-      for (const auto& tag : m_changedTags)
-        tags.emplace_back(tag.second);
+      tags = m_changedTags.GetAllTags();
 
       FixOverlappingEvents(tags);
     }
@@ -557,14 +489,9 @@ std::vector<std::shared_ptr<CPVREpgInfoTag>> CPVREpgTagsContainer::GetAllTags()
     {
       tags = m_database->GetAllEpgTags(m_iEpgID);
 
-      if (!m_changedTags.empty())
-      {
-        // Fix data inconsistencies
-        for (const auto& changedTagsEntry : m_changedTags)
-        {
-          ResolveConflictingTags(changedTagsEntry.second, tags);
-        }
-      }
+      // Fix data inconsistencies
+      for (size_t i = 0; i < m_changedTags.Size(); ++i)
+        ResolveConflictingTags(m_changedTags.GetTagAt(i), tags);
     }
 
     return CreateEntries(tags);
@@ -577,8 +504,8 @@ CDateTime CPVREpgTagsContainer::GetFirstStartTime() const
 {
   CDateTime result;
 
-  if (!m_changedTags.empty())
-    result = (*m_changedTags.cbegin()).second->StartAsUTC();
+  if (!m_changedTags.IsEmpty())
+    result = m_changedTags.GetFirstStartTime();
 
   if (m_database)
   {
@@ -594,8 +521,8 @@ CDateTime CPVREpgTagsContainer::GetLastEndTime() const
 {
   CDateTime result;
 
-  if (!m_changedTags.empty())
-    result = (*m_changedTags.crbegin()).second->EndAsUTC();
+  if (!m_changedTags.IsEmpty())
+    result = m_changedTags.GetLastEndTime();
 
   if (m_database)
   {
@@ -609,7 +536,12 @@ CDateTime CPVREpgTagsContainer::GetLastEndTime() const
 
 bool CPVREpgTagsContainer::NeedsSave() const
 {
-  return !m_changedTags.empty() || !m_deletedTags.empty();
+  return !m_changedTags.IsEmpty() || !m_deletedTags.IsEmpty();
+}
+
+size_t CPVREpgTagsContainer::GetMemoryUsage() const
+{
+  return m_changedTags.GetMemoryUsage() + m_deletedTags.GetMemoryUsage();
 }
 
 void CPVREpgTagsContainer::QueuePersistQuery()
@@ -619,25 +551,43 @@ void CPVREpgTagsContainer::QueuePersistQuery()
     m_database->Lock();
 
     CLog::LogFC(LOGDEBUG, LOGEPG, "EPG Tags Container: Updating {}, deleting {} events...",
-                m_changedTags.size(), m_deletedTags.size());
+                m_changedTags.Size(), m_deletedTags.Size());
 
-    for (const auto& tag : m_deletedTags)
-      m_database->QueueDeleteTagQuery(*tag.second);
+    for (size_t i = 0; i < m_deletedTags.Size(); ++i)
+      m_database->QueueDeleteTagQuery(*m_deletedTags.GetTagAt(i));
 
-    m_deletedTags.clear();
+    m_deletedTags.Clear();
 
-    FixOverlappingEvents(m_changedTags);
-
-    for (const auto& tag : m_changedTags)
-    {
+    const auto persistTag = [this](const std::shared_ptr<CPVREpgInfoTag>& tag) {
       // remove any conflicting events from database before persisting the new event
       m_database->QueueDeleteEpgTagsByMinEndMaxStartTimeQuery(
-          m_iEpgID, tag.second->StartAsUTC() + ONE_SECOND, tag.second->EndAsUTC() - ONE_SECOND);
+          m_iEpgID, tag->StartAsUTC() + ONE_SECOND, tag->EndAsUTC() - ONE_SECOND);
+
+      tag->QueuePersistQuery(m_database);
+    };
 
-      tag.second->QueuePersistQuery(m_database);
+    // Fix overlapping events on the way. A tag is persisted once its successor is known, as
+    // the successor may shorten it.
+    std::shared_ptr<CPVREpgInfoTag> previousTag;
+    for (size_t i = 0; i < m_changedTags.Size(); ++i)
+    {
+      const std::shared_ptr<CPVREpgInfoTag> tag = m_changedTags.GetTagAt(i);
+      if (!FixOverlap(previousTag, tag))
+      {
+        m_tagsCache->Reset();
+        continue;
+      }
+
+      if (previousTag)
+        persistTag(previousTag);
+
+      previousTag = tag;
     }
 
-    m_changedTags.clear();
+    if (previousTag)
+      persistTag(previousTag);
+
+    m_changedTags.Clear();
 
     m_database->Unlock();
   }
@@ -9,8 +9,8 @@
 #pragma once
 
 #include "XBDateTime.h"
+#include "pvr/epg/EpgTagsTimeline.h"
 
-#include <map>
 #include <memory>
 #include <vector>
 
@@ -165,6 +165,12 @@ public:
    */
   bool NeedsSave() const;
 
+  /*!
+   * @brief Get the approximate number of bytes allocated by the unsaved data of this container.
+   * @return The number of bytes.
+   */
+  size_t GetMemoryUsage() const;
+
   /*!
    * @brief Write the query to persist data into database's queue
    */
@@ -204,15 +210,15 @@ private:
    * @param tags The events to check/fix.
    */
   void FixOverlappingEvents(std::vector<std::shared_ptr<CPVREpgInfoTag>>& tags) const;
-  void FixOverlappingEvents(std::map<CDateTime, std::shared_ptr<CPVREpgInfoTag>>& tags) const;
 
   int m_iEpgID = 0;
   std::shared_ptr<CPVREpgChannelData> m_channelData;
   const std::shared_ptr<CPVREpgDatabase> m_database;
-  const std::unique_ptr<CPVREpgTagsCache> m_tagsCache;
 
-  std::map<CDateTime, std::shared_ptr<CPVREpgInfoTag>> m_changedTags;
-  std::map<CDateTime, std::shared_ptr<CPVREpgInfoTag>> m_deletedTags;
+  CPVREpgTagsTimeline m_changedTags;
+  CPVREpgTagsTimeline m_deletedTags;
+
+  const std::unique_ptr<CPVREpgTagsCache> m_tagsCache;
 };
 
 } // namespace PVR
@@ -0,0 +1,416 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "EpgTagsTimeline.h"
+
+#include "pvr/epg/EpgChannelData.h"
+#include "pvr/epg/EpgInfoTag.h"
+#include "threads/SingleLock.h"
+
+#include <algorithm>
+
+using namespace PVR;
+
+namespace
+{
+// Lists are stored as one pool string, each element terminated by '\0', which can not occur in
+// strings passed by the add-ons. Unlike EPG_STRING_TOKEN_SEPARATOR this keeps every list intact.
+const char LIST_TERMINATOR = '\0';
+
+time_t AsTime(const CDateTime& time)
+{
+  time_t result = 0;
+  time.GetAsTime(result);
+  return result;
+}
+
+// Bytes allocated outside of the string object itself
+size_t HeapSize(const std::string& str)
+{
+  const char* data = str.data();
+  const char* object = reinterpret_cast<const char*>(&str);
+  if (data >= object && data < object + sizeof(str))
+    return 0;
+
+  return str.capacity() + 1;
+}
+
+template<typename T>
+size_t VectorSize(const std::vector<T>& vector)
+{
+  return vector.capacity() * sizeof(T);
+}
+
+} // unnamed namespace
+
+CPVREpgStringPool::CPVREpgStringPool()
+{
+  Clear();
+}
+
+uint32_t CPVREpgStringPool::Add(const std::string& str)
+{
+  const auto result = m_ids.insert({str, static_cast<uint32_t>(m_strings.size())});
+  if (result.second)
+    m_strings.emplace_back(&result.first->first);
+
+  return result.first->second;
+}
+
+void CPVREpgStringPool::Clear()
+{
+  m_ids.clear();
+  m_strings.clear();
+  Add("");
+}
+
+size_t CPVREpgStringPool::GetMemoryUsage() const
+{
+  // Every entry of an unordered_map is a node holding the value, the next pointer and the hash
+  const size_t nodeSize = sizeof(std::pair<const std::string, uint32_t>) + 2 * sizeof(void*);
+
+  size_t result = VectorSize(m_strings) + m_ids.bucket_count() * sizeof(void*);
+  for (const auto& entry : m_ids)
+    result += nodeSize + HeapSize(entry.first);
+
+  return result;
+}
+
+CPVREpgTagsTimeline::CPVREpgTagsTimeline(int iEpgID,
+                                         const std::shared_ptr<CPVREpgChannelData>& channelData)
+  : m_iEpgID(iEpgID), m_channelData(channelData)
+{
+}
+
+void CPVREpgTagsTimeline::Insert(const CPVREpgInfoTag& tag)
+{
+  CSingleLock lock(tag.m_critSection);
+
+  const time_t startTime = AsTime(tag.m_startTime);
+  const time_t endTime = AsTime(tag.m_endTime);
+
+  EventData data;
+  data.iDatabaseID = tag.m_iDatabaseID;
+  data.iUniqueBroadcastID = tag.m_iUniqueBroadcastID;
+  data.iGenreType = tag.m_iGenreType;
+  data.iGenreSubType = tag.m_iGenreSubType;
+  data.iParentalRating = tag.m_iParentalRating;
+  data.iStarRating = tag.m_iStarRating;
+  data.iSeriesNumber = tag.m_iSeriesNumber;
+  data.iEpisodeNumber = tag.m_iEpisodeNumber;
+  data.iEpisodePart = tag.m_iEpisodePart;
+  data.iYear = tag.m_iYear;
+  data.iFlags = tag.m_iFlags;
+  data.title = m_strings.Add(tag.m_strTitle);
+  data.plotOutline = m_strings.Add(tag.m_strPlotOutline);
+  data.plot = m_strings.Add(tag.m_strPlot);
+  data.originalTitle = m_strings.Add(tag.m_strOriginalTitle);
+  data.cast = AddList(tag.m_cast);
+  data.directors = AddList(tag.m_directors);
+  data.writers = AddList(tag.m_writers);
+  data.genre = AddList(tag.m_genre);
+  data.imdbNumber = m_strings.Add(tag.m_strIMDBNumber);
+  data.episodeName = m_strings.Add(tag.m_strEpisodeName);
+  data.iconPath = m_strings.Add(tag.m_strIconPath);
+  data.seriesLink = m_strings.Add(tag.m_strSeriesLink);
+  data.firstAired =
+      m_strings.Add(tag.m_firstAired.IsValid() ? tag.m_firstAired.GetAsW3CDate() : "");
+
+  m_maxDuration = std::max(m_maxDuration, endTime - startTime);
+
+  // Guide data usually arrives in chronological order, appending is the common case
+  const size_t index = LowerBound(startTime);
+  if (index < m_startTimes.size() && m_startTimes[index] == startTime)
+  {
+    // The strings of the replaced tag stay in the pool until the timeline is cleared
+    m_endTimes[index] = endTime;
+    m_data[index] = data;
+  }
+  else
+  {
+    m_startTimes.insert(m_startTimes.begin() + index, startTime);
+    m_endTimes.insert(m_endTimes.begin() + index, endTime);
+    m_data.insert(m_data.begin() + index, data);
+  }
+}
+
+bool CPVREpgTagsTimeline::Erase(const CDateTime& startTime)
+{
+  const time_t time = AsTime(startTime);
+  const size_t index = LowerBound(time);
+  if (index == m_startTimes.size() || m_startTimes[index] != time)
+    return false;
+
+  m_startTimes.erase(m_startTimes.begin() + index);
+  m_endTimes.erase(m_endTimes.begin() + index);
+  m_data.erase(m_data.begin() + index);
+
+  if (m_startTimes.empty())
+    Clear();
+
+  return true;
+}
+
+bool CPVREpgTagsTimeline::EraseEndedBefore(const CDateTime& time)
+{
+  const time_t endTime = AsTime(time);
+
+  bool bErased = false;
+  std::vector<bool> erase(m_endTimes.size(), false);
+  for (size_t i = 0; i < m_endTimes.size(); ++i)
+  {
+    if (m_endTimes[i] < endTime)
+    {
+      erase[i] = true;
+      bErased = true;
+    }
+  }
+
+  if (bErased)
+    EraseIf(erase);
+
+  return bErased;
+}
+
+void CPVREpgTagsTimeline::EraseIf(const std::vector<bool>& erase)
+{
+  size_t kept = 0;
+  for (size_t i = 0; i < erase.size(); ++i)
+  {
+    if (erase[i])
+      continue;
+
+    m_startTimes[kept] = m_startTimes[i];
+    m_endTimes[kept] = m_endTimes[i];
+    m_data[kept] = m_data[i];
+    ++kept;
+  }
+
+  m_startTimes.resize(kept);
+  m_endTimes.resize(kept);
+  m_data.resize(kept);
+
+  if (kept == 0)
+    Clear();
+}
+
+void CPVREpgTagsTimeline::Clear()
+{
+  // Release the memory, timelines are cleared after every persist
+  std::vector<time_t>().swap(m_startTimes);
+  std::vector<time_t>().swap(m_endTimes);
+  std::vector<EventData>().swap(m_data);
+  m_maxDuration = 0;
+  m_strings.Clear();
+}
+
+std::shared_ptr<CPVREpgInfoTag> CPVREpgTagsTimeline::GetTagAt(size_t index) const
+{
+  const EventData& data = m_data[index];
+
+  std::shared_ptr<CPVREpgInfoTag> tag(new CPVREpgInfoTag());
+  tag->m_startTime = CDateTime(m_startTimes[index]);
+  tag->m_endTime = CDateTime(m_endTimes[index]);
+  tag->m_iDatabaseID = data.iDatabaseID;
+  tag->m_iUniqueBroadcastID = data.iUniqueBroadcastID;
+  tag->m_iGenreType = data.iGenreType;
+  tag->m_iGenreSubType = data.iGenreSubType;
+  tag->m_iParentalRating = data.iParentalRating;
+  tag->m_iStarRating = data.iStarRating;
+  tag->m_iSeriesNumber = data.iSeriesNumber;
+  tag->m_iEpisodeNumber = data.iEpisodeNumber;
+  tag->m_iEpisodePart = data.iEpisodePart;
+  tag->m_iYear = data.iYear;
+  tag->m_iFlags = data.iFlags;
+  tag->m_strTitle = m_strings.Get(data.title);
+  tag->m_strPlotOutline = m_strings.Get(data.plotOutline);
+  tag->m_strPlot = m_strings.Get(data.plot);
+  tag->m_strOriginalTitle = m_strings.Get(data.originalTitle);
+  tag->m_cast = GetList(data.cast);
+  tag->m_directors = GetList(data.directors);
+  tag->m_writers = GetList(data.writers);
+  tag->m_genre = GetList(data.genre);
+  tag->m_strIMDBNumber = m_strings.Get(data.imdbNumber);
+  tag->m_strEpisodeName = m_strings.Get(data.episodeName);
+  tag->m_strIconPath = m_strings.Get(data.iconPath);
+  tag->m_strSeriesLink = m_strings.Get(data.seriesLink);
+
+  const std::string& firstAired = m_strings.Get(data.firstAired);
+  if (!firstAired.empty())
+    tag->m_firstAired.SetFromW3CDate(firstAired);
+
+  if (m_channelData)
+    tag->m_channelData = m_channelData;
+  tag->m_iEpgID = m_iEpgID;
+  tag->UpdatePath();
+
+  return tag;
+}
+
+std::shared_ptr<CPVREpgInfoTag> CPVREpgTagsTimeline::GetTag(const CDateTime& startTime) const
+{
+  const time_t time = AsTime(startTime);
+  const size_t index = LowerBound(time);
+  if (index < m_startTimes.size() && m_startTimes[index] == time)
+    return GetTagAt(index);
+
+  return {};
+}
+
+std::shared_ptr<CPVREpgInfoTag> CPVREpgTagsTimeline::GetTag(unsigned int iUniqueBroadcastID) const
+{
+  for (size_t i = 0; i < m_data.size(); ++i)
+  {
+    if (m_data[i].iUniqueBroadcastID == iUniqueBroadcastID)
+      return GetTagAt(i);
+  }
+  return {};
+}
+
+std::shared_ptr<CPVREpgInfoTag> CPVREpgTagsTimeline::GetTagByDatabaseID(int iDatabaseID) const
+{
+  for (size_t i = 0; i < m_data.size(); ++i)
+  {
+    if (m_data[i].iDatabaseID == iDatabaseID)
+      return GetTagAt(i);
+  }
+  return {};
+}
+
+std::shared_ptr<CPVREpgInfoTag> CPVREpgTagsTimeline::GetTagBetween(const CDateTime& start,
+                                                                   const CDateTime& end) const
+{
+  const size_t index = LowerBound(AsTime(start));
+  if (index < m_startTimes.size() && m_endTimes[index] <= AsTime(end))
+    return GetTagAt(index);
+
+  return {};
+}
+
+std::shared_ptr<CPVREpgInfoTag> CPVREpgTagsTimeline::GetActiveTag(const CDateTime& time) const
+{
+  const time_t activeTime = AsTime(time);
+  const size_t last = UpperBound(activeTime);
+  for (size_t i = FirstCandidate(activeTime); i < last; ++i)
+  {
+    if (m_endTimes[i] > activeTime)
+      return GetTagAt(i);
+  }
+  return {};
+}
+
+std::shared_ptr<CPVREpgInfoTag> CPVREpgTagsTimeline::GetLastEndedTag(const CDateTime& time) const
+{
+  const time_t activeTime = AsTime(time);
+  for (size_t i = UpperBound(activeTime); i > 0; --i)
+  {
+    if (m_endTimes[i - 1] < activeTime)
+      return GetTagAt(i - 1);
+  }
+  return {};
+}
+
+std::shared_ptr<CPVREpgInfoTag> CPVREpgTagsTimeline::GetNextStartingTag(const CDateTime& time) const
+{
+  const size_t index = UpperBound(AsTime(time));
+  if (index < m_startTimes.size())
+    return GetTagAt(index);
+
+  return {};
+}
+
+std::vector<std::shared_ptr<CPVREpgInfoTag>> CPVREpgTagsTimeline::GetTags(
+    const CDateTime& minEventEnd, const CDateTime& maxEventStart) const
+{
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
+
+  const time_t minEnd = AsTime(minEventEnd);
+  const size_t last = LowerBound(AsTime(maxEventStart));
+  for (size_t i = FirstCandidate(minEnd); i < last; ++i)
+  {
+    if (m_endTimes[i] > minEnd)
+      tags.emplace_back(GetTagAt(i));
+  }
+  return tags;
+}
+
+std::vector<std::shared_ptr<CPVREpgInfoTag>> CPVREpgTagsTimeline::GetAllTags() const
+{
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
+  tags.reserve(m_startTimes.size());
+  for (size_t i = 0; i < m_startTimes.size(); ++i)
+    tags.emplace_back(GetTagAt(i));
+
+  return tags;
+}
+
+CDateTime CPVREpgTagsTimeline::GetFirstStartTime() const
+{
+  if (m_startTimes.empty())
+    return {};
+
+  return CDateTime(m_startTimes.front());
+}
+
+CDateTime CPVREpgTagsTimeline::GetLastEndTime() const
+{
+  if (m_endTimes.empty())
+    return {};
+
+  return CDateTime(m_endTimes.back());
+}
+
+size_t CPVREpgTagsTimeline::GetMemoryUsage() const
+{
+  return VectorSize(m_startTimes) + VectorSize(m_endTimes) + VectorSize(m_data) +
+         m_strings.GetMemoryUsage();
+}
+
+size_t CPVREpgTagsTimeline::LowerBound(time_t startTime) const
+{
+  return std::lower_bound(m_startTimes.cbegin(), m_startTimes.cend(), startTime) -
+         m_startTimes.cbegin();
+}
+
+size_t CPVREpgTagsTimeline::UpperBound(time_t startTime) const
+{
+  return std::upper_bound(m_startTimes.cbegin(), m_startTimes.cend(), startTime) -
+         m_startTimes.cbegin();
+}
+
+size_t CPVREpgTagsTimeline::FirstCandidate(time_t minEventEnd) const
+{
+  // No tag is longer than m_maxDuration, so tags ending after minEventEnd can not start earlier
+  return UpperBound(minEventEnd - m_maxDuration);
+}
+
+uint32_t CPVREpgTagsTimeline::AddList(const std::vector<std::string>& list)
+{
+  std::string str;
+  for (const auto& element : list)
+  {
+    str.append(element);
+    str.push_back(LIST_TERMINATOR);
+  }
+  return m_strings.Add(str);
+}
+
+std::vector<std::string> CPVREpgTagsTimeline::GetList(uint32_t id) const
+{
+  std::vector<std::string> list;
+
+  const std::string& str = m_strings.Get(id);
+  size_t start = 0;
+  while (start < str.size())
+  {
+    const size_t end = str.find(LIST_TERMINATOR, start);
+    list.emplace_back(str, start, end - start);
+    start = end + 1;
+  }
+  return list;
+}
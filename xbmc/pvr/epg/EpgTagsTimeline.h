@@ -0,0 +1,277 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "XBDateTime.h"
+
+#include <ctime>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace PVR
+{
+class CPVREpgChannelData;
+class CPVREpgInfoTag;
+
+/*!
+ * @brief Pool of unique strings, referenced by small integer ids.
+ *
+ * EPG data repeats the same titles, genres and credits over and over. Each distinct string is
+ * stored only once. Id 0 is always the empty string.
+ */
+class CPVREpgStringPool
+{
+public:
+  CPVREpgStringPool();
+
+  // m_strings points into m_ids, a copy would point into the source pool
+  CPVREpgStringPool(const CPVREpgStringPool&) = delete;
+  CPVREpgStringPool& operator=(const CPVREpgStringPool&) = delete;
+
+  /*!
+   * @brief Add a string to the pool.
+   * @param str The string.
+   * @return The id of the string.
+   */
+  uint32_t Add(const std::string& str);
+
+  /*!
+   * @brief Get a string of the pool.
+   * @param id The id of the string.
+   * @return The string.
+   */
+  const std::string& Get(uint32_t id) const { return *m_strings[id]; }
+
+  /*!
+   * @brief Remove all strings from the pool. Previously returned ids become invalid.
+   */
+  void Clear();
+
+  /*!
+   * @brief Get the number of distinct strings in the pool.
+   * @return The number of strings.
+   */
+  size_t Size() const { return m_strings.size(); }
+
+  /*!
+   * @brief Get the approximate number of bytes allocated by the pool.
+   * @return The number of bytes.
+   */
+  size_t GetMemoryUsage() const;
+
+private:
+  std::unordered_map<std::string, uint32_t> m_ids;
+  std::vector<const std::string*> m_strings; //!< Points to the keys of m_ids, which never move
+};
+
+/*!
+ * @brief Compact in-memory timeline of the EPG events of one channel.
+ *
+ * Events are stored column-wise, sorted by start time, with their strings held in a string
+ * pool. CPVREpgInfoTag instances are only created when a tag is requested. Tags returned by this
+ * class are copies, changes to them must be stored using Insert().
+ */
+class CPVREpgTagsTimeline
+{
+public:
+  CPVREpgTagsTimeline() = delete;
+  CPVREpgTagsTimeline(int iEpgID, const std::shared_ptr<CPVREpgChannelData>& channelData);
+
+  /*!
+   * @brief Set the EPG id passed to the tags of this timeline.
+   * @param iEpgID The ID.
+   */
+  void SetEpgID(int iEpgID) { m_iEpgID = iEpgID; }
+
+  /*!
+   * @brief Set the channel data passed to the tags of this timeline.
+   * @param data The channel data.
+   */
+  void SetChannelData(const std::shared_ptr<CPVREpgChannelData>& data) { m_channelData = data; }
+
+  /*!
+   * @brief Add a tag or replace the tag with the same start time.
+   * @param tag The tag. Its EPG id and channel data are not stored.
+   */
+  void Insert(const CPVREpgInfoTag& tag);
+
+  /*!
+   * @brief Remove the tag with the given start time.
+   * @param startTime The start time.
+   * @return True if a tag was removed, false otherwise.
+   */
+  bool Erase(const CDateTime& startTime);
+
+  /*!
+   * @brief Remove all tags which ended before the given time.
+   * @param time The time.
+   * @return True if any tag was removed, false otherwise.
+   */
+  bool EraseEndedBefore(const CDateTime& time);
+
+  /*!
+   * @brief Remove all tags.
+   */
+  void Clear();
+
+  /*!
+   * @brief Check whether this timeline is empty.
+   * @return True if there are no tags, false otherwise.
+   */
+  bool IsEmpty() const { return m_startTimes.empty(); }
+
+  /*!
+   * @brief Get the number of tags.
+   * @return The number of tags.
+   */
+  size_t Size() const { return m_startTimes.size(); }
+
+  /*!
+   * @brief Get a tag given its position in the timeline.
+   * @param index The position, must be less than Size().
+   * @return The tag.
+   */
+  std::shared_ptr<CPVREpgInfoTag> GetTagAt(size_t index) const;
+
+  /*!
+   * @brief Get a tag given its start time.
+   * @param startTime The start time.
+   * @return The tag or nullptr if no tag was found.
+   */
+  std::shared_ptr<CPVREpgInfoTag> GetTag(const CDateTime& startTime) const;
+
+  /*!
+   * @brief Get a tag given its unique broadcast ID.
+   * @param iUniqueBroadcastID The ID.
+   * @return The tag or nullptr if no tag was found.
+   */
+  std::shared_ptr<CPVREpgInfoTag> GetTag(unsigned int iUniqueBroadcastID) const;
+
+  /*!
+   * @brief Get a tag given its database ID.
+   * @param iDatabaseID The ID.
+   * @return The tag or nullptr if no tag was found.
+   */
+  std::shared_ptr<CPVREpgInfoTag> GetTagByDatabaseID(int iDatabaseID) const;
+
+  /*!
+   * @brief Get the first tag starting at or after the given start time, if it ends before the
+   * given end time.
+   * @param start The start of the time interval.
+   * @param end The end of the time interval.
+   * @return The tag or nullptr if no tag was found.
+   */
+  std::shared_ptr<CPVREpgInfoTag> GetTagBetween(const CDateTime& start, const CDateTime& end) const;
+
+  /*!
+   * @brief Get the tag that is active at the given time.
+   * @param time The time.
+   * @return The tag or nullptr if no tag was found.
+   */
+  std::shared_ptr<CPVREpgInfoTag> GetActiveTag(const CDateTime& time) const;
+
+  /*!
+   * @brief Get the last tag that ended before the given time.
+   * @param time The time.
+   * @return The tag or nullptr if no tag was found.
+   */
+  std::shared_ptr<CPVREpgInfoTag> GetLastEndedTag(const CDateTime& time) const;
+
+  /*!
+   * @brief Get the first tag that starts after the given time.
+   * @param time The time.
+   * @return The tag or nullptr if no tag was found.
+   */
+  std::shared_ptr<CPVREpgInfoTag> GetNextStartingTag(const CDateTime& time) const;
+
+  /*!
+   * @brief Get all tags ending after minEventEnd and starting before maxEventStart.
+   * @param minEventEnd The minimum end time of the tags to return.
+   * @param maxEventStart The maximum start time of the tags to return.
+   * @return The tags, sorted by start time.
+   */
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> GetTags(const CDateTime& minEventEnd,
+                                                       const CDateTime& maxEventStart) const;
+
+  /*!
+   * @brief Get all tags.
+   * @return The tags, sorted by start time.
+   */
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> GetAllTags() const;
+
+  /*!
+   * @brief Get the start time of the first tag.
+   * @return The time, invalid if the timeline is empty.
+   */
+  CDateTime GetFirstStartTime() const;
+
+  /*!
+   * @brief Get the end time of the tag that starts last.
+   * @return The time, invalid if the timeline is empty.
+   */
+  CDateTime GetLastEndTime() const;
+
+  /*!
+   * @brief Get the approximate number of bytes allocated by this timeline.
+   * @return The number of bytes.
+   */
+  size_t GetMemoryUsage() const;
+
+private:
+  //! Everything but the times of an event. Strings and lists are ids of the string pool.
+  struct EventData
+  {
+    int iDatabaseID;
+    unsigned int iUniqueBroadcastID;
+    int iGenreType;
+    int iGenreSubType;
+    int iParentalRating;
+    int iStarRating;
+    int iSeriesNumber;
+    int iEpisodeNumber;
+    int iEpisodePart;
+    int iYear;
+    unsigned int iFlags;
+    uint32_t title;
+    uint32_t plotOutline;
+    uint32_t plot;
+    uint32_t originalTitle;
+    uint32_t cast;
+    uint32_t directors;
+    uint32_t writers;
+    uint32_t genre;
+    uint32_t imdbNumber;
+    uint32_t episodeName;
+    uint32_t iconPath;
+    uint32_t seriesLink;
+    uint32_t firstAired;
+  };
+
+  size_t LowerBound(time_t startTime) const;
+  size_t UpperBound(time_t startTime) const;
+  size_t FirstCandidate(time_t minEventEnd) const;
+  void EraseIf(const std::vector<bool>& erase);
+
+  uint32_t AddList(const std::vector<std::string>& list);
+  std::vector<std::string> GetList(uint32_t id) const;
+
+  int m_iEpgID;
+  std::shared_ptr<CPVREpgChannelData> m_channelData;
+
+  std::vector<time_t> m_startTimes; //!< Sorted ascending, unique
+  std::vector<time_t> m_endTimes;
+  std::vector<EventData> m_data;
+  time_t m_maxDuration = 0; //!< Longest duration ever inserted, bounds the backward search
+  CPVREpgStringPool m_strings;
+};
+
+} // namespace PVR
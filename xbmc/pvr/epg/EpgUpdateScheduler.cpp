@@ -0,0 +1,193 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "EpgUpdateScheduler.h"
+
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+using namespace PVR;
+using namespace std::chrono_literals;
+
+CPVREpgUpdateScheduler::CPVREpgUpdateScheduler(UpdateFunction update,
+                                               unsigned int iMaxUpdates,
+                                               unsigned int iMaxUpdatesPerClient)
+  : m_update(std::move(update)),
+    m_iMaxUpdates(std::max(iMaxUpdates, 1u)),
+    m_iMaxUpdatesPerClient(std::max(iMaxUpdatesPerClient, 1u))
+{
+}
+
+CPVREpgUpdateScheduler::~CPVREpgUpdateScheduler() = default;
+
+bool CPVREpgUpdateScheduler::Execute(const std::vector<Job>& jobs,
+                                     const ProgressCallback& progress)
+{
+  {
+    CSingleLock lock(m_critSection);
+    m_jobs = jobs;
+    m_results.assign(jobs.size(), JobResult::NONE);
+    m_pendingJobs.resize(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i)
+      m_pendingJobs[i] = i;
+    std::stable_sort(m_pendingJobs.begin(), m_pendingJobs.end(), [&jobs](size_t a, size_t b) {
+      return jobs[a].iPriority < jobs[b].iPriority;
+    });
+    m_finishedJobs.clear();
+    m_activeUpdatesPerClient.clear();
+    m_iActiveUpdates = 0;
+    m_iMaxActiveUpdates = 0;
+    m_iMaxActiveUpdatesPerClient = 0;
+    m_bStop = false;
+  }
+
+  if (jobs.empty())
+    return true;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  const size_t updaters = std::min(static_cast<size_t>(m_iMaxUpdates), jobs.size());
+  for (size_t i = 0; i < updaters; ++i)
+  {
+    m_threads.emplace_back(new CThread(this, "EPGUpdater"));
+    m_threads.back()->Create();
+  }
+
+  bool bCancelled = false;
+  size_t iFinished = 0;
+  while (true)
+  {
+    std::deque<size_t> finishedJobs;
+    {
+      CSingleLock lock(m_critSection);
+      finishedJobs.swap(m_finishedJobs);
+    }
+
+    // Jobs finished after cancelling are still reported, their data is valid
+    for (size_t job : finishedJobs)
+    {
+      ++iFinished;
+      if (progress && !progress(job, iFinished))
+        bCancelled = true;
+    }
+
+    if (finishedJobs.empty() && progress && !bCancelled && !progress(NO_JOB, iFinished))
+      bCancelled = true;
+
+    CSingleLock lock(m_critSection);
+    if (bCancelled)
+      CancelPendingJobs();
+
+    if (m_pendingJobs.empty() && m_iActiveUpdates == 0 && m_finishedJobs.empty())
+    {
+      m_bStop = true;
+      break;
+    }
+
+    if (m_finishedJobs.empty())
+      m_callerCondition.wait(lock, 100ms);
+  }
+
+  m_updaterCondition.notifyAll();
+  for (auto& thread : m_threads)
+    thread->StopThread(true);
+  m_threads.clear();
+
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  CLog::LogFC(LOGDEBUG, LOGEPG,
+              "Executed {} of {} EPG updates in {:.1f} s, at most {} at a time and {} per client",
+              iFinished, jobs.size(), seconds, m_iMaxActiveUpdates, m_iMaxActiveUpdatesPerClient);
+
+  return !bCancelled;
+}
+
+CPVREpgUpdateScheduler::JobResult CPVREpgUpdateScheduler::GetResult(size_t job) const
+{
+  CSingleLock lock(m_critSection);
+  if (job >= m_results.size())
+    return JobResult::NONE;
+
+  return m_results[job];
+}
+
+unsigned int CPVREpgUpdateScheduler::GetMaxActiveUpdates() const
+{
+  CSingleLock lock(m_critSection);
+  return m_iMaxActiveUpdates;
+}
+
+unsigned int CPVREpgUpdateScheduler::GetMaxActiveUpdatesPerClient() const
+{
+  CSingleLock lock(m_critSection);
+  return m_iMaxActiveUpdatesPerClient;
+}
+
+void CPVREpgUpdateScheduler::Run()
+{
+  size_t job;
+  while (StartNextJob(job))
+  {
+    const bool bSuccess = m_update(job);
+
+    {
+      CSingleLock lock(m_critSection);
+      m_results[job] = bSuccess ? JobResult::SUCCEEDED : JobResult::FAILED;
+      --m_activeUpdatesPerClient[m_jobs[job].iClientID];
+      --m_iActiveUpdates;
+      m_finishedJobs.push_back(job);
+    }
+
+    // The finished job may have been the one blocking its client's next job
+    m_updaterCondition.notifyAll();
+    m_callerCondition.notifyAll();
+  }
+}
+
+bool CPVREpgUpdateScheduler::StartNextJob(size_t& job)
+{
+  CSingleLock lock(m_critSection);
+  while (true)
+  {
+    if (m_bStop)
+      return false;
+
+    // The job with the highest priority whose client is not busy
+    const auto it = std::find_if(m_pendingJobs.begin(), m_pendingJobs.end(), [this](size_t i) {
+      return m_activeUpdatesPerClient[m_jobs[i].iClientID] < m_iMaxUpdatesPerClient;
+    });
+
+    if (it != m_pendingJobs.end())
+    {
+      job = *it;
+      m_pendingJobs.erase(it);
+
+      const unsigned int iClientUpdates = ++m_activeUpdatesPerClient[m_jobs[job].iClientID];
+      ++m_iActiveUpdates;
+      m_iMaxActiveUpdates = std::max(m_iMaxActiveUpdates, m_iActiveUpdates);
+      m_iMaxActiveUpdatesPerClient = std::max(m_iMaxActiveUpdatesPerClient, iClientUpdates);
+      return true;
+    }
+
+    m_updaterCondition.wait(lock);
+  }
+}
+
+void CPVREpgUpdateScheduler::CancelPendingJobs()
+{
+  for (size_t job : m_pendingJobs)
+    m_results[job] = JobResult::CANCELLED;
+
+  m_pendingJobs.clear();
+}
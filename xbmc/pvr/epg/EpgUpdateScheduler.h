@@ -0,0 +1,143 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+#include "threads/IRunnable.h"
+
+#include <deque>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
+
+class CThread;
+
+namespace PVR
+{
+/*!
+ * @brief Runs EPG table updates on a bounded pool of threads.
+ *
+ * Each update is a job fetching the EPG of one channel from a client. Jobs are started in order of
+ * priority, with at most a given number of jobs running at the same time, and at most a given
+ * number of them for the same client, so a single backend is not flooded with requests.
+ * Finished jobs are reported on the calling thread, which is free to persist their data.
+ */
+class CPVREpgUpdateScheduler : private IRunnable
+{
+public:
+  //! Passed to the progress callback while no job finished.
+  static constexpr size_t NO_JOB = std::numeric_limits<size_t>::max();
+
+  struct Job
+  {
+    int iClientID; //!< The client serving the job
+    int iPriority; //!< Jobs with lower values are started first
+  };
+
+  enum class JobResult
+  {
+    NONE,
+    SUCCEEDED,
+    FAILED,
+    CANCELLED,
+  };
+
+  /*!
+   * @brief Execute a job.
+   * @param job The index of the job.
+   * @return True on success, false otherwise.
+   * @note Called from the update threads.
+   */
+  using UpdateFunction = std::function<bool(size_t job)>;
+
+  /*!
+   * @brief Report progress on the calling thread. Called once for each finished job and
+   * periodically while waiting for jobs to finish.
+   * @param job The index of the job that finished, or NO_JOB.
+   * @param iFinished The number of jobs finished so far.
+   * @return False to cancel all jobs that have not been started yet.
+   */
+  using ProgressCallback = std::function<bool(size_t job, size_t iFinished)>;
+
+  /*!
+   * @brief Create a scheduler.
+   * @param update The function executing a job.
+   * @param iMaxUpdates The maximum number of jobs running at the same time.
+   * @param iMaxUpdatesPerClient The maximum number of jobs of one client running at the same time.
+   */
+  CPVREpgUpdateScheduler(UpdateFunction update,
+                         unsigned int iMaxUpdates,
+                         unsigned int iMaxUpdatesPerClient);
+  ~CPVREpgUpdateScheduler() override;
+
+  /*!
+   * @brief Execute jobs, returns when all started jobs have finished.
+   * @param jobs The jobs.
+   * @param progress The progress callback, may be empty.
+   * @return True if all jobs were executed, false if the jobs were cancelled.
+   */
+  bool Execute(const std::vector<Job>& jobs, const ProgressCallback& progress);
+
+  /*!
+   * @brief Get the result of a job of the last call to Execute().
+   * @param job The index of the job.
+   * @return The result.
+   */
+  JobResult GetResult(size_t job) const;
+
+  /*!
+   * @brief Get the largest number of jobs that ran at the same time during the last call to
+   * Execute().
+   * @return The number of jobs.
+   */
+  unsigned int GetMaxActiveUpdates() const;
+
+  /*!
+   * @brief Get the largest number of jobs of the same client that ran at the same time during the
+   * last call to Execute().
+   * @return The number of jobs.
+   */
+  unsigned int GetMaxActiveUpdatesPerClient() const;
+
+private:
+  // Implementation of IRunnable, the loop of an update thread
+  void Run() override;
+
+  bool StartNextJob(size_t& job);
+  void CancelPendingJobs();
+
+  // Construction parameters
+  const UpdateFunction m_update;
+  const unsigned int m_iMaxUpdates;
+  const unsigned int m_iMaxUpdatesPerClient;
+
+  // State of the current call to Execute()
+  std::vector<Job> m_jobs;
+  std::vector<JobResult> m_results;
+  std::vector<size_t> m_pendingJobs; //!< Sorted by priority
+  std::deque<size_t> m_finishedJobs; //!< Not yet reported to the calling thread
+  std::map<int, unsigned int> m_activeUpdatesPerClient;
+  unsigned int m_iActiveUpdates = 0;
+  bool m_bStop = false;
+  std::vector<std::unique_ptr<CThread>> m_threads;
+
+  // Statistics
+  unsigned int m_iMaxActiveUpdates = 0;
+  unsigned int m_iMaxActiveUpdatesPerClient = 0;
+
+  // Synchronization
+  mutable CCriticalSection m_critSection;
+  XbmcThreads::ConditionVariable m_updaterCondition;
+  XbmcThreads::ConditionVariable m_callerCondition;
+};
+
+} // namespace PVR
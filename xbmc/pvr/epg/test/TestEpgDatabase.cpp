@@ -0,0 +1,304 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "XBDateTime.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "pvr/epg/EpgDatabase.h"
+#include "pvr/epg/EpgInfoTag.h"
+#include "pvr/epg/EpgSearchData.h"
+#include "pvr/test/PVRTestUtils.h"
+#include "settings/AdvancedSettings.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PVR;
+using namespace PVRTestUtils;
+
+namespace
+{
+const std::string DB_NAME = "TestEpg";
+constexpr int EPG_ID = 1;
+const CDateTimeSpan ONE_SECOND(0, 0, 0, 1);
+
+class TestEpgDatabase : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_settings.type = "sqlite3";
+    m_settings.host = CSpecialProtocol::TranslatePath("special://temp/");
+    XFILE::CFile::Delete(m_settings.host + DB_NAME + ".db");
+
+    m_database = std::make_shared<CPVREpgDatabase>();
+    ASSERT_TRUE(m_database->Connect(DB_NAME, m_settings, true));
+  }
+
+  void TearDown() override
+  {
+    m_database->Close();
+    XFILE::CFile::Delete(m_settings.host + DB_NAME + ".db");
+  }
+
+  std::shared_ptr<CPVREpgInfoTag> CreateTag(int iEpgId,
+                                            time_t start,
+                                            const std::string& title,
+                                            const std::string& plotOutline,
+                                            const std::string& plot)
+  {
+    EpgTagData data;
+    data.iChannelUid = iEpgId;
+    data.iEpgId = iEpgId;
+    data.start = start;
+    data.title = title;
+    data.plotOutline = plotOutline;
+    data.plot = plot;
+    return m_tagFactory.Create(data);
+  }
+
+  // A tag for each title, following each other on one channel
+  void PersistGuide(const std::vector<std::vector<std::string>>& guide)
+  {
+    time_t start = FIRST_START;
+    for (const auto& event : guide)
+    {
+      m_database->QueuePersistQuery(*CreateTag(EPG_ID, start, event[0], event[1], event[2]));
+      start += DURATION;
+    }
+    Commit();
+  }
+
+  void Commit()
+  {
+    m_database->CommitDeleteQueries();
+    m_database->CommitInsertQueries();
+  }
+
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> SearchTags(const std::string& term,
+                                                          bool bSearchInDescription = false)
+  {
+    PVREpgSearchData searchData;
+    searchData.m_strSearchTerm = term;
+    searchData.m_bSearchInDescription = bSearchInDescription;
+    searchData.m_startDateTime = CDateTime(2020, 1, 1, 0, 0, 0);
+    searchData.m_endDateTime = CDateTime(2030, 1, 1, 0, 0, 0);
+    return m_database->GetEpgTags(searchData);
+  }
+
+  std::vector<std::string> Search(const std::string& term, bool bSearchInDescription = false)
+  {
+    std::vector<std::string> titles;
+    for (const auto& tag : SearchTags(term, bSearchInDescription))
+      titles.emplace_back(tag->Title());
+
+    std::sort(titles.begin(), titles.end());
+    return titles;
+  }
+
+  DatabaseSettings m_settings;
+  std::shared_ptr<CPVREpgDatabase> m_database;
+  CEpgTagFactory m_tagFactory;
+};
+
+using Titles = std::vector<std::string>;
+
+const std::vector<std::vector<std::string>> GUIDE = {
+    {"The Big Bang Theory", "", "Sheldon and Leonard"},
+    {"Big Brother", "Reality show", ""},
+    {"Tagesschau", "Nachrichten", "News from Germany"},
+    {"Bang on time", "", "Documentary"},
+    {"Dr. Who", "Sci-Fi", "The doctor travels in time"},
+    {"O'Brien tonight", "", ""},
+};
+} // namespace
+
+TEST_F(TestEpgDatabase, SearchTerms)
+{
+  PersistGuide(GUIDE);
+
+  EXPECT_EQ(Search("big"), Titles({"Big Brother", "The Big Bang Theory"}));
+  EXPECT_EQ(Search("BIG bang"), Titles({"Bang on time", "Big Brother", "The Big Bang Theory"}));
+  EXPECT_EQ(Search("big and bang"), Titles({"The Big Bang Theory"}));
+  EXPECT_EQ(Search("big + theory"), Titles({"The Big Bang Theory"}));
+  EXPECT_EQ(Search("bang and not theory"), Titles({"Bang on time"}));
+  EXPECT_EQ(Search("show | sci"), Titles({"Big Brother", "Dr. Who"}));
+  EXPECT_EQ(Search("\"big bang\""), Titles({"The Big Bang Theory"}));
+  EXPECT_EQ(Search("o'brien"), Titles({"O'Brien tonight"}));
+  EXPECT_EQ(Search("zebra"), Titles());
+}
+
+TEST_F(TestEpgDatabase, SearchShortTerms)
+{
+  PersistGuide(GUIDE);
+
+  // Terms shorter than three characters can't be looked up in the search index
+  EXPECT_EQ(Search("dr"), Titles({"Dr. Who"}));
+  EXPECT_EQ(Search("dr and who"), Titles({"Dr. Who"}));
+  EXPECT_EQ(Search("on and bang"), Titles({"Bang on time"}));
+}
+
+TEST_F(TestEpgDatabase, SearchInDescription)
+{
+  PersistGuide(GUIDE);
+
+  EXPECT_EQ(Search("news"), Titles());
+  EXPECT_EQ(Search("news", true), Titles({"Tagesschau"}));
+  EXPECT_EQ(Search("time"), Titles({"Bang on time"}));
+  EXPECT_EQ(Search("time", true), Titles({"Bang on time", "Dr. Who"}));
+}
+
+TEST_F(TestEpgDatabase, SearchIndexFollowsChanges)
+{
+  PersistGuide(GUIDE);
+
+  // Replace a tag, like CPVREpgTagsContainer does for changed events
+  const std::shared_ptr<CPVREpgInfoTag> tag =
+      CreateTag(EPG_ID, FIRST_START, "Zebra crossing", "", "");
+  m_database->QueueDeleteEpgTagsByMinEndMaxStartTimeQuery(EPG_ID, tag->StartAsUTC() + ONE_SECOND,
+                                                          tag->EndAsUTC() - ONE_SECOND);
+  m_database->QueuePersistQuery(*tag);
+  Commit();
+
+  EXPECT_EQ(Search("zebra"), Titles({"Zebra crossing"}));
+  EXPECT_EQ(Search("theory"), Titles());
+
+  // Replace a tag without deleting it first
+  m_database->QueuePersistQuery(*CreateTag(EPG_ID, FIRST_START + DURATION, "Zebra herd", "", ""));
+  Commit();
+
+  EXPECT_EQ(Search("zebra"), Titles({"Zebra crossing", "Zebra herd"}));
+  EXPECT_EQ(Search("brother"), Titles());
+
+  // Delete a tag
+  const std::vector<std::shared_ptr<CPVREpgInfoTag>> found = SearchTags("crossing");
+  ASSERT_EQ(found.size(), 1u);
+  m_database->QueueDeleteTagQuery(*found[0]);
+  Commit();
+
+  EXPECT_EQ(Search("zebra"), Titles({"Zebra herd"}));
+
+  // Delete everything
+  m_database->DeleteEpg();
+  EXPECT_EQ(Search("zebra"), Titles());
+
+  PersistGuide(GUIDE);
+  EXPECT_EQ(Search("big and bang"), Titles({"The Big Bang Theory"}));
+}
+
+TEST_F(TestEpgDatabase, SearchIndexReplacedTags)
+{
+  const std::shared_ptr<CPVREpgInfoTag> tag = CreateTag(EPG_ID, FIRST_START, "Zebra", "", "");
+  m_database->QueuePersistQuery(*tag);
+  Commit();
+  m_database->QueuePersistQuery(*tag);
+  Commit();
+
+  EXPECT_EQ(1, m_database->GetSingleValueInt("SELECT COUNT(*) FROM epgtags"));
+
+  // the replaced tag leaves no entry behind, if full-text search is supported at all
+  const std::string indexed = m_database->GetSingleValue("SELECT COUNT(*) FROM epgtags_fts");
+  if (!indexed.empty())
+  {
+    EXPECT_EQ("1", indexed);
+  }
+}
+
+TEST_F(TestEpgDatabase, SearchIndexSurvivesReopen)
+{
+  PersistGuide(GUIDE);
+  m_database->Close();
+
+  ASSERT_TRUE(m_database->Connect(DB_NAME, m_settings, false));
+  const time_t start = FIRST_START + static_cast<time_t>(GUIDE.size()) * DURATION;
+  m_database->QueuePersistQuery(*CreateTag(EPG_ID, start, "Zebra crossing", "", ""));
+  Commit();
+
+  EXPECT_EQ(Search("zebra"), Titles({"Zebra crossing"}));
+  EXPECT_EQ(Search("big and bang"), Titles({"The Big Bang Theory"}));
+}
+
+// A generated guide of a million events, 1000 channels with 1000 events each. Takes a few minutes
+// to generate, run with --gtest_also_run_disabled_tests.
+TEST_F(TestEpgDatabase, DISABLED_SearchBenchmark)
+{
+  const std::vector<std::string> words = {
+      "news",  "weather", "football", "documentary", "nature", "cooking", "crime",
+      "drama", "comedy",  "science",  "history",     "travel", "music",   "quiz",
+      "film",  "series",  "kids",     "cartoon",     "sport",  "politics"};
+
+  std::mt19937 generator(1);
+  const auto randomWords = [&words, &generator](int count) {
+    std::string result;
+    for (int i = 0; i < count; ++i)
+      result += words[generator() % words.size()] + " ";
+    return result;
+  };
+
+  constexpr int CHANNELS = 1000;
+  constexpr int EVENTS = 1000;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int channel = 1; channel <= CHANNELS; ++channel)
+  {
+    for (int event = 0; event < EVENTS; ++event)
+    {
+      // A rare title for every 1000th event
+      const std::string title = (event == channel % EVENTS)
+                                    ? "Eurovision Song Contest"
+                                    : randomWords(3) + std::to_string(event);
+      m_database->QueuePersistQuery(*CreateTag(channel, FIRST_START + event * DURATION, title,
+                                               randomWords(5), randomWords(20)));
+    }
+
+    if (m_database->GetInsertQueriesCount() > EPG_COMMIT_QUERY_COUNT_LIMIT)
+      Commit();
+  }
+  Commit();
+
+  const double generateSeconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "Generated " << CHANNELS * EVENTS << " events in " << generateSeconds << " s"
+            << std::endl;
+
+  struct Query
+  {
+    std::string term;
+    bool bSearchInDescription;
+    size_t expected;
+  };
+
+  // "zq" can't be looked up in the index and shows the cost of searching without it
+  const std::vector<Query> queries = {
+      {"eurovision", false, CHANNELS},
+      {"\"song contest\"", true, CHANNELS},
+      {"eurovision and not zebra", true, CHANNELS},
+      {"zebra", true, 0},
+      {"zq", true, 0},
+  };
+
+  for (const auto& query : queries)
+  {
+    start = std::chrono::steady_clock::now();
+    const size_t found = SearchTags(query.term, query.bSearchInDescription).size();
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+    std::cout << "Search [" << query.term << "]" << (query.bSearchInDescription ? " in plot" : "")
+              << ": " << found << " events in " << ms << " ms" << std::endl;
+    EXPECT_EQ(found, query.expected) << query.term;
+  }
+}
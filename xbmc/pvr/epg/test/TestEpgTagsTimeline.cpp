@@ -0,0 +1,248 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "XBDateTime.h"
+#include "addons/kodi-dev-kit/include/kodi/c-api/addon-instance/pvr/pvr_epg.h"
+#include "pvr/epg/EpgChannelData.h"
+#include "pvr/epg/EpgInfoTag.h"
+#include "pvr/epg/EpgTagsTimeline.h"
+#include "pvr/test/PVRTestUtils.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PVR;
+using namespace PVRTestUtils;
+
+namespace
+{
+constexpr int EPG_ID = 3;
+
+class TestEpgTagsTimeline : public ::testing::Test
+{
+protected:
+  std::shared_ptr<CPVREpgInfoTag> CreateTag(time_t start,
+                                            time_t end,
+                                            const std::string& title,
+                                            const std::string& cast = "")
+  {
+    EpgTagData data;
+    data.iEpgId = EPG_ID;
+    data.start = start;
+    data.end = end;
+    data.title = title;
+    data.cast = cast;
+    data.iGenreType = EPG_EVENT_CONTENTMASK_NEWSCURRENTAFFAIRS;
+    data.channelData = m_channelData;
+    return m_tagFactory.Create(data);
+  }
+
+  // Events following each other, starting at FIRST_START
+  void CreateGuide(CPVREpgTagsTimeline& timeline, size_t events)
+  {
+    for (size_t i = 0; i < events; ++i)
+    {
+      const time_t start = FIRST_START + i * DURATION;
+      timeline.Insert(*CreateTag(start, start + DURATION, "Event " + std::to_string(i)));
+    }
+  }
+
+  static time_t Start(const std::shared_ptr<CPVREpgInfoTag>& tag)
+  {
+    time_t start = 0;
+    if (tag)
+      tag->StartAsUTC().GetAsTime(start);
+    return start;
+  }
+
+  const std::shared_ptr<CPVREpgChannelData> m_channelData =
+      std::make_shared<CPVREpgChannelData>(1, 1);
+  CEpgTagFactory m_tagFactory;
+};
+} // namespace
+
+TEST_F(TestEpgTagsTimeline, InsertKeepsOrder)
+{
+  CPVREpgTagsTimeline timeline(EPG_ID, m_channelData);
+  EXPECT_TRUE(timeline.IsEmpty());
+  EXPECT_FALSE(timeline.GetFirstStartTime().IsValid());
+
+  for (time_t offset : {2, 0, 3, 1})
+  {
+    const time_t start = FIRST_START + offset * DURATION;
+    timeline.Insert(*CreateTag(start, start + DURATION, std::to_string(offset)));
+  }
+
+  ASSERT_EQ(timeline.Size(), 4u);
+  for (size_t i = 0; i < timeline.Size(); ++i)
+  {
+    EXPECT_EQ(Start(timeline.GetTagAt(i)), FIRST_START + static_cast<time_t>(i) * DURATION);
+    EXPECT_EQ(timeline.GetTagAt(i)->Title(), std::to_string(i));
+  }
+  EXPECT_EQ(timeline.GetFirstStartTime(), CDateTime(FIRST_START));
+  EXPECT_EQ(timeline.GetLastEndTime(), CDateTime(FIRST_START + 4 * DURATION));
+
+  // Same start time replaces the tag
+  timeline.Insert(*CreateTag(FIRST_START + DURATION, FIRST_START + 2 * DURATION, "replaced"));
+  EXPECT_EQ(timeline.Size(), 4u);
+  EXPECT_EQ(timeline.GetTag(CDateTime(FIRST_START + DURATION))->Title(), "replaced");
+
+  EXPECT_TRUE(timeline.Erase(CDateTime(FIRST_START)));
+  EXPECT_FALSE(timeline.Erase(CDateTime(FIRST_START)));
+  EXPECT_EQ(timeline.Size(), 3u);
+  EXPECT_EQ(timeline.GetTag(CDateTime(FIRST_START)), nullptr);
+}
+
+TEST_F(TestEpgTagsTimeline, TagsAreComplete)
+{
+  CPVREpgTagsTimeline timeline(EPG_ID, m_channelData);
+
+  EPG_TAG data = {};
+  data.iUniqueBroadcastId = 42;
+  data.iUniqueChannelId = 1;
+  data.startTime = FIRST_START;
+  data.endTime = FIRST_START + DURATION;
+  data.strTitle = "Title";
+  data.strPlotOutline = "Outline";
+  data.strPlot = "Plot";
+  data.strOriginalTitle = "Original";
+  data.strCast = "Actor A,Actor B";
+  data.strDirector = "Director";
+  data.strWriter = "Writer A,Writer B";
+  data.iYear = 2020;
+  data.strIMDBNumber = "tt0000001";
+  data.strIconPath = "special://icon.png";
+  data.iGenreType = EPG_GENRE_USE_STRING;
+  data.strGenreDescription = "Drama,Comedy";
+  data.strFirstAired = "2019-05-06";
+  data.iParentalRating = 12;
+  data.iStarRating = 4;
+  data.iSeriesNumber = 3;
+  data.iEpisodeNumber = 7;
+  data.iEpisodePartNumber = 1;
+  data.strEpisodeName = "Episode";
+  data.iFlags = EPG_TAG_FLAG_IS_SERIES | EPG_TAG_FLAG_IS_NEW;
+  data.strSeriesLink = "crid://series";
+  const auto tag = std::make_shared<CPVREpgInfoTag>(data, 1, m_channelData, EPG_ID);
+
+  timeline.Insert(*tag);
+  const std::shared_ptr<CPVREpgInfoTag> copy = timeline.GetTag(42u);
+  ASSERT_NE(copy, nullptr);
+  EXPECT_NE(copy, tag);
+
+  // Update() reports any difference between the tags
+  EXPECT_FALSE(copy->Update(*tag, true));
+  EXPECT_EQ(copy->Cast(), tag->Cast());
+  EXPECT_EQ(copy->Genre(), tag->Genre());
+  EXPECT_EQ(copy->FirstAired(), tag->FirstAired());
+  EXPECT_EQ(copy->Path(), tag->Path());
+  EXPECT_EQ(copy->EpgID(), EPG_ID);
+
+  timeline.SetEpgID(EPG_ID + 1);
+  EXPECT_EQ(timeline.GetTagAt(0)->EpgID(), EPG_ID + 1);
+  EXPECT_NE(timeline.GetTagAt(0)->Path(), tag->Path());
+}
+
+TEST_F(TestEpgTagsTimeline, Lists)
+{
+  CPVREpgTagsTimeline timeline(EPG_ID, m_channelData);
+
+  auto tag = CreateTag(FIRST_START, FIRST_START + DURATION, "Title", "A,B");
+  ASSERT_EQ(tag->Cast().size(), 2u);
+  timeline.Insert(*tag);
+  EXPECT_EQ(timeline.GetTagAt(0)->Cast(), tag->Cast());
+
+  auto empty = CreateTag(FIRST_START + DURATION, FIRST_START + 2 * DURATION, "Title");
+  timeline.Insert(*empty);
+  EXPECT_EQ(timeline.GetTagAt(1)->Cast(), empty->Cast());
+}
+
+TEST_F(TestEpgTagsTimeline, Queries)
+{
+  CPVREpgTagsTimeline timeline(EPG_ID, m_channelData);
+
+  // A long event, a gap and three short ones
+  timeline.Insert(*CreateTag(FIRST_START, FIRST_START + 6 * DURATION, "long"));
+  for (time_t i = 8; i < 11; ++i)
+  {
+    const time_t start = FIRST_START + i * DURATION;
+    timeline.Insert(*CreateTag(start, start + DURATION, "short"));
+  }
+
+  const CDateTime inLong(FIRST_START + 5 * DURATION);
+  const CDateTime inGap(FIRST_START + 7 * DURATION);
+  const CDateTime inShort(FIRST_START + 9 * DURATION + 60);
+
+  EXPECT_EQ(Start(timeline.GetActiveTag(inLong)), FIRST_START);
+  EXPECT_EQ(timeline.GetActiveTag(inGap), nullptr);
+  EXPECT_EQ(Start(timeline.GetActiveTag(inShort)), FIRST_START + 9 * DURATION);
+
+  EXPECT_EQ(timeline.GetLastEndedTag(inLong), nullptr);
+  EXPECT_EQ(Start(timeline.GetLastEndedTag(inGap)), FIRST_START);
+  EXPECT_EQ(Start(timeline.GetLastEndedTag(inShort)), FIRST_START + 8 * DURATION);
+
+  EXPECT_EQ(Start(timeline.GetNextStartingTag(inLong)), FIRST_START + 8 * DURATION);
+  EXPECT_EQ(Start(timeline.GetNextStartingTag(inShort)), FIRST_START + 10 * DURATION);
+  EXPECT_EQ(timeline.GetNextStartingTag(CDateTime(FIRST_START + 10 * DURATION)), nullptr);
+
+  EXPECT_EQ(Start(timeline.GetTagBetween(inGap, CDateTime(FIRST_START + 9 * DURATION))),
+            FIRST_START + 8 * DURATION);
+  EXPECT_EQ(timeline.GetTagBetween(inGap, CDateTime(FIRST_START + 8 * DURATION + 60)), nullptr);
+
+  // The long event starts far before the requested range, but still overlaps it
+  const auto tags = timeline.GetTags(inLong, CDateTime(FIRST_START + 9 * DURATION));
+  ASSERT_EQ(tags.size(), 2u);
+  EXPECT_EQ(Start(tags[0]), FIRST_START);
+  EXPECT_EQ(Start(tags[1]), FIRST_START + 8 * DURATION);
+
+  EXPECT_TRUE(timeline.GetTags(inGap, CDateTime(FIRST_START + 8 * DURATION)).empty());
+  EXPECT_EQ(timeline.GetAllTags().size(), 4u);
+}
+
+TEST_F(TestEpgTagsTimeline, EraseEndedBefore)
+{
+  CPVREpgTagsTimeline timeline(EPG_ID, m_channelData);
+  CreateGuide(timeline, 10);
+
+  EXPECT_FALSE(timeline.EraseEndedBefore(CDateTime(FIRST_START)));
+  EXPECT_TRUE(timeline.EraseEndedBefore(CDateTime(FIRST_START + 4 * DURATION)));
+  EXPECT_EQ(timeline.Size(), 7u);
+  EXPECT_EQ(timeline.GetFirstStartTime(), CDateTime(FIRST_START + 3 * DURATION));
+
+  EXPECT_TRUE(timeline.EraseEndedBefore(CDateTime(FIRST_START + 20 * DURATION)));
+  EXPECT_TRUE(timeline.IsEmpty());
+}
+
+TEST_F(TestEpgTagsTimeline, MemoryUsage)
+{
+  // 100 channels of 1000 events, with recurring titles, genres and credits
+  constexpr size_t CHANNELS = 100;
+  constexpr size_t EVENTS = 1000;
+
+  size_t bytes = 0;
+  for (size_t channel = 0; channel < CHANNELS; ++channel)
+  {
+    CPVREpgTagsTimeline timeline(EPG_ID, m_channelData);
+    for (size_t i = 0; i < EVENTS; ++i)
+    {
+      const time_t start = FIRST_START + i * DURATION;
+      const size_t show = (i * 7) % 40;
+      timeline.Insert(*CreateTag(start, start + DURATION, "Show number " + std::to_string(show),
+                                 "Actor " + std::to_string(show) + ",Actor " +
+                                     std::to_string(show + 1)));
+    }
+    bytes += timeline.GetMemoryUsage();
+  }
+
+  RecordProperty("bytes_per_100k_events", static_cast<int>(bytes));
+
+  EXPECT_LT(bytes, CHANNELS * EVENTS * sizeof(CPVREpgInfoTag) / 4);
+}
@@ -0,0 +1,211 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "pvr/epg/EpgUpdateScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PVR;
+
+namespace
+{
+//! Stand-in for the PVR clients, takes some time to deliver the EPG of a channel and records how
+//! many requests it serves at the same time
+class CStandInClients
+{
+public:
+  explicit CStandInClients(std::chrono::microseconds latency) : m_latency(latency) {}
+
+  bool GetEPGForChannel(int iClientID, size_t job)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      const unsigned int iActive = ++m_active;
+      const unsigned int iClientActive = ++m_activePerClient[iClientID];
+      m_maxActive = std::max(m_maxActive, iActive);
+      m_maxActivePerClient = std::max(m_maxActivePerClient, iClientActive);
+      m_started.push_back(job);
+    }
+
+    std::this_thread::sleep_for(m_latency);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    --m_active;
+    --m_activePerClient[iClientID];
+    return m_failingJobs.find(job) == m_failingJobs.end();
+  }
+
+  void SetFailing(size_t job) { m_failingJobs[job] = true; }
+
+  unsigned int m_maxActive = 0;
+  unsigned int m_maxActivePerClient = 0;
+  std::vector<size_t> m_started;
+
+private:
+  const std::chrono::microseconds m_latency;
+  std::mutex m_mutex;
+  unsigned int m_active = 0;
+  std::map<int, unsigned int> m_activePerClient;
+  std::map<size_t, bool> m_failingJobs;
+};
+
+class TestEpgUpdateScheduler : public ::testing::Test
+{
+protected:
+  // Channels of the given number of clients, the first ones of each client with the highest
+  // priority
+  void CreateChannels(int iClients, int iChannelsPerClient)
+  {
+    for (int channel = 0; channel < iChannelsPerClient; ++channel)
+    {
+      for (int client = 0; client < iClients; ++client)
+        m_jobs.push_back({client, channel});
+    }
+  }
+
+  CPVREpgUpdateScheduler::UpdateFunction MakeUpdate(CStandInClients& clients)
+  {
+    return [this, &clients](size_t job) {
+      return clients.GetEPGForChannel(m_jobs[job].iClientID, job);
+    };
+  }
+
+  std::vector<CPVREpgUpdateScheduler::Job> m_jobs;
+};
+} // namespace
+
+TEST_F(TestEpgUpdateScheduler, UpdatesAllChannels)
+{
+  CreateChannels(3, 20);
+  CStandInClients clients(std::chrono::microseconds(2000));
+  clients.SetFailing(7);
+
+  CPVREpgUpdateScheduler scheduler(MakeUpdate(clients), 5, 2);
+  std::vector<size_t> reported;
+  size_t iLastFinished = 0;
+  ASSERT_TRUE(scheduler.Execute(m_jobs, [&](size_t job, size_t iFinished) {
+    EXPECT_GE(iFinished, iLastFinished);
+    iLastFinished = iFinished;
+    if (job != CPVREpgUpdateScheduler::NO_JOB)
+    {
+      reported.push_back(job);
+      EXPECT_EQ(iFinished, reported.size());
+      EXPECT_NE(scheduler.GetResult(job), CPVREpgUpdateScheduler::JobResult::NONE);
+    }
+    return true;
+  }));
+
+  ASSERT_EQ(reported.size(), m_jobs.size());
+  std::sort(reported.begin(), reported.end());
+  for (size_t i = 0; i < m_jobs.size(); ++i)
+  {
+    EXPECT_EQ(reported[i], i);
+    EXPECT_EQ(scheduler.GetResult(i), i == 7 ? CPVREpgUpdateScheduler::JobResult::FAILED
+                                             : CPVREpgUpdateScheduler::JobResult::SUCCEEDED);
+  }
+}
+
+TEST_F(TestEpgUpdateScheduler, ConcurrencyLimits)
+{
+  CreateChannels(3, 20);
+  CStandInClients clients(std::chrono::microseconds(2000));
+
+  CPVREpgUpdateScheduler scheduler(MakeUpdate(clients), 5, 2);
+  ASSERT_TRUE(scheduler.Execute(m_jobs, nullptr));
+
+  EXPECT_GT(clients.m_maxActive, 1u);
+  EXPECT_LE(clients.m_maxActive, 5u);
+  EXPECT_LE(clients.m_maxActivePerClient, 2u);
+  EXPECT_LE(scheduler.GetMaxActiveUpdates(), 5u);
+  EXPECT_LE(scheduler.GetMaxActiveUpdatesPerClient(), 2u);
+
+  // A single client never gets more than its share, even with spare threads
+  m_jobs.clear();
+  CreateChannels(1, 20);
+  CStandInClients client(std::chrono::microseconds(2000));
+  CPVREpgUpdateScheduler single(MakeUpdate(client), 8, 3);
+  ASSERT_TRUE(single.Execute(m_jobs, nullptr));
+  EXPECT_LE(client.m_maxActive, 3u);
+  EXPECT_EQ(single.GetMaxActiveUpdates(), single.GetMaxActiveUpdatesPerClient());
+}
+
+TEST_F(TestEpgUpdateScheduler, PriorityOrder)
+{
+  m_jobs = {{0, 2}, {0, 1}, {1, 0}, {1, 2}, {0, 0}, {1, 1}};
+  CStandInClients clients(std::chrono::microseconds(0));
+
+  CPVREpgUpdateScheduler scheduler(MakeUpdate(clients), 1, 1);
+  ASSERT_TRUE(scheduler.Execute(m_jobs, nullptr));
+
+  // Jobs of the same priority keep their order
+  const std::vector<size_t> expected = {2, 4, 1, 5, 0, 3};
+  EXPECT_EQ(clients.m_started, expected);
+}
+
+TEST_F(TestEpgUpdateScheduler, Cancel)
+{
+  CreateChannels(2, 20);
+  CStandInClients clients(std::chrono::microseconds(2000));
+
+  CPVREpgUpdateScheduler scheduler(MakeUpdate(clients), 2, 1);
+  size_t iReported = 0;
+  EXPECT_FALSE(scheduler.Execute(m_jobs, [&iReported](size_t job, size_t iFinished) {
+    if (job != CPVREpgUpdateScheduler::NO_JOB)
+      ++iReported;
+    return iFinished < 4;
+  }));
+
+  // Jobs running when cancelling are finished and reported, no other job is started
+  EXPECT_EQ(iReported, clients.m_started.size());
+  EXPECT_LT(clients.m_started.size(), m_jobs.size());
+
+  size_t iCancelled = 0;
+  for (size_t i = 0; i < m_jobs.size(); ++i)
+  {
+    const CPVREpgUpdateScheduler::JobResult result = scheduler.GetResult(i);
+    EXPECT_NE(result, CPVREpgUpdateScheduler::JobResult::NONE);
+    if (result == CPVREpgUpdateScheduler::JobResult::CANCELLED)
+      ++iCancelled;
+  }
+  EXPECT_EQ(iCancelled + clients.m_started.size(), m_jobs.size());
+}
+
+TEST_F(TestEpgUpdateScheduler, DISABLED_Benchmark)
+{
+  // 100 channels of two clients with a slow backend
+  CreateChannels(2, 50);
+  const auto latency = std::chrono::microseconds(5000);
+
+  const auto measure = [this, latency](unsigned int iMaxUpdates, unsigned int iMaxPerClient) {
+    CStandInClients clients(latency);
+    CPVREpgUpdateScheduler scheduler(MakeUpdate(clients), iMaxUpdates, iMaxPerClient);
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(scheduler.Execute(m_jobs, nullptr));
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return m_jobs.size() / seconds;
+  };
+
+  const double serial = measure(1, 1);
+  const double parallel = measure(4, 2);
+
+  std::cout << "1 update at a time: " << serial << " channels per second" << std::endl;
+  std::cout << "4 updates at a time: " << parallel << " channels per second" << std::endl;
+  RecordProperty("serial_channels_per_second", static_cast<int>(serial));
+  RecordProperty("parallel_channels_per_second", static_cast<int>(parallel));
+
+  EXPECT_GT(parallel, serial * 2);
+}
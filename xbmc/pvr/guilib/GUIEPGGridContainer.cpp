@@ -22,9 +22,12 @@
 #include "pvr/channels/PVRChannelGroupMember.h"
 #include "pvr/epg/EpgInfoTag.h"
 #include "pvr/guilib/GUIEPGGridContainerModel.h"
+#include "threads/SingleLock.h"
+#include "utils/JobManager.h"
 #include "utils/MathUtils.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
+#include "utils/log.h"
 
 #include <algorithm>
 #include <memory>
@@ -38,6 +41,20 @@ using namespace PVR;
 #define BLOCKJUMP    4 // how many blocks are jumped with each analogue scroll action
 static const int BLOCK_SCROLL_OFFSET = 60 / CGUIEPGGridContainerModel::MINSPERBLOCK; // how many blocks are jumped if we are at left/right edge of grid
 
+struct CGUIEPGGridContainer::EpgTagsFetch
+{
+  CCriticalSection critSection;
+  bool bRunning = false;
+  bool bReplace = false; // tags replace the model's tags, not only extend them
+  std::shared_ptr<const CGUIEPGGridContainerModel> model; // the model the tags were fetched for
+  CGUIEPGGridContainerModel::EpgTagsMap epgTags;
+
+  // the last fetched area, not fetched again unless refreshing
+  std::vector<int> channels;
+  int firstBlock = -1;
+  int lastBlock = -1;
+};
+
 CGUIEPGGridContainer::CGUIEPGGridContainer(int parentID,
                                            int controlID,
                                            float posX,
@@ -96,7 +113,8 @@ CGUIEPGGridContainer::CGUIEPGGridContainer(int parentID,
     m_channelScrollLastTime(0),
     m_channelScrollSpeed(0),
     m_channelScrollOffset(0),
-    m_gridModel(new CGUIEPGGridContainerModel)
+    m_gridModel(new CGUIEPGGridContainerModel),
+    m_epgTagsFetch(std::make_shared<EpgTagsFetch>())
 {
   ControlType = GUICONTAINER_EPGGRID;
 }
@@ -156,10 +174,13 @@ CGUIEPGGridContainer::CGUIEPGGridContainer(const CGUIEPGGridContainer& other)
     m_channelScrollLastTime(other.m_channelScrollLastTime),
     m_channelScrollSpeed(other.m_channelScrollSpeed),
     m_channelScrollOffset(other.m_channelScrollOffset),
-    m_gridModel(new CGUIEPGGridContainerModel(*other.m_gridModel)),
+    m_gridModel(std::make_shared<CGUIEPGGridContainerModel>(*other.m_gridModel)),
     m_updatedGridModel(other.m_updatedGridModel
                            ? new CGUIEPGGridContainerModel(*other.m_updatedGridModel)
                            : nullptr),
+    m_epgTagsFetch(std::make_shared<EpgTagsFetch>()),
+    m_timelineStart(other.m_timelineStart),
+    m_timelineEnd(other.m_timelineEnd),
     m_itemStartBlock(other.m_itemStartBlock)
 {
 }
@@ -188,6 +209,9 @@ void CGUIEPGGridContainer::SetPageControl(int id)
 
 void CGUIEPGGridContainer::Process(unsigned int currentTime, CDirtyRegionList& dirtyregions)
 {
+  const auto processStart = std::chrono::steady_clock::now();
+  const bool bScrolling = m_channelScrollSpeed != 0 || m_programmeScrollSpeed != 0;
+
   ValidateOffset();
 
   if (m_bInvalidated)
@@ -235,6 +259,31 @@ void CGUIEPGGridContainer::Process(unsigned int currentTime, CDirtyRegionList& d
   }
 
   CGUIControl::Process(currentTime, dirtyregions);
+
+  UpdateScrollStatistics(bScrolling, std::chrono::steady_clock::now() - processStart);
+}
+
+void CGUIEPGGridContainer::UpdateScrollStatistics(bool bScrolling,
+                                                  std::chrono::steady_clock::duration frameTime)
+{
+  if (bScrolling)
+  {
+    ++m_scrollFrames;
+    m_scrollFramesTime += frameTime;
+    m_scrollMaxFrameTime = std::max(m_scrollMaxFrameTime, frameTime);
+  }
+  else if (m_scrollFrames > 0)
+  {
+    using ms = std::chrono::duration<double, std::milli>;
+    CLog::LogFC(LOGDEBUG, LOGPVR,
+                "Scrolled for {} frames, processing took {:.2f} ms on average, {:.2f} ms at most",
+                m_scrollFrames, ms(m_scrollFramesTime).count() / m_scrollFrames,
+                ms(m_scrollMaxFrameTime).count());
+
+    m_scrollFrames = 0;
+    m_scrollFramesTime = {};
+    m_scrollMaxFrameTime = {};
+  }
 }
 
 void CGUIEPGGridContainer::Render()
@@ -750,6 +799,9 @@ void CGUIEPGGridContainer::UpdateItems()
   // always use asynchronously precalculated grid data.
   m_gridModel = std::move(m_updatedGridModel);
 
+  // tags still being fetched for the old model are of no use anymore
+  m_epgTagsFetch = std::make_shared<EpgTagsFetch>();
+
   if (prevSelectedEpgTag)
   {
     if (oldGridStart != m_gridModel->GetGridStart())
@@ -1836,6 +1888,9 @@ void CGUIEPGGridContainer::SetTimelineItems(const std::unique_ptr<CFileItemList>
     oldUpdatedGridModel = std::move(m_updatedGridModel);
 
     m_updatedGridModel = std::move(newUpdatedGridModel);
+    m_timelineStart = gridStart;
+    m_timelineEnd = gridEnd;
+    m_bRefreshEpgTags = false;
   }
 }
 
@@ -1844,6 +1899,98 @@ std::unique_ptr<CFileItemList> CGUIEPGGridContainer::GetCurrentTimeLineItems() c
   return m_gridModel->GetCurrentTimeLineItems();
 }
 
+namespace
+{
+// The grid model starts and ends its grid at full or half hours
+bool IsSameGridTime(const CDateTime& time1, const CDateTime& time2)
+{
+  const auto halfHour = [](const CDateTime& time) {
+    return CDateTime(time.GetYear(), time.GetMonth(), time.GetDay(), time.GetHour(),
+                     time.GetMinute() >= 30 ? 30 : 0, 0);
+  };
+  return halfHour(time1) == halfHour(time2);
+}
+} // unnamed namespace
+
+bool CGUIEPGGridContainer::RefreshEpgTags(const CDateTime& gridStart, const CDateTime& gridEnd)
+{
+  CSingleLock lock(m_critSection);
+
+  if (!m_timelineStart.IsValid() || !IsSameGridTime(gridStart, m_timelineStart) ||
+      !IsSameGridTime(gridEnd, m_timelineEnd))
+    return false;
+
+  m_bRefreshEpgTags = true;
+  return true;
+}
+
+bool CGUIEPGGridContainer::MergeFetchedEpgTags()
+{
+  CSingleLock lock(m_epgTagsFetch->critSection);
+
+  if (m_epgTagsFetch->bRunning || !m_epgTagsFetch->model)
+    return false;
+
+  bool bChanged = false;
+  if (m_epgTagsFetch->model == m_gridModel)
+    bChanged = m_gridModel->MergeEpgTags(m_epgTagsFetch->epgTags, m_epgTagsFetch->bReplace);
+
+  // grid contains CFileItem instances. drop them here, on the GUI thread.
+  m_epgTagsFetch->epgTags.clear();
+  m_epgTagsFetch->model.reset();
+  return bChanged;
+}
+
+void CGUIEPGGridContainer::FetchEpgTags()
+{
+  bool bReplace;
+  {
+    CSingleLock lock(m_critSection);
+    bReplace = m_bRefreshEpgTags;
+  }
+
+  int firstBlock;
+  int lastBlock;
+  std::vector<int> channels = m_gridModel->GetChannelsToFetch(bReplace, firstBlock, lastBlock);
+  if (channels.empty())
+    return;
+
+  {
+    CSingleLock lock(m_epgTagsFetch->critSection);
+
+    if (m_epgTagsFetch->bRunning || m_epgTagsFetch->model)
+      return; // wait for the running fetch to finish and to be merged
+
+    if (!bReplace && channels == m_epgTagsFetch->channels &&
+        firstBlock == m_epgTagsFetch->firstBlock && lastBlock == m_epgTagsFetch->lastBlock)
+      return; // already tried, the model takes the rest on demand
+
+    m_epgTagsFetch->bRunning = true;
+    m_epgTagsFetch->bReplace = bReplace;
+    m_epgTagsFetch->model = m_gridModel;
+    m_epgTagsFetch->channels = channels;
+    m_epgTagsFetch->firstBlock = firstBlock;
+    m_epgTagsFetch->lastBlock = lastBlock;
+  }
+
+  if (bReplace)
+  {
+    CSingleLock lock(m_critSection);
+    m_bRefreshEpgTags = false;
+  }
+
+  const std::shared_ptr<const CGUIEPGGridContainerModel> model = m_gridModel;
+  const std::shared_ptr<EpgTagsFetch> fetch = m_epgTagsFetch;
+  CJobManager::GetInstance().Submit([model, fetch, channels, firstBlock, lastBlock] {
+    CGUIEPGGridContainerModel::EpgTagsMap epgTags =
+        model->FetchEpgTags(channels, firstBlock, lastBlock);
+
+    CSingleLock lock(fetch->critSection);
+    fetch->epgTags = std::move(epgTags);
+    fetch->bRunning = false;
+  });
+}
+
 void CGUIEPGGridContainer::GoToChannel(int channelIndex)
 {
   if (channelIndex < m_channelsPerPage)
@@ -2390,13 +2537,21 @@ void CGUIEPGGridContainer::HandleProgrammeGrid(bool bRender, unsigned int curren
     if (lastBlock > m_gridModel->GetLastBlock())
       lastBlock = m_gridModel->GetLastBlock();
 
-    if (m_gridModel->FreeProgrammeMemory(firstChannel, lastChannel, firstBlock, lastBlock))
+    bool bChanged = m_gridModel->FreeProgrammeMemory(firstChannel, lastChannel, firstBlock,
+                                                     lastBlock);
+    if (MergeFetchedEpgTags())
+      bChanged = true;
+
+    if (bChanged)
     {
-      // announce changed viewport
+      // announce changed viewport or EPG data
       const CGUIMessage msg(
           GUI_MSG_REFRESH_LIST, GetParentID(), GetID(), static_cast<int>(PVREvent::Epg));
       KODI::MESSAGING::CApplicationMessenger::GetInstance().SendGUIMessage(msg);
     }
+
+    // prefetch the EPG data around the viewport, so that it is ready when scrolling there
+    FetchEpgTags();
   }
 
   CPoint originProgramme = CPoint(m_gridPosX, m_gridPosY) + m_renderOffset;
@@ -17,6 +17,7 @@
 #include "threads/CriticalSection.h"
 #include "utils/Geometry.h"
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <utility>
@@ -107,6 +108,15 @@ namespace PVR
 
     std::unique_ptr<CFileItemList> GetCurrentTimeLineItems() const;
 
+    /*!
+     * @brief Refresh the EPG data of the grid in the background, keeping its channels and layout.
+     * @param gridStart The start of the time range the grid shall cover.
+     * @param gridEnd The end of the time range the grid shall cover.
+     * @return true if the refresh was scheduled, false if the grid covers a different time range
+     * and has to be recreated using SetTimelineItems.
+     */
+    bool RefreshEpgTags(const CDateTime& gridStart, const CDateTime& gridEnd);
+
     /*!
      * @brief Set the control's selection to the given channel and set the control's view port to show the channel.
      * @param channel the channel.
@@ -212,6 +222,10 @@ namespace PVR
 
     void UpdateItems();
 
+    bool MergeFetchedEpgTags();
+    void FetchEpgTags();
+    void UpdateScrollStatistics(bool bScrolling, std::chrono::steady_clock::duration frameTime);
+
     float GetChannelScrollOffsetPos() const;
     float GetProgrammeScrollOffsetPos() const;
     int GetChannelScrollOffset(CGUIListItemLayout* layout) const;
@@ -266,9 +280,19 @@ namespace PVR
     float m_channelScrollOffset;
 
     mutable CCriticalSection m_critSection;
-    std::unique_ptr<CGUIEPGGridContainerModel> m_gridModel;
+    std::shared_ptr<CGUIEPGGridContainerModel> m_gridModel;
     std::unique_ptr<CGUIEPGGridContainerModel> m_updatedGridModel;
 
+    struct EpgTagsFetch;
+    std::shared_ptr<EpgTagsFetch> m_epgTagsFetch; //! EPG tags fetched in the background
+    bool m_bRefreshEpgTags = false;
+    CDateTime m_timelineStart;
+    CDateTime m_timelineEnd;
+
+    unsigned int m_scrollFrames = 0;
+    std::chrono::steady_clock::duration m_scrollFramesTime{};
+    std::chrono::steady_clock::duration m_scrollMaxFrameTime{};
+
     int m_itemStartBlock = 0;
   };
 }
@@ -18,6 +18,7 @@
 #include "utils/Variant.h"
 #include "utils/log.h"
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <vector>
@@ -33,7 +34,10 @@ void CGUIEPGGridContainerModel::SetInvalid()
   for (const auto& channel : m_channelItems)
     channel->SetInvalid();
   for (const auto& ruler : m_rulerItems)
-    ruler->SetInvalid();
+  {
+    if (ruler)
+      ruler->SetInvalid();
+  }
 }
 
 std::shared_ptr<CFileItem> CGUIEPGGridContainerModel::CreateGapItem(int iChannel) const
@@ -121,46 +125,66 @@ void CGUIEPGGridContainerModel::Initialize(const std::unique_ptr<CFileItemList>&
   }
 
   ////////////////////////////////////////////////////////////////////////
-  // Create ruler items
-  CDateTime ruler;
-  ruler.SetFromUTCDateTime(m_gridStart);
+  // Create ruler items. Only the date item is created here, the time items are created when
+  // they get visible (see GetRulerItem).
+  m_rulerStart.SetFromUTCDateTime(m_gridStart);
   CDateTime rulerEnd;
   rulerEnd.SetFromUTCDateTime(m_gridEnd);
-  CFileItemPtr rulerItem(new CFileItem(ruler.GetAsLocalizedDate(true)));
+  CFileItemPtr rulerItem(new CFileItem(m_rulerStart.GetAsLocalizedDate(true)));
   rulerItem->SetProperty("DateLabel", true);
   m_rulerItems.emplace_back(rulerItem);
 
-  const CDateTimeSpan unit(0, 0, iRulerUnit * MINSPERBLOCK, 0);
-  for (; ruler < rulerEnd; ruler += unit)
-  {
-    rulerItem.reset(new CFileItem(ruler.GetAsLocalizedTime("", false)));
-    rulerItem->SetLabel2(ruler.GetAsLocalizedDate(true));
-    m_rulerItems.emplace_back(rulerItem);
-  }
+  m_rulerUnitMinutes = std::max(iRulerUnit, 1) * MINSPERBLOCK;
+  const int rulerSeconds = (rulerEnd - m_rulerStart).GetSecondsTotal();
+  const int unitSeconds = m_rulerUnitMinutes * 60;
+  if (rulerSeconds > 0)
+    m_rulerItems.resize(1 + (rulerSeconds + unitSeconds - 1) / unitSeconds);
 
   m_firstActiveChannel = iFirstChannel;
   m_lastActiveChannel = iFirstChannel + iChannelsPerPage - 1;
   m_firstActiveBlock = iFirstBlock;
   m_lastActiveBlock = iFirstBlock + iBlocksPerPage - 1;
+  UpdateKeptArea();
 }
 
-std::shared_ptr<CFileItem> CGUIEPGGridContainerModel::CreateEpgTags(int iChannel, int iBlock) const
+std::shared_ptr<CFileItem> CGUIEPGGridContainerModel::GetRulerItem(int iIndex) const
 {
-  std::shared_ptr<CFileItem> result;
+  std::shared_ptr<CFileItem>& rulerItem = m_rulerItems[iIndex];
+  if (!rulerItem)
+  {
+    const CDateTime ruler =
+        m_rulerStart + CDateTimeSpan(0, 0, (iIndex - 1) * m_rulerUnitMinutes, 0);
+    rulerItem = std::make_shared<CFileItem>(ruler.GetAsLocalizedTime("", false));
+    rulerItem->SetLabel2(ruler.GetAsLocalizedDate(true));
+  }
+  return rulerItem;
+}
 
-  const int firstBlock = iBlock < m_firstActiveBlock ? iBlock : m_firstActiveBlock;
-  const int lastBlock = iBlock > m_lastActiveBlock ? iBlock : m_lastActiveBlock;
+void CGUIEPGGridContainerModel::UpdateKeptArea()
+{
+  const int channels = m_lastActiveChannel - m_firstActiveChannel + 1;
+  m_firstKeptChannel = std::max(m_firstActiveChannel - channels, 0);
+  m_lastKeptChannel = std::min(m_lastActiveChannel + channels, GetLastChannel());
 
+  const int blocks = m_lastActiveBlock - m_firstActiveBlock + 1;
+  m_firstKeptBlock = std::max(m_firstActiveBlock - blocks, 0);
+  m_lastKeptBlock = std::min(m_lastActiveBlock + blocks, GetLastBlock());
+}
+
+bool CGUIEPGGridContainerModel::FetchChannelEpgTags(int iChannel,
+                                                    int firstBlock,
+                                                    int lastBlock,
+                                                    EpgTags& epgTags) const
+{
   const auto tags =
       GetEPGTimeline(iChannel, GetStartTimeForBlock(firstBlock), GetStartTimeForBlock(lastBlock));
+  if (tags.empty())
+    return false;
 
   const int firstResultBlock = GetFirstEventBlock(tags.front());
   const int lastResultBlock = GetLastEventBlock(tags.back());
   if (firstResultBlock > lastResultBlock)
-    return result;
-
-  auto it = m_epgItems.insert({iChannel, EpgTags()}).first;
-  EpgTags& epgTags = (*it).second;
+    return false;
 
   epgTags.firstBlock = firstResultBlock;
   epgTags.lastBlock = lastResultBlock;
@@ -170,14 +194,34 @@ std::shared_ptr<CFileItem> CGUIEPGGridContainerModel::CreateEpgTags(int iChannel
     if (GetFirstEventBlock(tag) > GetLastEventBlock(tag))
       continue;
 
-    const std::shared_ptr<CFileItem> item = std::make_shared<CFileItem>(
-        tag, m_channelItems[iChannel]->GetPVRChannelGroupMemberInfoTag());
-    if (!result && IsEventMemberOfBlock(tag, iBlock))
-      result = item;
+    epgTags.tags.emplace_back(std::make_shared<CFileItem>(
+        tag, m_channelItems[iChannel]->GetPVRChannelGroupMemberInfoTag()));
+  }
+
+  return true;
+}
+
+std::shared_ptr<CFileItem> CGUIEPGGridContainerModel::CreateEpgTags(int iChannel, int iBlock) const
+{
+  std::shared_ptr<CFileItem> result;
+
+  const int firstBlock = iBlock < m_firstActiveBlock ? iBlock : m_firstActiveBlock;
+  const int lastBlock = iBlock > m_lastActiveBlock ? iBlock : m_lastActiveBlock;
+
+  EpgTags epgTags;
+  if (!FetchChannelEpgTags(iChannel, firstBlock, lastBlock, epgTags))
+    return result;
 
-    epgTags.tags.emplace_back(item);
+  for (const auto& item : epgTags.tags)
+  {
+    if (IsEventMemberOfBlock(item->GetEPGInfoTag(), iBlock))
+    {
+      result = item;
+      break;
+    }
   }
 
+  m_epgItems.insert({iChannel, std::move(epgTags)});
   return result;
 }
 
@@ -514,72 +558,202 @@ bool CGUIEPGGridContainerModel::FreeProgrammeMemory(int firstChannel,
   if (!channelsChanged && !blocksChanged)
     return false;
 
-  // clear the grid. it will be recreated on-demand.
-  m_gridIndex.clear();
+  m_firstActiveChannel = firstChannel;
+  m_lastActiveChannel = lastChannel;
+  m_firstActiveBlock = firstBlock;
+  m_lastActiveBlock = lastBlock;
+  UpdateKeptArea();
 
-  bool newChannels = false;
+  // Keep everything around the active area, so that scrolling does not recreate it. The rest is
+  // dropped and recreated on-demand.
+  for (auto it = m_gridIndex.begin(); it != m_gridIndex.end();)
+  {
+    const GridCoordinates& coordinates = (*it).first;
+    if (coordinates.channel < m_firstKeptChannel || coordinates.channel > m_lastKeptChannel ||
+        coordinates.block < m_firstKeptBlock || coordinates.block > m_lastKeptBlock)
+      it = m_gridIndex.erase(it);
+    else
+      ++it;
+  }
 
-  if (channelsChanged)
+  for (auto it = m_epgItems.begin(); it != m_epgItems.end();)
   {
-    // purge epg tags for inactive channels
-    for (auto it = m_epgItems.begin(); it != m_epgItems.end();)
+    if ((*it).first >= m_firstKeptChannel && (*it).first <= m_lastKeptChannel)
     {
-      if ((*it).first < firstChannel || (*it).first > lastChannel)
+      TrimEpgTags((*it).second);
+      if (!(*it).second.tags.empty())
       {
-        it = m_epgItems.erase(it);
-        continue; // next channel
+        ++it;
+        continue;
       }
-      ++it;
     }
+    it = m_epgItems.erase(it);
+  }
+
+  return true;
+}
 
-    newChannels = (firstChannel < m_firstActiveChannel) || (lastChannel > m_lastActiveChannel);
+void CGUIEPGGridContainerModel::TrimEpgTags(EpgTags& epgTags) const
+{
+  auto& tags = epgTags.tags;
+
+  const auto first = std::find_if(tags.cbegin(), tags.cend(), [this](const auto& item) {
+    return GetLastEventBlock(item->GetEPGInfoTag()) >= m_firstKeptBlock;
+  });
+  if (first != tags.cbegin())
+  {
+    tags.erase(tags.cbegin(), first);
+    if (!tags.empty())
+      epgTags.firstBlock = GetFirstEventBlock(tags.front()->GetEPGInfoTag());
   }
 
-  if (blocksChanged || newChannels)
+  const auto last = std::find_if(tags.crbegin(), tags.crend(), [this](const auto& item) {
+    return GetFirstEventBlock(item->GetEPGInfoTag()) <= m_lastKeptBlock;
+  });
+  if (last != tags.crbegin())
   {
-    // clear and refetch epg tags for active channels
-    const CDateTime maxEnd = GetStartTimeForBlock(firstBlock);
-    const CDateTime minStart = GetStartTimeForBlock(lastBlock);
-    std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
-    for (int i = firstChannel; i <= lastChannel; ++i)
+    tags.erase(last.base(), tags.cend());
+    if (!tags.empty())
+      epgTags.lastBlock = GetLastEventBlock(tags.back()->GetEPGInfoTag());
+  }
+}
+
+std::vector<int> CGUIEPGGridContainerModel::GetChannelsToFetch(bool bAll,
+                                                               int& firstBlock,
+                                                               int& lastBlock) const
+{
+  std::vector<int> channels;
+
+  firstBlock = m_firstKeptBlock;
+  lastBlock = m_lastKeptBlock;
+
+  for (int channel = m_firstKeptChannel; channel <= m_lastKeptChannel; ++channel)
+  {
+    if (!bAll)
     {
-      auto it = m_epgItems.find(i);
-      if (it == m_epgItems.end())
-        it = m_epgItems.insert({i, EpgTags()}).first;
+      const auto it = m_epgItems.find(channel);
+      if (it != m_epgItems.end() && (*it).second.firstBlock <= firstBlock &&
+          (*it).second.lastBlock >= lastBlock)
+        continue;
+    }
+    channels.emplace_back(channel);
+  }
 
-      if (blocksChanged || i < m_firstActiveChannel || i > m_lastActiveChannel)
-      {
-        EpgTags& epgTags = (*it).second;
+  return channels;
+}
 
-        (*it).second.tags.clear();
+CGUIEPGGridContainerModel::EpgTagsMap CGUIEPGGridContainerModel::FetchEpgTags(
+    const std::vector<int>& channels, int firstBlock, int lastBlock) const
+{
+  EpgTagsMap epgTags;
 
-        tags = GetEPGTimeline(i, maxEnd, minStart);
-        const int firstResultBlock = GetFirstEventBlock(tags.front());
-        const int lastResultBlock = GetLastEventBlock(tags.back());
-        if (firstResultBlock > lastResultBlock)
-          continue;
+  for (int channel : channels)
+  {
+    if (channel < 0 || channel >= ChannelItemsSize())
+      continue;
 
-        epgTags.firstBlock = firstResultBlock;
-        epgTags.lastBlock = lastResultBlock;
+    // channels without tags are kept as well, their tags may have been removed
+    EpgTags channelEpgTags;
+    FetchChannelEpgTags(channel, firstBlock, lastBlock, channelEpgTags);
+    epgTags.insert({channel, std::move(channelEpgTags)});
+  }
+
+  return epgTags;
+}
 
-        for (const auto& tag : tags)
-        {
-          if (GetFirstEventBlock(tag) > GetLastEventBlock(tag))
-            continue;
+bool CGUIEPGGridContainerModel::MergeEpgTags(EpgTagsMap& epgTags, bool bReplace)
+{
+  bool bChanged = false;
 
-          epgTags.tags.emplace_back(std::make_shared<CFileItem>(
-              tag, m_channelItems[i]->GetPVRChannelGroupMemberInfoTag()));
-        }
+  for (auto& fetched : epgTags)
+  {
+    const int channel = fetched.first;
+    if (channel < m_firstKeptChannel || channel > m_lastKeptChannel)
+      continue; // scrolled away meanwhile
+
+    auto it = m_epgItems.find(channel);
+    if (bReplace)
+    {
+      // a channel may have lost all of its tags, kept channels never have empty tags
+      if (fetched.second.tags.empty())
+      {
+        if (it != m_epgItems.end())
+          m_epgItems.erase(it);
       }
+      else
+        m_epgItems[channel] = std::move(fetched.second);
+
+      EraseGridItems(channel);
+      bChanged = true;
+    }
+    else if (fetched.second.tags.empty())
+    {
+      continue; // nothing to add
+    }
+    else if (it == m_epgItems.end())
+    {
+      m_epgItems.insert({channel, std::move(fetched.second)});
+      bChanged = true;
+    }
+    else if (ExtendEpgTags((*it).second, fetched.second))
+    {
+      bChanged = true;
     }
   }
 
-  m_firstActiveChannel = firstChannel;
-  m_lastActiveChannel = lastChannel;
-  m_firstActiveBlock = firstBlock;
-  m_lastActiveBlock = lastBlock;
+  return bChanged;
+}
 
-  return true;
+bool CGUIEPGGridContainerModel::ExtendEpgTags(EpgTags& epgTags, EpgTags& fetchedEpgTags) const
+{
+  auto& tags = epgTags.tags;
+  auto& fetched = fetchedEpgTags.tags;
+
+  if (tags.empty())
+  {
+    epgTags = std::move(fetchedEpgTags);
+    return true;
+  }
+
+  bool bChanged = false;
+
+  // prepend the fetched tags starting before the existing ones, if they continue seamlessly
+  const CDateTime firstStart = tags.front()->GetEPGInfoTag()->StartAsUTC();
+  const auto before =
+      std::find_if(fetched.cbegin(), fetched.cend(), [&firstStart](const auto& item) {
+        return item->GetEPGInfoTag()->StartAsUTC() >= firstStart;
+      });
+  if (before != fetched.cbegin() && (*(before - 1))->GetEPGInfoTag()->EndAsUTC() >= firstStart)
+  {
+    tags.insert(tags.begin(), fetched.cbegin(), before);
+    epgTags.firstBlock = std::min(epgTags.firstBlock, fetchedEpgTags.firstBlock);
+    bChanged = true;
+  }
+
+  // append the fetched tags starting after the existing ones, if they continue seamlessly
+  const CDateTime lastEnd = tags.back()->GetEPGInfoTag()->EndAsUTC();
+  const auto after = std::find_if(fetched.cbegin(), fetched.cend(), [&lastEnd](const auto& item) {
+    return item->GetEPGInfoTag()->StartAsUTC() >= lastEnd;
+  });
+  if (after != fetched.cend() && (*after)->GetEPGInfoTag()->StartAsUTC() <= lastEnd)
+  {
+    tags.insert(tags.end(), after, fetched.cend());
+    epgTags.lastBlock = std::max(epgTags.lastBlock, fetchedEpgTags.lastBlock);
+    bChanged = true;
+  }
+
+  return bChanged;
+}
+
+void CGUIEPGGridContainerModel::EraseGridItems(int iChannel)
+{
+  for (auto it = m_gridIndex.begin(); it != m_gridIndex.end();)
+  {
+    if ((*it).first.channel == iChannel)
+      it = m_gridIndex.erase(it);
+    else
+      ++it;
+  }
 }
 
 void CGUIEPGGridContainerModel::FreeRulerMemory(int keepStart, int keepEnd)
@@ -588,9 +762,9 @@ void CGUIEPGGridContainerModel::FreeRulerMemory(int keepStart, int keepEnd)
   {
     // remove before keepStart and after keepEnd
     for (int i = 1; i < keepStart && i < RulerItemsSize(); ++i)
-      m_rulerItems[i]->FreeMemory();
+      m_rulerItems[i].reset();
     for (int i = keepEnd + 1; i < RulerItemsSize(); ++i)
-      m_rulerItems[i]->FreeMemory();
+      m_rulerItems[i].reset();
   }
   else
   {
@@ -600,7 +774,7 @@ void CGUIEPGGridContainerModel::FreeRulerMemory(int keepStart, int keepEnd)
       if (i == 0)
         continue;
 
-      m_rulerItems[i]->FreeMemory();
+      m_rulerItems[i].reset();
     }
   }
 }
@@ -52,6 +52,15 @@ namespace PVR
   public:
     static constexpr int MINSPERBLOCK = 5; // minutes
 
+    struct EpgTags
+    {
+      std::vector<std::shared_ptr<CFileItem>> tags;
+      int firstBlock = -1;
+      int lastBlock = -1;
+    };
+
+    using EpgTagsMap = std::unordered_map<int, EpgTags>;
+
     CGUIEPGGridContainerModel() = default;
     virtual ~CGUIEPGGridContainerModel() = default;
 
@@ -73,6 +82,36 @@ namespace PVR
     bool FreeProgrammeMemory(int firstChannel, int lastChannel, int firstBlock, int lastBlock);
     void FreeRulerMemory(int keepStart, int keepEnd);
 
+    /*!
+     * @brief Get the channels whose EPG tags do not cover the area around the active part of the
+     * grid, which is kept in memory.
+     * @param bAll True to get all channels of the area, regardless of their EPG tags.
+     * @param firstBlock Return the first block of the area.
+     * @param lastBlock Return the last block of the area.
+     * @return The channel indices.
+     */
+    std::vector<int> GetChannelsToFetch(bool bAll, int& firstBlock, int& lastBlock) const;
+
+    /*!
+     * @brief Fetch the EPG tags of some channels for a range of blocks. Does not access any data
+     * changed after Initialize(), thus can be called from any thread while the model is alive.
+     * @param channels The channel indices.
+     * @param firstBlock The first block.
+     * @param lastBlock The last block.
+     * @return The EPG tags, suitable for MergeEpgTags(). Channels without tags are included.
+     */
+    EpgTagsMap FetchEpgTags(const std::vector<int>& channels, int firstBlock, int lastBlock) const;
+
+    /*!
+     * @brief Add fetched EPG tags to the model. Tags of channels no longer kept in memory are
+     * dropped.
+     * @param epgTags The EPG tags, moved into the model.
+     * @param bReplace True to replace the tags of the model, false to only add the tags the
+     * model does not have yet.
+     * @return True if the model changed, false otherwise.
+     */
+    bool MergeEpgTags(EpgTagsMap& epgTags, bool bReplace);
+
     std::shared_ptr<CFileItem> GetChannelItem(int iIndex) const { return m_channelItems[iIndex]; }
     bool HasChannelItems() const { return !m_channelItems.empty(); }
     int ChannelItemsSize() const { return static_cast<int>(m_channelItems.size()); }
@@ -81,7 +120,7 @@ namespace PVR
       return m_channelItems.empty() ? -1 : static_cast<int>(m_channelItems.size()) - 1;
     }
 
-    std::shared_ptr<CFileItem> GetRulerItem(int iIndex) const { return m_rulerItems[iIndex]; }
+    std::shared_ptr<CFileItem> GetRulerItem(int iIndex) const;
     int RulerItemsSize() const { return static_cast<int>(m_rulerItems.size()); }
 
     int GridItemsSize() const { return m_blocks; }
@@ -119,21 +158,17 @@ namespace PVR
     std::vector<std::shared_ptr<CPVREpgInfoTag>> GetEPGTimeline(
         int iChannel, const CDateTime& minEventEnd, const CDateTime& maxEventStart) const;
 
-    struct EpgTags
-    {
-      std::vector<std::shared_ptr<CFileItem>> tags;
-      int firstBlock = -1;
-      int lastBlock = -1;
-    };
-
-    using EpgTagsMap = std::unordered_map<int, EpgTags>;
-
+    bool FetchChannelEpgTags(int iChannel, int firstBlock, int lastBlock, EpgTags& epgTags) const;
     std::shared_ptr<CFileItem> CreateEpgTags(int iChannel, int iBlock) const;
     std::shared_ptr<CFileItem> GetEpgTags(EpgTagsMap::iterator& itEpg,
                                           int iChannel,
                                           int iBlock) const;
     std::shared_ptr<CFileItem> GetEpgTagsBefore(EpgTags& epgTags, int iChannel, int iBlock) const;
     std::shared_ptr<CFileItem> GetEpgTagsAfter(EpgTags& epgTags, int iChannel, int iBlock) const;
+    bool ExtendEpgTags(EpgTags& epgTags, EpgTags& fetchedEpgTags) const;
+    void TrimEpgTags(EpgTags& epgTags) const;
+    void EraseGridItems(int iChannel);
+    void UpdateKeptArea();
 
     mutable EpgTagsMap m_epgItems;
 
@@ -141,7 +176,9 @@ namespace PVR
     CDateTime m_gridEnd;
 
     std::vector<std::shared_ptr<CFileItem>> m_channelItems;
-    std::vector<std::shared_ptr<CFileItem>> m_rulerItems;
+    mutable std::vector<std::shared_ptr<CFileItem>> m_rulerItems; // created on demand
+    CDateTime m_rulerStart; // local time
+    int m_rulerUnitMinutes = 0;
 
     struct GridCoordinates
     {
@@ -173,5 +210,11 @@ namespace PVR
     int m_lastActiveChannel = 0;
     int m_firstActiveBlock = 0;
     int m_lastActiveBlock = 0;
+
+    // one page around the active area, kept in memory
+    int m_firstKeptChannel = 0;
+    int m_lastKeptChannel = 0;
+    int m_firstKeptBlock = 0;
+    int m_lastKeptBlock = 0;
   };
 }
@@ -43,6 +43,7 @@
 #include "pvr/channels/PVRChannelGroupMember.h"
 #include "pvr/channels/PVRChannelGroups.h"
 #include "pvr/channels/PVRChannelGroupsContainer.h"
+#include "pvr/channels/PVRChannelPrebuffers.h"
 #include "pvr/dialogs/GUIDialogPVRChannelGuide.h"
 #include "pvr/dialogs/GUIDialogPVRGuideInfo.h"
 #include "pvr/dialogs/GUIDialogPVRRecordingInfo.h"
@@ -1026,9 +1027,10 @@ namespace PVR
       return false;
     }
 
+    const std::shared_ptr<CPVRClient> client =
+        CServiceBroker::GetPVRManager().GetClient(recording->m_iClientId);
     std::shared_ptr<CPVRRecording> origRecording(new CPVRRecording);
-    origRecording->Update(*recording,
-                          *CServiceBroker::GetPVRManager().GetClient(recording->m_iClientId));
+    origRecording->Update(*recording, client->GetClientCapabilities());
 
     if (!ShowRecordingSettings(recording))
       return false;
@@ -1239,9 +1241,11 @@ namespace PVR
       {
         // If this was an EPG Tag to be played as live then PlayEpgTag() will create a channel
         // fileitem instead and pass the epg tags props so we use those and skip the client call
+        // A stream opened ahead of time comes with its props, no need to ask the client either
         if (epgProps)
           props = *epgProps;
-        else
+        else if (!CServiceBroker::GetPVRManager().ChannelPrebuffers()->Reserve(item->GetPath(),
+                                                                                props))
           client->GetChannelStreamProperties(item->GetPVRChannelInfoTag(), props);
       }
       else if (item->IsPVRRecording())
@@ -358,15 +358,16 @@ bool CPVRRecording::UpdateRecordingSize()
   return false;
 }
 
-void CPVRRecording::UpdateMetadata(CVideoDatabase& db, const CPVRClient& client)
+void CPVRRecording::UpdateMetadata(CVideoDatabase& db,
+                                   const CPVRClientCapabilities& capabilities)
 {
   if (m_bGotMetaData || !db.IsOpen())
     return;
 
-  if (!client.GetClientCapabilities().SupportsRecordingsPlayCount())
+  if (!capabilities.SupportsRecordingsPlayCount())
     CVideoInfoTag::SetPlayCount(db.GetPlayCount(m_strFileNameAndPath));
 
-  if (!client.GetClientCapabilities().SupportsRecordingsLastPlayedPosition())
+  if (!capabilities.SupportsRecordingsLastPlayedPosition())
   {
     CBookmark resumePoint;
     if (db.GetResumeBookMark(m_strFileNameAndPath, resumePoint))
@@ -387,7 +388,7 @@ std::vector<PVR_EDL_ENTRY> CPVRRecording::GetEdl() const
   return edls;
 }
 
-void CPVRRecording::Update(const CPVRRecording& tag, const CPVRClient& client)
+void CPVRRecording::Update(const CPVRRecording& tag, const CPVRClientCapabilities& capabilities)
 {
   m_strRecordingId = tag.m_strRecordingId;
   m_iClientId = tag.m_iClientId;
@@ -418,10 +419,10 @@ void CPVRRecording::Update(const CPVRRecording& tag, const CPVRClient& client)
     m_sizeInBytes = tag.m_sizeInBytes;
   }
 
-  if (client.GetClientCapabilities().SupportsRecordingsPlayCount())
+  if (capabilities.SupportsRecordingsPlayCount())
     CVideoInfoTag::SetPlayCount(tag.GetLocalPlayCount());
 
-  if (client.GetClientCapabilities().SupportsRecordingsLastPlayedPosition())
+  if (capabilities.SupportsRecordingsLastPlayedPosition())
     CVideoInfoTag::SetResumePoint(tag.GetLocalResumePoint());
 
   SetDuration(tag.GetDuration());
@@ -42,7 +42,7 @@ struct PVR_RECORDING;
 namespace PVR
 {
   class CPVRChannel;
-  class CPVRClient;
+  class CPVRClientCapabilities;
   class CPVRTimerInfoTag;
 
   /*!
@@ -186,16 +186,16 @@ namespace PVR
      * @brief Get the resume point and play count from the database if the
      * client doesn't handle it itself.
      * @param db The database to read the data from.
-     * @param client The client this recording belongs to.
+     * @param capabilities The capabilities of the client this recording belongs to.
      */
-    void UpdateMetadata(CVideoDatabase& db, const CPVRClient& client);
+    void UpdateMetadata(CVideoDatabase& db, const CPVRClientCapabilities& capabilities);
 
     /*!
      * @brief Update this tag with the contents of the given tag.
      * @param tag The new tag info.
-     * @param client The client this recording belongs to.
+     * @param capabilities The capabilities of the client this recording belongs to.
      */
-    void Update(const CPVRRecording& tag, const CPVRClient& client);
+    void Update(const CPVRRecording& tag, const CPVRClientCapabilities& capabilities);
 
     /*!
      * @brief Retrieve the recording start as UTC time
@@ -391,18 +391,6 @@ namespace PVR
     */
    int64_t GetSizeInBytes() const;
 
-    /*!
-     * @brief Mark a recording as dirty/clean.
-     * @param bDirty true to mark as dirty, false to mark as clean.
-     */
-    void SetDirty(bool bDirty) { m_bDirty = bDirty; }
-
-    /*!
-     * @brief Return whether the recording is marked dirty.
-     * @return true if dirty, false otherwise.
-     */
-    bool IsDirty() const { return m_bDirty; }
-
   private:
     void UpdatePath();
 
@@ -418,7 +406,6 @@ namespace PVR
     unsigned int m_iFlags = 0; /*!< the flags applicable to this recording */
     mutable XbmcThreads::EndTime m_recordingSizeRefetchTimeout;
     int64_t m_sizeInBytes = 0; /*!< the size of the recording in bytes */
-    bool m_bDirty = false;
 
     mutable CCriticalSection m_critSection;
   };
@@ -10,6 +10,7 @@
 
 #include "ServiceBroker.h"
 #include "pvr/PVRManager.h"
+#include "pvr/addons/PVRClient.h"
 #include "pvr/addons/PVRClients.h"
 #include "pvr/epg/EpgInfoTag.h"
 #include "pvr/recordings/PVRRecording.h"
@@ -37,24 +38,44 @@ void CPVRRecordings::UpdateFromClients()
 {
   CSingleLock lock(m_critSection);
 
-  for (const auto& recording : m_recordings)
-    recording.second->SetDirty(true);
+  m_changes = {};
+  m_diff.BeginUpdate();
 
   std::vector<int> failedClients;
-  CServiceBroker::GetPVRManager().Clients()->GetRecordings(this, false, failedClients);
-  CServiceBroker::GetPVRManager().Clients()->GetRecordings(this, true, failedClients);
+  GetRecordingsFromClients(failedClients);
 
   // remove recordings that were deleted at the backend
-  for (auto it = m_recordings.begin(); it != m_recordings.end();)
+  for (const auto& removed : m_diff.EndUpdate(failedClients))
   {
-    if ((*it).second->IsDirty() && std::find(failedClients.begin(), failedClients.end(),
-                                             (*it).second->ClientID()) == failedClients.end())
-      it = m_recordings.erase(it);
-    else
-      ++it;
+    const auto it = m_recordings.find(CPVRRecordingUid(removed.first, removed.second));
+    if (it != m_recordings.end())
+    {
+      AddRecordingCount(*it->second, -1);
+      m_recordings.erase(it);
+      ++m_changes.iRemoved;
+    }
   }
 }
 
+void CPVRRecordings::GetRecordingsFromClients(std::vector<int>& failedClients)
+{
+  CServiceBroker::GetPVRManager().Clients()->GetRecordings(this, false, failedClients);
+  CServiceBroker::GetPVRManager().Clients()->GetRecordings(this, true, failedClients);
+}
+
+void CPVRRecordings::PublishEvent(PVREvent event)
+{
+  CServiceBroker::GetPVRManager().PublishEvent(event);
+}
+
+void CPVRRecordings::AddRecordingCount(const CPVRRecording& recording, int iDelta)
+{
+  if (recording.IsRadio())
+    m_iRadioRecordings += iDelta;
+  else
+    m_iTVRecordings += iDelta;
+}
+
 int CPVRRecordings::Load()
 {
   Unload();
@@ -70,6 +91,7 @@ void CPVRRecordings::Unload()
   m_iTVRecordings = 0;
   m_iRadioRecordings = 0;
   m_recordings.clear();
+  m_diff.Clear();
 }
 
 void CPVRRecordings::Update()
@@ -85,9 +107,16 @@ void CPVRRecordings::Update()
 
   lock.Enter();
   m_bIsUpdating = false;
+  const Changes changes = m_changes;
   lock.Leave();
 
-  CServiceBroker::GetPVRManager().PublishEvent(PVREvent::RecordingsInvalidated);
+  CLog::LogFC(LOGDEBUG, LOGPVR, "Recordings updated: {} added, {} moved, {} changed, {} removed",
+              changes.iAdded, changes.iMoved, changes.iChanged, changes.iRemoved);
+
+  // The items of the lists hold copies of the recordings' data, so lists showing changed
+  // recordings need to be refetched as well
+  if (changes.iAdded > 0 || changes.iMoved > 0 || changes.iChanged > 0 || changes.iRemoved > 0)
+    PublishEvent(PVREvent::RecordingsInvalidated);
 }
 
 void CPVRRecordings::UpdateInProgressSize()
@@ -111,7 +140,7 @@ void CPVRRecordings::UpdateInProgressSize()
   m_bIsUpdating = false;
 
   if (bHaveUpdatedInProgessRecording)
-    CServiceBroker::GetPVRManager().PublishEvent(PVREvent::RecordingsInvalidated);
+    PublishEvent(PVREvent::RecordingsInvalidated);
 }
 
 int CPVRRecordings::GetNumTVRecordings() const
@@ -199,11 +228,23 @@ std::shared_ptr<CPVRRecording> CPVRRecordings::GetById(int iClientId, const std:
   return retVal;
 }
 
-void CPVRRecordings::UpdateFromClient(const std::shared_ptr<CPVRRecording>& tag,
-                                      const CPVRClient& client)
+void CPVRRecordings::UpdateFromClient(const PVR_RECORDING& recording, const CPVRClient& client)
+{
+  UpdateFromClient(recording, client.GetID(), client.GetClientCapabilities());
+}
+
+void CPVRRecordings::UpdateFromClient(const PVR_RECORDING& recording,
+                                      int iClientId,
+                                      const CPVRClientCapabilities& capabilities)
 {
   CSingleLock lock(m_critSection);
 
+  const CPVRRecordingsDiff::Change change = m_diff.Update(iClientId, recording);
+  if (change == CPVRRecordingsDiff::Change::NONE)
+    return;
+
+  const std::shared_ptr<CPVRRecording> tag = std::make_shared<CPVRRecording>(recording, iClientId);
+
   if (tag->IsDeleted())
   {
     if (tag->IsRadio())
@@ -215,18 +256,22 @@ void CPVRRecordings::UpdateFromClient(const std::shared_ptr<CPVRRecording>& tag,
   std::shared_ptr<CPVRRecording> existingTag = GetById(tag->m_iClientId, tag->m_strRecordingId);
   if (existingTag)
   {
-    existingTag->Update(*tag, client);
-    existingTag->SetDirty(false);
+    if (existingTag->m_strFileNameAndPath != tag->m_strFileNameAndPath)
+      ++m_changes.iMoved;
+    else
+      ++m_changes.iChanged;
+
+    AddRecordingCount(*existingTag, -1);
+    existingTag->Update(*tag, capabilities);
+    AddRecordingCount(*existingTag, 1);
   }
   else
   {
-    tag->UpdateMetadata(GetVideoDatabase(), client);
+    tag->UpdateMetadata(GetVideoDatabase(), capabilities);
     tag->m_iRecordingId = ++m_iLastId;
     m_recordings.insert({CPVRRecordingUid(tag->m_iClientId, tag->m_strRecordingId), tag});
-    if (tag->IsRadio())
-      ++m_iRadioRecordings;
-    else
-      ++m_iTVRecordings;
+    AddRecordingCount(*tag, 1);
+    ++m_changes.iAdded;
   }
 }
 
@@ -296,7 +341,7 @@ bool CPVRRecordings::ChangeRecordingsPlayCount(const std::shared_ptr<CPVRRecordi
         recording->SetResumePoint(CBookmark());
       }
 
-      CServiceBroker::GetPVRManager().PublishEvent(PVREvent::RecordingsInvalidated);
+      PublishEvent(PVREvent::RecordingsInvalidated);
       return true;
     }
   }
@@ -328,7 +373,7 @@ bool CPVRRecordings::ResetResumePoint(const std::shared_ptr<CPVRRecording>& reco
       db.ClearBookMarksOfFile(recording->m_strFileNameAndPath, CBookmark::RESUME);
       recording->SetResumePoint(CBookmark());
 
-      CServiceBroker::GetPVRManager().PublishEvent(PVREvent::RecordingsInvalidated);
+      PublishEvent(PVREvent::RecordingsInvalidated);
     }
   }
   return bResult;
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "pvr/recordings/PVRRecordingsDiff.h"
 #include "threads/CriticalSection.h"
 
 #include <map>
@@ -17,14 +18,19 @@
 
 class CVideoDatabase;
 
+struct PVR_RECORDING;
+
 namespace PVR
 {
   class CPVRClient;
+  class CPVRClientCapabilities;
   class CPVREpgInfoTag;
   class CPVRRecording;
   class CPVRRecordingUid;
   class CPVRRecordingsPath;
 
+  enum class PVREvent;
+
   class CPVRRecordings
   {
   public:
@@ -44,13 +50,24 @@ namespace PVR
 
     /*!
      * @brief client has delivered a new/updated recording.
-     * @param tag The recording
+     * @param recording The recording
      * @param client The client the recording belongs to.
      */
-    void UpdateFromClient(const std::shared_ptr<CPVRRecording>& tag, const CPVRClient& client);
+    void UpdateFromClient(const PVR_RECORDING& recording, const CPVRClient& client);
+
+    /*!
+     * @brief client has delivered a new/updated recording.
+     * @param recording The recording
+     * @param iClientId The id of the client the recording belongs to.
+     * @param capabilities The capabilities of the client the recording belongs to.
+     */
+    void UpdateFromClient(const PVR_RECORDING& recording,
+                          int iClientId,
+                          const CPVRClientCapabilities& capabilities);
 
     /*!
-     * @brief refresh the recordings list from the clients.
+     * @brief refresh the recordings list from the clients. Recordings the clients deliver
+     * unchanged are skipped, observers are only notified if any recording changed.
      */
     void Update();
 
@@ -96,6 +113,19 @@ namespace PVR
      */
     std::shared_ptr<CPVRRecording> GetRecordingForEpgTag(const std::shared_ptr<CPVREpgInfoTag>& epgTag) const;
 
+  protected:
+    /*!
+     * @brief Let the clients deliver their recordings through UpdateFromClient.
+     * @param failedClients Filled with the ids of the clients failing to deliver.
+     */
+    virtual void GetRecordingsFromClients(std::vector<int>& failedClients);
+
+    /*!
+     * @brief Notify the observers of the recordings about a change.
+     * @param event The event.
+     */
+    virtual void PublishEvent(PVREvent event);
+
   private:
     mutable CCriticalSection m_critSection;
     bool m_bIsUpdating = false;
@@ -106,8 +136,20 @@ namespace PVR
     bool m_bDeletedRadioRecordings = false;
     unsigned int m_iTVRecordings = 0;
     unsigned int m_iRadioRecordings = 0;
+    CPVRRecordingsDiff m_diff;
+
+    //! The changes of the running update
+    struct Changes
+    {
+      unsigned int iAdded = 0;
+      unsigned int iMoved = 0; //!< Changed recordings with a new path
+      unsigned int iChanged = 0; //!< Changed recordings keeping their path
+      unsigned int iRemoved = 0;
+    };
+    Changes m_changes;
 
     void UpdateFromClients();
+    void AddRecordingCount(const CPVRRecording& recording, int iDelta);
 
     /*!
      * @brief Get/Open the video database.
@@ -0,0 +1,134 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "PVRRecordingsDiff.h"
+
+#include "addons/kodi-dev-kit/include/kodi/c-api/addon-instance/pvr/pvr_recordings.h"
+
+#include <algorithm>
+
+using namespace PVR;
+
+namespace
+{
+// 64 bit FNV-1a
+class CHash
+{
+public:
+  template<size_t N>
+  void AddText(const char (&text)[N])
+  {
+    // Only the text up to the terminating null is set by the clients
+    for (size_t i = 0; i < N && text[i] != '\0'; ++i)
+      AddByte(static_cast<unsigned char>(text[i]));
+
+    AddByte(0);
+  }
+
+  template<typename T>
+  void AddValue(T value)
+  {
+    const int64_t bytes = static_cast<int64_t>(value);
+    for (size_t i = 0; i < sizeof(bytes); ++i)
+      AddByte(static_cast<unsigned char>(bytes >> (i * 8)));
+  }
+
+  uint64_t Get() const { return m_iHash; }
+
+private:
+  void AddByte(unsigned char byte)
+  {
+    m_iHash ^= byte;
+    m_iHash *= 1099511628211ULL;
+  }
+
+  uint64_t m_iHash = 14695981039346656037ULL;
+};
+} // unnamed namespace
+
+uint64_t CPVRRecordingsDiff::GetHash(const PVR_RECORDING& recording)
+{
+  CHash hash;
+  hash.AddText(recording.strRecordingId);
+  hash.AddText(recording.strTitle);
+  hash.AddText(recording.strEpisodeName);
+  hash.AddValue(recording.iSeriesNumber);
+  hash.AddValue(recording.iEpisodeNumber);
+  hash.AddValue(recording.iYear);
+  hash.AddText(recording.strDirectory);
+  hash.AddText(recording.strPlotOutline);
+  hash.AddText(recording.strPlot);
+  hash.AddText(recording.strGenreDescription);
+  hash.AddText(recording.strChannelName);
+  hash.AddText(recording.strIconPath);
+  hash.AddText(recording.strThumbnailPath);
+  hash.AddText(recording.strFanartPath);
+  hash.AddValue(recording.recordingTime);
+  hash.AddValue(recording.iDuration);
+  hash.AddValue(recording.iPriority);
+  hash.AddValue(recording.iLifetime);
+  hash.AddValue(recording.iGenreType);
+  hash.AddValue(recording.iGenreSubType);
+  hash.AddValue(recording.iPlayCount);
+  hash.AddValue(recording.iLastPlayedPosition);
+  hash.AddValue(recording.bIsDeleted);
+  hash.AddValue(recording.iEpgEventId);
+  hash.AddValue(recording.iChannelUid);
+  hash.AddValue(recording.channelType);
+  hash.AddText(recording.strFirstAired);
+  hash.AddValue(recording.iFlags);
+  hash.AddValue(recording.sizeInBytes);
+  return hash.Get();
+}
+
+void CPVRRecordingsDiff::BeginUpdate()
+{
+  for (auto& recording : m_recordings)
+    recording.second.bDelivered = false;
+}
+
+CPVRRecordingsDiff::Change CPVRRecordingsDiff::Update(int iClientId,
+                                                      const PVR_RECORDING& recording)
+{
+  const uint64_t iHash = GetHash(recording);
+
+  const auto result = m_recordings.insert({{iClientId, recording.strRecordingId}, {iHash, true}});
+  if (result.second)
+    return Change::ADDED;
+
+  Entry& entry = result.first->second;
+  entry.bDelivered = true;
+  if (entry.iHash == iHash)
+    return Change::NONE;
+
+  entry.iHash = iHash;
+  return Change::CHANGED;
+}
+
+std::vector<CPVRRecordingsDiff::RecordingKey> CPVRRecordingsDiff::EndUpdate(
+    const std::vector<int>& failedClients)
+{
+  std::vector<RecordingKey> removed;
+  for (auto it = m_recordings.begin(); it != m_recordings.end();)
+  {
+    if (!it->second.bDelivered && std::find(failedClients.begin(), failedClients.end(),
+                                            it->first.first) == failedClients.end())
+    {
+      removed.emplace_back(it->first);
+      it = m_recordings.erase(it);
+    }
+    else
+      ++it;
+  }
+  return removed;
+}
+
+void CPVRRecordingsDiff::Clear()
+{
+  m_recordings.clear();
+}
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct PVR_RECORDING;
+
+namespace PVR
+{
+/*!
+ * @brief Tells which of the recordings delivered by the clients were added, changed or removed
+ * since the previous update.
+ *
+ * The clients always deliver all of their recordings. A hash of the data delivered for each
+ * recording is kept, so recordings delivered unchanged can be skipped without converting them.
+ */
+class CPVRRecordingsDiff
+{
+public:
+  enum class Change
+  {
+    NONE,
+    ADDED,
+    CHANGED,
+  };
+
+  //! The client id and the client's recording id
+  using RecordingKey = std::pair<int, std::string>;
+
+  /*!
+   * @brief Get the hash of the data of a recording.
+   * @param recording The recording.
+   * @return The hash.
+   */
+  static uint64_t GetHash(const PVR_RECORDING& recording);
+
+  /*!
+   * @brief Start an update. All recordings not delivered until EndUpdate() are removed.
+   */
+  void BeginUpdate();
+
+  /*!
+   * @brief A client delivered a recording.
+   * @param iClientId The id of the client.
+   * @param recording The recording.
+   * @return The change of the recording since the previous update.
+   */
+  Change Update(int iClientId, const PVR_RECORDING& recording);
+
+  /*!
+   * @brief Finish an update.
+   * @param failedClients The clients that failed to deliver their recordings. Their recordings are
+   * not removed.
+   * @return The recordings removed.
+   */
+  std::vector<RecordingKey> EndUpdate(const std::vector<int>& failedClients);
+
+  /*!
+   * @brief Forget all recordings.
+   */
+  void Clear();
+
+  /*!
+   * @brief Get the number of recordings.
+   * @return The number of recordings.
+   */
+  size_t Size() const { return m_recordings.size(); }
+
+private:
+  struct Entry
+  {
+    uint64_t iHash;
+    bool bDelivered;
+  };
+
+  std::map<RecordingKey, Entry> m_recordings;
+};
+} // namespace PVR
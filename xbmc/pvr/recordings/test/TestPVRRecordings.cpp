@@ -0,0 +1,154 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "addons/kodi-dev-kit/include/kodi/c-api/addon-instance/pvr/pvr_recordings.h"
+#include "pvr/PVRManager.h"
+#include "pvr/PVRManagerJobQueue.h"
+#include "pvr/addons/PVRClient.h"
+#include "pvr/recordings/PVRRecording.h"
+#include "pvr/recordings/PVRRecordings.h"
+#include "pvr/test/PVRTestUtils.h"
+
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PVR;
+using namespace std::chrono_literals;
+
+namespace
+{
+constexpr int CLIENT_ID = 1;
+
+//! Recordings delivered by a stand-in backend, keeping the events published for observers
+class CTestRecordings : public CPVRRecordings
+{
+public:
+  void Add(const std::string& strId, const std::string& strTitle, int64_t sizeInBytes)
+  {
+    PVR_RECORDING recording = {};
+    std::strncpy(recording.strRecordingId, strId.c_str(), sizeof(recording.strRecordingId) - 1);
+    std::strncpy(recording.strTitle, strTitle.c_str(), sizeof(recording.strTitle) - 1);
+    recording.recordingTime = PVRTestUtils::FIRST_START;
+    recording.iDuration = PVRTestUtils::DURATION;
+    recording.sizeInBytes = sizeInBytes;
+    recording.channelType = PVR_RECORDING_CHANNEL_TYPE_TV;
+    recording.iChannelUid = PVR_CHANNEL_INVALID_UID;
+    m_backend[strId] = recording;
+  }
+
+  std::map<std::string, PVR_RECORDING> m_backend;
+  std::vector<PVREvent> m_events;
+  unsigned int m_iUpdates = 0;
+
+protected:
+  void GetRecordingsFromClients(std::vector<int>& /* failedClients */) override
+  {
+    ++m_iUpdates;
+    for (const auto& recording : m_backend)
+      UpdateFromClient(recording.second, CLIENT_ID, m_capabilities);
+  }
+
+  void PublishEvent(PVREvent event) override { m_events.emplace_back(event); }
+
+private:
+  const CPVRClientCapabilities m_capabilities;
+};
+
+class TestPVRRecordings : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_recordings.Add("1", "First", 1000);
+    m_recordings.Add("2", "Second", 2000);
+    m_recordings.Add("3", "Third", 3000);
+    m_recordings.Update();
+    ASSERT_EQ(m_recordings.m_events.size(), 1u);
+    m_recordings.m_events.clear();
+  }
+
+  CTestRecordings m_recordings;
+};
+} // namespace
+
+TEST_F(TestPVRRecordings, UnchangedRecordingsNotifyNothing)
+{
+  EXPECT_EQ(m_recordings.GetNumTVRecordings(), 3);
+
+  m_recordings.Update();
+  EXPECT_TRUE(m_recordings.m_events.empty());
+  EXPECT_EQ(m_recordings.GetNumTVRecordings(), 3);
+}
+
+TEST_F(TestPVRRecordings, ChangedRecordingsInvalidateLists)
+{
+  // The items shown for a recording hold copies of its data, so the lists must be refetched for
+  // changes in place as well
+  m_recordings.Add("2", "Second", 2500);
+  m_recordings.Update();
+  ASSERT_EQ(m_recordings.m_events.size(), 1u);
+  EXPECT_EQ(m_recordings.m_events[0], PVREvent::RecordingsInvalidated);
+  EXPECT_EQ(m_recordings.GetById(CLIENT_ID, "2")->GetSizeInBytes(), 2500);
+
+  // A new title moves the recording to another path
+  m_recordings.m_events.clear();
+  m_recordings.Add("3", "Renamed", 3000);
+  m_recordings.Update();
+  ASSERT_EQ(m_recordings.m_events.size(), 1u);
+  EXPECT_EQ(m_recordings.m_events[0], PVREvent::RecordingsInvalidated);
+  EXPECT_EQ(m_recordings.GetById(CLIENT_ID, "3")->m_strTitle, "Renamed");
+  EXPECT_EQ(m_recordings.GetNumTVRecordings(), 3);
+}
+
+TEST_F(TestPVRRecordings, RemovedRecordingsInvalidateLists)
+{
+  m_recordings.m_backend.erase("1");
+  m_recordings.Update();
+  ASSERT_EQ(m_recordings.m_events.size(), 1u);
+  EXPECT_EQ(m_recordings.m_events[0], PVREvent::RecordingsInvalidated);
+  EXPECT_FALSE(m_recordings.GetById(CLIENT_ID, "1"));
+  EXPECT_EQ(m_recordings.GetNumTVRecordings(), 2);
+}
+
+TEST_F(TestPVRRecordings, CoalescedUpdates)
+{
+  CPVRManagerJobQueue queue;
+  queue.Start();
+
+  // A backend notifying each single change of a burst. The queue runs its jobs only when asked
+  // to, so the whole burst is in before any update could run.
+  for (int i = 0; i < 20; ++i)
+  {
+    m_recordings.Add("1", "First", 1000 + i);
+    queue.AppendCoalesced("pvr-update-recordings", 10ms, 1000ms,
+                          [this]() { m_recordings.Update(); });
+  }
+
+  const unsigned int iUpdates = m_recordings.m_iUpdates;
+  for (int i = 0; i < 100 && m_recordings.m_iUpdates == iUpdates; ++i)
+  {
+    queue.WaitForJobs(100);
+    queue.ExecutePendingJobs();
+  }
+
+  EXPECT_EQ(m_recordings.m_iUpdates, iUpdates + 1);
+  ASSERT_EQ(m_recordings.m_events.size(), 1u);
+  EXPECT_EQ(m_recordings.m_events[0], PVREvent::RecordingsInvalidated);
+  EXPECT_EQ(m_recordings.GetById(CLIENT_ID, "1")->GetSizeInBytes(), 1019);
+
+  // Nothing is left to run
+  queue.ExecutePendingJobs();
+  EXPECT_EQ(m_recordings.m_iUpdates, iUpdates + 1);
+
+  queue.Stop();
+}
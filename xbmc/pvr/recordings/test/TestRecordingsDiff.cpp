@@ -0,0 +1,246 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "addons/kodi-dev-kit/include/kodi/c-api/addon-instance/pvr/pvr_recordings.h"
+#include "pvr/recordings/PVRRecordingsDiff.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PVR;
+
+namespace
+{
+//! Stand-in for a PVR client, keeps its recordings and delivers them in full like the add-ons do,
+//! reusing one PVR_RECORDING for all of them
+class CStandInClient
+{
+public:
+  CStandInClient(int iClientId, unsigned int iSeed) : m_iClientId(iClientId), m_random(iSeed) {}
+
+  struct Recording
+  {
+    std::string strTitle;
+    std::string strPlot;
+    int iPlayCount = 0;
+    int64_t sizeInBytes = 0;
+  };
+
+  void Add(size_t iCount)
+  {
+    for (size_t i = 0; i < iCount; ++i)
+    {
+      const std::string strId = "rec" + std::to_string(m_iNextId++);
+      m_recordings[strId] = {"Title " + strId, "Plot of " + strId, 0, 1000};
+    }
+  }
+
+  //! Change, remove and add the given numbers of recordings
+  void Churn(size_t iChanged, size_t iRemoved, size_t iAdded)
+  {
+    m_changed.clear();
+    m_removed.clear();
+
+    for (size_t i = 0; i < iRemoved; ++i)
+    {
+      const auto it = RandomRecording();
+      m_removed.insert(it->first);
+      m_recordings.erase(it);
+    }
+
+    while (m_changed.size() < iChanged)
+    {
+      const auto it = RandomRecording();
+      if (!m_changed.insert(it->first).second)
+        continue;
+
+      switch (m_changed.size() % 4)
+      {
+        case 0:
+          it->second.strTitle += " (new)";
+          break;
+        case 1:
+          it->second.strPlot += ".";
+          break;
+        case 2:
+          ++it->second.iPlayCount;
+          break;
+        default:
+          it->second.sizeInBytes += 1000;
+          break;
+      }
+    }
+
+    Add(iAdded);
+  }
+
+  void Deliver(CPVRRecordingsDiff& diff, std::map<CPVRRecordingsDiff::Change, size_t>& changes)
+  {
+    for (const auto& recording : m_recordings)
+    {
+      // Add-ons reuse their structs, text of previous recordings stays after the null
+      Copy(recording.first, m_recording.strRecordingId);
+      Copy(recording.second.strTitle, m_recording.strTitle);
+      Copy(recording.second.strPlot, m_recording.strPlot);
+      m_recording.iPlayCount = recording.second.iPlayCount;
+      m_recording.sizeInBytes = recording.second.sizeInBytes;
+
+      const CPVRRecordingsDiff::Change change = diff.Update(m_iClientId, m_recording);
+      ++changes[change];
+      if (change == CPVRRecordingsDiff::Change::CHANGED)
+      {
+        EXPECT_EQ(m_changed.count(recording.first), 1u) << recording.first;
+      }
+    }
+  }
+
+  const int m_iClientId;
+  std::set<std::string> m_changed;
+  std::set<std::string> m_removed;
+
+private:
+  template<size_t N>
+  static void Copy(const std::string& text, char (&target)[N])
+  {
+    std::memcpy(target, text.c_str(), std::min(text.size() + 1, N));
+    target[N - 1] = '\0';
+  }
+
+  std::map<std::string, Recording>::iterator RandomRecording()
+  {
+    auto it = m_recordings.begin();
+    std::advance(it, std::uniform_int_distribution<size_t>(0, m_recordings.size() - 1)(m_random));
+    return it;
+  }
+
+  std::map<std::string, Recording> m_recordings;
+  unsigned int m_iNextId = 0;
+  std::mt19937 m_random;
+  PVR_RECORDING m_recording = {};
+};
+} // namespace
+
+TEST(TestRecordingsDiff, Hash)
+{
+  PVR_RECORDING recording = {};
+  std::strcpy(recording.strRecordingId, "1");
+  std::strcpy(recording.strTitle, "Title");
+  const uint64_t iHash = CPVRRecordingsDiff::GetHash(recording);
+
+  // Text after the terminating null is not part of the data
+  PVR_RECORDING same = recording;
+  std::strcpy(same.strPlot, "Plot");
+  same.strPlot[0] = '\0';
+  EXPECT_EQ(CPVRRecordingsDiff::GetHash(same), iHash);
+
+  // Text moving from one field to the next is a change
+  PVR_RECORDING moved = recording;
+  std::strcpy(moved.strTitle, "Titl");
+  std::strcpy(moved.strEpisodeName, "e");
+  EXPECT_NE(CPVRRecordingsDiff::GetHash(moved), iHash);
+
+  PVR_RECORDING changed = recording;
+  changed.iLastPlayedPosition = 1;
+  EXPECT_NE(CPVRRecordingsDiff::GetHash(changed), iHash);
+
+  changed = recording;
+  changed.sizeInBytes = 1LL << 40;
+  EXPECT_NE(CPVRRecordingsDiff::GetHash(changed), iHash);
+
+  changed = recording;
+  changed.bIsDeleted = true;
+  EXPECT_NE(CPVRRecordingsDiff::GetHash(changed), iHash);
+}
+
+TEST(TestRecordingsDiff, Churn)
+{
+  std::vector<CStandInClient> clients = {{1, 1}, {2, 2}};
+  clients[0].Add(3000);
+  clients[1].Add(2000);
+
+  CPVRRecordingsDiff diff;
+  std::map<CPVRRecordingsDiff::Change, size_t> changes;
+  diff.BeginUpdate();
+  for (auto& client : clients)
+    client.Deliver(diff, changes);
+  EXPECT_TRUE(diff.EndUpdate({}).empty());
+  EXPECT_EQ(changes[CPVRRecordingsDiff::Change::ADDED], 5000u);
+  EXPECT_EQ(diff.Size(), 5000u);
+
+  for (int round = 0; round < 10; ++round)
+  {
+    clients[0].Churn(20, 5, 10);
+    clients[1].Churn(10, 10, 0);
+
+    changes.clear();
+    diff.BeginUpdate();
+    for (auto& client : clients)
+      client.Deliver(diff, changes);
+    const std::vector<CPVRRecordingsDiff::RecordingKey> removed = diff.EndUpdate({});
+
+    EXPECT_EQ(changes[CPVRRecordingsDiff::Change::ADDED], 10u);
+    EXPECT_EQ(changes[CPVRRecordingsDiff::Change::CHANGED], 30u);
+    EXPECT_EQ(changes[CPVRRecordingsDiff::Change::NONE], diff.Size() - 40u);
+
+    ASSERT_EQ(removed.size(), 15u);
+    for (const auto& key : removed)
+    {
+      const CStandInClient& client = clients[key.first - 1];
+      EXPECT_EQ(client.m_removed.count(key.second), 1u) << key.second;
+    }
+  }
+
+  // A client failing to deliver keeps its recordings
+  clients[1].Churn(0, 100, 0);
+  changes.clear();
+  diff.BeginUpdate();
+  clients[0].Deliver(diff, changes);
+  const size_t iSize = diff.Size();
+  EXPECT_TRUE(diff.EndUpdate({clients[1].m_iClientId}).empty());
+  EXPECT_EQ(diff.Size(), iSize);
+
+  diff.Clear();
+  EXPECT_EQ(diff.Size(), 0u);
+}
+
+TEST(TestRecordingsDiff, DISABLED_Benchmark)
+{
+  CStandInClient client(1, 3);
+  client.Add(10000);
+
+  CPVRRecordingsDiff diff;
+  std::map<CPVRRecordingsDiff::Change, size_t> changes;
+  diff.BeginUpdate();
+  client.Deliver(diff, changes);
+  diff.EndUpdate({});
+
+  const auto start = std::chrono::steady_clock::now();
+  client.Churn(10, 0, 0);
+  changes.clear();
+  diff.BeginUpdate();
+  client.Deliver(diff, changes);
+  diff.EndUpdate({});
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << "Diffed 10000 recordings in " << seconds * 1000 << " ms" << std::endl;
+  RecordProperty("diff_milliseconds", static_cast<int>(seconds * 1000));
+
+  // Only the changed recordings need to be converted and published
+  EXPECT_EQ(changes[CPVRRecordingsDiff::Change::CHANGED], 10u);
+  EXPECT_EQ(changes[CPVRRecordingsDiff::Change::NONE], 9990u);
+}
@@ -0,0 +1,76 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "addons/kodi-dev-kit/include/kodi/c-api/addon-instance/pvr/pvr_epg.h"
+#include "pvr/epg/EpgInfoTag.h"
+
+#include <ctime>
+#include <memory>
+#include <string>
+
+namespace PVRTestUtils
+{
+/*!
+ * \brief Start of the first event of the guides the PVR tests build, 2021-01-01 00:00 UTC
+ */
+constexpr time_t FIRST_START = 1609459200;
+
+/*!
+ * \brief Duration of an event of the guides the PVR tests build
+ */
+constexpr time_t DURATION = 30 * 60;
+
+/*!
+ * \brief The data of an EPG tag to create, owning the strings EPG_TAG only points to
+ */
+struct EpgTagData
+{
+  int iClientId = 1;
+  int iChannelUid = 1;
+  int iEpgId = 1;
+  time_t start = FIRST_START;
+  time_t end = 0; //!< 0 for start + DURATION
+  std::string title;
+  std::string plotOutline;
+  std::string plot;
+  std::string cast;
+  std::string seriesLink;
+  unsigned int iGenreType = 0;
+  //! empty for the minimal channel data CPVREpgInfoTag creates itself
+  std::shared_ptr<PVR::CPVREpgChannelData> channelData;
+};
+
+/*!
+ * \brief Creates EPG tags, each with a broadcast id of its own
+ */
+class CEpgTagFactory
+{
+public:
+  std::shared_ptr<PVR::CPVREpgInfoTag> Create(const EpgTagData& tagData)
+  {
+    EPG_TAG data = {};
+    data.iUniqueBroadcastId = ++m_iUniqueBroadcastId;
+    data.iUniqueChannelId = tagData.iChannelUid;
+    data.strTitle = tagData.title.c_str();
+    data.strPlotOutline = tagData.plotOutline.c_str();
+    data.strPlot = tagData.plot.c_str();
+    data.strCast = tagData.cast.c_str();
+    data.strSeriesLink = tagData.seriesLink.c_str();
+    data.iGenreType = tagData.iGenreType;
+    data.startTime = tagData.start;
+    data.endTime = tagData.end > 0 ? tagData.end : tagData.start + DURATION;
+    return std::make_shared<PVR::CPVREpgInfoTag>(data, tagData.iClientId, tagData.channelData,
+                                                 tagData.iEpgId);
+  }
+
+private:
+  unsigned int m_iUniqueBroadcastId = 0;
+};
+} // namespace PVRTestUtils
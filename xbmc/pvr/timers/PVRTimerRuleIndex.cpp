@@ -0,0 +1,280 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "PVRTimerRuleIndex.h"
+
+#include "XBDateTime.h"
+#include "pvr/epg/EpgInfoTag.h"
+#include "pvr/timers/PVRTimerInfoTag.h"
+#include "pvr/timers/PVRTimerType.h"
+#include "utils/StringUtils.h"
+
+#include <algorithm>
+#include <memory>
+
+using namespace PVR;
+
+namespace
+{
+constexpr size_t TEXT_KEY_LENGTH = 3;
+
+// CRegExp ignores the case of ASCII letters only
+char ToLower(char c)
+{
+  return StringUtils::isasciiuppercaseletter(c) ? c - 'A' + 'a' : c;
+}
+
+bool IsAscii(const std::string& text)
+{
+  return std::all_of(text.begin(), text.end(),
+                     [](char c) { return static_cast<unsigned char>(c) < 0x80; });
+}
+
+int GetMinuteOfDay(const CDateTime& localTime)
+{
+  return localTime.GetHour() * 60 + localTime.GetMinute();
+}
+
+unsigned int GetWeekday(const CDateTime& localTime)
+{
+  int weekday = localTime.GetDayOfWeek();
+  if (weekday == 0)
+    weekday = 7;
+
+  return 1 << (weekday - 1);
+}
+} // unnamed namespace
+
+struct CPVRTimerRuleIndex::TagAttributes
+{
+  explicit TagAttributes(const CPVREpgInfoTag& tag)
+    : strSeriesLink(tag.SeriesLink())
+  {
+    const CDateTime start = CPVRTimerInfoTag::ConvertUTCToLocalTime(tag.StartAsUTC());
+    const CDateTime end = CPVRTimerInfoTag::ConvertUTCToLocalTime(tag.EndAsUTC());
+    iWeekday = GetWeekday(start);
+    iStartMinute = GetMinuteOfDay(start);
+    iEndMinute = GetMinuteOfDay(end);
+
+    const std::string title = tag.Title();
+    for (size_t i = 0; i + TEXT_KEY_LENGTH <= title.size(); ++i)
+    {
+      std::string key = title.substr(i, TEXT_KEY_LENGTH);
+      std::transform(key.begin(), key.end(), key.begin(), ToLower);
+      titleKeys.emplace_back(std::move(key));
+    }
+    std::sort(titleKeys.begin(), titleKeys.end());
+    titleKeys.erase(std::unique(titleKeys.begin(), titleKeys.end()), titleKeys.end());
+  }
+
+  bool Matches(const Entry& entry) const
+  {
+    return (entry.iWeekdays & iWeekday) && iStartMinute >= entry.iStartMinute &&
+           iEndMinute <= entry.iEndMinute;
+  }
+
+  std::string strSeriesLink;
+  std::vector<std::string> titleKeys;
+  unsigned int iWeekday = 0;
+  int iStartMinute = 0;
+  int iEndMinute = 0;
+};
+
+bool CPVRTimerRuleIndex::GetRule(const CPVRTimerInfoTag& timerRule, Rule& rule)
+{
+  // The same decisions as CPVRTimerRuleMatcher
+  const std::shared_ptr<CPVRTimerType> type = timerRule.GetTimerType();
+
+  rule = {};
+  rule.iClientId = timerRule.m_iClientId;
+  if (type->SupportsChannels() &&
+      !(type->SupportsAnyChannel() && timerRule.m_iClientChannelUid == PVR_CHANNEL_INVALID_UID))
+  {
+    if (timerRule.m_iClientChannelUid == PVR_CHANNEL_INVALID_UID)
+      return false; // no channel matches
+
+    rule.iClientChannelUid = timerRule.m_iClientChannelUid;
+  }
+
+  if (type->RequiresEpgSeriesLinkOnCreate())
+  {
+    rule.bMatchSeriesLink = true;
+    rule.strSeriesLink = timerRule.SeriesLink();
+  }
+
+  // Full text rules may match any text of the tag, only title matches are indexed
+  if (!(type->SupportsEpgFulltextMatch() && timerRule.m_bFullTextEpgSearch) &&
+      type->SupportsEpgTitleMatch())
+    rule.strTitleSearch = timerRule.m_strEpgSearchString;
+
+  if (type->SupportsWeekdays())
+    rule.iWeekdays = timerRule.m_iWeekdays;
+
+  if (!(type->SupportsStartAnyTime() && timerRule.m_bStartAnyTime) && type->SupportsStartTime())
+    rule.iStartMinute = GetMinuteOfDay(timerRule.StartAsLocalTime());
+
+  if (!(type->SupportsEndAnyTime() && timerRule.m_bEndAnyTime) && type->SupportsEndTime())
+    rule.iEndMinute = GetMinuteOfDay(timerRule.EndAsLocalTime());
+
+  return true;
+}
+
+void CPVRTimerRuleIndex::Add(const Rule& rule, size_t iRuleId)
+{
+  Entries* entries = &m_anyChannelEntries;
+  if (rule.iClientChannelUid != PVR_CHANNEL_INVALID_UID)
+    entries = &m_channelEntries[{rule.iClientId, rule.iClientChannelUid}];
+  else
+    m_bHasAnyChannelEntries = true;
+
+  const Entry entry{iRuleId, rule.iWeekdays, rule.iStartMinute, rule.iEndMinute};
+  ++m_iSize;
+
+  if (rule.bMatchSeriesLink)
+  {
+    entries->bySeriesLink[rule.strSeriesLink].emplace_back(entry);
+    return;
+  }
+
+  // Any key of the required text will do, the middle one is the least likely to be a common word
+  const std::string text = GetRequiredText(rule.strTitleSearch);
+  std::vector<std::string> keys;
+  for (size_t i = 0; i + TEXT_KEY_LENGTH <= text.size(); ++i)
+  {
+    std::string key = text.substr(i, TEXT_KEY_LENGTH);
+    if (IsAscii(key))
+      keys.emplace_back(std::move(key));
+  }
+
+  if (keys.empty())
+    entries->others.emplace_back(entry);
+  else
+    entries->byTitleText[keys[keys.size() / 2]].emplace_back(entry);
+}
+
+void CPVRTimerRuleIndex::Clear()
+{
+  m_channelEntries.clear();
+  m_anyChannelEntries = {};
+  m_bHasAnyChannelEntries = false;
+  m_iSize = 0;
+}
+
+bool CPVRTimerRuleIndex::HasRulesForChannel(int iClientId, int iClientChannelUid) const
+{
+  return m_bHasAnyChannelEntries ||
+         m_channelEntries.find({iClientId, iClientChannelUid}) != m_channelEntries.end();
+}
+
+void CPVRTimerRuleIndex::GetCandidates(const CPVREpgInfoTag& tag,
+                                       std::vector<size_t>& ruleIds) const
+{
+  ruleIds.clear();
+
+  const auto it = m_channelEntries.find({tag.ClientID(), tag.UniqueChannelID()});
+  if (it == m_channelEntries.end() && !m_bHasAnyChannelEntries)
+    return;
+
+  const TagAttributes attributes(tag);
+  AddCandidates(m_anyChannelEntries, attributes, ruleIds);
+  if (it != m_channelEntries.end())
+    AddCandidates(it->second, attributes, ruleIds);
+
+  std::sort(ruleIds.begin(), ruleIds.end());
+}
+
+void CPVRTimerRuleIndex::AddCandidates(const Entries& entries,
+                                       const TagAttributes& tag,
+                                       std::vector<size_t>& ruleIds)
+{
+  const auto addMatching = [&tag, &ruleIds](const std::vector<Entry>& list) {
+    for (const auto& entry : list)
+    {
+      if (tag.Matches(entry))
+        ruleIds.emplace_back(entry.iRuleId);
+    }
+  };
+
+  addMatching(entries.others);
+
+  if (!entries.bySeriesLink.empty())
+  {
+    const auto it = entries.bySeriesLink.find(tag.strSeriesLink);
+    if (it != entries.bySeriesLink.end())
+      addMatching(it->second);
+  }
+
+  if (!entries.byTitleText.empty())
+  {
+    for (const auto& key : tag.titleKeys)
+    {
+      const auto it = entries.byTitleText.find(key);
+      if (it != entries.byTitleText.end())
+        addMatching(it->second);
+    }
+  }
+}
+
+std::string CPVRTimerRuleIndex::GetRequiredText(const std::string& regExp)
+{
+  // Alternatives, groups, classes and counted repetitions may make any text optional
+  if (regExp.find_first_of("|()[]{}") != std::string::npos)
+    return {};
+
+  std::string longest;
+  std::string text;
+  const auto endText = [&longest, &text]() {
+    if (text.size() > longest.size())
+      longest = text;
+    text.clear();
+  };
+
+  for (size_t i = 0; i < regExp.size(); ++i)
+  {
+    char c = regExp[i];
+    if (c == '.' || c == '^' || c == '$' || c == '?' || c == '*' || c == '+')
+    {
+      endText();
+      continue;
+    }
+
+    if (c == '\\')
+    {
+      // Escaped letters and digits are classes, anchors, references or character codes, anything
+      // else is literal
+      if (i + 1 == regExp.size())
+        break;
+
+      if (StringUtils::isasciialphanum(regExp[i + 1]))
+      {
+        // Character codes, references and quoting take more than one character
+        if (std::string("0123456789cgkopxEKNQ").find(regExp[i + 1]) != std::string::npos)
+          return {};
+
+        endText();
+        ++i;
+        continue;
+      }
+      c = regExp[++i];
+    }
+
+    const char next = i + 1 < regExp.size() ? regExp[i + 1] : '\0';
+    if (next == '?' || next == '*')
+    {
+      endText(); // the character is optional
+      continue;
+    }
+
+    text += ToLower(c);
+    if (next == '+')
+      endText();
+  }
+  endText();
+
+  return longest;
+}
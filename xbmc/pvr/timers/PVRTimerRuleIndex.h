@@ -0,0 +1,126 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "addons/kodi-dev-kit/include/kodi/c-api/addon-instance/pvr/pvr_channels.h"
+#include "addons/kodi-dev-kit/include/kodi/c-api/addon-instance/pvr/pvr_timers.h"
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace PVR
+{
+class CPVREpgInfoTag;
+class CPVRTimerInfoTag;
+
+/*!
+ * @brief Finds the epg-based timer rules that may match an epg tag, without looking at all rules.
+ *
+ * Rules are filed by channel and then by series link or by three characters of text every title
+ * matching the rule contains. For an epg tag, only the rules of its channel and of the text of its
+ * title are looked at. Weekday and time of day are compared on precomputed values. The candidates
+ * found still have to be matched by CPVRTimerRuleMatcher, the index never misses a matching rule.
+ */
+class CPVRTimerRuleIndex
+{
+public:
+  static constexpr int MINUTES_PER_DAY = 24 * 60;
+
+  //! The attributes of a timer rule used by the index
+  struct Rule
+  {
+    int iClientId = -1;
+    int iClientChannelUid = PVR_CHANNEL_INVALID_UID; //!< Invalid if any channel matches
+    bool bMatchSeriesLink = false;
+    std::string strSeriesLink;
+    std::string strTitleSearch; //!< Case insensitive regular expression for the title, if any
+    unsigned int iWeekdays = PVR_WEEKDAY_ALLDAYS;
+    int iStartMinute = 0; //!< Earliest start, in minutes after local midnight
+    int iEndMinute = MINUTES_PER_DAY; //!< Latest end, in minutes after local midnight
+  };
+
+  /*!
+   * @brief Get the attributes of an epg-based timer rule.
+   * @param timerRule The timer rule.
+   * @param rule The attributes.
+   * @return False if the rule cannot match any epg tag, true otherwise.
+   */
+  static bool GetRule(const CPVRTimerInfoTag& timerRule, Rule& rule);
+
+  /*!
+   * @brief Add a rule.
+   * @param rule The attributes of the rule.
+   * @param iRuleId The id returned for the rule by GetCandidates().
+   */
+  void Add(const Rule& rule, size_t iRuleId);
+
+  /*!
+   * @brief Remove all rules.
+   */
+  void Clear();
+
+  /*!
+   * @brief Get the number of rules.
+   * @return The number of rules.
+   */
+  size_t Size() const { return m_iSize; }
+
+  /*!
+   * @brief Check whether any rule may match epg tags of the given channel.
+   * @param iClientId The client id of the channel.
+   * @param iClientChannelUid The unique id of the channel.
+   * @return True if a rule for the channel or for any channel exists, false otherwise.
+   */
+  bool HasRulesForChannel(int iClientId, int iClientChannelUid) const;
+
+  /*!
+   * @brief Get the rules that may match the given epg tag.
+   * @param tag The epg tag.
+   * @param ruleIds Filled with the ids of the rules, in ascending order.
+   */
+  void GetCandidates(const CPVREpgInfoTag& tag, std::vector<size_t>& ruleIds) const;
+
+  /*!
+   * @brief Get the longest text every string matching the given regular expression contains.
+   * @param regExp The regular expression.
+   * @return The text, lower case, or an empty string if the expression does not require any.
+   */
+  static std::string GetRequiredText(const std::string& regExp);
+
+private:
+  struct Entry
+  {
+    size_t iRuleId;
+    unsigned int iWeekdays;
+    int iStartMinute;
+    int iEndMinute;
+  };
+
+  struct Entries
+  {
+    std::unordered_map<std::string, std::vector<Entry>> bySeriesLink;
+    std::unordered_map<std::string, std::vector<Entry>> byTitleText;
+    std::vector<Entry> others;
+  };
+
+  struct TagAttributes;
+
+  static void AddCandidates(const Entries& entries,
+                            const TagAttributes& tag,
+                            std::vector<size_t>& ruleIds);
+
+  std::map<std::pair<int, int>, Entries> m_channelEntries;
+  Entries m_anyChannelEntries;
+  bool m_bHasAnyChannelEntries = false;
+  size_t m_iSize = 0;
+};
+} // namespace PVR
@@ -16,9 +16,11 @@
 #include "pvr/addons/PVRClients.h"
 #include "pvr/channels/PVRChannel.h"
 #include "pvr/epg/Epg.h"
+#include "pvr/epg/EpgChannelData.h"
 #include "pvr/epg/EpgContainer.h"
 #include "pvr/epg/EpgInfoTag.h"
 #include "pvr/timers/PVRTimerInfoTag.h"
+#include "pvr/timers/PVRTimerRuleIndex.h"
 #include "pvr/timers/PVRTimerRuleMatcher.h"
 #include "settings/Settings.h"
 #include "threads/SingleLock.h"
@@ -118,6 +120,8 @@ void CPVRTimers::Unload()
   // remove all tags
   CSingleLock lock(m_critSection);
   m_tags.clear();
+  m_bTimersByChannelValid = false;
+  m_reminderRulesEpgChanges.clear();
 }
 
 void CPVRTimers::Start()
@@ -195,6 +199,8 @@ bool CPVRTimers::IsRecording() const
 void CPVRTimers::RemoveEntry(const std::shared_ptr<CPVRTimerInfoTag>& tag)
 {
   CSingleLock lock(m_critSection);
+  m_bTimersByChannelValid = false;
+  InvalidateReminderRulesMatch(*tag);
 
   auto it = m_tags.find(tag->m_bStartAnyTime ? CDateTime() : tag->StartAsUTC());
   if (it != m_tags.end())
@@ -237,6 +243,7 @@ bool CPVRTimers::UpdateEntries(const CPVRTimersContainer& timers, const std::vec
   std::vector< std::pair< int, std::string> > timerNotifications;
 
   CSingleLock lock(m_critSection);
+  m_bTimersByChannelValid = false;
 
   /* go through the timer list and check for updated or new timers */
   for (MapTags::const_iterator it = timers.GetTags().begin(); it != timers.GetTags().end(); ++it)
@@ -316,6 +323,7 @@ bool CPVRTimers::UpdateEntries(const CPVRTimersContainer& timers, const std::vec
 
         CheckAndAppendTimerNotification(timerNotifications, timer, true);
 
+        InvalidateReminderRulesMatch(*timer);
         it2 = it->second.erase(it2);
 
         bChanged = true;
@@ -445,53 +453,6 @@ namespace
 
     return matches;
   }
-
-  void AddTimerRuleToEpgMap(const std::shared_ptr<CPVRTimerInfoTag>& timer,
-                            const CDateTime& now,
-                            std::map<std::shared_ptr<CPVREpg>, std::vector<std::shared_ptr<CPVRTimerRuleMatcher>>>& epgMap,
-                            bool& bFetchedAllEpgs)
-  {
-    const std::shared_ptr<CPVRChannel> channel = timer->Channel();
-    if (channel)
-    {
-      const std::shared_ptr<CPVREpg> epg = channel->GetEPG();
-      if (epg)
-      {
-        const std::shared_ptr<CPVRTimerRuleMatcher> matcher = std::make_shared<CPVRTimerRuleMatcher>(timer, now);
-        auto it = epgMap.find(epg);
-        if (it == epgMap.end())
-          epgMap.insert({epg, {matcher}});
-        else
-          it->second.emplace_back(matcher);
-      }
-    }
-    else
-    {
-      // rule matches "any channel" => we need to check all channels
-      if (!bFetchedAllEpgs)
-      {
-        const std::vector<std::shared_ptr<CPVREpg>> epgs = CServiceBroker::GetPVRManager().EpgContainer().GetAllEpgs();
-        for (const auto& epg : epgs)
-        {
-          const std::shared_ptr<CPVRTimerRuleMatcher> matcher = std::make_shared<CPVRTimerRuleMatcher>(timer, now);
-          auto it = epgMap.find(epg);
-          if (it == epgMap.end())
-            epgMap.insert({epg, {matcher}});
-          else
-            it->second.emplace_back(matcher);
-        }
-        bFetchedAllEpgs = true;
-      }
-      else
-      {
-        for (auto& epgMapEntry : epgMap)
-        {
-          const std::shared_ptr<CPVRTimerRuleMatcher> matcher = std::make_shared<CPVRTimerRuleMatcher>(timer, now);
-          epgMapEntry.second.emplace_back(matcher);
-        }
-      }
-    }
-  }
 } // unnamed namespace
 
 bool CPVRTimers::UpdateEntries(int iMaxNotificationDelay)
@@ -500,8 +461,8 @@ bool CPVRTimers::UpdateEntries(int iMaxNotificationDelay)
   std::vector<std::pair<std::shared_ptr<CPVRTimerInfoTag>, std::shared_ptr<CPVRTimerInfoTag>>> childTimersToInsert;
   bool bChanged = false;
   const CDateTime now = CDateTime::GetUTCDateTime();
-  bool bFetchedAllEpgs = false;
-  std::map<std::shared_ptr<CPVREpg>, std::vector<std::shared_ptr<CPVRTimerRuleMatcher>>> epgMap;
+  std::vector<std::shared_ptr<CPVRTimerRuleMatcher>> reminderRules;
+  CPVRTimerRuleIndex reminderRulesIndex;
 
   CSingleLock lock(m_critSection);
 
@@ -578,8 +539,12 @@ bool CPVRTimers::UpdateEntries(int iMaxNotificationDelay)
         {
           if (timer->IsEpgBased())
           {
-            if (m_bReminderRulesUpdatePending)
-              AddTimerRuleToEpgMap(timer, now, epgMap, bFetchedAllEpgs);
+            CPVRTimerRuleIndex::Rule rule;
+            if (m_bReminderRulesUpdatePending && CPVRTimerRuleIndex::GetRule(*timer, rule))
+            {
+              reminderRulesIndex.Add(rule, reminderRules.size());
+              reminderRules.emplace_back(std::make_shared<CPVRTimerRuleMatcher>(timer, now));
+            }
           }
           else
           {
@@ -620,6 +585,7 @@ bool CPVRTimers::UpdateEntries(int iMaxNotificationDelay)
         if (parent)
           parent->UpdateChildState(timer, false);
 
+        InvalidateReminderRulesMatch(*timer);
         it2 = it->second.erase(it2);
       }
       else
@@ -634,28 +600,55 @@ bool CPVRTimers::UpdateEntries(int iMaxNotificationDelay)
       ++it;
   }
 
-  // create new children of local epg-based reminder timer rules
-  for (const auto& epgMapEntry : epgMap)
+  if (bChanged)
+    m_bTimersByChannelValid = false;
+
+  // create new children of local epg-based reminder timer rules. Rules added later match the whole
+  // epg on their own (see AddLocalTimer), so only epgs changed since the last time are matched.
+  if (!reminderRules.empty())
   {
-    const auto epgTags = epgMapEntry.first->GetTags();
-    for (const auto& epgTag : epgTags)
+    const std::vector<std::shared_ptr<CPVREpg>> epgs =
+        CServiceBroker::GetPVRManager().EpgContainer().GetAllEpgs();
+    std::map<std::pair<int, int>, unsigned int> epgChanges;
+    std::vector<size_t> candidates;
+    for (const auto& epg : epgs)
     {
-      if (GetTimerForEpgTag(epgTag))
+      const std::shared_ptr<CPVREpgChannelData> channelData = epg->GetChannelData();
+      const std::pair<int, int> channel{channelData->ClientId(),
+                                        channelData->UniqueClientChannelId()};
+      const unsigned int iChanges = epg->GetTagsChangeCount();
+      epgChanges.insert({channel, iChanges});
+
+      const auto it = m_reminderRulesEpgChanges.find(channel);
+      if (it != m_reminderRulesEpgChanges.end() && it->second == iChanges)
+        continue;
+
+      if (!reminderRulesIndex.HasRulesForChannel(channel.first, channel.second))
         continue;
 
-      for (const auto& matcher : epgMapEntry.second)
+      const auto epgTags = epg->GetTags();
+      for (const auto& epgTag : epgTags)
       {
-        if (!matcher->Matches(epgTag))
+        reminderRulesIndex.GetCandidates(*epgTag, candidates);
+        if (candidates.empty() || GetTimerForEpgTag(epgTag))
           continue;
 
-        const std::shared_ptr<CPVRTimerInfoTag> childTimer = CPVRTimerInfoTag::CreateReminderFromEpg(epgTag, matcher->GetTimerRule());
-        if (childTimer)
+        for (size_t candidate : candidates)
         {
-          bChanged = true;
-          childTimersToInsert.emplace_back(std::make_pair(matcher->GetTimerRule(), childTimer)); // remember and insert/save later
+          const std::shared_ptr<CPVRTimerRuleMatcher>& matcher = reminderRules[candidate];
+          if (!matcher->Matches(epgTag))
+            continue;
+
+          const std::shared_ptr<CPVRTimerInfoTag> childTimer = CPVRTimerInfoTag::CreateReminderFromEpg(epgTag, matcher->GetTimerRule());
+          if (childTimer)
+          {
+            bChanged = true;
+            childTimersToInsert.emplace_back(std::make_pair(matcher->GetTimerRule(), childTimer)); // remember and insert/save later
+          }
         }
       }
     }
+    m_reminderRulesEpgChanges.swap(epgChanges);
   }
 
   // reinsert timers with changed timer start
@@ -912,6 +905,7 @@ std::shared_ptr<CPVRTimerInfoTag> CPVRTimers::UpdateEntry(const std::shared_ptr<
   bool bChanged = false;
 
   CSingleLock lock(m_critSection);
+  m_bTimersByChannelValid = false;
   std::shared_ptr<CPVRTimerInfoTag> tag = GetByClient(timer->m_iClientId, timer->m_iClientIndex);
   if (tag)
   {
@@ -1072,6 +1066,7 @@ bool CPVRTimers::DeleteLocalTimer(const std::shared_ptr<CPVRTimerInfoTag>& tag,
         if (timer->m_iParentClientIndex == tag->m_iClientIndex)
         {
           tag->UpdateChildState(timer, false);
+          InvalidateReminderRulesMatch(*timer);
           it2 = it->second.erase(it2);
           timer->DeleteFromDatabase();
         }
@@ -1164,37 +1159,84 @@ std::shared_ptr<CPVRTimerInfoTag> CPVRTimers::GetTimerForEpgTag(const std::share
 {
   if (epgTag)
   {
-    CSingleLock lock(m_critSection);
+    const auto matches = [&epgTag](const std::shared_ptr<CPVRTimerInfoTag>& timersEntry) {
+      if (timersEntry->GetEpgInfoTag(false) == epgTag)
+        return true;
 
-    for (const auto& tagsEntry : m_tags)
-    {
-      for (const auto& timersEntry : tagsEntry.second)
+      if (timersEntry->m_iClientChannelUid != PVR_CHANNEL_INVALID_UID &&
+          timersEntry->m_iClientChannelUid == epgTag->UniqueChannelID())
       {
-        if (timersEntry->IsTimerRule())
-          continue;
+        if (timersEntry->UniqueBroadcastID() != EPG_TAG_INVALID_UID &&
+            timersEntry->UniqueBroadcastID() == epgTag->UniqueBroadcastID())
+          return true;
+
+        if (timersEntry->m_bIsRadio == epgTag->IsRadio() &&
+            timersEntry->StartAsUTC() <= epgTag->StartAsUTC() &&
+            timersEntry->EndAsUTC() >= epgTag->EndAsUTC())
+          return true;
+      }
+      return false;
+    };
 
-        if (timersEntry->GetEpgInfoTag(false) == epgTag)
-          return timersEntry;
+    CSingleLock lock(m_critSection);
 
-        if (timersEntry->m_iClientChannelUid != PVR_CHANNEL_INVALID_UID &&
-            timersEntry->m_iClientChannelUid == epgTag->UniqueChannelID())
-        {
-          if (timersEntry->UniqueBroadcastID() != EPG_TAG_INVALID_UID &&
-              timersEntry->UniqueBroadcastID() == epgTag->UniqueBroadcastID())
-            return timersEntry;
+    if (!m_bTimersByChannelValid)
+      UpdateTimersByChannel();
 
-          if (timersEntry->m_bIsRadio == epgTag->IsRadio() &&
-              timersEntry->StartAsUTC() <= epgTag->StartAsUTC() &&
-              timersEntry->EndAsUTC() >= epgTag->EndAsUTC())
-            return timersEntry;
+    const auto findFirst = [this, &matches](int iChannelUid) -> const PositionedTimer* {
+      const auto it = m_timersByChannel.find(iChannelUid);
+      if (it != m_timersByChannel.end())
+      {
+        for (const auto& entry : it->second)
+        {
+          if (matches(entry.second))
+            return &entry;
         }
       }
+      return nullptr;
+    };
+
+    // Only timers of the tag's channel and timers without channel can match. Like a search of all
+    // timers, return the first match in start time order.
+    const PositionedTimer* first = findFirst(PVR_CHANNEL_INVALID_UID);
+    if (epgTag->UniqueChannelID() != PVR_CHANNEL_INVALID_UID)
+    {
+      const PositionedTimer* onChannel = findFirst(epgTag->UniqueChannelID());
+      if (onChannel && (!first || onChannel->first < first->first))
+        first = onChannel;
     }
+
+    if (first)
+      return first->second;
   }
 
   return std::shared_ptr<CPVRTimerInfoTag>();
 }
 
+void CPVRTimers::InvalidateReminderRulesMatch(const CPVRTimerInfoTag& timer)
+{
+  m_reminderRulesEpgChanges.erase({timer.m_iClientId, timer.m_iClientChannelUid});
+}
+
+void CPVRTimers::UpdateTimersByChannel() const
+{
+  m_timersByChannel.clear();
+
+  size_t iPosition = 0;
+  for (const auto& tagsEntry : m_tags)
+  {
+    for (const auto& timersEntry : tagsEntry.second)
+    {
+      if (!timersEntry->IsTimerRule())
+        m_timersByChannel[timersEntry->m_iClientChannelUid].emplace_back(iPosition, timersEntry);
+
+      ++iPosition;
+    }
+  }
+
+  m_bTimersByChannelValid = true;
+}
+
 std::shared_ptr<CPVRTimerInfoTag> CPVRTimers::GetTimerRule(const std::shared_ptr<CPVRTimerInfoTag>& timer) const
 {
   if (timer)
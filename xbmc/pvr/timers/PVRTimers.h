@@ -15,6 +15,7 @@
 #include <map>
 #include <memory>
 #include <queue>
+#include <utility>
 #include <vector>
 
 namespace PVR
@@ -295,6 +296,18 @@ namespace PVR
     std::vector<std::shared_ptr<CPVRTimerInfoTag>> GetActiveRecordings(const TimerKind& eKind) const;
     int AmountActiveRecordings(const TimerKind& eKind) const;
 
+    /*!
+     * @brief Match the epg of a timer's channel against the reminder rules again with the next
+     * update. Called when the timer is deleted, as it may have hidden an epg tag from the rules.
+     * @param timer The deleted timer.
+     */
+    void InvalidateReminderRulesMatch(const CPVRTimerInfoTag& timer);
+
+    /*!
+     * @brief Rebuild the lookup of timers by channel used by GetTimerForEpgTag.
+     */
+    void UpdateTimersByChannel() const;
+
     bool CheckAndAppendTimerNotification(
         std::vector<std::pair<int, std::string>>& timerNotifications,
         const std::shared_ptr<CPVRTimerInfoTag>& tag,
@@ -304,6 +317,14 @@ namespace PVR
     CPVRSettings m_settings;
     std::queue<std::shared_ptr<CPVRTimerInfoTag>> m_remindersToAnnounce;
     bool m_bReminderRulesUpdatePending = false;
+    // Tags change count of the epg of each channel (client id, channel uid) when it was last
+    // matched against the reminder rules
+    std::map<std::pair<int, int>, unsigned int> m_reminderRulesEpgChanges;
+
+    // Timers that are not timer rules by channel uid, with their position in start time order
+    using PositionedTimer = std::pair<size_t, std::shared_ptr<CPVRTimerInfoTag>>;
+    mutable std::map<int, std::vector<PositionedTimer>> m_timersByChannel;
+    mutable bool m_bTimersByChannelValid = false;
 
     bool m_bFirstUpdate = true;
     std::vector<int> m_failedClients;
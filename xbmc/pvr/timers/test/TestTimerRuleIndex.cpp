@@ -0,0 +1,313 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "XBDateTime.h"
+#include "pvr/epg/EpgInfoTag.h"
+#include "pvr/timers/PVRTimerInfoTag.h"
+#include "pvr/test/PVRTestUtils.h"
+#include "pvr/timers/PVRTimerRuleIndex.h"
+#include "utils/RegExp.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PVR;
+using namespace PVRTestUtils;
+
+namespace
+{
+constexpr int CLIENT_ID = 1;
+constexpr int EPG_ID = 3;
+
+const std::vector<std::string> WORDS = {
+    "News",    "Weather", "Star",   "Trek",    "Doctor",  "Who",     "Football", "Tennis",
+    "Cooking", "Garden",  "Crime",  "Scene",   "Family",  "Quiz",    "Night",    "Morning",
+    "Show",    "Live",    "World",  "Nature",  "Ocean",   "Planet",  "History",  "Science",
+    "Music",   "Concert", "Comedy", "Drama",   "Movie",   "Classic", "Kids",     "Cartoon",
+    "Sports",  "Racing",  "Travel", "Journey", "Talk",    "Report",  "Special",  "Finale"};
+
+//! A rule and the compiled expression of its title, like CPVRTimerRuleMatcher keeps it
+struct TestRule
+{
+  CPVRTimerRuleIndex::Rule rule;
+  std::unique_ptr<CRegExp> titleSearch;
+};
+
+class TestTimerRuleIndex : public ::testing::Test
+{
+protected:
+  std::shared_ptr<CPVREpgInfoTag> CreateTag(int iChannelUid,
+                                            time_t start,
+                                            const std::string& title,
+                                            const std::string& seriesLink = "")
+  {
+    EpgTagData data;
+    data.iClientId = CLIENT_ID;
+    data.iChannelUid = iChannelUid;
+    data.iEpgId = EPG_ID;
+    data.start = start;
+    data.title = title;
+    data.seriesLink = seriesLink;
+    return m_tagFactory.Create(data);
+  }
+
+  // Channels with events following each other, titles made of two words
+  void CreateGuide(int iChannels, size_t events)
+  {
+    for (int channel = 1; channel <= iChannels; ++channel)
+    {
+      for (size_t i = 0; i < events; ++i)
+      {
+        const std::string& first = WORDS[m_random() % WORDS.size()];
+        const std::string& second = WORDS[m_random() % WORDS.size()];
+        const std::string seriesLink =
+            m_random() % 4 == 0 ? "series-" + std::to_string(m_random() % 50) : "";
+        m_tags.emplace_back(
+            CreateTag(channel, FIRST_START + i * DURATION, first + " " + second, seriesLink));
+      }
+    }
+  }
+
+  // Rules for a channel or any channel, with all kinds of attributes and expressions
+  void CreateRules(int iChannels, size_t rules)
+  {
+    for (size_t i = 0; i < rules; ++i)
+    {
+      CPVRTimerRuleIndex::Rule rule;
+      rule.iClientId = CLIENT_ID;
+      if (m_random() % 3 != 0)
+        rule.iClientChannelUid = 1 + m_random() % iChannels;
+
+      const std::string& word = WORDS[m_random() % WORDS.size()];
+      const std::string& other = WORDS[m_random() % WORDS.size()];
+      switch (m_random() % 10)
+      {
+        case 0:
+          rule.bMatchSeriesLink = true;
+          rule.strSeriesLink = "series-" + std::to_string(m_random() % 50);
+          break;
+        case 1:
+          break; // any title
+        case 2:
+          rule.strTitleSearch = "^" + word + " " + other + "$";
+          break;
+        case 3:
+          rule.strTitleSearch = word + ".*" + other;
+          break;
+        case 4:
+          rule.strTitleSearch = "(" + word + "|" + other + ")";
+          break;
+        case 5:
+          rule.strTitleSearch = word.substr(0, 2) + "?" + word.substr(2);
+          break;
+        default:
+          rule.strTitleSearch = m_random() % 2 ? word : StringToUpper(word);
+          break;
+      }
+
+      if (m_random() % 2)
+        rule.iWeekdays = 1 + m_random() % PVR_WEEKDAY_ALLDAYS;
+      if (m_random() % 2)
+        rule.iStartMinute = m_random() % CPVRTimerRuleIndex::MINUTES_PER_DAY;
+      if (m_random() % 2)
+        rule.iEndMinute = m_random() % CPVRTimerRuleIndex::MINUTES_PER_DAY;
+
+      TestRule testRule;
+      testRule.rule = rule;
+      if (!rule.strTitleSearch.empty())
+      {
+        testRule.titleSearch.reset(new CRegExp(true /* case insensitive */));
+        testRule.titleSearch->RegComp(rule.strTitleSearch);
+      }
+      m_rules.emplace_back(std::move(testRule));
+    }
+  }
+
+  // The decision of CPVRTimerRuleMatcher for the attributes known to the index
+  static bool Matches(const TestRule& testRule, const CPVREpgInfoTag& tag)
+  {
+    const CPVRTimerRuleIndex::Rule& rule = testRule.rule;
+    if (rule.iClientChannelUid != PVR_CHANNEL_INVALID_UID &&
+        (tag.ClientID() != rule.iClientId || tag.UniqueChannelID() != rule.iClientChannelUid))
+      return false;
+
+    if (rule.bMatchSeriesLink && tag.SeriesLink() != rule.strSeriesLink)
+      return false;
+
+    const CDateTime start = CPVRTimerInfoTag::ConvertUTCToLocalTime(tag.StartAsUTC());
+    const CDateTime end = CPVRTimerInfoTag::ConvertUTCToLocalTime(tag.EndAsUTC());
+    int weekday = start.GetDayOfWeek();
+    if (weekday == 0)
+      weekday = 7;
+
+    return (rule.iWeekdays & (1 << (weekday - 1))) &&
+           start.GetHour() * 60 + start.GetMinute() >= rule.iStartMinute &&
+           end.GetHour() * 60 + end.GetMinute() <= rule.iEndMinute &&
+           (!testRule.titleSearch || testRule.titleSearch->RegFind(tag.Title()) >= 0);
+  }
+
+  static std::string StringToUpper(std::string text)
+  {
+    std::transform(text.begin(), text.end(), text.begin(), ::toupper);
+    return text;
+  }
+
+  CPVRTimerRuleIndex CreateIndex() const
+  {
+    CPVRTimerRuleIndex index;
+    for (size_t i = 0; i < m_rules.size(); ++i)
+      index.Add(m_rules[i].rule, i);
+    return index;
+  }
+
+  std::mt19937 m_random{42};
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> m_tags;
+  std::vector<TestRule> m_rules;
+  CEpgTagFactory m_tagFactory;
+};
+} // namespace
+
+TEST_F(TestTimerRuleIndex, RequiredText)
+{
+  EXPECT_EQ(CPVRTimerRuleIndex::GetRequiredText("Star Trek"), "star trek");
+  EXPECT_EQ(CPVRTimerRuleIndex::GetRequiredText("^News$"), "news");
+  EXPECT_EQ(CPVRTimerRuleIndex::GetRequiredText("Doctor.*Who"), "doctor");
+  EXPECT_EQ(CPVRTimerRuleIndex::GetRequiredText("Colou?r Television"), "r television");
+  EXPECT_EQ(CPVRTimerRuleIndex::GetRequiredText("Kids*"), "kid");
+  EXPECT_EQ(CPVRTimerRuleIndex::GetRequiredText("Hello+ World"), " world");
+  EXPECT_EQ(CPVRTimerRuleIndex::GetRequiredText("Dr\\. No"), "dr. no");
+  EXPECT_EQ(CPVRTimerRuleIndex::GetRequiredText("\\bNews\\b"), "news");
+  EXPECT_EQ(CPVRTimerRuleIndex::GetRequiredText(""), "");
+
+  // Anything that may make a piece of text optional or is not plain text
+  EXPECT_EQ(CPVRTimerRuleIndex::GetRequiredText("Star|Trek"), "");
+  EXPECT_EQ(CPVRTimerRuleIndex::GetRequiredText("(Star )?Trek"), "");
+  EXPECT_EQ(CPVRTimerRuleIndex::GetRequiredText("[Nn]ews"), "");
+  EXPECT_EQ(CPVRTimerRuleIndex::GetRequiredText("News{0}"), "");
+  EXPECT_EQ(CPVRTimerRuleIndex::GetRequiredText("\\x4eews"), "");
+  EXPECT_EQ(CPVRTimerRuleIndex::GetRequiredText("\\QStar\\E"), "");
+}
+
+TEST_F(TestTimerRuleIndex, CandidatesContainAllMatches)
+{
+  constexpr int CHANNELS = 10;
+  CreateGuide(CHANNELS, 200);
+  CreateRules(CHANNELS, 300);
+  const CPVRTimerRuleIndex index = CreateIndex();
+  ASSERT_EQ(index.Size(), m_rules.size());
+
+  size_t iMatches = 0;
+  size_t iCandidates = 0;
+  std::vector<size_t> candidates;
+  for (const auto& tag : m_tags)
+  {
+    index.GetCandidates(*tag, candidates);
+    ASSERT_TRUE(std::is_sorted(candidates.begin(), candidates.end()));
+    iCandidates += candidates.size();
+
+    for (size_t i = 0; i < m_rules.size(); ++i)
+    {
+      if (Matches(m_rules[i], *tag))
+      {
+        ++iMatches;
+        EXPECT_TRUE(std::binary_search(candidates.begin(), candidates.end(), i))
+            << "rule " << i << " '" << m_rules[i].rule.strTitleSearch << "' missed for '"
+            << tag->Title() << "'";
+      }
+    }
+  }
+
+  EXPECT_GT(iMatches, 0u);
+  EXPECT_LT(iCandidates, m_tags.size() * m_rules.size() / 10);
+
+  for (int channel = 1; channel <= CHANNELS; ++channel)
+    EXPECT_TRUE(index.HasRulesForChannel(CLIENT_ID, channel));
+}
+
+TEST_F(TestTimerRuleIndex, Channels)
+{
+  CPVRTimerRuleIndex index;
+  EXPECT_FALSE(index.HasRulesForChannel(CLIENT_ID, 1));
+
+  CPVRTimerRuleIndex::Rule rule;
+  rule.iClientId = CLIENT_ID;
+  rule.iClientChannelUid = 1;
+  rule.strTitleSearch = "News";
+  index.Add(rule, 0);
+  EXPECT_TRUE(index.HasRulesForChannel(CLIENT_ID, 1));
+  EXPECT_FALSE(index.HasRulesForChannel(CLIENT_ID, 2));
+  EXPECT_FALSE(index.HasRulesForChannel(CLIENT_ID + 1, 1));
+
+  std::vector<size_t> candidates;
+  index.GetCandidates(*CreateTag(1, FIRST_START, "Evening news"), candidates);
+  EXPECT_EQ(candidates, std::vector<size_t>{0});
+  index.GetCandidates(*CreateTag(2, FIRST_START, "Evening news"), candidates);
+  EXPECT_TRUE(candidates.empty());
+
+  rule.iClientChannelUid = PVR_CHANNEL_INVALID_UID;
+  index.Add(rule, 1);
+  EXPECT_TRUE(index.HasRulesForChannel(CLIENT_ID, 2));
+  index.GetCandidates(*CreateTag(1, FIRST_START, "Evening news"), candidates);
+  EXPECT_EQ(candidates, (std::vector<size_t>{0, 1}));
+
+  index.Clear();
+  EXPECT_EQ(index.Size(), 0u);
+  EXPECT_FALSE(index.HasRulesForChannel(CLIENT_ID, 1));
+}
+
+TEST_F(TestTimerRuleIndex, DISABLED_Benchmark)
+{
+  // 500 rules against a guide of 20 channels with 500 events each
+  CreateGuide(20, 500);
+  CreateRules(20, 500);
+  const CPVRTimerRuleIndex index = CreateIndex();
+
+  auto start = std::chrono::steady_clock::now();
+  size_t iAllRulesMatches = 0;
+  for (const auto& tag : m_tags)
+  {
+    for (const auto& rule : m_rules)
+    {
+      if (Matches(rule, *tag))
+        ++iAllRulesMatches;
+    }
+  }
+  const double allRules =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  size_t iIndexMatches = 0;
+  std::vector<size_t> candidates;
+  for (const auto& tag : m_tags)
+  {
+    index.GetCandidates(*tag, candidates);
+    for (size_t candidate : candidates)
+    {
+      if (Matches(m_rules[candidate], *tag))
+        ++iIndexMatches;
+    }
+  }
+  const double indexed =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << "Matching " << m_rules.size() << " rules against " << m_tags.size()
+            << " events: " << allRules * 1000 << " ms for all rules, " << indexed * 1000
+            << " ms with the index" << std::endl;
+  RecordProperty("all_rules_ms", static_cast<int>(allRules * 1000));
+  RecordProperty("index_ms", static_cast<int>(indexed * 1000));
+
+  EXPECT_EQ(iIndexMatches, iAllRulesMatches);
+  EXPECT_LT(indexed * 2, allRules);
+}
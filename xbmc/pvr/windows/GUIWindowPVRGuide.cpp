@@ -39,8 +39,10 @@
 #include "settings/Settings.h"
 #include "settings/SettingsComponent.h"
 #include "threads/SingleLock.h"
+#include "utils/log.h"
 #include "view/GUIViewState.h"
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <utility>
@@ -55,6 +57,7 @@ CGUIWindowPVRGuideBase::CGUIWindowPVRGuideBase(bool bRadio, int id, const std::s
 {
   m_bRefreshTimelineItems = false;
   m_bSyncRefreshTimelineItems = false;
+  m_bRefreshEpgTags = false;
   CServiceBroker::GetPVRManager().EpgContainer().Events().Subscribe(static_cast<CGUIWindowPVRBase*>(this), &CGUIWindowPVRBase::Notify);
 }
 
@@ -64,6 +67,7 @@ CGUIWindowPVRGuideBase::~CGUIWindowPVRGuideBase()
 
   m_bRefreshTimelineItems = false;
   m_bSyncRefreshTimelineItems = false;
+  m_bRefreshEpgTags = false;
   StopRefreshTimelineItemsThread();
 }
 
@@ -113,6 +117,8 @@ void CGUIWindowPVRGuideBase::ClearData()
 
 void CGUIWindowPVRGuideBase::OnInitWindow()
 {
+  const auto start = std::chrono::steady_clock::now();
+
   if (m_guiState)
     m_viewControl.SetCurrentView(m_guiState->GetViewAsControl(), false);
 
@@ -120,6 +126,11 @@ void CGUIWindowPVRGuideBase::OnInitWindow()
     InitEpgGridControl();
 
   CGUIWindowPVRBase::OnInitWindow();
+
+  CLog::LogFC(LOGDEBUG, LOGPVR, "Opened guide window in {} ms",
+              std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count());
 }
 
 void CGUIWindowPVRGuideBase::OnDeinitWindow(int nextWindowID)
@@ -152,10 +163,13 @@ void CGUIWindowPVRGuideBase::StopRefreshTimelineItemsThread()
 
 void CGUIWindowPVRGuideBase::NotifyEvent(const PVREvent& event)
 {
-  if (event == PVREvent::Epg ||
-      event == PVREvent::EpgContainer ||
-      event == PVREvent::ChannelGroupInvalidated ||
-      event == PVREvent::ChannelGroup)
+  if (event == PVREvent::Epg || event == PVREvent::EpgContainer)
+  {
+    m_bRefreshEpgTags = true;
+    // no base class call => do async refresh
+    return;
+  }
+  else if (event == PVREvent::ChannelGroupInvalidated || event == PVREvent::ChannelGroup)
   {
     m_bRefreshTimelineItems = true;
     // no base class call => do async refresh
@@ -669,10 +683,12 @@ bool CGUIWindowPVRGuideBase::OnContextButtonNavigate(CONTEXT_BUTTON button)
 
 bool CGUIWindowPVRGuideBase::RefreshTimelineItems()
 {
-  if (m_bRefreshTimelineItems || m_bSyncRefreshTimelineItems)
+  if (m_bRefreshTimelineItems || m_bSyncRefreshTimelineItems || m_bRefreshEpgTags)
   {
+    const bool bOnlyEpgTags = !m_bRefreshTimelineItems && !m_bSyncRefreshTimelineItems;
     m_bRefreshTimelineItems = false;
     m_bSyncRefreshTimelineItems = false;
+    m_bRefreshEpgTags = false;
 
     CGUIEPGGridContainer* epgGridContainer = GetGridControl();
     if (epgGridContainer)
@@ -705,6 +721,12 @@ bool CGUIWindowPVRGuideBase::RefreshTimelineItems()
       if (endDate > maxFutureDate)
         endDate = maxFutureDate;
 
+      // Channels and time range did not change, let the grid patch its EPG data
+      if (bOnlyEpgTags && epgGridContainer->RefreshEpgTags(startDate, endDate))
+        return false;
+
+      const auto start = std::chrono::steady_clock::now();
+
       std::unique_ptr<CFileItemList> channels(new CFileItemList);
       const std::vector<std::shared_ptr<CPVRChannelGroupMember>> groupMembers =
           group->GetMembers(CPVRChannelGroup::Include::ONLY_VISIBLE);
@@ -719,6 +741,12 @@ bool CGUIWindowPVRGuideBase::RefreshTimelineItems()
 
       epgGridContainer->SetTimelineItems(channels, startDate, endDate);
 
+      CLog::LogFC(LOGDEBUG, LOGPVR, "Created guide timeline of {} channels in {} ms",
+                  channels->Size(),
+                  std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count());
+
       {
         CSingleLock lock(m_critSection);
         m_cachedChannelGroup = group;
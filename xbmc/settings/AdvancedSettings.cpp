@@ -121,6 +121,12 @@ void CAdvancedSettings::Initialize()
   m_limiterHold = 0.025f;
   m_limiterRelease = 0.1f;
 
+  m_audioResampler = "ffmpeg";
+
+  m_audioPrefetch = true;
+  m_audioPrefetchMemorySize = 64;
+  m_audioPrefetchLookahead = 2;
+
   m_seekSteps = { 10, 30, 60, 180, 300, 600, 1800 };
 
   m_audioDefaultPlayer = "paplayer";
@@ -325,6 +331,10 @@ void CAdvancedSettings::Initialize()
   m_bEpgDisplayUpdatePopup = true; /* Display a progress popup while updating EPG data from clients */
   m_bEpgDisplayIncrementalUpdatePopup = false; /* Display a progress popup while doing incremental EPG updates, but
                                                   only if 'displayupdatepopup' is also enabled. */
+  m_iEpgMaxConcurrentUpdates = 4; /* Fetch the EPG data of at most X channels at the same time */
+  m_iEpgMaxConcurrentUpdatesPerClient = 1; /* Fetch the EPG data of at most X channels of the same
+                                              client at the same time. Not every backend copes
+                                              with concurrent requests, so this is opt-in. */
 
   m_bEdlMergeShortCommBreaks = false;      // Off by default
   m_iEdlMaxCommBreakLength = 8 * 30 + 10;  // Just over 8 * 30 second commercial break.
@@ -377,6 +387,14 @@ void CAdvancedSettings::Initialize()
   m_iPVRNumericChannelSwitchTimeout = 2000;
   m_iPVRTimeshiftThreshold = 10;
   m_bPVRTimeshiftSimpleOSD = true;
+  m_bPVRWarmStart = true;
+  m_bPVRPrebufferChannels = false;
+  m_iPVRPrebufferMaxStreams = 1;
+  m_iPVRPrebufferMaxKBps = 4096;
+  m_iPVRPrebufferSizeKB = 4096;
+  m_bPVRLocalTimeshift = false;
+  m_strPVRLocalTimeshiftPath = "special://temp/";
+  m_iPVRLocalTimeshiftSizeMB = 1024;
   m_PVRDefaultSortOrder.sortBy = SortByDate;
   m_PVRDefaultSortOrder.sortOrder = SortOrderDescending;
 
@@ -568,6 +586,24 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
 
     XMLUtils::GetFloat(pElement, "limiterhold", m_limiterHold, 0.0f, 100.0f);
     XMLUtils::GetFloat(pElement, "limiterrelease", m_limiterRelease, 0.001f, 100.0f);
+
+    // ffmpeg or polyphase
+    XMLUtils::GetString(pElement, "resampler", m_audioResampler);
+
+    // read upcoming tracks from network shares into memory ahead of playback
+    TiXmlElement* pPrefetch = pElement->FirstChildElement("prefetch");
+    if (pPrefetch)
+    {
+      XMLUtils::GetBoolean(pPrefetch, "enabled", m_audioPrefetch);
+      XMLUtils::GetUInt(pPrefetch, "memorysize", m_audioPrefetchMemorySize, 1, 1024);
+      XMLUtils::GetUInt(pPrefetch, "lookahead", m_audioPrefetchLookahead, 1, 10);
+    }
+  }
+
+  pElement = pRootElement->FirstChildElement("games");
+  if (pElement)
+  {
+    XMLUtils::GetUInt(pElement, "rewindmemorysize", m_gamesRewindMemorySize, 0, 4096);
   }
 
   pElement = pRootElement->FirstChildElement("x11");
@@ -934,6 +970,9 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "updateemptytagsinterval", m_iEpgUpdateEmptyTagsInterval);
     XMLUtils::GetBoolean(pElement, "displayupdatepopup", m_bEpgDisplayUpdatePopup);
     XMLUtils::GetBoolean(pElement, "displayincrementalupdatepopup", m_bEpgDisplayIncrementalUpdatePopup);
+    XMLUtils::GetInt(pElement, "maxconcurrentupdates", m_iEpgMaxConcurrentUpdates, 1, 32);
+    XMLUtils::GetInt(pElement, "maxconcurrentupdatesperclient",
+                     m_iEpgMaxConcurrentUpdatesPerClient, 1, 32);
   }
 
   // EDL commercial break handling
@@ -1115,6 +1154,14 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pPVR, "numericchannelswitchtimeout", m_iPVRNumericChannelSwitchTimeout, 50, 60000);
     XMLUtils::GetInt(pPVR, "timeshiftthreshold", m_iPVRTimeshiftThreshold, 0, 60);
     XMLUtils::GetBoolean(pPVR, "timeshiftsimpleosd", m_bPVRTimeshiftSimpleOSD);
+    XMLUtils::GetBoolean(pPVR, "warmstart", m_bPVRWarmStart);
+    XMLUtils::GetBoolean(pPVR, "prebufferchannels", m_bPVRPrebufferChannels);
+    XMLUtils::GetInt(pPVR, "prebuffermaxstreams", m_iPVRPrebufferMaxStreams, 0, 2);
+    XMLUtils::GetInt(pPVR, "prebuffermaxkbps", m_iPVRPrebufferMaxKBps, 0, 1024 * 1024);
+    XMLUtils::GetInt(pPVR, "prebuffersizekb", m_iPVRPrebufferSizeKB, 64, 64 * 1024);
+    XMLUtils::GetBoolean(pPVR, "localtimeshift", m_bPVRLocalTimeshift);
+    XMLUtils::GetPath(pPVR, "localtimeshiftpath", m_strPVRLocalTimeshiftPath);
+    XMLUtils::GetInt(pPVR, "localtimeshiftsizemb", m_iPVRLocalTimeshiftSizeMB, 16, 64 * 1024);
     TiXmlElement* pSortDecription = pPVR->FirstChildElement("pvrrecordings");
     if (pSortDecription)
     {
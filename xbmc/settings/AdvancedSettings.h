@@ -129,9 +129,15 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_VideoPlayerIgnoreDTSinWAV;
     float m_limiterHold;
     float m_limiterRelease;
+    std::string m_audioResampler;
+    bool m_audioPrefetch;
+    unsigned int m_audioPrefetchMemorySize; //!< in MB
+    unsigned int m_audioPrefetchLookahead; //!< number of upcoming playlist items
 
     bool  m_omlSync = true;
 
+    unsigned int m_gamesRewindMemorySize = 256; //!< in MB, 0 for no limit
+
     float m_videoSubsDelayRange;
     float m_videoAudioDelayRange;
     bool m_videoUseTimeSeeking;
@@ -272,6 +278,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_iEpgUpdateEmptyTagsInterval; // seconds
     bool m_bEpgDisplayUpdatePopup;
     bool m_bEpgDisplayIncrementalUpdatePopup;
+    int m_iEpgMaxConcurrentUpdates;
+    int m_iEpgMaxConcurrentUpdatesPerClient;
 
     // EDL Commercial Break
     bool m_bEdlMergeShortCommBreaks;
@@ -317,6 +325,14 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_iPVRNumericChannelSwitchTimeout; /*!< @brief time in msecs after that a channel switch occurs after entering a channel number, if confirmchannelswitch is disabled */
     int m_iPVRTimeshiftThreshold; /*!< @brief time diff between current playing time and timeshift buffer end, in seconds, before a playing stream is displayed as timeshifting. */
     bool m_bPVRTimeshiftSimpleOSD; /*!< @brief use simple timeshift OSD (with progress only for the playing event instead of progress for the whole ts buffer). */
+    bool m_bPVRWarmStart; /*!< @brief make the channels, groups and EPG persisted by the last session available at startup, before the clients are ready. */
+    bool m_bPVRPrebufferChannels; /*!< @brief open the streams of the channels next to the playing channel ahead of time, for fast channel switching. defaults to false. */
+    int m_iPVRPrebufferMaxStreams; /*!< @brief the number of streams per client that may be opened ahead of time. */
+    int m_iPVRPrebufferMaxKBps; /*!< @brief the bandwidth in KB/s all streams opened ahead of time may use together, 0 for no limit. */
+    int m_iPVRPrebufferSizeKB; /*!< @brief the size in KB of the buffer of each stream opened ahead of time. */
+    bool m_bPVRLocalTimeshift; /*!< @brief record live streams to disk so they can be paused and seeked if the client does not support timeshifting. defaults to false. */
+    std::string m_strPVRLocalTimeshiftPath; /*!< @brief the folder of the local timeshift buffer. defaults to special://temp/. */
+    int m_iPVRLocalTimeshiftSizeMB; /*!< @brief the size in MB of the local timeshift buffer. */
     SortDescription m_PVRDefaultSortOrder; /*!< @brief SortDecription used to store default recording sort type and sort order */
 
     DatabaseSettings m_databaseMusic; // advanced music database setup
@@ -17,6 +17,7 @@ CGameSettings &CGameSettings::operator=(const CGameSettings &rhs)
     m_videoFilter = rhs.m_videoFilter;
     m_stretchMode = rhs.m_stretchMode;
     m_rotationDegCCW = rhs.m_rotationDegCCW;
+    m_runAheadFrames = rhs.m_runAheadFrames;
   }
   return *this;
 }
@@ -26,13 +27,15 @@ void CGameSettings::Reset()
   m_videoFilter.clear();
   m_stretchMode = RETRO::STRETCHMODE::Normal;
   m_rotationDegCCW = 0;
+  m_runAheadFrames = 0;
 }
 
 bool CGameSettings::operator==(const CGameSettings &rhs) const
 {
   return m_videoFilter == rhs.m_videoFilter &&
          m_stretchMode == rhs.m_stretchMode &&
-         m_rotationDegCCW == rhs.m_rotationDegCCW;
+         m_rotationDegCCW == rhs.m_rotationDegCCW &&
+         m_runAheadFrames == rhs.m_runAheadFrames;
 }
 
 void CGameSettings::SetVideoFilter(const std::string &videoFilter)
@@ -61,3 +64,12 @@ void CGameSettings::SetRotationDegCCW(unsigned int rotation)
     SetChanged();
   }
 }
+
+void CGameSettings::SetRunAheadFrames(unsigned int runAheadFrames)
+{
+  if (runAheadFrames != m_runAheadFrames)
+  {
+    m_runAheadFrames = runAheadFrames;
+    SetChanged();
+  }
+}
@@ -36,9 +36,15 @@ public:
   unsigned int RotationDegCCW() const { return m_rotationDegCCW; }
   void SetRotationDegCCW(unsigned int rotation);
 
+  unsigned int RunAheadFrames() const { return m_runAheadFrames; }
+  void SetRunAheadFrames(unsigned int runAheadFrames);
+
 private:
   // Video settings
   std::string m_videoFilter;
   KODI::RETRO::STRETCHMODE m_stretchMode;
   unsigned int m_rotationDegCCW;
+
+  // Gameplay settings
+  unsigned int m_runAheadFrames;
 };
@@ -139,6 +139,27 @@ bool CMediaSettings::Load(const TiXmlNode *settings)
     int rotation;
     if (XMLUtils::GetInt(pElement, "rotation", rotation, 0, 270) && rotation >= 0)
       m_defaultGameSettings.SetRotationDegCCW(static_cast<unsigned int>(rotation));
+
+    int runAheadFrames;
+    if (XMLUtils::GetInt(pElement, "runaheadframes", runAheadFrames, 0,
+                         RETRO::MAX_RUNAHEAD_FRAMES))
+      m_defaultGameSettings.SetRunAheadFrames(static_cast<unsigned int>(runAheadFrames));
+  }
+
+  // Run-ahead chosen for individual games
+  m_gameRunAheadFrames.clear();
+  pElement = settings->FirstChildElement("gamerunahead");
+  if (pElement != nullptr)
+  {
+    for (const TiXmlElement* pGame = pElement->FirstChildElement("game"); pGame != nullptr;
+         pGame = pGame->NextSiblingElement("game"))
+    {
+      const char* path = pGame->Attribute("path");
+      int runAheadFrames;
+      if (path != nullptr && XMLUtils::GetInt(pGame, "frames", runAheadFrames, 0,
+                                              RETRO::MAX_RUNAHEAD_FRAMES))
+        m_gameRunAheadFrames[path] = static_cast<unsigned int>(runAheadFrames);
+    }
   }
 
   // mymusic settings
@@ -246,6 +267,21 @@ bool CMediaSettings::Save(TiXmlNode *settings) const
   std::string sm = RETRO::CRetroPlayerUtils::StretchModeToIdentifier(m_defaultGameSettings.StretchMode());
   XMLUtils::SetString(pNode, "stretchmode", sm);
   XMLUtils::SetInt(pNode, "rotation", m_defaultGameSettings.RotationDegCCW());
+  XMLUtils::SetInt(pNode, "runaheadframes", m_defaultGameSettings.RunAheadFrames());
+
+  TiXmlElement gameRunAheadNode("gamerunahead");
+  pNode = settings->InsertEndChild(gameRunAheadNode);
+  if (pNode == nullptr)
+    return false;
+
+  for (const auto& it : m_gameRunAheadFrames)
+  {
+    TiXmlElement gameNode("game");
+    gameNode.SetAttribute("path", it.first.c_str());
+    TiXmlNode* pGame = pNode->InsertEndChild(gameNode);
+    if (pGame != nullptr)
+      XMLUtils::SetInt(pGame, "frames", it.second);
+  }
 
   // mymusic
   pNode = settings->FirstChild("mymusic");
@@ -397,6 +433,22 @@ void CMediaSettings::CycleWatchedMode(const std::string &content)
   }
 }
 
+unsigned int CMediaSettings::GetGameRunAheadFrames(const std::string& gamePath) const
+{
+  CSingleLock lock(m_critical);
+  auto it = m_gameRunAheadFrames.find(gamePath);
+  if (it != m_gameRunAheadFrames.end())
+    return it->second;
+
+  return m_defaultGameSettings.RunAheadFrames();
+}
+
+void CMediaSettings::SetGameRunAheadFrames(const std::string& gamePath, unsigned int frames)
+{
+  CSingleLock lock(m_critical);
+  m_gameRunAheadFrames[gamePath] = frames;
+}
+
 std::string CMediaSettings::GetWatchedContent(const std::string &content)
 {
   if (content == "seasons" || content == "episodes")
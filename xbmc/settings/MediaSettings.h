@@ -69,6 +69,20 @@ public:
    */
   void CycleWatchedMode(const std::string &content);
 
+  /*! \brief Retrieve the run-ahead frames chosen for a game
+   \param gamePath Path of the game file
+   \return the frames chosen for this game, the default game settings if none were chosen
+   \sa SetGameRunAheadFrames
+   */
+  unsigned int GetGameRunAheadFrames(const std::string& gamePath) const;
+
+  /*! \brief Remember the run-ahead frames for a game
+   \param gamePath Path of the game file
+   \param frames Frames to emulate ahead of the input
+   \sa GetGameRunAheadFrames
+   */
+  void SetGameRunAheadFrames(const std::string& gamePath, unsigned int frames);
+
   void SetMusicPlaylistRepeat(bool repeats) { m_musicPlaylistRepeat = repeats; }
   void SetMusicPlaylistShuffled(bool shuffled) { m_musicPlaylistShuffle = shuffled; }
 
@@ -98,6 +112,7 @@ private:
 
   CGameSettings m_defaultGameSettings;
   CGameSettings m_currentGameSettings;
+  std::map<std::string, unsigned int> m_gameRunAheadFrames;
 
   typedef std::map<std::string, WatchedMode> WatchedModes;
   WatchedModes m_watchedModes;
@@ -0,0 +1,38 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+/*!
+ * \brief Storage that needs a while to answer every access
+ *
+ * Tests of code that keeps I/O away from latency sensitive threads derive
+ * their fake file system or database from it.
+ */
+struct CSlowStorage
+{
+  std::atomic<int> delayMs{0};
+  std::atomic<int> accesses{0};
+  std::atomic<bool> fail{false};
+
+  /*!
+   * \brief Count the access and wait for the configured delay
+   *
+   * \return False if the storage is set to fail
+   */
+  bool Access()
+  {
+    accesses++;
+    std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+    return !fail;
+  }
+};
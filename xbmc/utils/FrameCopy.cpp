@@ -0,0 +1,522 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "FrameCopy.h"
+
+#include "ServiceBroker.h"
+#include "utils/CPUInfo.h"
+
+#include <atomic>
+#include <memory>
+#include <string.h>
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define FRAMECOPY_X86
+#include <immintrin.h>
+#if defined(__GNUC__)
+#define FRAMECOPY_TARGET_SSE2 __attribute__((target("sse2")))
+#define FRAMECOPY_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define FRAMECOPY_TARGET_SSE2
+#define FRAMECOPY_TARGET_AVX2
+#endif
+#elif defined(__aarch64__) || (defined(__arm__) && defined(HAS_NEON))
+#define FRAMECOPY_NEON
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+// planes larger than this are written around the cache
+constexpr size_t STREAMING_THRESHOLD = 2 * 1024 * 1024;
+
+struct KernelSet
+{
+  CFrameCopy::Kernel kernel;
+  void (*copyRow)(uint8_t* dst, const uint8_t* src, size_t size, bool stream);
+  void (*splitUV)(uint8_t* dstU, uint8_t* dstV, const uint8_t* src, size_t width);
+  void (*mergeUV)(uint8_t* dst, const uint8_t* srcU, const uint8_t* srcV, size_t width);
+  void (*fence)();
+};
+
+//------------------------------------------------------------------------------
+// C
+//------------------------------------------------------------------------------
+
+// the C and NEON kernels always write through the cache
+void CopyRowC(uint8_t* dst, const uint8_t* src, size_t size, bool /* stream */)
+{
+  memcpy(dst, src, size);
+}
+
+void SplitUVC(uint8_t* dstU, uint8_t* dstV, const uint8_t* src, size_t width)
+{
+  for (size_t i = 0; i < width; i++)
+  {
+    dstU[i] = src[2 * i];
+    dstV[i] = src[2 * i + 1];
+  }
+}
+
+void MergeUVC(uint8_t* dst, const uint8_t* srcU, const uint8_t* srcV, size_t width)
+{
+  for (size_t i = 0; i < width; i++)
+  {
+    dst[2 * i] = srcU[i];
+    dst[2 * i + 1] = srcV[i];
+  }
+}
+
+void FenceC()
+{
+}
+
+constexpr KernelSet KERNELS_C = {CFrameCopy::Kernel::C, CopyRowC, SplitUVC, MergeUVC, FenceC};
+
+#if defined(FRAMECOPY_X86)
+//------------------------------------------------------------------------------
+// SSE2
+//------------------------------------------------------------------------------
+
+FRAMECOPY_TARGET_SSE2 void CopyRowSSE2(uint8_t* dst, const uint8_t* src, size_t size, bool stream)
+{
+  size_t i = 0;
+  if (stream)
+  {
+    // align the destination for the streaming stores
+    const size_t head = (16 - (reinterpret_cast<uintptr_t>(dst) & 15)) & 15;
+    if (head < size)
+    {
+      memcpy(dst, src, head);
+      for (i = head; i + 64 <= size; i += 64)
+      {
+        const __m128i x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+        const __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32));
+        const __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), x0);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 16), x1);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 32), x2);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 48), x3);
+      }
+    }
+  }
+  else
+  {
+    for (; i + 64 <= size; i += 64)
+    {
+      const __m128i x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      const __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+      const __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32));
+      const __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), x0);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16), x1);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 32), x2);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 48), x3);
+    }
+  }
+
+  if (i < size)
+    memcpy(dst + i, src + i, size - i);
+}
+
+FRAMECOPY_TARGET_SSE2 void SplitUVSSE2(uint8_t* dstU,
+                                       uint8_t* dstV,
+                                       const uint8_t* src,
+                                       size_t width)
+{
+  const __m128i mask = _mm_set1_epi16(0x00FF);
+  size_t i = 0;
+  for (; i + 16 <= width; i += 16)
+  {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i + 16));
+    const __m128i u = _mm_packus_epi16(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+    const __m128i v = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dstU + i), u);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dstV + i), v);
+  }
+  SplitUVC(dstU + i, dstV + i, src + 2 * i, width - i);
+}
+
+FRAMECOPY_TARGET_SSE2 void MergeUVSSE2(uint8_t* dst,
+                                       const uint8_t* srcU,
+                                       const uint8_t* srcV,
+                                       size_t width)
+{
+  size_t i = 0;
+  for (; i + 16 <= width; i += 16)
+  {
+    const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcU + i));
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcV + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), _mm_unpacklo_epi8(u, v));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i + 16), _mm_unpackhi_epi8(u, v));
+  }
+  MergeUVC(dst + 2 * i, srcU + i, srcV + i, width - i);
+}
+
+FRAMECOPY_TARGET_SSE2 void FenceSSE2()
+{
+  _mm_sfence();
+}
+
+constexpr KernelSet KERNELS_SSE2 = {CFrameCopy::Kernel::SSE2, CopyRowSSE2, SplitUVSSE2,
+                                    MergeUVSSE2, FenceSSE2};
+
+//------------------------------------------------------------------------------
+// AVX2
+//------------------------------------------------------------------------------
+
+FRAMECOPY_TARGET_AVX2 void CopyRowAVX2(uint8_t* dst, const uint8_t* src, size_t size, bool stream)
+{
+  size_t i = 0;
+  if (stream)
+  {
+    const size_t head = (32 - (reinterpret_cast<uintptr_t>(dst) & 31)) & 31;
+    if (head < size)
+    {
+      memcpy(dst, src, head);
+      for (i = head; i + 128 <= size; i += 128)
+      {
+        const __m256i y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i y1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+        const __m256i y2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 64));
+        const __m256i y3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 96));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i), y0);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i + 32), y1);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i + 64), y2);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i + 96), y3);
+      }
+    }
+  }
+  else
+  {
+    for (; i + 128 <= size; i += 128)
+    {
+      const __m256i y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+      const __m256i y1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+      const __m256i y2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 64));
+      const __m256i y3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 96));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), y0);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 32), y1);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 64), y2);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 96), y3);
+    }
+  }
+
+  for (; i + 32 <= size; i += 32)
+  {
+    const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), y);
+  }
+
+  if (i < size)
+    memcpy(dst + i, src + i, size - i);
+
+  // avoid the AVX to SSE transition penalty in the caller
+  _mm256_zeroupper();
+}
+
+FRAMECOPY_TARGET_AVX2 void SplitUVAVX2(uint8_t* dstU,
+                                       uint8_t* dstV,
+                                       const uint8_t* src,
+                                       size_t width)
+{
+  const __m256i mask = _mm256_set1_epi16(0x00FF);
+  size_t i = 0;
+  for (; i + 32 <= width; i += 32)
+  {
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * i));
+    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * i + 32));
+    // the packs work per 128 bit lane, put the quadwords back in order
+    const __m256i u = _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(_mm256_and_si256(a, mask), _mm256_and_si256(b, mask)), 0xD8);
+    const __m256i v = _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8)), 0xD8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dstU + i), u);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dstV + i), v);
+  }
+  _mm256_zeroupper();
+  SplitUVC(dstU + i, dstV + i, src + 2 * i, width - i);
+}
+
+FRAMECOPY_TARGET_AVX2 void MergeUVAVX2(uint8_t* dst,
+                                       const uint8_t* srcU,
+                                       const uint8_t* srcV,
+                                       size_t width)
+{
+  size_t i = 0;
+  for (; i + 32 <= width; i += 32)
+  {
+    const __m256i u = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcU + i));
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcV + i));
+    const __m256i lo = _mm256_unpacklo_epi8(u, v);
+    const __m256i hi = _mm256_unpackhi_epi8(u, v);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i),
+                        _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i + 32),
+                        _mm256_permute2x128_si256(lo, hi, 0x31));
+  }
+  _mm256_zeroupper();
+  MergeUVC(dst + 2 * i, srcU + i, srcV + i, width - i);
+}
+
+constexpr KernelSet KERNELS_AVX2 = {CFrameCopy::Kernel::AVX2, CopyRowAVX2, SplitUVAVX2,
+                                    MergeUVAVX2, FenceSSE2};
+#endif
+
+#if defined(FRAMECOPY_NEON)
+//------------------------------------------------------------------------------
+// NEON
+//------------------------------------------------------------------------------
+
+void CopyRowNEON(uint8_t* dst, const uint8_t* src, size_t size, bool /* stream */)
+{
+  size_t i = 0;
+  for (; i + 64 <= size; i += 64)
+  {
+    const uint8x16_t q0 = vld1q_u8(src + i);
+    const uint8x16_t q1 = vld1q_u8(src + i + 16);
+    const uint8x16_t q2 = vld1q_u8(src + i + 32);
+    const uint8x16_t q3 = vld1q_u8(src + i + 48);
+    vst1q_u8(dst + i, q0);
+    vst1q_u8(dst + i + 16, q1);
+    vst1q_u8(dst + i + 32, q2);
+    vst1q_u8(dst + i + 48, q3);
+  }
+
+  if (i < size)
+    memcpy(dst + i, src + i, size - i);
+}
+
+void SplitUVNEON(uint8_t* dstU, uint8_t* dstV, const uint8_t* src, size_t width)
+{
+  size_t i = 0;
+  for (; i + 16 <= width; i += 16)
+  {
+    const uint8x16x2_t uv = vld2q_u8(src + 2 * i);
+    vst1q_u8(dstU + i, uv.val[0]);
+    vst1q_u8(dstV + i, uv.val[1]);
+  }
+  SplitUVC(dstU + i, dstV + i, src + 2 * i, width - i);
+}
+
+void MergeUVNEON(uint8_t* dst, const uint8_t* srcU, const uint8_t* srcV, size_t width)
+{
+  size_t i = 0;
+  for (; i + 16 <= width; i += 16)
+  {
+    uint8x16x2_t uv;
+    uv.val[0] = vld1q_u8(srcU + i);
+    uv.val[1] = vld1q_u8(srcV + i);
+    vst2q_u8(dst + 2 * i, uv);
+  }
+  MergeUVC(dst + 2 * i, srcU + i, srcV + i, width - i);
+}
+
+constexpr KernelSet KERNELS_NEON = {CFrameCopy::Kernel::NEON, CopyRowNEON, SplitUVNEON,
+                                    MergeUVNEON, FenceC};
+#endif
+
+const KernelSet* GetKernelSet(CFrameCopy::Kernel kernel)
+{
+  switch (kernel)
+  {
+#if defined(FRAMECOPY_X86)
+    case CFrameCopy::Kernel::SSE2:
+      return &KERNELS_SSE2;
+    case CFrameCopy::Kernel::AVX2:
+      return &KERNELS_AVX2;
+#endif
+#if defined(FRAMECOPY_NEON)
+    case CFrameCopy::Kernel::NEON:
+      return &KERNELS_NEON;
+#endif
+    case CFrameCopy::Kernel::C:
+      return &KERNELS_C;
+    default:
+      return nullptr;
+  }
+}
+
+unsigned int GetCPUFeatures()
+{
+  std::shared_ptr<CCPUInfo> cpuInfo = CServiceBroker::GetCPUInfo();
+  if (!cpuInfo)
+    cpuInfo = CCPUInfo::GetCPUInfo();
+
+  return cpuInfo ? cpuInfo->GetCPUFeatures() : 0;
+}
+
+const KernelSet* SelectBest()
+{
+  if (CFrameCopy::IsSupported(CFrameCopy::Kernel::AVX2))
+    return GetKernelSet(CFrameCopy::Kernel::AVX2);
+  if (CFrameCopy::IsSupported(CFrameCopy::Kernel::SSE2))
+    return GetKernelSet(CFrameCopy::Kernel::SSE2);
+  if (CFrameCopy::IsSupported(CFrameCopy::Kernel::NEON))
+    return GetKernelSet(CFrameCopy::Kernel::NEON);
+
+  return &KERNELS_C;
+}
+
+std::atomic<const KernelSet*> activeKernels{nullptr};
+
+const KernelSet& Kernels()
+{
+  const KernelSet* kernels = activeKernels.load(std::memory_order_acquire);
+  if (!kernels)
+  {
+    // selecting twice from concurrent first calls is harmless
+    kernels = SelectBest();
+    activeKernels.store(kernels, std::memory_order_release);
+  }
+  return *kernels;
+}
+
+void CopyPlaneWith(const KernelSet& kernels,
+                   uint8_t* dst,
+                   int dstStride,
+                   const uint8_t* src,
+                   int srcStride,
+                   int widthBytes,
+                   int height)
+{
+  if (widthBytes <= 0 || height <= 0)
+    return;
+
+  const size_t planeSize = static_cast<size_t>(widthBytes) * height;
+  const bool stream = planeSize >= STREAMING_THRESHOLD;
+
+  if (dstStride == widthBytes && srcStride == widthBytes)
+  {
+    kernels.copyRow(dst, src, planeSize, stream);
+  }
+  else
+  {
+    for (int y = 0; y < height; y++)
+    {
+      kernels.copyRow(dst, src, widthBytes, stream);
+      src += srcStride;
+      dst += dstStride;
+    }
+  }
+
+  if (stream)
+    kernels.fence();
+}
+} // namespace
+
+CFrameCopy::Kernel CFrameCopy::GetKernel()
+{
+  return Kernels().kernel;
+}
+
+const char* CFrameCopy::GetKernelName(Kernel kernel)
+{
+  switch (kernel)
+  {
+    case Kernel::C:
+      return "C";
+    case Kernel::SSE2:
+      return "SSE2";
+    case Kernel::AVX2:
+      return "AVX2";
+    case Kernel::NEON:
+      return "NEON";
+    default:
+      return "unknown";
+  }
+}
+
+bool CFrameCopy::IsSupported(Kernel kernel)
+{
+  if (!GetKernelSet(kernel))
+    return false;
+
+  switch (kernel)
+  {
+    case Kernel::SSE2:
+      return (GetCPUFeatures() & CPU_FEATURE_SSE2) != 0;
+    case Kernel::AVX2:
+      return (GetCPUFeatures() & CPU_FEATURE_AVX2) != 0;
+    case Kernel::NEON:
+#if defined(__aarch64__)
+      // NEON is mandatory on AArch64
+      return true;
+#else
+      return (GetCPUFeatures() & CPU_FEATURE_NEON) != 0;
+#endif
+    default:
+      return true;
+  }
+}
+
+bool CFrameCopy::ForceKernel(Kernel kernel)
+{
+  if (!IsSupported(kernel))
+    return false;
+
+  activeKernels.store(GetKernelSet(kernel), std::memory_order_release);
+  return true;
+}
+
+void CFrameCopy::ResetKernel()
+{
+  activeKernels.store(SelectBest(), std::memory_order_release);
+}
+
+void CFrameCopy::CopyPlane(
+    uint8_t* dst, int dstStride, const uint8_t* src, int srcStride, int widthBytes, int height)
+{
+  CopyPlaneWith(Kernels(), dst, dstStride, src, srcStride, widthBytes, height);
+}
+
+void CFrameCopy::SplitUV(uint8_t* dstU,
+                         int dstStrideU,
+                         uint8_t* dstV,
+                         int dstStrideV,
+                         const uint8_t* src,
+                         int srcStride,
+                         int width,
+                         int height)
+{
+  if (width <= 0)
+    return;
+
+  const KernelSet& kernels = Kernels();
+  for (int y = 0; y < height; y++)
+  {
+    kernels.splitUV(dstU, dstV, src, width);
+    dstU += dstStrideU;
+    dstV += dstStrideV;
+    src += srcStride;
+  }
+}
+
+void CFrameCopy::MergeUV(uint8_t* dst,
+                         int dstStride,
+                         const uint8_t* srcU,
+                         int srcStrideU,
+                         const uint8_t* srcV,
+                         int srcStrideV,
+                         int width,
+                         int height)
+{
+  if (width <= 0)
+    return;
+
+  const KernelSet& kernels = Kernels();
+  for (int y = 0; y < height; y++)
+  {
+    kernels.mergeUV(dst, srcU, srcV, width);
+    dst += dstStride;
+    srcU += srcStrideU;
+    srcV += srcStrideV;
+  }
+}
@@ -0,0 +1,90 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*!
+ * \brief Strided plane copy and chroma conversion for system memory frames.
+ *
+ * The kernels are picked once at runtime from the features reported by CCPUInfo: AVX2 and SSE2
+ * on x86, NEON on ARM, plain C otherwise. Large planes are written with non-temporal stores
+ * where the instruction set has them, so a frame on its way to the GPU does not evict the
+ * decoder's working set from the cache.
+ *
+ * All strides are in bytes and may be larger than the row, widths are in samples unless the
+ * parameter is called widthBytes.
+ */
+class CFrameCopy
+{
+public:
+  enum class Kernel
+  {
+    C,
+    SSE2,
+    AVX2,
+    NEON,
+  };
+
+  /*!
+   * \brief The kernel set used by all copy functions.
+   */
+  static Kernel GetKernel();
+
+  static const char* GetKernelName(Kernel kernel);
+
+  /*!
+   * \brief Whether the given kernel set was built in and is supported by the CPU.
+   */
+  static bool IsSupported(Kernel kernel);
+
+  /*!
+   * \brief Use the given kernel set instead of the best one, used by tests and benchmarks.
+   * \return false if the kernel set is not supported, the current one is kept.
+   */
+  static bool ForceKernel(Kernel kernel);
+
+  /*!
+   * \brief Go back to the best kernel set for this CPU.
+   */
+  static void ResetKernel();
+
+  static void CopyPlane(uint8_t* dst,
+                        int dstStride,
+                        const uint8_t* src,
+                        int srcStride,
+                        int widthBytes,
+                        int height);
+
+  /*!
+   * \brief Deinterleave an 8 bit UV plane into separate U and V planes (NV12 -> I420 chroma).
+   * \param width Chroma samples per row, i.e. half of the UV row in bytes.
+   */
+  static void SplitUV(uint8_t* dstU,
+                      int dstStrideU,
+                      uint8_t* dstV,
+                      int dstStrideV,
+                      const uint8_t* src,
+                      int srcStride,
+                      int width,
+                      int height);
+
+  /*!
+   * \brief Interleave separate 8 bit U and V planes into one UV plane (I420 -> NV12 chroma).
+   * \param width Chroma samples per row.
+   */
+  static void MergeUV(uint8_t* dst,
+                      int dstStride,
+                      const uint8_t* srcU,
+                      int srcStrideU,
+                      const uint8_t* srcV,
+                      int srcStrideV,
+                      int width,
+                      int height);
+};
@@ -13,61 +13,180 @@
 #endif
 #include <math.h>
 
-RFFT::RFFT(int size, bool windowed) :
-  m_size(size), m_windowed(windowed)
-{
-  m_cfg = kiss_fftr_alloc(m_size,0,nullptr,nullptr);
-}
-
-RFFT::~RFFT()
-{
-  // we don' use kiss_fftr_free here because
-  // its hardcoded to free and doesn't pay attention
-  // to SIMD (which might be used during kiss_fftr_alloc
-  //in the C'tor).
-  KISS_FFT_FREE(m_cfg);
-}
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define RFFT_USE_SSE
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RFFT_USE_NEON
+#endif
 
-void RFFT::calc(const float* input, float* output)
+RFFT::RFFT(int size, bool windowed) :
+  m_size(size), m_windowed(windowed), m_re(size), m_im(size)
 {
-  // temporary buffers
-  std::vector<kiss_fft_scalar> linput(m_size), rinput(m_size);
-  std::vector<kiss_fft_cpx> loutput(m_size), routput(m_size);
+  unsigned int bits = 0;
+  while ((static_cast<size_t>(1) << bits) < m_size)
+    ++bits;
 
+  m_bitrev.resize(m_size);
   for (size_t i=0;i<m_size;++i)
   {
-    linput[i] = input[2*i];
-    rinput[i] = input[2*i+1];
+    uint32_t reversed = 0;
+    for (unsigned int bit=0;bit<bits;++bit)
+      reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+    m_bitrev[i] = reversed;
+  }
+
+  // stage with half size h uses the twiddles at offset h-1
+  m_twiddleRe.resize(m_size > 1 ? m_size - 1 : 0);
+  m_twiddleIm.resize(m_twiddleRe.size());
+  for (size_t half=1;half<m_size;half*=2)
+  {
+    for (size_t k=0;k<half;++k)
+    {
+      const double angle = -M_PI * k / half;
+      m_twiddleRe[half - 1 + k] = static_cast<float>(cos(angle));
+      m_twiddleIm[half - 1 + k] = static_cast<float>(sin(angle));
+    }
   }
 
   if (m_windowed)
   {
-    hann(linput);
-    hann(rinput);
+    m_window.resize(m_size);
+    for (size_t i=0;i<m_size;++i)
+      m_window[i] = static_cast<float>(0.5 * (1.0 - cos(2.0 * M_PI * i / (m_size - 1))));
   }
+}
 
-  // transform channels
-  kiss_fftr(m_cfg, &linput[0], &loutput[0]);
-  kiss_fftr(m_cfg, &rinput[0], &routput[0]);
+RFFT::~RFFT() = default;
 
-  auto&& filter = [&](kiss_fft_cpx& data)
+void RFFT::calc(const float* input, float* output)
+{
+  // deinterleave into bit reversed order, left channel as real part and
+  // right channel as imaginary part
+  if (m_windowed)
+  {
+    for (size_t i=0;i<m_size;++i)
+    {
+      m_re[m_bitrev[i]] = input[2*i] * m_window[i];
+      m_im[m_bitrev[i]] = input[2*i+1] * m_window[i];
+    }
+  }
+  else
   {
-    return static_cast<double>(sqrt(data.r * data.r + data.i * data.i)) * 2.0 / m_size *
-           (m_windowed ? sqrt(8.0 / 3.0) : 1.0);
-  };
+    for (size_t i=0;i<m_size;++i)
+    {
+      m_re[m_bitrev[i]] = input[2*i];
+      m_im[m_bitrev[i]] = input[2*i+1];
+    }
+  }
+
+  transform();
 
-  // interleave while taking magnitudes and normalizing
+  // separate the spectra of both channels while taking magnitudes and
+  // normalizing, the spectrum of a real signal is conjugate symmetric:
+  //   L[k] = (Z[k] + conj(Z[N-k])) / 2
+  //   R[k] = (Z[k] - conj(Z[N-k])) / 2i
+  const float scale = static_cast<float>(1.0 / m_size * (m_windowed ? sqrt(8.0 / 3.0) : 1.0));
   for (size_t i=0;i<m_size/2;++i)
   {
-    output[2*i] = filter(loutput[i]);
-    output[2*i+1] = filter(routput[i]);
+    const size_t j = (m_size - i) & (m_size - 1);
+    const float lr = m_re[i] + m_re[j];
+    const float li = m_im[i] - m_im[j];
+    const float rr = m_im[i] + m_im[j];
+    const float ri = m_re[j] - m_re[i];
+    output[2*i] = sqrtf(lr * lr + li * li) * scale;
+    output[2*i+1] = sqrtf(rr * rr + ri * ri) * scale;
   }
 }
 
-#include <iostream>
-
-void RFFT::hann(std::vector<kiss_fft_scalar>& data)
+void RFFT::transform()
 {
-  for (size_t i=0;i<data.size();++i)
-    data[i] *= 0.5f * (1.0f - cos(2.0f * static_cast<float>(M_PI) * i / (data.size() - 1)));
+  float* re = m_re.data();
+  float* im = m_im.data();
+
+  // first stage, twiddle 1
+  for (size_t i=0;i+1<m_size;i+=2)
+  {
+    const float ar = re[i], ai = im[i];
+    re[i] = ar + re[i+1];
+    im[i] = ai + im[i+1];
+    re[i+1] = ar - re[i+1];
+    im[i+1] = ai - im[i+1];
+  }
+
+  // second stage, twiddles 1 and -i
+  for (size_t i=0;i+3<m_size;i+=4)
+  {
+    float ar = re[i], ai = im[i];
+    re[i] = ar + re[i+2];
+    im[i] = ai + im[i+2];
+    re[i+2] = ar - re[i+2];
+    im[i+2] = ai - im[i+2];
+
+    ar = re[i+1];
+    ai = im[i+1];
+    const float br = im[i+3], bi = -re[i+3];
+    re[i+1] = ar + br;
+    im[i+1] = ai + bi;
+    re[i+3] = ar - br;
+    im[i+3] = ai - bi;
+  }
+
+  // remaining stages, four butterflies at a time
+  for (size_t half=4;half<m_size;half*=2)
+  {
+    const float* twRe = m_twiddleRe.data() + half - 1;
+    const float* twIm = m_twiddleIm.data() + half - 1;
+
+    for (size_t start=0;start<m_size;start+=2*half)
+    {
+      float* aRe = re + start;
+      float* aIm = im + start;
+      float* bRe = aRe + half;
+      float* bIm = aIm + half;
+
+      for (size_t k=0;k<half;k+=4)
+      {
+#if defined(RFFT_USE_SSE)
+        const __m128 wr = _mm_loadu_ps(twRe + k);
+        const __m128 wi = _mm_loadu_ps(twIm + k);
+        const __m128 xr = _mm_loadu_ps(bRe + k);
+        const __m128 xi = _mm_loadu_ps(bIm + k);
+        const __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+        const __m128 ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+        const __m128 ar = _mm_loadu_ps(aRe + k);
+        const __m128 ai = _mm_loadu_ps(aIm + k);
+        _mm_storeu_ps(aRe + k, _mm_add_ps(ar, tr));
+        _mm_storeu_ps(aIm + k, _mm_add_ps(ai, ti));
+        _mm_storeu_ps(bRe + k, _mm_sub_ps(ar, tr));
+        _mm_storeu_ps(bIm + k, _mm_sub_ps(ai, ti));
+#elif defined(RFFT_USE_NEON)
+        const float32x4_t wr = vld1q_f32(twRe + k);
+        const float32x4_t wi = vld1q_f32(twIm + k);
+        const float32x4_t xr = vld1q_f32(bRe + k);
+        const float32x4_t xi = vld1q_f32(bIm + k);
+        const float32x4_t tr = vmlsq_f32(vmulq_f32(xr, wr), xi, wi);
+        const float32x4_t ti = vmlaq_f32(vmulq_f32(xr, wi), xi, wr);
+        const float32x4_t ar = vld1q_f32(aRe + k);
+        const float32x4_t ai = vld1q_f32(aIm + k);
+        vst1q_f32(aRe + k, vaddq_f32(ar, tr));
+        vst1q_f32(aIm + k, vaddq_f32(ai, ti));
+        vst1q_f32(bRe + k, vsubq_f32(ar, tr));
+        vst1q_f32(bIm + k, vsubq_f32(ai, ti));
+#else
+        for (size_t n=k;n<k+4;++n)
+        {
+          const float tr = bRe[n] * twRe[n] - bIm[n] * twIm[n];
+          const float ti = bRe[n] * twIm[n] + bIm[n] * twRe[n];
+          const float ar = aRe[n], ai = aIm[n];
+          aRe[n] = ar + tr;
+          aIm[n] = ai + ti;
+          bRe[n] = ar - tr;
+          bIm[n] = ai - ti;
+        }
+#endif
+      }
+    }
+  }
 }
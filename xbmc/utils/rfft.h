@@ -8,16 +8,20 @@
 
 #pragma once
 
-#include "contrib/kissfft/kiss_fftr.h"
-
+#include <stddef.h>
+#include <stdint.h>
 #include <vector>
 
 //! \brief Class performing a RFFT of interleaved stereo data.
+//!
+//! Both channels are transformed at once by a single complex FFT, the left
+//! channel as real and the right channel as imaginary part. The butterflies
+//! use SSE or NEON where available.
 class RFFT
 {
 public:
   //! \brief The constructor creates a RFFT plan.
-  //! \brief size Length of time data for a single channel.
+  //! \brief size Length of time data for a single channel, a power of 2.
   //! \brief windowed Whether or not to apply a Hann window to data.
   RFFT(int size, bool windowed=false);
 
@@ -29,11 +33,15 @@ public:
   //! \param output Output data of size m_size.
   void calc(const float* input, float* output);
 protected:
-  //! \brief Apply a Hann window to a buffer.
-  //! \param data Vector with data to apply window to.
-  static void hann(std::vector<kiss_fft_scalar>& data);
+  //! \brief Run the butterflies of all stages on m_re and m_im.
+  void transform();
 
   size_t m_size;       //!< Size for a single channel.
   bool m_windowed;     //!< Whether or not a Hann window is applied.
-  kiss_fftr_cfg m_cfg; //!< FFT plan
+  std::vector<float> m_window;      //!< Hann window, empty if not windowed
+  std::vector<uint32_t> m_bitrev;   //!< Bit reversed index of each sample
+  std::vector<float> m_twiddleRe;   //!< Twiddle factors of all stages, real part
+  std::vector<float> m_twiddleIm;   //!< Twiddle factors of all stages, imaginary part
+  std::vector<float> m_re;          //!< Work buffer, real part (left channel)
+  std::vector<float> m_im;          //!< Work buffer, imaginary part (right channel)
 };
@@ -0,0 +1,157 @@
+/*
+ *  Copyright (C) 2021 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "utils/FrameCopy.h"
+
+#include <chrono>
+#include <iostream>
+#include <string.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+const CFrameCopy::Kernel ALL_KERNELS[] = {CFrameCopy::Kernel::C, CFrameCopy::Kernel::SSE2,
+                                          CFrameCopy::Kernel::AVX2, CFrameCopy::Kernel::NEON};
+
+std::vector<uint8_t> MakePattern(size_t size, unsigned int seed)
+{
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; i++)
+    data[i] = static_cast<uint8_t>((i * 31 + seed) ^ (i >> 7));
+  return data;
+}
+} // namespace
+
+class TestFrameCopy : public ::testing::TestWithParam<CFrameCopy::Kernel>
+{
+protected:
+  void SetUp() override
+  {
+    if (!CFrameCopy::ForceKernel(GetParam()))
+      m_supported = false;
+  }
+
+  void TearDown() override { CFrameCopy::ResetKernel(); }
+
+  bool m_supported = true;
+};
+
+TEST_P(TestFrameCopy, CopyPlane)
+{
+  if (!m_supported)
+    return;
+
+  // odd widths exercise the vector tails, the large plane the streaming path
+  const int widths[] = {1, 15, 33, 127, 1921, 4096};
+  const int heights[] = {1, 3, 17, 600};
+  for (int width : widths)
+  {
+    for (int height : heights)
+    {
+      const int srcStride = width + 7;
+      const int dstStride = width + 64;
+      const std::vector<uint8_t> src = MakePattern(srcStride * height, width);
+      std::vector<uint8_t> dst(dstStride * height, 0xAA);
+
+      CFrameCopy::CopyPlane(dst.data(), dstStride, src.data(), srcStride, width, height);
+
+      for (int y = 0; y < height; y++)
+      {
+        ASSERT_EQ(0, memcmp(&dst[y * dstStride], &src[y * srcStride], width))
+            << "width " << width << " row " << y;
+        for (int x = width; x < dstStride; x++)
+          ASSERT_EQ(0xAA, dst[y * dstStride + x]) << "padding overwritten";
+      }
+    }
+  }
+}
+
+TEST_P(TestFrameCopy, CopyPlaneContiguous)
+{
+  if (!m_supported)
+    return;
+
+  const int width = 1920;
+  const int height = 1080;
+  const std::vector<uint8_t> src = MakePattern(width * height, 1);
+  std::vector<uint8_t> dst(width * height + 1, 0x55);
+
+  // unaligned destination
+  CFrameCopy::CopyPlane(dst.data() + 1, width, src.data(), width, width, height);
+  EXPECT_EQ(0x55, dst[0]);
+  EXPECT_EQ(0, memcmp(dst.data() + 1, src.data(), src.size()));
+}
+
+TEST_P(TestFrameCopy, SplitMergeUV)
+{
+  if (!m_supported)
+    return;
+
+  for (int width : {1, 17, 64, 960, 1001})
+  {
+    const int height = 9;
+    const int uvStride = width * 2 + 6;
+    const std::vector<uint8_t> uv = MakePattern(uvStride * height, width);
+    std::vector<uint8_t> u(width * height);
+    std::vector<uint8_t> v(width * height);
+
+    CFrameCopy::SplitUV(u.data(), width, v.data(), width, uv.data(), uvStride, width, height);
+
+    for (int y = 0; y < height; y++)
+    {
+      for (int x = 0; x < width; x++)
+      {
+        ASSERT_EQ(uv[y * uvStride + 2 * x], u[y * width + x]);
+        ASSERT_EQ(uv[y * uvStride + 2 * x + 1], v[y * width + x]);
+      }
+    }
+
+    std::vector<uint8_t> merged(uvStride * height);
+    CFrameCopy::MergeUV(merged.data(), uvStride, u.data(), width, v.data(), width, width,
+                        height);
+
+    for (int y = 0; y < height; y++)
+      ASSERT_EQ(0, memcmp(&merged[y * uvStride], &uv[y * uvStride], width * 2));
+  }
+}
+
+TEST_P(TestFrameCopy, DISABLED_Bandwidth)
+{
+  if (!m_supported)
+    return;
+
+  // 4K NV12 frame with padded source rows, as produced by the software decoder
+  const int width = 3840;
+  const int height = 2160;
+  const int srcStride = width + 64;
+  const std::vector<uint8_t> srcY = MakePattern(srcStride * height, 0);
+  const std::vector<uint8_t> srcUV = MakePattern(srcStride * height / 2, 1);
+  std::vector<uint8_t> dstY(width * height);
+  std::vector<uint8_t> dstUV(width * height / 2);
+
+  const int iterations = 50;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+  {
+    CFrameCopy::CopyPlane(dstY.data(), width, srcY.data(), srcStride, width, height);
+    CFrameCopy::CopyPlane(dstUV.data(), width, srcUV.data(), srcStride, width, height / 2);
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  const double bytes = static_cast<double>(width) * height * 3 / 2 * iterations;
+  std::cout << CFrameCopy::GetKernelName(GetParam()) << ": "
+            << bytes / elapsed.count() / (1024.0 * 1024.0 * 1024.0) << " GB/s, "
+            << elapsed.count() * 1000.0 / iterations << " ms per 4K NV12 frame" << std::endl;
+
+  EXPECT_EQ(0, memcmp(dstY.data() + (height - 1) * width, srcY.data() + (height - 1) * srcStride,
+                      width));
+}
+
+INSTANTIATE_TEST_SUITE_P(Kernels, TestFrameCopy, ::testing::ValuesIn(ALL_KERNELS));
@@ -6,8 +6,13 @@
  *  See LICENSES/README.md for more information.
  */
 
+#include "contrib/kissfft/kiss_fftr.h"
 #include "utils/rfft.h"
 
+#include <ctime>
+#include <random>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #if defined(TARGET_WINDOWS) && !defined(_USE_MATH_DEFINES)
@@ -39,3 +44,118 @@ TEST(TestRFFT, SimpleSignal)
     EXPECT_NEAR(output[2*i+1], ((i==freq2[0]||i==freq2[1])?1.0:0.0), 1e-7);
   }
 }
+
+namespace
+{
+//! \brief Reference magnitudes computed with kissfft, as RFFT used to do.
+class KissReference
+{
+public:
+  KissReference(size_t size, bool windowed) : m_size(size), m_windowed(windowed)
+  {
+    m_cfg = kiss_fftr_alloc(m_size, 0, nullptr, nullptr);
+  }
+
+  ~KissReference() { KISS_FFT_FREE(m_cfg); }
+
+  void calc(const float* input, float* output)
+  {
+    std::vector<kiss_fft_scalar> linput(m_size), rinput(m_size);
+    std::vector<kiss_fft_cpx> loutput(m_size), routput(m_size);
+
+    for (size_t i = 0; i < m_size; ++i)
+    {
+      const float window =
+          m_windowed ? 0.5f * (1.0f - cos(2.0f * static_cast<float>(M_PI) * i / (m_size - 1)))
+                     : 1.0f;
+      linput[i] = input[2 * i] * window;
+      rinput[i] = input[2 * i + 1] * window;
+    }
+
+    kiss_fftr(m_cfg, linput.data(), loutput.data());
+    kiss_fftr(m_cfg, rinput.data(), routput.data());
+
+    const float scale = static_cast<float>(2.0 / m_size * (m_windowed ? sqrt(8.0 / 3.0) : 1.0));
+    for (size_t i = 0; i < m_size / 2; ++i)
+    {
+      output[2 * i] = sqrt(loutput[i].r * loutput[i].r + loutput[i].i * loutput[i].i) * scale;
+      output[2 * i + 1] = sqrt(routput[i].r * routput[i].r + routput[i].i * routput[i].i) * scale;
+    }
+  }
+
+private:
+  size_t m_size;
+  bool m_windowed;
+  kiss_fftr_cfg m_cfg;
+};
+
+std::vector<float> MakeMusic(size_t size)
+{
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> noise(-0.1f, 0.1f);
+  std::vector<float> input(2 * size);
+  for (size_t i = 0; i < size; ++i)
+  {
+    input[2 * i] = static_cast<float>(0.5 * sin(2.0 * M_PI * 440.0 * i / 44100.0)) + noise(random);
+    input[2 * i + 1] =
+        static_cast<float>(0.3 * sin(2.0 * M_PI * 1234.5 * i / 44100.0)) + noise(random);
+  }
+  return input;
+}
+} // namespace
+
+TEST(TestRFFT, MatchesKissFFT)
+{
+  for (size_t size : {4, 8, 64, 256, 2048})
+  {
+    for (bool windowed : {false, true})
+    {
+      const std::vector<float> input = MakeMusic(size);
+      std::vector<float> output(size);
+      std::vector<float> expected(size);
+
+      RFFT transform(size, windowed);
+      transform.calc(input.data(), output.data());
+      KissReference reference(size, windowed);
+      reference.calc(input.data(), expected.data());
+
+      for (size_t i = 0; i < size; ++i)
+        ASSERT_NEAR(expected[i], output[i], 1e-5) << "size " << size << " bin " << i / 2;
+    }
+  }
+}
+
+/* Disabled as it only measures, run it with --gtest_also_run_disabled_tests. */
+TEST(TestRFFT, DISABLED_Benchmark)
+{
+  constexpr size_t SIZE = 256; // what the visualisation control uses
+  constexpr int RUNS = 20000;
+
+  const std::vector<float> input = MakeMusic(SIZE);
+  std::vector<float> output(SIZE);
+
+  RFFT transform(SIZE, true);
+  KissReference reference(SIZE, true);
+
+  float sink = 0.0f;
+  std::clock_t start = std::clock();
+  for (int run = 0; run < RUNS; ++run)
+  {
+    reference.calc(input.data(), output.data());
+    sink += output[run % SIZE];
+  }
+  const double kissUs = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC * 1e6 / RUNS;
+
+  start = std::clock();
+  for (int run = 0; run < RUNS; ++run)
+  {
+    transform.calc(input.data(), output.data());
+    sink += output[run % SIZE];
+  }
+  const double rfftUs = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC * 1e6 / RUNS;
+
+  RecordProperty("kissfft_ns", static_cast<int>(kissUs * 1000.0));
+  RecordProperty("rfft_ns", static_cast<int>(rfftUs * 1000.0));
+
+  EXPECT_GT(sink, 0.0f);
+}
@@ -13,6 +13,7 @@
 #include "ServiceBroker.h"
 #include "TextureCache.h"
 #include "URL.h"
+#include "cores/VideoPlayer/DVDBatchThumbExtractor.h"
 #include "cores/VideoPlayer/DVDFileInfo.h"
 #include "cores/VideoSettings.h"
 #include "filesystem/Directory.h"
@@ -109,12 +110,19 @@ bool CThumbExtractor::DoWork()
     CLog::Log(LOGDEBUG, "{} - trying to extract thumb from video file {}", __FUNCTION__,
               CURL::GetRedacted(m_item.GetPath()));
     // construct the thumb cache file
-    CTextureDetails details;
-    details.file = CTextureCache::GetCacheFile(m_target) + ".jpg";
-    result = CDVDFileInfo::ExtractThumb(m_item, details, m_fillStreamDetails ? &m_item.GetVideoInfoTag()->m_streamDetails : nullptr, m_pos);
+    ThumbExtractFile file;
+    file.item = m_item;
+    if (m_fillStreamDetails)
+      file.streamDetails = &m_item.GetVideoInfoTag()->m_streamDetails;
+    ThumbExtractRequest request;
+    request.pos = m_pos;
+    request.details.file = CTextureCache::GetCacheFile(m_target) + ".jpg";
+    file.requests.push_back(request);
+
+    result = CDVDBatchThumbExtractor::Extract(file) > 0;
     if (result)
     {
-      CTextureCache::GetInstance().AddCachedTexture(m_target, details);
+      CTextureCache::GetInstance().AddCachedTexture(m_target, file.requests.front().details);
       m_item.SetProperty("HasAutoThumb", true);
       m_item.SetProperty("AutoThumbImage", m_target);
       m_item.SetArt("thumb", m_target);
@@ -182,6 +190,64 @@ bool CThumbExtractor::DoWork()
   return false;
 }
 
+CChapterThumbExtractor::CChapterThumbExtractor(const CFileItem& item,
+                                               const std::string& listpath,
+                                               const std::map<unsigned int, int64_t>& chapters)
+  : m_listpath(listpath), m_item(item), m_chapters(chapters)
+{
+  if (m_item.IsStack())
+    m_item.SetPath(CStackDirectory::GetFirstStackedFile(m_item.GetPath()));
+}
+
+CChapterThumbExtractor::~CChapterThumbExtractor() = default;
+
+bool CChapterThumbExtractor::operator==(const CJob* job) const
+{
+  if (strcmp(job->GetType(), GetType()) == 0)
+  {
+    const CChapterThumbExtractor* jobExtract = dynamic_cast<const CChapterThumbExtractor*>(job);
+    if (jobExtract && jobExtract->m_listpath == m_listpath &&
+        jobExtract->m_chapters == m_chapters)
+      return true;
+  }
+  return false;
+}
+
+bool CChapterThumbExtractor::DoWork()
+{
+  CLog::Log(LOGDEBUG, "{} - trying to extract {} chapter thumbs from video file {}", __FUNCTION__,
+            m_chapters.size(), CURL::GetRedacted(m_item.GetPath()));
+
+  ThumbExtractFile file;
+  file.item = m_item;
+  for (const auto& chapter : m_chapters)
+  {
+    ThumbExtractRequest request;
+    request.pos = chapter.second;
+    request.details.file =
+        CTextureCache::GetCacheFile(StringUtils::Format("chapter://{}/{}", m_listpath,
+                                                        chapter.first)) + ".jpg";
+    file.requests.push_back(request);
+  }
+
+  CDVDBatchThumbExtractor::Extract(file);
+
+  m_extracted.clear();
+  auto request = file.requests.begin();
+  for (const auto& chapter : m_chapters)
+  {
+    if (request->extracted)
+    {
+      const std::string target = StringUtils::Format("chapter://{}/{}", m_listpath, chapter.first);
+      CTextureCache::GetInstance().AddCachedTexture(target, request->details);
+      m_extracted.push_back(chapter.first);
+    }
+    ++request;
+  }
+
+  return !m_extracted.empty();
+}
+
 CVideoThumbLoader::CVideoThumbLoader() :
   CThumbLoader(), CJobQueue(true, 1, CJob::PRIORITY_LOW_PAUSABLE)
 {
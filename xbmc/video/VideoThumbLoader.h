@@ -56,6 +56,41 @@ public:
   bool m_fillStreamDetails; ///< fill in stream details?
 };
 
+/*!
+ \ingroup thumbs,jobs
+ \brief Chapter thumb extractor job class
+
+ Extracts the thumbs of several chapters of one file in a single pass, decoding
+ only the key frames nearest to the chapter positions.
+
+ \sa CDVDBatchThumbExtractor and CJob
+ */
+class CChapterThumbExtractor : public CJob
+{
+public:
+  CChapterThumbExtractor(const CFileItem& item,
+                         const std::string& listpath,
+                         const std::map<unsigned int, int64_t>& chapters);
+  ~CChapterThumbExtractor() override;
+
+  /*!
+   \brief Work function that extracts the chapter thumbs.
+   */
+  bool DoWork() override;
+
+  const char* GetType() const override
+  {
+    return kJobTypeMediaFlags;
+  }
+
+  bool operator==(const CJob* job) const override;
+
+  std::string m_listpath; ///< path used in fileitem list
+  CFileItem m_item;
+  std::map<unsigned int, int64_t> m_chapters; ///< chapter index -> position in ms
+  std::vector<unsigned int> m_extracted; ///< chapters whose thumb was extracted
+};
+
 class CVideoThumbLoader : public CThumbLoader, public CJobQueue
 {
 public:
@@ -36,6 +36,7 @@
 #include "video/VideoThumbLoader.h"
 #include "view/ViewState.h"
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -263,6 +264,7 @@ void CGUIDialogVideoBookmarks::OnRefreshList()
   }
 
   // add chapters if around
+  std::map<unsigned int, int64_t> chapterThumbs;
   for (int i = 1; i <= g_application.GetAppPlayer().GetChapterCount(); ++i)
   {
     std::string chapterName;
@@ -285,11 +287,8 @@ void CGUIDialogVideoBookmarks::OnRefreshList()
       item->SetArt("thumb", cachefile);
     else if (i > m_jobsStarted && CServiceBroker::GetSettingsComponent()->GetSettings()->GetBool(CSettings::SETTING_MYVIDEOS_EXTRACTCHAPTERTHUMBS))
     {
-      CFileItem item(m_filePath, false);
-      CJob* job = new CThumbExtractor(item, m_filePath, true, chapterPath, pos * 1000, false);
-      AddJob(job);
-      m_mapJobsChapter[job] = i;
-      m_jobsStarted++;
+      chapterThumbs[i] = pos * 1000;
+      m_jobsStarted = i;
     }
 
     item->SetProperty("chapter", i);
@@ -298,6 +297,15 @@ void CGUIDialogVideoBookmarks::OnRefreshList()
     items.push_back(item);
   }
 
+  // extract all missing chapter thumbs in one pass over the file
+  if (!chapterThumbs.empty())
+  {
+    CFileItem item(m_filePath, false);
+    CJob* job = new CChapterThumbExtractor(item, m_filePath, chapterThumbs);
+    AddJob(job);
+    m_mapJobsChapter[job] = chapterThumbs.size();
+  }
+
   // sort items by resume point
   std::sort(items.begin(), items.end(), [](const CFileItemPtr &item1, const CFileItemPtr &item2) {
     return item1->GetProperty("resumepoint").asDouble() < item2->GetProperty("resumepoint").asDouble();
@@ -568,9 +576,12 @@ void CGUIDialogVideoBookmarks::OnJobComplete(unsigned int jobID,
     MAPJOBSCHAPS::iterator iter = m_mapJobsChapter.find(job);
     if (iter != m_mapJobsChapter.end())
     {
-      unsigned int chapterIdx = (*iter).second;
-      CGUIMessage m(GUI_MSG_REFRESH_LIST, GetID(), 0, 1, chapterIdx);
-      CApplicationMessenger::GetInstance().SendGUIMessage(m);
+      const CChapterThumbExtractor* extractor = static_cast<const CChapterThumbExtractor*>(job);
+      for (unsigned int chapterIdx : extractor->m_extracted)
+      {
+        CGUIMessage m(GUI_MSG_REFRESH_LIST, GetID(), 0, 1, chapterIdx);
+        CApplicationMessenger::GetInstance().SendGUIMessage(m);
+      }
       m_mapJobsChapter.erase(iter);
     }
   }
@@ -17,7 +17,7 @@ class CFileItemList;
 
 class CGUIDialogVideoBookmarks : public CGUIDialog, public CJobQueue
 {
-  typedef std::map<CJob*, unsigned int> MAPJOBSCHAPS;
+  typedef std::map<CJob*, unsigned int> MAPJOBSCHAPS; ///< job -> number of chapters
 
 public:
   CGUIDialogVideoBookmarks(void);